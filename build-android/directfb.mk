@@ -405,6 +405,7 @@ SAWMAN_SOURCES = \
 	$(DFB_SOURCE)/lib/sawman/sawman_core.c		\
 	$(DFB_SOURCE)/lib/sawman/sawman_config.c		\
 	$(DFB_SOURCE)/lib/sawman/sawman_draw.c		\
+	$(DFB_SOURCE)/lib/sawman/sawman_overlay.c		\
 	$(DFB_SOURCE)/lib/sawman/sawman_updates.c		\
 	$(DFB_SOURCE)/lib/sawman/sawman_window.c		\
 	$(DFB_SOURCE)/lib/sawman/SaWMan.cpp			\
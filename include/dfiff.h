@@ -40,7 +40,50 @@
 #include <inttypes.h>
 
 #define DFIFF_FLAG_LITTLE_ENDIAN   0x01
-#define DFIFF_FLAG_PREMULTIPLIED   0x02
+#define DFIFF_FLAG_PREMULTIPLIED   0x02   /* all levels contain premultiplied pixels */
+
+/*
+ * Version 2 (major == 2)
+ *
+ * The DFIFFHeader still describes the full size image (level 0). It is followed by a
+ * DFIFFExtension, the level table (num_levels entries) and the tile table (num_tiles
+ * entries). Each level is split into tiles of 'tile_height' rows (the last one may be
+ * shorter), so a partial render only needs to decode the tiles it touches.
+ *
+ * Level n is the full size image scaled down by 2^n (at least 1x1), i.e. a box filtered
+ * mip map. Mip levels are always premultiplied if the format has an alpha channel.
+ *
+ * The data of each level starts at a multiple of DFIFF_DATA_ALIGN. Uncompressed tiles of
+ * a level are stored back to back, which allows to use the mapped file directly as a
+ * preallocated surface. A compressed tile whose size equals its raw size is stored as is.
+ */
+#define DFIFF_MAJOR_V2             2
+
+#define DFIFF_DATA_ALIGN           64
+
+typedef enum {
+     DFIFF_COMPRESSION_NONE   = 0,
+     DFIFF_COMPRESSION_FASTLZ = 1   /* see direct_fastlz_compress() */
+} DFIFFCompression;
+
+typedef struct {
+     uint32_t                 compression;   /* DFIFFCompression */
+     uint32_t                 tile_height;   /* Rows per tile */
+     uint32_t                 num_levels;    /* Number of levels including the full size image */
+     uint32_t                 num_tiles;     /* Number of tiles of all levels */
+} DFIFFExtension;
+
+typedef struct {
+     uint32_t                 width;
+     uint32_t                 height;
+     uint32_t                 pitch;
+     uint32_t                 first_tile;    /* Index of the level's first tile in the tile table */
+} DFIFFLevel;
+
+typedef struct {
+     uint32_t                 offset;        /* Offset of the tile data from the start of the file */
+     uint32_t                 size;          /* Stored size of the tile data */
+} DFIFFTile;
 
 typedef struct {
      unsigned char magic[5];      /* "DFIFF" magic */
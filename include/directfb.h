@@ -794,7 +794,12 @@ typedef enum {
 
      DSRO_WRITE_MASK_BITS      = 0x00000010, /* Enable usage of write mask bits setting. */
 
-     DSRO_ALL                  = 0x0000001F  /* All of these. */
+     DSRO_SMOOTH_BICUBIC       = 0x00000020, /* Use a bicubic filter for smooth StretchBlit() (quality level, together
+                                                with DSRO_SMOOTH_UPSCALE and/or DSRO_SMOOTH_DOWNSCALE). */
+     DSRO_SMOOTH_LANCZOS       = 0x00000040, /* Use a Lanczos filter for smooth StretchBlit() (highest quality level,
+                                                takes precedence over DSRO_SMOOTH_BICUBIC). */
+
+     DSRO_ALL                  = 0x0000007F  /* All of these. */
 } DFBSurfaceRenderOptions;
 
 /*
@@ -4989,6 +4994,24 @@ D_DEFINE_INTERFACE(   IDirectFBSurface,
           IDirectFBSurface         *thiz,
           DFBSurfaceFlushFlags      flags
      );
+
+
+   /** Buffer age **/
+
+     /*
+      * Get the age of the back buffer, i.e. the number of frames since its content was shown.
+      *
+      * An age of 1 means it holds the content of the front buffer, e.g. after blitting Flip() or
+      * for single buffered surfaces. With flipping the age is usually 2 (double) or 3 (triple).
+      * Only the areas changed during the last age - 1 frames need to be redrawn before the next
+      * Flip() instead of copying back from the front buffer.
+      *
+      * An age of 0 means the content is undefined and everything has to be redrawn.
+      */
+     DFBResult (*GetBufferAge) (
+          IDirectFBSurface         *thiz,
+          unsigned int             *ret_age
+     );
 )
 
 /**************************
@@ -7168,6 +7191,24 @@ D_DEFINE_INTERFACE(   IDirectFBImageProvider,
           const DFBRectangle       *src_rect,
           const char               *filename
      );
+
+
+   /** Region of interest **/
+
+     /*
+      * Restrict decoding to a part of the image.
+      *
+      * Subsequent calls to RenderTo() render only the specified
+      * rectangle of the image into the destination rectangle,
+      * skipping as much of the decoding outside of it as the
+      * image format allows. Passing NULL resets to the whole image.
+      *
+      * This is optional and might be unsupported by some image providers
+      */
+     DFBResult (*SetSourceRectangle) (
+          IDirectFBImageProvider   *thiz,
+          const DFBRectangle       *source_rect
+     );
 )
 
 /*
@@ -7795,6 +7836,42 @@ D_DEFINE_INTERFACE(   IDirectFBDataBuffer,
           const DFBFontDescription  *desc,
           IDirectFBFont            **interface_ptr
      );
+
+
+   /** Direct access **/
+
+     /*
+      * Get a pointer to the complete data of a static buffer.
+      *
+      * This avoids copying the data via GetData() or PeekData(),
+      * e.g. files are mapped into memory. The data is read only
+      * and stays valid until the buffer is destroyed. The current
+      * position is not affected.
+      *
+      * Returns DFB_UNSUPPORTED if the buffer cannot provide it.
+      */
+     DFBResult (*GetDataPointer) (
+          IDirectFBDataBuffer      *thiz,
+          const void              **ret_data,
+          unsigned int             *ret_length
+     );
+
+     /*
+      * Get a pointer to the buffered data of a streamed buffer.
+      *
+      * Returns the contiguous part of the data at the current
+      * position, without copying it. The data is read only and
+      * stays valid until the next GetData() or Flush(). Passing
+      * NULL as the buffer to GetData() consumes it without copying.
+      *
+      * Returns DFB_BUFFEREMPTY if no data is buffered, DFB_EOF
+      * after Finish(), or DFB_UNSUPPORTED for other buffers.
+      */
+     DFBResult (*PeekDataPointer) (
+          IDirectFBDataBuffer      *thiz,
+          const void              **ret_data,
+          unsigned int             *ret_length
+     );
 )
 
 #ifdef __cplusplus
@@ -50,6 +50,13 @@ static DFBResult Probe( IDirectFBImageProvider_ProbeContext *ctx );
 static DFBResult Construct( IDirectFBImageProvider *thiz,
                             IDirectFBDataBuffer    *buffer );
 
+static const DirectInterfaceSignature signatures[] = {
+     { 0, "BM", 2 },
+     { 0, NULL, 0 }
+};
+
+#define DIRECT_INTERFACE_SIGNATURES signatures
+
 #include <direct/interface_implementation.h>
 
 DIRECT_INTERFACE_IMPLEMENTATION( IDirectFBImageProvider, BMP )
@@ -37,9 +37,7 @@
 #include <config.h>
 
 #include <errno.h>
-#include <fcntl.h>
-#include <sys/mman.h>
-#include <sys/stat.h>
+#include <limits.h>
 #include <string.h>
 #include <unistd.h>
 #include <stdarg.h>
@@ -47,7 +45,10 @@
 #include <directfb.h>
 
 #include <direct/debug.h>
+#include <direct/fastlz.h>
 #include <direct/interface.h>
+#include <direct/mem.h>
+#include <direct/memcpy.h>
 #include <direct/messages.h>
 #include <direct/util.h>
 
@@ -69,6 +70,13 @@ static DFBResult
 Construct( IDirectFBImageProvider *thiz,
            ... );
 
+static const DirectInterfaceSignature signatures[] = {
+     { 0, "DFIFF", 5 },
+     { 0, NULL, 0 }
+};
+
+#define DIRECT_INTERFACE_SIGNATURES signatures
+
 #include <direct/interface_implementation.h>
 
 DIRECT_INTERFACE_IMPLEMENTATION( IDirectFBImageProvider, DFIFF )
@@ -80,20 +88,90 @@ DIRECT_INTERFACE_IMPLEMENTATION( IDirectFBImageProvider, DFIFF )
 typedef struct {
      IDirectFBImageProvider_data base;
 
-     void                *ptr;     /* pointer to raw file data (mapped) */
-     int                  len;     /* data length, i.e. file size */
+     const void          *ptr;     /* pointer to raw file data (owned by the buffer) */
+     unsigned int         len;     /* data length, i.e. file size */
+
+     const DFIFFHeader    *header;
+     const DFIFFExtension *ext;
+     const DFIFFLevel     *levels;
+     const DFIFFTile      *tiles;
+
+     /* tables describing a version 0 file, i.e. one uncompressed level with one tile */
+     DFIFFExtension       v0_ext;
+     DFIFFLevel           v0_level;
+     DFIFFTile            v0_tile;
 } IDirectFBImageProvider_DFIFF_data;
 
 
 
 
 
-static void
-IDirectFBImageProvider_DFIFF_Destruct( IDirectFBImageProvider *thiz )
+/*
+ * Limits for values read from the file, keeping all size calculations far from overflowing.
+ */
+#define DFIFF_MAX_DIMENSION   32768
+#define DFIFF_MAX_PITCH       (DFIFF_MAX_DIMENSION * 16)
+
+/*
+ * Returns the size of 'rows' rows of a tile in bytes.
+ */
+static inline u64
+tile_size( const DFIFFHeader *header,
+           const DFIFFLevel  *level,
+           unsigned int       rows )
+{
+     return (u64) DFB_PLANE_MULTIPLY( header->format, (u64) rows ) * level->pitch;
+}
+
+/*
+ * Chooses the smallest level that is at least as big as the destination.
+ */
+static const DFIFFLevel *
+choose_level( IDirectFBImageProvider_DFIFF_data *data,
+              int                                width,
+              int                                height )
 {
-     IDirectFBImageProvider_DFIFF_data *data = thiz->priv;
+     int n;
 
-     munmap( data->ptr, data->len );
+     for (n = data->ext->num_levels - 1; n > 0; n--) {
+          const DFIFFLevel *level = &data->levels[n];
+
+          if (level->width >= (unsigned) width && level->height >= (unsigned) height)
+               break;
+     }
+
+     return &data->levels[n];
+}
+
+/*
+ * Decompresses the tiles 'first' to 'last' of a level into 'dst' which is 'pitch' aligned.
+ */
+static DFBResult
+decode_tiles( IDirectFBImageProvider_DFIFF_data *data,
+              const DFIFFLevel                  *level,
+              unsigned int                       first,
+              unsigned int                       last,
+              u8                                *dst )
+{
+     unsigned int n;
+
+     for (n = first; n <= last; n++) {
+          const DFIFFTile *tile = &data->tiles[level->first_tile + n];
+          unsigned int     rows = MIN( data->ext->tile_height, level->height - n * data->ext->tile_height );
+          unsigned int     size = (unsigned int) tile_size( data->header, level, rows );
+          const u8        *src  = (const u8*) data->ptr + tile->offset;
+
+          if (tile->size == size)
+               direct_memcpy( dst, src, size );
+          else if (direct_fastlz_decompress( src, tile->size, dst, size ) != (int) size) {
+               D_ERROR( "ImageProvider/DFIFF: Corrupt tile %u of %ux%u level!\n", n, level->width, level->height );
+               return DFB_FAILURE;
+          }
+
+          dst += size;
+     }
+
+     return DFB_OK;
 }
 
 static DFBResult
@@ -105,11 +183,17 @@ IDirectFBImageProvider_DFIFF_RenderTo( IDirectFBImageProvider *thiz,
      IDirectFBSurface_data *dst_data;
      CoreSurface           *dst_surface;
      const DFIFFHeader     *header;
+     const DFIFFLevel      *level;
      DFBRectangle           rect;
      DFBRectangle           clipped;
+     DFBRectangle           source_rect;
      DFBSurfaceCapabilities caps;
      bool                   dfiff_premultiplied = false;
      bool                   dest_premultiplied = false;
+     bool                   scaled;
+     u8                    *pixels;
+     u8                    *buffer = NULL;
+     unsigned int           rows;
 
      DIRECT_INTERFACE_GET_DATA (IDirectFBImageProvider_DFIFF)
 
@@ -141,7 +225,7 @@ IDirectFBImageProvider_DFIFF_RenderTo( IDirectFBImageProvider *thiz,
 
      destination->GetCapabilities( destination, &caps );
 
-     header = data->ptr;
+     header = data->header;
 
      if (header->flags & DFIFF_FLAG_PREMULTIPLIED)
           dfiff_premultiplied = true;
@@ -149,15 +233,60 @@ IDirectFBImageProvider_DFIFF_RenderTo( IDirectFBImageProvider *thiz,
      if (caps & DSCAPS_PREMULTIPLIED)
           dest_premultiplied = true;
 
+     level  = choose_level( data, rect.w, rect.h );
+     scaled = (unsigned) rect.w != level->width || (unsigned) rect.h != level->height;
+
+     if (scaled) {
+          source_rect.x = 0;
+          source_rect.y = 0;
+          source_rect.w = level->width;
+          source_rect.h = level->height;
+     }
+     else {
+          source_rect.x = clipped.x - rect.x;
+          source_rect.y = clipped.y - rect.y;
+          source_rect.w = clipped.w;
+          source_rect.h = clipped.h;
+     }
+
+     rows = level->height;
+
+     if (data->ext->compression == DFIFF_COMPRESSION_NONE) {
+          /* Tiles are stored back to back, use the mapped file directly. */
+          pixels = (u8*) data->ptr + data->tiles[level->first_tile].offset;
+     }
+     else {
+          unsigned int first = 0;
+          unsigned int last  = (level->height - 1) / data->ext->tile_height;
+
+          /* Without scaling only the tiles covering the clipped area are needed. */
+          if (!scaled) {
+               first = source_rect.y / data->ext->tile_height;
+               last  = (source_rect.y + source_rect.h - 1) / data->ext->tile_height;
+
+               source_rect.y -= first * data->ext->tile_height;
+          }
+
+          rows = MIN( (last + 1) * data->ext->tile_height, level->height ) - first * data->ext->tile_height;
 
-     if (DFB_RECTANGLE_EQUAL( rect, clipped ) &&
-         (unsigned)rect.w == header->width && (unsigned)rect.h == header->height &&
+          buffer = D_MALLOC( tile_size( header, level, rows ) );
+          if (!buffer)
+               return D_OOM();
+
+          ret = decode_tiles( data, level, first, last, buffer );
+          if (ret) {
+               D_FREE( buffer );
+               return ret;
+          }
+
+          pixels = buffer;
+     }
+
+     if (!scaled && DFB_RECTANGLE_EQUAL( rect, clipped ) &&
          dst_surface->config.format == header->format && dfiff_premultiplied == dest_premultiplied)
      {
           ret = dfb_surface_write_buffer( dst_surface, CSBR_BACK,
-                                          (u8*)data->ptr + sizeof(DFIFFHeader), header->pitch, &rect );
-          if (ret)
-               return ret;
+                                          pixels + source_rect.y * level->pitch, level->pitch, &rect );
      }
      else {
           IDirectFBSurface      *source;
@@ -165,15 +294,19 @@ IDirectFBImageProvider_DFIFF_RenderTo( IDirectFBImageProvider *thiz,
           DFBRegion              clip = DFB_REGION_INIT_FROM_RECTANGLE( &clipped );
           DFBRegion              old_clip;
 
-          thiz->GetSurfaceDescription( thiz, &desc );
-
-          desc.flags |= DSDESC_PREALLOCATED;   
-          desc.preallocated[0].data  = (u8*)data->ptr + sizeof(DFIFFHeader);
-          desc.preallocated[0].pitch = header->pitch;
+          desc.flags                 = DSDESC_WIDTH | DSDESC_HEIGHT | DSDESC_PIXELFORMAT | DSDESC_PREALLOCATED;
+          desc.width                 = level->width;
+          desc.height                = rows;
+          desc.pixelformat           = header->format;
+          desc.preallocated[0].data  = pixels;
+          desc.preallocated[0].pitch = level->pitch;
 
           ret = data->base.idirectfb->CreateSurface( data->base.idirectfb, &desc, &source );
-          if (ret)
+          if (ret) {
+               if (buffer)
+                    D_FREE( buffer );
                return ret;
+          }
 
           if (DFB_PIXELFORMAT_HAS_ALPHA(desc.pixelformat)) {
                if (dest_premultiplied && !dfiff_premultiplied)
@@ -185,7 +318,10 @@ IDirectFBImageProvider_DFIFF_RenderTo( IDirectFBImageProvider *thiz,
           destination->GetClip( destination, &old_clip );
           destination->SetClip( destination, &clip );
 
-          destination->StretchBlit( destination, source, NULL, &rect );
+          if (scaled)
+               ret = destination->StretchBlit( destination, source, &source_rect, &rect );
+          else
+               ret = destination->Blit( destination, source, &source_rect, clipped.x, clipped.y );
 
           destination->SetClip( destination, &old_clip );
 
@@ -195,7 +331,13 @@ IDirectFBImageProvider_DFIFF_RenderTo( IDirectFBImageProvider *thiz,
 
           source->Release( source );
      }
-     
+
+     if (buffer)
+          D_FREE( buffer );
+
+     if (ret)
+          return ret;
+
      if (data->base.render_callback) {
           DFBRectangle rect = { 0, 0, clipped.w, clipped.h };
           data->base.render_callback( &rect,
@@ -215,7 +357,7 @@ IDirectFBImageProvider_DFIFF_GetSurfaceDescription( IDirectFBImageProvider *thiz
 
      DIRECT_INTERFACE_GET_DATA (IDirectFBImageProvider_DFIFF)
 
-     header = data->ptr;
+     header = data->header;
 
      dsc->flags       = DSDESC_WIDTH | DSDESC_HEIGHT | DSDESC_PIXELFORMAT;
      dsc->width       = header->width;
@@ -236,7 +378,7 @@ IDirectFBImageProvider_DFIFF_GetImageDescription( IDirectFBImageProvider *thiz,
      if (!desc)
           return DFB_INVARG;
 
-     header = data->ptr;
+     header = data->header;
 
      desc->caps = DICAPS_NONE;
 
@@ -248,6 +390,127 @@ IDirectFBImageProvider_DFIFF_GetImageDescription( IDirectFBImageProvider *thiz,
 
 
 
+/*
+ * Sets up the level and tile tables, synthesizing them for version 0 files,
+ * and checks that everything referenced lies within the file.
+ */
+static DFBResult
+setup_tables( IDirectFBImageProvider_DFIFF_data *data )
+{
+     const DFIFFHeader *header = data->ptr;
+     unsigned int       n, t;
+     size_t             offset;
+
+     if (data->len < sizeof(DFIFFHeader))
+          return DFB_FAILURE;
+
+     data->header = header;
+
+     if (header->major < DFIFF_MAJOR_V2) {
+          data->v0_ext.compression  = DFIFF_COMPRESSION_NONE;
+          data->v0_ext.tile_height  = header->height;
+          data->v0_ext.num_levels   = 1;
+          data->v0_ext.num_tiles    = 1;
+
+          data->v0_level.width      = header->width;
+          data->v0_level.height     = header->height;
+          data->v0_level.pitch      = header->pitch;
+          data->v0_level.first_tile = 0;
+
+          data->v0_tile.offset      = sizeof(DFIFFHeader);
+          data->v0_tile.size        = 0;   /* set below once the pitch has been checked */
+
+          data->ext    = &data->v0_ext;
+          data->levels = &data->v0_level;
+          data->tiles  = &data->v0_tile;
+     }
+     else {
+          if (header->major > DFIFF_MAJOR_V2) {
+               D_ERROR( "ImageProvider/DFIFF: Unsupported version %d.%d!\n", header->major, header->minor );
+               return DFB_UNSUPPORTED;
+          }
+
+          offset = sizeof(DFIFFHeader) + sizeof(DFIFFExtension);
+          if ((size_t) data->len < offset)
+               return DFB_FAILURE;
+
+          data->ext = (const DFIFFExtension*) (header + 1);
+
+          if (data->ext->compression > DFIFF_COMPRESSION_FASTLZ ||
+              !data->ext->tile_height || !data->ext->num_levels || !data->ext->num_tiles)
+               return DFB_FAILURE;
+
+          data->levels = (const DFIFFLevel*) (data->ext + 1);
+          data->tiles  = (const DFIFFTile*) (data->levels + data->ext->num_levels);
+
+          offset += data->ext->num_levels * (size_t) sizeof(DFIFFLevel) +
+                    data->ext->num_tiles  * (size_t) sizeof(DFIFFTile);
+          if ((size_t) data->len < offset)
+               return DFB_FAILURE;
+     }
+
+     if (!header->width || !header->height ||
+         header->width > DFIFF_MAX_DIMENSION || header->height > DFIFF_MAX_DIMENSION ||
+         DFB_PIXELFORMAT_INDEX( header->format ) >= DFB_NUM_PIXELFORMATS)
+          return DFB_FAILURE;
+
+     if (data->ext->tile_height > DFIFF_MAX_DIMENSION ||
+         data->ext->num_levels > DFIFF_MAX_DIMENSION || data->ext->num_tiles > DFIFF_MAX_DIMENSION * 16)
+          return DFB_FAILURE;
+
+     for (n = 0; n < data->ext->num_levels; n++) {
+          const DFIFFLevel *level = &data->levels[n];
+          unsigned int      tiles;
+          u64               start;
+
+          if (!level->width || !level->height ||
+              level->width > DFIFF_MAX_DIMENSION || level->height > DFIFF_MAX_DIMENSION ||
+              level->pitch < DFB_BYTES_PER_LINE( header->format, level->width ) || level->pitch > DFIFF_MAX_PITCH)
+               return DFB_FAILURE;
+
+          /* Keeps decode buffers and tile sizes within an int. */
+          if (tile_size( header, level, level->height ) > INT_MAX)
+               return DFB_FAILURE;
+
+          if (header->major < DFIFF_MAJOR_V2)
+               data->v0_tile.size = tile_size( header, level, level->height );
+
+          tiles = (level->height + data->ext->tile_height - 1) / data->ext->tile_height;
+
+          /* Planar formats can not be split into tiles. */
+          if (tiles > 1 && DFB_PLANAR_PIXELFORMAT( header->format ))
+               return DFB_FAILURE;
+
+          if (level->first_tile > data->ext->num_tiles || tiles > data->ext->num_tiles - level->first_tile)
+               return DFB_FAILURE;
+
+          start = data->tiles[level->first_tile].offset;
+
+          /* Uncompressed levels are used in place, so the whole level must lie within the file. */
+          if (data->ext->compression == DFIFF_COMPRESSION_NONE &&
+              start + tile_size( header, level, level->height ) > (u64) data->len)
+               return DFB_FAILURE;
+
+          for (t = 0; t < tiles; t++) {
+               const DFIFFTile *tile = &data->tiles[level->first_tile + t];
+               unsigned int     rows = MIN( data->ext->tile_height, level->height - t * data->ext->tile_height );
+               u64              size = tile_size( header, level, rows );
+
+               if ((u64) tile->offset + tile->size > (u64) data->len)
+                    return DFB_FAILURE;
+
+               if (data->ext->compression == DFIFF_COMPRESSION_NONE) {
+                    /* Uncompressed levels are used in place, so they must be contiguous. */
+                    if (tile->size != size ||
+                        tile->offset != start + t * tile_size( header, level, data->ext->tile_height ))
+                         return DFB_FAILURE;
+               }
+          }
+     }
+
+     return DFB_OK;
+}
+
 static DFBResult
 Probe( IDirectFBImageProvider_ProbeContext *ctx )
 {
@@ -261,11 +524,9 @@ static DFBResult
 Construct( IDirectFBImageProvider *thiz,
            ... )
 {
-     DFBResult                 ret;
-     struct stat               stat;
-     void                     *ptr;
-     int                       fd = -1;
-     IDirectFBDataBuffer_data *buffer_data;
+     DFBResult            ret;
+     const void          *ptr;
+     unsigned int         len;
 
      IDirectFBDataBuffer *buffer;
      CoreDFB             *core;
@@ -280,52 +541,26 @@ Construct( IDirectFBImageProvider *thiz,
 
      D_MAGIC_ASSERT( (IAny*) buffer, DirectInterface );
 
-     /* Get the buffer's private data. */
-     buffer_data = buffer->priv;
-     if (!buffer_data) {
-          ret = DFB_DEAD;
-          goto error;
-     }
-
-     /* Check for valid filename. */
-     if (!buffer_data->filename) {
-          ret = DFB_UNSUPPORTED;
+     /* Use the data in place, e.g. the file mapped by the buffer. */
+     ret = buffer->GetDataPointer( buffer, &ptr, &len );
+     if (ret)
           goto error;
-     }
 
-     /* Open the file. */
-     fd = open( buffer_data->filename, O_RDONLY );
-     if (fd < 0) {
-          ret = errno2result( errno );
-          D_PERROR( "ImageProvider/DFIFF: Failure during open() of '%s'!\n", buffer_data->filename );
-          goto error;
-     }
-
-     /* Query file size etc. */
-     if (fstat( fd, &stat ) < 0) {
-          ret = errno2result( errno );
-          D_PERROR( "ImageProvider/DFIFF: Failure during fstat() of '%s'!\n", buffer_data->filename );
-          goto error;
-     }
+     data->ptr = ptr;
+     data->len = len;
 
-     /* Memory map the file. */
-     ptr = mmap( NULL, stat.st_size, PROT_READ, MAP_SHARED, fd, 0 );
-     if (ptr == MAP_FAILED) {
-          ret = errno2result( errno );
-          D_PERROR( "ImageProvider/DFIFF: Failure during mmap() of '%s'!\n", buffer_data->filename );
+     ret = setup_tables( data );
+     if (ret) {
+          D_ERROR( "ImageProvider/DFIFF: Invalid or truncated data!\n" );
           goto error;
      }
 
-     /* Already close, we still have the map. */
-     close( fd );
-
-     data->base.ref = 1;
-     data->base.core = core;
+     /* The data remains valid as long as the buffer. */
+     buffer->AddRef( buffer );
 
-     data->ptr = ptr;
-     data->len = stat.st_size;
-
-     data->base.Destruct = IDirectFBImageProvider_DFIFF_Destruct;
+     data->base.ref    = 1;
+     data->base.buffer = buffer;
+     data->base.core   = core;
 
      thiz->RenderTo              = IDirectFBImageProvider_DFIFF_RenderTo;
      thiz->GetImageDescription   = IDirectFBImageProvider_DFIFF_GetImageDescription;
@@ -334,9 +569,6 @@ Construct( IDirectFBImageProvider *thiz,
      return DFB_OK;
 
 error:
-     if (fd != -1)
-          close( fd );
-
      DIRECT_DEALLOCATE_INTERFACE(thiz);
 
      return ret;
@@ -39,6 +39,15 @@ static DFBResult Probe( IDirectFBImageProvider_ProbeContext *ctx );
 static DFBResult Construct( IDirectFBImageProvider *thiz,
                             ... );
 
+/* Frame start codes. */
+static const DirectInterfaceSignature signatures[] = {
+     { 0, "\x00\x00\x00\x01", 4 },
+     { 0, "\x00\x00\x01\xb3", 4 },
+     { 0, NULL, 0 }
+};
+
+#define DIRECT_INTERFACE_SIGNATURES signatures
+
 #include "direct/interface_implementation.h"
 
 DIRECT_INTERFACE_IMPLEMENTATION( IDirectFBImageProvider, FFMPEG )
@@ -62,6 +62,13 @@ static DFBResult
 Construct( IDirectFBImageProvider *thiz,
            ... );
 
+static const DirectInterfaceSignature signatures[] = {
+     { 0, "GIF8", 4 },
+     { 0, NULL, 0 }
+};
+
+#define DIRECT_INTERFACE_SIGNATURES signatures
+
 #include <direct/interface_implementation.h>
 
 DIRECT_INTERFACE_IMPLEMENTATION( IDirectFBImageProvider, GIF )
@@ -128,6 +135,10 @@ typedef struct {
      int clear_code, end_code;
      int table[2][(1<< MAX_LWZ_BITS)];
      int stack[(1<<(MAX_LWZ_BITS))*2], *sp;
+
+     const u8     *mapped;   /* data of the buffer if accessible directly */
+     unsigned int  mapped_length;
+     unsigned int  mapped_pos;
 } IDirectFBImageProvider_GIF_data;
 
 static bool verbose       = false;
@@ -138,7 +149,7 @@ static u32* ReadGIF( IDirectFBImageProvider_GIF_data *data, int imageNumber,
                        int *width, int *height, bool *transparency,
                        u32 *key_rgb, bool alpha, bool headeronly);
 
-static bool ReadOK( IDirectFBDataBuffer *buffer, void *data, unsigned int len );
+static bool ReadOK( IDirectFBImageProvider_GIF_data *data, void *buf, unsigned int len );
 
 
 static DFBResult
@@ -200,12 +211,18 @@ Construct( IDirectFBImageProvider *thiz,
      data->transparent = -1;
      data->delayTime   = -1;
 
+     /* Read directly from the buffer's data if possible, e.g. a mapped file. */
+     if (buffer->GetDataPointer( buffer, (const void**) &data->mapped, &data->mapped_length ) ||
+         buffer->GetPosition( buffer, &data->mapped_pos ))
+          data->mapped = NULL;
+
      data->image = ReadGIF( data, 1, &data->image_width, &data->image_height,
                             &data->image_transparency, &data->image_colorkey,
                             true, false );
 
      buffer->Release( buffer );
      data->base.buffer = NULL;
+     data->mapped      = NULL;
 
      if (!data->image ||
          (data->image_height == 0) ||
@@ -333,14 +350,14 @@ IDirectFBImageProvider_GIF_GetImageDescription( IDirectFBImageProvider *thiz,
          GIF Loader Code
  **********************************/
 
-static int ReadColorMap( IDirectFBDataBuffer *buffer, int number,
+static int ReadColorMap( IDirectFBImageProvider_GIF_data *data, int number,
                          u8 buf[3][MAXCOLORMAPSIZE] )
 {
      int     i;
      u8 rgb[3];
 
      for (i = 0; i < number; ++i) {
-          if (! ReadOK( buffer, rgb, sizeof(rgb) )) {
+          if (! ReadOK( data, rgb, sizeof(rgb) )) {
                GIFERRORMSG("bad colormap" );
                return true;
           }
@@ -352,17 +369,17 @@ static int ReadColorMap( IDirectFBDataBuffer *buffer, int number,
      return false;
 }
 
-static int GetDataBlock(IDirectFBDataBuffer *buffer, u8 *buf)
+static int GetDataBlock(IDirectFBImageProvider_GIF_data *data, u8 *buf)
 {
      unsigned char count;
 
-     if (! ReadOK( buffer, &count, 1 )) {
+     if (! ReadOK( data, &count, 1 )) {
           GIFERRORMSG("error in getting DataBlock size" );
           return -1;
      }
      ZeroDataBlock = count == 0;
 
-     if ((count != 0) && (! ReadOK( buffer, buf, count ))) {
+     if ((count != 0) && (! ReadOK( data, buf, count ))) {
           GIFERRORMSG("error in reading DataBlock" );
           return -1;
      }
@@ -392,7 +409,7 @@ static int GetCode(IDirectFBImageProvider_GIF_data *data, int code_size, int fla
           data->buf[0] = data->buf[data->last_byte-2];
           data->buf[1] = data->buf[data->last_byte-1];
 
-          if ((count = GetDataBlock( data->base.buffer, &data->buf[2] )) == 0) {
+          if ((count = GetDataBlock( data, &data->buf[2] )) == 0) {
                data->done = true;
           }
 
@@ -424,21 +441,21 @@ static int DoExtension( IDirectFBImageProvider_GIF_data *data, int label )
                break;
           case 0xfe:              /* Comment Extension */
                str = "Comment Extension";
-               while (GetDataBlock( data->base.buffer, (u8*) buf ) != 0) {
+               while (GetDataBlock( data, (u8*) buf ) != 0) {
                     if (showComment)
                          GIFERRORMSG("gif comment: %s", buf );
                     }
                return false;
           case 0xf9:              /* Graphic Control Extension */
                str = "Graphic Control Extension";
-               (void) GetDataBlock( data->base.buffer, (u8*) buf );
+               (void) GetDataBlock( data, (u8*) buf );
                data->disposal    = (buf[0] >> 2) & 0x7;
                data->inputFlag   = (buf[0] >> 1) & 0x1;
                data->delayTime   = LM_to_uint( buf[1], buf[2] );
                if ((buf[0] & 0x1) != 0) {
                     data->transparent = buf[3];
                }
-               while (GetDataBlock( data->base.buffer, (u8*) buf ) != 0)
+               while (GetDataBlock( data, (u8*) buf ) != 0)
                     ;
                return false;
           default:
@@ -450,7 +467,7 @@ static int DoExtension( IDirectFBImageProvider_GIF_data *data, int label )
      if (verbose)
           GIFERRORMSG("got a '%s' extension", str );
 
-     while (GetDataBlock( data->base.buffer, (u8*) buf ) != 0)
+     while (GetDataBlock( data, (u8*) buf ) != 0)
           ;
 
      return false;
@@ -522,7 +539,7 @@ static int LWZReadByte( IDirectFBImageProvider_GIF_data *data, int flag, int inp
                     return -2;
                }
 
-               while ((count = GetDataBlock( data->base.buffer, buf )) > 0)
+               while ((count = GetDataBlock( data, buf )) > 0)
                     ;
 
                if (count != 0)
@@ -631,7 +648,7 @@ static u32* ReadImage( IDirectFBImageProvider_GIF_data *data, int width, int hei
      /*
      **  Initialize the decompression routines
      */
-     if (! ReadOK( data->base.buffer, &c, 1 ))
+     if (! ReadOK( data, &c, 1 ))
           GIFERRORMSG("EOF / read error on image data" );
 
      if (LWZReadByte( data, true, c ) < 0)
@@ -739,7 +756,7 @@ static u32* ReadGIF( IDirectFBImageProvider_GIF_data *data, int imageNumber,
      int   imageCount = 0;
      char  version[4];
 
-     if (! ReadOK( data->base.buffer, buf, 6 )) {
+     if (! ReadOK( data, buf, 6 )) {
           GIFERRORMSG("error reading magic number" );
      }
 
@@ -753,7 +770,7 @@ static u32* ReadGIF( IDirectFBImageProvider_GIF_data *data, int imageNumber,
           GIFERRORMSG("bad version number, not '87a' or '89a'" );
      }
 
-     if (! ReadOK(data->base.buffer,buf,7)) {
+     if (! ReadOK( data, buf,7)) {
           GIFERRORMSG("failed to read screen descriptor" );
      }
 
@@ -765,7 +782,7 @@ static u32* ReadGIF( IDirectFBImageProvider_GIF_data *data, int imageNumber,
      data->AspectRatio     = buf[6];
 
      if (BitSet(buf[4], LOCALCOLORMAP)) {    /* Global Colormap */
-          if (ReadColorMap( data->base.buffer, data->BitPixel, data->ColorMap )) {
+          if (ReadColorMap( data, data->BitPixel, data->ColorMap )) {
                GIFERRORMSG("error reading global colormap" );
           }
      }
@@ -781,7 +798,7 @@ static u32* ReadGIF( IDirectFBImageProvider_GIF_data *data, int imageNumber,
      data->disposal    = 0;
 
      for (;;) {
-          if (! ReadOK( data->base.buffer, &c, 1)) {
+          if (! ReadOK( data, &c, 1)) {
                GIFERRORMSG("EOF / read error on image data" );
           }
 
@@ -794,7 +811,7 @@ static u32* ReadGIF( IDirectFBImageProvider_GIF_data *data, int imageNumber,
           }
 
           if (c == '!') {         /* Extension */
-               if (! ReadOK( data->base.buffer, &c, 1)) {
+               if (! ReadOK( data, &c, 1)) {
                     GIFERRORMSG("OF / read error on extention function code");
                }
                DoExtension( data, c );
@@ -808,7 +825,7 @@ static u32* ReadGIF( IDirectFBImageProvider_GIF_data *data, int imageNumber,
 
           ++imageCount;
 
-          if (! ReadOK( data->base.buffer, buf, 9 )) {
+          if (! ReadOK( data, buf, 9 )) {
                GIFERRORMSG("couldn't read left/top/width/height");
           }
 
@@ -828,7 +845,7 @@ static u32* ReadGIF( IDirectFBImageProvider_GIF_data *data, int imageNumber,
           }
           else {
                bitPixel = 2 << (buf[8] & 0x07);
-               if (ReadColorMap( data->base.buffer, bitPixel, localColorMap ))
+               if (ReadColorMap( data, bitPixel, localColorMap ))
                     GIFERRORMSG("error reading local colormap" );
 
                if (*transparency && (key_rgb || !headeronly))
@@ -853,9 +870,23 @@ static u32* ReadGIF( IDirectFBImageProvider_GIF_data *data, int imageNumber,
 }
 
 static bool
-ReadOK( IDirectFBDataBuffer *buffer, void *data, unsigned int len )
+ReadOK( IDirectFBImageProvider_GIF_data *data, void *buf, unsigned int len )
 {
-     DFBResult ret;
+     DFBResult            ret;
+     IDirectFBDataBuffer *buffer = data->base.buffer;
+
+     if (data->mapped) {
+          if (len > data->mapped_length - data->mapped_pos) {
+               DirectFBError( "(DirectFB/ImageProvider_GIF) GetData failed", DFB_EOF );
+               return false;
+          }
+
+          direct_memcpy( buf, data->mapped + data->mapped_pos, len );
+
+          data->mapped_pos += len;
+
+          return true;
+     }
 
      ret = buffer->WaitForData( buffer, len );
      if (ret) {
@@ -863,7 +894,7 @@ ReadOK( IDirectFBDataBuffer *buffer, void *data, unsigned int len )
           return false;
      }
 
-     ret = buffer->GetData( buffer, len, data, NULL );
+     ret = buffer->GetData( buffer, len, buf, NULL );
      if (ret) {
           DirectFBError( "(DirectFB/ImageProvider_GIF) GetData failed", ret );
           return false;
@@ -70,6 +70,14 @@ static DFBResult
 Construct( IDirectFBImageProvider *thiz,
            ... );
 
+/* SOI marker required by Probe(), to be listed in the interface manifest. */
+static const DirectInterfaceSignature signatures[] = {
+     { 0, "\xff\xd8", 2 },
+     { 0, NULL, 0 }
+};
+
+#define DIRECT_INTERFACE_SIGNATURES signatures
+
 #include <direct/interface_implementation.h>
 
 DIRECT_INTERFACE_IMPLEMENTATION( IDirectFBImageProvider, JPEG )
@@ -88,6 +96,8 @@ typedef struct {
      int                  image_height; /*  height of image data  */
 
      DIRenderFlags        flags;        /*  selected idct method  */
+
+     DFBRectangle         source;       /*  region of interest    */
 } IDirectFBImageProvider_JPEG_data;
 
 
@@ -108,6 +118,10 @@ static DFBResult
 IDirectFBImageProvider_JPEG_SetRenderFlags( IDirectFBImageProvider *thiz,
                                             DIRenderFlags flags );
 
+static DFBResult
+IDirectFBImageProvider_JPEG_SetSourceRectangle( IDirectFBImageProvider *thiz,
+                                                const DFBRectangle     *source_rect );
+
 #define JPEG_PROG_BUF_SIZE    0x10000
 
 typedef struct {
@@ -119,6 +133,9 @@ typedef struct {
 
      int                     peekonly;
      int                     peekoffset;
+
+     const void             *mapped;     /* data of the buffer if accessible directly */
+     unsigned int            mapped_length;
 } buffer_source_mgr;
 
 typedef buffer_source_mgr * buffer_src_ptr;
@@ -130,6 +147,12 @@ buffer_init_source (j_decompress_ptr cinfo)
      IDirectFBDataBuffer *buffer = src->buffer;
 
      buffer->SeekTo( buffer, 0 ); /* ignore return value */
+
+     /* The whole data is available at once, no need to copy it. */
+     if (src->mapped) {
+          src->pub.next_input_byte = src->mapped;
+          src->pub.bytes_in_buffer = src->mapped_length;
+     }
 }
 
 static boolean
@@ -140,15 +163,21 @@ buffer_fill_input_buffer (j_decompress_ptr cinfo)
      buffer_src_ptr       src    = (buffer_src_ptr) cinfo->src;
      IDirectFBDataBuffer *buffer = src->buffer;
 
-     buffer->WaitForDataWithTimeout( buffer, JPEG_PROG_BUF_SIZE, 1, 0 );
-
-     if (src->peekonly) {
-          ret = buffer->PeekData( buffer, JPEG_PROG_BUF_SIZE,
-                                  src->peekoffset, src->data, &nbytes );
-          src->peekoffset += MAX( nbytes, 0 );
+     if (src->mapped) {
+          /* All data has been consumed. */
+          ret = DFB_EOF;
      }
      else {
-          ret = buffer->GetData( buffer, JPEG_PROG_BUF_SIZE, src->data, &nbytes );
+          buffer->WaitForDataWithTimeout( buffer, JPEG_PROG_BUF_SIZE, 1, 0 );
+
+          if (src->peekonly) {
+               ret = buffer->PeekData( buffer, JPEG_PROG_BUF_SIZE,
+                                       src->peekoffset, src->data, &nbytes );
+               src->peekoffset += MAX( nbytes, 0 );
+          }
+          else {
+               ret = buffer->GetData( buffer, JPEG_PROG_BUF_SIZE, src->data, &nbytes );
+          }
      }
 
      if (ret || nbytes <= 0) {
@@ -207,6 +236,9 @@ jpeg_buffer_src (j_decompress_ptr cinfo, IDirectFBDataBuffer *buffer, int peekon
      src->peekonly = peekonly;
      src->peekoffset = 0;
 
+     if (buffer->GetDataPointer( buffer, &src->mapped, &src->mapped_length ))
+          src->mapped = NULL;
+
      src->pub.init_source       = buffer_init_source;
      src->pub.fill_input_buffer = buffer_fill_input_buffer;
      src->pub.skip_input_data   = buffer_skip_input_data;
@@ -382,6 +414,9 @@ Construct( IDirectFBImageProvider *thiz,
 
      data->flags = DIRENDER_NONE;
 
+     data->source.w = data->width;
+     data->source.h = data->height;
+
      jpeg_abort_decompress(&cinfo);
      jpeg_destroy_decompress(&cinfo);
 
@@ -396,6 +431,7 @@ Construct( IDirectFBImageProvider *thiz,
      thiz->RenderTo = IDirectFBImageProvider_JPEG_RenderTo;
      thiz->GetImageDescription =IDirectFBImageProvider_JPEG_GetImageDescription;
      thiz->SetRenderFlags = IDirectFBImageProvider_JPEG_SetRenderFlags;
+     thiz->SetSourceRectangle = IDirectFBImageProvider_JPEG_SetSourceRectangle;
      thiz->GetSurfaceDescription =
      IDirectFBImageProvider_JPEG_GetSurfaceDescription;
 
@@ -462,7 +498,7 @@ IDirectFBImageProvider_JPEG_RenderTo( IDirectFBImageProvider *thiz,
           return ret;
 
      if (data->image &&
-         (rect.x || rect.y || rect.w != data->image_width || rect.h != data->image_height)) {
+         (rect.w != data->image_width || rect.h != data->image_height)) {
            D_FREE( data->image );
            data->image        = NULL;
            data->image_width  = 0;
@@ -478,6 +514,9 @@ IDirectFBImageProvider_JPEG_RenderTo( IDirectFBImageProvider *thiz,
           u32 *row_ptr;
           int y = 0;
           int uv_offset = 0;
+          const DFBRectangle *source = &data->source;
+          DFBRegion  region;      /* source rectangle in output coordinates */
+          JDIMENSION x_offset;    /* start of the region within the output row */
 
           cinfo.err = jpeg_std_error(&jerr.pub);
           jerr.pub.error_exit = jpeglib_panic;
@@ -512,42 +551,36 @@ IDirectFBImageProvider_JPEG_RenderTo( IDirectFBImageProvider *thiz,
           jpeg_read_header( &cinfo, TRUE );
 
 #if JPEG_LIB_VERSION >= 70
-          cinfo.scale_num = 8;
+          /*  The supported scaling ratios in libjpeg 7 and 8
+           *  are N/8 with all N from 1 to 16. Pick the smallest
+           *  one still covering the destination rectangle.
+           */
+          cinfo.scale_num = 1;
           cinfo.scale_denom = 8;
+          while (cinfo.scale_num < 16
+                 && (source->w * cinfo.scale_num < rect.w * 8
+                     || source->h * cinfo.scale_num < rect.h * 8))
+               ++cinfo.scale_num;
 #else
+          /*  The supported scaling ratios in libjpeg 6
+           *  are 1/1, 1/2, 1/4, and 1/8.
+           */
           cinfo.scale_num = 1;
           cinfo.scale_denom = 1;
+          while (cinfo.scale_denom < 8
+                 && source->w / (int) (cinfo.scale_denom * 2) >= rect.w
+                 && source->h / (int) (cinfo.scale_denom * 2) >= rect.h)
+               cinfo.scale_denom <<= 1;
 #endif
           jpeg_calc_output_dimensions( &cinfo );
 
-          if (cinfo.output_width == (unsigned)rect.w && cinfo.output_height == (unsigned)rect.h) {
+          region.x1 =  source->x * cinfo.output_width  / data->width;
+          region.y1 =  source->y * cinfo.output_height / data->height;
+          region.x2 = ((source->x + source->w) * cinfo.output_width  + data->width  - 1) / data->width  - 1;
+          region.y2 = ((source->y + source->h) * cinfo.output_height + data->height - 1) / data->height - 1;
+
+          if (region.x2 - region.x1 + 1 == rect.w && region.y2 - region.y1 + 1 == rect.h)
                direct = true;
-          }
-          else if (rect.x == 0 && rect.y == 0) {
-#if JPEG_LIB_VERSION >= 70
-               /*  The supported scaling ratios in libjpeg 7 and 8
-                *  are N/8 with all N from 1 to 16.
-                */
-               cinfo.scale_num = 1;
-               jpeg_calc_output_dimensions( &cinfo );
-               while (cinfo.scale_num < 16
-                      && cinfo.output_width < (unsigned)rect.w
-                      && cinfo.output_height < (unsigned)rect.h) {
-                    ++cinfo.scale_num;
-                    jpeg_calc_output_dimensions( &cinfo );
-               }
-#else
-               /*  The supported scaling ratios in libjpeg 6
-                *  are 1/1, 1/2, 1/4, and 1/8.
-                */
-               while (cinfo.scale_denom < 8
-                      && ((cinfo.output_width >> 1) >= (unsigned)rect.w)
-                      && ((cinfo.output_height >> 1) >= (unsigned)rect.h)) {
-                    cinfo.scale_denom <<= 1;
-                    jpeg_calc_output_dimensions( &cinfo );
-               }
-#endif
-          }
 
           cinfo.output_components = 3;
 
@@ -586,8 +619,28 @@ IDirectFBImageProvider_JPEG_RenderTo( IDirectFBImageProvider *thiz,
 
           jpeg_start_decompress( &cinfo );
 
-          data->image_width = cinfo.output_width;
-          data->image_height = cinfo.output_height;
+          x_offset = region.x1;
+
+#ifdef LIBJPEG_TURBO_VERSION_NUMBER
+          /* Let libjpeg-turbo skip the iMCU columns and rows outside of the region.
+           * Keep one extra column on each side, fancy upsampling replicates the edge
+           * pixels of the cropped scanline.
+           */
+          if (region.x1 > 0 || region.x2 < (int) cinfo.output_width - 1) {
+               JDIMENSION crop_x = MAX( region.x1 - 1, 0 );
+               JDIMENSION crop_w = MIN( region.x2 + 2, (int) cinfo.output_width ) - crop_x;
+
+               jpeg_crop_scanline( &cinfo, &crop_x, &crop_w );
+
+               x_offset = region.x1 - crop_x;
+          }
+
+          if (region.y1 > 0)
+               jpeg_skip_scanlines( &cinfo, region.y1 );
+#endif
+
+          data->image_width = region.x2 - region.x1 + 1;
+          data->image_height = region.y2 - region.y1 + 1;
 
           row_stride = cinfo.output_width * 3;
 
@@ -601,20 +654,28 @@ IDirectFBImageProvider_JPEG_RenderTo( IDirectFBImageProvider *thiz,
           }
           row_ptr = data->image;
 
-          while (cinfo.output_scanline < cinfo.output_height && cb_result == DIRCR_OK) {
+          while (cinfo.output_scanline <= (JDIMENSION) region.y2 && cb_result == DIRCR_OK) {
+               const u8 *src;
+
                jpeg_read_scanlines( &cinfo, buffer, 1 );
 
+               /* Rows above the region are only decoded if they could not be skipped. */
+               if (cinfo.output_scanline <= (JDIMENSION) region.y1)
+                    continue;
+
+               src = *buffer + x_offset * 3;
+
                switch (dst_surface->config.format) {
                     case DSPF_NV16:
                     case DSPF_UYVY:
                          if (direct) {
                               switch (dst_surface->config.format) {
                                    case DSPF_NV16:
-                                        copy_line_nv16( lock.addr, (u16*)lock.addr + uv_offset, *buffer, rect.w );
+                                        copy_line_nv16( lock.addr, (u16*)lock.addr + uv_offset, src, rect.w );
                                         break;
 
                                    case DSPF_UYVY:
-                                        copy_line_uyvy( lock.addr, *buffer, rect.w );
+                                        copy_line_uyvy( lock.addr, src, rect.w );
                                         break;
 
                                    default:
@@ -633,7 +694,7 @@ IDirectFBImageProvider_JPEG_RenderTo( IDirectFBImageProvider *thiz,
                          }
 
                     default:
-                         copy_line32( row_ptr, *buffer, data->image_width );
+                         copy_line32( row_ptr, src, data->image_width );
 
                          if (direct) {
                               DFBRectangle r = { rect.x, rect.y+y, rect.w, 1 };
@@ -667,6 +728,10 @@ IDirectFBImageProvider_JPEG_RenderTo( IDirectFBImageProvider *thiz,
                D_FREE( data->image );
                data->image = NULL;
           }
+          else if (cinfo.output_scanline < cinfo.output_height) {
+               /* Rows below the region are not needed. */
+               jpeg_abort_decompress( &cinfo );
+          }
           else {
                jpeg_finish_decompress( &cinfo );
           }
@@ -717,6 +782,41 @@ IDirectFBImageProvider_JPEG_SetRenderFlags( IDirectFBImageProvider *thiz,
      return DFB_OK;
 }
 
+static DFBResult
+IDirectFBImageProvider_JPEG_SetSourceRectangle( IDirectFBImageProvider *thiz,
+                                                const DFBRectangle     *source_rect )
+{
+     DFBRectangle rect = { 0, 0, 0, 0 };
+
+     DIRECT_INTERFACE_GET_DATA(IDirectFBImageProvider_JPEG)
+
+     rect.w = data->width;
+     rect.h = data->height;
+
+     if (source_rect) {
+          DFBRectangle image = rect;
+
+          if (source_rect->w < 1 || source_rect->h < 1)
+               return DFB_INVARG;
+
+          rect = *source_rect;
+
+          if (!dfb_rectangle_intersect( &rect, &image ))
+               return DFB_INVAREA;
+     }
+
+     if (!DFB_RECTANGLE_EQUAL( rect, data->source ) && data->image) {
+          D_FREE( data->image );
+          data->image        = NULL;
+          data->image_width  = 0;
+          data->image_height = 0;
+     }
+
+     data->source = rect;
+
+     return DFB_OK;
+}
+
 static DFBResult
 IDirectFBImageProvider_JPEG_GetImageDescription( IDirectFBImageProvider *thiz,
                                                  DFBImageDescription    *dsc )
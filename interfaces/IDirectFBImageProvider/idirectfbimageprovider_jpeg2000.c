@@ -54,6 +54,15 @@ static DFBResult Probe( IDirectFBImageProvider_ProbeContext *ctx );
 static DFBResult Construct( IDirectFBImageProvider *thiz,
                             IDirectFBDataBuffer    *buffer );
 
+/* JP2 file and JPEG 2000 code stream. */
+static const DirectInterfaceSignature signatures[] = {
+     { 0, "\x00\x00\x00\x0C\x6A\x50\x20\x20\x0D\x0A\x87\x0A", 12 },
+     { 0, "\xFF\x4F", 2 },
+     { 0, NULL, 0 }
+};
+
+#define DIRECT_INTERFACE_SIGNATURES signatures
+
 #include <direct/interface_implementation.h>
 
 DIRECT_INTERFACE_IMPLEMENTATION( IDirectFBImageProvider, JPEG2000 )
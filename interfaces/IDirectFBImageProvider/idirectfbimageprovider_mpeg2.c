@@ -66,6 +66,13 @@ static DFBResult
 Construct( IDirectFBImageProvider *thiz,
            ... );
 
+static const DirectInterfaceSignature signatures[] = {
+     { 0, "\x00\x00\x01\xb3", 4 },
+     { 0, NULL, 0 }
+};
+
+#define DIRECT_INTERFACE_SIGNATURES signatures
+
 #include <direct/interface_implementation.h>
 
 DIRECT_INTERFACE_IMPLEMENTATION( IDirectFBImageProvider, MPEG2 )
@@ -84,6 +84,13 @@ static DFBResult
 Construct( IDirectFBImageProvider *thiz,
            ... );
 
+static const DirectInterfaceSignature signatures[] = {
+     { 0, "\x89PNG\r\n\x1a\n", 8 },
+     { 0, NULL, 0 }
+};
+
+#define DIRECT_INTERFACE_SIGNATURES signatures
+
 #include <direct/interface_implementation.h>
 
 DIRECT_INTERFACE_IMPLEMENTATION( IDirectFBImageProvider, PNG )
@@ -121,6 +128,12 @@ typedef struct {
      int                  pitch;
      u32                  palette[256];
      DFBColor             colors[256];
+
+     DFBRectangle         source;      /* region of interest */
+
+     const u8            *mapped;      /* data of the buffer if accessible directly */
+     unsigned int         mapped_length;
+     unsigned int         mapped_pos;
 } IDirectFBImageProvider_PNG_data;
 
 
@@ -137,6 +150,10 @@ static DFBResult
 IDirectFBImageProvider_PNG_GetImageDescription( IDirectFBImageProvider *thiz,
                                                 DFBImageDescription    *dsc );
 
+static DFBResult
+IDirectFBImageProvider_PNG_SetSourceRectangle( IDirectFBImageProvider *thiz,
+                                               const DFBRectangle     *source_rect );
+
 /* Called at the start of the progressive load, once we have image info */
 static void
 png_info_callback (png_structp png_read_ptr,
@@ -159,6 +176,7 @@ png_end_callback  (png_structp png_read_ptr,
 static DFBResult
 push_data_until_stage (IDirectFBImageProvider_PNG_data *data,
                        int                              stage,
+                       int                              rows,
                        int                              buffer_size);
 
 /**********************************************************************************************************************/
@@ -213,6 +231,15 @@ Construct( IDirectFBImageProvider *thiz,
      /* Increase the data buffer reference counter. */
      buffer->AddRef( buffer );
 
+     /* Decode directly from the buffer's data if possible, e.g. a mapped file. */
+     if (buffer->GetDataPointer( buffer, (const void**) &data->mapped, &data->mapped_length ) == DFB_OK &&
+         buffer->GetPosition( buffer, &data->mapped_pos ) == DFB_OK)
+     {
+          D_DEBUG_AT( imageProviderPNG, "  -> using %u bytes of data directly\n", data->mapped_length );
+     }
+     else
+          data->mapped = NULL;
+
      /* Create the PNG read handle. */
      data->png_ptr = png_create_read_struct( PNG_LIBPNG_VER_STRING,
                                              NULL, NULL, NULL );
@@ -237,15 +264,19 @@ Construct( IDirectFBImageProvider *thiz,
 
 
      /* Read until info callback is called. */
-     ret = push_data_until_stage( data, STAGE_INFO, 64 );
+     ret = push_data_until_stage( data, STAGE_INFO, 0, 64 );
      if (ret)
           goto error;
 
+     data->source.w = data->width;
+     data->source.h = data->height;
+
      data->base.Destruct = IDirectFBImageProvider_PNG_Destruct;
 
      thiz->RenderTo              = IDirectFBImageProvider_PNG_RenderTo;
      thiz->GetImageDescription   = IDirectFBImageProvider_PNG_GetImageDescription;
      thiz->GetSurfaceDescription = IDirectFBImageProvider_PNG_GetSurfaceDescription;
+     thiz->SetSourceRectangle    = IDirectFBImageProvider_PNG_SetSourceRectangle;
 
      return DFB_OK;
 
@@ -277,6 +308,9 @@ IDirectFBImageProvider_PNG_RenderTo( IDirectFBImageProvider *thiz,
      DFBRectangle           rect;
      int                    x, y;
      DFBRectangle           clipped;
+     const DFBRectangle    *source;
+     int                    rows = 0;
+     u8                    *image;
 
      DIRECT_INTERFACE_GET_DATA (IDirectFBImageProvider_PNG)
 
@@ -323,9 +357,16 @@ IDirectFBImageProvider_PNG_RenderTo( IDirectFBImageProvider *thiz,
           data->stage = STAGE_ERROR;
      }
 
-     /* Read until image is completely decoded. */
+     source = &data->source;
+
+     /* Rows below the region of interest are not needed, unless the image is interlaced. */
+     if (png_get_interlace_type( data->png_ptr, data->info_ptr ) == PNG_INTERLACE_NONE &&
+         source->y + source->h < data->height)
+          rows = source->y + source->h;
+
+     /* Read until image (or the region of interest) is completely decoded. */
      if (data->stage != STAGE_ERROR) {
-          ret = push_data_until_stage( data, STAGE_END, 16384 );
+          ret = push_data_until_stage( data, STAGE_END, rows, 16384 );
           if (ret)
                return ret;
      }
@@ -374,7 +415,9 @@ IDirectFBImageProvider_PNG_RenderTo( IDirectFBImageProvider *thiz,
                              rect.w == dst_surface->config.size.w  &&
                              rect.h == dst_surface->config.size.h &&
                              rect.w == data->width         &&
-                             rect.h == data->height)
+                             rect.h == data->height        &&
+                             source->w == data->width      &&
+                             source->h == data->height)
                          {
                               for (y = 0; y < data->height; y++)
                                    direct_memcpy( (u8*)lock.addr + lock.pitch * y,
@@ -396,15 +439,17 @@ IDirectFBImageProvider_PNG_RenderTo( IDirectFBImageProvider *thiz,
                          for (x = 0; x < 256; x++)
                               data->palette[x] = 0xff000000 | (x << 16) | (x << 8) | x;
 
-                         dfb_scale_linear_32( data->image, data->width, data->height,
-                                              lock.addr, lock.pitch, &rect, dst_surface, &clip );
+                         image = (u8*)data->image + source->y * data->pitch + source->x * 4;
+
+                         dfb_scale_linear_32_pitch( (u32*) image, source->w, source->h, data->pitch,
+                                                    lock.addr, lock.pitch, &rect, dst_surface, &clip );
                          break;
                     }
 
                     // FIXME: allocates four additional bytes because the scaling functions
                     //        in src/misc/gfx_util.c have an off-by-one bug which causes
                     //        segfaults on darwin/osx (not on linux)
-                    int size = data->width * data->height * 4 + 4;
+                    int size = source->w * source->h * 4 + 4;
 
                     /* allocate image data */
                     void *image_argb = D_MALLOC( size );
@@ -427,54 +472,46 @@ IDirectFBImageProvider_PNG_RenderTo( IDirectFBImageProvider *thiz,
 
                          switch (bit_depth) {
                               case 8:
-                                   for (y = 0; y < data->height; y++) {
-                                        u8  *S = (u8*)data->image + data->pitch * y;
-                                        u32 *D = (u32*)((u8*)image_argb  + data->width * y * 4);
+                                   for (y = 0; y < source->h; y++) {
+                                        u8  *S = (u8*)data->image + data->pitch * (source->y + y);
+                                        u32 *D = (u32*)((u8*)image_argb  + source->w * y * 4);
 
-                                        for (x = 0; x < data->width; x++)
-                                             D[x] = data->palette[ S[x] ];
+                                        for (x = source->x; x < source->x + source->w; x++)
+                                             D[x - source->x] = data->palette[ S[x] ];
                                    }
                                    break;
 
                               case 4:
-                                   for (y = 0; y < data->height; y++) {
-                                        u8  *S = (u8*)data->image + data->pitch * y;
-                                        u32 *D = (u32*)((u8*)image_argb  + data->width * y * 4);
+                                   for (y = 0; y < source->h; y++) {
+                                        u8  *S = (u8*)data->image + data->pitch * (source->y + y);
+                                        u32 *D = (u32*)((u8*)image_argb  + source->w * y * 4);
 
-                                        for (x = 0; x < data->width; x++) {
+                                        for (x = source->x; x < source->x + source->w; x++) {
                                              if (x & 1)
-                                                  D[x] = data->palette[ S[x>>1] & 0xf ];
+                                                  D[x - source->x] = data->palette[ S[x>>1] & 0xf ];
                                              else
-                                                  D[x] = data->palette[ S[x>>1] >> 4 ];
+                                                  D[x - source->x] = data->palette[ S[x>>1] >> 4 ];
                                         }
                                    }
                                    break;
 
                               case 2:
-                                   for (y = 0; y < data->height; y++) {
-                                        int  n = 6;
-                                        u8  *S = (u8*)data->image + data->pitch * y;
-                                        u32 *D = (u32*)((u8*)image_argb  + data->width * y * 4);
-
-                                        for (x = 0; x < data->width; x++) {
-                                             D[x] = data->palette[ (S[x>>2] >> n) & 3 ];
+                                   for (y = 0; y < source->h; y++) {
+                                        u8  *S = (u8*)data->image + data->pitch * (source->y + y);
+                                        u32 *D = (u32*)((u8*)image_argb  + source->w * y * 4);
 
-                                             n = (n ? n - 2 : 6);
-                                        }
+                                        for (x = source->x; x < source->x + source->w; x++)
+                                             D[x - source->x] = data->palette[ (S[x>>2] >> (6 - 2 * (x & 3))) & 3 ];
                                    }
                                    break;
 
                               case 1:
-                                   for (y = 0; y < data->height; y++) {
-                                        int  n = 7;
-                                        u8  *S = (u8*)data->image + data->pitch * y;
-                                        u32 *D = (u32*)((u8*)image_argb  + data->width * y * 4);
+                                   for (y = 0; y < source->h; y++) {
+                                        u8  *S = (u8*)data->image + data->pitch * (source->y + y);
+                                        u32 *D = (u32*)((u8*)image_argb  + source->w * y * 4);
 
-                                        for (x = 0; x < data->width; x++) {
-                                             D[x] = data->palette[ (S[x>>3] >> n) & 1 ];
-
-                                             n = (n ? n - 1 : 7);
-                                        }
+                                        for (x = source->x; x < source->x + source->w; x++)
+                                             D[x - source->x] = data->palette[ (S[x>>3] >> (7 - (x & 7))) & 1 ];
                                    }
                                    break;
 
@@ -483,7 +520,7 @@ IDirectFBImageProvider_PNG_RenderTo( IDirectFBImageProvider *thiz,
                                             bit_depth );
                          }
 
-                         dfb_scale_linear_32( image_argb, data->width, data->height,
+                         dfb_scale_linear_32( image_argb, source->w, source->h,
                                               lock.addr, lock.pitch, &rect, dst_surface, &clip );
 
                          D_FREE( image_argb );
@@ -494,15 +531,17 @@ IDirectFBImageProvider_PNG_RenderTo( IDirectFBImageProvider *thiz,
                     /*
                      * Generic loading code.
                      */
-                    dfb_scale_linear_32( data->image, data->width, data->height,
-                                         lock.addr, lock.pitch, &rect, dst_surface, &clip );
+                    image = (u8*)data->image + source->y * data->pitch + source->x * 4;
+
+                    dfb_scale_linear_32_pitch( (u32*) image, source->w, source->h, data->pitch,
+                                               lock.addr, lock.pitch, &rect, dst_surface, &clip );
                     break;
           }
 
           dfb_surface_unlock_buffer( dst_surface, &lock );
      }
 
-     if (data->stage != STAGE_END)
+     if (data->stage != STAGE_END && (!rows || data->rows < rows))
           ret = DFB_INCOMPLETE;
 
      return ret;
@@ -565,6 +604,38 @@ IDirectFBImageProvider_PNG_GetImageDescription( IDirectFBImageProvider *thiz,
      return DFB_OK;
 }
 
+static DFBResult
+IDirectFBImageProvider_PNG_SetSourceRectangle( IDirectFBImageProvider *thiz,
+                                               const DFBRectangle     *source_rect )
+{
+     DFBRectangle rect = { 0, 0, 0, 0 };
+
+     DIRECT_INTERFACE_GET_DATA (IDirectFBImageProvider_PNG)
+
+     D_DEBUG_AT( imageProviderPNG, "%s(%d)\n", __FUNCTION__, __LINE__ );
+
+     rect.w = data->width;
+     rect.h = data->height;
+
+     if (source_rect) {
+          DFBRectangle image = rect;
+
+          D_DEBUG_AT( imageProviderPNG, "  -> source_rect %4d,%4d-%4dx%4d\n", DFB_RECTANGLE_VALS(source_rect) );
+
+          if (source_rect->w < 1 || source_rect->h < 1)
+               return DFB_INVARG;
+
+          rect = *source_rect;
+
+          if (!dfb_rectangle_intersect( &rect, &image ))
+               return DFB_INVAREA;
+     }
+
+     data->source = rect;
+
+     return DFB_OK;
+}
+
 /**********************************************************************************************************************/
 
 #define MAXCOLORMAPSIZE 256
@@ -1010,22 +1081,43 @@ png_end_callback   (png_structp png_read_ptr,
      data->stage = STAGE_END;
 }
 
-/* Pipes data into libpng until stage is different from the one specified. */
+/* Pipes data into libpng until stage is different from the one specified,
+   or until the given number of rows (if not zero) has been decoded. */
 static DFBResult
 push_data_until_stage (IDirectFBImageProvider_PNG_data *data,
                        int                              stage,
+                       int                              rows,
                        int                              buffer_size)
 {
      DFBResult            ret;
      IDirectFBDataBuffer *buffer = data->base.buffer;
 
-     while (data->stage < stage) {
+     while (data->stage < stage && (!rows || data->rows < rows)) {
           unsigned int  len;
           unsigned char buf[buffer_size];
 
           if (data->stage < 0)
                return DFB_FAILURE;
 
+          if (data->mapped) {
+               if (data->mapped_pos >= data->mapped_length)
+                    return DFB_FAILURE;
+
+               len = MIN( buffer_size, data->mapped_length - data->mapped_pos );
+
+               /* libpng does not write to the data passed in */
+               png_process_data( data->png_ptr, data->info_ptr,
+                                 (png_bytep) data->mapped + data->mapped_pos, len );
+
+               data->mapped_pos += len;
+
+               switch (data->stage) {
+                    case STAGE_ABORT: return DFB_INTERRUPTED;
+                    case STAGE_ERROR: return DFB_FAILURE;
+                    default:          continue;
+               }
+          }
+
           while (buffer->HasData( buffer ) == DFB_OK) {
                D_DEBUG_AT( imageProviderPNG,
                            "Retrieving data (up to %d bytes)...\n",
@@ -1042,7 +1134,7 @@ push_data_until_stage (IDirectFBImageProvider_PNG_data *data,
                D_DEBUG_AT( imageProviderPNG, "  -> processed %d bytes\n", len );
 
                /* are we there yet? */
-               if (data->stage < 0 || data->stage >= stage) {
+               if (data->stage < 0 || data->stage >= stage || (rows && data->rows >= rows)) {
                     switch (data->stage) {
                          case STAGE_ABORT: return DFB_INTERRUPTED;
                          case STAGE_ERROR: return DFB_FAILURE;
@@ -75,6 +75,13 @@ IDirectFBImageProvider_PNM_GetImageDescription( IDirectFBImageProvider *thiz,
                                                 DFBImageDescription    *desc );
 
 
+static const DirectInterfaceSignature signatures[] = {
+     { 0, "P", 1 },
+     { 0, NULL, 0 }
+};
+
+#define DIRECT_INTERFACE_SIGNATURES signatures
+
 #include <direct/interface_implementation.h>
 
 DIRECT_INTERFACE_IMPLEMENTATION( IDirectFBImageProvider, PNM )
@@ -74,6 +74,16 @@ static DFBResult
 Construct( IDirectFBImageProvider *thiz,
            ... );
 
+/* Big and little endian TIFF, little endian MDI. */
+static const DirectInterfaceSignature signatures[] = {
+     { 0, "MM", 2 },
+     { 0, "II", 2 },
+     { 0, "EP", 2 },
+     { 0, NULL, 0 }
+};
+
+#define DIRECT_INTERFACE_SIGNATURES signatures
+
 #include <direct/interface_implementation.h>
 
 DIRECT_INTERFACE_IMPLEMENTATION( IDirectFBImageProvider, TIFF )
@@ -42,9 +42,12 @@
 #include <direct/debug.h>
 #include <direct/interface.h>
 
+#include <core/CoreGraphicsStateClient.h>
+
 #include <display/idirectfbsurface.h>
 
 #include "elements.h"
+#include "raster.h"
 #include "transform.h"
 #include "util.h"
 
@@ -862,7 +865,8 @@ TEST_Render_Triangle( State                    *state,
                triangles[0].y3 = values[5].i;
 
                for (n=1, i=6; i<num_values; n++, i+=2) {
-                    triangles[n].x1 = triangles[n-1].x2;    /* FIXME: correct? */
+                    /* Each triangle shares the last two vertices of the previous one. */
+                    triangles[n].x1 = triangles[n-1].x2;
                     triangles[n].y1 = triangles[n-1].y2;
                     triangles[n].x2 = triangles[n-1].x3;
                     triangles[n].y2 = triangles[n-1].y3;
@@ -1120,29 +1124,198 @@ TEST_Render_Trapezoid_To_Quadrangle( State                    *state,
      return DFB_OK;
 }
 
+/**********************************************************************************************************************
+ ** Paths, using the scanline rasterizer
+ */
+
+static inline float
+PathValue( const WaterElementHeader *header,
+           const WaterScalar        *values,
+           unsigned int              index )
+{
+     if (header->scalar == WST_UNKNOWN)
+          return values[index].i;
+
+     return TEST_SCALAR_TO_FLOAT( values[index], header->scalar );
+}
+
+static inline float
+AttributeValue( const Attribute *attribute )
+{
+     if (attribute->scalar_type == WST_UNKNOWN)
+          return attribute->scalar.i;
+
+     return TEST_SCALAR_TO_FLOAT( attribute->scalar, attribute->scalar_type );
+}
+
+static void
+PathSpans( void                   *ctx,
+           const CoreCoverageSpan *spans,
+           unsigned int            num )
+{
+     State        *state = ctx;
+     unsigned int  i;
+     DFBRectangle  rects[num];
+
+     if (state->attributes[WAT_RENDER_MODE].render_mode & WRM_ANTIALIAS) {
+          CoreGraphicsStateClient_FillCoverageSpans( &state->client, spans, num );
+          return;
+     }
+
+     for (i=0; i<num; i++) {
+          rects[i].x = spans[i].x;
+          rects[i].y = spans[i].y;
+          rects[i].w = spans[i].w;
+          rects[i].h = 1;
+     }
+
+     CoreGraphicsStateClient_FillRectangles( &state->client, rects, num );
+}
+
+static void
+BeginPath( State             *state,
+           WaterElementFlags  flags,
+           RasterPath        *fill,
+           RasterPath        *stroke )
+{
+     float tolerance = (state->attributes[WAT_RENDER_QUALITY_AA].quality == WQL_BEST) ? 0.1f : 0.25f;
+     float width     = AttributeValue( &state->attributes[WAT_LINE_WIDTH] );
+
+     TEST_Raster_Init( fill, &state->attributes[WAT_RENDER_TRANSFORM].transform, tolerance );
+
+     if (flags & WEF_DRAW) {
+          TEST_Raster_Init( stroke, NULL, tolerance );
+
+          fill->stroke      = stroke;
+          fill->half_width  = MAX( width, 1.0f ) * fill->scale / 2.0f;
+          fill->cap         = state->attributes[WAT_LINE_CAPSTYLE].line_cap_style;
+          fill->join        = state->attributes[WAT_LINE_JOINSTYLE].line_join_style;
+          fill->miter_limit = MAX( AttributeValue( &state->attributes[WAT_LINE_MITER] ), 1.0f );
+     }
+}
+
+/*
+ * Fills the area (also if neither flag is set) and draws the outline on top.
+ */
+static DFBResult
+RenderPath( State             *state,
+            WaterElementFlags  flags,
+            RasterPath        *fill,
+            RasterPath        *stroke )
+{
+     DFBResult ret     = DFB_OK;
+     int       samples = 1;
+
+     if (state->attributes[WAT_RENDER_MODE].render_mode & WRM_ANTIALIAS) {
+          switch (state->attributes[WAT_RENDER_QUALITY_AA].quality) {
+               case WQL_FAST:
+                    samples = 4;
+                    break;
+
+               case WQL_BEST:
+                    samples = 16;
+                    break;
+
+               case WQL_OFF:
+                    break;
+
+               default:
+                    samples = 8;
+                    break;
+          }
+     }
+
+     /* Caps of the last sub path are needed before drawing the outline. */
+     TEST_Raster_End( fill );
+
+     D_DEBUG_AT( IWater_TEST_Elem, "  -> %d fill edges, %d samples\n", fill->num_edges, samples );
+
+     if ((flags & WEF_FILL) || !(flags & WEF_DRAW)) {
+          SetWaterColor( state, &state->attributes[WAT_FILL_COLOR].color );
+
+          ret = TEST_Raster_Fill( fill, state->attributes[WAT_FILL_RULE].fill_rule, samples,
+                                  &state->state.clip, PathSpans, state );
+     }
+
+     if (flags & WEF_DRAW) {
+          D_DEBUG_AT( IWater_TEST_Elem, "  -> %d outline edges\n", stroke->num_edges );
+
+          if (!ret) {
+               SetWaterColor( state, &state->attributes[WAT_DRAW_COLOR].color );
+
+               ret = TEST_Raster_Fill( stroke, WFR_NONZERO, samples, &state->state.clip, PathSpans, state );
+          }
+
+          TEST_Raster_Deinit( stroke );
+     }
+
+     TEST_Raster_Deinit( fill );
+
+     return ret;
+}
+
 DFBResult
 TEST_Render_Polygon( State                    *state,
                      const WaterElementHeader *header,
                      const WaterScalar        *values,
                      unsigned int              num_values )
 {
-     int i;
-     WaterElementHeader tri_element;
+     unsigned int i;
+     RasterPath   fill;
+     RasterPath   stroke;
 
      D_DEBUG_AT( IWater_TEST_Elem, "%s( %p [%u] )\n", __FUNCTION__, values, num_values );
 
-     tri_element.type   = WET_TRIANGLE_FAN;
-     tri_element.flags  = header->flags;
-     tri_element.scalar = header->scalar;
+     if (num_values < 6 || (num_values & 1))
+          return DFB_INVARG;
+
+     BeginPath( state, header->flags, &fill, &stroke );
 
-     D_UNIMPLEMENTED();
+     TEST_Raster_MoveTo( &fill, PathValue( header, values, 0 ), PathValue( header, values, 1 ) );
 
-     for (i=0; i<num_values; i+=2)
-          D_DEBUG_AT( IWater_TEST_Elem, "  -> %4d,%4d [%d]\n",
-                      values[i+0].i,
-                      values[i+1].i, i/2 );
+     for (i=2; i<num_values; i+=2)
+          TEST_Raster_LineTo( &fill, PathValue( header, values, i ), PathValue( header, values, i+1 ) );
 
-     return TEST_Render_Triangle( state, &tri_element, values, num_values );
+     TEST_Raster_Close( &fill );
+
+     state->pen_x = PathValue( header, values, 0 );
+     state->pen_y = PathValue( header, values, 1 );
+
+     return RenderPath( state, header->flags, &fill, &stroke );
+}
+
+static DFBResult
+RenderEllipses( State                    *state,
+                const WaterElementHeader *header,
+                const WaterScalar        *values,
+                unsigned int              num_values,
+                unsigned int              per_item )
+{
+     unsigned int i;
+     RasterPath   fill;
+     RasterPath   stroke;
+
+     if (!num_values || num_values % per_item)
+          return DFB_INVARG;
+
+     BeginPath( state, header->flags, &fill, &stroke );
+
+     for (i=0; i<num_values; i+=per_item) {
+          float x  = PathValue( header, values, i+0 );
+          float y  = PathValue( header, values, i+1 );
+          float rx = PathValue( header, values, i+2 );
+          float ry = PathValue( header, values, i + per_item - 1 );
+
+          D_DEBUG_AT( IWater_TEST_Elem, "  -> %8.2f,%8.2f - %8.2f x %8.2f [%u]\n", x, y, rx, ry, i / per_item );
+
+          TEST_Raster_ArcTo( &fill, x, y, rx, ry, 0.0f, 360.0f );
+          TEST_Raster_Close( &fill );
+
+          state->pen_x = x + rx;
+          state->pen_y = y;
+     }
+
+     return RenderPath( state, header->flags, &fill, &stroke );
 }
 
 DFBResult
@@ -1151,34 +1324,159 @@ TEST_Render_Circle( State                    *state,
                     const WaterScalar        *values,
                     unsigned int              num_values )
 {
-     int                i, n;
-     WaterScalar        vals[num_values * 4 / 3];
-     WaterElementHeader temp;
+     D_DEBUG_AT( IWater_TEST_Elem, "%s( %p [%u] )\n", __FUNCTION__, values, num_values );
+
+     return RenderEllipses( state, header, values, num_values, 3 );
+}
 
+DFBResult
+TEST_Render_Ellipse( State                    *state,
+                     const WaterElementHeader *header,
+                     const WaterScalar        *values,
+                     unsigned int              num_values )
+{
      D_DEBUG_AT( IWater_TEST_Elem, "%s( %p [%u] )\n", __FUNCTION__, values, num_values );
 
-     D_UNIMPLEMENTED();
+     return RenderEllipses( state, header, values, num_values, 4 );
+}
 
-     /*
-      * First transformation of a representation: circles to rectangles! (FIXME)
-      */
-     for (n=0, i=0; i<num_values; n+=4, i+=3) {
-          vals[n+0].i = values[i+0].i - values[i+2].i;
-          vals[n+1].i = values[i+1].i - values[i+2].i;
-          vals[n+2].i = values[i+2].i + values[i+2].i;
-          vals[n+3].i = values[i+2].i + values[i+2].i;
+/*
+ * Arcs with start angle 'a' and sweep 'f' in degrees, filled as a pie slice.
+ */
+DFBResult
+TEST_Render_Arc( State                    *state,
+                 const WaterElementHeader *header,
+                 const WaterScalar        *values,
+                 unsigned int              num_values )
+{
+     unsigned int i;
+     unsigned int per_item = (header->type == WET_ARC_CIRCLE) ? 5 : 6;
+     RasterPath   fill;
+     RasterPath   stroke;
+
+     D_DEBUG_AT( IWater_TEST_Elem, "%s( %p [%u] )\n", __FUNCTION__, values, num_values );
+
+     if (!num_values || num_values % per_item)
+          return DFB_INVARG;
+
+     BeginPath( state, header->flags, &fill, &stroke );
+
+     for (i=0; i<num_values; i+=per_item) {
+          float x     = PathValue( header, values, i+0 );
+          float y     = PathValue( header, values, i+1 );
+          float rx    = PathValue( header, values, i+2 );
+          float ry    = PathValue( header, values, i + per_item - 3 );
+          float start = PathValue( header, values, i + per_item - 2 );
+          float sweep = PathValue( header, values, i + per_item - 1 );
+
+          D_DEBUG_AT( IWater_TEST_Elem, "  -> %8.2f,%8.2f - %8.2f x %8.2f, %6.1f %+6.1f [%u]\n",
+                      x, y, rx, ry, start, sweep, i / per_item );
+
+          if (header->flags & WEF_FILL) {
+               TEST_Raster_MoveTo( &fill, x, y );
+               TEST_Raster_ArcTo( &fill, x, y, rx, ry, start, sweep );
+               TEST_Raster_Close( &fill );
+          }
+          else {
+               /* Outline of the arc only, starting a new sub path. */
+               TEST_Raster_Close( &fill );
+               TEST_Raster_ArcTo( &fill, x, y, rx, ry, start, sweep );
+          }
+
+          state->pen_x = x + rx * cosf( (start + sweep) * M_PI / 180.0f );
+          state->pen_y = y + ry * sinf( (start + sweep) * M_PI / 180.0f );
      }
 
-     /*
-      * Generate transformed temporary element
-      */
-     temp.type   = WET_RECTANGLE;
-     temp.flags  = header->flags;
-     temp.scalar = header->scalar;
-
-     /*
-      * Render temporary element
-      */
-     return TEST_Render_Rectangle( state, &temp, vals, num_values * 4 / 3 );
+     return RenderPath( state, header->flags, &fill, &stroke );
+}
+
+/*
+ * Curves start at the end point of the previous path element, strips continue with smooth segments
+ * reflecting the last control point.
+ */
+DFBResult
+TEST_Render_QuadCurve( State                    *state,
+                       const WaterElementHeader *header,
+                       const WaterScalar        *values,
+                       unsigned int              num_values )
+{
+     unsigned int i;
+     RasterPath   fill;
+     RasterPath   stroke;
+
+     D_DEBUG_AT( IWater_TEST_Elem, "%s( %p [%u] )\n", __FUNCTION__, values, num_values );
+
+     if (header->type == WET_QUAD_CURVE_STRIP ? (num_values < 4 || (num_values & 1)) : (!num_values || num_values % 4))
+          return DFB_INVARG;
+
+     BeginPath( state, header->flags, &fill, &stroke );
+
+     TEST_Raster_MoveTo( &fill, state->pen_x, state->pen_y );
+
+     for (i=0; i<num_values; ) {
+          if (i && header->type == WET_QUAD_CURVE_STRIP) {
+               TEST_Raster_SmoothQuadTo( &fill, PathValue( header, values, i ), PathValue( header, values, i+1 ) );
+
+               i += 2;
+          }
+          else {
+               TEST_Raster_QuadTo( &fill, PathValue( header, values, i+0 ), PathValue( header, values, i+1 ),
+                                          PathValue( header, values, i+2 ), PathValue( header, values, i+3 ) );
+
+               i += 4;
+          }
+     }
+
+     if (header->flags & WEF_CLOSE)
+          TEST_Raster_Close( &fill );
+
+     state->pen_x = PathValue( header, values, num_values - 2 );
+     state->pen_y = PathValue( header, values, num_values - 1 );
+
+     return RenderPath( state, header->flags, &fill, &stroke );
+}
+
+DFBResult
+TEST_Render_CubicCurve( State                    *state,
+                        const WaterElementHeader *header,
+                        const WaterScalar        *values,
+                        unsigned int              num_values )
+{
+     unsigned int i;
+     RasterPath   fill;
+     RasterPath   stroke;
+
+     D_DEBUG_AT( IWater_TEST_Elem, "%s( %p [%u] )\n", __FUNCTION__, values, num_values );
+
+     if (header->type == WET_CUBIC_CURVE_STRIP ? (num_values < 6 || (num_values - 6) % 4) : (!num_values || num_values % 6))
+          return DFB_INVARG;
+
+     BeginPath( state, header->flags, &fill, &stroke );
+
+     TEST_Raster_MoveTo( &fill, state->pen_x, state->pen_y );
+
+     for (i=0; i<num_values; ) {
+          if (i && header->type == WET_CUBIC_CURVE_STRIP) {
+               TEST_Raster_SmoothCubicTo( &fill, PathValue( header, values, i+0 ), PathValue( header, values, i+1 ),
+                                                 PathValue( header, values, i+2 ), PathValue( header, values, i+3 ) );
+
+               i += 4;
+          }
+          else {
+               TEST_Raster_CubicTo( &fill, PathValue( header, values, i+0 ), PathValue( header, values, i+1 ),
+                                           PathValue( header, values, i+2 ), PathValue( header, values, i+3 ),
+                                           PathValue( header, values, i+4 ), PathValue( header, values, i+5 ) );
+
+               i += 6;
+          }
+     }
+
+     if (header->flags & WEF_CLOSE)
+          TEST_Raster_Close( &fill );
+
+     state->pen_x = PathValue( header, values, num_values - 2 );
+     state->pen_y = PathValue( header, values, num_values - 1 );
+
+     return RenderPath( state, header->flags, &fill, &stroke );
 }
 
@@ -95,6 +95,26 @@ DFBResult TEST_Render_Circle       ( State                    *state,
                                      const WaterScalar        *values,
                                      unsigned int              num_values );
 
+DFBResult TEST_Render_Ellipse      ( State                    *state,
+                                     const WaterElementHeader *header,
+                                     const WaterScalar        *values,
+                                     unsigned int              num_values );
+
+DFBResult TEST_Render_Arc          ( State                    *state,
+                                     const WaterElementHeader *header,
+                                     const WaterScalar        *values,
+                                     unsigned int              num_values );
+
+DFBResult TEST_Render_QuadCurve    ( State                    *state,
+                                     const WaterElementHeader *header,
+                                     const WaterScalar        *values,
+                                     unsigned int              num_values );
+
+DFBResult TEST_Render_CubicCurve   ( State                    *state,
+                                     const WaterElementHeader *header,
+                                     const WaterScalar        *values,
+                                     unsigned int              num_values );
+
 
 
 
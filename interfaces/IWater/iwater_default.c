@@ -72,9 +72,15 @@ DIRECT_INTERFACE_IMPLEMENTATION( IWater, default )
 static void
 IWater_Destruct( IWater *thiz )
 {
+     IWater_data *data;
+
      D_DEBUG_AT( IWater_default, "%s( %p )\n", __FUNCTION__, thiz );
 
      D_ASSERT( thiz != NULL );
+
+     data = thiz->priv;
+
+     CoreGraphicsStateClient_Deinit( &data->state.client );
 }
 
 static DirectResult
@@ -441,6 +447,20 @@ SetAttribute_32( State                      *state,
      return DFB_OK;
 }
 
+static DFBResult
+SetAttribute_Scalar( State                      *state,
+                     Attribute                  *attribute,
+                     const WaterAttributeHeader *header,
+                     const void                 *value )
+{
+     const WaterScalar *scalar = value;
+
+     attribute->scalar      = *scalar;
+     attribute->scalar_type = header->scalar;
+
+     return DFB_OK;
+}
+
 static DFBResult
 SetAttribute_DFBPoint( State                      *state,
                        Attribute                  *attribute,
@@ -812,7 +832,7 @@ InitState( State   *state,
      state->attributes[WAT_FILL_TRANSFORM].Set         = SetAttribute_Transform;
      state->attributes[WAT_FILL_COLORKEY].Set          = SetAttribute_32;
 
-     state->attributes[WAT_LINE_WIDTH].Set             = SetAttribute_32;
+     state->attributes[WAT_LINE_WIDTH].Set             = SetAttribute_Scalar;
      state->attributes[WAT_LINE_CAPSTYLE].Set          = SetAttribute_32;
      state->attributes[WAT_LINE_JOINSTYLE].Set         = SetAttribute_32;
      state->attributes[WAT_LINE_MITER].Set             = SetAttribute_32;
@@ -829,6 +849,8 @@ InitState( State   *state,
 
 
      dfb_state_init( &state->state, core );
+
+     CoreGraphicsStateClient_Init( &state->client, &state->state );
 }
 
 static void
@@ -845,6 +867,14 @@ InitRender( IWater_data *data )
      data->Render[WATER_ELEMENT_TYPE_INDEX(WET_QUADRANGLE)] = TEST_Render_Quadrangle;
      data->Render[WATER_ELEMENT_TYPE_INDEX(WET_POLYGON)]    = TEST_Render_Polygon;
      data->Render[WATER_ELEMENT_TYPE_INDEX(WET_CIRCLE)]     = TEST_Render_Circle;
+     data->Render[WATER_ELEMENT_TYPE_INDEX(WET_ELLIPSE)]    = TEST_Render_Ellipse;
+
+     data->Render[WATER_ELEMENT_TYPE_INDEX(WET_ARC_CIRCLE)]        = TEST_Render_Arc;
+     data->Render[WATER_ELEMENT_TYPE_INDEX(WET_ARC_ELLIPSE)]       = TEST_Render_Arc;
+     data->Render[WATER_ELEMENT_TYPE_INDEX(WET_QUAD_CURVE)]        = TEST_Render_QuadCurve;
+     data->Render[WATER_ELEMENT_TYPE_INDEX(WET_QUAD_CURVE_STRIP)]  = TEST_Render_QuadCurve;
+     data->Render[WATER_ELEMENT_TYPE_INDEX(WET_CUBIC_CURVE)]       = TEST_Render_CubicCurve;
+     data->Render[WATER_ELEMENT_TYPE_INDEX(WET_CUBIC_CURVE_STRIP)] = TEST_Render_CubicCurve;
 }
 
 /**********************************************************************************************************************/
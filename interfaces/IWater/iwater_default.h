@@ -35,6 +35,7 @@
 #include <directfb.h>
 
 #include <core/coretypes.h>
+#include <core/CoreGraphicsStateClient.h>
 
 
 #define MAX_ATTRIBUTES   256
@@ -75,6 +76,7 @@ struct __Water_Attribute {
           void               *pointer;
      };
 
+     WaterScalarType          scalar_type;     /* of 'scalar', if set by SetAttribute_Scalar() */
 
      SetAttributeHandler      Set;
 };
@@ -84,6 +86,10 @@ struct __Water_State {
 
 
      CardState                state;
+     CoreGraphicsStateClient  client;
+
+     float                    pen_x;           /* end point of the last path element */
+     float                    pen_y;
 };
 
 
@@ -0,0 +1,932 @@
+/*
+   (c) Copyright 2012-2013  DirectFB integrated media GmbH
+   (c) Copyright 2001-2013  The world wide DirectFB Open Source Community (directfb.org)
+   (c) Copyright 2000-2004  Convergence (integrated media) GmbH
+
+   All rights reserved.
+
+   Written by Denis Oliver Kropp <dok@directfb.org>,
+              Andreas Shimokawa <andi@directfb.org>,
+              Marek Pikarski <mass@directfb.org>,
+              Sven Neumann <neo@directfb.org>,
+              Ville Syrjälä <syrjala@sci.fi> and
+              Claudio Ciccani <klan@users.sf.net>.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+
+#include <config.h>
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <directfb.h>
+#include <directfb_water.h>
+
+#include <direct/debug.h>
+#include <direct/mem.h>
+#include <direct/memcpy.h>
+
+#include "raster.h"
+#include "transform.h"
+#include "util.h"
+
+
+D_DEBUG_DOMAIN( IWater_TEST_Raster, "IWater_TEST/Raster", "IWater Interface TEST Rasterizer" );
+
+/**********************************************************************************************************************/
+
+#define RASTER_MAX_STEPS      256
+#define RASTER_SPAN_BATCH     256
+
+static void
+raster_transform( const RasterPath *path,
+                  float             x,
+                  float             y,
+                  float            *ret_x,
+                  float            *ret_y )
+{
+     *ret_x = path->matrix[0] * x + path->matrix[1] * y + path->matrix[2];
+     *ret_y = path->matrix[3] * x + path->matrix[4] * y + path->matrix[5];
+}
+
+static int
+raster_steps( const RasterPath *path,
+              float             distance )
+{
+     int steps = (int) ceilf( sqrtf( distance / path->tolerance ) );
+
+     if (steps < 1)
+          return 1;
+
+     if (steps > RASTER_MAX_STEPS)
+          return RASTER_MAX_STEPS;
+
+     return steps;
+}
+
+static void
+raster_add_edge( RasterPath *path,
+                 float       x1,
+                 float       y1,
+                 float       x2,
+                 float       y2 )
+{
+     RasterEdge *edge;
+
+     /* Transformed coordinates may overflow, edges need finite values for the scan conversion. */
+     if (!isfinite( x1 ) || !isfinite( y1 ) || !isfinite( x2 ) || !isfinite( y2 ))
+          return;
+
+     /* Horizontal edges never cross a sample line. */
+     if (!(y1 < y2) && !(y2 < y1))
+          return;
+
+     if (path->num_edges == path->max_edges) {
+          int         max   = path->max_edges ? path->max_edges * 2 : 64;
+          RasterEdge *edges = D_REALLOC( path->edges, max * sizeof(RasterEdge) );
+
+          if (!edges) {
+               D_OOM();
+               return;
+          }
+
+          path->edges     = edges;
+          path->max_edges = max;
+     }
+
+     edge = &path->edges[path->num_edges++];
+
+     if (y1 < y2) {
+          edge->x1  = x1;
+          edge->y1  = y1;
+          edge->x2  = x2;
+          edge->y2  = y2;
+          edge->dir = 1;
+     }
+     else {
+          edge->x1  = x2;
+          edge->y1  = y2;
+          edge->x2  = x1;
+          edge->y2  = y1;
+          edge->dir = -1;
+     }
+
+     edge->dxdy = (edge->x2 - edge->x1) / (edge->y2 - edge->y1);
+}
+
+/*
+ * Outlines are built from one quadrilateral per segment plus polygons for joins and caps, all with
+ * the same orientation, so that the union is filled by the nonzero rule.
+ */
+static void
+raster_stroke_polygon( RasterPath  *stroke,
+                       const float *points,
+                       int          num )
+{
+     int   i;
+     float area = 0.0f;
+
+     for (i=0; i<num; i++) {
+          int j = (i + 1) % num;
+
+          area += points[i*2] * points[j*2+1] - points[j*2] * points[i*2+1];
+     }
+
+     /* Same orientation as the segment quadrilaterals and discs. */
+     if (area > 0.0f) {
+          for (i=num-1; i>=0; i--) {
+               int j = (i + num - 1) % num;
+
+               raster_add_edge( stroke, points[i*2], points[i*2+1], points[j*2], points[j*2+1] );
+          }
+     }
+     else {
+          for (i=0; i<num; i++) {
+               int j = (i + 1) % num;
+
+               raster_add_edge( stroke, points[i*2], points[i*2+1], points[j*2], points[j*2+1] );
+          }
+     }
+}
+
+static void
+raster_stroke_disc( RasterPath *stroke,
+                    float       x,
+                    float       y,
+                    float       radius )
+{
+     int   i;
+     int   steps = (int) ceilf( M_PI / acosf( 1.0f - MIN( stroke->tolerance / radius, 1.0f ) ) );
+     float px    = x + radius;
+     float py    = y;
+
+     steps = CLAMP( steps, 8, 64 );
+
+     for (i=1; i<=steps; i++) {
+          float a  = - 2.0f * M_PI * i / steps;
+          float nx = (i == steps) ? x + radius : x + radius * cosf( a );
+          float ny = (i == steps) ? y          : y + radius * sinf( a );
+
+          raster_add_edge( stroke, px, py, nx, ny );
+
+          px = nx;
+          py = ny;
+     }
+}
+
+/*
+ * Fills the gap on the outer side of the turn from direction 0 to 1 at (x,y), directions are unit vectors.
+ */
+static void
+raster_stroke_join( RasterPath         *path,
+                    float               x,
+                    float               y,
+                    float               dx0,
+                    float               dy0,
+                    float               dx1,
+                    float               dy1,
+                    WaterLineJoinStyle  join )
+{
+     float hw    = path->half_width;
+     float dot   = dx0 * dx1 + dy0 * dy1;
+     float cross = dx0 * dy1 - dy0 * dx1;
+     float s;
+     float points[8];
+
+     /* Straight continuation. */
+     if (fabsf( cross ) < 1e-6f && dot > 0.0f)
+          return;
+
+     if (join == WLJS_ROUND && hw > 1.0f) {
+          raster_stroke_disc( path->stroke, x, y, hw );
+          return;
+     }
+
+     /* The segment offsets are at +/- (-dy,dx) * hw, the outer one is opposite to the turn. */
+     s = (cross > 0.0f) ? -hw : hw;
+
+     points[0] = x;
+     points[1] = y;
+     points[2] = x - s * dy0;
+     points[3] = y + s * dx0;
+
+     /* Miter length relative to the line width is 1 / cos(angle/2) = sqrt(2 / (1 + dot)). */
+     if (join == WLJS_MITER && dot > -1.0f && 2.0f <= path->miter_limit * path->miter_limit * (1.0f + dot)) {
+          points[4] = x - s * (dy0 + dy1) / (1.0f + dot);
+          points[5] = y + s * (dx0 + dx1) / (1.0f + dot);
+          points[6] = x - s * dy1;
+          points[7] = y + s * dx1;
+
+          raster_stroke_polygon( path->stroke, points, 4 );
+     }
+     else {
+          points[4] = x - s * dy1;
+          points[5] = y + s * dx1;
+
+          raster_stroke_polygon( path->stroke, points, 3 );
+     }
+}
+
+/* Cap at the end (x,y) of a line pointing in the unit direction (dx,dy). */
+static void
+raster_stroke_cap( RasterPath *path,
+                   float       x,
+                   float       y,
+                   float       dx,
+                   float       dy )
+{
+     float hw = path->half_width;
+     float points[8];
+
+     switch (path->cap) {
+          case WLCS_ROUND:
+               raster_stroke_disc( path->stroke, x, y, hw );
+               break;
+
+          case WLCS_SQUARE:
+               points[0] = x - dy * hw;
+               points[1] = y + dx * hw;
+               points[2] = x - dy * hw + dx * hw;
+               points[3] = y + dx * hw + dy * hw;
+               points[4] = x + dy * hw + dx * hw;
+               points[5] = y - dx * hw + dy * hw;
+               points[6] = x + dy * hw;
+               points[7] = y - dx * hw;
+
+               raster_stroke_polygon( path->stroke, points, 4 );
+               break;
+
+          default:
+               /* Butt caps end with the segment. */
+               break;
+     }
+}
+
+/*
+ * 'joint' selects the join style of the path, otherwise the segments of a flattened curve are connected by bevels.
+ */
+static void
+raster_stroke_segment( RasterPath *path,
+                       float       x1,
+                       float       y1,
+                       float       x2,
+                       float       y2,
+                       bool        joint )
+{
+     RasterPath *stroke = path->stroke;
+     float       dx     = x2 - x1;
+     float       dy     = y2 - y1;
+     float       len    = sqrtf( dx * dx + dy * dy );
+     float       nx, ny;
+
+     if (!(len > 0.0f) || !isfinite( len ))
+          return;
+
+     dx /= len;
+     dy /= len;
+
+     nx = - dy * path->half_width;
+     ny =   dx * path->half_width;
+
+     raster_add_edge( stroke, x1 + nx, y1 + ny, x2 + nx, y2 + ny );
+     raster_add_edge( stroke, x2 + nx, y2 + ny, x2 - nx, y2 - ny );
+     raster_add_edge( stroke, x2 - nx, y2 - ny, x1 - nx, y1 - ny );
+     raster_add_edge( stroke, x1 - nx, y1 - ny, x1 + nx, y1 + ny );
+
+     if (path->stroked) {
+          raster_stroke_join( path, x1, y1, path->prev_dx, path->prev_dy, dx, dy, joint ? path->join : WLJS_BEVEL );
+     }
+     else {
+          path->first_dx = dx;
+          path->first_dy = dy;
+          path->stroked  = true;
+     }
+
+     path->prev_dx = dx;
+     path->prev_dy = dy;
+}
+
+/* Adds the caps of an open sub path. */
+static void
+raster_stroke_end( RasterPath *path )
+{
+     if (!path->stroke || !path->stroked)
+          return;
+
+     raster_stroke_cap( path, path->start_x, path->start_y, - path->first_dx, - path->first_dy );
+     raster_stroke_cap( path, path->last_x, path->last_y, path->prev_dx, path->prev_dy );
+
+     path->stroked = false;
+}
+
+/* Device coordinates, 'joint' is false within flattened curves. */
+static void
+raster_line( RasterPath *path,
+             float       x,
+             float       y,
+             bool        joint )
+{
+     raster_add_edge( path, path->last_x, path->last_y, x, y );
+
+     if (path->stroke)
+          raster_stroke_segment( path, path->last_x, path->last_y, x, y, joint );
+
+     path->last_x = x;
+     path->last_y = y;
+     path->ctrl_x = x;
+     path->ctrl_y = y;
+}
+
+static void
+raster_quad( RasterPath *path,
+             float       cx,
+             float       cy,
+             float       x,
+             float       y )
+{
+     int   i, steps;
+     float x0 = path->last_x;
+     float y0 = path->last_y;
+     float ddx = x0 - 2.0f * cx + x;
+     float ddy = y0 - 2.0f * cy + y;
+
+     /* Deviation of the chord is at most |p0 - 2 p1 + p2| / 8 / steps². */
+     steps = raster_steps( path, sqrtf( ddx * ddx + ddy * ddy ) / 8.0f );
+
+     for (i=1; i<=steps; i++) {
+          float t = i / (float) steps;
+          float u = 1.0f - t;
+
+          if (i == steps)
+               raster_line( path, x, y, i == 1 );
+          else
+               raster_line( path,
+                            u * u * x0 + 2.0f * u * t * cx + t * t * x,
+                            u * u * y0 + 2.0f * u * t * cy + t * t * y, i == 1 );
+     }
+
+     path->ctrl_x = cx;
+     path->ctrl_y = cy;
+}
+
+static void
+raster_cubic( RasterPath *path,
+              float       c1x,
+              float       c1y,
+              float       c2x,
+              float       c2y,
+              float       x,
+              float       y )
+{
+     int   i, steps;
+     float x0   = path->last_x;
+     float y0   = path->last_y;
+     float dd1x = x0  - 2.0f * c1x + c2x;
+     float dd1y = y0  - 2.0f * c1y + c2y;
+     float dd2x = c1x - 2.0f * c2x + x;
+     float dd2y = c1y - 2.0f * c2y + y;
+     float dd   = MAX( sqrtf( dd1x * dd1x + dd1y * dd1y ), sqrtf( dd2x * dd2x + dd2y * dd2y ) );
+
+     /* Deviation of the chord is at most 3/4 of the max. second difference / steps². */
+     steps = raster_steps( path, dd * 0.75f );
+
+     for (i=1; i<=steps; i++) {
+          float t = i / (float) steps;
+          float u = 1.0f - t;
+
+          if (i == steps)
+               raster_line( path, x, y, i == 1 );
+          else
+               raster_line( path,
+                            u * u * u * x0 + 3.0f * u * u * t * c1x + 3.0f * u * t * t * c2x + t * t * t * x,
+                            u * u * u * y0 + 3.0f * u * u * t * c1y + 3.0f * u * t * t * c2y + t * t * t * y, i == 1 );
+     }
+
+     path->ctrl_x = c2x;
+     path->ctrl_y = c2y;
+}
+
+/**********************************************************************************************************************/
+
+void
+TEST_Raster_Init( RasterPath           *path,
+                  const WaterTransform *transform,
+                  float                 tolerance )
+{
+     WaterTransform matrix;
+     int            i;
+
+     D_DEBUG_AT( IWater_TEST_Raster, "%s( %p, %p, %f )\n", __FUNCTION__, path, transform, tolerance );
+
+     memset( path, 0, sizeof(RasterPath) );
+
+     path->matrix[0] = 1.0f;
+     path->matrix[4] = 1.0f;
+     path->scale     = 1.0f;
+     path->tolerance = tolerance;
+
+     if (transform && (transform->flags & (WTF_TYPE | WTF_MATRIX))) {
+          matrix = *transform;
+
+          if (matrix.flags & WTF_TYPE)
+               TEST_Transform_TypeToMatrix( &matrix );
+
+          for (i=0; i<6; i++)
+               path->matrix[i] = TEST_SCALAR_TO_FLOAT( matrix.matrix[i], matrix.scalar );
+
+          path->scale = MAX( sqrtf( path->matrix[0] * path->matrix[0] + path->matrix[3] * path->matrix[3] ),
+                             sqrtf( path->matrix[1] * path->matrix[1] + path->matrix[4] * path->matrix[4] ) );
+     }
+}
+
+void
+TEST_Raster_Deinit( RasterPath *path )
+{
+     D_DEBUG_AT( IWater_TEST_Raster, "%s( %p )\n", __FUNCTION__, path );
+
+     if (path->edges)
+          D_FREE( path->edges );
+
+     path->edges     = NULL;
+     path->num_edges = 0;
+     path->max_edges = 0;
+}
+
+void
+TEST_Raster_MoveTo( RasterPath *path,
+                    float       x,
+                    float       y )
+{
+     D_DEBUG_AT( IWater_TEST_Raster, "%s( %p, %.2f, %.2f )\n", __FUNCTION__, path, x, y );
+
+     TEST_Raster_End( path );
+
+     raster_transform( path, x, y, &path->start_x, &path->start_y );
+
+     path->last_x = path->ctrl_x = path->start_x;
+     path->last_y = path->ctrl_y = path->start_y;
+     path->open   = true;
+}
+
+void
+TEST_Raster_LineTo( RasterPath *path,
+                    float       x,
+                    float       y )
+{
+     float dx, dy;
+
+     raster_transform( path, x, y, &dx, &dy );
+
+     raster_line( path, dx, dy, true );
+}
+
+void
+TEST_Raster_QuadTo( RasterPath *path,
+                    float       cx,
+                    float       cy,
+                    float       x,
+                    float       y )
+{
+     float dcx, dcy, dx, dy;
+
+     raster_transform( path, cx, cy, &dcx, &dcy );
+     raster_transform( path, x, y, &dx, &dy );
+
+     raster_quad( path, dcx, dcy, dx, dy );
+}
+
+void
+TEST_Raster_SmoothQuadTo( RasterPath *path,
+                          float       x,
+                          float       y )
+{
+     float dx, dy;
+
+     raster_transform( path, x, y, &dx, &dy );
+
+     raster_quad( path, 2.0f * path->last_x - path->ctrl_x, 2.0f * path->last_y - path->ctrl_y, dx, dy );
+}
+
+void
+TEST_Raster_CubicTo( RasterPath *path,
+                     float       c1x,
+                     float       c1y,
+                     float       c2x,
+                     float       c2y,
+                     float       x,
+                     float       y )
+{
+     float dc1x, dc1y, dc2x, dc2y, dx, dy;
+
+     raster_transform( path, c1x, c1y, &dc1x, &dc1y );
+     raster_transform( path, c2x, c2y, &dc2x, &dc2y );
+     raster_transform( path, x, y, &dx, &dy );
+
+     raster_cubic( path, dc1x, dc1y, dc2x, dc2y, dx, dy );
+}
+
+void
+TEST_Raster_SmoothCubicTo( RasterPath *path,
+                           float       c2x,
+                           float       c2y,
+                           float       x,
+                           float       y )
+{
+     float dc2x, dc2y, dx, dy;
+
+     raster_transform( path, c2x, c2y, &dc2x, &dc2y );
+     raster_transform( path, x, y, &dx, &dy );
+
+     raster_cubic( path, 2.0f * path->last_x - path->ctrl_x, 2.0f * path->last_y - path->ctrl_y, dc2x, dc2y, dx, dy );
+}
+
+void
+TEST_Raster_ArcTo( RasterPath *path,
+                   float       cx,
+                   float       cy,
+                   float       rx,
+                   float       ry,
+                   float       start,
+                   float       sweep )
+{
+     int   i, steps;
+     float radius = MAX( fabsf( rx ), fabsf( ry ) ) * path->scale;
+     float a0     = start * (float) M_PI / 180.0f;
+     float da     = sweep * (float) M_PI / 180.0f;
+
+     D_DEBUG_AT( IWater_TEST_Raster, "%s( %p, %.2f,%.2f - %.2fx%.2f, %.1f %+.1f )\n",
+                 __FUNCTION__, path, cx, cy, rx, ry, start, sweep );
+
+     if (sweep > 360.0f || sweep < -360.0f)
+          da = (sweep > 0) ? 2.0f * M_PI : -2.0f * M_PI;
+
+     /* Segments of angle 2·acos(1 - tol/r) keep the chord within the tolerance. */
+     if (radius > path->tolerance)
+          steps = (int) ceilf( fabsf( da ) / (2.0f * acosf( 1.0f - path->tolerance / radius )) );
+     else
+          steps = 1;
+
+     steps = CLAMP( steps, 1, RASTER_MAX_STEPS );
+
+     if (path->open)
+          TEST_Raster_LineTo( path, cx + rx * cosf( a0 ), cy + ry * sinf( a0 ) );
+     else
+          TEST_Raster_MoveTo( path, cx + rx * cosf( a0 ), cy + ry * sinf( a0 ) );
+
+     for (i=1; i<=steps; i++) {
+          float a = a0 + da * i / steps;
+          float x, y;
+
+          raster_transform( path, cx + rx * cosf( a ), cy + ry * sinf( a ), &x, &y );
+
+          raster_line( path, x, y, i == 1 );
+     }
+}
+
+void
+TEST_Raster_Close( RasterPath *path )
+{
+     D_DEBUG_AT( IWater_TEST_Raster, "%s( %p )\n", __FUNCTION__, path );
+
+     if (!path->open)
+          return;
+
+     if (path->last_x != path->start_x || path->last_y != path->start_y)
+          raster_line( path, path->start_x, path->start_y, true );
+
+     /* Join at the start of the closed path instead of caps. */
+     if (path->stroke && path->stroked) {
+          raster_stroke_join( path, path->start_x, path->start_y,
+                              path->prev_dx, path->prev_dy, path->first_dx, path->first_dy, path->join );
+
+          path->stroked = false;
+     }
+
+     path->open = false;
+}
+
+void
+TEST_Raster_End( RasterPath *path )
+{
+     D_DEBUG_AT( IWater_TEST_Raster, "%s( %p )\n", __FUNCTION__, path );
+
+     if (!path->open)
+          return;
+
+     /* Fill closes the sub path implicitly. */
+     raster_add_edge( path, path->last_x, path->last_y, path->start_x, path->start_y );
+
+     raster_stroke_end( path );
+
+     path->open = false;
+}
+
+/**********************************************************************************************************************/
+
+typedef struct {
+     float x;
+     int   dir;
+} RasterCrossing;
+
+typedef struct {
+     const DFBRegion  *clip;
+     RasterSpansFunc   func;
+     void             *ctx;
+
+     CoreCoverageSpan  spans[RASTER_SPAN_BATCH];
+     unsigned int      num;
+} RasterOutput;
+
+/*
+ * Converts to int within [lo,hi], NaN results in 'lo'. Converting values out of the int range is undefined.
+ */
+static inline int
+raster_to_int( float v,
+               int   lo,
+               int   hi )
+{
+     if (!(v > lo))
+          return lo;
+
+     if (v >= hi)
+          return hi;
+
+     return (int) v;
+}
+
+static int
+raster_compare_edges( const void *a,
+                      const void *b )
+{
+     const RasterEdge *ea = a;
+     const RasterEdge *eb = b;
+
+     if (ea->y1 < eb->y1)
+          return -1;
+
+     if (ea->y1 > eb->y1)
+          return 1;
+
+     return 0;
+}
+
+static inline void
+raster_emit( RasterOutput *out,
+             int           x,
+             int           y,
+             int           w,
+             int           coverage )
+{
+     CoreCoverageSpan *span;
+
+     if (out->num == RASTER_SPAN_BATCH) {
+          out->func( out->ctx, out->spans, out->num );
+          out->num = 0;
+     }
+
+     span = &out->spans[out->num++];
+
+     span->x        = x;
+     span->y        = y;
+     span->w        = w;
+     span->coverage = coverage;
+}
+
+/*
+ * Collects the crossings of the active edges with the sample line at 'y' sorted by x
+ * and returns the number of crossings.
+ */
+static int
+raster_crossings( const RasterEdge *edges,
+                  int              *active,
+                  int              *num_active,
+                  RasterCrossing   *crossings,
+                  float             y )
+{
+     int i, n = 0, num = 0;
+
+     for (i=0; i<*num_active; i++) {
+          const RasterEdge *edge = &edges[active[i]];
+          float             x;
+          int               j;
+
+          if (edge->y2 <= y)
+               continue;
+
+          active[n++] = active[i];
+
+          if (edge->y1 > y)
+               continue;
+
+          x = edge->x1 + (y - edge->y1) * edge->dxdy;
+
+          /* Insertion sort, the list is mostly sorted already. */
+          for (j=num; j>0 && crossings[j-1].x > x; j--)
+               crossings[j] = crossings[j-1];
+
+          crossings[j].x   = x;
+          crossings[j].dir = edge->dir;
+
+          num++;
+     }
+
+     *num_active = n;
+
+     return num;
+}
+
+DFBResult
+TEST_Raster_Fill( RasterPath      *path,
+                  WaterFillRule    rule,
+                  int              samples,
+                  const DFBRegion *clip,
+                  RasterSpansFunc  func,
+                  void            *ctx )
+{
+     int             i, s, py;
+     int             y1, y2;
+     int             next   = 0;
+     int             num_active = 0;
+     int             shift  = 0;
+     int             width  = clip->x2 - clip->x1 + 1;
+     float           ymin, ymax;
+     int            *active;
+     int            *cells  = NULL;
+     RasterCrossing *crossings;
+     RasterOutput    out;
+
+     D_DEBUG_AT( IWater_TEST_Raster, "%s( %p, %d edges, rule %d, %d samples )\n",
+                 __FUNCTION__, path, path->num_edges, rule, samples );
+
+     D_ASSERT( samples == 1 || samples == 4 || samples == 8 || samples == 16 );
+
+     TEST_Raster_End( path );
+
+     if (!path->num_edges || width <= 0)
+          return DFB_OK;
+
+     ymin = path->edges[0].y1;
+     ymax = path->edges[0].y2;
+
+     for (i=1; i<path->num_edges; i++) {
+          ymin = MIN( ymin, path->edges[i].y1 );
+          ymax = MAX( ymax, path->edges[i].y2 );
+     }
+
+     /* Clamped before the conversion, edges may be far outside. */
+     y1 = raster_to_int( floorf( ymin ), clip->y1, clip->y2 + 1 );
+     y2 = raster_to_int( ceilf( ymax ), clip->y1, clip->y2 + 1 ) - 1;
+
+     if (y1 > y2)
+          return DFB_OK;
+
+     qsort( path->edges, path->num_edges, sizeof(RasterEdge), raster_compare_edges );
+
+     active    = D_MALLOC( path->num_edges * (sizeof(int) + sizeof(RasterCrossing)) );
+     if (!active)
+          return D_OOM();
+
+     crossings = (RasterCrossing*)(active + path->num_edges);
+
+     if (samples > 1) {
+          /* Sub pixel coverage per cell, interior runs as start/end deltas. */
+          cells = D_CALLOC( 2 * (width + 2), sizeof(int) );
+          if (!cells) {
+               D_FREE( active );
+               return D_OOM();
+          }
+
+          while ((1 << shift) < samples)
+               shift++;
+     }
+
+     out.clip = clip;
+     out.func = func;
+     out.ctx  = ctx;
+     out.num  = 0;
+
+     for (py = y1; py <= y2; py++) {
+          int  min_x = width;
+          int  max_x = -1;
+          int *delta = cells ? cells + width + 2 : NULL;
+
+          /* Skip rows without any edge. */
+          if (!num_active && next < path->num_edges && path->edges[next].y1 >= py + 1) {
+               py = raster_to_int( floorf( path->edges[next].y1 ), py, y2 + 1 ) - 1;
+               continue;
+          }
+
+          for (s=0; s<samples; s++) {
+               float y = py + (s + 0.5f) / samples;
+               int   num, winding = 0;
+               float start = 0.0f;
+
+               while (next < path->num_edges && path->edges[next].y1 <= y)
+                    active[num_active++] = next++;
+
+               num = raster_crossings( path->edges, active, &num_active, crossings, y );
+
+               for (i=0; i<num; i++) {
+                    bool inside = (rule == WFR_EVENODD) ? (winding & 1) : (winding != 0);
+
+                    winding += crossings[i].dir;
+
+                    if (inside == ((rule == WFR_EVENODD) ? (winding & 1) : (winding != 0)))
+                         continue;
+
+                    if (!inside) {
+                         start = crossings[i].x;
+                         continue;
+                    }
+
+                    if (samples == 1) {
+                         /* Pixels with their center inside. */
+                         int xa = raster_to_int( ceilf( start - 0.5f ), clip->x1, clip->x2 + 1 );
+                         int xb = raster_to_int( ceilf( crossings[i].x - 0.5f ), clip->x1, clip->x2 + 1 );
+
+                         if (xa < xb)
+                              raster_emit( &out, xa, py, xb - xa, 0xff );
+                    }
+                    else {
+                         /* Horizontal coverage in 1/256 pixel. */
+                         int fa = raster_to_int( (start - clip->x1) * 256.0f, 0, width * 256 );
+                         int fb = raster_to_int( (crossings[i].x - clip->x1) * 256.0f, 0, width * 256 );
+                         int ia = fa >> 8;
+                         int ib = fb >> 8;
+
+                         if (fa >= fb)
+                              continue;
+
+                         if (ia == ib)
+                              cells[ia] += fb - fa;
+                         else {
+                              cells[ia]   += 256 - (fa & 0xff);
+                              delta[ia+1] += 256;
+                              delta[ib]   -= 256;
+                              cells[ib]   += fb & 0xff;
+                         }
+
+                         min_x = MIN( min_x, ia );
+                         max_x = MAX( max_x, ib );
+                    }
+               }
+          }
+
+          if (max_x >= 0) {
+               int run      = 0;
+               int span_x   = 0;
+               int span_cov = 0;
+               int x;
+
+               max_x = MIN( max_x, width - 1 );
+
+               for (x = min_x; x <= max_x + 1; x++) {
+                    int cov = 0;
+
+                    if (x <= max_x) {
+                         run += delta[x];
+
+                         /* Full coverage is 256 << shift. */
+                         cov = ((cells[x] + run) * 0xff) >> (8 + shift);
+                    }
+
+                    if (cov != span_cov) {
+                         if (span_cov)
+                              raster_emit( &out, clip->x1 + span_x, py, x - span_x, span_cov );
+
+                         span_x   = x;
+                         span_cov = cov;
+                    }
+               }
+
+               memset( cells + min_x, 0, (width + 1 - min_x) * sizeof(int) );
+               memset( delta + min_x, 0, (width + 1 - min_x) * sizeof(int) );
+          }
+     }
+
+     if (out.num)
+          func( ctx, out.spans, out.num );
+
+     if (cells)
+          D_FREE( cells );
+
+     D_FREE( active );
+
+     return DFB_OK;
+}
@@ -0,0 +1,158 @@
+/*
+   (c) Copyright 2012-2013  DirectFB integrated media GmbH
+   (c) Copyright 2001-2013  The world wide DirectFB Open Source Community (directfb.org)
+   (c) Copyright 2000-2004  Convergence (integrated media) GmbH
+
+   All rights reserved.
+
+   Written by Denis Oliver Kropp <dok@directfb.org>,
+              Andreas Shimokawa <andi@directfb.org>,
+              Marek Pikarski <mass@directfb.org>,
+              Sven Neumann <neo@directfb.org>,
+              Ville Syrjälä <syrjala@sci.fi> and
+              Claudio Ciccani <klan@users.sf.net>.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+
+#ifndef __WATER_TEST__RASTER_H__
+#define __WATER_TEST__RASTER_H__
+
+#include <directfb.h>
+#include <directfb_water.h>
+
+#include <core/gfxcard.h>
+
+
+/*
+ * Scanline rasterizer for paths made of lines, Bézier curves and elliptical arcs.
+ *
+ * Coordinates passed in are transformed to device coordinates, curves are flattened there.
+ * Filling samples each pixel row at one (aliased) or more sub-scanlines with exact horizontal
+ * coverage, resulting in spans of equal coverage.
+ */
+
+typedef struct {
+     float            x1, y1;        /* upper end */
+     float            x2, y2;        /* lower end, y2 > y1 */
+     float            dxdy;
+     int              dir;           /* 1 if the path goes down, -1 if it goes up */
+} RasterEdge;
+
+typedef struct __Water_RasterPath RasterPath;
+
+struct __Water_RasterPath {
+     float            matrix[6];     /* user to device coordinates */
+     float            scale;         /* max. scale of the matrix for estimating flattening steps */
+     float            tolerance;     /* max. distance of flattened curves in device pixels */
+
+     RasterEdge      *edges;
+     int              num_edges;
+     int              max_edges;
+
+     float            start_x, start_y;   /* first point of the sub path in device coordinates */
+     float            last_x, last_y;     /* current point in device coordinates */
+     float            ctrl_x, ctrl_y;     /* last control point for smooth curves */
+     bool             open;
+
+     RasterPath      *stroke;        /* receives the outline of each segment if set */
+     float            half_width;
+     WaterLineCapStyle   cap;
+     WaterLineJoinStyle  join;
+     float            miter_limit;   /* max. ratio of miter length and line width */
+
+     float            first_dx, first_dy; /* unit direction of the first stroked segment of the sub path */
+     float            prev_dx, prev_dy;   /* unit direction of the last stroked segment */
+     bool             stroked;            /* the sub path has a stroked segment */
+};
+
+typedef void (*RasterSpansFunc)( void                   *ctx,
+                                 const CoreCoverageSpan *spans,
+                                 unsigned int            num );
+
+
+void      TEST_Raster_Init         ( RasterPath           *path,
+                                     const WaterTransform *transform,
+                                     float                 tolerance );
+
+void      TEST_Raster_Deinit       ( RasterPath           *path );
+
+void      TEST_Raster_MoveTo       ( RasterPath           *path,
+                                     float                 x,
+                                     float                 y );
+
+void      TEST_Raster_LineTo       ( RasterPath           *path,
+                                     float                 x,
+                                     float                 y );
+
+void      TEST_Raster_QuadTo       ( RasterPath           *path,
+                                     float                 cx,
+                                     float                 cy,
+                                     float                 x,
+                                     float                 y );
+
+/* Control point is the reflection of the previous one */
+void      TEST_Raster_SmoothQuadTo ( RasterPath           *path,
+                                     float                 x,
+                                     float                 y );
+
+void      TEST_Raster_CubicTo      ( RasterPath           *path,
+                                     float                 c1x,
+                                     float                 c1y,
+                                     float                 c2x,
+                                     float                 c2y,
+                                     float                 x,
+                                     float                 y );
+
+/* First control point is the reflection of the previous one */
+void      TEST_Raster_SmoothCubicTo( RasterPath           *path,
+                                     float                 c2x,
+                                     float                 c2y,
+                                     float                 x,
+                                     float                 y );
+
+/*
+ * Connects the current point with the start of the arc, angles are in degrees clockwise (y down).
+ */
+void      TEST_Raster_ArcTo        ( RasterPath           *path,
+                                     float                 cx,
+                                     float                 cy,
+                                     float                 rx,
+                                     float                 ry,
+                                     float                 start,
+                                     float                 sweep );
+
+void      TEST_Raster_Close        ( RasterPath           *path );
+
+/*
+ * Ends the current sub path, adding the caps of an open outline. Called by TEST_Raster_Fill(),
+ * but needs to be called before filling the outline.
+ */
+void      TEST_Raster_End          ( RasterPath           *path );
+
+/*
+ * Open sub paths are closed implicitly (without outline). Samples are the sub-scanlines
+ * per pixel row, 1, 4, 8 or 16, with just one pixel centers are tested for insideness.
+ */
+DFBResult TEST_Raster_Fill         ( RasterPath           *path,
+                                     WaterFillRule         rule,
+                                     int                   samples,
+                                     const DFBRegion      *clip,
+                                     RasterSpansFunc       func,
+                                     void                 *ctx );
+
+#endif
@@ -353,6 +353,15 @@ static inline int _D__atomic_add_return(int i, volatile int *v)
 	 0
 #endif
 
+#define D_SYNC_BOOL_COMPARE_AND_SWAP64( ptr, old_value, new_value )   \
+	 0
+
+#define D_SYNC_FETCH_AND_CLEAR64( ptr )                               \
+	 0
+
+#define D_SYNC_ADD_AND_FETCH64( ptr, value )                          \
+	 0
+
 #else //WIN32
 
 #ifndef D_SYNC_BOOL_COMPARE_AND_SWAP
@@ -387,6 +396,19 @@ static inline int _D__atomic_add_return(int i, volatile int *v)
      do { (void) D_SYNC_ADD_AND_FETCH( ptr, value ); } while (0)
 #endif
 
+/*
+ * 64 bit operations, always the compiler builtins as the assembly versions above are 32 bit only.
+ */
+
+#define D_SYNC_BOOL_COMPARE_AND_SWAP64( ptr, old_value, new_value )   \
+     __sync_bool_compare_and_swap( ptr, old_value, new_value )
+
+#define D_SYNC_FETCH_AND_CLEAR64( ptr )                               \
+     __sync_fetch_and_and( ptr, 0 )
+
+#define D_SYNC_ADD_AND_FETCH64( ptr, value )                          \
+     __sync_add_and_fetch( ptr, value )
+
 #endif //!WIN32
 
 /*
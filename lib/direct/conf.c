@@ -63,6 +63,7 @@ const char   *direct_config_usage =
      "  [no-]nm-for-trace              Enable running nm in a child process to retrieve symbols\n"
      "  log-file=<name>                Write all messages to a file\n"
      "  log-udp=<host>:<port>          Send all messages via UDP to host:port\n"
+     "  log-async[=<kb>]               Queue messages in per thread buffers of <kb> (default 64) written by a thread\n"
      "  fatal-level=<level>            Abort on NONE, ASSERT (default) or ASSUME (incl. assert)\n"
      "  [no-]fatal-break               Abort on BREAK (default)\n"
      "  dont-catch=<num>[[,<num>]...]  Don't catch these signals\n"
@@ -71,14 +72,23 @@ const char   *direct_config_usage =
      "  [no-]thread-block-signals      Block all signals in new threads?\n"
      "  disable-module=<module_name>   suppress loading this module\n"
      "  module-dir=<directory>         Override default module search directory (default = $libdir/directfb-x.y-z)\n"
+     "  module-manifest=<mode>         Use module manifests (default yes), ignore them (no) or rewrite them (update)\n"
      "  thread-priority-scale=<100th>  Apply scaling factor on thread type based priorities\n"
      "  default-interface-implementation=<type/name> Probe interface_type/implementation_name first\n"
+     "  interface-preload=<type>       Load all implementations of an interface type in the background (repeatable)\n"
      "  perf-dump-interval=<ms>        Create thread dumping performance counters every ms milli seconds\n"
+     "  timeline=<events>              Record a timeline of up to <events> per thread, dumped on SIGURG\n"
+     "  timeline-file=<name>           Write the timeline to this file (default /tmp/directfb-timeline-<pid>.json)\n"
+     "  startup-profile[=<file>]       Report wall and CPU time of startup steps to the log or appended to a file\n"
      "  log-delay-rand-loops=<loops>   Add random busy loops (of max loops) to central logging code for testing purpose\n"
      "  log-delay-rand-us=<us>         Add random sleep (of max us) to central logging code for testing purpose\n"
      "  log-delay-min-loops=<loops>    Set minimum busy loops after each log message\n"
      "  log-delay-min-us=<us>          Set minimum sleep after each log message\n"
      "  delay-trap-ms=<ms>             Set period to wait instead of raising\n"
+     "  stream-prefetch=<kb>           Prefetch buffer per HTTP stream in KiB (default 256, 0 = off)\n"
+     "  stream-cache=<directory>       Keep fetched blocks of HTTP streams in this directory\n"
+     "  stream-cache-limit=<kb>        Maximum data cached per HTTP stream in KiB (default 16384)\n"
+     "  stream-cache-size=<kb>         Maximum size of the HTTP stream cache directory in KiB (default 65536)\n"
      "\n";
 
 /**********************************************************************************************************************/
@@ -633,6 +643,62 @@ direct_config_set( const char *name, const char *value )
                return DR_INVARG;
           }
      } else
+     if (direct_strcmp (name, "log-async" ) == 0) {
+          if (value) {
+               unsigned int kb;
+
+               if (direct_sscanf( value, "%u", &kb ) < 1) {
+                    D_ERROR("Direct/Config '%s': Could not parse value!\n", name);
+                    return DR_INVARG;
+               }
+
+               direct_config->log_async = kb;
+          }
+          else
+               direct_config->log_async = 64;
+     } else
+     if (direct_strcmp (name, "timeline" ) == 0) {
+          if (value) {
+               unsigned int events;
+
+               if (direct_sscanf( value, "%u", &events ) < 1) {
+                    D_ERROR("Direct/Config '%s': Could not parse value!\n", name);
+                    return DR_INVARG;
+               }
+
+               direct_config->timeline = events;
+          }
+          else {
+               D_ERROR("Direct/Config '%s': No value specified!\n", name);
+               return DR_INVARG;
+          }
+     } else
+     if (direct_strcmp (name, "timeline-file" ) == 0) {
+          if (value) {
+               if (direct_config->timeline_file)
+                    D_FREE( direct_config->timeline_file );
+
+               direct_config->timeline_file = D_STRDUP( value );
+          }
+          else {
+               D_ERROR("Direct/Config '%s': No file name specified!\n", name);
+               return DR_INVARG;
+          }
+     } else
+     if (direct_strcmp (name, "startup-profile" ) == 0) {
+          if (direct_config->startup_profile_file) {
+               D_FREE( direct_config->startup_profile_file );
+               direct_config->startup_profile_file = NULL;
+          }
+
+          if (value)
+               direct_config->startup_profile_file = D_STRDUP( value );
+
+          direct_config->startup_profile = true;
+     } else
+     if (direct_strcmp (name, "no-startup-profile" ) == 0) {
+          direct_config->startup_profile = false;
+     } else
      if (direct_strcmp (name, "log-delay-rand-loops" ) == 0) {
           if (value) {
                int max;
@@ -721,6 +787,9 @@ direct_config_set( const char *name, const char *value )
                config_option_create( name, value );
      }
 
+     /* Options like "log-none" or "debug" change the level of domains without own configuration. */
+     direct_log_domains_refresh();
+
      return DR_OK;
 }
 
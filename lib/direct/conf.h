@@ -118,6 +118,14 @@ struct __D_DirectConfig {
      int                           delay_trap_ms;
 
      bool                          sighandler_thread;
+
+     unsigned int                  timeline;           /* Events per thread recorded in the timeline, 0 = off */
+     char                         *timeline_file;      /* Timeline dump file */
+
+     bool                          startup_profile;    /* Record and report startup steps */
+     char                         *startup_profile_file; /* Startup report file, log if NULL */
+
+     unsigned int                  log_async;          /* Ring buffer size per thread in KiB for asynchronous logging, 0 = off */
 };
 
 extern DirectConfig DIRECT_API *direct_config;
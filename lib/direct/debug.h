@@ -131,10 +131,11 @@ void DIRECT_API direct_assumption( const char *exp,
      } while (0)
 
 
-// TODO: OPT: check domain etc here to avoid probably expensive parameter generation
+/* Disabled domains are skipped inline, see D_LOG_DOMAIN_SKIP(). */
 #define D_DEBUG_AT(d,...)                                                            \
      do {                                                                            \
-          direct_debug_at( &d, __VA_ARGS__ );                                        \
+          if (!D_LOG_DOMAIN_SKIP( d, DIRECT_LOG_DEBUG ))                             \
+               direct_debug_at( &d, __VA_ARGS__ );                                   \
      } while (0)
 
 #define D_DEBUG_ENTER(d,...)                                                         \
@@ -167,7 +168,7 @@ void DIRECT_API direct_assumption( const char *exp,
      } while (0)
 
 #define D_DEBUG_CHECK(d)                                                             \
-     direct_log_domain_check( &d )
+     (!D_LOG_DOMAIN_SKIP( d, DIRECT_LOG_DEBUG ) && direct_log_domain_check( &d ))
 
 #elif defined(DIRECT_MINI_DEBUG)
 
@@ -185,6 +185,8 @@ direct_initialize()
 
      direct_signals_initialize();
 
+     direct_log_async_initialize();
+
      direct_mutex_unlock( &main_lock );
 
      return DR_OK;
@@ -201,6 +203,8 @@ direct_shutdown()
      if (refs == 1) {
           D_DEBUG_AT( Direct_Main, "...shutting down now.\n" );
 
+          direct_log_async_shutdown();
+
           direct_signals_shutdown();
 
           D_DEBUG_AT( Direct_Main, "  -> done.\n" );
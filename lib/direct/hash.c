@@ -27,11 +27,15 @@
    Free Software Foundation, Inc., 59 Temple Place - Suite 330,
    Boston, MA 02111-1307, USA.
 */
+#include <config.h>
 
+#include <string.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
-#include <config.h>
-
+#include <direct/atomic.h>
 #include <direct/debug.h>
 #include <direct/hash.h>
 #include <direct/mem.h>
@@ -42,86 +46,284 @@ D_LOG_DOMAIN( Direct_Hash, "Direct/Hash", "Hash table implementation" );
 
 /**********************************************************************************************************************/
 
-static const unsigned int primes[] =
-{
-     11,
-     19,
-     37,
-     73,
-     109,
-     163,
-     251,
-     367,
-     557,
-     823,
-     1237,
-     1861,
-     2777,
-     4177,
-     6247,
-     9371,
-     14057,
-     21089,
-     31627,
-     47431,
-     71143,
-     106721,
-     160073,
-     240101,
-     360163,
-     540217,
-     810343,
-     1215497,
-     1823231,
-     2734867,
-     4102283,
-     6153409,
-     9230113,
-     13845163,
+#define DIRECT_HASH_MIN_SIZE 16
+#define DIRECT_HASH_MAX_SIZE (1 << 24)
+
+/* Control bytes, full slots hold the lower seven bits of the hash. */
+#define CTRL_EMPTY           0x80
+#define CTRL_REMOVED         0xfe
+
+#define CTRL_IS_FULL(c)      (!((c) & 0x80))
+
+#if defined(__i386__) || defined(__x86_64__)
+/* Neither loads nor stores are reordered among themselves. */
+#define HASH_BARRIER()       __asm__ __volatile__( "" : : : "memory" )
+#elif defined(__GNUC__)
+#define HASH_BARRIER()       __sync_synchronize()
+#else
+#define HASH_BARRIER()       do {} while (0)
+#endif
+
+struct __D_DirectHashTable {
+     DirectHashTable   *next;        /* in list of retired tables */
+
+     unsigned int       mask;        /* number of slots - 1 */
+
+     DirectHashElement *elements;
+     u8                *ctrl;        /* number of slots + GROUP_WIDTH, the first bytes are mirrored at the end */
 };
 
-static const unsigned int nprimes = D_ARRAY_SIZE( primes );
+/**********************************************************************************************************************/
+
+#if defined(__SSE2__)
+
+#define GROUP_WIDTH 16
 
-static unsigned int
-spaced_primes_closest (unsigned int num)
+typedef unsigned int GroupMask;
+
+static __inline__ GroupMask
+group_match( const u8 *ctrl, u8 tag )
 {
-     unsigned int i;
-     for (i = 0; i < nprimes; i++)
-          if (primes[i] > num)
-               return primes[i];
-     return primes[nprimes - 1];
+     __m128i group = _mm_loadu_si128( (const __m128i*) ctrl );
+
+     return _mm_movemask_epi8( _mm_cmpeq_epi8( group, _mm_set1_epi8( tag ) ) );
 }
 
-#define DIRECT_HASH_MIN_SIZE 11
-#define DIRECT_HASH_MAX_SIZE 13845163
+static __inline__ GroupMask
+group_match_empty( const u8 *ctrl )
+{
+     __m128i group = _mm_loadu_si128( (const __m128i*) ctrl );
+
+     return _mm_movemask_epi8( _mm_cmpeq_epi8( group, _mm_set1_epi8( (char) CTRL_EMPTY ) ) );
+}
+
+static __inline__ GroupMask
+group_match_free( const u8 *ctrl )
+{
+     /* Empty and removed slots have the top bit set. */
+     return _mm_movemask_epi8( _mm_loadu_si128( (const __m128i*) ctrl ) );
+}
+
+#define GROUP_MASK_FIRST(m)  __builtin_ctz( m )
+
+#else
+
+#define GROUP_WIDTH 8
+
+typedef u64 GroupMask;
+
+#define GROUP_LSBS           0x0101010101010101ULL
+#define GROUP_MSBS           0x8080808080808080ULL
+
+static __inline__ u64
+group_load( const u8 *ctrl )
+{
+     u64 group;
+
+     memcpy( &group, ctrl, sizeof(group) );
+
+#ifdef WORDS_BIGENDIAN
+     group = __builtin_bswap64( group );
+#endif
+
+     return group;
+}
+
+static __inline__ GroupMask
+group_match( const u8 *ctrl, u8 tag )
+{
+     u64 group = group_load( ctrl ) ^ (GROUP_LSBS * tag);
+
+     /* May have false positives above a real match, keys are compared anyway. */
+     return (group - GROUP_LSBS) & ~group & GROUP_MSBS;
+}
+
+static __inline__ GroupMask
+group_match_empty( const u8 *ctrl )
+{
+     u64 group = group_load( ctrl );
+
+     /* Top bit set and bit 1 clear. */
+     return group & (~group << 6) & GROUP_MSBS;
+}
+
+static __inline__ GroupMask
+group_match_free( const u8 *ctrl )
+{
+     u64 group = group_load( ctrl );
+
+     /* Top bit set and bit 0 clear. */
+     return group & ~(group << 7) & GROUP_MSBS;
+}
+
+#define GROUP_MASK_FIRST(m)  (__builtin_ctzll( m ) >> 3)
+
+#endif
 
 /**********************************************************************************************************************/
 
+static __inline__ unsigned int
+hash_key( unsigned long key )
+{
+     u64 h = (u64) key * 0x9e3779b97f4a7c15ULL;
+
+     return (unsigned int) (h >> 32) ^ (unsigned int) h;
+}
+
+static __inline__ void
+table_set_ctrl( DirectHashTable *table,
+                unsigned int     index,
+                u8               ctrl )
+{
+     table->ctrl[index] = ctrl;
+     table->ctrl[((index - (GROUP_WIDTH - 1)) & table->mask) + (GROUP_WIDTH - 1)] = ctrl;
+}
+
 static __inline__ int
-locate_key( const DirectHash *hash, unsigned long key )
+table_locate( const DirectHashTable *table,
+              unsigned long          key,
+              unsigned int           h )
 {
-     int                      pos;
-     const DirectHashElement *element;
+     unsigned int pos  = (h >> 7) & table->mask;
+     unsigned int step = 0;
+     u8           tag  = h & 0x7f;
 
-     D_MAGIC_ASSERT( hash, DirectHash );
-     D_ASSERT( hash->size > 0 );
-     D_ASSERT( hash->Elements != NULL );
+     while (true) {
+          GroupMask match = group_match( table->ctrl + pos, tag );
+
+          while (match) {
+               unsigned int index = (pos + GROUP_MASK_FIRST( match )) & table->mask;
+
+               if (table->elements[index].key == key)
+                    return index;
+
+               match &= match - 1;
+          }
+
+          if (group_match_empty( table->ctrl + pos ))
+               return -1;
+
+          step += GROUP_WIDTH;
+          pos   = (pos + step) & table->mask;
+     }
+}
+
+static __inline__ unsigned int
+table_find_free( const DirectHashTable *table,
+                 unsigned int           h )
+{
+     unsigned int pos  = (h >> 7) & table->mask;
+     unsigned int step = 0;
+
+     while (true) {
+          GroupMask match = group_match_free( table->ctrl + pos );
+
+          if (match)
+               return (pos + GROUP_MASK_FIRST( match )) & table->mask;
+
+          step += GROUP_WIDTH;
+          pos   = (pos + step) & table->mask;
+     }
+}
+
+static DirectHashTable *
+table_create( DirectHash   *hash,
+              unsigned int  size )
+{
+     DirectHashTable *table;
+     size_t           bytes = sizeof(DirectHashTable) + size * sizeof(DirectHashElement) + size + GROUP_WIDTH;
+
+     D_ASSERT( size >= DIRECT_HASH_MIN_SIZE );
+     D_ASSERT( !(size & (size - 1)) );
 
-     pos = key % hash->size;
+     if (hash->disable_debugging_alloc)
+          table = direct_malloc( bytes );
+     else
+          table = D_MALLOC( bytes );
 
-     element = &hash->Elements[pos];
+     if (!table)
+          return NULL;
+
+     table->next     = NULL;
+     table->mask     = size - 1;
+     table->elements = (DirectHashElement*) (table + 1);
+     table->ctrl     = (u8*) (table->elements + size);
+
+     memset( table->ctrl, CTRL_EMPTY, size + GROUP_WIDTH );
+
+     return table;
+}
 
-     while (element->value) {
-          if (element->value != DIRECT_HASH_ELEMENT_REMOVED && element->key == key)
-               return pos;
+static void
+table_destroy( DirectHash      *hash,
+               DirectHashTable *table )
+{
+     if (hash->disable_debugging_alloc)
+          direct_free( table );
+     else
+          D_FREE( table );
+}
 
-          if (++pos == hash->size)
-               pos = 0;
+static void
+free_retired( DirectHash *hash )
+{
+     DirectHashTable *table = hash->retired;
+
+     /* Lookups entered before the table was replaced may still use it. */
+     if (!table || D_SYNC_ADD_AND_FETCH( &hash->readers, 0 ))
+          return;
 
-          element = &hash->Elements[pos];
+     while (table) {
+          DirectHashTable *next = table->next;
+
+          table_destroy( hash, table );
+
+          table = next;
      }
 
-     return -1;
+     hash->retired = NULL;
+}
+
+static DirectResult
+resize( DirectHash   *hash,
+        unsigned int  size )
+{
+     unsigned int     i;
+     DirectHashTable *old = hash->table;
+     DirectHashTable *table;
+
+     D_DEBUG_AT( Direct_Hash, "Resizing from %d to %u... (count %d, removed %d)\n",
+                 hash->size, size, hash->count, hash->removed );
+
+     table = table_create( hash, size );
+     if (!table) {
+          D_WARN( "out of memory" );
+          return DR_NOLOCALMEMORY;
+     }
+
+     for (i=0; i<=old->mask; i++) {
+          if (CTRL_IS_FULL( old->ctrl[i] )) {
+               unsigned int h     = hash_key( old->elements[i].key );
+               unsigned int index = table_find_free( table, h );
+
+               table->elements[index] = old->elements[i];
+
+               table_set_ctrl( table, index, h & 0x7f );
+          }
+     }
+
+     /* Publish the new table (the atomic operation implies a full barrier). */
+     D_SYNC_BOOL_COMPARE_AND_SWAP( &hash->table, old, table );
+
+     old->next     = hash->retired;
+     hash->retired = old;
+
+     hash->size    = size;
+     hash->removed = 0;
+
+     free_retired( hash );
+
+     return DR_OK;
 }
 
 /**********************************************************************************************************************/
@@ -165,7 +367,11 @@ direct_hash_init( DirectHash *hash,
      D_DEBUG_AT( Direct_Hash, "Creating hash table with initial capacity of %d...\n", size );
 
      hash->size     = size;
-     hash->Elements = NULL;
+     hash->count    = 0;
+     hash->removed  = 0;
+     hash->table    = NULL;
+     hash->readers  = 0;
+     hash->retired  = NULL;
 
      D_MAGIC_SET( hash, DirectHash );
 }
@@ -174,16 +380,22 @@ void
 direct_hash_deinit( DirectHash *hash )
 {
      D_MAGIC_ASSERT( hash, DirectHash );
+     D_ASSUME( hash->readers == 0 );
 
      D_MAGIC_CLEAR( hash );
 
-     if (hash->Elements) {
-          if (hash->disable_debugging_alloc)
-               direct_free( hash->Elements );
-          else
-               D_FREE( hash->Elements );
+     if (hash->table) {
+          table_destroy( hash, hash->table );
+
+          hash->table = NULL;
+     }
+
+     while (hash->retired) {
+          DirectHashTable *next = hash->retired->next;
+
+          table_destroy( hash, hash->retired );
 
-          hash->Elements = NULL;
+          hash->retired = next;
      }
 }
 
@@ -202,102 +414,83 @@ direct_hash_insert( DirectHash    *hash,
                     unsigned long  key,
                     void          *value )
 {
-     int                pos;
-     DirectHashElement *element;
+     DirectResult     ret;
+     DirectHashTable *table;
+     unsigned int     h;
+     unsigned int     index;
 
      D_MAGIC_ASSERT( hash, DirectHash );
      D_ASSERT( hash->size > 0 );
      D_ASSERT( value != NULL );
 
-     if (!hash->Elements) {
-          if (hash->disable_debugging_alloc)
-               hash->Elements = direct_calloc( hash->size, sizeof(DirectHashElement) );
-          else
-               hash->Elements = D_CALLOC( hash->size, sizeof(DirectHashElement) );
+     if (!hash->table) {
+          unsigned int size = DIRECT_HASH_MIN_SIZE;
 
-          if (!hash->Elements)
-               return D_OOM();
-     }
+          while (size < hash->size && size < DIRECT_HASH_MAX_SIZE)
+               size <<= 1;
 
-     /* Need to resize the hash table? */
-     if ((hash->count + hash->removed) > hash->size / 2) {
-          int                i, size;
-          DirectHashElement *elements;
-
-          size = spaced_primes_closest( hash->size );
-          if (size > DIRECT_HASH_MAX_SIZE)
-               size = DIRECT_HASH_MAX_SIZE;
-          if (size < DIRECT_HASH_MIN_SIZE)
-               size = DIRECT_HASH_MIN_SIZE;
-
-          D_DEBUG_AT( Direct_Hash, "Resizing from %d to %d... (count %d, removed %d)\n",
-                      hash->size, size, hash->count, hash->removed );
-
-          if (hash->disable_debugging_alloc)
-               elements = direct_calloc( size, sizeof(DirectHashElement) );
-          else
-               elements = D_CALLOC( size, sizeof(DirectHashElement) );
-          if (!elements) {
-               D_WARN( "out of memory" );
-               return DR_NOLOCALMEMORY;
-          }
-
-          for (i=0; i<hash->size; i++) {
-               DirectHashElement *element = &hash->Elements[i];
-               DirectHashElement *insertElement;
-
-               if (element->value && element->value != DIRECT_HASH_ELEMENT_REMOVED) {
-                    pos = element->key % size;
+          table = table_create( hash, size );
+          if (!table)
+               return D_OOM();
 
-                    insertElement = &elements[pos];
-                    while (insertElement->value && insertElement->value != DIRECT_HASH_ELEMENT_REMOVED) {
-                        if (++pos == size)
-                            pos = 0;
-                        insertElement = &elements[pos];
-                    }
+          hash->size = size;
 
-                    elements[pos] = *element;
-               }
-          }
+          D_SYNC_BOOL_COMPARE_AND_SWAP( &hash->table, NULL, table );
+     }
 
-          if (hash->disable_debugging_alloc)
-               direct_free( hash->Elements );
-          else
-               D_FREE( hash->Elements );
+     table = hash->table;
+     h     = hash_key( key );
 
-          hash->size     = size;
-          hash->Elements = elements;
-          hash->removed  = 0;
+     if (table_locate( table, key, h ) != -1) {
+          D_BUG( "key already exists" );
+          return DR_BUG;
      }
 
-     pos = key % hash->size;
+     /* Need to resize the hash table? Keep at least one eighth of the slots empty to keep probing short. */
+     if ((hash->count + hash->removed + 1) * 8 > hash->size * 7) {
+          unsigned int size = hash->size;
 
-     D_DEBUG_AT( Direct_Hash, "Attempting to insert key 0x%08lx at position %d...\n", key, pos );
+          /* Grow unless mostly removed slots are to be reclaimed. */
+          if ((hash->count + 1) * 16 > hash->size * 7)
+               size <<= 1;
 
-     element = &hash->Elements[pos];
+          if (size > DIRECT_HASH_MAX_SIZE) {
+               if (hash->count + 1 >= hash->size) {
+                    D_WARN( "maximum size reached" );
+                    return DR_LIMITEXCEEDED;
+               }
 
-     while (element->value && element->value != DIRECT_HASH_ELEMENT_REMOVED) {
-          if (element->key == key) {
-               D_BUG( "key already exists" );
-               return DR_BUG;
+               size = DIRECT_HASH_MAX_SIZE;
           }
 
-          if (++pos == hash->size)
-               pos = 0;
+          ret = resize( hash, size );
+          if (ret)
+               return ret;
 
-          element = &hash->Elements[pos];
+          table = hash->table;
      }
 
-     if (element->value == DIRECT_HASH_ELEMENT_REMOVED)
+     index = table_find_free( table, h );
+
+     D_DEBUG_AT( Direct_Hash, "Inserting key 0x%08lx at position %u...\n", key, index );
+
+     if (table->ctrl[index] == CTRL_REMOVED)
           hash->removed--;
 
-     element->key   = key;
-     element->value = value;
+     /* Key before value, see direct_hash_lookup_lockfree(). */
+     table->elements[index].key = key;
+     HASH_BARRIER();
+     table->elements[index].value = value;
+     HASH_BARRIER();
+
+     table_set_ctrl( table, index, h & 0x7f );
 
      hash->count++;
 
-     D_DEBUG_AT( Direct_Hash, "...inserted at %d, new count = %d, removed = %d, size = %d, key = 0x%08lx.\n",
-                 pos, hash->count, hash->removed, hash->size, key );
+     D_DEBUG_AT( Direct_Hash, "...inserted at %u, new count = %d, removed = %d, size = %d, key = 0x%08lx.\n",
+                 index, hash->count, hash->removed, hash->size, key );
+
+     free_retired( hash );
 
      return DR_OK;
 }
@@ -310,16 +503,17 @@ direct_hash_remove( DirectHash    *hash,
 
      D_MAGIC_ASSERT( hash, DirectHash );
 
-     if (!hash->Elements)
+     if (!hash->table)
           return DR_BUFFEREMPTY;
 
-     pos = locate_key( hash, key );
+     pos = table_locate( hash->table, key, hash_key( key ) );
      if (pos == -1) {
           D_WARN( "key not found" );
           return DR_ITEMNOTFOUND;
      }
 
-     hash->Elements[pos].value = DIRECT_HASH_ELEMENT_REMOVED;
+     /* The element stays intact for lookups already past the control byte. */
+     table_set_ctrl( hash->table, pos, CTRL_REMOVED );
 
      hash->count--;
      hash->removed++;
@@ -327,6 +521,8 @@ direct_hash_remove( DirectHash    *hash,
      D_DEBUG_AT( Direct_Hash, "Removed key 0x%08lx at %d, new count = %d, removed = %d, size = %d.\n",
                  key, pos, hash->count, hash->removed, hash->size );
 
+     free_retired( hash );
+
 //     direct_futex_wake( &hash->count, INT_MAX );  // FIXME: only wake if waiting
 
      return DR_OK;
@@ -340,12 +536,57 @@ direct_hash_lookup( const DirectHash *hash,
 
      D_MAGIC_ASSERT( hash, DirectHash );
 
-     if (!hash->Elements)
+     if (!hash->table)
+          return NULL;
+
+     pos = table_locate( hash->table, key, hash_key( key ) );
+
+     return (pos != -1) ? hash->table->elements[pos].value : NULL;
+}
+
+void *
+direct_hash_lookup_lockfree( const DirectHash *hash,
+                             unsigned long     key )
+{
+     DirectHash      *mutable_hash = (DirectHash*) hash;
+     DirectHashTable *table;
+     unsigned int     h;
+     void            *value = NULL;
+
+     D_MAGIC_ASSERT( hash, DirectHash );
+
+     if (!hash->table)
           return NULL;
 
-     pos = locate_key( hash, key );
+     h = hash_key( key );
+
+     /* Keep the table from being freed by a concurrent resize (the atomic operation implies a full barrier). */
+     D_SYNC_ADD( &mutable_hash->readers, 1 );
+
+     table = hash->table;
+
+     while (true) {
+          int pos = table_locate( table, key, h );
 
-     return (pos != -1) ? hash->Elements[pos].value : NULL;
+          if (pos == -1)
+               break;
+
+          /* The slot might be reused concurrently, the insert writes the key before the value. */
+          HASH_BARRIER();
+
+          value = table->elements[pos].value;
+
+          HASH_BARRIER();
+
+          if (table->elements[pos].key == key)
+               break;
+
+          value = NULL;
+     }
+
+     D_SYNC_ADD( &mutable_hash->readers, -1 );
+
+     return value;
 }
 
 void
@@ -353,21 +594,22 @@ direct_hash_iterate( DirectHash             *hash,
                      DirectHashIteratorFunc  func,
                      void                   *ctx )
 {
-     int i;
+     unsigned int     i;
+     DirectHashTable *table;
 
      D_MAGIC_ASSERT( hash, DirectHash );
 
-     if (!hash->Elements)
+     table = hash->table;
+     if (!table)
           return;
 
-     for (i=0; i<hash->size; i++) {
-          DirectHashElement *element = &hash->Elements[i];
+     for (i=0; i<=table->mask; i++) {
+          DirectHashElement *element = &table->elements[i];
 
-          if (!element->value || element->value == DIRECT_HASH_ELEMENT_REMOVED)
+          if (!CTRL_IS_FULL( table->ctrl[i] ))
                continue;
 
           if (!func( hash, element->key, element->value, ctx ) )
                return;
      }
 }
-
@@ -42,20 +42,30 @@ typedef struct {
      void          *value;
 } DirectHashElement;
 
-#define DIRECT_HASH_ELEMENT_REMOVED  ((void *) -1)
-
+/*
+ * Open addressing with a power of two number of slots and one control byte per slot (empty, removed or seven bits
+ * of the key's hash), probing a group of control bytes at once (SSE2 or eight bytes in a word).
+ *
+ * Insert and remove need to be serialized by the caller, usually also covering direct_hash_lookup(), while
+ * direct_hash_lookup_lockfree() may run concurrently with them. Tables replaced by a resize are only freed
+ * when no lock free lookup is running.
+ */
+typedef struct __D_DirectHashTable DirectHashTable;
 
 struct __D_DirectHash {
      int                 magic;
 
-     int                 size;
+     int                 size;          /* number of slots, initial capacity until the first insert */
 
      int                 count;
      int                 removed;
 
-     DirectHashElement  *Elements;
+     DirectHashTable    *table;
 
      bool                disable_debugging_alloc;
+
+     int                 readers;       /* lookups in progress */
+     DirectHashTable    *retired;       /* replaced tables waiting for readers to leave */
 };
 
 /**********************************************************************************************************************/
@@ -78,8 +88,8 @@ struct __D_DirectHash {
      do {                                                                                                \
           D_MAGIC_ASSERT( hash, DirectHash );                                                            \
           D_ASSERT( (hash)->size > 0 );                                                                  \
-          D_ASSERT( (hash)->Elements != NULL || (hash)->count == 0 );                                    \
-          D_ASSERT( (hash)->Elements != NULL || (hash)->removed == 0 );                                  \
+          D_ASSERT( (hash)->table != NULL || (hash)->count == 0 );                                       \
+          D_ASSERT( (hash)->table != NULL || (hash)->removed == 0 );                                     \
           D_ASSERT( (hash)->count + (hash)->removed < (hash)->size );                                    \
      } while (0)
 
@@ -125,6 +135,12 @@ DirectResult DIRECT_API  direct_hash_remove ( DirectHash             *hash,
 void         DIRECT_API *direct_hash_lookup ( const DirectHash       *hash,
                                               unsigned long           key );
 
+/*
+ * Lookup without holding the lock used for insert and remove, slightly more expensive than direct_hash_lookup().
+ */
+void         DIRECT_API *direct_hash_lookup_lockfree( const DirectHash *hash,
+                                                      unsigned long     key );
+
 void         DIRECT_API  direct_hash_iterate( DirectHash             *hash,
                                               DirectHashIteratorFunc  func,
                                               void                   *ctx );
@@ -41,7 +41,9 @@
 #include <direct/mem.h>
 #include <direct/perf.h>
 #include <direct/result.h>
+#include <direct/startup.h>
 #include <direct/thread.h>
+#include <direct/timeline.h>
 #include <direct/util.h>
 
 
@@ -66,6 +68,8 @@ static Func init_funcs[] = {
      __D_log_init,
      __D_log_domain_init,
      __D_perf_init,
+     __D_timeline_init,
+     __D_startup_init,
      __D_interface_init,
      __D_interface_dbg_init,
      __D_base_init,
@@ -76,6 +80,8 @@ static Func deinit_funcs[] = {
      __D_interface_dbg_deinit,
      __D_interface_deinit,
      __D_log_domain_deinit,
+     __D_startup_deinit,
+     __D_timeline_deinit,
      __D_perf_deinit,
      __D_thread_deinit,
      __D_mem_deinit,
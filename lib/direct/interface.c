@@ -39,7 +39,9 @@
 #include <direct/mem.h>
 #include <direct/memcpy.h>
 #include <direct/messages.h>
+#include <direct/modules.h>
 #include <direct/print.h>
+#include <direct/startup.h>
 #include <direct/thread.h>
 #include <direct/trace.h>
 #include <direct/util.h>
@@ -69,6 +71,17 @@ typedef struct {
 static DirectMutex  implementations_mutex;
 static DirectLink  *implementations;
 
+#if DIRECT_BUILD_DYNLOAD
+typedef struct {
+     DirectLink     link;
+
+     char          *type;
+     DirectThread  *thread;
+} InterfacePreload;
+
+static DirectLink  *preloads;         /* protected by implementations_mutex */
+#endif
+
 void
 __D_interface_init()
 {
@@ -116,6 +129,121 @@ probe_interface( DirectInterfaceImplementation  *impl,
      return 1;
 }
 
+#if DIRECT_BUILD_DYNLOAD
+/*
+ * Returns false if the manifest lists the file as a different implementation than the requested one,
+ * or with signatures not matching the data.
+ */
+static inline bool
+manifest_matches( const DirectModuleManifest *manifest,
+                  const char                 *file,
+                  const char                 *implementation,
+                  const void                 *data,
+                  unsigned int                length )
+{
+     const char *name;
+
+     if (!direct_module_manifest_matches( manifest, file, data, length ))
+          return false;
+
+     if (!implementation)
+          return true;
+
+     name = direct_module_manifest_lookup( manifest, file );
+
+     return !name || !strcmp( name, implementation );
+}
+
+static inline bool
+is_module_file( const char *name )
+{
+     size_t len = strlen( name );
+
+     return len >= 4 && name[len-1] == 'o' && name[len-2] == 's';
+}
+
+/*
+ * Returns the implementation registered by the file, dlopen()ing it if not done yet.
+ * Returns NULL if it can't be loaded or did not register. Called with the implementations lock held.
+ */
+static DirectInterfaceImplementation *
+load_implementation( const char *interface_dir,
+                     const char *type,
+                     const char *file,
+                     const char *reason )
+{
+     DirectLink                    *link;
+     DirectInterfaceImplementation *old_impl = (DirectInterfaceImplementation*) implementations;
+     DirectInterfaceImplementation *impl;
+     void                          *handle;
+     DirectStartupSpan              span;
+     char                           buf[4096];
+
+     direct_snprintf( buf, 4096, "%s/%s", interface_dir, file );
+
+     /* Check if it got already loaded. */
+     direct_list_foreach( link, implementations ) {
+          impl = (DirectInterfaceImplementation*) link;
+
+          if (impl->filename && !strcmp( impl->filename, buf ))
+               return impl;
+     }
+
+     direct_startup_begin( &span );
+
+     handle = dlopen( buf, RTLD_NOW );
+
+     direct_startup_end( &span, "interface", "%s/%s%s", type, file, reason );
+
+     if (!handle) {
+          D_DLERROR( "Direct/Interface: Unable to dlopen `%s'!\n", buf );
+          return NULL;
+     }
+
+     /* Check if it registered itself. */
+     impl = (DirectInterfaceImplementation*) implementations;
+
+     if (old_impl == impl) {
+          dlclose( handle );
+          return NULL;
+     }
+
+     /* Keep filename and module handle. */
+     impl->filename      = D_STRDUP( buf );
+     impl->module_handle = handle;
+
+     return impl;
+}
+
+/*
+ * Formats the signatures of an implementation for the manifest, NULL if there are none.
+ */
+static char *
+format_signatures( const DirectInterfaceSignature *signatures,
+                   char                           *buf,
+                   int                             size )
+{
+     int          len = 0;
+     unsigned int i;
+
+     if (!signatures)
+          return NULL;
+
+     for (; signatures->magic && len < size; signatures++) {
+          len += direct_snprintf( buf + len, size - len, "%s%u:", len ? " " : "", signatures->offset );
+
+          for (i=0; i<signatures->length && len < size; i++)
+               len += direct_snprintf( buf + len, size - len, "%02x", (unsigned char) signatures->magic[i] );
+     }
+
+     /* Rather none than an incomplete list. */
+     if (!len || len >= size)
+          return NULL;
+
+     return buf;
+}
+#endif
+
 /**********************************************************************************************************************/
 
 void
@@ -189,6 +317,18 @@ DirectGetInterface( DirectInterfaceFuncs     **funcs,
                     const char                *implementation,
                     DirectInterfaceProbeFunc   probe,
                     void                      *probe_ctx )
+{
+     return DirectGetInterfaceForData( funcs, type, implementation, probe, probe_ctx, NULL, 0 );
+}
+
+DirectResult
+DirectGetInterfaceForData( DirectInterfaceFuncs     **funcs,
+                           const char                *type,
+                           const char                *implementation,
+                           DirectInterfaceProbeFunc   probe,
+                           void                      *probe_ctx,
+                           const void                *data,
+                           unsigned int               length )
 {
      int                         n   = 0;
      int                         idx = -1;
@@ -200,12 +340,13 @@ DirectGetInterface( DirectInterfaceFuncs     **funcs,
      struct dirent              *entry = NULL;
      struct dirent               tmp;
      const char                 *path;
+     DirectModuleManifest       *manifest = NULL;
 #endif
 
      DirectLink *link;
 
-     D_DEBUG_AT( Direct_Interface, "%s( %p, '%s', '%s', %p, %p )\n", __FUNCTION__,
-                 funcs, type, implementation, probe, probe_ctx );
+     D_DEBUG_AT( Direct_Interface, "%s( %p, '%s', '%s', %p, %p, %p, %u )\n", __FUNCTION__,
+                 funcs, type, implementation, probe, probe_ctx, data, length );
 
      direct_mutex_lock( &implementations_mutex );
 
@@ -300,6 +441,10 @@ DirectGetInterface( DirectInterfaceFuncs     **funcs,
           return errno2result( errno );
      }
 
+     /* Tells the implementation of each file without loading it. */
+     if (direct_module_manifest_use())
+          manifest = direct_module_manifest_load( interface_dir );
+
      if (direct_config->default_interface_implementation_types) {
           n = 0;
 
@@ -318,73 +463,38 @@ DirectGetInterface( DirectInterfaceFuncs     **funcs,
 
                /* Iterate directory. */
                while (idx >= 0 && readdir_r( dir, &tmp, &entry ) == 0 && entry) {
-                    void *handle = NULL;
-                    char  buf[4096];
-
-                    DirectInterfaceImplementation *old_impl = (DirectInterfaceImplementation*) implementations;
-                    DirectInterfaceImplementation *impl = NULL;
+                    DirectInterfaceImplementation *impl;
 
-                    if (strlen(entry->d_name) < 4 ||
-                        entry->d_name[strlen(entry->d_name)-1] != 'o' ||
-                        entry->d_name[strlen(entry->d_name)-2] != 's')
+                    if (!is_module_file( entry->d_name ))
                          continue;
 
-                    direct_snprintf( buf, 4096, "%s/%s", interface_dir, entry->d_name );
-
-                    /* Check if it got already loaded. */
-                    direct_list_foreach( link, implementations ) {
-                         DirectInterfaceImplementation *test_impl = (DirectInterfaceImplementation*) link;
-
-                         if (test_impl->filename && !strcmp( test_impl->filename, buf )) {
-                              impl = test_impl;
-                              handle = impl->module_handle;
-                              break;
-                         }
-                    }
-
                     workaround_func();
 
-                    /* Open it if needed and check. */
-                    if (!handle) {
-                         handle = dlopen( buf, RTLD_NOW );
-
-                         /* Check if it registered itself. */
-                         if (handle) {
-                              impl = (DirectInterfaceImplementation*) implementations;
-
-                              if (old_impl == impl) {
-                                   dlclose( handle );
-                                   continue;
-                              }
+                    /* Skip other implementations known by the manifest. */
+                    if (!manifest_matches( manifest, entry->d_name,
+                                           direct_config->default_interface_implementation_names[idx], data, length ))
+                         continue;
 
-                              /* Keep filename and module handle. */
-                              impl->filename      = D_STRDUP( buf );
-                              impl->module_handle = handle;
-                         }
-                    }
+                    /* Open it if needed and check. */
+                    impl = load_implementation( interface_dir, type, entry->d_name, "" );
+
+                    /* check whether the dlopen'ed interface supports the required implementation */
+                    if (impl && !strcmp( impl->implementation, direct_config->default_interface_implementation_names[idx] ) &&
+                        probe_interface( impl, funcs, type, direct_config->default_interface_implementation_names[idx], probe, probe_ctx ))
+                    {
+                         if (impl->references == 1)
+                              D_INFO( "Direct/Interface: Loaded '%s' implementation of '%s'.\n", 
+                                      impl->implementation, impl->type );
 
-                    if (handle) {
-                         /* check whether the dlopen'ed interface supports the required implementation */
-                         if (!strcmp( impl->implementation, direct_config->default_interface_implementation_names[idx] )) {
-                              if (probe_interface( impl, funcs, type, direct_config->default_interface_implementation_names[idx], probe, probe_ctx )) {
-                                   if (impl->references == 1)
-                                        D_INFO( "Direct/Interface: Loaded '%s' implementation of '%s'.\n", 
-                                                impl->implementation, impl->type );
+                         closedir( dir );
 
-                                   closedir( dir );
+                         if (manifest)
+                              direct_module_manifest_destroy( manifest );
 
-                                   direct_mutex_unlock( &implementations_mutex );
+                         direct_mutex_unlock( &implementations_mutex );
 
-                                   return DR_OK;
-                              }
-                              else
-                                   continue;
-                         }
-                         else
-                              continue;
+                         return DR_OK;
                     }
-                    else
-                         D_DLERROR( "Direct/Interface: Unable to dlopen `%s'!\n", buf );
                }
 
                rewinddir( dir );
@@ -393,76 +503,261 @@ DirectGetInterface( DirectInterfaceFuncs     **funcs,
 
      /* Iterate directory. */
      while (readdir_r( dir, &tmp, &entry ) == 0 && entry) {
-          void *handle = NULL;
-          char  buf[4096];
+          DirectInterfaceImplementation *impl;
 
-          DirectInterfaceImplementation *old_impl = (DirectInterfaceImplementation*) implementations;
-          DirectInterfaceImplementation *impl = NULL;
+          if (!is_module_file( entry->d_name ))
+               continue;
 
-          if (strlen(entry->d_name) < 4 ||
-              entry->d_name[strlen(entry->d_name)-1] != 'o' ||
-              entry->d_name[strlen(entry->d_name)-2] != 's')
+          workaround_func(); // this "fixes" problems with gcc-4.6.3 on x86-64 and x86
+
+          /* Skip other implementations known by the manifest. */
+          if (!manifest_matches( manifest, entry->d_name, implementation, data, length ))
                continue;
 
-          direct_snprintf( buf, 4096, "%s/%s", interface_dir, entry->d_name );
+          /* Open it if needed and check. */
+          impl = load_implementation( interface_dir, type, entry->d_name, "" );
+
+          if (impl && probe_interface( impl, funcs, type, implementation, probe, probe_ctx )) {
+               if (impl->references == 1)
+                    D_INFO( "Direct/Interface: Loaded '%s' implementation of '%s'.\n",
+                            impl->implementation, impl->type );
 
-          /* Check if it got already loaded. */
-          direct_list_foreach( link, implementations ) {
-               DirectInterfaceImplementation *test_impl = (DirectInterfaceImplementation*) link;
+               closedir( dir );
 
-               if (test_impl->filename && !strcmp( test_impl->filename, buf )) {
-                   impl = test_impl;
-                   handle = impl->module_handle;
-                   break;
-               }
+               if (manifest)
+                    direct_module_manifest_destroy( manifest );
+
+               direct_mutex_unlock( &implementations_mutex );
+
+               return DR_OK;
           }
+     }
 
-          workaround_func(); // this "fixes" problems with gcc-4.6.3 on x86-64 and x86
+     closedir( dir );
 
-          /* Open it if needed and check. */
-          if (!handle) {
-               handle = dlopen( buf, RTLD_NOW );
+     if (manifest)
+          direct_module_manifest_destroy( manifest );
+#endif
 
-               /* Check if it registered itself. */
-               if (handle) {
-                    impl = (DirectInterfaceImplementation*) implementations;
+     direct_mutex_unlock( &implementations_mutex );
 
-                    if (old_impl == impl) {
-                         dlclose( handle );
-                         continue;
-                    }
+     return DR_NOIMPL;
+}
 
-                    /* Keep filename and module handle. */
-                    impl->filename      = D_STRDUP( buf );
-                    impl->module_handle = handle;
-               }
-          }
+DirectResult
+DirectUpdateInterfaceManifest( const char *type )
+{
+#if DIRECT_BUILD_DYNLOAD
+     DirectResult          ret;
+     int                   len;
+     DIR                  *dir;
+     char                 *interface_dir;
+     struct dirent        *entry = NULL;
+     struct dirent         tmp;
+     const char           *path;
+     DirectModuleManifest *manifest;
 
-          if (handle) {
-               if (probe_interface( impl, funcs, type, implementation, probe, probe_ctx )) {
-                    if (impl->references == 1)
-                         D_INFO( "Direct/Interface: Loaded '%s' implementation of '%s'.\n",
-                                 impl->implementation, impl->type );
+     D_DEBUG_AT( Direct_Interface, "%s( '%s' )\n", __FUNCTION__, type );
 
-                    closedir( dir );
+     path = direct_config->module_dir;
+     if (!path)
+          path = MODULEDIR;
 
-                    direct_mutex_unlock( &implementations_mutex );
+     /* All types, one directory each. */
+     if (!type) {
+          len = strlen(path) + strlen("/interfaces") + 1;
+          interface_dir = alloca( len );
+          direct_snprintf( interface_dir, len, "%s%sinterfaces", path, (path[strlen(path)-1]=='/') ? "" : "/" );
 
-                    return DR_OK;
-               }
-               else
+          dir = opendir( interface_dir );
+          if (!dir)
+               return errno2result( errno );
+
+          ret = DR_OK;
+
+          while (readdir_r( dir, &tmp, &entry ) == 0 && entry) {
+               if (entry->d_name[0] == '.')
                     continue;
+
+               if (DirectUpdateInterfaceManifest( entry->d_name ) != DR_OK)
+                    ret = DR_FAILURE;
           }
-          else
-               D_DLERROR( "Direct/Interface: Unable to dlopen `%s'!\n", buf );
+
+          closedir( dir );
+
+          return ret;
+     }
+
+     len = strlen(path) + strlen("/interfaces/") + strlen(type) + 1;
+     interface_dir = alloca( len );
+     direct_snprintf( interface_dir, len, "%s%sinterfaces/%s", path, (path[strlen(path)-1]=='/') ? "" : "/", type );
+
+     dir = opendir( interface_dir );
+     if (!dir)
+          return errno2result( errno );
+
+     manifest = direct_module_manifest_create();
+     if (!manifest) {
+          closedir( dir );
+          return DR_NOLOCALMEMORY;
      }
 
+     direct_mutex_lock( &implementations_mutex );
+
+     /* Load every implementation to find out its name and signatures. */
+     while (readdir_r( dir, &tmp, &entry ) == 0 && entry) {
+          DirectInterfaceImplementation *impl;
+          char                           signatures[512];
+
+          if (!is_module_file( entry->d_name ))
+               continue;
+
+          impl = load_implementation( interface_dir, type, entry->d_name, "" );
+          if (!impl)
+               continue;
+
+          direct_module_manifest_add( manifest, entry->d_name, impl->implementation,
+                                      format_signatures( impl->funcs->Signatures, signatures, sizeof(signatures) ) );
+     }
+
+     direct_mutex_unlock( &implementations_mutex );
+
      closedir( dir );
+
+     ret = direct_module_manifest_save( manifest, interface_dir );
+     if (ret == DR_OK)
+          D_INFO( "Direct/Interface: Updated manifest of '%s'\n", interface_dir );
+
+     direct_module_manifest_destroy( manifest );
+
+     return ret;
+#else
+     return DR_UNSUPPORTED;
 #endif
+}
+
+#if DIRECT_BUILD_DYNLOAD
+static void *
+preload_loop( DirectThread *thread,
+              void         *arg )
+{
+     InterfacePreload *preload = arg;
+     int               len;
+     DIR              *dir;
+     char             *interface_dir;
+     struct dirent    *entry = NULL;
+     struct dirent     tmp;
+     const char       *path;
+
+     D_DEBUG_AT( Direct_Interface, "%s( '%s' )\n", __FUNCTION__, preload->type );
+
+     path = direct_config->module_dir;
+     if (!path)
+          path = MODULEDIR;
+
+     len = strlen(path) + strlen("/interfaces/") + strlen(preload->type) + 1;
+     interface_dir = alloca( len );
+     direct_snprintf( interface_dir, len, "%s%sinterfaces/%s", path, (path[strlen(path)-1]=='/') ? "" : "/", preload->type );
+
+     dir = opendir( interface_dir );
+     if (!dir) {
+          D_DEBUG_LOG( Direct_Interface, 1, "Could not open interface directory '%s'!\n", interface_dir );
+          return NULL;
+     }
+
+     while (readdir_r( dir, &tmp, &entry ) == 0 && entry) {
+          if (!is_module_file( entry->d_name ))
+               continue;
+
+          /* Only one file is loaded with the lock held, DirectGetInterface() waits for no more than that. */
+          direct_mutex_lock( &implementations_mutex );
+
+          load_implementation( interface_dir, preload->type, entry->d_name, " (preload)" );
+
+          direct_mutex_unlock( &implementations_mutex );
+     }
+
+     closedir( dir );
+
+     D_DEBUG_AT( Direct_Interface, "  -> preloading '%s' done\n", preload->type );
+
+     return NULL;
+}
+#endif
+
+void
+DirectPreloadInterfaces( const char *type )
+{
+#if DIRECT_BUILD_DYNLOAD
+     InterfacePreload *preload;
+
+     D_ASSERT( type != NULL );
+
+     D_DEBUG_AT( Direct_Interface, "%s( '%s' )\n", __FUNCTION__, type );
+
+     direct_mutex_lock( &implementations_mutex );
+
+     direct_list_foreach (preload, preloads) {
+          if (!strcmp( preload->type, type )) {
+               direct_mutex_unlock( &implementations_mutex );
+               return;
+          }
+     }
+
+     preload = D_CALLOC( 1, sizeof(InterfacePreload) );
+     if (!preload) {
+          D_OOM();
+          direct_mutex_unlock( &implementations_mutex );
+          return;
+     }
+
+     preload->type = D_STRDUP( type );
+     if (!preload->type) {
+          D_OOM();
+          D_FREE( preload );
+          direct_mutex_unlock( &implementations_mutex );
+          return;
+     }
+
+     preload->thread = direct_thread_create( DTT_DEFAULT, preload_loop, preload, "Interface Preload" );
+     if (!preload->thread) {
+          D_FREE( preload->type );
+          D_FREE( preload );
+          direct_mutex_unlock( &implementations_mutex );
+          return;
+     }
+
+     direct_list_append( &preloads, &preload->link );
 
      direct_mutex_unlock( &implementations_mutex );
+#endif
+}
 
-     return DR_NOIMPL;
+void
+DirectPreloadInterfacesWait( void )
+{
+#if DIRECT_BUILD_DYNLOAD
+     DirectLink       *list;
+     InterfacePreload *preload, *next;
+
+     D_DEBUG_AT( Direct_Interface, "%s()\n", __FUNCTION__ );
+
+     /* The threads need the lock, so take the list and join them without it. */
+     direct_mutex_lock( &implementations_mutex );
+
+     list     = preloads;
+     preloads = NULL;
+
+     direct_mutex_unlock( &implementations_mutex );
+
+     direct_list_foreach_safe (preload, next, list) {
+          direct_thread_join( preload->thread );
+          direct_thread_destroy( preload->thread );
+
+          D_FREE( preload->type );
+          D_FREE( preload );
+     }
+#endif
 }
 
 /**************************************************************************************************/
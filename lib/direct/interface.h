@@ -89,6 +89,15 @@ typedef DirectResult (*DirectInterfaceGenericProbeFunc)( void *ctx, ... );
  */
 typedef DirectResult (*DirectInterfaceGenericConstructFunc)( void *interface_ptr, ... );
 
+/*
+ * Probe signature of an implementation, 'length' bytes of 'magic' at 'offset' of the probed data
+ */
+typedef struct {
+     unsigned int   offset;
+     const char    *magic;
+     unsigned int   length;
+} DirectInterfaceSignature;
+
 /*
  * Function table for interface implementations
  */
@@ -100,6 +109,9 @@ typedef struct {
      
      DirectInterfaceGenericProbeFunc     Probe;
      DirectInterfaceGenericConstructFunc Construct;
+
+     const DirectInterfaceSignature     *Signatures;  /* Probe() only accepts data matching one of them,
+                                                          terminated by a NULL magic, NULL if unknown */
 } DirectInterfaceFuncs;
 
 /*
@@ -120,6 +132,18 @@ DirectResult DIRECT_API DirectGetInterface( DirectInterfaceFuncs     **funcs,
                                             DirectInterfaceProbeFunc   probe,
                                             void                      *probe_ctx );
 
+/*
+ * Like DirectGetInterface(), with the first bytes of the data to be probed.
+ * Implementations whose signatures in the manifest don't match the data are not loaded.
+ */
+DirectResult DIRECT_API DirectGetInterfaceForData( DirectInterfaceFuncs     **funcs,
+                                                   const char                *type,
+                                                   const char                *implementation,
+                                                   DirectInterfaceProbeFunc   probe,
+                                                   void                      *probe_ctx,
+                                                   const void                *data,
+                                                   unsigned int               length );
+
 /*
  * Default probe function. Calls "funcs->Probe(ctx)".
  * Can be used as the 'probe' argument to DirectGetInterface.
@@ -127,6 +151,23 @@ DirectResult DIRECT_API DirectGetInterface( DirectInterfaceFuncs     **funcs,
  */
 DirectResult DIRECT_API DirectProbeInterface( DirectInterfaceFuncs *funcs, void *ctx );
 
+/*
+ * Loads all implementations of an interface type, or of all types if NULL, and writes the
+ * manifest of its module directory (see direct/modules.h), including their signatures.
+ * DirectGetInterface() then only loads the file listed for a requested implementation,
+ * DirectGetInterfaceForData() only those with matching signatures.
+ */
+DirectResult DIRECT_API DirectUpdateInterfaceManifest( const char *type );
+
+/*
+ * Loads all implementations of an interface type in a background thread, so that probing
+ * without an implementation finds them loaded already instead of dlopen()ing each file in turn.
+ * DirectPreloadInterfacesWait() joins all threads started so far.
+ */
+void         DIRECT_API DirectPreloadInterfaces( const char *type );
+
+void         DIRECT_API DirectPreloadInterfacesWait( void );
+
 /*
  * Called by implementation modules during 'dlopen'ing or at startup if linked
  * into the executable.
@@ -43,6 +43,13 @@ static DirectResult  Deallocate( void *interface_ptr );
 //static DirectResult  Probe( void *ctx, ... );
 //static DirectResult  Construct( void *interface, ... );
 
+/*
+ * Define to an array of DirectInterfaceSignature before including this file, if Probe() only checks magic bytes.
+ */
+#ifndef DIRECT_INTERFACE_SIGNATURES
+#define DIRECT_INTERFACE_SIGNATURES NULL
+#endif
+
 
 static DirectInterfaceFuncs interface_funcs = {
      /* GetType */            GetType,
@@ -50,7 +57,8 @@ static DirectInterfaceFuncs interface_funcs = {
      /* Allocate */           Allocate,
      /* Deallocate */         Deallocate,
      /* Probe */              (void*) Probe,    //FIXME
-     /* Construct */          (void*) Construct //FIXME
+     /* Construct */          (void*) Construct,//FIXME
+     /* Signatures */         DIRECT_INTERFACE_SIGNATURES
 };
 
 #define DIRECT_INTERFACE_IMPLEMENTATION(type, impl)              \
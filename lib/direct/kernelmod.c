@@ -209,6 +209,7 @@ EXPORT_SYMBOL_GPL( direct_hash_destroy );
 EXPORT_SYMBOL_GPL( direct_hash_insert );
 EXPORT_SYMBOL_GPL( direct_hash_remove );
 EXPORT_SYMBOL_GPL( direct_hash_lookup );
+EXPORT_SYMBOL_GPL( direct_hash_lookup_lockfree );
 EXPORT_SYMBOL_GPL( direct_hash_count );
 EXPORT_SYMBOL_GPL( direct_hash_iterate );
 
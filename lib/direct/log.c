@@ -32,6 +32,9 @@
 
 #include <config.h>
 
+#include <string.h>
+
+#include <direct/atomic.h>
 #include <direct/debug.h>
 #include <direct/mem.h>
 #include <direct/log.h>
@@ -49,6 +52,57 @@
 static DirectLog  fallback_log;
 static DirectLog *default_log;
 
+/**********************************************************************************************************************/
+
+/*
+ * Asynchronous mode ("log-async")
+ *
+ * Each thread appends its formatted messages to its own ring buffer without taking any lock, the owning thread
+ * being the only one advancing 'head' and the writer (background thread or flush) the only one advancing 'tail'.
+ * Messages not fitting into the ring are dropped and counted. Rings of exited threads are adopted by new threads.
+ */
+
+#define LOG_ASYNC_MAX_MESSAGE    2000          /* larger messages are written synchronously */
+#define LOG_ASYNC_IDLE_US        5000
+
+typedef struct __D_DirectLogRing DirectLogRing;
+
+struct __D_DirectLogRing {
+     DirectLogRing *next;
+
+     int            owned;        /* cleared when the owning thread exits */
+
+     unsigned int   mask;
+     unsigned int   head;         /* bytes written, only advanced by the owning thread */
+     unsigned int   tail;         /* bytes read, only advanced by the writer */
+
+     unsigned int   dropped;      /* messages dropped by the owning thread */
+     unsigned int   reported;     /* drops already reported by the writer */
+
+     char          *data;
+};
+
+typedef struct {
+     DirectLog     *log;
+     unsigned int   length;
+} DirectLogRecord;
+
+#define LOG_RECORD_SIZE(length)  ((sizeof(DirectLogRecord) + (length) + 7) & ~7)
+
+static DirectTLS      log_tls;
+static DirectMutex    log_rings_lock;
+static DirectLogRing *log_rings;
+static unsigned int   log_rings_count;
+static DirectLogRing  log_ring_bypass;     /* TLS value of threads writing synchronously */
+
+static DirectThread  *log_async_thread;
+static bool           log_async_running;
+static bool           log_async_stop;
+static int            log_async_draining;  /* ownership of the rings for writing them out */
+static pid_t          log_async_crash_tid; /* thread keeping the ownership after direct_log_async_flush( true ) */
+
+static void log_ring_release( void *ptr );
+
 void
 __D_log_init()
 {
@@ -61,12 +115,34 @@ __D_log_init()
      direct_log_init( fb, NULL );
 
      D_MAGIC_SET( fb, DirectLog );
+
+     direct_tls_register( &log_tls, log_ring_release );
+     direct_mutex_init( &log_rings_lock );
 }
 
 void
 __D_log_deinit()
 {
-     DirectLog *fb = &fallback_log;
+     DirectLog     *fb   = &fallback_log;
+     DirectLogRing *ring;
+
+     direct_log_async_shutdown();
+
+     ring = log_rings;
+
+     /* Threads still running may still reference their ring, so free only at the very end. */
+     while (ring) {
+          DirectLogRing *next = ring->next;
+
+          direct_free( ring );
+
+          ring = next;
+     }
+
+     log_rings = NULL;
+
+     direct_mutex_deinit( &log_rings_lock );
+     direct_tls_unregister( &log_tls );
 
      direct_log_deinit( fb );
 
@@ -79,6 +155,216 @@ __D_log_deinit()
 
 /**********************************************************************************************************************/
 
+__dfb_no_instrument_function__
+static void
+log_ring_release( void *ptr )
+{
+     DirectLogRing *ring = ptr;
+
+     if (ring == &log_ring_bypass)
+          return;
+
+     /* Messages of the exiting thread itself are written synchronously from now on. */
+     direct_tls_set( log_tls, &log_ring_bypass );
+
+     D_SYNC_FETCH_AND_CLEAR( &ring->owned );
+}
+
+__dfb_no_instrument_function__
+static DirectLogRing *
+log_ring_get( void )
+{
+     DirectLogRing *ring = direct_tls_get( log_tls );
+     unsigned int   size = 1;
+
+     if (ring)
+          return ring;
+
+     /* Anything logged while setting up the ring goes out directly. */
+     direct_tls_set( log_tls, &log_ring_bypass );
+
+     direct_mutex_lock( &log_rings_lock );
+
+     /* Continue the ring of an exited thread, possibly still containing messages. */
+     for (ring = log_rings; ring; ring = ring->next) {
+          if (D_SYNC_BOOL_COMPARE_AND_SWAP( &ring->owned, 0, 1 ))
+               break;
+     }
+
+     if (!ring) {
+          /* Round up to a power of two for cheap wrapping. */
+          while (size < direct_config->log_async * 1024)
+               size <<= 1;
+
+          ring = direct_calloc( 1, sizeof(DirectLogRing) + size );
+          if (ring) {
+               ring->owned = 1;
+               ring->mask  = size - 1;
+               ring->data  = (char*) (ring + 1);
+               ring->next  = log_rings;
+
+               /* The atomic add orders the initialization before publishing the ring to the writer,
+                  which is walking the list without the lock. */
+               D_SYNC_ADD( &log_rings_count, 1 );
+
+               log_rings = ring;
+          }
+     }
+
+     direct_mutex_unlock( &log_rings_lock );
+
+     if (ring)
+          direct_tls_set( log_tls, ring );
+
+     return ring ? ring : &log_ring_bypass;
+}
+
+__dfb_no_instrument_function__
+static void
+log_ring_put( DirectLogRing *ring,
+              unsigned int   pos,
+              const void    *data,
+              unsigned int   bytes )
+{
+     unsigned int offset = pos & ring->mask;
+     unsigned int first  = MIN( bytes, ring->mask + 1 - offset );
+
+     memcpy( ring->data + offset, data, first );
+
+     if (first < bytes)
+          memcpy( ring->data, (const char*) data + first, bytes - first );
+}
+
+__dfb_no_instrument_function__
+static void
+log_ring_get_data( DirectLogRing *ring,
+                   unsigned int   pos,
+                   void          *data,
+                   unsigned int   bytes )
+{
+     unsigned int offset = pos & ring->mask;
+     unsigned int first  = MIN( bytes, ring->mask + 1 - offset );
+
+     memcpy( data, ring->data + offset, first );
+
+     if (first < bytes)
+          memcpy( (char*) data + first, ring->data, bytes - first );
+}
+
+/*
+ * Writes out all messages queued so far, returns the number of messages written.
+ */
+__dfb_no_instrument_function__
+static unsigned int
+log_rings_drain( void )
+{
+     DirectLogRing *ring;
+     unsigned int   count = 0;
+     char           buf[LOG_ASYNC_MAX_MESSAGE];
+
+     for (ring = log_rings; ring; ring = ring->next) {
+          unsigned int dropped;
+          unsigned int head = D_SYNC_ADD_AND_FETCH( &ring->head, 0 );
+          unsigned int tail = ring->tail;
+
+          while (tail != head) {
+               DirectLogRecord record;
+
+               log_ring_get_data( ring, tail, &record, sizeof(record) );
+               log_ring_get_data( ring, tail + sizeof(record), buf, record.length );
+
+               record.log->write( record.log, buf, record.length );
+
+               tail += LOG_RECORD_SIZE( record.length );
+
+               /* Release the space to the owning thread. */
+               D_SYNC_ADD( &ring->tail, LOG_RECORD_SIZE( record.length ) );
+
+               count++;
+          }
+
+          dropped = D_SYNC_ADD_AND_FETCH( &ring->dropped, 0 );
+
+          if (dropped != ring->reported) {
+               DirectLog *log = direct_log_default();
+               int        len;
+
+               len = direct_snprintf( buf, sizeof(buf), "(!) Direct/Log: %u messages dropped (log-async buffer full)\n",
+                                      dropped - ring->reported );
+
+               log->write( log, buf, len );
+
+               ring->reported = dropped;
+          }
+     }
+
+     return count;
+}
+
+__dfb_no_instrument_function__
+static DirectResult
+log_output( DirectLog  *log,
+            const char *buffer,
+            size_t      bytes )
+{
+     DirectLogRing   *ring;
+     DirectLogRecord  record;
+     unsigned int     size;
+     unsigned int     head;
+
+     if (!log_async_running || bytes > LOG_ASYNC_MAX_MESSAGE)
+          return log->write( log, buffer, bytes );
+
+     ring = log_ring_get();
+     if (ring == &log_ring_bypass)
+          return log->write( log, buffer, bytes );
+
+     size = LOG_RECORD_SIZE( bytes );
+     head = ring->head;
+
+     if (size > ring->mask + 1 - (head - D_SYNC_ADD_AND_FETCH( &ring->tail, 0 ))) {
+          D_SYNC_ADD( &ring->dropped, 1 );
+          return DR_OK;
+     }
+
+     record.log    = log;
+     record.length = bytes;
+
+     log_ring_put( ring, head, &record, sizeof(record) );
+     log_ring_put( ring, head + sizeof(record), buffer, bytes );
+
+     /* Publish the message to the writer. */
+     D_SYNC_ADD( &ring->head, size );
+
+     return DR_OK;
+}
+
+__dfb_no_instrument_function__
+static void *
+log_async_loop( DirectThread *thread,
+                void         *arg )
+{
+     /* Our own messages (e.g. from thread management) are written directly. */
+     direct_tls_set( log_tls, &log_ring_bypass );
+
+     while (!log_async_stop) {
+          unsigned int count = 0;
+
+          if (D_SYNC_BOOL_COMPARE_AND_SWAP( &log_async_draining, 0, 1 )) {
+               count = log_rings_drain();
+
+               D_SYNC_FETCH_AND_CLEAR( &log_async_draining );
+          }
+
+          if (!count)
+               direct_thread_sleep( LOG_ASYNC_IDLE_US );
+     }
+
+     return NULL;
+}
+
+/**********************************************************************************************************************/
+
 DirectResult
 direct_log_create( DirectLogType   type,
                    const char     *param,
@@ -118,6 +404,9 @@ direct_log_destroy( DirectLog *log )
 
      D_ASSERT( &fallback_log != log );
 
+     /* Queued messages may still reference the log. */
+     direct_log_async_flush( false );
+
      if (log == default_log)
           default_log = NULL;
 
@@ -153,7 +442,7 @@ direct_log_write( DirectLog        *log,
           return DR_BUG;
 
 //     direct_mutex_lock( &log->lock );
-     ret = log->write( log, buffer, bytes );
+     ret = log_output( log, buffer, bytes );
 //     direct_mutex_unlock( &log->lock );
 
      direct_log_debug_delay( true );
@@ -210,7 +499,7 @@ direct_log_printf( DirectLog  *log,
 
 //     direct_mutex_lock( &log->lock );
 
-     ret = log->write( log, ptr, len );
+     ret = log_output( log, ptr, len );
 
 //     direct_mutex_unlock( &log->lock );
 
@@ -284,6 +573,8 @@ direct_log_flush( DirectLog *log,
      if (!D_MAGIC_CHECK( log, DirectLog ))
           return DR_BUG;
 
+     direct_log_async_flush( false );
+
      if (!log->flush)
           return DR_UNSUPPORTED;
 
@@ -292,6 +583,116 @@ direct_log_flush( DirectLog *log,
 
 /**********************************************************************************************************************/
 
+DirectResult
+direct_log_async_initialize( void )
+{
+     if (!direct_config->log_async || log_async_thread)
+          return DR_OK;
+
+     log_async_stop = false;
+
+     log_async_thread = direct_thread_create( DTT_OUTPUT, log_async_loop, NULL, "Log Writer" );
+     if (!log_async_thread)
+          return DR_FAILURE;
+
+     log_async_running = true;
+
+     return DR_OK;
+}
+
+void
+direct_log_async_shutdown( void )
+{
+     if (!log_async_thread)
+          return;
+
+     log_async_running = false;
+     log_async_stop    = true;
+
+     direct_thread_join( log_async_thread );
+     direct_thread_destroy( log_async_thread );
+
+     log_async_thread = NULL;
+
+     direct_log_async_flush( false );
+}
+
+/*
+ * Crash path: takes the ownership of the rings away from the writer and keeps it until direct_log_async_resume(),
+ * so the writer can not write out the same messages again or race on the tail of a ring.
+ */
+__dfb_no_instrument_function__
+static void
+log_async_flush_final( void )
+{
+     int tries = 0;
+
+     /* Messages from now on are written synchronously, even if the writer is still alive. */
+     log_async_running = false;
+
+     while (!D_SYNC_BOOL_COMPARE_AND_SWAP( &log_async_draining, 0, 1 )) {
+          /* Crashed within a pass of the writer, which won't continue before we return. */
+          if (direct_thread_self() == log_async_thread) {
+               log_rings_drain();
+               return;
+          }
+
+          /* The owner is stuck, leave the queued messages rather than writing them concurrently. */
+          if (log_async_crash_tid || ++tries > 100)
+               return;
+
+          direct_thread_sleep( 1000 );
+     }
+
+     log_async_crash_tid = direct_gettid();
+
+     log_rings_drain();
+}
+
+__dfb_no_instrument_function__
+void
+direct_log_async_flush( bool final )
+{
+     if (!log_rings)
+          return;
+
+     if (final) {
+          log_async_flush_final();
+          return;
+     }
+
+     /* Wait for the writer to finish its pass. */
+     while (!D_SYNC_BOOL_COMPARE_AND_SWAP( &log_async_draining, 0, 1 )) {
+          /* Called while handling a crash on this thread, e.g. from a cleanup handler. */
+          if (log_async_crash_tid == direct_gettid()) {
+               log_rings_drain();
+               return;
+          }
+
+          direct_thread_sleep( 1000 );
+     }
+
+     log_rings_drain();
+
+     D_SYNC_FETCH_AND_CLEAR( &log_async_draining );
+}
+
+__dfb_no_instrument_function__
+void
+direct_log_async_resume( void )
+{
+     if (log_async_crash_tid == direct_gettid()) {
+          log_async_crash_tid = 0;
+
+          D_SYNC_FETCH_AND_CLEAR( &log_async_draining );
+     }
+
+     if (log_async_thread && !log_async_stop)
+          log_async_running = true;
+}
+
+/**********************************************************************************************************************/
+
 __dfb_no_instrument_function__
 DirectLog *
 direct_log_default( void )
@@ -108,6 +108,26 @@ DirectResult DIRECT_API direct_log_flush      ( DirectLog        *log,
  */
 DirectLog    DIRECT_API *direct_log_default( void );
 
+/*
+ * Asynchronous mode ("log-async=<kb>"): messages are formatted by the calling thread and queued in a lock free ring
+ * buffer per thread, a background thread writes them out. Messages are dropped (and counted) when a ring is full.
+ * Ordering is kept per thread only.
+ */
+DirectResult DIRECT_API direct_log_async_initialize( void );
+void         DIRECT_API direct_log_async_shutdown  ( void );
+
+/*
+ * Writes out all queued messages. Use 'final' when crashing, i.e. from a signal handler: the writer is stopped from
+ * writing, all following messages are written synchronously and waiting for a stuck writer is given up after a while.
+ */
+void         DIRECT_API direct_log_async_flush     ( bool final );
+
+/*
+ * Continues asynchronous logging after direct_log_async_flush( true ) when the process survived, e.g. the signal
+ * handler returned. Has to be called by the same thread.
+ */
+void         DIRECT_API direct_log_async_resume    ( void );
+
 
 #define d_printf( ... )            direct_log_printf( NULL, __VA_ARGS__ )
 
@@ -54,14 +54,13 @@ typedef struct {
 /**********************************************************************************************************************/
 
 static DirectMutex   domains_lock;
-static unsigned int  domains_age;
 static DirectLink   *domains;      // FIXME: use hash table like in direct/result.c
 
+unsigned int direct_log_domains_age = 1;   /* never 0, the age of unchecked domains */
+
 void
 __D_log_domain_init()
 {
-     domains_age = 1;
-
      direct_mutex_init( &domains_lock );
 }
 
@@ -115,13 +114,7 @@ check_domain( DirectLogDomain *domain );
 static DirectLogLevel
 check_domain( DirectLogDomain *domain )
 {
-     if (direct_config->log_none)
-          return DIRECT_LOG_NONE;
-
-     if (direct_config->log_all)
-          return DIRECT_LOG_ALL;
-
-     if (domain->age != domains_age) {
+     if (domain->age != direct_log_domains_age) {
           LogDomainEntry *entry;
 
           if (direct_mutex_lock( &domains_lock ))
@@ -129,8 +122,6 @@ check_domain( DirectLogDomain *domain )
 
           entry = lookup_domain( domain->name, true );
 
-          domain->age = domains_age;
-
           if (entry) {
                domain->registered = true;
                domain->config     = entry->config;
@@ -140,9 +131,28 @@ check_domain( DirectLogDomain *domain )
                domain->config.level = direct_config->log_level;
           }
 
+          /* Skipped messages would still have to apply the debug delay. */
+          if (direct_config->log_delay_rand_us || direct_config->log_delay_rand_loops)
+               domain->skip_level = DIRECT_LOG_ALL;
+          else if (direct_config->log_none)
+               domain->skip_level = DIRECT_LOG_NONE;
+          else if (direct_config->log_all)
+               domain->skip_level = DIRECT_LOG_ALL;
+          else
+               domain->skip_level = domain->config.level;
+
+          /* Set the age last, call sites only use the skip level with a current age. */
+          domain->age = direct_log_domains_age;
+
           direct_mutex_unlock( &domains_lock );
      }
 
+     if (direct_config->log_none)
+          return DIRECT_LOG_NONE;
+
+     if (direct_config->log_all)
+          return DIRECT_LOG_ALL;
+
      return domain->config.level;
 }
 
@@ -185,8 +195,20 @@ direct_log_domain_configure( const char *name, const DirectLogDomainConfig *conf
 
      entry->config = *config;
 
-     if (! ++domains_age)
-          domains_age++;
+     if (! ++direct_log_domains_age)
+          direct_log_domains_age++;
+
+     direct_mutex_unlock( &domains_lock );
+}
+
+void
+direct_log_domains_refresh()
+{
+     if (direct_mutex_lock( &domains_lock ))
+          return;
+
+     if (! ++direct_log_domains_age)
+          direct_log_domains_age++;
 
      direct_mutex_unlock( &domains_lock );
 }
@@ -347,6 +369,8 @@ direct_log_domain_log( DirectLogDomain *domain,
 
 #else
 
+unsigned int direct_log_domains_age;
+
 void
 __D_log_domain_init()
 {
@@ -370,6 +394,11 @@ direct_log_domain_configure( const char                  *name,
                              const DirectLogDomainConfig *config )
 {
 }
+
+void
+direct_log_domains_refresh()
+{
+}
   
 bool
 direct_log_domain_check( DirectLogDomain *domain )
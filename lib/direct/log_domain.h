@@ -82,20 +82,39 @@ typedef struct {
      bool                     registered;
 
      DirectLogDomainConfig    config;
+
+     DirectLogLevel           skip_level;    /* call sites skip messages above this level while age is current */
 } DirectLogDomain;
 
 /**********************************************************************************************************************/
 
 #define D_LOG_DOMAIN( _identifier, _name, _description )                                                           \
      static DirectLogDomain _identifier D_UNUSED = {                                                               \
-            _description, _name, sizeof(_name) - 1, 0, false, {DIRECT_LOG_NONE,0}                                  \
+            _description, _name, sizeof(_name) - 1, 0, false, {DIRECT_LOG_NONE,0}, DIRECT_LOG_NONE                 \
      }
 
+/*
+ * Age of the domain configuration, advanced by direct_log_domain_configure() and direct_log_domains_refresh().
+ *
+ * Each domain caches the result of its last full check together with the age. While the age is current,
+ * D_LOG_DOMAIN_SKIP() lets call sites drop messages of disabled domains with a compare and a branch, without
+ * calling into the library or evaluating the message arguments.
+ */
+extern unsigned int DIRECT_API direct_log_domains_age;
+
+#define D_LOG_DOMAIN_SKIP( _Domain, _level )                                                                          \
+     D_LIKELY( (_Domain).age == direct_log_domains_age && (_level) > (_Domain).skip_level )
+
 /**********************************************************************************************************************/
 
 void         DIRECT_API direct_log_domain_configure( const char                  *name,
                                                      const DirectLogDomainConfig *config );
 
+/*
+ * Lets all domains check their configuration again, e.g. after changing the global log options.
+ */
+void         DIRECT_API direct_log_domains_refresh( void );
+
 
 DirectResult DIRECT_API direct_log_domain_vprintf( DirectLogDomain *domain,
                                                    DirectLogLevel   level,
@@ -132,12 +151,14 @@ bool DIRECT_API direct_log_domain_check_level( DirectLogDomain *domain,
 
 #define D_LOG( _Domain, _LEVEL, ... )                                                                                 \
      do {                                                                                                             \
-          direct_log_domain_log( &(_Domain), DIRECT_LOG_ ## _LEVEL, __FUNCTION__, __FILE__, __LINE__, __VA_ARGS__ );  \
+          if (!D_LOG_DOMAIN_SKIP( _Domain, DIRECT_LOG_ ## _LEVEL ))                                                   \
+               direct_log_domain_log( &(_Domain), DIRECT_LOG_ ## _LEVEL, __FUNCTION__, __FILE__, __LINE__, __VA_ARGS__ ); \
      } while (0)
 
 #define D_LOG_( _Domain, _level, ... )                                                                                \
      do {                                                                                                             \
-          direct_log_domain_log( &(_Domain), _level, __FUNCTION__, __FILE__, __LINE__, __VA_ARGS__ );                 \
+          if (!D_LOG_DOMAIN_SKIP( _Domain, _level ))                                                                  \
+               direct_log_domain_log( &(_Domain), _level, __FUNCTION__, __FILE__, __LINE__, __VA_ARGS__ );            \
      } while (0)
 
 
@@ -33,14 +33,22 @@
 #include <config.h>
 
 #include <sys/types.h>
+#include <ctype.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
 #include <direct/conf.h>
 #include <direct/debug.h>
+#include <direct/list.h>
 #include <direct/mem.h>
 #include <direct/messages.h>
 #include <direct/modules.h>
+#include <direct/print.h>
+#include <direct/startup.h>
+#include <direct/thread.h>
+
+#include <errno.h>
 
 #if DIRECT_BUILD_DYNLOAD
 #include <alloca.h>
@@ -66,6 +74,26 @@ static void  unload_module( DirectModuleEntry *module );
 
 #endif
 
+/*
+ * Protects the entries of all directories. Modules are always (un)loaded with the lock held,
+ * as their constructors and destructors (un)register themselves.
+ */
+static DirectMutex modules_lock = DIRECT_RECURSIVE_MUTEX_INITIALIZER(modules_lock);
+
+/******************************************************************************/
+
+typedef struct {
+     DirectLink  link;
+
+     char       *file;
+     char       *name;
+     char       *signatures;    /* "<offset>:<hex>" separated by spaces, NULL if unknown */
+} ManifestEntry;
+
+struct __D_DirectModuleManifest {
+     DirectLink *entries;
+};
+
 /******************************************************************************/
 
 static int
@@ -102,7 +130,41 @@ direct_modules_register( DirectModuleDir *directory,
 
      D_DEBUG_AT( Direct_Modules, "Registering '%s' ('%s')...\n", name, directory->path );
 
+     direct_mutex_lock( &modules_lock );
+
 #if DIRECT_BUILD_DYNLOAD
+     if (directory->loading && directory->loading->name) {
+          /* Loading an entry known by its name already, see load_module(). */
+          entry = directory->loading;
+
+          D_MAGIC_ASSERT( entry, DirectModuleEntry );
+
+          directory->loading = NULL;
+
+          if (strcmp( entry->name, name )) {
+               D_WARN( "module '%s' registered as '%s' instead of '%s', outdated manifest?",
+                       entry->file, name, entry->name );
+
+               D_FREE( entry->name );
+
+               entry->name     = D_STRDUP( name );
+               entry->disabled = suppress_module( name );
+          }
+
+          entry->loaded = true;
+          entry->funcs  = funcs;
+
+          if (abi_version != directory->abi_version) {
+               D_ERROR( "Direct/Modules: ABI version of '%s' (%d) does not match %d!\n",
+                        entry->file, abi_version, directory->abi_version );
+
+               entry->disabled = true;
+          }
+
+          direct_mutex_unlock( &modules_lock );
+          return;
+     }
+
      if ((entry = lookup_by_name( directory, name )) != NULL) {
           D_DEBUG_AT( Direct_Modules, "  -> found entry %p\n", entry );
 
@@ -111,6 +173,7 @@ direct_modules_register( DirectModuleDir *directory,
           entry->loaded = true;
           entry->funcs  = funcs;
 
+          direct_mutex_unlock( &modules_lock );
           return;
      }
 #endif
@@ -125,6 +188,7 @@ direct_modules_register( DirectModuleDir *directory,
           entry = D_CALLOC( 1, sizeof(DirectModuleEntry) );
           if (!entry) {
                D_OOM();
+               direct_mutex_unlock( &modules_lock );
                return;
           }
 
@@ -150,6 +214,8 @@ direct_modules_register( DirectModuleDir *directory,
 
      direct_list_prepend( &directory->entries, &entry->link );
 
+     direct_mutex_unlock( &modules_lock );
+
      D_DEBUG_AT( Direct_Modules, "...registered as %p\n", entry );
 }
 
@@ -164,8 +230,11 @@ direct_modules_unregister( DirectModuleDir *directory,
      D_DEBUG_AT( Direct_Modules, "Unregistering '%s' ('%s')...\n", name, directory->path );
 
 #if DIRECT_BUILD_DYNLOAD
+     direct_mutex_lock( &modules_lock );
+
      entry = lookup_by_name( directory, name );
      if (!entry) {
+          direct_mutex_unlock( &modules_lock );
           D_ERROR( "Direct/Modules: Unregister failed, could not find '%s' module!\n", name );
           return;
      }
@@ -174,11 +243,16 @@ direct_modules_unregister( DirectModuleDir *directory,
 
      D_FREE( entry->name );
 
+     if (entry->file)
+          D_FREE( entry->file );
+
      direct_list_remove( &directory->entries, &entry->link );
 
      D_MAGIC_CLEAR( entry );
 
      D_FREE( entry );
+
+     direct_mutex_unlock( &modules_lock );
 #endif
 
      D_DEBUG_AT( Direct_Modules, "...unregistered.\n" );
@@ -188,13 +262,14 @@ int
 direct_modules_explore_directory( DirectModuleDir *directory )
 {
 #if DIRECT_BUILD_DYNLOAD
-     DIR           *dir;
-     struct dirent *entry = NULL;
-     struct dirent  tmp;
-     int            count = 0;
-     const char    *pathfront = "";
-     const char    *path;
-     char          *buf;
+     DIR                  *dir;
+     struct dirent        *entry = NULL;
+     struct dirent         tmp;
+     int                   count = 0;
+     const char           *pathfront = "";
+     const char           *path;
+     char                 *buf;
+     DirectModuleManifest *manifest = NULL;
 
      D_ASSERT( directory != NULL );
      D_ASSERT( directory->path != NULL );
@@ -218,9 +293,15 @@ direct_modules_explore_directory( DirectModuleDir *directory )
           return 0;
      }
 
+     if (direct_module_manifest_use())
+          manifest = direct_module_manifest_load( buf );
+
+     direct_mutex_lock( &modules_lock );
+
      while (readdir_r( dir, &tmp, &entry ) == 0 && entry) {
           void              *handle;
           DirectModuleEntry *module;
+          const char        *name;
           int                entry_len = strlen(entry->d_name);
 
           if (entry_len < 4 ||
@@ -249,6 +330,20 @@ direct_modules_explore_directory( DirectModuleDir *directory )
                continue;
           }
 
+          /* Known by the manifest, load it when referenced. */
+          name = direct_module_manifest_lookup( manifest, entry->d_name );
+          if (name) {
+               D_DEBUG_AT( Direct_Modules, "  -> '%s' from manifest\n", name );
+
+               module->name     = D_STRDUP( name );
+               module->disabled = suppress_module( name );
+
+               direct_list_prepend( &directory->entries, &module->link );
+
+               count++;
+               continue;
+          }
+
           directory->loading = module;
 
           if ((handle = open_module( module )) != NULL) {
@@ -286,12 +381,106 @@ direct_modules_explore_directory( DirectModuleDir *directory )
 
      closedir( dir );
 
+     if (direct_module_manifest_update()) {
+          DirectModuleManifest *update = direct_module_manifest_create();
+
+          if (update) {
+               DirectModuleEntry *module;
+
+               direct_list_foreach (module, directory->entries) {
+                    if (module->file && module->name && module->loaded)
+                         direct_module_manifest_add( update, module->file, module->name, NULL );
+               }
+
+               if (direct_module_manifest_save( update, buf ) == DR_OK)
+                    D_INFO( "Direct/Modules: Updated manifest of '%s'\n", buf );
+
+               direct_module_manifest_destroy( update );
+          }
+     }
+
+     direct_mutex_unlock( &modules_lock );
+
+     if (manifest)
+          direct_module_manifest_destroy( manifest );
+
      return count;
 #else
      return 0;
 #endif
 }
 
+#if DIRECT_BUILD_DYNLOAD
+static void *
+preload_loop( DirectThread *thread,
+              void         *arg )
+{
+     DirectModuleDir *directory = arg;
+
+     D_DEBUG_AT( Direct_Modules, "%s( '%s' )\n", __FUNCTION__, directory->path );
+
+     while (true) {
+          DirectModuleEntry *module;
+
+          direct_mutex_lock( &modules_lock );
+
+          /* Look for the next module, entries may have been removed meanwhile. */
+          direct_list_foreach (module, directory->entries) {
+               D_MAGIC_ASSERT( module, DirectModuleEntry );
+
+               if (!module->preloaded && module->dynamic && !module->loaded && !module->disabled)
+                    break;
+          }
+
+          if (!module) {
+               direct_mutex_unlock( &modules_lock );
+               break;
+          }
+
+          module->preloaded = true;
+
+          /* Only one module is loaded with the lock held, direct_module_ref() waits for no more than that. */
+          load_module( module );
+
+          direct_mutex_unlock( &modules_lock );
+     }
+
+     D_DEBUG_AT( Direct_Modules, "  -> preloading '%s' done\n", directory->path );
+
+     return NULL;
+}
+#endif
+
+void
+direct_modules_preload( DirectModuleDir *directory )
+{
+     D_ASSERT( directory != NULL );
+
+     D_DEBUG_AT( Direct_Modules, "%s( '%s' )\n", __FUNCTION__, directory->path );
+
+#if DIRECT_BUILD_DYNLOAD
+     if (directory->preload)
+          return;
+
+     directory->preload = direct_thread_create( DTT_DEFAULT, preload_loop, directory, "Module Preload" );
+#endif
+}
+
+void
+direct_modules_preload_wait( DirectModuleDir *directory )
+{
+     D_ASSERT( directory != NULL );
+
+     D_DEBUG_AT( Direct_Modules, "%s( '%s' )\n", __FUNCTION__, directory->path );
+
+     if (directory->preload) {
+          direct_thread_join( directory->preload );
+          direct_thread_destroy( directory->preload );
+
+          directory->preload = NULL;
+     }
+}
+
 const void *
 direct_module_ref( DirectModuleEntry *module )
 {
@@ -302,11 +491,17 @@ direct_module_ref( DirectModuleEntry *module )
 
      D_MAGIC_ASSERT( module, DirectModuleEntry );
 
-     if (module->disabled)
+     direct_mutex_lock( &modules_lock );
+
+     if (module->disabled) {
+          direct_mutex_unlock( &modules_lock );
           return NULL;
+     }
 
 #if DIRECT_BUILD_DYNLOAD
      if (!module->loaded && !load_module( module )) {
+          direct_mutex_unlock( &modules_lock );
+
           D_DEBUG_AT( Direct_Modules, "  -> load_module failed, returning NULL\n" );
 
           return NULL;
@@ -317,6 +512,8 @@ direct_module_ref( DirectModuleEntry *module )
 
      D_DEBUG_AT( Direct_Modules, "  -> refs %d, funcs %p\n", module->refs, module->funcs );
 
+     direct_mutex_unlock( &modules_lock );
+
      return module->funcs;
 }
 
@@ -331,13 +528,286 @@ direct_module_unref( DirectModuleEntry *module )
      D_MAGIC_ASSERT( module, DirectModuleEntry );
      D_ASSERT( module->refs > 0 );
 
-     if (--module->refs)
+     direct_mutex_lock( &modules_lock );
+
+     if (--module->refs) {
+          direct_mutex_unlock( &modules_lock );
           return;
+     }
 
 #if DIRECT_BUILD_DYNLOAD
      if (module->dynamic)
           unload_module( module );
 #endif
+
+     direct_mutex_unlock( &modules_lock );
+}
+
+/******************************************************************************/
+
+static const char *
+manifest_mode( void )
+{
+     char *value = NULL;
+     int   num   = 0;
+
+     if (direct_config_get( "module-manifest", &value, 1, &num ) || !num)
+          return NULL;
+
+     return value;
+}
+
+bool
+direct_module_manifest_use( void )
+{
+     const char *mode = manifest_mode();
+
+     return !mode || (strcmp( mode, "no" ) && strcmp( mode, "update" ));
+}
+
+bool
+direct_module_manifest_update( void )
+{
+     const char *mode = manifest_mode();
+
+     return mode && !strcmp( mode, "update" );
+}
+
+DirectModuleManifest *
+direct_module_manifest_create( void )
+{
+     DirectModuleManifest *manifest;
+
+     manifest = D_CALLOC( 1, sizeof(DirectModuleManifest) );
+     if (!manifest)
+          D_OOM();
+
+     return manifest;
+}
+
+DirectModuleManifest *
+direct_module_manifest_load( const char *path )
+{
+     DirectModuleManifest *manifest;
+     FILE                 *f;
+     char                  filename[4096];
+     char                  line[1024];
+
+     D_ASSERT( path != NULL );
+
+     direct_snprintf( filename, sizeof(filename), "%s/" DIRECT_MODULE_MANIFEST, path );
+
+     f = fopen( filename, "r" );
+     if (!f) {
+          D_DEBUG_AT( Direct_Modules, "  -> no manifest '%s'\n", filename );
+          return NULL;
+     }
+
+     manifest = direct_module_manifest_create();
+     if (manifest) {
+          while (fgets( line, sizeof(line), f )) {
+               char  file[256];
+               char  name[256];
+               int   end  = 0;
+               char *signatures;
+
+               if (line[0] == '#')
+                    continue;
+
+               if (sscanf( line, "%255s %255s%n", file, name, &end ) != 2)
+                    continue;
+
+               /* Optional signatures up to the end of the line. */
+               signatures = line + end;
+
+               signatures += strspn( signatures, " \t" );
+               signatures[strcspn( signatures, "\r\n" )] = 0;
+
+               direct_module_manifest_add( manifest, file, name, *signatures ? signatures : NULL );
+          }
+     }
+
+     fclose( f );
+
+     return manifest;
+}
+
+void
+direct_module_manifest_destroy( DirectModuleManifest *manifest )
+{
+     ManifestEntry *entry, *next;
+
+     D_ASSERT( manifest != NULL );
+
+     direct_list_foreach_safe (entry, next, manifest->entries) {
+          D_FREE( entry->file );
+          D_FREE( entry->name );
+
+          if (entry->signatures)
+               D_FREE( entry->signatures );
+
+          D_FREE( entry );
+     }
+
+     D_FREE( manifest );
+}
+
+static ManifestEntry *
+manifest_entry( const DirectModuleManifest *manifest,
+                const char                 *file )
+{
+     ManifestEntry *entry;
+
+     D_ASSERT( file != NULL );
+
+     if (!manifest)
+          return NULL;
+
+     direct_list_foreach (entry, manifest->entries) {
+          if (!strcmp( entry->file, file ))
+               return entry;
+     }
+
+     return NULL;
+}
+
+const char *
+direct_module_manifest_lookup( const DirectModuleManifest *manifest,
+                               const char                 *file )
+{
+     ManifestEntry *entry = manifest_entry( manifest, file );
+
+     return entry ? entry->name : NULL;
+}
+
+/*
+ * Checks a single "<offset>:<hex>" signature against the data.
+ */
+static bool
+signature_matches( const char          *signature,
+                   const unsigned char *data,
+                   unsigned int         length )
+{
+     char         *end;
+     unsigned long offset;
+
+     offset = strtoul( signature, &end, 10 );
+     if (end == signature || *end != ':')
+          return true;
+
+     for (signature = end + 1; isxdigit( (unsigned char) signature[0] ) && isxdigit( (unsigned char) signature[1] ); signature += 2) {
+          char byte[3] = { signature[0], signature[1], 0 };
+
+          if (offset >= length || data[offset++] != strtoul( byte, NULL, 16 ))
+               return false;
+     }
+
+     return true;
+}
+
+bool
+direct_module_manifest_matches( const DirectModuleManifest *manifest,
+                                const char                 *file,
+                                const void                 *data,
+                                unsigned int                length )
+{
+     ManifestEntry *entry = manifest_entry( manifest, file );
+     const char    *signature;
+
+     if (!entry || !entry->signatures || !data)
+          return true;
+
+     for (signature = entry->signatures; *signature; signature += strcspn( signature, " " )) {
+          signature += strspn( signature, " " );
+
+          if (*signature && signature_matches( signature, data, length ))
+               return true;
+     }
+
+     return false;
+}
+
+DirectResult
+direct_module_manifest_add( DirectModuleManifest *manifest,
+                            const char           *file,
+                            const char           *name,
+                            const char           *signatures )
+{
+     ManifestEntry *entry;
+
+     D_ASSERT( manifest != NULL );
+     D_ASSERT( file != NULL );
+     D_ASSERT( name != NULL );
+
+     entry = D_CALLOC( 1, sizeof(ManifestEntry) );
+     if (!entry)
+          return D_OOM();
+
+     entry->file       = D_STRDUP( file );
+     entry->name       = D_STRDUP( name );
+     entry->signatures = signatures ? D_STRDUP( signatures ) : NULL;
+
+     if (!entry->file || !entry->name || (signatures && !entry->signatures)) {
+          if (entry->file)
+               D_FREE( entry->file );
+
+          if (entry->name)
+               D_FREE( entry->name );
+
+          if (entry->signatures)
+               D_FREE( entry->signatures );
+
+          D_FREE( entry );
+
+          return D_OOM();
+     }
+
+     direct_list_append( &manifest->entries, &entry->link );
+
+     return DR_OK;
+}
+
+DirectResult
+direct_module_manifest_save( const DirectModuleManifest *manifest,
+                             const char                 *path )
+{
+     DirectResult   ret;
+     ManifestEntry *entry;
+     FILE          *f;
+     char           filename[4096];
+     char           tmpname[4096];
+
+     D_ASSERT( manifest != NULL );
+     D_ASSERT( path != NULL );
+
+     direct_snprintf( filename, sizeof(filename), "%s/" DIRECT_MODULE_MANIFEST, path );
+     direct_snprintf( tmpname, sizeof(tmpname), "%s/" DIRECT_MODULE_MANIFEST ".tmp", path );
+
+     /* Write a temporary file first, readers never see a partial manifest. */
+     f = fopen( tmpname, "w" );
+     if (!f) {
+          ret = errno2result( errno );
+          D_PERROR( "Direct/Modules: Could not write manifest '%s'!\n", tmpname );
+          return ret;
+     }
+
+     fprintf( f, "# <file> <name> [<offset>:<hex magic> ...], written by module-manifest=update\n" );
+
+     direct_list_foreach (entry, manifest->entries) {
+          if (entry->signatures)
+               fprintf( f, "%s %s %s\n", entry->file, entry->name, entry->signatures );
+          else
+               fprintf( f, "%s %s\n", entry->file, entry->name );
+     }
+
+     if (fclose( f ) || rename( tmpname, filename )) {
+          ret = errno2result( errno );
+          D_PERROR( "Direct/Modules: Could not write manifest '%s'!\n", filename );
+          remove( tmpname );
+          return ret;
+     }
+
+     return DR_OK;
 }
 
 /******************************************************************************/
@@ -397,6 +867,8 @@ lookup_by_file( const DirectModuleDir *directory,
 static bool
 load_module( DirectModuleEntry *module )
 {
+     void *handle;
+
      D_DEBUG_AT( Direct_Modules, "%s()\n", __FUNCTION__ );
 
      D_MAGIC_ASSERT( module, DirectModuleEntry );
@@ -408,11 +880,36 @@ load_module( DirectModuleEntry *module )
      D_ASSERT( module->loaded == false );
      D_ASSERT( module->disabled == false );
 
-     module->handle = open_module( module );
-     if (module->handle)
-          module->loaded = true;
+     /* Let direct_modules_register() find the entry, even if registering under another name. */
+     module->directory->loading = module;
+
+     handle = open_module( module );
 
-     return module->loaded;
+     module->directory->loading = NULL;
+
+     if (!handle) {
+          module->disabled = true;
+          return false;
+     }
+
+     if (!module->loaded) {
+          D_ERROR( "Direct/Modules: Module '%s' did not register itself after loading!\n", module->file );
+
+          dlclose( handle );
+
+          module->disabled = true;
+          return false;
+     }
+
+     /* Keep disabled modules loaded, unloading would remove the entry. */
+     module->handle = handle;
+
+     if (module->disabled) {
+          module->loaded = false;
+          return false;
+     }
+
+     return true;
 }
 
 static void
@@ -444,11 +941,12 @@ unload_module( DirectModuleEntry *module )
 static void *
 open_module( DirectModuleEntry *module )
 {
-     DirectModuleDir *directory;
-     const char      *pathfront = "";
-     const char      *path;
-     char            *buf;
-     void            *handle;
+     DirectModuleDir   *directory;
+     const char        *pathfront = "";
+     const char        *path;
+     char              *buf;
+     void              *handle;
+     DirectStartupSpan  span;
 
      D_DEBUG_AT( Direct_Modules, "%s()\n", __FUNCTION__ );
 
@@ -460,6 +958,8 @@ open_module( DirectModuleEntry *module )
      D_ASSERT( module->directory != NULL );
      D_ASSERT( module->directory->path != NULL );
 
+     direct_startup_begin( &span );
+
      directory = module->directory;
      path      = directory->path;
 
@@ -479,6 +979,8 @@ open_module( DirectModuleEntry *module )
      if (!handle)
           D_DLERROR( "Direct/Modules: Unable to dlopen `%s'!\n", buf );
 
+     direct_startup_end( &span, "module", "%s/%s", path, module->file );
+
      D_MAGIC_ASSERT( module, DirectModuleEntry );
 
      return handle;
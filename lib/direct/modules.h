@@ -55,6 +55,8 @@ struct __D_DirectModuleEntry {
      int                refs;
      char              *file;
      void              *handle;
+
+     bool               preloaded;   /* tried by direct_modules_preload() */
 };
 
 struct __D_DirectModuleDir {
@@ -64,6 +66,8 @@ struct __D_DirectModuleDir {
      DirectLink        *entries;
 
      DirectModuleEntry *loading;
+
+     DirectThread      *preload;
 };
 
 #define DECLARE_MODULE_DIRECTORY(d)  \
@@ -75,10 +79,30 @@ struct __D_DirectModuleDir {
           /*.abi_version =*/ n,                            \
           /*.entries     =*/ NULL,                         \
           /*.loading     =*/ NULL,                         \
+          /*.preload     =*/ NULL,                         \
      }
 
+/*
+ * Adds all modules found in the directory.
+ *
+ * Modules listed in the directory's manifest are only loaded when referenced,
+ * others are loaded immediately to let them register. With the option
+ * "module-manifest=update" all modules are loaded and the manifest is rewritten.
+ */
 int  DIRECT_API  direct_modules_explore_directory( DirectModuleDir *directory );
 
+/*
+ * Starts loading modules of the directory, that have not been loaded yet, in a background thread.
+ *
+ * Useful if all of them will be referenced anyway, e.g. for probing.
+ */
+void DIRECT_API  direct_modules_preload          ( DirectModuleDir *directory );
+
+/*
+ * Waits for direct_modules_preload() to finish.
+ */
+void DIRECT_API  direct_modules_preload_wait     ( DirectModuleDir *directory );
+
 void DIRECT_API  direct_modules_register( DirectModuleDir *directory,
                                           unsigned int     abi_version,
                                           const char      *name,
@@ -90,5 +114,45 @@ void DIRECT_API  direct_modules_unregister( DirectModuleDir *directory,
 const void DIRECT_API *direct_module_ref  ( DirectModuleEntry *module );
 void       DIRECT_API  direct_module_unref( DirectModuleEntry *module );
 
+/*
+ * A manifest lists the name each module file of a directory registers as,
+ * one "<file> <name>" per line. It is stored as DIRECT_MODULE_MANIFEST in
+ * the directory, allowing to select modules without loading all of them.
+ *
+ * Interface implementations may add probe signatures, "<offset>:<hex magic>"
+ * separated by spaces. Their Probe() only accepts data matching one of them,
+ * so files whose signatures don't match the probed data are not loaded.
+ */
+#define DIRECT_MODULE_MANIFEST  "modules.manifest"
+
+DirectModuleManifest DIRECT_API *direct_module_manifest_create ( void );
+DirectModuleManifest DIRECT_API *direct_module_manifest_load   ( const char                 *path );
+void                 DIRECT_API  direct_module_manifest_destroy( DirectModuleManifest       *manifest );
+
+const char           DIRECT_API *direct_module_manifest_lookup ( const DirectModuleManifest *manifest,
+                                                                 const char                 *file );
+
+/*
+ * Returns false only if the file has signatures and none matches the data.
+ */
+bool                 DIRECT_API  direct_module_manifest_matches( const DirectModuleManifest *manifest,
+                                                                 const char                 *file,
+                                                                 const void                 *data,
+                                                                 unsigned int                length );
+
+DirectResult         DIRECT_API  direct_module_manifest_add    ( DirectModuleManifest       *manifest,
+                                                                 const char                 *file,
+                                                                 const char                 *name,
+                                                                 const char                 *signatures );
+
+DirectResult         DIRECT_API  direct_module_manifest_save   ( const DirectModuleManifest *manifest,
+                                                                 const char                 *path );
+
+/*
+ * Returns whether manifests should be used or rewritten ("module-manifest" option).
+ */
+bool DIRECT_API  direct_module_manifest_use   ( void );
+bool DIRECT_API  direct_module_manifest_update( void );
+
 #endif
 
@@ -90,8 +90,12 @@ direct_mutex_unlock( DirectMutex *mutex )
 DirectResult
 direct_mutex_trylock( DirectMutex *mutex )
 {
-     if (pthread_mutex_trylock( &mutex->lock ))
-          return errno2result( errno );
+     int erno;
+
+     /* Returns the error instead of setting errno, EBUSY must not become DR_OK. */
+     erno = pthread_mutex_trylock( &mutex->lock );
+     if (erno)
+          return errno2result( erno );
 
      return DR_OK;
 }
@@ -151,18 +151,10 @@ DirectResultTypeUnregister( DirectResultType *type )
 const char *
 DirectResultString( DirectResult result )
 {
-     DirectResult      ret;
      DirectResultType *type;
 
      if (result) {
-          ret = direct_mutex_lock( &result_mutex );
-          if (ret)
-               return NULL;
-
-          type = direct_hash_lookup( &result_types, D_RESULT_TYPE( result ) );
-
-          direct_mutex_unlock( &result_mutex );
-
+          type = direct_hash_lookup_lockfree( &result_types, D_RESULT_TYPE( result ) );
           if (type) {
                unsigned int index = D_RESULT_INDEX( result );
 
@@ -37,11 +37,13 @@
 #include <direct/debug.h>
 #include <direct/interface.h>
 #include <direct/list.h>
+#include <direct/log.h>
 #include <direct/mem.h>
 #include <direct/messages.h>
 #include <direct/signals.h>
 #include <direct/system.h>
 #include <direct/thread.h>
+#include <direct/timeline.h>
 #include <direct/trace.h>
 #include <direct/util.h>
 
@@ -51,6 +53,7 @@ D_LOG_DOMAIN( Direct_Signals, "Direct/Signals", "Signal handling" );
 
 #define SIG_CLOSE_SIGHANDLER SIGUNUSED
 #define SIG_DUMP_STACK       SIGPIPE    //(SIGUNUSED-1)
+#define SIG_DUMP_TIMELINE    SIGURG     /* ignored by default, harmless without the timeline */
 
 struct __D_DirectSignalHandler {
      DirectLink               link;
@@ -116,6 +119,9 @@ direct_signals_initialize( void )
                for (i=0; i<NUM_SIGS_TO_HANDLE; i++)
                     sigaddset( &mask, sigs_to_handle[i] );
 
+               if (D_TIMELINE_ENABLED())
+                    sigaddset( &mask, SIG_DUMP_TIMELINE );
+
                pthread_sigmask( SIG_BLOCK, &mask, NULL );
 
                sighandler_thread = direct_thread_create( DTT_CRITICAL, handle_signals, NULL, "SigHandler" );
@@ -427,6 +433,9 @@ signal_handler( int num )
      void         *addr = NULL;
      sigset_t      mask;
 
+     /* Get out what has been queued before, all following messages are written synchronously. */
+     direct_log_async_flush( true );
+
 #ifndef SA_SIGINFO
      D_LOG( Direct_Signals, FATAL, "    --> Caught signal %d <--\n", num );
 #else
@@ -493,6 +502,9 @@ signal_handler( int num )
      direct_trap( "SigHandler", num );
 
      pthread_sigmask( SIG_BLOCK, &mask, NULL );
+
+     /* Survived, queue messages again. */
+     direct_log_async_resume();
 #endif
 }
 
@@ -518,6 +530,9 @@ handle_signals( DirectThread *thread,
      sigaddset( &mask, SIG_CLOSE_SIGHANDLER );
      sigaddset( &mask, SIG_DUMP_STACK );
 
+     if (D_TIMELINE_ENABLED())
+          sigaddset( &mask, SIG_DUMP_TIMELINE );
+
      direct_sigprocmask( SIG_BLOCK, &mask, NULL );
 
 
@@ -552,6 +567,11 @@ handle_signals( DirectThread *thread,
 
                     call_handlers( info.si_signo, NULL );
                }
+               else if (SIG_DUMP_TIMELINE == info.si_signo) {
+                    D_DEBUG_AT( Direct_Signals, "  -> got timeline signal %d (me %d, from %d)\n", SIG_DUMP_TIMELINE, direct_getpid(), info.si_pid );
+
+                    direct_timeline_dump( NULL );
+               }
                else {
 #ifdef SA_SIGINFO
                     signal_handler( info.si_signo, &info, NULL );
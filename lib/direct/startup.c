@@ -0,0 +1,272 @@
+/*
+   (c) Copyright 2012-2013  DirectFB integrated media GmbH
+   (c) Copyright 2001-2013  The world wide DirectFB Open Source Community (directfb.org)
+   (c) Copyright 2000-2004  Convergence (integrated media) GmbH
+
+   All rights reserved.
+
+   Written by Denis Oliver Kropp <dok@directfb.org>,
+              Andreas Shimokawa <andi@directfb.org>,
+              Marek Pikarski <mass@directfb.org>,
+              Sven Neumann <neo@directfb.org>,
+              Ville Syrjälä <syrjala@sci.fi> and
+              Claudio Ciccani <klan@users.sf.net>.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+
+
+#include <config.h>
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <direct/debug.h>
+#include <direct/list.h>
+#include <direct/mem.h>
+#include <direct/messages.h>
+#include <direct/print.h>
+#include <direct/startup.h>
+#include <direct/thread.h>
+#include <direct/timeline.h>
+#include <direct/util.h>
+
+
+D_DEBUG_DOMAIN( Direct_Startup, "Direct/Startup", "Direct Startup Profile" );
+
+/**********************************************************************************************************************/
+
+typedef struct {
+     DirectLink           link;
+
+     const char          *category;
+     char                 name[96];
+     char                 thread[32];
+
+     long long            start;
+     long long            wall;
+     long long            cpu;
+
+     bool                 reported;
+} StartupRecord;
+
+/**********************************************************************************************************************/
+
+static DirectMutex  startup_lock;
+static DirectLink  *startup_records;
+
+/**********************************************************************************************************************/
+
+void
+__D_startup_init()
+{
+     direct_mutex_init( &startup_lock );
+}
+
+void
+__D_startup_deinit()
+{
+     DirectLink *link, *next;
+
+     /* Records stay until here, the timeline references their names. */
+     direct_list_foreach_safe (link, next, startup_records)
+          D_FREE( link );
+
+     startup_records = NULL;
+
+     direct_mutex_deinit( &startup_lock );
+}
+
+/**********************************************************************************************************************/
+
+void
+direct_startup_end( const DirectStartupSpan *span,
+                    const char              *category,
+                    const char              *format, ... )
+{
+     StartupRecord *record;
+     const char    *thread;
+     va_list        args;
+
+     D_ASSERT( span != NULL );
+     D_ASSERT( category != NULL );
+     D_ASSERT( format != NULL );
+
+     if (!D_STARTUP_ENABLED())
+          return;
+
+     record = D_CALLOC( 1, sizeof(StartupRecord) );
+     if (!record) {
+          D_OOM();
+          return;
+     }
+
+     record->category = category;
+     record->start    = span->wall;
+     record->wall     = direct_clock_get_time( DIRECT_CLOCK_MONOTONIC ) - span->wall;
+     record->cpu      = direct_clock_get_time( DIRECT_CLOCK_THREAD_CPUTIME_ID ) - span->cpu;
+
+     va_start( args, format );
+     direct_vsnprintf( record->name, sizeof(record->name), format, args );
+     va_end( args );
+
+     thread = direct_thread_self_name();
+
+     direct_snputs( record->thread, thread ? thread : "?", sizeof(record->thread) );
+
+     D_DEBUG_AT( Direct_Startup, "%s( %s, '%s' ) <- %lld us wall, %lld us cpu\n", __FUNCTION__,
+                 category, record->name, record->wall, record->cpu );
+
+     if (D_TIMELINE_ENABLED())
+          direct_timeline_record( DTLP_COMPLETE, category, record->name, 0, record->start, record->wall );
+
+     direct_mutex_lock( &startup_lock );
+
+     direct_list_append( &startup_records, &record->link );
+
+     direct_mutex_unlock( &startup_lock );
+}
+
+/**********************************************************************************************************************/
+
+static int
+compare_records( const void *a,
+                 const void *b )
+{
+     const StartupRecord *ra = *(const StartupRecord * const *) a;
+     const StartupRecord *rb = *(const StartupRecord * const *) b;
+
+     if (ra->wall != rb->wall)
+          return (ra->wall < rb->wall) ? 1 : -1;
+
+     return (ra->start < rb->start) ? -1 : (ra->start > rb->start);
+}
+
+static void
+write_report( FILE           *file,
+              const char     *title,
+              StartupRecord **records,
+              int             num,
+              long long       first )
+{
+     int       i;
+     long long now = direct_clock_get_time( DIRECT_CLOCK_MONOTONIC );
+
+     if (file)
+          fprintf( file, "%-42s%14s%12s%12s  thread\n", title, "wall ms", "cpu ms", "start ms" );
+     else
+          direct_log_printf( NULL, "%-42s%14s%12s%12s  thread\n", title, "wall ms", "cpu ms", "start ms" );
+
+     for (i=0; i<num; i++) {
+          const StartupRecord *record = records[i];
+          char                 name[48];
+
+          direct_snprintf( name, sizeof(name), "%-10s %s", record->category, record->name );
+
+          if (file)
+               fprintf( file, "  %-40s %9lld.%03lld %7lld.%03lld %7lld.%03lld  %s\n", name,
+                        record->wall / 1000, record->wall % 1000, record->cpu / 1000, record->cpu % 1000,
+                        (record->start - first) / 1000, (record->start - first) % 1000, record->thread );
+          else
+               direct_log_printf( NULL, "  %-40s %9lld.%03lld %7lld.%03lld %7lld.%03lld  %s\n", name,
+                                  record->wall / 1000, record->wall % 1000, record->cpu / 1000, record->cpu % 1000,
+                                  (record->start - first) / 1000, (record->start - first) % 1000, record->thread );
+     }
+
+     if (file)
+          fprintf( file, "  %-40s %9lld.%03lld\n", "(total)", (now - first) / 1000, (now - first) % 1000 );
+     else
+          direct_log_printf( NULL, "  %-40s %9lld.%03lld\n", "(total)", (now - first) / 1000, (now - first) % 1000 );
+}
+
+DirectResult
+direct_startup_report( const char *title,
+                       const char *filename )
+{
+     FILE           *file = NULL;
+     StartupRecord  *record;
+     StartupRecord **records;
+     int             num   = 0;
+     long long       first = 0;
+
+     D_DEBUG_AT( Direct_Startup, "%s( '%s', '%s' )\n", __FUNCTION__, title, filename );
+
+     if (!D_STARTUP_ENABLED())
+          return DR_OK;
+
+     if (!title)
+          title = "Startup Profile";
+
+     if (!filename)
+          filename = direct_config->startup_profile_file;
+
+     direct_mutex_lock( &startup_lock );
+
+     direct_list_foreach (record, startup_records) {
+          if (!record->reported)
+               num++;
+     }
+
+     if (!num) {
+          direct_mutex_unlock( &startup_lock );
+          return DR_OK;
+     }
+
+     records = D_MALLOC( num * sizeof(StartupRecord*) );
+     if (!records) {
+          direct_mutex_unlock( &startup_lock );
+          return D_OOM();
+     }
+
+     num = 0;
+
+     direct_list_foreach (record, startup_records) {
+          if (record->reported)
+               continue;
+
+          if (!num || record->start < first)
+               first = record->start;
+
+          record->reported = true;
+
+          records[num++] = record;
+     }
+
+     direct_mutex_unlock( &startup_lock );
+
+     qsort( records, num, sizeof(StartupRecord*), compare_records );
+
+     if (filename) {
+          file = fopen( filename, "a" );
+          if (!file)
+               D_PERROR( "Direct/Startup: Could not open '%s' for writing!\n", filename );
+     }
+
+     write_report( file, title, records, num, first );
+
+     if (file)
+          fclose( file );
+
+     D_FREE( records );
+
+     if (D_TIMELINE_ENABLED())
+          direct_timeline_dump( NULL );
+
+     return DR_OK;
+}
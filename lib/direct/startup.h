@@ -0,0 +1,87 @@
+/*
+   (c) Copyright 2012-2013  DirectFB integrated media GmbH
+   (c) Copyright 2001-2013  The world wide DirectFB Open Source Community (directfb.org)
+   (c) Copyright 2000-2004  Convergence (integrated media) GmbH
+
+   All rights reserved.
+
+   Written by Denis Oliver Kropp <dok@directfb.org>,
+              Andreas Shimokawa <andi@directfb.org>,
+              Marek Pikarski <mass@directfb.org>,
+              Sven Neumann <neo@directfb.org>,
+              Ville Syrjälä <syrjala@sci.fi> and
+              Claudio Ciccani <klan@users.sf.net>.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+
+
+#ifndef __DIRECT__STARTUP_H__
+#define __DIRECT__STARTUP_H__
+
+#include <direct/clock.h>
+#include <direct/compiler.h>
+#include <direct/conf.h>
+
+/*
+ * Startup profile of steps like core parts, module loads or device probing.
+ *
+ * Enabled via "startup-profile[=<file>]", each span records wall and thread CPU time and
+ * direct_startup_report() writes them sorted by wall time. Spans nest, so times are inclusive.
+ * While the timeline is recording (see direct/timeline.h), spans are added to it as well.
+ */
+
+typedef struct {
+     long long                wall;
+     long long                cpu;
+} DirectStartupSpan;
+
+/**********************************************************************************************************************/
+
+#define D_STARTUP_ENABLED()                    (direct_config->startup_profile)
+
+/*
+ * Takes the start time unconditionally, so that spans begun before the configuration is
+ * parsed are recorded, too. Both clocks are cheap compared to the steps being measured.
+ */
+static __inline__ void
+direct_startup_begin( DirectStartupSpan *span )
+{
+     span->wall = direct_clock_get_time( DIRECT_CLOCK_MONOTONIC );
+     span->cpu  = direct_clock_get_time( DIRECT_CLOCK_THREAD_CPUTIME_ID );
+}
+
+/*
+ * Records the span with the formatted name, unless profiling is disabled.
+ */
+void         DIRECT_API direct_startup_end   ( const DirectStartupSpan *span,
+                                               const char              *category,
+                                               const char              *format, ... )  D_FORMAT_PRINTF(3);
+
+/*
+ * Writes spans recorded since the last report to the file, or to "startup-profile=<file>",
+ * or to the log if both are NULL. Also dumps the timeline if it is recording.
+ */
+DirectResult DIRECT_API direct_startup_report( const char              *title,
+                                               const char              *filename );
+
+/**********************************************************************************************************************/
+
+void __D_startup_init( void );
+void __D_startup_deinit( void );
+
+#endif
@@ -33,9 +33,14 @@
 #include <config.h>
 
 #include <sys/stat.h>
+#ifndef WIN32
+#include <sys/mman.h>
+#endif
 
 #include <direct/build.h>
 
+#include <direct/clock.h>
+#include <direct/conf.h>
 #include <direct/filesystem.h>
 #include <direct/mem.h>
 #include <direct/memcpy.h>
@@ -44,16 +49,20 @@
 #include <direct/util.h>
 
 #include <direct/stream.h>
+#include <direct/thread.h>
 
 
 D_LOG_DOMAIN( Direct_Stream, "Direct/Stream", "Stream wrapper" );
 
 
 #if DIRECT_BUILD_NETWORK
+#include <dirent.h>
 #include <sys/select.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <netdb.h>
+
+typedef struct __D_HTTPPrefetch HTTPPrefetch;
 #endif
 
 
@@ -73,6 +82,10 @@ struct __D_DirectStream {
      void                 *cache;
      unsigned int          cache_size;
 
+     /* mapping of regular files, see direct_stream_map() */
+     void                 *map;
+     size_t                map_length;
+
 #if DIRECT_BUILD_NETWORK
      /* remote streams data */
      struct {
@@ -94,6 +107,8 @@ struct __D_DirectStream {
 
           bool             real_rtsp;
           bool             real_pack;
+
+          HTTPPrefetch    *prefetch;
      } remote;
 #endif
 
@@ -222,20 +237,36 @@ net_response( DirectStream *stream, char *buf, size_t size )
 {
      fd_set         set;
      struct timeval tv;
-     int            i;
+     int            i = 0;
 
-     FD_ZERO( &set );
-     FD_SET( stream->remote.sd, &set );
+     /* Peek at the pending data and consume it up to the end of the line only,
+        anything following (e.g. the body after the headers) stays in the socket. */
+     while (i < size-1) {
+          char *nl;
+          int   len;
+
+          FD_ZERO( &set );
+          FD_SET( stream->remote.sd, &set );
 
-     for (i = 0; i < size-1; i++) {
           tv.tv_sec  = NET_TIMEOUT;
           tv.tv_usec = 0;
           select( stream->remote.sd+1, &set, NULL, NULL, &tv );
 
-          if (recv( stream->remote.sd, buf+i, 1, 0 ) != 1)
+          len = recv( stream->remote.sd, buf+i, size-1-i, MSG_PEEK );
+          if (len <= 0)
+               break;
+
+          nl = memchr( buf+i, '\n', len );
+          if (nl)
+               len = nl - (buf+i) + 1;
+
+          if (recv( stream->remote.sd, buf+i, len, 0 ) != len)
                break;
 
-          if (buf[i] == '\n') {
+          i += len;
+
+          if (nl) {
+               i--;
                if (i > 0 && buf[i-1] == '\r')
                     i--;
                break;
@@ -441,146 +472,1277 @@ net_connect( struct addrinfo *addr, int sock, int proto, int *ret_fd )
                               continue;
                          }
 
-                         setsockopt( fd, SOL_SOCKET, SO_REUSEADDR, saddr, sizeof(*saddr) );
-                    }
-               }
+                         setsockopt( fd, SOL_SOCKET, SO_REUSEADDR, saddr, sizeof(*saddr) );
+                    }
+               }
+
+               FD_ZERO( &s );
+               FD_SET( fd, &s );
+
+               err = select( fd+1, NULL, &s, NULL, &t );
+               if (err < 1) {
+                    D_DEBUG_AT( Direct_Stream, "...connection failed.\n" );
+
+                    close( fd );
+                    fd = -1;
+
+                    if (err == 0) {
+                         ret = DR_TIMEOUT;
+                         continue;
+                    } else {
+                         ret = errno2result( errno );
+                         break;
+                    }
+               }
+
+               D_DEBUG_AT( Direct_Stream, "...connected.\n" );
+
+               ret = DR_OK;
+               break;
+          }
+     }
+
+     *ret_fd = fd;
+
+     return ret;
+}
+
+static DirectResult
+net_open( DirectStream *stream, const char *filename, int proto )
+{
+     DirectResult    ret  = DR_OK;
+     int             sock = (proto == IPPROTO_TCP) ? SOCK_STREAM : SOCK_DGRAM;
+     struct addrinfo hints;
+     char            port[16];
+
+     parse_url( filename,
+                &stream->remote.host,
+                &stream->remote.port,
+                &stream->remote.user,
+                &stream->remote.pass,
+                &stream->remote.path );
+
+     direct_snprintf( port, sizeof(port), "%d", stream->remote.port );
+
+     memset( &hints, 0, sizeof(hints) );
+     hints.ai_flags    = AI_CANONNAME;
+     hints.ai_socktype = sock;
+     hints.ai_family   = PF_UNSPEC;
+
+     if (getaddrinfo( stream->remote.host, port, &hints, &stream->remote.addr )) {
+          /* give it a second chance without AI_CANONNAME which fails on some platforms */
+          hints.ai_flags = 0;
+          if (getaddrinfo( stream->remote.host, port, &hints, &stream->remote.addr )) {
+               D_ERROR( "Direct/Stream: failed to resolve host '%s'!\n", stream->remote.host );
+               return DR_FAILURE;
+          }
+     }
+
+     ret = net_connect( stream->remote.addr, sock, proto, &stream->remote.sd );
+     if (ret)
+          return ret;
+
+     stream->fd     = stream->remote.sd;
+     stream->length = -1;
+     stream->wait   = net_wait;
+     stream->peek   = net_peek;
+     stream->read   = net_read;
+
+     return ret;
+}
+
+/*****************************************************************************/
+
+typedef struct {
+     int        status;
+     int        version;      /* minor version of the HTTP/1.x response */
+     long long  length;       /* Content-Length, -1 if not sent */
+     long long  total;        /* complete length from Content-Range, -1 if unknown */
+     bool       ranges;       /* Accept-Ranges other than 'none' */
+     bool       chunked;      /* Transfer-Encoding: chunked */
+     bool       keepalive;    /* connection stays open after the body */
+     char      *mime;
+     char      *location;
+     char      *validator;    /* ETag or Last-Modified */
+} HTTPResponse;
+
+static void
+http_response_free( HTTPResponse *response )
+{
+     if (response->mime)
+          D_FREE( response->mime );
+
+     if (response->location)
+          D_FREE( response->location );
+
+     if (response->validator)
+          D_FREE( response->validator );
+}
+
+/*
+ * Send a GET request on the current connection and parse the response headers.
+ *
+ * Bytes 'start' to 'end' are requested, open ended if 'end' is negative, the whole resource if 'start' is negative.
+ * Returns DR_IO if no status line could be received.
+ */
+static DirectResult
+http_request( DirectStream *stream,
+              long long     start,
+              long long     end,
+              bool          keepalive,
+              HTTPResponse *response )
+{
+     char buf[1280];
+     int  len;
+
+     memset( response, 0, sizeof(HTTPResponse) );
+
+     response->length = -1;
+     response->total  = -1;
+
+     len = direct_snprintf( buf, sizeof(buf),
+                     "GET %s HTTP/1.%d\r\n"
+                     "Host: %s:%d\r\n",
+                     stream->remote.path, keepalive ? 1 : 0,
+                     stream->remote.host,
+                     stream->remote.port );
+     if (stream->remote.auth) {
+          len += direct_snprintf( buf+len, sizeof(buf)-len,
+                           "Authorization: Basic %s\r\n",
+                           stream->remote.auth );
+     }
+     len += direct_snprintf( buf+len, sizeof(buf)-len,
+                      "User-Agent: DirectFB/%s\r\n"
+                      "Accept: */*\r\n",
+                      DIRECTFB_VERSION );
+     if (start >= 0) {
+          if (end >= 0)
+               len += direct_snprintf( buf+len, sizeof(buf)-len,
+                                "Range: bytes=%lld-%lld\r\n", start, end );
+          else
+               len += direct_snprintf( buf+len, sizeof(buf)-len,
+                                "Range: bytes=%lld-\r\n", start );
+     }
+     direct_snprintf( buf+len, sizeof(buf)-len,
+               "Connection: %s\r\n",
+               keepalive ? "Keep-Alive" : "Close" );
+
+     response->status = net_command( stream, buf, sizeof(buf) );
+     if (!response->status)
+          return DR_IO;
+
+     sscanf( buf, "HTTP/1.%d", &response->version );
+
+     response->keepalive = keepalive && response->version > 0;
+
+     while (net_response( stream, buf, sizeof(buf) ) > 0) {
+          if (!strncasecmp( buf, "Accept-Ranges:", 14 )) {
+               if (strcmp( trim( buf+14 ), "none" ))
+                    response->ranges = true;
+          }
+          else if (!strncasecmp( buf, "Content-Type:", 13 )) {
+               char *mime = trim( buf+13 );
+               char *tmp  = strchr( mime, ';' );
+               if (tmp)
+                    *tmp = '\0';
+               if (response->mime)
+                    D_FREE( response->mime );
+               response->mime = D_STRDUP( mime );
+          }
+          else if (!strncasecmp( buf, "Content-Length:", 15 )) {
+               char *tmp = trim( buf+15 );
+               if (sscanf( tmp, "%lld", &response->length ) < 1)
+                    sscanf( tmp, "bytes=%lld", &response->length );
+          }
+          else if (!strncasecmp( buf, "Content-Range:", 14 )) {
+               char *tmp = trim( buf+14 );
+               if (sscanf( tmp, "bytes %*d-%*d/%lld", &response->total ) < 1)
+                    sscanf( tmp, "bytes */%lld", &response->total );
+          }
+          else if (!strncasecmp( buf, "Transfer-Encoding:", 18 )) {
+               if (!strcasecmp( trim( buf+18 ), "chunked" ))
+                    response->chunked = true;
+          }
+          else if (!strncasecmp( buf, "Connection:", 11 )) {
+               char *tmp = trim( buf+11 );
+               if (!strcasecmp( tmp, "close" ))
+                    response->keepalive = false;
+               else if (!strcasecmp( tmp, "keep-alive" ))
+                    response->keepalive = keepalive;
+          }
+          else if (!strncasecmp( buf, "ETag:", 5 )) {
+               if (response->validator)
+                    D_FREE( response->validator );
+               response->validator = D_STRDUP( trim( buf+5 ) );
+          }
+          else if (!strncasecmp( buf, "Last-Modified:", 14 )) {
+               if (!response->validator)
+                    response->validator = D_STRDUP( trim( buf+14 ) );
+          }
+          else if (!strncasecmp( buf, "Location:", 9 )) {
+               if (response->location)
+                    D_FREE( response->location );
+               response->location = D_STRDUP( trim( buf+9 ) );
+          }
+     }
+
+     /* Without length or chunks the body ends when the connection gets closed. */
+     if (!response->chunked && response->length < 0)
+          response->keepalive = false;
+
+     return DR_OK;
+}
+
+static DirectResult
+http_seek( DirectStream *stream, unsigned int offset )
+{
+     DirectResult ret;
+     HTTPResponse response;
+
+     close( stream->remote.sd );
+     stream->remote.sd = -1;
+
+     ret = net_connect( stream->remote.addr,
+                        SOCK_STREAM, IPPROTO_TCP, &stream->remote.sd );
+     if (ret)
+          return ret;
+
+     stream->fd = stream->remote.sd;
+
+     ret = http_request( stream, offset, -1, false, &response );
+     if (ret)
+          return DR_FAILURE;
+
+     http_response_free( &response );
+
+     switch (response.status) {
+          case 200 ... 299:
+               stream->offset = offset;
+               break;
+          default:
+               D_DEBUG_AT( Direct_Stream,
+                           "server returned status %d.\n", response.status );
+               return DR_FAILURE;
+     }
+
+     return DR_OK;
+}
+
+/*****************************************************************************/
+
+/*
+ * Prefetching of HTTP streams
+ *
+ * A thread per stream keeps a ring buffer filled ahead of the read position, so reading does not wait for
+ * the network as long as the connection keeps up. If the server supports ranges, the data is requested in
+ * chunks of the ring size over a kept alive connection. Seeking then needs another request on the same
+ * connection, after draining at most HTTP_DRAIN_MAX bytes of the current chunk, and seeking forward within
+ * the buffered data does not touch the network at all.
+ *
+ * With the option 'stream-cache=<directory>', complete blocks of streams with known length are also written
+ * to a small on-disk cache (up to 'stream-cache-limit' KiB per stream), serving repeated and backward reads.
+ * The cache is keyed by the URL and validated by the length and the ETag or Last-Modified header, streams
+ * without either are not cached. The least recently used streams are removed to keep the whole directory
+ * below 'stream-cache-size' KiB.
+ */
+
+#define HTTP_DRAIN_MAX      (64 * 1024)
+#define HTTP_MAX_RETRIES    3
+#define HTTP_CACHE_BLOCK    (64 * 1024)
+
+typedef struct {
+     char             magic[8];
+     long long        length;
+     unsigned int     block_size;
+     char             validator[116];
+} HTTPCacheHeader;
+
+struct __D_HTTPPrefetch {
+     DirectStream    *stream;
+     DirectThread    *thread;
+
+     DirectMutex      lock;
+     DirectWaitQueue  cond;
+     int              wakeup[2];     /* pipe interrupting the thread while waiting for the network */
+     bool             fetching;      /* thread works without holding the lock */
+
+     /* ring buffer starting at the stream offset */
+     u8              *ring;
+     unsigned int     size;
+     unsigned int     head;
+     unsigned int     fill;
+     long long        pos;           /* stream position following the buffered data */
+
+     DirectResult     error;         /* DR_EOF or a failure stopping the prefetch until the next seek */
+     bool             seeking;
+     unsigned int     seek_offset;
+     DirectResult     seek_result;
+     bool             quit;
+
+     /* connection state, used by the thread only */
+     long long        conn_pos;      /* stream position of the next body byte */
+     long long        body;          /* remaining body bytes, -1 if unknown, 0 if complete */
+     unsigned int     chunk;         /* remaining bytes of the current transfer chunk */
+     bool             chunked;
+     bool             chunk_crlf;    /* CRLF of the previous chunk not read yet */
+     bool             keepalive;
+     bool             ranges;
+     bool             open_ended;    /* response runs to the end of the resource */
+     int              retries;
+
+     /* on-disk cache */
+     int              cache_fd;
+     int              map_fd;
+     u8              *map;
+     unsigned int     blocks;
+     unsigned int     cache_mark;    /* next block to be marked complete */
+     long long        cache_end;     /* end of the contiguous range being written */
+     long long        cache_written;
+     long long        cache_limit;
+};
+
+static unsigned int
+http_prefetch_size( void )
+{
+     long long kb = direct_config_get_int_value_with_default( "stream-prefetch", 256 );
+
+     return (kb > 0) ? kb * 1024 : 0;
+}
+
+/*
+ * Usage of a cache file, counting allocated blocks so sparse files count what they really take.
+ */
+static long long
+http_cache_usage( const char *name, time_t *ret_mtime )
+{
+     struct stat st;
+
+     if (stat( name, &st ))
+          return 0;
+
+     if (ret_mtime)
+          *ret_mtime = st.st_mtime;
+
+     return st.st_blocks * 512LL;
+}
+
+/*
+ * Removes the least recently used streams (except 'keep') from the cache directory
+ * until another 'need' bytes fit into the total size.
+ */
+static void
+http_cache_evict( const char *dir, unsigned long long keep, long long need, long long total )
+{
+     char name[1024];
+
+     while (true) {
+          DIR                *d;
+          struct dirent      *entry;
+          long long           usage  = 0;
+          unsigned long long  oldest = 0;
+          time_t              oldest_mtime = 0;
+          bool                found  = false;
+
+          d = opendir( dir );
+          if (!d)
+               return;
+
+          while ((entry = readdir( d )) != NULL) {
+               unsigned long long hash;
+               char               suffix[8];
+               time_t             mtime = 0;
+
+               if (sscanf( entry->d_name, "%16llx.%7s", &hash, suffix ) != 2 ||
+                   (strcmp( suffix, "data" ) && strcmp( suffix, "map" )))
+                    continue;
+
+               if (hash == keep)
+                    continue;
+
+               direct_snprintf( name, sizeof(name), "%s/%s", dir, entry->d_name );
+               usage += http_cache_usage( name, &mtime );
+
+               if (!found || mtime < oldest_mtime) {
+                    found        = true;
+                    oldest       = hash;
+                    oldest_mtime = mtime;
+               }
+          }
+
+          closedir( d );
+
+          if (!found || usage + need <= total)
+               return;
+
+          D_DEBUG_AT( Direct_Stream, "  -> evicting %016llx from cache (%lld + %lld > %lld)\n", oldest, usage, need, total );
+
+          direct_snprintf( name, sizeof(name), "%s/%016llx.map", dir, oldest );
+          unlink( name );
+
+          direct_snprintf( name, sizeof(name), "%s/%016llx.data", dir, oldest );
+          unlink( name );
+     }
+}
+
+static void
+http_cache_open( DirectStream *stream, HTTPPrefetch *pf, const char *validator )
+{
+     char            *dir;
+     int              num;
+     char             name[1024];
+     unsigned long long hash = 0xcbf29ce484222325ULL;
+     HTTPCacheHeader  header;
+     HTTPCacheHeader  stored;
+     const char      *c;
+     long long        total;
+
+     if (stream->length <= 0 || !pf->ranges)
+          return;
+
+     /* Without a validator (or a truncated one) a changed resource could not be detected. */
+     if (!validator || strlen( validator ) >= sizeof(header.validator)) {
+          D_DEBUG_AT( Direct_Stream, "  -> no usable ETag or Last-Modified, not caching\n" );
+          return;
+     }
+
+     if (direct_config_get( "stream-cache", &dir, 1, &num ) || !num)
+          return;
+
+     /* FNV-1a of the URL */
+     direct_snprintf( name, sizeof(name), "%s:%d%s",
+                      stream->remote.host, stream->remote.port, stream->remote.path );
+
+     for (c = name; *c; c++) {
+          hash ^= (u8) *c;
+          hash *= 0x100000001b3ULL;
+     }
+
+     total = direct_config_get_int_value_with_default( "stream-cache-size", 65536 ) * 1024;
+
+     pf->cache_limit = direct_config_get_int_value_with_default( "stream-cache-limit", 16384 ) * 1024;
+     pf->cache_limit = MIN( pf->cache_limit, MIN( stream->length, total ) );
+
+     if (pf->cache_limit <= 0)
+          return;
+
+     /* Make room for this stream growing to its limit. */
+     http_cache_evict( dir, hash, pf->cache_limit, total );
+
+     direct_snprintf( name, sizeof(name), "%s/%016llx.data", dir, hash );
+
+     pf->cache_fd = open( name, O_RDWR | O_CREAT, 0644 );
+     if (pf->cache_fd < 0) {
+          D_DEBUG_AT( Direct_Stream, "  -> could not open cache file '%s'!\n", name );
+          return;
+     }
+
+     direct_snprintf( name, sizeof(name), "%s/%016llx.map", dir, hash );
+
+     pf->map_fd = open( name, O_RDWR | O_CREAT, 0644 );
+     if (pf->map_fd < 0) {
+          D_DEBUG_AT( Direct_Stream, "  -> could not open cache map '%s'!\n", name );
+          close( pf->cache_fd );
+          pf->cache_fd = -1;
+          return;
+     }
+
+     memset( &header, 0, sizeof(header) );
+     memcpy( header.magic, "DSCACHE1", 8 );
+
+     header.length     = stream->length;
+     header.block_size = HTTP_CACHE_BLOCK;
+
+     direct_snputs( header.validator, validator, sizeof(header.validator) );
+
+     pf->blocks = (stream->length + HTTP_CACHE_BLOCK - 1) / HTTP_CACHE_BLOCK;
+
+     pf->map = D_CALLOC( pf->blocks, 1 );
+     if (!pf->map) {
+          D_OOM();
+          close( pf->map_fd );
+          close( pf->cache_fd );
+          pf->map_fd   = -1;
+          pf->cache_fd = -1;
+          return;
+     }
+
+     if (pread( pf->map_fd, &stored, sizeof(stored), 0 ) == sizeof(stored) && !memcmp( &stored, &header, sizeof(header) )) {
+          if (pread( pf->map_fd, pf->map, pf->blocks, sizeof(header) ) < 0)
+               memset( pf->map, 0, pf->blocks );
+     }
+     else {
+          D_DEBUG_AT( Direct_Stream, "  -> starting new cache for %016llx\n", hash );
+
+          /* New or changed resource. */
+          if (ftruncate( pf->map_fd, 0 ) || ftruncate( pf->cache_fd, 0 ) ||
+              pwrite( pf->map_fd, &header, sizeof(header), 0 ) != sizeof(header))
+          {
+               D_FREE( pf->map );
+               pf->map = NULL;
+               return;
+          }
+     }
+
+     /* Mark as recently used, the file times order the eviction. */
+     futimens( pf->map_fd, NULL );
+     futimens( pf->cache_fd, NULL );
+
+     direct_snprintf( name, sizeof(name), "%s/%016llx.data", dir, hash );
+
+     /* The limit covers what earlier opens have cached already. */
+     pf->cache_written = http_cache_usage( name, NULL );
+     pf->cache_end     = -1;
+}
+
+static void
+http_cache_close( HTTPPrefetch *pf )
+{
+     if (pf->map) {
+          D_FREE( pf->map );
+          pf->map = NULL;
+     }
+
+     if (pf->map_fd >= 0) {
+          close( pf->map_fd );
+          pf->map_fd = -1;
+     }
+
+     if (pf->cache_fd >= 0) {
+          close( pf->cache_fd );
+          pf->cache_fd = -1;
+     }
+}
+
+static inline bool
+http_cache_has( HTTPPrefetch *pf, long long pos )
+{
+     return pf->map && pos < pf->stream->length && pf->map[pos / HTTP_CACHE_BLOCK];
+}
+
+static DirectResult
+http_cache_read( HTTPPrefetch *pf,
+                 long long     pos,
+                 void         *buf,
+                 unsigned int  length,
+                 unsigned int *ret_read )
+{
+     unsigned int block = pos / HTTP_CACHE_BLOCK;
+     ssize_t      len;
+
+     if (!http_cache_has( pf, pos ))
+          return DR_ITEMNOTFOUND;
+
+     length = MIN( length, MIN( (block + 1) * (long long) HTTP_CACHE_BLOCK, pf->stream->length ) - pos );
+
+     /* A short read means the file has been truncated behind our back, forget the block. */
+     len = pread( pf->cache_fd, buf, length, pos );
+     if (len < (ssize_t) length) {
+          D_DEBUG_AT( Direct_Stream, "  -> short read of cached block %u (%zd/%u)\n", block, len, length );
+
+          pf->map[block] = 0;
+
+          if (pwrite( pf->map_fd, &pf->map[block], 1, sizeof(HTTPCacheHeader) + block ) != 1)
+               D_DEBUG_AT( Direct_Stream, "  -> writing cache map failed\n" );
+
+          return DR_ITEMNOTFOUND;
+     }
+
+     *ret_read = len;
+
+     return DR_OK;
+}
+
+static void
+http_cache_write( HTTPPrefetch *pf,
+                  long long     pos,
+                  const void   *buf,
+                  unsigned int  length )
+{
+     if (!pf->map || pf->cache_written + length > pf->cache_limit)
+          return;
+
+     /* Blocks are only complete if written from their beginning on. */
+     if (pos != pf->cache_end)
+          pf->cache_mark = (pos + HTTP_CACHE_BLOCK - 1) / HTTP_CACHE_BLOCK;
+
+     if (pwrite( pf->cache_fd, buf, length, pos ) != length) {
+          D_DEBUG_AT( Direct_Stream, "  -> writing to cache failed, disabling it\n" );
+          http_cache_close( pf );
+          return;
+     }
+
+     pf->cache_end      = pos + length;
+     pf->cache_written += length;
+
+     while (pf->cache_mark < pf->blocks) {
+          long long end = MIN( (pf->cache_mark + 1) * (long long) HTTP_CACHE_BLOCK, pf->stream->length );
+
+          if (end > pf->cache_end)
+               break;
+
+          if (!pf->map[pf->cache_mark]) {
+               pf->map[pf->cache_mark] = 1;
+
+               if (pwrite( pf->map_fd, &pf->map[pf->cache_mark], 1, sizeof(HTTPCacheHeader) + pf->cache_mark ) != 1)
+                    D_DEBUG_AT( Direct_Stream, "  -> writing cache map failed\n" );
+          }
+
+          pf->cache_mark++;
+     }
+}
+
+static void
+http_prefetch_interrupt( HTTPPrefetch *pf )
+{
+     char c = 0;
+
+     if (pf->fetching && write( pf->wakeup[1], &c, 1 ) < 0)
+          D_DEBUG_AT( Direct_Stream, "  -> could not wake up prefetch thread\n" );
+}
+
+static void
+http_prefetch_disconnect( DirectStream *stream, HTTPPrefetch *pf )
+{
+     if (stream->remote.sd >= 0) {
+          close( stream->remote.sd );
+          stream->remote.sd = -1;
+     }
+
+     pf->body = 0;
+}
+
+/*
+ * Receive body data of the current response at 'conn_pos', sets 'body' to 0 at its end.
+ */
+static DirectResult
+http_prefetch_recv( DirectStream *stream,
+                    HTTPPrefetch *pf,
+                    void         *buf,
+                    unsigned int  length,
+                    unsigned int *ret_read )
+{
+     fd_set         set;
+     struct timeval tv = { NET_TIMEOUT, 0 };
+     int            sd = stream->remote.sd;
+     ssize_t        len;
+
+     *ret_read = 0;
+
+     if (!pf->body || sd < 0)
+          return DR_OK;
+
+     if (pf->chunked && !pf->chunk) {
+          char line[64];
+
+          if (pf->chunk_crlf)
+               net_response( stream, line, sizeof(line) );
+
+          if (!net_response( stream, line, sizeof(line) ))
+               return DR_IO;
+
+          pf->chunk      = strtoul( line, NULL, 16 );
+          pf->chunk_crlf = true;
+
+          if (!pf->chunk) {
+               /* skip trailer */
+               while (net_response( stream, line, sizeof(line) ) > 0);
+
+               pf->body       = 0;
+               pf->chunk_crlf = false;
+
+               return DR_OK;
+          }
+     }
+
+     if (pf->body > 0)
+          length = MIN( length, pf->body );
+
+     if (pf->chunked)
+          length = MIN( length, pf->chunk );
+
+     FD_ZERO( &set );
+     FD_SET( sd, &set );
+     FD_SET( pf->wakeup[0], &set );
+
+     switch (select( MAX( sd, pf->wakeup[0] ) + 1, &set, NULL, NULL, &tv )) {
+          case 0:
+               return DR_TIMEOUT;
+          case -1:
+               return (errno == EINTR) ? DR_INTERRUPTED : errno2result( errno );
+     }
+
+     if (FD_ISSET( pf->wakeup[0], &set )) {
+          char c[16];
+
+          while (read( pf->wakeup[0], c, sizeof(c) ) > 0);
+
+          return DR_INTERRUPTED;
+     }
+
+     len = recv( sd, buf, length, 0 );
+     switch (len) {
+          case 0:
+               http_prefetch_disconnect( stream, pf );
+
+               /* End of a body without length? */
+               if (pf->open_ended && !pf->chunked && stream->length < 0)
+                    return DR_OK;
+
+               return DR_IO;
+          case -1:
+               if (errno == EAGAIN || errno == EWOULDBLOCK)
+                    return DR_OK;
+               return errno2result( errno );
+     }
+
+     pf->conn_pos += len;
+
+     if (pf->body > 0)
+          pf->body -= len;
+
+     if (pf->chunked)
+          pf->chunk -= len;
+
+     *ret_read = len;
+
+     return DR_OK;
+}
+
+static DirectResult
+http_prefetch_drain( DirectStream *stream, HTTPPrefetch *pf, long long length )
+{
+     DirectResult ret;
+     char         buf[4096];
+     unsigned int size;
+
+     while (length > 0 && pf->body) {
+          ret = http_prefetch_recv( stream, pf, buf, MIN( length, sizeof(buf) ), &size );
+          if (ret)
+               return ret;
+
+          length -= size;
+     }
+
+     return DR_OK;
+}
+
+/*
+ * Make the connection deliver the body at 'pos', reusing the response in flight or the kept alive connection.
+ */
+static DirectResult
+http_prefetch_position( DirectStream *stream, HTTPPrefetch *pf, long long pos )
+{
+     DirectResult ret;
+     HTTPResponse response;
+     long long    end = -1;
+     bool         reuse;
+
+     if (stream->length >= 0 && pos >= stream->length)
+          return DR_EOF;
+
+     if (stream->remote.sd >= 0 && pf->body) {
+          long long skip = pos - pf->conn_pos;
+
+          /* Response in flight at or shortly before the position? */
+          if (skip >= 0 && skip <= HTTP_DRAIN_MAX && (pf->body < 0 || skip < pf->body))
+               return http_prefetch_drain( stream, pf, skip );
+
+          /* Keep the connection if only a little is left over. */
+          if (pf->keepalive && pf->body > 0 && pf->body <= HTTP_DRAIN_MAX) {
+               D_DEBUG_AT( Direct_Stream, "  -> draining %lld bytes\n", pf->body );
+
+               ret = http_prefetch_drain( stream, pf, pf->body );
+               if (ret)
+                    return ret;
+          }
+          else
+               http_prefetch_disconnect( stream, pf );
+     }
+     else if (!pf->body && pf->open_ended && pos == pf->conn_pos)
+          return DR_EOF;
+
+     if (pf->ranges && stream->length >= 0)
+          end = MIN( pos + pf->size, stream->length ) - 1;
+
+     D_DEBUG_AT( Direct_Stream, "  -> requesting %lld-%lld\n", pos, end );
+
+     reuse = stream->remote.sd >= 0 && pf->keepalive;
+
+     while (true) {
+          if (!reuse) {
+               http_prefetch_disconnect( stream, pf );
+
+               ret = net_connect( stream->remote.addr, SOCK_STREAM, IPPROTO_TCP, &stream->remote.sd );
+               if (ret)
+                    return ret;
+          }
+
+          ret = http_request( stream, (pos || end >= 0) ? pos : -1, end, true, &response );
+          if (ret && reuse) {
+               /* idle connection closed by the server */
+               reuse = false;
+               continue;
+          }
+
+          break;
+     }
+
+     if (ret) {
+          http_prefetch_disconnect( stream, pf );
+          return ret;
+     }
+
+     http_response_free( &response );
+
+     pf->body       = response.chunked ? -1 : response.length;
+     pf->chunk      = 0;
+     pf->chunked    = response.chunked;
+     pf->chunk_crlf = false;
+     pf->keepalive  = response.keepalive;
+
+     if (response.status == 206) {
+          pf->conn_pos   = pos;
+          pf->open_ended = end < 0;
+     }
+     else if (response.status >= 200 && response.status < 300) {
+          /* range ignored, the whole resource follows */
+          pf->conn_pos   = 0;
+          pf->open_ended = true;
+          pf->ranges     = false;
+
+          return http_prefetch_drain( stream, pf, pos );
+     }
+     else if (response.status == 416) {
+          http_prefetch_disconnect( stream, pf );
+
+          pf->conn_pos   = pos;
+          pf->open_ended = true;
+
+          return DR_EOF;
+     }
+     else {
+          D_DEBUG_AT( Direct_Stream, "server returned status %d.\n", response.status );
+
+          http_prefetch_disconnect( stream, pf );
+
+          return (response.status == 404) ? DR_FILENOTFOUND : DR_FAILURE;
+     }
+
+     return DR_OK;
+}
+
+static DirectResult
+http_prefetch_fetch( DirectStream *stream,
+                     HTTPPrefetch *pf,
+                     long long     pos,
+                     void         *buf,
+                     unsigned int  length,
+                     unsigned int *ret_read )
+{
+     DirectResult ret;
+
+     *ret_read = 0;
+
+     if (stream->length >= 0) {
+          if (pos >= stream->length)
+               return DR_EOF;
+
+          length = MIN( length, stream->length - pos );
+     }
+
+     if (http_cache_read( pf, pos, buf, length, ret_read ) == DR_OK)
+          return DR_OK;
+
+     ret = http_prefetch_position( stream, pf, pos );
+     if (ret)
+          return ret;
+
+     ret = http_prefetch_recv( stream, pf, buf, length, ret_read );
+     if (ret == DR_IO && ++pf->retries <= HTTP_MAX_RETRIES) {
+          D_DEBUG_AT( Direct_Stream, "  -> lost connection, retrying...\n" );
+
+          http_prefetch_disconnect( stream, pf );
+
+          return DR_OK;
+     }
+
+     if (ret == DR_OK && *ret_read) {
+          pf->retries = 0;
+
+          http_cache_write( pf, pos, buf, *ret_read );
+     }
+
+     return ret;
+}
+
+static void *
+http_prefetch_loop( DirectThread *thread, void *arg )
+{
+     HTTPPrefetch *pf     = arg;
+     DirectStream *stream = pf->stream;
+
+     direct_mutex_lock( &pf->lock );
+
+     while (!pf->quit) {
+          DirectResult ret;
+          long long    pos;
+          unsigned int tail, space, size;
+
+          if (pf->seeking) {
+               char c[16];
+
+               /* drop pending interrupts */
+               while (read( pf->wakeup[0], c, sizeof(c) ) > 0);
+
+               pf->head  = 0;
+               pf->fill  = 0;
+               pf->pos   = pf->seek_offset;
+               pf->error = DR_OK;
+
+               pos = pf->pos;
+
+               pf->fetching = true;
+
+               direct_mutex_unlock( &pf->lock );
+
+               if (http_cache_has( pf, pos ))
+                    ret = DR_OK;
+               else
+                    ret = http_prefetch_position( stream, pf, pos );
+
+               direct_mutex_lock( &pf->lock );
+
+               pf->fetching = false;
+
+               if (ret && ret != DR_EOF)
+                    pf->error = ret;
+
+               pf->seek_result = (ret == DR_EOF) ? DR_OK : ret;
+               pf->seeking     = false;
+
+               direct_waitqueue_broadcast( &pf->cond );
+               continue;
+          }
+
+          if (pf->fill == pf->size || pf->error) {
+               direct_waitqueue_wait( &pf->cond, &pf->lock );
+               continue;
+          }
+
+          tail  = (pf->head + pf->fill) % pf->size;
+          space = MIN( pf->size - pf->fill, pf->size - tail );
+          pos   = pf->pos;
+
+          pf->fetching = true;
+
+          direct_mutex_unlock( &pf->lock );
+
+          ret = http_prefetch_fetch( stream, pf, pos, pf->ring + tail, space, &size );
+
+          direct_mutex_lock( &pf->lock );
+
+          pf->fetching = false;
+
+          /* data before the seek is stale */
+          if (pf->seeking)
+               continue;
+
+          switch (ret) {
+               case DR_OK:
+                    if (size) {
+                         pf->fill += size;
+                         pf->pos  += size;
+
+                         direct_waitqueue_broadcast( &pf->cond );
+                    }
+                    break;
+
+               case DR_INTERRUPTED:
+               case DR_TIMEOUT:
+                    break;
+
+               default:
+                    D_DEBUG_AT( Direct_Stream, "  -> prefetch stopped at %lld (%s)\n", pos, DirectResultString( ret ) );
+
+                    pf->error = ret;
+
+                    direct_waitqueue_broadcast( &pf->cond );
+                    break;
+          }
+     }
+
+     direct_mutex_unlock( &pf->lock );
+
+     return NULL;
+}
+
+static void
+http_prefetch_copy( HTTPPrefetch *pf, unsigned int offset, void *buf, unsigned int length )
+{
+     unsigned int start = (pf->head + offset) % pf->size;
+     unsigned int first = MIN( length, pf->size - start );
+
+     direct_memcpy( buf, pf->ring + start, first );
+
+     if (first < length)
+          direct_memcpy( (u8*) buf + first, pf->ring, length - first );
+}
+
+static DirectResult
+http_prefetch_wait( DirectStream   *stream,
+                    unsigned int    length,
+                    struct timeval *tv )
+{
+     DirectResult  ret = DR_OK;
+     HTTPPrefetch *pf  = stream->remote.prefetch;
+     long long     timeout = 0;
+
+     if (tv)
+          timeout = direct_clock_get_time( DIRECT_CLOCK_MONOTONIC ) + tv->tv_sec * 1000000LL + tv->tv_usec;
+
+     if (length > pf->size)
+          length = pf->size;
+
+     direct_mutex_lock( &pf->lock );
+
+     while (pf->fill < length && !pf->error) {
+          if (tv) {
+               long long now = direct_clock_get_time( DIRECT_CLOCK_MONOTONIC );
+
+               if (now >= timeout) {
+                    ret = DR_TIMEOUT;
+                    break;
+               }
+
+               direct_waitqueue_wait_timeout( &pf->cond, &pf->lock, timeout - now );
+          }
+          else
+               direct_waitqueue_wait( &pf->cond, &pf->lock );
+     }
+
+     /* remaining data before the end or a failure */
+     if (pf->fill < length && pf->error)
+          ret = pf->fill ? DR_OK : pf->error;
+
+     direct_mutex_unlock( &pf->lock );
+
+     return ret;
+}
+
+static DirectResult
+http_prefetch_peek( DirectStream *stream,
+                    unsigned int  length,
+                    int           offset,
+                    void         *buf,
+                    unsigned int *read_out )
+{
+     DirectResult  ret = DR_OK;
+     HTTPPrefetch *pf  = stream->remote.prefetch;
+
+     if (offset < 0)
+          return DR_UNSUPPORTED;
+
+     direct_mutex_lock( &pf->lock );
+
+     if (offset < pf->fill) {
+          length = MIN( length, pf->fill - offset );
+
+          http_prefetch_copy( pf, offset, buf, length );
+
+          if (read_out)
+               *read_out = length;
+     }
+     else
+          ret = pf->error ? pf->error : DR_BUFFEREMPTY;
+
+     direct_mutex_unlock( &pf->lock );
+
+     return ret;
+}
+
+static DirectResult
+http_prefetch_read( DirectStream *stream,
+                    unsigned int  length,
+                    void         *buf,
+                    unsigned int *read_out )
+{
+     DirectResult  ret = DR_OK;
+     HTTPPrefetch *pf  = stream->remote.prefetch;
 
-               FD_ZERO( &s );
-               FD_SET( fd, &s );
+     direct_mutex_lock( &pf->lock );
 
-               err = select( fd+1, NULL, &s, NULL, &t );
-               if (err < 1) {
-                    D_DEBUG_AT( Direct_Stream, "...connection failed.\n" );
+     if (pf->fill) {
+          length = MIN( length, pf->fill );
 
-                    close( fd );
-                    fd = -1;
+          http_prefetch_copy( pf, 0, buf, length );
 
-                    if (err == 0) {
-                         ret = DR_TIMEOUT;
-                         continue;
-                    } else {
-                         ret = errno2result( errno );
-                         break;
-                    }
-               }
+          pf->head  = (pf->head + length) % pf->size;
+          pf->fill -= length;
 
-               D_DEBUG_AT( Direct_Stream, "...connected.\n" );
+          stream->offset += length;
 
-               ret = DR_OK;
-               break;
-          }
+          direct_waitqueue_broadcast( &pf->cond );
+
+          if (read_out)
+               *read_out = length;
      }
+     else
+          ret = pf->error ? pf->error : DR_BUFFEREMPTY;
 
-     *ret_fd = fd;
+     direct_mutex_unlock( &pf->lock );
 
      return ret;
 }
 
 static DirectResult
-net_open( DirectStream *stream, const char *filename, int proto )
+http_prefetch_seek( DirectStream *stream, unsigned int offset )
 {
-     DirectResult    ret  = DR_OK;
-     int             sock = (proto == IPPROTO_TCP) ? SOCK_STREAM : SOCK_DGRAM;
-     struct addrinfo hints;
-     char            port[16];
+     DirectResult  ret = DR_OK;
+     HTTPPrefetch *pf  = stream->remote.prefetch;
 
-     parse_url( filename,
-                &stream->remote.host,
-                &stream->remote.port,
-                &stream->remote.user,
-                &stream->remote.pass,
-                &stream->remote.path );
+     direct_mutex_lock( &pf->lock );
 
-     direct_snprintf( port, sizeof(port), "%d", stream->remote.port );
+     if (offset >= stream->offset && offset - stream->offset <= pf->fill) {
+          unsigned int skip = offset - stream->offset;
 
-     memset( &hints, 0, sizeof(hints) );
-     hints.ai_flags    = AI_CANONNAME;
-     hints.ai_socktype = sock;
-     hints.ai_family   = PF_UNSPEC;
+          /* within the buffered data */
+          pf->head  = (pf->head + skip) % pf->size;
+          pf->fill -= skip;
 
-     if (getaddrinfo( stream->remote.host, port, &hints, &stream->remote.addr )) {
-          /* give it a second chance without AI_CANONNAME which fails on some platforms */
-          hints.ai_flags = 0;
-          if (getaddrinfo( stream->remote.host, port, &hints, &stream->remote.addr )) {
-               D_ERROR( "Direct/Stream: failed to resolve host '%s'!\n", stream->remote.host );
-               return DR_FAILURE;
-          }
+          direct_waitqueue_broadcast( &pf->cond );
      }
+     else {
+          pf->seeking     = true;
+          pf->seek_offset = offset;
 
-     ret = net_connect( stream->remote.addr, sock, proto, &stream->remote.sd );
-     if (ret)
-          return ret;
+          direct_waitqueue_broadcast( &pf->cond );
 
-     stream->fd     = stream->remote.sd;
-     stream->length = -1;
-     stream->wait   = net_wait;
-     stream->peek   = net_peek;
-     stream->read   = net_read;
+          http_prefetch_interrupt( pf );
+
+          while (pf->seeking)
+               direct_waitqueue_wait( &pf->cond, &pf->lock );
+
+          ret = pf->seek_result;
+     }
+
+     if (ret == DR_OK)
+          stream->offset = offset;
+
+     direct_mutex_unlock( &pf->lock );
 
      return ret;
 }
 
-/*****************************************************************************/
+static void
+http_prefetch_stop( DirectStream *stream )
+{
+     HTTPPrefetch *pf = stream->remote.prefetch;
+
+     if (pf->thread) {
+          direct_mutex_lock( &pf->lock );
+
+          pf->quit = true;
+
+          direct_waitqueue_broadcast( &pf->cond );
+
+          http_prefetch_interrupt( pf );
+
+          direct_mutex_unlock( &pf->lock );
+
+          direct_thread_join( pf->thread );
+          direct_thread_destroy( pf->thread );
+     }
+
+     http_cache_close( pf );
+
+     close( pf->wakeup[0] );
+     close( pf->wakeup[1] );
+
+     direct_waitqueue_deinit( &pf->cond );
+     direct_mutex_deinit( &pf->lock );
+
+     D_FREE( pf->ring );
+     D_FREE( pf );
+
+     stream->remote.prefetch = NULL;
+}
 
 static DirectResult
-http_seek( DirectStream *stream, unsigned int offset )
+http_prefetch_start( DirectStream       *stream,
+                     unsigned int        size,
+                     const HTTPResponse *response )
 {
-     DirectResult ret;
-     char         buf[1280];
-     int          status, len;
-
-     close( stream->remote.sd );
-     stream->remote.sd = -1;
+     HTTPPrefetch *pf;
 
-     ret = net_connect( stream->remote.addr,
-                        SOCK_STREAM, IPPROTO_TCP, &stream->remote.sd );
-     if (ret)
-          return ret;
+     D_DEBUG_AT( Direct_Stream, "%s( %p, %u )\n", __FUNCTION__, stream, size );
 
-     stream->fd = stream->remote.sd;
+     pf = D_CALLOC( 1, sizeof(HTTPPrefetch) );
+     if (!pf)
+          return D_OOM();
 
-     len = direct_snprintf( buf, sizeof(buf),
-                     "GET %s HTTP/1.0\r\n"
-                     "Host: %s:%d\r\n",
-                     stream->remote.path,
-                     stream->remote.host,
-                     stream->remote.port );
-     if (stream->remote.auth) {
-          len += direct_snprintf( buf+len, sizeof(buf)-len,
-                           "Authorization: Basic %s\r\n",
-                           stream->remote.auth );
+     pf->ring = D_MALLOC( size );
+     if (!pf->ring) {
+          D_FREE( pf );
+          return D_OOM();
      }
-     direct_snprintf( buf+len, sizeof(buf)-len,
-               "User-Agent: DirectFB/%s\r\n"
-               "Accept: */*\r\n"
-               "Range: bytes=%d-\r\n"
-               "Connection: Close\r\n",
-               DIRECTFB_VERSION, offset );
 
-     status = net_command( stream, buf, sizeof(buf) );
-     switch (status) {
-          case 200 ... 299:
-               stream->offset = offset;
-               break;
-          default:
-               if (status)
-                    D_DEBUG_AT( Direct_Stream,
-                                "server returned status %d.\n", status );
-               return DR_FAILURE;
+     if (pipe( pf->wakeup )) {
+          DirectResult ret = errno2result( errno );
+
+          D_PERROR( "Direct/Stream: Could not create wakeup pipe!\n" );
+          D_FREE( pf->ring );
+          D_FREE( pf );
+          return ret;
      }
 
-     /* discard remaining headers */
-     while (net_response( stream, buf, sizeof(buf) ) > 0);
+     fcntl( pf->wakeup[0], F_SETFL, O_NONBLOCK );
+     fcntl( pf->wakeup[1], F_SETFL, O_NONBLOCK );
+
+     pf->stream     = stream;
+     pf->size       = size;
+     pf->body       = response->chunked ? -1 : response->length;
+     pf->chunked    = response->chunked;
+     pf->keepalive  = response->keepalive;
+     pf->ranges     = stream->seek != NULL;
+     pf->open_ended = response->status != 206;
+     pf->cache_fd   = -1;
+     pf->map_fd     = -1;
+
+     direct_mutex_init( &pf->lock );
+     direct_waitqueue_init( &pf->cond );
+
+     http_cache_open( stream, pf, response->validator );
+
+     stream->remote.prefetch = pf;
+
+     /* the socket is owned by the thread from now on */
+     stream->fd = -1;
+
+     stream->wait = http_prefetch_wait;
+     stream->peek = http_prefetch_peek;
+     stream->read = http_prefetch_read;
+
+     if (stream->seek)
+          stream->seek = http_prefetch_seek;
+
+     pf->thread = direct_thread_create( DTT_DEFAULT, http_prefetch_loop, pf, "HTTP Prefetch" );
+     if (!pf->thread) {
+          http_prefetch_stop( stream );
+          return DR_INIT;
+     }
 
      return DR_OK;
 }
 
+/*****************************************************************************/
+
 static DirectResult
 http_open( DirectStream *stream, const char *filename )
 {
      DirectResult ret;
-     char         buf[1280];
-     int          status, len;
+     HTTPResponse response;
+     unsigned int prefetch;
+     int          len;
 
      stream->remote.port = HTTP_PORT;
 
@@ -604,78 +1766,85 @@ http_open( DirectStream *stream, const char *filename )
           stream->remote.auth = direct_base64_encode( tmp, len );
      }
 
-     len = direct_snprintf( buf, sizeof(buf),
-                     "GET %s HTTP/1.0\r\n"
-                     "Host: %s:%d\r\n",
-                     stream->remote.path,
-                     stream->remote.host,
-                     stream->remote.port );
-     if (stream->remote.auth) {
-          len += direct_snprintf( buf+len, sizeof(buf)-len,
-                           "Authorization: Basic %s\r\n",
-                           stream->remote.auth );
-     }
-     direct_snprintf( buf+len, sizeof(buf)-len,
-               "User-Agent: DirectFB/%s\r\n"
-               "Accept: */*\r\n"
-               "Connection: Close\r\n",
-               DIRECTFB_VERSION );
+     prefetch = http_prefetch_size();
 
-     status = net_command( stream, buf, sizeof(buf) );
+     /* When prefetching, already the first request asks for a chunk and keeps the connection. */
+     if (prefetch)
+          ret = http_request( stream, 0, prefetch - 1, true, &response );
+     else
+          ret = http_request( stream, -1, -1, false, &response );
+     if (ret)
+          return DR_FAILURE;
 
-     while (net_response( stream, buf, sizeof(buf) ) > 0) {
-          if (!strncasecmp( buf, "Accept-Ranges:", 14 )) {
-               if (strcmp( trim( buf+14 ), "none" ))
-                    stream->seek = http_seek;
-          }
-          else if (!strncasecmp( buf, "Content-Type:", 13 )) {
-               char *mime = trim( buf+13 );
-               char *tmp  = strchr( mime, ';' );
-               if (tmp)
-                    *tmp = '\0';
-               if (stream->mime)
-                    D_FREE( stream->mime );
-               stream->mime = D_STRDUP( mime );
-          }
-          else if (!strncasecmp( buf, "Content-Length:", 15 )) {
-               char *tmp = trim( buf+15 );
-               if (sscanf( tmp, "%zd", &stream->length ) < 1)
-                    sscanf( tmp, "bytes=%zd", &stream->length );
-          }
-          else if (!strncasecmp( buf, "Location:", 9 )) {
-               direct_stream_close( stream );
-               stream->seek = NULL;
-
-               if (++stream->remote.redirects > HTTP_MAX_REDIRECTS) {
-                    D_ERROR( "Direct/Stream: "
-                             "reached maximum number of redirects (%d).\n",
-                             HTTP_MAX_REDIRECTS );
-                    return DR_LIMITEXCEEDED;
-               }
+     if (response.location) {
+          char *location = response.location;
 
-               filename = trim( buf+9 );
-               if (!strncmp( filename, "http://", 7 ))
-                    return http_open( stream, filename+7 );
-               if (!strncmp( filename, "ftp://", 6 ))
-                    return ftp_open( stream, filename+6 );
-               if (!strncmp( filename, "rtsp://", 7 ))
-                    return rtsp_open( stream, filename+7 );
+          response.location = NULL;
 
-               return DR_UNSUPPORTED;
+          http_response_free( &response );
+
+          direct_stream_close( stream );
+          stream->seek = NULL;
+
+          if (++stream->remote.redirects > HTTP_MAX_REDIRECTS) {
+               D_ERROR( "Direct/Stream: "
+                        "reached maximum number of redirects (%d).\n",
+                        HTTP_MAX_REDIRECTS );
+               ret = DR_LIMITEXCEEDED;
           }
+          else if (!strncmp( location, "http://", 7 ))
+               ret = http_open( stream, location+7 );
+          else if (!strncmp( location, "ftp://", 6 ))
+               ret = ftp_open( stream, location+6 );
+          else if (!strncmp( location, "rtsp://", 7 ))
+               ret = rtsp_open( stream, location+7 );
+          else
+               ret = DR_UNSUPPORTED;
+
+          D_FREE( location );
+
+          return ret;
      }
 
-     switch (status) {
-          case 200 ... 299:
+     if (response.mime) {
+          if (stream->mime)
+               D_FREE( stream->mime );
+
+          stream->mime  = response.mime;
+          response.mime = NULL;
+     }
+
+     switch (response.status) {
+          case 206:
+               stream->length = response.total;
+               break;
+          case 200 ... 205:
+          case 207 ... 299:
+               stream->length = response.length;
                break;
+          case 416:
+               /* even the first byte is not satisfiable */
+               if (prefetch) {
+                    stream->length = 0;
+                    break;
+               }
+               /* fall through */
           default:
-               if (status)
-                    D_DEBUG_AT( Direct_Stream,
-                                "server returned status %d.\n", status );
-               return (status == 404) ? DR_FILENOTFOUND : DR_FAILURE;
+               D_DEBUG_AT( Direct_Stream,
+                           "server returned status %d.\n", response.status );
+               http_response_free( &response );
+               return (response.status == 404) ? DR_FILENOTFOUND : DR_FAILURE;
      }
 
-     return DR_OK;
+     if (response.ranges || response.status == 206)
+          stream->seek = http_seek;
+
+     if (prefetch)
+          ret = http_prefetch_start( stream, prefetch, &response );
+
+     http_response_free( &response );
+
+     return ret;
 }
 
 /*****************************************************************************/
@@ -1888,6 +3057,28 @@ pipe_read( DirectStream *stream,
 
 /*****************************************************************************/
 
+static DirectResult
+file_copy_mapped( DirectStream *stream,
+                  unsigned int  length,
+                  int           offset,
+                  void         *buf,
+                  unsigned int *read_out )
+{
+     size_t pos = stream->offset + offset;
+
+     if (pos >= stream->map_length)
+          return DR_EOF;
+
+     length = MIN( length, stream->map_length - pos );
+
+     direct_memcpy( buf, (const u8*) stream->map + pos, length );
+
+     if (read_out)
+          *read_out = length;
+
+     return DR_OK;
+}
+
 #ifndef WIN32
 static DirectResult
 file_peek( DirectStream *stream,
@@ -1899,10 +3090,10 @@ file_peek( DirectStream *stream,
      DirectResult ret = DR_OK;
      ssize_t      size;
 
-     if (lseek( stream->fd, offset, SEEK_CUR ) < 0)
-          return DR_FAILURE;
+     if (stream->map)
+          return file_copy_mapped( stream, length, offset, buf, read_out );
 
-     size = read( stream->fd, buf, length );
+     size = pread( stream->fd, buf, length, stream->offset + offset );
      switch (size) {
           case 0:
                ret = DR_EOF;
@@ -1915,9 +3106,6 @@ file_peek( DirectStream *stream,
                break;
      }
 
-     if (lseek( stream->fd, - offset - size, SEEK_CUR ) < 0)
-          return DR_FAILURE;
-
      if (read_out)
           *read_out = size;
 
@@ -1932,6 +3120,26 @@ file_read( DirectStream *stream,
 {
      ssize_t size;
 
+     if (stream->map) {
+          DirectResult ret;
+          unsigned int copied;
+
+          ret = file_copy_mapped( stream, length, 0, buf, &copied );
+          if (ret)
+               return ret;
+
+          /* keep the file position in sync */
+          if (lseek( stream->fd, copied, SEEK_CUR ) < 0)
+               return DR_FAILURE;
+
+          stream->offset += copied;
+
+          if (read_out)
+               *read_out = copied;
+
+          return DR_OK;
+     }
+
      size = read( stream->fd, buf, length );
      switch (size) {
           case 0:
@@ -1974,6 +3182,9 @@ file_peek( DirectStream *stream,
      DirectResult ret = DR_OK;
      size_t       size;
 
+     if (stream->map)
+          return file_copy_mapped( stream, length, offset, buf, read_out );
+
      ret = direct_file_seek( &stream->file, offset );
      if (ret)
           return ret;
@@ -2001,9 +3212,24 @@ file_read( DirectStream *stream,
      DirectResult ret;
      size_t       size;
 
-     ret = direct_file_read( &stream->file, buf, length, &size );
-     if (ret)
-          return ret;
+     if (stream->map) {
+          unsigned int copied;
+
+          ret = file_copy_mapped( stream, length, 0, buf, &copied );
+          if (ret)
+               return ret;
+
+          ret = direct_file_seek( &stream->file, copied );
+          if (ret)
+               return ret;
+
+          size = copied;
+     }
+     else {
+          ret = direct_file_read( &stream->file, buf, length, &size );
+          if (ret)
+               return ret;
+     }
 
      stream->offset += size;
 
@@ -2241,6 +3467,52 @@ direct_stream_length( DirectStream *stream )
      return (unsigned int)((stream->length >= 0) ? stream->length : stream->offset);
 }
 
+DirectResult
+direct_stream_map( DirectStream  *stream,
+                   const void   **ret_data,
+                   unsigned int  *ret_length )
+{
+     D_ASSERT( stream != NULL );
+     D_ASSERT( ret_data != NULL );
+     D_ASSERT( ret_length != NULL );
+
+     D_MAGIC_ASSERT( stream, DirectStream );
+
+     if (!stream->map) {
+          void *map;
+
+          /* regular files only */
+          if (stream->seek != file_seek || stream->length <= 0)
+               return DR_UNSUPPORTED;
+
+#ifndef WIN32
+          map = mmap( NULL, stream->length, PROT_READ, MAP_SHARED, stream->fd, 0 );
+          if (map == MAP_FAILED)
+               return errno2result( errno );
+
+          /* Data is usually parsed from the beginning to the end, let the kernel read ahead all of it. */
+          madvise( map, stream->length, MADV_SEQUENTIAL );
+          madvise( map, stream->length, MADV_WILLNEED );
+#else
+          DirectResult ret;
+
+          ret = direct_file_map( &stream->file, NULL, 0, stream->length, DFP_READ, &map );
+          if (ret)
+               return ret;
+#endif
+
+          D_DEBUG_AT( Direct_Stream, "%s( %p ) -> mapped %zd bytes at %p\n", __FUNCTION__, stream, stream->length, map );
+
+          stream->map        = map;
+          stream->map_length = stream->length;
+     }
+
+     *ret_data   = stream->map;
+     *ret_length = stream->map_length;
+
+     return DR_OK;
+}
+
 DirectResult
 direct_stream_wait( DirectStream   *stream,
                     unsigned int    length,
@@ -2323,6 +3595,9 @@ static void
 direct_stream_close( DirectStream *stream )
 {
 #if DIRECT_BUILD_NETWORK
+     if (stream->remote.prefetch)
+          http_prefetch_stop( stream );
+
      if (stream->remote.host) {
           D_FREE( stream->remote.host );
           stream->remote.host = NULL;
@@ -2375,6 +3650,15 @@ direct_stream_close( DirectStream *stream )
           stream->cache_size = 0;
      }
 
+     if (stream->map) {
+#ifndef WIN32
+          munmap( stream->map, stream->map_length );
+#else
+          direct_file_unmap( &stream->file, stream->map, stream->map_length );
+#endif
+          stream->map = NULL;
+     }
+
 #ifndef WIN32
      if (stream->fd >= 0) {
           fcntl( stream->fd, F_SETFL,
@@ -88,6 +88,17 @@ unsigned int DIRECT_API  direct_stream_length  ( DirectStream   *stream );
  */
 unsigned int DIRECT_API  direct_stream_offset  ( DirectStream   *stream );
 
+/*
+ * Get direct access to the complete data of a regular file, without copying.
+ *
+ * The file is mapped on first use and stays mapped until the stream is destroyed,
+ * reading and peeking then copy from the mapping. Returns DR_UNSUPPORTED for
+ * other kinds of streams.
+ */
+DirectResult DIRECT_API  direct_stream_map     ( DirectStream   *stream,
+                                                 const void    **ret_data,
+                                                 unsigned int   *ret_length );
+
 /*
  * Wait for data to be available.
  * If 'timeout' is NULL, the function blocks indefinitely.
@@ -0,0 +1,396 @@
+/*
+   (c) Copyright 2012-2013  DirectFB integrated media GmbH
+   (c) Copyright 2001-2013  The world wide DirectFB Open Source Community (directfb.org)
+   (c) Copyright 2000-2004  Convergence (integrated media) GmbH
+
+   All rights reserved.
+
+   Written by Denis Oliver Kropp <dok@directfb.org>,
+              Andreas Shimokawa <andi@directfb.org>,
+              Marek Pikarski <mass@directfb.org>,
+              Sven Neumann <neo@directfb.org>,
+              Ville Syrjälä <syrjala@sci.fi> and
+              Claudio Ciccani <klan@users.sf.net>.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+
+
+
+#include <config.h>
+
+#include <errno.h>
+#include <stdio.h>
+
+#include <direct/atomic.h>
+#include <direct/debug.h>
+#include <direct/mem.h>
+#include <direct/messages.h>
+#include <direct/thread.h>
+#include <direct/timeline.h>
+#include <direct/util.h>
+
+
+D_DEBUG_DOMAIN( Direct_Timeline, "Direct/Timeline", "Direct Timeline" );
+
+/**********************************************************************************************************************/
+
+typedef struct __D_DirectTimelineBuffer DirectTimelineBuffer;
+
+struct __D_DirectTimelineBuffer {
+     DirectTimelineBuffer *next;
+
+     pid_t                 tid;
+     char                  name[64];
+
+     unsigned int          mask;
+     unsigned int          written;      /* only incremented by the owning thread */
+
+     bool                  retired;      /* owning thread has exited */
+
+     DirectTimelineEvent  *events;
+};
+
+#define TIMELINE_MAX_EVENTS    (1 << 20)     /* per thread ring buffer size limit */
+#define TIMELINE_MAX_RETIRED   32            /* buffers of exited threads kept for the dump */
+
+/**********************************************************************************************************************/
+
+static DirectTLS             timeline_tls;
+static DirectMutex           timeline_lock;
+static DirectTimelineBuffer *timeline_buffers;
+static unsigned int          timeline_retired;
+
+static void timeline_buffer_retire( void *ptr );
+
+/**********************************************************************************************************************/
+
+void
+__D_timeline_init()
+{
+     direct_tls_register( &timeline_tls, timeline_buffer_retire );
+     direct_mutex_init( &timeline_lock );
+}
+
+void
+__D_timeline_deinit()
+{
+     DirectTimelineBuffer *buffer = timeline_buffers;
+
+     /* Threads still running may still reference their buffer, so free only at the very end. */
+     while (buffer) {
+          DirectTimelineBuffer *next = buffer->next;
+
+          D_FREE( buffer );
+
+          buffer = next;
+     }
+
+     timeline_buffers = NULL;
+     timeline_retired = 0;
+
+     direct_mutex_deinit( &timeline_lock );
+     direct_tls_unregister( &timeline_tls );
+}
+
+/**********************************************************************************************************************/
+
+static DirectTimelineBuffer *
+timeline_buffer_create( void )
+{
+     DirectTimelineBuffer *buffer;
+     const char           *name;
+     unsigned int          size = 1;
+
+     /* Round up to a power of two for cheap wrapping. */
+     while (size < direct_config->timeline && size < TIMELINE_MAX_EVENTS)
+          size <<= 1;
+
+     buffer = D_CALLOC( 1, sizeof(DirectTimelineBuffer) + size * sizeof(DirectTimelineEvent) );
+     if (!buffer) {
+          D_OOM();
+          return NULL;
+     }
+
+     name = direct_thread_self_name();
+
+     buffer->tid    = direct_gettid();
+     buffer->mask   = size - 1;
+     buffer->events = (DirectTimelineEvent*) (buffer + 1);
+
+     direct_snputs( buffer->name, name ? name : "?", sizeof(buffer->name) );
+
+     D_DEBUG_AT( Direct_Timeline, "%s() -> %u events for '%s' (%d)\n", __FUNCTION__, size, buffer->name, buffer->tid );
+
+     direct_mutex_lock( &timeline_lock );
+
+     buffer->next     = timeline_buffers;
+     timeline_buffers = buffer;
+
+     direct_mutex_unlock( &timeline_lock );
+
+     direct_tls_set( timeline_tls, buffer );
+
+     return buffer;
+}
+
+/*
+ * TLS destructor, keeps the events of an exiting thread for the dump in a buffer of just the needed size.
+ * Only the most recent TIMELINE_MAX_RETIRED buffers of exited threads are kept.
+ */
+static void
+timeline_buffer_retire( void *ptr )
+{
+     DirectTimelineBuffer  *buffer = ptr;
+     DirectTimelineBuffer  *retired;
+     DirectTimelineBuffer  *oldest = NULL;
+     DirectTimelineBuffer **link;
+     unsigned int           i;
+     unsigned int           num   = MIN( buffer->written, buffer->mask );
+     unsigned int           start = buffer->written - num;
+     unsigned int           size  = 1;
+
+     /* Leave room for one more slot, the dump never reads the oldest one. */
+     while (size <= num)
+          size <<= 1;
+
+     retired = D_CALLOC( 1, sizeof(DirectTimelineBuffer) + size * sizeof(DirectTimelineEvent) );
+     if (retired) {
+          retired->tid     = buffer->tid;
+          retired->mask    = size - 1;
+          retired->written = num;
+          retired->retired = true;
+          retired->events  = (DirectTimelineEvent*) (retired + 1);
+
+          direct_snputs( retired->name, buffer->name, sizeof(retired->name) );
+
+          for (i=0; i<num; i++)
+               retired->events[i] = buffer->events[(start + i) & buffer->mask];
+     }
+
+     D_DEBUG_AT( Direct_Timeline, "%s() -> %u events of '%s' (%d)\n", __FUNCTION__, num, buffer->name, buffer->tid );
+
+     direct_mutex_lock( &timeline_lock );
+
+     for (link = &timeline_buffers; *link; link = &(*link)->next) {
+          if (*link == buffer) {
+               if (retired) {
+                    retired->next = buffer->next;
+                    *link         = retired;
+               }
+               else
+                    *link = buffer->next;
+
+               break;
+          }
+     }
+
+     if (retired && ++timeline_retired > TIMELINE_MAX_RETIRED) {
+          /* Buffers are prepended, so the last retired one in the list is the oldest. */
+          for (link = &timeline_buffers; *link; link = &(*link)->next) {
+               if ((*link)->retired)
+                    oldest = *link;
+          }
+
+          for (link = &timeline_buffers; *link != oldest; link = &(*link)->next);
+
+          *link = oldest->next;
+
+          timeline_retired--;
+     }
+
+     direct_mutex_unlock( &timeline_lock );
+
+     if (oldest)
+          D_FREE( oldest );
+
+     D_FREE( buffer );
+}
+
+void
+direct_timeline_record( DirectTimelinePhase  phase,
+                        const char          *category,
+                        const char          *name,
+                        unsigned long        id,
+                        long long            ts,
+                        long long            dur )
+{
+     DirectTimelineBuffer *buffer;
+     DirectTimelineEvent  *event;
+
+     buffer = direct_tls_get( timeline_tls );
+     if (!buffer) {
+          buffer = timeline_buffer_create();
+          if (!buffer)
+               return;
+     }
+
+     event = &buffer->events[buffer->written & buffer->mask];
+
+     event->ts       = ts;
+     event->dur      = dur;
+     event->category = category;
+     event->name     = name;
+     event->id       = id;
+     event->phase    = phase;
+
+     /* Publish the event, the dump reads 'written' before and after copying. */
+     D_SYNC_ADD( &buffer->written, 1 );
+}
+
+/**********************************************************************************************************************/
+
+static void
+write_string( FILE       *file,
+              const char *string )
+{
+     fputc( '"', file );
+
+     for (; *string; string++) {
+          if (*string == '"' || *string == '\\')
+               fputc( '\\', file );
+
+          if ((unsigned char) *string >= 0x20)
+               fputc( *string, file );
+     }
+
+     fputc( '"', file );
+}
+
+static int
+dump_buffer( FILE                 *file,
+             DirectTimelineBuffer *buffer,
+             pid_t                 pid,
+             int                   count )
+{
+     unsigned int         i;
+     unsigned int         start;
+     unsigned int         end;
+     unsigned int         num;
+     unsigned int         skip;
+     DirectTimelineEvent *events;
+
+     fprintf( file, "%s\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":",
+              count ? "," : "", pid, buffer->tid );
+     write_string( file, buffer->name );
+     fprintf( file, "}}" );
+
+     count++;
+
+     /* Once wrapped, the oldest slot is the one being written next, so leave it out. */
+     end   = D_SYNC_ADD_AND_FETCH( &buffer->written, 0 );
+     num   = MIN( end, buffer->mask );
+     start = end - num;
+
+     if (!num)
+          return count;
+
+     events = D_MALLOC( num * sizeof(DirectTimelineEvent) );
+     if (!events) {
+          D_OOM();
+          return count;
+     }
+
+     for (i=0; i<num; i++)
+          events[i] = buffer->events[(start + i) & buffer->mask];
+
+     /* Events written by the owner in the meantime may have overwritten the oldest ones. */
+     skip = D_SYNC_ADD_AND_FETCH( &buffer->written, 0 ) - end;
+
+     for (i=skip; i<num; i++) {
+          const DirectTimelineEvent *event = &events[i];
+
+          fprintf( file, ",\n{\"ph\":\"%c\",\"pid\":%d,\"tid\":%d,\"ts\":%lld,\"cat\":", event->phase, pid, buffer->tid, event->ts );
+          write_string( file, event->category );
+          fprintf( file, ",\"name\":" );
+          write_string( file, event->name );
+
+          switch (event->phase) {
+               case DTLP_COMPLETE:
+                    fprintf( file, ",\"dur\":%lld", event->dur );
+                    break;
+
+               case DTLP_INSTANT:
+                    fprintf( file, ",\"s\":\"t\"" );
+                    break;
+
+               case DTLP_ASYNC_BEGIN:
+               case DTLP_ASYNC_END:
+                    fprintf( file, ",\"id\":\"0x%lx\"", event->id );
+                    break;
+
+               default:
+                    break;
+          }
+
+          if (event->id && event->phase != DTLP_ASYNC_BEGIN && event->phase != DTLP_ASYNC_END)
+               fprintf( file, ",\"args\":{\"id\":\"0x%lx\"}", event->id );
+
+          fprintf( file, "}" );
+
+          count++;
+     }
+
+     D_FREE( events );
+
+     return count;
+}
+
+DirectResult
+direct_timeline_dump( const char *filename )
+{
+     FILE                 *file;
+     DirectTimelineBuffer *buffer;
+     char                  buf[256];
+     pid_t                 pid   = direct_getpid();
+     int                   count = 0;
+
+     if (!filename)
+          filename = direct_config->timeline_file;
+
+     if (!filename) {
+          snprintf( buf, sizeof(buf), "/tmp/directfb-timeline-%d.json", pid );
+
+          filename = buf;
+     }
+
+     D_DEBUG_AT( Direct_Timeline, "%s( '%s' )\n", __FUNCTION__, filename );
+
+     file = fopen( filename, "w" );
+     if (!file) {
+          D_PERROR( "Direct/Timeline: Could not open '%s' for writing!\n", filename );
+          return errno2result( errno );
+     }
+
+     fprintf( file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" );
+
+     direct_mutex_lock( &timeline_lock );
+
+     for (buffer = timeline_buffers; buffer; buffer = buffer->next)
+          count = dump_buffer( file, buffer, pid, count );
+
+     direct_mutex_unlock( &timeline_lock );
+
+     fprintf( file, "\n]}\n" );
+
+     fclose( file );
+
+     D_INFO( "Direct/Timeline: Written %d events to '%s'\n", count, filename );
+
+     return DR_OK;
+}
+
@@ -0,0 +1,157 @@
+/*
+   (c) Copyright 2012-2013  DirectFB integrated media GmbH
+   (c) Copyright 2001-2013  The world wide DirectFB Open Source Community (directfb.org)
+   (c) Copyright 2000-2004  Convergence (integrated media) GmbH
+
+   All rights reserved.
+
+   Written by Denis Oliver Kropp <dok@directfb.org>,
+              Andreas Shimokawa <andi@directfb.org>,
+              Marek Pikarski <mass@directfb.org>,
+              Sven Neumann <neo@directfb.org>,
+              Ville Syrjälä <syrjala@sci.fi> and
+              Claudio Ciccani <klan@users.sf.net>.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+
+
+
+#ifndef __DIRECT__TIMELINE_H__
+#define __DIRECT__TIMELINE_H__
+
+#include <direct/clock.h>
+#include <direct/conf.h>
+
+/*
+ * Timeline of events recorded into per thread ring buffers, dumped as Chrome trace JSON
+ * (chrome://tracing, ui.perfetto.dev).
+ *
+ * Recording is enabled via "timeline=<events>" giving the ring buffer size per thread (at most 2^20).
+ * The events of exited threads are kept for the dump, up to a limited number of threads.
+ * Category and name strings are not copied and must stay valid until the dump.
+ */
+
+typedef enum {
+     DTLP_BEGIN        = 'B',    /* duration begin, same thread */
+     DTLP_END          = 'E',    /* duration end, same thread */
+     DTLP_COMPLETE     = 'X',    /* duration with start time and length */
+     DTLP_INSTANT      = 'i',    /* single point in time */
+     DTLP_ASYNC_BEGIN  = 'b',    /* async span begin, matched by category, name and id */
+     DTLP_ASYNC_END    = 'e'     /* async span end */
+} DirectTimelinePhase;
+
+typedef struct {
+     long long                ts;
+     long long                dur;
+
+     const char              *category;
+     const char              *name;
+
+     unsigned long            id;
+     DirectTimelinePhase      phase;
+} DirectTimelineEvent;
+
+/**********************************************************************************************************************/
+
+void         DIRECT_API direct_timeline_record( DirectTimelinePhase  phase,
+                                                const char          *category,
+                                                const char          *name,
+                                                unsigned long        id,
+                                                long long            ts,
+                                                long long            dur );
+
+/*
+ * Writes all recorded events of all threads to the file, or to "timeline-file", or to
+ * /tmp/directfb-timeline-<pid>.json if both are NULL.
+ */
+DirectResult DIRECT_API direct_timeline_dump  ( const char          *filename );
+
+/**********************************************************************************************************************/
+
+#define D_TIMELINE_ENABLED()                   (direct_config->timeline > 0)
+
+static __inline__ long long
+direct_timeline_now( void )
+{
+     return D_TIMELINE_ENABLED() ? direct_clock_get_time( DIRECT_CLOCK_MONOTONIC ) : 0;
+}
+
+static __inline__ void
+direct_timeline_begin( const char *category,
+                       const char *name )
+{
+     if (D_TIMELINE_ENABLED())
+          direct_timeline_record( DTLP_BEGIN, category, name, 0, direct_clock_get_time( DIRECT_CLOCK_MONOTONIC ), 0 );
+}
+
+static __inline__ void
+direct_timeline_end( const char *category,
+                     const char *name )
+{
+     if (D_TIMELINE_ENABLED())
+          direct_timeline_record( DTLP_END, category, name, 0, direct_clock_get_time( DIRECT_CLOCK_MONOTONIC ), 0 );
+}
+
+/*
+ * Records a duration from 'start' (as returned by direct_timeline_now()) until now.
+ */
+static __inline__ void
+direct_timeline_complete( const char    *category,
+                          const char    *name,
+                          unsigned long  id,
+                          long long      start )
+{
+     if (D_TIMELINE_ENABLED() && start)
+          direct_timeline_record( DTLP_COMPLETE, category, name, id, start,
+                                  direct_clock_get_time( DIRECT_CLOCK_MONOTONIC ) - start );
+}
+
+static __inline__ void
+direct_timeline_instant( const char    *category,
+                         const char    *name,
+                         unsigned long  id )
+{
+     if (D_TIMELINE_ENABLED())
+          direct_timeline_record( DTLP_INSTANT, category, name, id, direct_clock_get_time( DIRECT_CLOCK_MONOTONIC ), 0 );
+}
+
+static __inline__ void
+direct_timeline_async_begin( const char    *category,
+                             const char    *name,
+                             unsigned long  id )
+{
+     if (D_TIMELINE_ENABLED())
+          direct_timeline_record( DTLP_ASYNC_BEGIN, category, name, id, direct_clock_get_time( DIRECT_CLOCK_MONOTONIC ), 0 );
+}
+
+static __inline__ void
+direct_timeline_async_end( const char    *category,
+                           const char    *name,
+                           unsigned long  id )
+{
+     if (D_TIMELINE_ENABLED())
+          direct_timeline_record( DTLP_ASYNC_END, category, name, id, direct_clock_get_time( DIRECT_CLOCK_MONOTONIC ), 0 );
+}
+
+/**********************************************************************************************************************/
+
+void __D_timeline_init( void );
+void __D_timeline_deinit( void );
+
+#endif
+
@@ -79,6 +79,7 @@ typedef struct __D_DirectLog                 DirectLog;
 typedef struct __D_DirectMap                 DirectMap;
 typedef struct __D_DirectModuleDir           DirectModuleDir;
 typedef struct __D_DirectModuleEntry         DirectModuleEntry;
+typedef struct __D_DirectModuleManifest      DirectModuleManifest;
 typedef struct __D_DirectMutex               DirectMutex;
 typedef struct __D_DirectProcessor           DirectProcessor;
 typedef struct __D_DirectSerial              DirectSerial;
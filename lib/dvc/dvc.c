@@ -41,6 +41,7 @@
 
 #include <gfx/clip.h>
 #include <gfx/convert.h>
+#include <gfx/convert_row.h>
 
 #include <misc/conf.h>
 
@@ -1703,6 +1704,14 @@ compute_v_offset( const DVCPicture *pic,
 # include "dvc_mmx.h"
 #endif
 
+#if defined(USE_SSE) && defined(__SSE2__)
+# include "dvc_sse2.h"
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+# include "dvc_neon.h"
+#endif
+
 #define SWAP_BUFFERS() { \
      DVCColor *tmp = ctx.buf[1]; \
      ctx.buf[1] = ctx.buf[0]; \
@@ -1765,6 +1774,12 @@ dvc_scale( const DVCPicture   *source,
 #ifdef USE_MMX 
      init_mmx();
 #endif
+#if defined(USE_SSE) && defined(__SSE2__)
+     init_sse2();
+#endif
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+     init_neon();
+#endif
      
      /* Begin ctx functions setup. */
      load = Load_Proc[DVC_PIXELFORMAT_INDEX(source->format)];
@@ -1851,7 +1866,7 @@ dvc_scale( const DVCPicture   *source,
      {
           memset( ctx.buf[0], 0xff, len * sizeof(DVCColor) );
           if (ctx.buf[1])
-               memset( ctx.buf[0], 0xff, len * sizeof(DVCColor) );
+               memset( ctx.buf[1], 0xff, len * sizeof(DVCColor) );
      }
      
      compute_h_offset( source, source->base, ctx.sx, ctx.src_base );
@@ -0,0 +1,217 @@
+#include <config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <directfb.h>
+
+#include "dvc.h"
+
+/*
+ * Memory to memory benchmark of dvc_scale() for each pair of formats.
+ *
+ * Run with "--dfb:no-mmx" to measure the plain C routines.
+ */
+
+/*****************************************************************************/
+
+static int            sw      = 720;
+static int            sh      = 576;
+static int            dw      = 0;
+static int            dh      = 0;
+static int            seconds = 1;
+static DVCPixelFormat only_sf = DVCPF_UNKNOWN;
+static DVCPixelFormat only_df = DVCPF_UNKNOWN;
+
+/*****************************************************************************/
+
+static struct {
+     DVCPixelFormat  id;
+     const char     *name;
+} formats[] = {
+     { DVCPF_RGB16,  "RGB16" },
+     { DVCPF_RGB24,  "RGB24" },
+     { DVCPF_RGB32,  "RGB32" },
+     { DVCPF_ARGB,   "ARGB" },
+     { DVCPF_YUY2,   "YUY2" },
+     { DVCPF_UYVY,   "UYVY" },
+     { DVCPF_YUV420, "I420" },
+     { DVCPF_NV12,   "NV12" },
+     { DVCPF_NV21,   "NV21" }
+};
+
+#define NUM_FORMATS (sizeof(formats)/sizeof(formats[0]))
+
+static DVCPixelFormat
+format_name_to_id( const char *name )
+{
+     int i;
+
+     for (i = 0; i < NUM_FORMATS; i++) {
+          if (!strcmp( name, formats[i].name ))
+               return formats[i].id;
+     }
+
+     return DVCPF_UNKNOWN;
+}
+
+/*****************************************************************************/
+
+static inline long long
+microsec( void )
+{
+     struct timeval tv;
+
+     gettimeofday( &tv, NULL );
+
+     return (long long) tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+static void
+fill_random( u8 *buf, unsigned int size )
+{
+     unsigned int pool = 0x12345678;
+
+     for (; size; size--) {
+          pool = pool * 1103515245 + 12345;
+          *buf++ = pool >> 16;
+     }
+}
+
+/*****************************************************************************/
+
+static void
+usage( void )
+{
+     fprintf( stderr, "Usage: dvc_bench [options]\n\n" );
+     fprintf( stderr, "Options:\n" );
+     fprintf( stderr, "  -h, --help                   Show this help\n" );
+     fprintf( stderr, "  -s, --size <width>x<height>  Set source size\n" );
+     fprintf( stderr, "  -d, --dest <width>x<height>  Set destination size (scaling)\n" );
+     fprintf( stderr, "  -f, --from <format>          Only test this source format\n" );
+     fprintf( stderr, "  -t, --to <format>            Only test this destination format\n" );
+     fprintf( stderr, "  -T, --time <seconds>         Duration of each test\n" );
+     fprintf( stderr, "\n" );
+     exit( EXIT_FAILURE );
+}
+
+static void
+parse_options( int argc, char **argv )
+{
+     int i;
+
+     for (i = 1; i < argc; i++) {
+          char *opt = argv[i];
+          char *arg = argv[i+1];
+
+          if (!strcmp( opt, "-h" ) || !strcmp( opt, "--help" )) {
+               usage();
+          }
+          else if (!strcmp( opt, "-s" ) || !strcmp( opt, "--size" )) {
+               if (!arg || sscanf( arg, "%ux%u", &sw, &sh ) != 2)
+                    usage();
+               i++;
+          }
+          else if (!strcmp( opt, "-d" ) || !strcmp( opt, "--dest" )) {
+               if (!arg || sscanf( arg, "%ux%u", &dw, &dh ) != 2)
+                    usage();
+               i++;
+          }
+          else if (!strcmp( opt, "-f" ) || !strcmp( opt, "--from" )) {
+               if (!arg || !(only_sf = format_name_to_id( arg )))
+                    usage();
+               i++;
+          }
+          else if (!strcmp( opt, "-t" ) || !strcmp( opt, "--to" )) {
+               if (!arg || !(only_df = format_name_to_id( arg )))
+                    usage();
+               i++;
+          }
+          else if (!strcmp( opt, "-T" ) || !strcmp( opt, "--time" )) {
+               if (!arg || (seconds = atoi( arg )) < 1)
+                    usage();
+               i++;
+          }
+          else
+               usage();
+     }
+
+     if (!dw || !dh) {
+          dw = sw;
+          dh = sh;
+     }
+}
+
+/*****************************************************************************/
+
+int
+main( int argc, char **argv )
+{
+     DFBResult  ret;
+     int        i, j;
+     void      *src_buf;
+     void      *dst_buf;
+
+     /* Only needed for the configuration, e.g. "--dfb:no-mmx". */
+     ret = DirectFBInit( &argc, &argv );
+     if (ret)
+          DirectFBErrorFatal( "DirectFBInit()", ret );
+
+     parse_options( argc, argv );
+
+     src_buf = malloc( dvc_picture_size( DVCPF_ARGB, sw, sh ) );
+     dst_buf = malloc( dvc_picture_size( DVCPF_ARGB, dw, dh ) );
+     if (!src_buf || !dst_buf) {
+          fprintf( stderr, "Out of memory!\n" );
+          return EXIT_FAILURE;
+     }
+
+     fill_random( src_buf, dvc_picture_size( DVCPF_ARGB, sw, sh ) );
+
+     printf( "** Benchmarking %dx%d -> %dx%d **\n\n", sw, sh, dw, dh );
+     printf( "  %-8s -> %-8s    %10s\n", "Source", "Dest", "MPixel/s" );
+
+     for (i = 0; i < NUM_FORMATS; i++) {
+          if (only_sf && formats[i].id != only_sf)
+               continue;
+
+          for (j = 0; j < NUM_FORMATS; j++) {
+               DVCPicture source;
+               DVCPicture dest;
+               long long  start, now;
+               long       num = 0;
+
+               if (only_df && formats[j].id != only_df)
+                    continue;
+
+               dvc_picture_init( &source, formats[i].id, sw, sh, src_buf );
+               dvc_picture_init( &dest,   formats[j].id, dw, dh, dst_buf );
+
+               start = microsec();
+
+               do {
+                    ret = dvc_scale( &source, &dest, NULL, NULL, NULL );
+                    if (ret)
+                         break;
+
+                    num++;
+               } while ((now = microsec()) < start + seconds * 1000000LL);
+
+               if (ret) {
+                    printf( "  %-8s -> %-8s    %10s\n", formats[i].name, formats[j].name, "n/a" );
+                    continue;
+               }
+
+               printf( "  %-8s -> %-8s    %10.3f\n", formats[i].name, formats[j].name,
+                       (double) dw * dh * num / (double) (now - start) );
+               fflush( stdout );
+          }
+     }
+
+     free( src_buf );
+     free( dst_buf );
+
+     return EXIT_SUCCESS;
+}
@@ -0,0 +1,231 @@
+/*
+   (C) Copyright 2007 Claudio Ciccani <klan@directfb.org>.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+
+   DVC - DirectFB Video Converter
+*/
+
+#ifndef __DVC_NEON_H__
+#define __DVC_NEON_H__
+
+#include <arm_neon.h>
+
+/*
+ * NEON is a compile time feature (-mfpu=neon or AArch64), so the
+ * routines are installed unconditionally by init_neon().
+ *
+ * DVCColor is stored as B/V, G/U, R/Y, A bytes which maps directly
+ * to the four registers of vld4/vst4.
+ */
+
+static void Load_YUYV_LE_NEON( DVCContext *ctx )
+{
+     u8        *S = ctx->src[0];
+     DVCColor  *D = ctx->buf[0];
+     int        w = ctx->sw >> 1;
+     uint8x8_t  a = vdup_n_u8( 0xff );
+
+     for (; w >= 8; w -= 8) {
+          uint8x8x4_t s = vld4_u8( S );    /* Y0, U, Y1, V */
+          uint8x8x2_t y = vzip_u8( s.val[0], s.val[2] );
+          uint8x8x2_t u = vzip_u8( s.val[1], s.val[1] );
+          uint8x8x2_t v = vzip_u8( s.val[3], s.val[3] );
+          uint8x8x4_t d;
+
+          d.val[0] = v.val[0];
+          d.val[1] = u.val[0];
+          d.val[2] = y.val[0];
+          d.val[3] = a;
+          vst4_u8( (u8*) D, d );
+
+          d.val[0] = v.val[1];
+          d.val[1] = u.val[1];
+          d.val[2] = y.val[1];
+          vst4_u8( (u8*) (D + 8), d );
+
+          S += 32;
+          D += 16;
+     }
+
+     for (; w; w--) {
+          D[0].YUV.y = S[0];
+          D[1].YUV.y = S[2];
+          D[0].YUV.u =
+          D[1].YUV.u = S[1];
+          D[0].YUV.v =
+          D[1].YUV.v = S[3];
+          S += 4;
+          D += 2;
+     }
+}
+
+static void Load_YUV422_NEON( DVCContext *ctx )
+{
+     u8        *Sy = ctx->src[0];
+     u8        *Su = ctx->src[1];
+     u8        *Sv = ctx->src[2];
+     DVCColor  *D  = ctx->buf[0];
+     int        w  = ctx->sw >> 1;
+     uint8x8_t  a  = vdup_n_u8( 0xff );
+
+     for (; w >= 8; w -= 8) {
+          uint8x16_t  y = vld1q_u8( Sy );
+          uint8x8_t   s = vld1_u8( Su );
+          uint8x8x2_t u = vzip_u8( s, s );
+          uint8x8x2_t v;
+          uint8x8x4_t d;
+
+          s = vld1_u8( Sv );
+          v = vzip_u8( s, s );
+
+          d.val[0] = v.val[0];
+          d.val[1] = u.val[0];
+          d.val[2] = vget_low_u8( y );
+          d.val[3] = a;
+          vst4_u8( (u8*) D, d );
+
+          d.val[0] = v.val[1];
+          d.val[1] = u.val[1];
+          d.val[2] = vget_high_u8( y );
+          vst4_u8( (u8*) (D + 8), d );
+
+          D  += 16;
+          Sy += 16;
+          Su += 8;
+          Sv += 8;
+     }
+
+     for (; w; w--) {
+          D[0].YUV.y = Sy[0];
+          D[1].YUV.y = Sy[1];
+          D[0].YUV.u =
+          D[1].YUV.u = Su[0];
+          D[0].YUV.v =
+          D[1].YUV.v = Sv[0];
+          D  += 2;
+          Sy += 2;
+          Su++;
+          Sv++;
+     }
+
+     if (ctx->sw & 1) {
+          D->YUV.y = *Sy;
+          D->YUV.u = *Su;
+          D->YUV.v = *Sv;
+     }
+}
+
+/* (lo + 128) >> 8, clamped to 0-255, same as YCBCR_TO_RGB() */
+static inline uint8x8_t
+neon_descale( int32x4_t lo, int32x4_t hi )
+{
+     return vqmovun_s16( vcombine_s16( vqshrn_n_s32( lo, 8 ), vqshrn_n_s32( hi, 8 ) ) );
+}
+
+static void YCbCr_to_RGB_Proc_NEON( DVCContext *ctx )
+{
+     DVCColor  *D   = ctx->buf[0];
+     int        w   = ctx->sw;
+     int32x4_t  rnd = vdupq_n_s32( 128 );
+
+     for (; w >= 8; w -= 8) {
+          uint8x8x4_t p  = vld4_u8( (u8*) D );
+          int16x8_t   y  = vsubq_s16( vreinterpretq_s16_u16( vmovl_u8( p.val[2] ) ), vdupq_n_s16( 16 ) );
+          int16x8_t   cb = vsubq_s16( vreinterpretq_s16_u16( vmovl_u8( p.val[1] ) ), vdupq_n_s16( 128 ) );
+          int16x8_t   cr = vsubq_s16( vreinterpretq_s16_u16( vmovl_u8( p.val[0] ) ), vdupq_n_s16( 128 ) );
+          int32x4_t   yl = vmlaq_n_s32( rnd, vmovl_s16( vget_low_s16( y ) ),  298 );
+          int32x4_t   yh = vmlaq_n_s32( rnd, vmovl_s16( vget_high_s16( y ) ), 298 );
+
+          p.val[2] = neon_descale( vmlal_n_s16( yl, vget_low_s16( cr ),  409 ),
+                                   vmlal_n_s16( yh, vget_high_s16( cr ), 409 ) );
+
+          p.val[1] = neon_descale( vmlal_n_s16( vmlal_n_s16( yl, vget_low_s16( cb ),  -100 ), vget_low_s16( cr ),  -208 ),
+                                   vmlal_n_s16( vmlal_n_s16( yh, vget_high_s16( cb ), -100 ), vget_high_s16( cr ), -208 ) );
+
+          p.val[0] = neon_descale( vmlal_n_s16( yl, vget_low_s16( cb ),  516 ),
+                                   vmlal_n_s16( yh, vget_high_s16( cb ), 516 ) );
+
+          vst4_u8( (u8*) D, p );
+
+          D += 8;
+     }
+
+     for (; w; w--) {
+          YCBCR_TO_RGB( D->YUV.y, D->YUV.u, D->YUV.v,
+                        D->RGB.r, D->RGB.g, D->RGB.b );
+          D++;
+     }
+}
+
+static void ScaleV_Up_Proc_NEON( DVCContext *ctx )
+{
+     u32 *S = (u32*)ctx->buf[1];
+     u32 *D = (u32*)ctx->buf[0];
+
+     if (ctx->s_v & 0xff00) {
+          int       b  = (ctx->s_v & 0xff00) >> 8;
+          int       a  = 256 - b;
+          uint8x8_t va = vdup_n_u8( a );
+          uint8x8_t vb = vdup_n_u8( b );
+          int       n  = ctx->dw;
+
+          for (; n >= 4; n -= 4) {
+               uint8x16_t s = vld1q_u8( (u8*) S );
+               uint8x16_t d = vld1q_u8( (u8*) D );
+               uint16x8_t l = vmlal_u8( vmull_u8( vget_low_u8( s ),  va ), vget_low_u8( d ),  vb );
+               uint16x8_t h = vmlal_u8( vmull_u8( vget_high_u8( s ), va ), vget_high_u8( d ), vb );
+
+               vst1q_u8( (u8*) D, vcombine_u8( vshrn_n_u16( l, 8 ), vshrn_n_u16( h, 8 ) ) );
+
+               D += 4;
+               S += 4;
+          }
+
+          for (; n; n--) {
+               *D = ((((*S & 0x00ff00ff) * a + (*D & 0x00ff00ff) * b) >> 8) & 0x00ff00ff) |
+                    ((((*S & 0xff00ff00) >> 8) * a + ((*D & 0xff00ff00) >> 8) * b) & 0xff00ff00);
+               D++;
+               S++;
+          }
+     }
+     else if (ctx->s_v & 0x00ff) {
+          direct_memcpy( D, S, ctx->dw * sizeof(DVCColor) );
+     }
+}
+
+
+static void init_neon( void )
+{
+     static int initialized = 0;
+
+     if (initialized)
+          return;
+
+     initialized = 1;
+
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+     Load_Proc[DVC_PIXELFORMAT_INDEX(DVCPF_YUYV_LE)] = Load_YUYV_LE_NEON;
+#endif
+     Load_Proc[DVC_PIXELFORMAT_INDEX(DVCPF_YUV422)]  = Load_YUV422_NEON;
+     Load_Proc[DVC_PIXELFORMAT_INDEX(DVCPF_YUV420)]  = Load_YUV422_NEON;
+
+     YCbCr_to_RGB_Proc = YCbCr_to_RGB_Proc_NEON;
+     ScaleV_Up_Proc    = ScaleV_Up_Proc_NEON;
+}
+
+
+#endif /* __DVC_NEON_H__ */
@@ -0,0 +1,296 @@
+/*
+   (C) Copyright 2007 Claudio Ciccani <klan@directfb.org>.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+
+   DVC - DirectFB Video Converter
+*/
+
+#ifndef __DVC_SSE2_H__
+#define __DVC_SSE2_H__
+
+#include <emmintrin.h>
+
+/*
+ * All routines produce exactly the same output as their C counterparts,
+ * they only process a multiple of 4/8/16 pixels at once and leave the
+ * remaining pixels to a scalar tail.
+ *
+ * Loaders set the alpha byte to 0xff, which is what the line buffers
+ * are initialized with for sources without alpha.
+ */
+
+static void Load_YUYV_LE_SSE2( DVCContext *ctx )
+{
+     const __m128i  ff  = _mm_set1_epi32( 0xff000000 );
+     const __m128i  m8  = _mm_set1_epi32( 0x0000ff00 );
+     const __m128i  m16 = _mm_set1_epi32( 0x00ff0000 );
+     const __m128i  m0  = _mm_set1_epi32( 0x000000ff );
+     u32           *S   = ctx->src[0];
+     DVCColor      *D   = ctx->buf[0];
+     int            w   = ctx->sw >> 1;
+
+     for (; w >= 4; w -= 4) {
+          __m128i s  = _mm_loadu_si128( (__m128i*) S );
+          __m128i vu = _mm_or_si128( _mm_or_si128( _mm_srli_epi32( s, 24 ), _mm_and_si128( s, m8 ) ), ff );
+          __m128i d0 = _mm_or_si128( vu, _mm_slli_epi32( _mm_and_si128( s, m0 ), 16 ) );
+          __m128i d1 = _mm_or_si128( vu, _mm_and_si128( s, m16 ) );
+
+          _mm_storeu_si128( (__m128i*) D,     _mm_unpacklo_epi32( d0, d1 ) );
+          _mm_storeu_si128( (__m128i*) D + 1, _mm_unpackhi_epi32( d0, d1 ) );
+
+          S += 4;
+          D += 8;
+     }
+
+     for (; w; w--) {
+          u32 s = *S++;
+          D[0].YUV.y = s;
+          D[1].YUV.y = s >> 16;
+          D[0].YUV.u =
+          D[1].YUV.u = s >>  8;
+          D[0].YUV.v =
+          D[1].YUV.v = s >> 24;
+          D += 2;
+     }
+}
+
+static void Load_NV12_LE_SSE2( DVCContext *ctx )
+{
+     const __m128i  ff  = _mm_set1_epi8( 0xff );
+     u8            *Sy  = ctx->src[0];
+     u16           *Suv = ctx->src[1];
+     DVCColor      *D   = ctx->buf[0];
+     int            w   = ctx->sw;
+     int            i;
+
+     for (i = 0; i + 8 <= w; i += 8) {
+          __m128i y  = _mm_loadl_epi64( (__m128i*) (Sy + i) );
+          __m128i uv = _mm_loadl_epi64( (__m128i*) (Suv + (i >> 1)) );
+          __m128i vu = _mm_or_si128( _mm_slli_epi16( uv, 8 ), _mm_srli_epi16( uv, 8 ) );
+          __m128i ya;
+
+          vu = _mm_unpacklo_epi16( vu, vu );
+          ya = _mm_unpacklo_epi8( y, ff );
+
+          _mm_storeu_si128( (__m128i*) (D + i),     _mm_unpacklo_epi16( vu, ya ) );
+          _mm_storeu_si128( (__m128i*) (D + i + 4), _mm_unpackhi_epi16( vu, ya ) );
+     }
+
+     for (; i < w; i++) {
+          u16 suv = le16(Suv[i>>1]);
+          D[i].YUV.y = Sy[i];
+          D[i].YUV.u = suv;
+          D[i].YUV.v = suv >> 8;
+     }
+}
+
+static void Load_YUV422_SSE2( DVCContext *ctx )
+{
+     const __m128i  ff = _mm_set1_epi8( 0xff );
+     u8            *Sy = ctx->src[0];
+     u8            *Su = ctx->src[1];
+     u8            *Sv = ctx->src[2];
+     DVCColor      *D  = ctx->buf[0];
+     int            w  = ctx->sw >> 1;
+
+     for (; w >= 8; w -= 8) {
+          __m128i y  = _mm_loadu_si128( (__m128i*) Sy );
+          __m128i u  = _mm_loadl_epi64( (__m128i*) Su );
+          __m128i v  = _mm_loadl_epi64( (__m128i*) Sv );
+          __m128i vu = _mm_unpacklo_epi8( v, u );
+          __m128i vl = _mm_unpacklo_epi16( vu, vu );
+          __m128i vh = _mm_unpackhi_epi16( vu, vu );
+          __m128i yl = _mm_unpacklo_epi8( y, ff );
+          __m128i yh = _mm_unpackhi_epi8( y, ff );
+
+          _mm_storeu_si128( (__m128i*) D,     _mm_unpacklo_epi16( vl, yl ) );
+          _mm_storeu_si128( (__m128i*) D + 1, _mm_unpackhi_epi16( vl, yl ) );
+          _mm_storeu_si128( (__m128i*) D + 2, _mm_unpacklo_epi16( vh, yh ) );
+          _mm_storeu_si128( (__m128i*) D + 3, _mm_unpackhi_epi16( vh, yh ) );
+
+          D  += 16;
+          Sy += 16;
+          Su += 8;
+          Sv += 8;
+     }
+
+     for (; w; w--) {
+          D[0].YUV.y = Sy[0];
+          D[1].YUV.y = Sy[1];
+          D[0].YUV.u =
+          D[1].YUV.u = Su[0];
+          D[0].YUV.v =
+          D[1].YUV.v = Sv[0];
+          D  += 2;
+          Sy += 2;
+          Su++;
+          Sv++;
+     }
+
+     if (ctx->sw & 1) {
+          D->YUV.y = *Sy;
+          D->YUV.u = *Su;
+          D->YUV.v = *Sv;
+     }
+}
+
+static void Store_RGB16_LE_SSE2( DVCContext *ctx )
+{
+     DVCColor *S = ctx->buf[0];
+     u16      *D = ctx->dst[0];
+     int       w = ctx->dw;
+
+     dither5_init( ctx->dy );
+     dither6_init( ctx->dy );
+
+     /* Dithering depends on the parity of the destination address. */
+     for (; w && ((long)D & 15); w--) {
+          int x = ((long)D >> 1) & 1;
+
+          *D++ = le16((dither5(S->RGB.r, x) << 8) |
+                      (dither6(S->RGB.g, x) << 3) |
+                      (dither5(S->RGB.b, x) >> 3));
+          S++;
+     }
+
+     if (w >= 8) {
+          /* Saturated add followed by masking is equal to dither5()/dither6(). */
+          const __m128i dither = _mm_set_epi8( 0, d5x[1], d6x[1], d5x[1], 0, d5x[0], d6x[0], d5x[0],
+                                               0, d5x[1], d6x[1], d5x[1], 0, d5x[0], d6x[0], d5x[0] );
+          const __m128i mask   = _mm_set1_epi32( 0x00f8fcf8 );
+          const __m128i mb     = _mm_set1_epi32( 0x0000001f );
+          const __m128i mg     = _mm_set1_epi32( 0x000007e0 );
+          const __m128i mr     = _mm_set1_epi32( 0x0000f800 );
+
+          for (; w >= 8; w -= 8) {
+               __m128i s0 = _mm_and_si128( _mm_adds_epu8( _mm_loadu_si128( (__m128i*) S ), dither ), mask );
+               __m128i s1 = _mm_and_si128( _mm_adds_epu8( _mm_loadu_si128( (__m128i*) S + 1 ), dither ), mask );
+
+               s0 = _mm_or_si128( _mm_or_si128( _mm_and_si128( _mm_srli_epi32( s0, 3 ), mb ),
+                                                _mm_and_si128( _mm_srli_epi32( s0, 5 ), mg ) ),
+                                  _mm_and_si128( _mm_srli_epi32( s0, 8 ), mr ) );
+               s1 = _mm_or_si128( _mm_or_si128( _mm_and_si128( _mm_srli_epi32( s1, 3 ), mb ),
+                                                _mm_and_si128( _mm_srli_epi32( s1, 5 ), mg ) ),
+                                  _mm_and_si128( _mm_srli_epi32( s1, 8 ), mr ) );
+
+               /* Sign extend for the signed saturating pack. */
+               s0 = _mm_srai_epi32( _mm_slli_epi32( s0, 16 ), 16 );
+               s1 = _mm_srai_epi32( _mm_slli_epi32( s1, 16 ), 16 );
+
+               _mm_store_si128( (__m128i*) D, _mm_packs_epi32( s0, s1 ) );
+
+               D += 8;
+               S += 8;
+          }
+     }
+
+     for (; w; w--) {
+          int x = ((long)D >> 1) & 1;
+
+          *D++ = le16((dither5(S->RGB.r, x) << 8) |
+                      (dither6(S->RGB.g, x) << 3) |
+                      (dither5(S->RGB.b, x) >> 3));
+          S++;
+     }
+}
+
+/*
+ * The line buffer has the DSPF_AYUV layout, the conversion is shared with the core's row converters.
+ */
+static void YCbCr_to_RGB_Proc_SSE2( DVCContext *ctx )
+{
+     dfb_convert_row_ayuv_to_argb( (u32*) ctx->buf[0], (u32*) ctx->buf[0], ctx->sw, DSCS_BT601 );
+}
+
+static void RGB_to_YCbCr_Proc_SSE2( DVCContext *ctx )
+{
+     dfb_convert_row_argb_to_ayuv( (u32*) ctx->buf[0], (u32*) ctx->buf[0], ctx->sw, DSCS_BT601 );
+}
+
+static void ScaleV_Up_Proc_SSE2( DVCContext *ctx )
+{
+     u32 *S = (u32*)ctx->buf[1];
+     u32 *D = (u32*)ctx->buf[0];
+
+     if (ctx->s_v & 0xff00) {
+          const __m128i zero = _mm_setzero_si128();
+          int           b    = (ctx->s_v & 0xff00) >> 8;
+          int           a    = 256 - b;
+          const __m128i va   = _mm_set1_epi16( a );
+          const __m128i vb   = _mm_set1_epi16( b );
+          int           n    = ctx->dw;
+
+          for (; n >= 4; n -= 4) {
+               __m128i s  = _mm_loadu_si128( (__m128i*) S );
+               __m128i d  = _mm_loadu_si128( (__m128i*) D );
+               __m128i lo = _mm_add_epi16( _mm_mullo_epi16( _mm_unpacklo_epi8( s, zero ), va ),
+                                           _mm_mullo_epi16( _mm_unpacklo_epi8( d, zero ), vb ) );
+               __m128i hi = _mm_add_epi16( _mm_mullo_epi16( _mm_unpackhi_epi8( s, zero ), va ),
+                                           _mm_mullo_epi16( _mm_unpackhi_epi8( d, zero ), vb ) );
+
+               _mm_storeu_si128( (__m128i*) D, _mm_packus_epi16( _mm_srli_epi16( lo, 8 ), _mm_srli_epi16( hi, 8 ) ) );
+
+               D += 4;
+               S += 4;
+          }
+
+          for (; n; n--) {
+               *D = ((((*S & 0x00ff00ff) * a + (*D & 0x00ff00ff) * b) >> 8) & 0x00ff00ff) |
+                    ((((*S & 0xff00ff00) >> 8) * a + ((*D & 0xff00ff00) >> 8) * b) & 0xff00ff00);
+               D++;
+               S++;
+          }
+     }
+     else if (ctx->s_v & 0x00ff) {
+          direct_memcpy( D, S, ctx->dw * sizeof(DVCColor) );
+     }
+}
+
+
+static void init_sse2( void )
+{
+     static int initialized = 0;
+
+     if (initialized)
+          return;
+
+     initialized = 1;
+
+     /* Same switch as for MMX, "no-mmx" turns off all x86 SIMD code. */
+     if (!dfb_config->mmx)
+          return;
+
+#if !defined(__amd64__) && !defined(__x86_64__)
+     /* Not all i386 CPUs have SSE2, init_mmx() and its CPUID macro are only available with USE_MMX. */
+     if (!__builtin_cpu_supports( "sse2" ))
+          return;
+#endif
+
+     Load_Proc[DVC_PIXELFORMAT_INDEX(DVCPF_YUYV_LE)] = Load_YUYV_LE_SSE2;
+     Load_Proc[DVC_PIXELFORMAT_INDEX(DVCPF_NV12_LE)] = Load_NV12_LE_SSE2;
+     Load_Proc[DVC_PIXELFORMAT_INDEX(DVCPF_YUV422)]  = Load_YUV422_SSE2;
+     Load_Proc[DVC_PIXELFORMAT_INDEX(DVCPF_YUV420)]  = Load_YUV422_SSE2;
+
+     Store_Proc[DVC_PIXELFORMAT_INDEX(DVCPF_RGB16_LE)] = Store_RGB16_LE_SSE2;
+
+     YCbCr_to_RGB_Proc = YCbCr_to_RGB_Proc_SSE2;
+     RGB_to_YCbCr_Proc = RGB_to_YCbCr_Proc_SSE2;
+     ScaleV_Up_Proc    = ScaleV_Up_Proc_SSE2;
+}
+
+
+#endif /* __DVC_SSE2_H__ */
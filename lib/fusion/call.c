@@ -44,6 +44,7 @@
 #include <direct/mem.h>
 #include <direct/memcpy.h>
 #include <direct/messages.h>
+#include <direct/timeline.h>
 
 #include <fusion/call.h>
 #include <fusion/conf.h>
@@ -341,6 +342,7 @@ fusion_call_execute (FusionCall          *call,
      }
      else {
           FusionCallExecute execute;
+          long long         start;
 
           execute.call_id  = call->call_id;
           execute.call_arg = call_arg;
@@ -350,6 +352,8 @@ fusion_call_execute (FusionCall          *call,
 
           fusion_world_flush_calls( _fusion_world( call->shared ), 1 );
 
+          start = direct_timeline_now();
+
           while (ioctl( _fusion_fd( call->shared ), FUSION_CALL_EXECUTE, &execute )) {
                switch (errno) {
                     case EINTR:
@@ -369,6 +373,8 @@ fusion_call_execute (FusionCall          *call,
                return DR_FAILURE;
           }
 
+          direct_timeline_complete( "fusion", "Execute", call->call_id, start );
+
           if (ret_val)
                *ret_val = execute.ret_val;
      }
@@ -410,6 +416,7 @@ fusion_call_execute2(FusionCall          *call,
      }
      else {
           FusionCallExecute2 execute;
+          long long          start;
 
           execute.call_id  = call->call_id;
           execute.call_arg = call_arg;
@@ -420,6 +427,8 @@ fusion_call_execute2(FusionCall          *call,
 
           fusion_world_flush_calls( _fusion_world( call->shared ), 1 );
 
+          start = direct_timeline_now();
+
           while (ioctl( _fusion_fd( call->shared ), FUSION_CALL_EXECUTE2, &execute )) {
                switch (errno) {
                     case EINTR:
@@ -439,6 +448,8 @@ fusion_call_execute2(FusionCall          *call,
                return DR_FAILURE;
           }
 
+          direct_timeline_complete( "fusion", "Execute2", call->call_id, start );
+
           if (ret_val)
                *ret_val = execute.ret_val;
      }
@@ -501,6 +512,7 @@ fusion_call_execute3(FusionCall          *call,
      else {
           FusionCallExecute3  execute;
           DirectResult        ret   = DR_OK;
+          long long           start;
 
           // check whether we can cache this call
           if (flags & FCEF_QUEUE && fusion_config->call_bin_max_num > 0 && length < 10000) {
@@ -556,6 +568,8 @@ fusion_call_execute3(FusionCall          *call,
 
           D_ASSERT( !(execute.flags & FCEF_ERROR) );
 
+          start = direct_timeline_now();
+
           while (ioctl( world->fusion_fd, FUSION_CALL_EXECUTE3, &execute )) {
                switch (errno) {
                     case EINTR:
@@ -578,6 +592,8 @@ fusion_call_execute3(FusionCall          *call,
                return DR_FAILURE;
           }
 
+          direct_timeline_complete( "fusion", "Execute3", call->call_id, start );
+
           if (ret_length)
                *ret_length = execute.ret_length;
      }
@@ -590,6 +606,7 @@ fusion_world_flush_calls( FusionWorld *world, int lock )
 {
      DirectResult  ret = DR_OK;
      CallTLS      *call_tls;
+     long long     start;
 
      call_tls = Call_GetTLS( world );
 
@@ -620,6 +637,8 @@ fusion_world_flush_calls( FusionWorld *world, int lock )
 
           call_tls->bins[call_tls->bins_num - 1].flags &= ~(FCEF_FOLLOW | FCEF_QUEUE);
 
+          start = direct_timeline_now();
+
           while (ioctl( world->fusion_fd, FUSION_CALL_EXECUTE3, call_tls->bins )) {
                switch (errno) {
                     case EINTR:
@@ -642,6 +661,8 @@ fusion_world_flush_calls( FusionWorld *world, int lock )
                break;
           }
 
+          direct_timeline_complete( "fusion", "Flush", call_tls->bins_num, start );
+
           call_tls->bins_num      = 0;
           call_tls->bins_data_len = 0;
      }
@@ -1222,6 +1243,7 @@ fusion_call_execute_internal (FusionCall          *call,
           int       fd;
           socklen_t len;
           int       err;
+          long long start;
 
           fd = socket( PF_LOCAL, SOCK_RAW, 0 );
           if (fd < 0) {
@@ -1259,6 +1281,8 @@ fusion_call_execute_internal (FusionCall          *call,
           snprintf( addr.sun_path, sizeof(addr.sun_path), 
                     "/tmp/.fusion-%d/%lx", call->shared->world_index, call->fusion_id );
 
+          start = direct_timeline_now();
+
           ret = _fusion_send_message( fd, msg, sizeof(FusionCallMessage) + length, &addr );
           if (ret == DR_OK) {
                char              buf[sizeof(FusionCallReturn) + ret_size];
@@ -1279,6 +1303,8 @@ fusion_call_execute_internal (FusionCall          *call,
                          *ret_length = callret->length;
                } 
           }
+
+          direct_timeline_complete( "fusion", "Execute", call->call_id, start );
           
           len = sizeof(addr);
           if (getsockname( fd, (struct sockaddr*)&addr, &len ) == 0)
@@ -139,6 +139,33 @@ ISaWManWM_Real::GetPerformance(
      return DFB_OK;
 }
 
+DFBResult
+ISaWManWM_Real::GetCachePerformance(
+                    DFBWindowStackingClass                     stacking,
+                    DFBBoolean                                 reset,
+                    u32                                       *ret_hits,
+                    u32                                       *ret_rebuilds,
+                    u64                                       *ret_saved
+)
+{
+     DFBResult          ret;
+     unsigned int       hits;
+     unsigned int       rebuilds;
+     unsigned long long saved;
+
+     D_DEBUG_AT( DirectFB_SaWMan, "%s()", __FUNCTION__ );
+
+     ret = sawman_get_cache_performance( obj, stacking, reset, &hits, &rebuilds, &saved );
+     if (ret)
+          return ret;
+
+     *ret_hits     = hits;
+     *ret_rebuilds = rebuilds;
+     *ret_saved    = saved;
+
+     return DFB_OK;
+}
+
 
 }
 
@@ -278,6 +278,37 @@ ISaWMan_GetPerformance( ISaWMan                *thiz,
      return DR_OK;
 }
 
+static DirectResult
+ISaWMan_GetCachePerformance( ISaWMan                *thiz,
+                             DFBWindowStackingClass  stacking,
+                             DFBBoolean              reset,
+                             unsigned int           *ret_hits,
+                             unsigned int           *ret_rebuilds,
+                             unsigned long long     *ret_saved )
+{
+     DFBResult ret;
+     u32       hits;
+     u32       rebuilds;
+     u64       saved;
+
+     DIRECT_INTERFACE_GET_DATA( ISaWMan )
+
+     ret = SaWMan_GetCachePerformance( data->sawman, stacking, reset, &hits, &rebuilds, &saved );
+     if (ret)
+          return ret;
+
+     if (ret_hits)
+          *ret_hits = hits;
+
+     if (ret_rebuilds)
+          *ret_rebuilds = rebuilds;
+
+     if (ret_saved)
+          *ret_saved = saved;
+
+     return DR_OK;
+}
+
 typedef struct {
      DirectLink          link;
 
@@ -411,6 +442,7 @@ ISaWMan_Construct( ISaWMan       *thiz,
      thiz->RegisterListeners   = ISaWMan_RegisterListeners;
      thiz->UnregisterListeners = ISaWMan_UnregisterListeners;
      thiz->GetPerformance      = ISaWMan_GetPerformance;
+     thiz->GetCachePerformance = ISaWMan_GetCachePerformance;
 
      return DFB_OK;
 }
@@ -510,6 +510,30 @@ ISaWManManager_IsWindowShowing( ISaWManManager     *thiz,
      return SaWManManager_IsShowingWindow( data->manager, sawwin, ret_showing );
 }
 
+static DirectResult
+ISaWManManager_GetWindowStats( ISaWManManager     *thiz,
+                               SaWManWindowHandle  handle,
+                               SaWManWindowStats  *ret_stats )
+{
+     SaWMan       *sawman;
+     SaWManWindow *sawwin = (SaWManWindow*)handle;
+
+     DIRECT_INTERFACE_GET_DATA( ISaWManManager )
+
+     D_DEBUG_AT( SaWMan_Manager, "%s()\n", __FUNCTION__ );
+
+     if (!ret_stats || (handle == SAWMAN_WINDOW_NONE))
+          return DFB_INVARG;
+
+     sawman = data->sawman;
+     D_MAGIC_ASSERT( sawman, SaWMan );
+     D_MAGIC_ASSERT( sawwin, SaWManWindow );
+
+     sawman_window_stats_get( sawwin, ret_stats );
+
+     return DFB_OK;
+}
+
 DirectResult
 ISaWManManager_Construct( ISaWManManager *thiz,
                           SaWMan         *sawman,
@@ -543,6 +567,7 @@ ISaWManManager_Construct( ISaWManManager *thiz,
      thiz->GetWindowInfo   = ISaWManManager_GetWindowInfo;
      thiz->GetProcessInfo  = ISaWManManager_GetProcessInfo;
      thiz->IsWindowShowing = ISaWManManager_IsWindowShowing;
+     thiz->GetWindowStats  = ISaWManManager_GetWindowStats;
 
      return DFB_OK;
 }
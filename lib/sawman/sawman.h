@@ -192,6 +192,27 @@ typedef struct {
      SaWManWindowFlags        flags;
 } SaWManWindowInfo;
 
+#define SAWMAN_WINDOW_STATS_BUCKETS  8
+
+/*
+ * Frame statistics of a window, counted since its creation.
+ *
+ * Sample them twice and subtract to get the values of an interval.
+ */
+typedef struct {
+     unsigned int             frames_submitted;  /* flips of the window */
+     unsigned int             frames_displayed;  /* flips that made it to the screen */
+     unsigned int             frames_merged;     /* flips replaced by a newer one before being displayed */
+
+     unsigned long long       pixels;            /* pixels composited from the window */
+
+     long long                latency_total;     /* sum of flip to display latencies in micro seconds */
+     long long                latency_max;       /* highest flip to display latency in micro seconds */
+
+     unsigned int             histogram[SAWMAN_WINDOW_STATS_BUCKETS];  /* latencies below 2^n ms (last one: all others),
+                                                                          only with 'window-histogram' option */
+} SaWManWindowStats;
+
 typedef struct {
      SaWManWindowHandle       handle;
 
@@ -417,6 +438,21 @@ DEFINE_INTERFACE(   ISaWMan,
           unsigned long long       *ret_pixels,
           long long                *ret_duration
      );
+
+     /*
+      * Read counters of the compositing cache.
+      *
+      * Hits are blits from the cache, saved are the pixels of cached windows
+      * which did not need to be blended again.
+      */
+     DirectResult (*GetCachePerformance) (
+          ISaWMan                  *thiz,
+          DFBWindowStackingClass    stacking,
+          DFBBoolean                reset,
+          unsigned int             *ret_hits,
+          unsigned int             *ret_rebuilds,
+          unsigned long long       *ret_saved
+     );
 )
 
 
@@ -596,6 +632,17 @@ DEFINE_INTERFACE(   ISaWManManager,
           SaWManWindowHandle        handle,
           DFBBoolean               *ret_showing
      );
+
+     /*
+      * Returns frame statistics of the requested window.
+      *
+      * The counters are read without locking.
+      */
+     DirectResult (*GetWindowStats) (
+          ISaWManManager           *thiz,
+          SaWManWindowHandle        handle,
+          SaWManWindowStats        *ret_stats
+     );
 )
 
 /**********************************************************************************************************************/
@@ -73,8 +73,12 @@ static const char *config_usage =
      "  resolution=<width>x<height>        Set virtual SaWMan resolution\n"
      "  [no-]static-layer                  Disable layer reconfiguration\n"
      "  update-region-mode=<num>           Set internal update region mode (1-3, default 2)\n"
+     "  compositing-cache=<num>            Cache bottom windows not updated for <num> repaints (default 0 = off)\n"
      "  keep-implicit-key-grabs            Causes implicit key grabs to stay even when window is withdrawn\n"
      "  hide-cursor-without-window         Hides the cursor when no window has control over it\n"
+     "  [no-]window-histogram              Record flip to display latency histograms per window\n"
+     "  overlay-layer=<layer-id>           Promote opaque windows to this layer instead of compositing them\n"
+     "  overlay-hysteresis=<num>           Frames a window has to be eligible before promotion (default 3)\n"
      "\n";
 
 
@@ -149,6 +153,8 @@ config_allocate( void )
 
      sawman_config->update_region_mode = 4;
 
+     sawman_config->overlay_hysteresis = 3;
+
      sawman_config->static_layer = true;
 
 
@@ -413,11 +419,76 @@ sawman_config_set( const char *name, const char *value )
                return DFB_INVARG;
           }
      } else
+     if (strcmp (name, "compositing-cache" ) == 0) {
+          if (value) {
+               int frames;
+
+               if (sscanf( value, "%d", &frames ) < 1) {
+                    D_ERROR("SaWMan/Config '%s': Could not parse value!\n", name);
+                    return DFB_INVARG;
+               }
+               if (frames < 0) {
+                    D_ERROR("SaWMan/Config '%s': Value %d out of bounds!\n", name, frames);
+                    return DFB_INVARG;
+               }
+               sawman_config->compositing_cache = frames;
+          }
+          else {
+               D_ERROR("SaWMan/Config '%s': No value specified!\n", name);
+               return DFB_INVARG;
+          }
+     } else
      if (strcmp (name, "keep-implicit-key-grabs") == 0) {
           sawman_config->keep_implicit_key_grabs = true;
      } else
      if (strcmp (name, "hide-cursor-without-window") == 0) {
           sawman_config->hide_cursor_without_window = true;
+     } else
+     if (strcmp (name, "overlay-layer" ) == 0) {
+          if (value) {
+               int id;
+
+               if (sscanf( value, "%d", &id ) < 1) {
+                    D_ERROR("SaWMan/Config '%s': Could not parse value!\n", name);
+                    return DFB_INVARG;
+               }
+
+               if (id < 0 || id >= MAX_LAYERS) {
+                    D_ERROR("SaWMan/Config '%s': Value %d out of bounds!\n", name, id);
+                    return DFB_INVARG;
+               }
+
+               sawman_config->overlay_layers |= 1 << id;
+          }
+          else {
+               D_ERROR("SaWMan/Config '%s': No value specified!\n", name);
+               return DFB_INVARG;
+          }
+     } else
+     if (strcmp (name, "overlay-hysteresis" ) == 0) {
+          if (value) {
+               int frames;
+
+               if (sscanf( value, "%d", &frames ) < 1) {
+                    D_ERROR("SaWMan/Config '%s': Could not parse value!\n", name);
+                    return DFB_INVARG;
+               }
+               if (frames < 1) {
+                    D_ERROR("SaWMan/Config '%s': Value %d out of bounds!\n", name, frames);
+                    return DFB_INVARG;
+               }
+               sawman_config->overlay_hysteresis = frames;
+          }
+          else {
+               D_ERROR("SaWMan/Config '%s': No value specified!\n", name);
+               return DFB_INVARG;
+          }
+     } else
+     if (strcmp (name, "window-histogram") == 0) {
+          sawman_config->window_histogram = true;
+     } else
+     if (strcmp (name, "no-window-histogram") == 0) {
+          sawman_config->window_histogram = false;
      } else
           return DFB_UNSUPPORTED;
 
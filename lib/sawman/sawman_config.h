@@ -63,11 +63,18 @@ typedef struct {
 
      int                   update_region_mode;
 
+     unsigned int          compositing_cache;   /* repaints without update before windows are cached, 0 = off */
+
      bool                  keep_implicit_key_grabs;
 
      DFBDimension          passive3d_mode;
 
      bool                  hide_cursor_without_window;
+
+     bool                  window_histogram;    /* record flip to display latency histograms per window */
+
+     u32                   overlay_layers;      /* mask of layer ids windows may be promoted to */
+     unsigned int          overlay_hysteresis;  /* passes a window has to be eligible before promotion */
 } SaWManConfig;
 
 
@@ -70,6 +70,7 @@
 
 #include "sawman_config.h"
 #include "sawman_draw.h"
+#include "sawman_overlay.h"
 
 #include "isawman.h"
 
@@ -355,6 +356,10 @@ sawman_post_init( SaWMan      *sawman,
           }
      }
 
+     /* Initialize layers for window promotion? */
+     if (sawman_config->overlay_layers)
+          sawman_overlays_init( sawman );
+
      sawman_unlock( sawman );
 
      return DFB_OK;
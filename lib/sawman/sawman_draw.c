@@ -102,6 +102,44 @@ sawman_get_performance( SaWMan                 *sawman,
      return DFB_OK;
 }
 
+DFBResult
+sawman_get_cache_performance( SaWMan                 *sawman,
+                              DFBWindowStackingClass  stacking,
+                              bool                    reset,
+                              unsigned int           *ret_hits,
+                              unsigned int           *ret_rebuilds,
+                              unsigned long long     *ret_saved )
+{
+     SaWManTier *tier;
+
+     sawman_lock( sawman );
+
+     tier = sawman_tier_by_class( sawman, stacking );
+     if (!tier) {
+          sawman_unlock( sawman );
+          return DFB_BUG;
+     }
+
+     if (ret_hits)
+          *ret_hits = tier->cache.hits;
+
+     if (ret_rebuilds)
+          *ret_rebuilds = tier->cache.rebuilds;
+
+     if (ret_saved)
+          *ret_saved = tier->cache.saved;
+
+     if (reset) {
+          tier->cache.hits     = 0;
+          tier->cache.rebuilds = 0;
+          tier->cache.saved    = 0;
+     }
+
+     sawman_unlock( sawman );
+
+     return DFB_OK;
+}
+
 void
 sawman_dispatch_tier_update( SaWMan             *sawman,
                              SaWManTier         *tier,
@@ -444,6 +482,10 @@ draw_window( SaWManTier   *tier,
      D_DEBUG_AT( SaWMan_Draw, "%s( %p, %d,%d-%dx%d )\n", __FUNCTION__,
                  sawwin, DFB_RECTANGLE_VALS_FROM_REGION( region ) );
 
+     /* Shown on its own layer above the tier. */
+     if (sawwin->overlay)
+          return;
+
      if (window->config.options & DWOP_STEREO_SIDE_BY_SIDE_HALF) {
           src.x /= 2;
           src.w /= 2;
@@ -463,11 +505,16 @@ draw_window( SaWManTier   *tier,
      if (!dfb_region_rectangle_intersect( &clip, &dst ))
           return;
 
+     sawman_window_stats_pixels( sawwin, (clip.x2 - clip.x1 + 1) * (clip.y2 - clip.y1 + 1) );
 
-     sawman_dispatch_blit( sawman, sawwin, right_eye, &sawwin->src, &dst, &clip );
 
-     if (sawwin2)
-          sawman_dispatch_blit( sawman, sawwin2, right_eye, &sawwin2->src, &dst, &clip );
+     /* Listeners only get blits to the tier itself. */
+     if (!tier->cache.building) {
+          sawman_dispatch_blit( sawman, sawwin, right_eye, &sawwin->src, &dst, &clip );
+
+          if (sawwin2)
+               sawman_dispatch_blit( sawman, sawwin2, right_eye, &sawwin2->src, &dst, &clip );
+     }
 
 
      /* Backup clipping region. */
@@ -700,6 +747,8 @@ draw_window_color( SaWManWindow *sawwin,
      if (!dfb_region_rectangle_intersect( &clip, &dst ))
           return;
 
+     sawman_window_stats_pixels( sawwin, (clip.x2 - clip.x1 + 1) * (clip.y2 - clip.y1 + 1) );
+
      /* Backup clipping region. */
      old_clip = state->clip;
 
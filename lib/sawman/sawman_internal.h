@@ -141,6 +141,7 @@ extern "C"
 #define SAWMAN_MAX_VISIBLE_REGIONS      10   // for the visible window region detection
 #define SAWMAN_MAX_UPDATES_REGIONS      10   // for the DSFLIP_QUEUE / DSFLIP_FLUSH implementation
 #define SAWMAN_MAX_IMPLICIT_KEYGRABS    16
+#define SAWMAN_MAX_OVERLAYS              4   // layers windows can be promoted to
 
 /**********************************************************************************************************************/
 
@@ -239,6 +240,26 @@ typedef struct {
      SaWManChangeFocusReason  reason;
 } SaWManChangeFocusArgs;
 
+/*
+ * Layer showing a single window instead of compositing it into a tier
+ */
+typedef struct {
+     DFBDisplayLayerID       layer_id;
+     CoreLayerContext       *context;
+     CoreLayerRegion        *region;
+
+     SaWManWindow           *window;            /* promoted window, NULL if unused */
+     SaWManTier             *tier;              /* tier of the window */
+     DFBRectangle            src;               /* window source of the promotion */
+     DFBRectangle            dst;               /* window destination of the promotion */
+     DFBSurfacePixelFormat   format;
+     bool                    dirty;             /* window flipped since the layer was updated */
+
+     SaWManWindow           *candidate;         /* window to be promoted next */
+     unsigned int            candidate_count;   /* flips it has been eligible for */
+     u32                     candidate_flips;   /* flips of its surface when last counted */
+} SaWManOverlay;
+
 struct __SaWMan_SaWMan {
      int                   magic;
 
@@ -315,6 +336,9 @@ struct __SaWMan_SaWMan {
           SaWManWindow        *confined;
      } cursor;
 
+     SaWManOverlay            overlays[SAWMAN_MAX_OVERLAYS];
+     int                      num_overlays;
+
      FusionCall                call;
 
      FusionReactor            *reactor;
@@ -350,6 +374,24 @@ typedef struct {
      DFBRegion               updated_regions[SAWMAN_MAX_UPDATED_REGIONS];
 } SaWManTierLR;
 
+/*
+ * State of a layout entry when it has been composited into the cache
+ */
+typedef struct {
+     SaWManWindow           *sawwin;
+     bool                    visible;
+     DFBRectangle            bounds;
+     DFBRectangle            src;
+     DFBRectangle            dst;
+     CoreSurface            *surface;
+     CoreWindowFlags         flags;
+     int                     opacity;
+     DFBWindowOptions        options;
+     DFBColor                color;
+     u32                     color_key;
+     DFBRegion               opaque;
+} SaWManCacheEntry;
+
 /*
  * Per HW layer
  */
@@ -405,12 +447,33 @@ struct __SaWMan_SaWManTier {
      SaWManTierLR            left;
      SaWManTierLR            right;
 
+     u32                     damaged;            /* frame counter of the region surface when its back buffer
+                                                    got the damage of older frames, 0 if never */
+
      struct {
           long long               stamp;
           unsigned int            updates;
           unsigned long long      pixels;
      } performance;
 
+     struct {
+          CoreSurface            *surface;      /* background and bottom windows composited */
+          int                     count;        /* layout entries taken from the surface, 0 if invalid */
+          SaWManCacheEntry       *entries;      /* state of those entries, in shared memory */
+          int                     max_entries;
+          DFBDisplayLayerBackgroundMode  bg_mode;
+          DFBColor                bg_color;
+          int                     bg_color_index;
+          CoreSurface            *bg_image;
+          unsigned int            frame;        /* repaints of the tier, for window stamps */
+          unsigned int            built;        /* frame of the last build from the background */
+          bool                    building;
+
+          unsigned int            hits;
+          unsigned int            rebuilds;
+          unsigned long long      saved;        /* window pixels not blended again */
+     } cache;
+
      DFBDisplayLayerConfig   driver_config;
      bool                    driver_config_set;
 
@@ -464,6 +527,14 @@ struct __SaWMan_SaWManWindow {
 
      long long              update_ms;
 
+     unsigned int           changed;            /* tier's cache frame of the last update */
+
+     SaWManWindowStats      stats;              /* updated atomically, see sawman_window_stats_get() */
+     long long              stats_stamp;        /* time of the flip not displayed yet, 0 if none */
+
+     SaWManOverlay         *overlay;            /* layer the window is shown on instead of its tier */
+     u32                    overlay_reject;     /* signature of a configuration the layer did not accept */
+
      SaWManWindowLR         left;
      SaWManWindowLR         right;
 };
@@ -551,6 +622,13 @@ DFBResult sawman_get_performance( SaWMan                 *sawman,
                                   unsigned long long     *ret_pixels,
                                   long long              *ret_duration );
 
+DFBResult sawman_get_cache_performance( SaWMan                 *sawman,
+                                        DFBWindowStackingClass  clazz,
+                                        bool                    reset,
+                                        unsigned int           *ret_hits,
+                                        unsigned int           *ret_rebuilds,
+                                        unsigned long long     *ret_saved );
+
 void sawman_dispatch_tier_update( SaWMan             *sawman,
                                   SaWManTier         *tier,
                                   bool                right_eye,
@@ -0,0 +1,575 @@
+/*
+   (c) Copyright 2012-2013  DirectFB integrated media GmbH
+   (c) Copyright 2001-2013  The world wide DirectFB Open Source Community (directfb.org)
+   (c) Copyright 2000-2004  Convergence (integrated media) GmbH
+
+   All rights reserved.
+
+   Written by Denis Oliver Kropp <dok@directfb.org>,
+              Andreas Shimokawa <andi@directfb.org>,
+              Marek Pikarski <mass@directfb.org>,
+              Sven Neumann <neo@directfb.org>,
+              Ville Syrjälä <syrjala@sci.fi> and
+              Claudio Ciccani <klan@users.sf.net>.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+//#define DIRECT_ENABLE_DEBUG
+
+#include <config.h>
+
+#include <direct/debug.h>
+#include <direct/messages.h>
+
+#include <core/layer_context.h>
+#include <core/layer_control.h>
+#include <core/layer_region.h>
+#include <core/layers.h>
+#include <core/screen.h>
+#include <core/windows_internal.h>
+
+#include <sawman.h>
+
+#include "sawman_config.h"
+#include "sawman_overlay.h"
+#include "sawman_window.h"
+
+
+D_DEBUG_DOMAIN( SaWMan_Overlay, "SaWMan/Overlay", "SaWMan window promotion to layers" );
+
+/**********************************************************************************************************************/
+
+/*
+ * Windows that are opaque, not covered and not decorated can be shown on a layer of their own,
+ * avoiding to composite them into their tier. Only layers above the tier are used,
+ * so the stale tier content below the window does not matter.
+ *
+ * The layer scans out the window surface itself, a flip of the window only makes the layer show
+ * its new front buffer. With a double buffered window surface the client may draw into the buffer
+ * still being shown until then, triple buffered ones avoid that.
+ *
+ * A window has to be eligible for 'overlay-hysteresis' of its flips before being promoted.
+ * It is demoted in the pass it is no longer eligible or its geometry changed.
+ */
+
+DFBResult
+sawman_overlays_init( SaWMan *sawman )
+{
+     DFBResult          ret;
+     DFBDisplayLayerID  id;
+     SaWManTier        *tier;
+
+     D_DEBUG_AT( SaWMan_Overlay, "%s( 0x%08x )\n", __FUNCTION__, sawman_config->overlay_layers );
+
+     D_MAGIC_ASSERT( sawman, SaWMan );
+     FUSION_SKIRMISH_ASSERT( sawman->lock );
+
+     for (id=0; id<MAX_LAYERS; id++) {
+          SaWManOverlay *overlay;
+          CoreLayer     *layer;
+
+          if (!(sawman_config->overlay_layers & (1 << id)))
+               continue;
+
+          if (sawman->num_overlays == SAWMAN_MAX_OVERLAYS) {
+               D_ERROR( "SaWMan/Overlay: Maximum number of %d overlays reached!\n", SAWMAN_MAX_OVERLAYS );
+               break;
+          }
+
+          if (sawman_tier_by_layer( sawman, id, &tier ) ||
+              (sawman_config->cursor.hw && sawman_config->cursor.layer_id == id))
+          {
+               D_ERROR( "SaWMan/Overlay: Layer %u is already in use!\n", id );
+               continue;
+          }
+
+          layer = dfb_layer_at( id );
+          if (!layer) {
+               D_ERROR( "SaWMan/Overlay: No layer with id %u!\n", id );
+               continue;
+          }
+
+          overlay = &sawman->overlays[sawman->num_overlays];
+
+          ret = dfb_layer_create_context( layer, false, &overlay->context );
+          if (ret) {
+               D_DERROR( ret, "SaWMan/Overlay: Could not create context at layer (id %u)!\n", id );
+               continue;
+          }
+
+          ret = dfb_layer_region_create( overlay->context, &overlay->region );
+          if (ret) {
+               D_DERROR( ret, "SaWMan/Overlay: Could not create region at layer (id %u)!\n", id );
+               dfb_layer_context_unref( overlay->context );
+               overlay->context = NULL;
+               continue;
+          }
+
+          /* The region shows window surfaces, never free their buffers. */
+          overlay->region->config.keep_buffers = true;
+
+          dfb_layer_activate_context( layer, overlay->context );
+
+          overlay->layer_id = id;
+
+          sawman->num_overlays++;
+
+          D_INFO( "SaWMan/Overlay: Using layer %u for window promotion\n", id );
+     }
+
+     return DFB_OK;
+}
+
+/**********************************************************************************************************************/
+
+static u32
+overlay_signature( const SaWManWindow *sawwin )
+{
+     const CoreWindow *window = sawwin->window;
+
+     return window->surface->config.format ^ (sawwin->src.w << 4) ^ (sawwin->src.h << 18) ^
+            (sawwin->dst.w << 8) ^ (sawwin->dst.h << 22);
+}
+
+/*
+ * Checks if layer 'a' is shown above layer 'b', by their levels if the driver knows them, by id otherwise.
+ */
+static bool
+layer_above( DFBDisplayLayerID a,
+             DFBDisplayLayerID b )
+{
+     int level_a;
+     int level_b;
+
+     if (dfb_layer_get_level( dfb_layer_at( a ), &level_a ) == DFB_OK &&
+         dfb_layer_get_level( dfb_layer_at( b ), &level_b ) == DFB_OK)
+          return level_a > level_b;
+
+     return a > b;
+}
+
+/*
+ * Calculates the layer destination of the window, false if the layer can't show it there.
+ */
+static bool
+overlay_destination( const SaWManOverlay *overlay,
+                     const SaWManTier    *tier,
+                     const SaWManWindow  *sawwin,
+                     DFBRectangle        *ret_dst )
+{
+     CoreLayer    *layer;
+     DFBRectangle  dst = sawwin->dst;
+     int           screen_width;
+     int           screen_height;
+
+     layer = dfb_layer_at( overlay->layer_id );
+     D_ASSERT( layer != NULL );
+     D_ASSERT( layer->shared != NULL );
+
+     dfb_screen_get_screen_size( layer->screen, &screen_width, &screen_height );
+
+     if (layer->shared->description.caps & DLCAPS_SCREEN_LOCATION) {
+          dst.x = dst.x * screen_width  / tier->size.w;
+          dst.y = dst.y * screen_height / tier->size.h;
+          dst.w = dst.w * screen_width  / tier->size.w;
+          dst.h = dst.h * screen_height / tier->size.h;
+     }
+     else {
+          if (dst.w != sawwin->src.w || dst.h != sawwin->src.h)
+               return false;
+
+          if (layer->shared->description.caps & DLCAPS_SCREEN_POSITION) {
+               dst.x += (screen_width  - tier->size.w) / 2;
+               dst.y += (screen_height - tier->size.h) / 2;
+          }
+          else if (dst.x != 0 || dst.y != 0 || dst.w != screen_width || dst.h != screen_height)
+               return false;
+     }
+
+#ifdef SAWMAN_NO_LAYER_DOWNSCALE
+     if (dst.w < sawwin->src.w || dst.h < sawwin->src.h)
+          return false;
+#endif
+
+     *ret_dst = dst;
+
+     return true;
+}
+
+/*
+ * Checks if the window at the layout index can be shown on the overlay.
+ */
+static bool
+overlay_eligible( SaWMan        *sawman,
+                  SaWManOverlay *overlay,
+                  SaWManWindow  *sawwin,
+                  int            index,
+                  SaWManTier   **ret_tier,
+                  DFBRectangle  *ret_dst )
+{
+     int           i;
+     CoreWindow   *window;
+     SaWManTier   *tier;
+     SaWManWindow *above;
+     DFBRegion     area;
+
+     window = sawwin->window;
+     D_MAGIC_COREWINDOW_ASSERT( window );
+
+     if (!SAWMAN_VISIBLE_WINDOW( window ) || SAWMAN_TRANSLUCENT_WINDOW( window ))
+          return false;
+
+     if (!window->surface || (window->caps & (DWCAPS_COLOR | DWCAPS_LR_MONO | DWCAPS_STEREO)) ||
+         (window->config.options & DWOP_STEREO_SIDE_BY_SIDE_HALF) || window->config.color.a)
+          return false;
+
+     if (sawman_window_border( sawwin ))
+          return false;
+
+     /* Promoted elsewhere? */
+     if (sawwin->overlay && sawwin->overlay != overlay)
+          return false;
+
+     tier = sawman_tier_by_class( sawman, window->config.stacking );
+     if (!tier || !tier->active || tier->single_mode || !layer_above( overlay->layer_id, tier->layer_id ) ||
+         (tier->region->config.options & DLOP_STEREO))
+          return false;
+
+     /* Must be completely inside of the tier. */
+     if (sawwin->dst.x < 0 || sawwin->dst.y < 0 ||
+         sawwin->dst.x + sawwin->dst.w > tier->size.w ||
+         sawwin->dst.y + sawwin->dst.h > tier->size.h)
+          return false;
+
+     dfb_region_from_rectangle( &area, &sawwin->dst );
+
+     /* Software cursor would be hidden. */
+     if (!sawman->cursor.region && tier->cursor_drawn && dfb_region_region_intersects( &area, &tier->cursor_region ))
+          return false;
+
+     /* Hardware cursor would be hidden, wherever it moves to without another pass. */
+     if (sawman->cursor.region && D_FLAGS_IS_SET( sawman->cursor.region->state, CLRSF_ENABLED ) &&
+         !layer_above( sawman_config->cursor.layer_id, overlay->layer_id ))
+          return false;
+
+     /* Nothing must be shown above it. */
+     for (i=index+1; i<sawman->layout.count; i++) {
+          above = fusion_vector_at( &sawman->layout, i );
+          D_MAGIC_ASSERT( above, SaWManWindow );
+
+          if (SAWMAN_VISIBLE_WINDOW( above->window ) &&
+              dfb_region_intersects( &area, DFB_REGION_VALS_FROM_RECTANGLE( &above->bounds ) ))
+               return false;
+     }
+
+     /* Layer did not accept it before. */
+     if (!sawwin->overlay && sawwin->overlay_reject == overlay_signature( sawwin ))
+          return false;
+
+     if (!overlay_destination( overlay, tier, sawwin, ret_dst ))
+          return false;
+
+     *ret_tier = tier;
+
+     return true;
+}
+
+/*
+ * Repaints the window's area on its tier.
+ */
+static void
+update_tier( SaWManTier         *tier,
+             const DFBRectangle *rect )
+{
+     DFBRegion region = DFB_REGION_INIT_FROM_RECTANGLE( rect );
+
+     if (dfb_unsafe_region_intersect( &region, 0, 0, tier->size.w - 1, tier->size.h - 1 ))
+          dfb_updates_add( &tier->left.updates, &region );
+}
+
+static void
+overlay_demote( SaWMan        *sawman,
+                SaWManOverlay *overlay )
+{
+     SaWManWindow *sawwin = overlay->window;
+
+     D_MAGIC_ASSERT( sawwin, SaWManWindow );
+     D_MAGIC_ASSERT( overlay->tier, SaWManTier );
+
+     D_DEBUG_AT( SaWMan_Overlay, "  -> demoting window %u from layer %u\n", sawwin->id, overlay->layer_id );
+
+     dfb_layer_region_disable( overlay->region );
+
+     /* Drop the reference to the window surface. */
+     dfb_layer_region_set_surface( overlay->region, NULL, false );
+
+     /* Composite it again, at the old and the current position. */
+     update_tier( overlay->tier, &overlay->dst );
+     update_tier( overlay->tier, &sawwin->dst );
+
+     overlay->tier->cache.count = 0;
+
+     sawwin->overlay = NULL;
+
+     overlay->window = NULL;
+     overlay->tier   = NULL;
+}
+
+/*
+ * Shows the new front buffer of the window surface, which has been flipped already.
+ */
+static void
+overlay_update( SaWMan              *sawman,
+                SaWManOverlay       *overlay,
+                DFBSurfaceFlipFlags  flags )
+{
+     SaWManWindow *sawwin = overlay->window;
+
+     D_MAGIC_ASSERT( sawwin, SaWManWindow );
+
+     sawman_dispatch_blit( sawman, sawwin, false, &sawwin->src, &sawwin->dst, NULL );
+
+     dfb_layer_region_flip_update( overlay->region, NULL, (flags & ~DSFLIP_SWAP) | DSFLIP_UPDATE );
+
+     overlay->dirty = false;
+
+     sawman_window_stats_displayed( sawman, sawwin );
+}
+
+static DFBResult
+overlay_promote( SaWMan             *sawman,
+                 SaWManOverlay      *overlay,
+                 SaWManTier         *tier,
+                 SaWManWindow       *sawwin,
+                 const DFBRectangle *dst )
+{
+     DFBResult                   ret;
+     CoreLayer                  *layer;
+     CoreLayerRegion            *region = overlay->region;
+     CoreSurface                *surface;
+     CoreLayerRegionConfig       config;
+     CoreLayerRegionConfigFlags  failed;
+
+     layer = dfb_layer_at( overlay->layer_id );
+     D_ASSERT( layer != NULL );
+     D_ASSERT( layer->funcs != NULL );
+     D_ASSERT( layer->funcs->TestRegion != NULL );
+
+     surface = sawwin->window->surface;
+     D_ASSERT( surface != NULL );
+
+     D_DEBUG_AT( SaWMan_Overlay, "  -> promoting window %u (%dx%d %s) to layer %u at %d,%d-%dx%d\n",
+                 sawwin->id, sawwin->src.w, sawwin->src.h, dfb_pixelformat_name( surface->config.format ),
+                 overlay->layer_id, DFB_RECTANGLE_VALS( dst ) );
+
+     config = overlay->context->primary.config;
+
+     config.width        = surface->config.size.w;
+     config.height       = surface->config.size.h;
+     config.format       = surface->config.format;
+     config.colorspace   = surface->config.colorspace;
+     config.options      = DLOP_NONE;
+     config.surface_caps = surface->config.caps & (DSCAPS_INTERLACED | DSCAPS_SEPARATED | DSCAPS_PREMULTIPLIED);
+     config.source       = sawwin->src;
+     config.dest         = *dst;
+     config.keep_buffers = true;
+
+     if (surface->config.caps & DSCAPS_DOUBLE)
+          config.buffermode = DLBM_BACKVIDEO;
+     else if (surface->config.caps & DSCAPS_TRIPLE)
+          config.buffermode = DLBM_TRIPLE;
+     else
+          config.buffermode = DLBM_FRONTONLY;
+
+     /* Let the driver examine the configuration. */
+     ret = layer->funcs->TestRegion( layer, layer->driver_data, layer->layer_data, &config, &failed );
+     if (ret) {
+          D_DEBUG_AT( SaWMan_Overlay, "  -> rejected (failed 0x%08x)\n", failed );
+
+          sawwin->overlay_reject = overlay_signature( sawwin );
+
+          return ret;
+     }
+
+     /* Lock the context. */
+     if (dfb_layer_context_lock( overlay->context ))
+          return DFB_FUSION;
+
+     dfb_layer_region_lock( region );
+
+     if (D_FLAGS_IS_SET( region->state, CLRSF_ENABLED ))
+          dfb_layer_region_disable( region );
+
+     ret = dfb_layer_region_set_configuration( region, &config,
+                                               D_FLAGS_IS_SET( region->state, CLRSF_CONFIGURED ) ?
+                                               (CLRCF_WIDTH | CLRCF_HEIGHT | CLRCF_FORMAT | CLRCF_OPTIONS |
+                                                CLRCF_BUFFERMODE | CLRCF_SURFACE_CAPS | CLRCF_SURFACE |
+                                                CLRCF_DEST | CLRCF_SOURCE | CLRCF_FREEZE) : CLRCF_ALL );
+     if (ret) {
+          D_DERROR( ret, "SaWMan/Overlay: Configuration of layer region failed!\n" );
+     }
+     else {
+          /* Scan out the window surface itself. */
+          ret = dfb_layer_region_set_surface( region, surface, false );
+          if (ret)
+               D_DERROR( ret, "SaWMan/Overlay: Could not set window surface at layer region!\n" );
+          else
+               dfb_layer_region_enable( region );
+     }
+
+     dfb_layer_region_unlock( region );
+
+     /* Unlock the context. */
+     dfb_layer_context_unlock( overlay->context );
+
+     if (ret) {
+          sawwin->overlay_reject = overlay_signature( sawwin );
+          return ret;
+     }
+
+     sawwin->overlay = overlay;
+
+     overlay->window = sawwin;
+     overlay->tier   = tier;
+     overlay->src    = sawwin->src;
+     overlay->dst    = sawwin->dst;
+     overlay->format = surface->config.format;
+
+     /* Window is no longer drawn into the tier. */
+     tier->cache.count = 0;
+
+     return DFB_OK;
+}
+
+/*
+ * Returns the biggest window that can be promoted to the overlay.
+ */
+static SaWManWindow *
+overlay_candidate( SaWMan        *sawman,
+                   SaWManOverlay *overlay,
+                   SaWManTier   **ret_tier,
+                   DFBRectangle  *ret_dst )
+{
+     int           i;
+     int           best_size = 0;
+     SaWManWindow *best      = NULL;
+     SaWManWindow *sawwin;
+
+     fusion_vector_foreach_reverse (sawwin, i, sawman->layout) {
+          SaWManTier   *tier;
+          DFBRectangle  dst;
+
+          D_MAGIC_ASSERT( sawwin, SaWManWindow );
+
+          if (sawwin->overlay || sawwin->dst.w * sawwin->dst.h <= best_size)
+               continue;
+
+          if (overlay_eligible( sawman, overlay, sawwin, i, &tier, &dst )) {
+               best      = sawwin;
+               best_size = sawwin->dst.w * sawwin->dst.h;
+
+               *ret_tier = tier;
+               *ret_dst  = dst;
+          }
+     }
+
+     return best;
+}
+
+void
+sawman_overlays_process( SaWMan              *sawman,
+                         DFBSurfaceFlipFlags  flags )
+{
+     int i;
+
+     D_MAGIC_ASSERT( sawman, SaWMan );
+     FUSION_SKIRMISH_ASSERT( sawman->lock );
+
+     for (i=0; i<sawman->num_overlays; i++) {
+          SaWManOverlay *overlay = &sawman->overlays[i];
+          SaWManWindow  *sawwin  = overlay->window;
+          SaWManTier    *tier;
+          DFBRectangle   dst;
+
+          if (sawwin) {
+               D_MAGIC_ASSERT( sawwin, SaWManWindow );
+
+               if (!overlay_eligible( sawman, overlay, sawwin, sawman_window_index( sawman, sawwin ), &tier, &dst ) ||
+                   tier != overlay->tier ||
+                   !DFB_RECTANGLE_EQUAL( sawwin->src, overlay->src ) ||
+                   !DFB_RECTANGLE_EQUAL( sawwin->dst, overlay->dst ) ||
+                   sawwin->window->surface->config.format != overlay->format)
+               {
+                    overlay_demote( sawman, overlay );
+               }
+               else {
+                    if (overlay->dirty)
+                         overlay_update( sawman, overlay, flags );
+
+                    continue;
+               }
+          }
+
+          sawwin = overlay_candidate( sawman, overlay, &tier, &dst );
+          if (sawwin != overlay->candidate) {
+               overlay->candidate       = sawwin;
+               overlay->candidate_count = 0;
+
+               if (sawwin)
+                    overlay->candidate_flips = sawwin->window->surface->flips;
+          }
+
+          if (!sawwin)
+               continue;
+
+          /* Count the flips of the candidate, not the passes caused by other windows. */
+          if (sawwin->window->surface->flips != overlay->candidate_flips) {
+               overlay->candidate_flips = sawwin->window->surface->flips;
+               overlay->candidate_count++;
+          }
+
+          if (overlay->candidate_count < sawman_config->overlay_hysteresis)
+               continue;
+
+          overlay->candidate       = NULL;
+          overlay->candidate_count = 0;
+
+          if (overlay_promote( sawman, overlay, tier, sawwin, &dst ) == DFB_OK)
+               overlay_update( sawman, overlay, flags );
+     }
+}
+
+void
+sawman_overlay_demote( SaWMan       *sawman,
+                       SaWManWindow *sawwin )
+{
+     int i;
+
+     D_MAGIC_ASSERT( sawman, SaWMan );
+     D_MAGIC_ASSERT( sawwin, SaWManWindow );
+     FUSION_SKIRMISH_ASSERT( sawman->lock );
+
+     if (sawwin->overlay)
+          overlay_demote( sawman, sawwin->overlay );
+
+     for (i=0; i<sawman->num_overlays; i++) {
+          if (sawman->overlays[i].candidate == sawwin) {
+               sawman->overlays[i].candidate       = NULL;
+               sawman->overlays[i].candidate_count = 0;
+          }
+     }
+}
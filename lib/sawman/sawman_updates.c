@@ -32,6 +32,7 @@
 
 #include <config.h>
 
+#include <string.h>
 #include <unistd.h>
 
 #include <direct/debug.h>
@@ -61,6 +62,7 @@
 #include "sawman_updates.h"
 #include "sawman_config.h"
 #include "sawman_draw.h"
+#include "sawman_overlay.h"
 #include "sawman_window.h"
 
 #include "isawman.h"
@@ -73,6 +75,7 @@ D_DEBUG_DOMAIN( SaWMan_Update,   "SaWMan/Update",   "SaWMan window manager updat
 D_DEBUG_DOMAIN( SaWMan_FlipOnce, "SaWMan/FlipOnce", "SaWMan window manager flip once" );
 D_DEBUG_DOMAIN( SaWMan_Surface,  "SaWMan/Surface",  "SaWMan window manager surface" );
 D_DEBUG_DOMAIN( SaWMan_Focus,    "SaWMan/Focus",    "SaWMan window manager focus" );
+D_DEBUG_DOMAIN( SaWMan_Cache,    "SaWMan/Cache",    "SaWMan window manager compositing cache" );
 
 /**********************************************************************************************************************/
 
@@ -930,6 +933,74 @@ update_region3( SaWMan          *sawman,
      D_DEBUG_AT( SaWMan_Update, " -=> done <=-\n" );
 }
 
+/*
+ * Compositing cache
+ *
+ * Windows at the bottom of the layout which have not been updated for a number of repaints are
+ * composited once together with the background into an intermediate surface. Update mode 4 takes
+ * the base from there with a single blit instead of blending each of these windows again.
+ *
+ * Windows becoming static above the cached ones are composited on top of the cache. Any other change
+ * invalidates it, building it again from the background is deferred for the same number of repaints.
+ */
+
+static void
+cache_draw( SaWMan     *sawman,
+            SaWManTier *tier,
+            CardState  *state,
+            DFBRegion  *region )
+{
+     int          i;
+     DFBRectangle rect  = DFB_RECTANGLE_INIT_FROM_REGION( region );
+     DFBPoint     point = { region->x1, region->y1 };
+
+     D_DEBUG_AT( SaWMan_Cache, "%s( %p, %d,%d-%dx%d )\n", __FUNCTION__, tier, DFB_RECTANGLE_VALS( &rect ) );
+
+     D_ASSERT( tier->cache.surface != NULL );
+
+     /* Set blitting source. */
+     state->source    = tier->cache.surface;
+     state->from_eye  = DSSE_LEFT;
+     state->modified |= SMF_SOURCE | SMF_FROM;
+
+     dfb_state_set_blitting_flags( state, DSBLIT_NOFX );
+
+     CoreGraphicsStateClient_Blit( state->client, &rect, &point, 1 );
+
+     /* Reset blitting source. */
+     state->source    = NULL;
+     state->modified |= SMF_SOURCE;
+
+     tier->cache.hits++;
+
+     for (i=0; i<tier->cache.count; i++) {
+          SaWManWindow *sawwin = fusion_vector_at( &sawman->layout, i );
+          CoreWindow   *window = sawwin->window;
+          DFBRegion     inter  = DFB_REGION_INIT_FROM_RECTANGLE( &sawwin->bounds );
+
+          if (SAWMAN_VISIBLE_WINDOW( window ) && (tier->classes & (1 << window->config.stacking)) &&
+              dfb_region_region_intersect( &inter, region ))
+               tier->cache.saved += (inter.x2 - inter.x1 + 1) * (inter.y2 - inter.y1 + 1);
+     }
+}
+
+/* Background or cached windows below the ones being composited. */
+static void
+draw_base( SaWMan     *sawman,
+           SaWManTier *tier,
+           CardState  *state,
+           DFBRegion  *region )
+{
+     /* Extending the cache, the base is the destination itself. */
+     if (tier->cache.building && tier->cache.count)
+          return;
+
+     if (tier->cache.count)
+          cache_draw( sawman, tier, state, region );
+     else
+          sawman_draw_background( tier, state, region );
+}
+
 static void
 update_region4_r( SaWMan          *sawman,
                   SaWManTier      *tier,
@@ -951,8 +1022,8 @@ update_region4_r( SaWMan          *sawman,
      D_MAGIC_ASSERT( state, CardState );
      D_ASSERT( start < fusion_vector_size( &sawman->layout ) );
 
-     /* find next intersecting window */
-     while (i >= 0) {
+     /* find next intersecting window above the cached ones */
+     while (i >= tier->cache.count) {
           sawwin = fusion_vector_at( &sawman->layout, i );
           D_MAGIC_ASSERT( sawwin, SaWManWindow );
 
@@ -982,7 +1053,7 @@ update_region4_r( SaWMan          *sawman,
      }
 
      /* intersecting window found? */
-     if (i >= 0) {
+     if (i >= tier->cache.count) {
           D_MAGIC_ASSERT( sawwin, SaWManWindow );
           D_MAGIC_COREWINDOW_ASSERT( window );
 
@@ -1060,7 +1131,7 @@ update_region4_r( SaWMan          *sawman,
 
           /* recursion already ended */
           if (bin->size < 1) {
-               sawman_draw_background( tier, state, &bin->region );
+               draw_base( sawman, tier, state, &bin->region );
 
                free( bin );
           }
@@ -1072,13 +1143,14 @@ update_region4_r( SaWMan          *sawman,
                                            (window->surface->config.caps & DSCAPS_PREMULTIPLIED) &&
                                            (window->config.options & DWOP_ALPHACHANNEL) && !(window->config.options & DWOP_COLORKEYING) &&
                                            (window->config.dst_geometry.mode == DWGM_DEFAULT) && stack->bg.mode == DLBM_COLOR &&
-                                           !stack->bg.color.a && !stack->bg.color.r && !stack->bg.color.g && !stack->bg.color.b);
+                                           !stack->bg.color.a && !stack->bg.color.r && !stack->bg.color.g && !stack->bg.color.b &&
+                                           !tier->cache.count);
                D_ASSERT(bin->curr > 0);
                D_ASSERT(bin->size > 0);
 
                /* draw background behind translucient windows */
                if (bin->curr == bin->size && SAWMAN_TRANSLUCENT_WINDOW( window )) {
-                    sawman_draw_background( tier, state, &bin->region );
+                    draw_base( sawman, tier, state, &bin->region );
                }
 
                /* current window opaque or premultiplied with black background? */
@@ -1140,16 +1212,283 @@ update_region4( SaWMan          *sawman,
 
      D_DEBUG_AT( SaWMan_Update, "%s( %p, %d, %d,%d - %d,%d )\n", __FUNCTION__, tier, start, x1, y1, x2, y2 );
 
-     if (start < 0) {
+     if (start < tier->cache.count) {
           DFBRegion region = { x1, y1, x2, y2 };
 
-          sawman_draw_background( tier, state, &region);
+          draw_base( sawman, tier, state, &region );
      }
      else {
           update_region4_r( sawman, tier, state, start, right_eye, dfb_update_bin_get( NULL, NULL, x1, y1, x2, y2, start + 1) );
      }
 }
 
+static void
+cache_entry_init( SaWManCacheEntry *entry,
+                  SaWManWindow     *sawwin )
+{
+     CoreWindow *window = sawwin->window;
+
+     /* Cleared for comparing with memcmp(), including padding. */
+     memset( entry, 0, sizeof(SaWManCacheEntry) );
+
+     entry->sawwin    = sawwin;
+     entry->visible   = SAWMAN_VISIBLE_WINDOW( window );
+     entry->bounds    = sawwin->bounds;
+     entry->src       = sawwin->src;
+     entry->dst       = sawwin->dst;
+     entry->surface   = window->surface;
+     entry->flags     = window->flags;
+     entry->opacity   = window->config.opacity;
+     entry->options   = window->config.options;
+     entry->color     = window->config.color;
+     entry->color_key = window->config.color_key;
+     entry->opaque    = window->config.opaque;
+}
+
+/*
+ * Whether the background and the cached entries are still in the state they were composited with.
+ */
+static bool
+cache_valid( SaWMan     *sawman,
+             SaWManTier *tier )
+{
+     int              i;
+     CoreWindowStack *stack = tier->stack;
+
+     if (tier->cache.bg_mode        != stack->bg.mode ||
+         tier->cache.bg_color_index != stack->bg.color_index ||
+         tier->cache.bg_image       != stack->bg.image ||
+         !DFB_COLOR_EQUAL( tier->cache.bg_color, stack->bg.color ))
+          return false;
+
+     for (i=0; i<tier->cache.count; i++) {
+          SaWManCacheEntry entry;
+
+          cache_entry_init( &entry, fusion_vector_at( &sawman->layout, i ) );
+
+          if (memcmp( &entry, &tier->cache.entries[i], sizeof(SaWManCacheEntry) ))
+               return false;
+     }
+
+     return true;
+}
+
+/* Records the state of the entries from 'start' up to 'count'. */
+static DFBResult
+cache_store( SaWMan     *sawman,
+             SaWManTier *tier,
+             int         start,
+             int         count )
+{
+     int              i;
+     CoreWindowStack *stack = tier->stack;
+
+     if (count > tier->cache.max_entries) {
+          SaWManCacheEntry *entries = SHREALLOC( sawman->shmpool, tier->cache.entries,
+                                                 count * sizeof(SaWManCacheEntry) );
+
+          if (!entries)
+               return D_OOSHM();
+
+          tier->cache.entries     = entries;
+          tier->cache.max_entries = count;
+     }
+
+     for (i=start; i<count; i++)
+          cache_entry_init( &tier->cache.entries[i], fusion_vector_at( &sawman->layout, i ) );
+
+     tier->cache.bg_mode        = stack->bg.mode;
+     tier->cache.bg_color       = stack->bg.color;
+     tier->cache.bg_color_index = stack->bg.color_index;
+     tier->cache.bg_image       = stack->bg.image;
+
+     return DFB_OK;
+}
+
+/*
+ * Returns the number of layout entries up to the first window of the tier which has been updated
+ * recently, if at least two visible windows are below.
+ */
+static int
+cache_candidate( SaWMan     *sawman,
+                 SaWManTier *tier )
+{
+     int i;
+     int windows = 0;
+
+     for (i=0; i<fusion_vector_size( &sawman->layout ); i++) {
+          SaWManWindow *sawwin = fusion_vector_at( &sawman->layout, i );
+          CoreWindow   *window = sawwin->window;
+
+          if (!(tier->classes & (1 << window->config.stacking)))
+               continue;
+
+          if (tier->cache.frame - sawwin->changed < sawman_config->compositing_cache)
+               break;
+
+          if (SAWMAN_VISIBLE_WINDOW( window ))
+               windows++;
+     }
+
+     return (windows < 2) ? 0 : i;
+}
+
+/*
+ * Composites the entries up to 'count' into the cache, on top of the ones already cached.
+ */
+static DFBResult
+cache_build( SaWMan     *sawman,
+             SaWManTier *tier,
+             WMData     *wmdata,
+             int         count )
+{
+     DFBResult    ret;
+     CardState   *state   = &wmdata->state;
+     CoreSurface *surface = tier->region->surface;
+     DFBRegion    region  = { 0, 0, surface->config.size.w - 1, surface->config.size.h - 1 };
+
+     D_DEBUG_AT( SaWMan_Cache, "%s( %p, %d -> %d )\n", __FUNCTION__, tier, tier->cache.count, count );
+
+     D_ASSERT( count > tier->cache.count );
+
+     /* Also backs off after failures. */
+     if (!tier->cache.count)
+          tier->cache.built = tier->cache.frame;
+
+     ret = cache_store( sawman, tier, tier->cache.count, count );
+     if (ret) {
+          tier->cache.count = 0;
+          return ret;
+     }
+
+     if (!tier->cache.surface) {
+          D_ASSERT( tier->cache.count == 0 );
+
+          ret = dfb_surface_create_simple( wmdata->core, surface->config.size.w, surface->config.size.h,
+                                           surface->config.format, surface->config.colorspace,
+                                           DSCAPS_NONE, CSTF_SHARED, 0, NULL, &tier->cache.surface );
+          if (ret) {
+               D_DERROR( ret, "SaWMan/Cache: Failed creating %dx%d surface!\n",
+                         surface->config.size.w, surface->config.size.h );
+               return ret;
+          }
+
+          ret = dfb_surface_globalize( tier->cache.surface );
+          D_ASSERT( ret == DFB_OK );
+     }
+
+     /* Set destination. */
+     state->destination  = tier->cache.surface;
+     state->to_eye       = DSSE_LEFT;
+     state->modified    |= SMF_DESTINATION | SMF_TO;
+
+     dfb_state_set_clip( state, &region );
+
+     if (!tier->cache.count)
+          tier->cache.rebuilds++;
+
+     tier->cache.building = true;
+
+     update_region4( sawman, tier, state, count - 1, region.x1, region.y1, region.x2, region.y2, false );
+
+     tier->cache.building = false;
+     tier->cache.count    = count;
+
+     return DFB_OK;
+}
+
+/*
+ * Validates, extends or rebuilds the cache before composing the updates of the tier.
+ */
+static void
+cache_prepare( SaWMan     *sawman,
+               SaWManTier *tier,
+               WMData     *wmdata )
+{
+     int          count   = 0;
+     CoreSurface *surface = tier->region->surface;
+
+     D_MAGIC_ASSERT( sawman, SaWMan );
+     D_MAGIC_ASSERT( tier, SaWManTier );
+
+     /* Drop the surface if the layer has been reconfigured. */
+     if (tier->cache.surface &&
+         (tier->cache.surface->config.size.w != surface->config.size.w ||
+          tier->cache.surface->config.size.h != surface->config.size.h ||
+          tier->cache.surface->config.format  != surface->config.format))
+     {
+          tier->cache.count = 0;
+
+          dfb_surface_unlink( &tier->cache.surface );
+     }
+
+     if (sawman_config->compositing_cache && sawman_config->update_region_mode == 4 &&
+         !(tier->region->config.options & DLOP_STEREO) &&
+         !(tier->context->config.options & DLOP_SRC_COLORKEY) &&
+         !DFB_PIXELFORMAT_IS_INDEXED( surface->config.format ))
+     {
+          tier->cache.frame++;
+
+          count = cache_candidate( sawman, tier );
+     }
+
+     if (tier->cache.count) {
+          if (count >= tier->cache.count && cache_valid( sawman, tier )) {
+               /* More windows became static, composite them on top. */
+               if (count > tier->cache.count)
+                    cache_build( sawman, tier, wmdata, count );
+
+               return;
+          }
+
+          D_DEBUG_AT( SaWMan_Cache, "  -> invalidated %d entries (now %d)\n", tier->cache.count, count );
+
+          tier->cache.count = 0;
+     }
+
+     /* Hysteresis, building from the background again waits as long as windows need to be static. */
+     if (count && tier->cache.frame - tier->cache.built >= sawman_config->compositing_cache)
+          cache_build( sawman, tier, wmdata, count );
+}
+
+/*
+ * Whether the back buffer is brought up to date by repainting the damage of the frames it missed
+ * instead of copying back from the front buffer after each flip.
+ */
+bool
+sawman_tier_buffer_age( SaWManTier *tier )
+{
+     D_MAGIC_ASSERT( tier, SaWManTier );
+
+     if (dfb_config->task_manager || dfb_config->wm_fullscreen_updates)
+          return false;
+
+     if (tier->region->config.options & DLOP_STEREO)
+          return false;
+
+     return tier->region->config.buffermode == DLBM_BACKVIDEO ||
+            tier->region->config.buffermode == DLBM_TRIPLE;
+}
+
+static void
+add_back_damage( SaWManTier      *tier,
+                 const DFBRegion *full )
+{
+     u32 presents = tier->region->surface->presents;
+
+     /* Already repaired since the last flip? */
+     if (tier->damaged && tier->damaged == presents)
+          return;
+
+     if (dfb_layer_region_get_damage( tier->region, &tier->left.updates )) {
+          D_DEBUG_AT( SaWMan_Surface, "  -> back buffer content unknown, repainting all\n" );
+
+          dfb_updates_add( &tier->left.updates, full );
+     }
+
+     tier->damaged = presents;
+}
+
 void
 sawman_flush_updating( SaWMan     *sawman,
                        SaWManTier *tier,
@@ -1221,7 +1560,7 @@ sawman_flush_updating( SaWMan     *sawman,
           dfb_layer_region_flip_update( tier->region, &tier->left.updated.bounding, DSFLIP_ONSYNC | DSFLIP_SWAP );
 
 
-     if (left_num_regions) {
+     if (left_num_regions && !sawman_tier_buffer_age( tier )) {
           D_DEBUG_AT( SaWMan_Surface, "  -> copying %d updated regions (F->B)\n", left_num_regions );
 
           for (i=0; i<left_num_regions; i++) {
@@ -1291,6 +1630,9 @@ repaint_tier( SaWMan              *sawman,
 
      sawman_dispatch_tier_update( sawman, tier, right_eye, updates, num_updates );
 
+     if (!right_eye)
+          cache_prepare( sawman, tier, wmdata );
+
      for (i=0; i<num_updates; i++) {
           const DFBRegion *update = &updates[i];
 
@@ -1382,6 +1724,41 @@ repaint_tier( SaWMan              *sawman,
      CoreGraphicsStateClient_Flush( &wmdata->client, 0, CGSCFF_NONE );
 }
 
+/*
+ * Repaints the damage of the frames missed by the back buffer, before drawing into it directly.
+ */
+void
+sawman_repair_back_buffer( SaWMan     *sawman,
+                           SaWManTier *tier,
+                           WMData     *wmdata )
+{
+     DFBRegion  regions[CORE_LAYER_REGION_DAMAGE_HISTORY];
+     DFBUpdates damage;
+     DFBRegion  full     = { 0, 0, tier->size.w - 1, tier->size.h - 1 };
+     u32        presents = tier->region->surface->presents;
+
+     D_DEBUG_AT( SaWMan_Surface, "%s( %p, %p )\n", __FUNCTION__, sawman, tier );
+
+     D_MAGIC_ASSERT( sawman, SaWMan );
+     D_MAGIC_ASSERT( tier, SaWManTier );
+
+     if (tier->damaged && tier->damaged == presents)
+          return;
+
+     fusion_skirmish_prevail( &wmdata->update_skirmish );
+
+     dfb_updates_init( &damage, regions, D_ARRAY_SIZE(regions) );
+
+     if (dfb_layer_region_get_damage( tier->region, &damage ))
+          repaint_tier( sawman, tier, &full, 1, DSFLIP_NONE, false, wmdata );
+     else if (damage.num_regions)
+          repaint_tier( sawman, tier, damage.regions, damage.num_regions, DSFLIP_NONE, false, wmdata );
+
+     tier->damaged = presents;
+
+     fusion_skirmish_dismiss( &wmdata->update_skirmish );
+}
+
 static SaWManWindow *
 get_single_window( SaWMan     *sawman,
                    SaWManTier *tier,
@@ -1784,6 +2161,8 @@ process_single( SaWMan              *sawman,
                fusion_reactor_dispatch_channel( tier->reactor, SAWMAN_TIER_UPDATE, &update, sizeof(update), true, NULL );
           }
 
+          sawman_tier_stats_displayed( sawman, tier );
+
           return DFB_OK;
      }
 
@@ -1840,6 +2219,8 @@ process_single( SaWMan              *sawman,
           dfb_layer_region_flip_update( tier->region, NULL, flags );
      }
 
+     sawman_tier_stats_displayed( sawman, tier );
+
      dfb_updates_reset( &tier->left.updates );
      dfb_updates_reset( &tier->right.updates );
 
@@ -1971,10 +2352,20 @@ process_updates( SaWMan              *sawman,
      DFBRegion        full_tier_region = { 0, 0, tier->size.w - 1, tier->size.h - 1 };
      DFBRegion        left_united;
      DFBRegion        right_united;
+     DFBRegion        fresh;
+     bool             age;
 
      D_MAGIC_ASSERT( sawman, SaWMan );
      D_MAGIC_ASSERT( tier, SaWManTier );
 
+     age = sawman_tier_buffer_age( tier ) && tier->left.updates.num_regions > 0;
+     if (age) {
+          /* Flip with the new updates only, the damage of older frames is just repainted. */
+          fresh = tier->left.updates.bounding;
+
+          add_back_damage( tier, &full_tier_region );
+     }
+
      if (dfb_config->wm_fullscreen_updates) {
           if (tier->left.updates.num_regions > 0) {
                repaint_tier( sawman, tier, &full_tier_region, 1, flags, false, wmdata );
@@ -2044,6 +2435,14 @@ process_updates( SaWMan              *sawman,
 
      switch (tier->region->config.buffermode) {
           case DLBM_TRIPLE:
+               if (age) {
+                    dfb_updates_add( &tier->left.updating, &fresh );
+
+                    if (!tier->left.updated.num_regions)
+                         sawman_flush_updating( sawman, tier, wmdata );
+                    break;
+               }
+
                /* Add the updated region. */
                for (i=0; i<left_num; i++) {
                     const DFBRegion *update = &left_updates[i];
@@ -2091,9 +2490,9 @@ process_updates( SaWMan              *sawman,
                }
                else {
                     /* Flip the whole region. */
-                    dfb_layer_region_flip_update( tier->region, &left_united, flags | DSFLIP_WAITFORSYNC | DSFLIP_SWAP );
+                    dfb_layer_region_flip_update( tier->region, age ? &fresh : &left_united, flags | DSFLIP_WAITFORSYNC | DSFLIP_SWAP );
 
-                    if (!dfb_config->wm_fullscreen_updates) {
+                    if (!age && !dfb_config->wm_fullscreen_updates) {
                          /* Copy back the updated region. */
                          dfb_gfx_copy_regions_client( tier->region->surface, CSBR_FRONT, DSSE_LEFT, tier->region->surface, CSBR_BACK, DSSE_LEFT, left_updates, left_num, 0, 0, &wmdata->client );
                     }
@@ -2180,6 +2579,8 @@ process_updates( SaWMan              *sawman,
      }
 
 
+     sawman_tier_stats_displayed( sawman, tier );
+
      dfb_updates_reset( &tier->left.updates );
      dfb_updates_reset( &tier->right.updates );
 
@@ -2256,6 +2657,9 @@ sawman_process_updates( SaWMan              *sawman,
 
      fusion_skirmish_prevail( &wmdata->update_skirmish );
 
+     if (sawman->num_overlays)
+          sawman_overlays_process( sawman, flags );
+
      direct_list_foreach (tier, sawman->tiers) {
           bool          none = false;
           bool          border_only;
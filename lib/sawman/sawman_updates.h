@@ -49,6 +49,12 @@ void         sawman_flush_updating ( SaWMan                *sawman,
                                      SaWManTier            *tier,
                                      WMData                *wmdata );
 
+bool         sawman_tier_buffer_age( SaWManTier            *tier );
+
+void         sawman_repair_back_buffer( SaWMan             *sawman,
+                                        SaWManTier         *tier,
+                                        WMData             *wmdata );
+
 
 #ifdef __cplusplus
 }
@@ -34,6 +34,8 @@
 
 #include <unistd.h>
 
+#include <direct/atomic.h>
+#include <direct/clock.h>
 #include <direct/debug.h>
 #include <direct/list.h>
 
@@ -60,6 +62,7 @@
 
 #include "sawman_config.h"
 #include "sawman_draw.h"
+#include "sawman_overlay.h"
 #include "sawman_window.h"
 
 #include "isawman.h"
@@ -275,8 +278,17 @@ sawman_update_window( SaWMan              *sawman,
           return DFB_OK;
      }
 
+     /* Shown on its own layer, updated (or demoted) by the next sawman_process_updates(). */
+     if (sawwin->overlay) {
+          sawwin->overlay->dirty = true;
+          return DFB_OK;
+     }
+
      tier = sawman_tier_by_class( sawman, window->config.stacking );
      updates = update_flags & SWMUF_RIGHT_EYE ? &tier->right.updates : &tier->left.updates;
+
+     /* Keep the window out of the compositing cache for a while. */
+     sawwin->changed = tier->cache.frame;
      stereo_offset = window->config.z;       /* z is 0 for mono windows */
      if (update_flags & SWMUF_RIGHT_EYE)
           stereo_offset *= -1;
@@ -349,6 +361,112 @@ sawman_update_window( SaWMan              *sawman,
      return DFB_OK;
 }
 
+/*
+ * The statistics are updated with atomic operations only, callers may or may not hold the sawman lock.
+ */
+void
+sawman_window_stats_submitted( SaWMan       *sawman,
+                               SaWManWindow *sawwin )
+{
+     long long now = direct_clock_get_time( DIRECT_CLOCK_MONOTONIC );
+
+     D_MAGIC_ASSERT( sawman, SaWMan );
+     D_MAGIC_ASSERT( sawwin, SaWManWindow );
+
+     D_SYNC_ADD( &sawwin->stats.frames_submitted, 1 );
+
+     /* Previous frame not shown yet, the new one replaces it and the latency counts from the first. */
+     if (!D_SYNC_BOOL_COMPARE_AND_SWAP64( &sawwin->stats_stamp, 0LL, now ? now : 1 ))
+          D_SYNC_ADD( &sawwin->stats.frames_merged, 1 );
+}
+
+void
+sawman_window_stats_displayed( SaWMan       *sawman,
+                               SaWManWindow *sawwin )
+{
+     long long stamp;
+     long long latency;
+     long long max;
+
+     D_MAGIC_ASSERT( sawman, SaWMan );
+     D_MAGIC_ASSERT( sawwin, SaWManWindow );
+
+     stamp = D_SYNC_FETCH_AND_CLEAR64( &sawwin->stats_stamp );
+     if (!stamp)
+          return;
+
+     latency = direct_clock_get_time( DIRECT_CLOCK_MONOTONIC ) - stamp;
+
+     D_SYNC_ADD( &sawwin->stats.frames_displayed, 1 );
+
+     D_SYNC_ADD_AND_FETCH64( &sawwin->stats.latency_total, latency );
+
+     do {
+          max = sawwin->stats.latency_max;
+
+          if (max >= latency)
+               break;
+     } while (!D_SYNC_BOOL_COMPARE_AND_SWAP64( &sawwin->stats.latency_max, max, latency ));
+
+     if (sawman_config->window_histogram) {
+          int n = 0;
+
+          while (n < SAWMAN_WINDOW_STATS_BUCKETS - 1 && latency >= (1000LL << n))
+               n++;
+
+          D_SYNC_ADD( &sawwin->stats.histogram[n], 1 );
+     }
+}
+
+void
+sawman_window_stats_pixels( SaWManWindow *sawwin,
+                            unsigned int  pixels )
+{
+     D_MAGIC_ASSERT( sawwin, SaWManWindow );
+
+     D_SYNC_ADD_AND_FETCH64( &sawwin->stats.pixels, pixels );
+}
+
+/* 64 bit values are read atomically, 32 bit machines could see halves of two values otherwise. */
+void
+sawman_window_stats_get( SaWManWindow      *sawwin,
+                         SaWManWindowStats *ret_stats )
+{
+     int i;
+
+     D_MAGIC_ASSERT( sawwin, SaWManWindow );
+     D_ASSERT( ret_stats != NULL );
+
+     ret_stats->frames_submitted = D_SYNC_ADD_AND_FETCH( &sawwin->stats.frames_submitted, 0 );
+     ret_stats->frames_displayed = D_SYNC_ADD_AND_FETCH( &sawwin->stats.frames_displayed, 0 );
+     ret_stats->frames_merged    = D_SYNC_ADD_AND_FETCH( &sawwin->stats.frames_merged, 0 );
+     ret_stats->pixels           = D_SYNC_ADD_AND_FETCH64( &sawwin->stats.pixels, 0 );
+     ret_stats->latency_total    = D_SYNC_ADD_AND_FETCH64( &sawwin->stats.latency_total, 0 );
+     ret_stats->latency_max      = D_SYNC_ADD_AND_FETCH64( &sawwin->stats.latency_max, 0 );
+
+     for (i=0; i<SAWMAN_WINDOW_STATS_BUCKETS; i++)
+          ret_stats->histogram[i] = D_SYNC_ADD_AND_FETCH( &sawwin->stats.histogram[i], 0 );
+}
+
+void
+sawman_tier_stats_displayed( SaWMan     *sawman,
+                             SaWManTier *tier )
+{
+     int           i;
+     SaWManWindow *sawwin;
+
+     D_MAGIC_ASSERT( sawman, SaWMan );
+     D_MAGIC_ASSERT( tier, SaWManTier );
+     FUSION_SKIRMISH_ASSERT( sawman->lock );
+
+     fusion_vector_foreach (sawwin, i, sawman->layout) {
+          D_MAGIC_ASSERT( sawwin, SaWManWindow );
+
+          if (sawwin->stats_stamp && (tier->classes & (1 << sawwin->window->config.stacking)))
+               sawman_window_stats_displayed( sawman, sawwin );
+     }
+}
+
 DirectResult
 sawman_showing_window( SaWMan       *sawman,
                        SaWManWindow *sawwin,
@@ -735,6 +853,9 @@ sawman_withdraw_window( SaWMan       *sawman,
           }
      }
 
+     /* Composite it again for hiding. */
+     sawman_overlay_demote( sawman, sawwin );
+
      /* Hide window. */
      if (SAWMAN_VISIBLE_WINDOW(window) && (sawwin->flags & SWMWF_INSERTED)) {
           window->config.opacity = 0;
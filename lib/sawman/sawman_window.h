@@ -55,6 +55,21 @@ DirectResult  sawman_update_window             ( SaWMan                *sawman,
                                                  DFBSurfaceFlipFlags    flags,
                                                  SaWManUpdateFlags      update_flags );
 
+void          sawman_window_stats_submitted    ( SaWMan                *sawman,
+                                                 SaWManWindow          *sawwin );
+
+void          sawman_window_stats_displayed    ( SaWMan                *sawman,
+                                                 SaWManWindow          *sawwin );
+
+void          sawman_window_stats_pixels       ( SaWManWindow          *sawwin,
+                                                 unsigned int           pixels );
+
+void          sawman_window_stats_get          ( SaWManWindow          *sawwin,
+                                                 SaWManWindowStats     *ret_stats );
+
+void          sawman_tier_stats_displayed      ( SaWMan                *sawman,
+                                                 SaWManTier            *tier );
+
 DirectResult  sawman_showing_window            ( SaWMan                *sawman,
                                                  SaWManWindow          *sawwin,
                                                  bool                  *ret_showing );
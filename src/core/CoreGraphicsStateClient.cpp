@@ -60,6 +60,7 @@ extern "C" {
 #include <core/Renderer.h>
 #include <core/Task.h>
 #include <core/TaskManager.h>
+#include <core/Util.h>
 
 D_DEBUG_DOMAIN( Core_GraphicsStateClient,          "Core/GfxState/Client",          "DirectFB Core Graphics State Client" );
 D_DEBUG_DOMAIN( Core_GraphicsStateClient_Flush,    "Core/GfxState/Client/Flush",    "DirectFB Core Graphics State Client Flush" );
@@ -955,6 +956,59 @@ CoreGraphicsStateClient_FillRectangles( CoreGraphicsStateClient *client,
      return DFB_OK;
 }
 
+DFBResult
+CoreGraphicsStateClient_FillCoverageSpans( CoreGraphicsStateClient *client,
+                                           const CoreCoverageSpan  *spans,
+                                           unsigned int             num )
+{
+     D_DEBUG_AT( Core_GraphicsStateClient, "%s( client %p )\n", __FUNCTION__, client );
+
+     D_MAGIC_ASSERT( client, CoreGraphicsStateClient );
+     D_ASSERT( spans != NULL );
+
+     if (client->renderer)
+          client->renderer->FillCoverageSpans( spans, num );
+     else {
+          if (!dfb_config->call_nodirect && (dfb_core_is_master( client->core ) || !fusion_config->secure_fusion)) {
+               dfb_gfxcard_fill_coverage_spans( spans, num, client->state );
+          }
+          else {
+               DFBResult    ret;
+               unsigned int i, n = 0;
+
+               if (!num)
+                    return DFB_OK;
+
+               DirectFB::Util::TempArray<DFBRectangle> rects( num );
+
+               /* No coverage in remote calls, sending solid spans instead */
+               for (i=0; i<num; i++) {
+                    if (spans[i].coverage >= 0x80) {
+                         rects.array[n].x = spans[i].x;
+                         rects.array[n].y = spans[i].y;
+                         rects.array[n].w = spans[i].w;
+                         rects.array[n].h = 1;
+
+                         n++;
+                    }
+               }
+
+               if (!n)
+                    return DFB_OK;
+
+               CoreGraphicsStateClient_Update( client, DFXL_FILLRECTANGLE, client->state );
+
+               DirectFB::IGraphicsState_Requestor *requestor = (DirectFB::IGraphicsState_Requestor*) client->requestor;
+
+               ret = requestor->FillRectangles( rects.array, n );
+               if (ret)
+                    return ret;
+          }
+     }
+
+     return DFB_OK;
+}
+
 DFBResult
 CoreGraphicsStateClient_FillTriangles( CoreGraphicsStateClient *client,
                                        const DFBTriangle       *triangles,
@@ -1091,6 +1145,28 @@ CoreGraphicsStateClient_Blit( CoreGraphicsStateClient *client,
      return DFB_OK;
 }
 
+DFBResult
+CoreGraphicsStateClient_DrawGlyphs( CoreGraphicsStateClient *client,
+                                    const DFBRectangle      *rects,
+                                    const DFBPoint          *points,
+                                    unsigned int             num )
+{
+     D_DEBUG_AT( Core_GraphicsStateClient, "%s( client %p )\n", __FUNCTION__, client );
+
+     D_MAGIC_ASSERT( client, CoreGraphicsStateClient );
+     D_ASSERT( rects != NULL );
+     D_ASSERT( points != NULL );
+
+     if (client->renderer) {
+          client->renderer->DrawGlyphs( rects, points, num );
+
+          return DFB_OK;
+     }
+
+     /* dfb_gfxcard_batchblit() detects glyphs itself, remote calls are sent as plain blits */
+     return CoreGraphicsStateClient_Blit( client, rects, points, num );
+}
+
 DFBResult
 CoreGraphicsStateClient_Blit2( CoreGraphicsStateClient *client,
                                const DFBRectangle      *rects,
@@ -110,6 +110,13 @@ DFBResult CoreGraphicsStateClient_FillRectangles  ( CoreGraphicsStateClient *cli
                                                     const DFBRectangle      *rects,
                                                     unsigned int             num );
 
+/*
+ * Anti-aliased spans in device coordinates, see dfb_gfxcard_fill_coverage_spans()
+ */
+DFBResult CoreGraphicsStateClient_FillCoverageSpans( CoreGraphicsStateClient *client,
+                                                     const CoreCoverageSpan  *spans,
+                                                     unsigned int             num );
+
 DFBResult CoreGraphicsStateClient_FillTriangles   ( CoreGraphicsStateClient *client,
                                                     const DFBTriangle       *triangles,
                                                     unsigned int             num );
@@ -128,6 +135,14 @@ DFBResult CoreGraphicsStateClient_Blit            ( CoreGraphicsStateClient *cli
                                                     const DFBPoint          *points,
                                                     unsigned int             num );
 
+/*
+ * Like CoreGraphicsStateClient_Blit() for A8 glyphs, letting the renderer process the whole run at once.
+ */
+DFBResult CoreGraphicsStateClient_DrawGlyphs      ( CoreGraphicsStateClient *client,
+                                                    const DFBRectangle      *rects,
+                                                    const DFBPoint          *points,
+                                                    unsigned int             num );
+
 DFBResult CoreGraphicsStateClient_Blit2           ( CoreGraphicsStateClient *client,
                                                     const DFBRectangle      *rects,
                                                     const DFBPoint          *points1,
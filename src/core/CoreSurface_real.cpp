@@ -882,6 +882,8 @@ ISurface_Real::Flip2(
                       dfb_gfx_copy_regions_client( obj, CSBR_BACK, DSSE_RIGHT,
                                                    obj, CSBR_FRONT, DSSE_RIGHT,
                                                    &r, 1, 0, 0, NULL );
+
+                  dfb_surface_mark_presented( obj );
               }
          }
          else {
@@ -899,6 +901,8 @@ ISurface_Real::Flip2(
                   dfb_gfx_copy_regions_client( obj, CSBR_BACK, DSSE_LEFT,
                                                obj, CSBR_FRONT, DSSE_LEFT,
                                                &l, 1, 0, 0, NULL );
+
+                  dfb_surface_mark_presented( obj );
              }
          }
      }
@@ -1037,5 +1041,32 @@ out:
 }
 
 
+DFBResult
+ISurface_Real::GetBufferAge(
+                    CoreSurfaceBufferRole                      role,
+                    DFBSurfaceStereoEye                        eye,
+                    u32                                       *ret_age
+                    )
+{
+     D_DEBUG_AT( DirectFB_CoreSurface, "ISurface_Real::%s( role %u, eye %u )\n", __FUNCTION__, role, eye );
+
+     D_ASSERT( ret_age != NULL );
+
+     if (role > CSBR_IDLE || (eye != DSSE_LEFT && eye != DSSE_RIGHT))
+          return DFB_INVARG;
+
+     if (eye == DSSE_RIGHT && !(obj->config.caps & DSCAPS_STEREO))
+          return DFB_INVARG;
+
+     dfb_surface_lock( obj );
+
+     *ret_age = dfb_surface_get_buffer_age( obj, role, eye );
+
+     dfb_surface_unlock( obj );
+
+     return DFB_OK;
+}
+
+
 }
 
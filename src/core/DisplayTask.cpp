@@ -44,6 +44,7 @@ extern "C" {
 
 #include <direct/debug.h>
 #include <direct/messages.h>
+#include <direct/timeline.h>
 
 #include <fusion/conf.h>
 
@@ -330,6 +331,7 @@ DisplayTask::Run()
      const DisplayLayerFuncs *funcs;
      CoreSurfaceBufferLock    left  = {0};
      CoreSurfaceBufferLock    right = {0};
+     long long                start = direct_timeline_now();
 
      D_DEBUG_AT( DirectFB_Task_Display, "DisplayTask::%s( %p [%s], region %p )\n", __FUNCTION__,
                  this, *ToString<DirectFB::Task>(*this), region );
@@ -518,6 +520,8 @@ out:
           }
      }
 
+     direct_timeline_complete( "display", "Flip", index, start );
+
      dfb_surface_unref( surface );
 
      Release();
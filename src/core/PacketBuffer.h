@@ -58,6 +58,8 @@ extern "C" {
 #include <string>
 #include <vector>
 
+#include <direct/Mutex.h>
+
 
 namespace DirectFB {
 
@@ -89,6 +91,148 @@ public:
 };
 
 
+/*
+ * Keeps released blocks for reuse by the next PacketBuffer, e.g. the command
+ * buffers of consecutive tasks, instead of going through the heap each time.
+ *
+ * The pool exists between Init() and Shutdown(), called via Task::InitPool()
+ * and Task::ShutdownPool(). Without it blocks come from and go to the heap.
+ */
+template<typename Buffer>
+class BufferPool {
+public:
+     static BufferPool *Get()
+     {
+          return instance;
+     }
+
+     static void
+     Init()
+     {
+          D_ASSERT( instance == NULL );
+
+          instance = new BufferPool();
+     }
+
+     static void
+     Shutdown()
+     {
+          BufferPool *pool = instance;
+
+          instance = NULL;
+
+          delete pool;
+     }
+
+     static Buffer *
+     Take( size_t size )
+     {
+          BufferPool *pool = instance;
+
+          return pool ? pool->take( size ) : new Buffer( size );
+     }
+
+     static void
+     Put( Buffer *buffer )
+     {
+          BufferPool *pool = instance;
+
+          if (pool)
+               pool->put( buffer );
+          else
+               delete buffer;
+     }
+
+     unsigned int           allocated;     // blocks allocated from the heap, only counted with debug support
+     unsigned int           reused;        // blocks taken from the pool, only counted with debug support
+
+private:
+     BufferPool( size_t max_buffers = 16 )
+          :
+          allocated( 0 ),
+          reused( 0 ),
+          max_buffers( max_buffers )
+     {
+     }
+
+     ~BufferPool()
+     {
+          flush();
+     }
+
+     Buffer *
+     take( size_t size )
+     {
+          Buffer *buffer = NULL;
+
+          lock.lock();
+
+          if (!buffers.empty() && buffers.back()->size == size) {
+               buffer = buffers.back();
+
+               buffers.pop_back();
+          }
+
+          lock.unlock();
+
+          if (buffer) {
+               buffer->length = 0;
+
+#if D_DEBUG_ENABLED
+               D_SYNC_ADD( &reused, 1 );
+#endif
+          }
+          else {
+               buffer = new Buffer( size );
+
+#if D_DEBUG_ENABLED
+               D_SYNC_ADD( &allocated, 1 );
+#endif
+          }
+
+          return buffer;
+     }
+
+     void
+     put( Buffer *buffer )
+     {
+          lock.lock();
+
+          if (buffers.size() < max_buffers) {
+               buffers.push_back( buffer );
+               buffer = NULL;
+          }
+
+          lock.unlock();
+
+          if (buffer)
+               delete buffer;
+     }
+
+     void
+     flush()
+     {
+          lock.lock();
+
+          for (typename std::vector<Buffer*>::const_iterator it = buffers.begin(); it != buffers.end(); ++it)
+               delete *it;
+
+          buffers.clear();
+
+          lock.unlock();
+     }
+
+     static BufferPool     *instance;
+
+     size_t                 max_buffers;
+     Direct::Mutex          lock;
+     std::vector<Buffer*>   buffers;
+};
+
+template<typename Buffer>
+BufferPool<Buffer> *BufferPool<Buffer>::instance;
+
+
 template<typename Buffer=HeapBuffer>
 class PacketBuffer {
 public:
@@ -140,8 +284,12 @@ PacketBuffer<Buffer>::~PacketBuffer()
 {
      D_DEBUG_AT( DirectFB_Util_PacketBuffer, "PacketBuffer::%s()\n", __FUNCTION__ );
 
-     for (typename buffer_vector::const_iterator it = buffers.begin(); it != buffers.end(); ++it)
-          delete *it;
+     for (typename buffer_vector::const_iterator it = buffers.begin(); it != buffers.end(); ++it) {
+          if ((*it)->size == block_size)
+               BufferPool<Buffer>::Put( *it );
+          else
+               delete *it;
+     }
 }
 
 template<typename Buffer>
@@ -174,7 +322,7 @@ PacketBuffer<Buffer>::GetBuffer( size_t space )
 
      D_DEBUG_AT( DirectFB_Util_PacketBuffer, "  -> allocating %zu bytes\n", space );
 
-     Buffer *buffer = new Buffer( space );
+     Buffer *buffer = (space == block_size) ? BufferPool<Buffer>::Take( space ) : new Buffer( space );
 
      buffers.push_back( buffer );
 
@@ -41,6 +41,7 @@ extern "C" {
 
 #include <direct/debug.h>
 #include <direct/messages.h>
+#include <direct/timeline.h>
 
 #include <core/core.h>
 #include <core/graphics_state.h>
@@ -166,6 +167,18 @@ public:
           return num_rects;
      }
 
+     virtual unsigned long long pixels() const {
+          unsigned long long pixels = 0;
+
+          if (accel != DFXL_DRAWRECTANGLE)
+               return dfb_gfxstats_rects_pixels( rects, num_rects, NULL );
+
+          for (unsigned int i=0; i<num_rects; i++)
+               pixels += 2 * (rects[i].w + rects[i].h);
+
+          return pixels;
+     }
+
      virtual Base *tesselate( DFBAccelerationMask  accel,
                               const DFBRegion     *clip,
                               const s32           *matrix );
@@ -191,7 +204,8 @@ public:
           Base( accel, clipped, del ),
           rects( (DFBRectangle*) rects ),
           points( (DFBPoint*) points ),
-          num_rects( num_rects )
+          num_rects( num_rects ),
+          glyphs( false )
      {
      }
 
@@ -206,6 +220,10 @@ public:
           return num_rects;
      }
 
+     virtual unsigned long long pixels() const {
+          return dfb_gfxstats_rects_pixels( rects, num_rects, NULL );
+     }
+
      virtual Base *tesselate( DFBAccelerationMask  accel,
                               const DFBRegion     *clip,
                               const s32           *matrix );
@@ -216,6 +234,7 @@ public:
      DFBRectangle *rects;
      DFBPoint     *points;
      unsigned int  num_rects;
+     bool          glyphs;   /* blits of A8 glyphs, rendered via Engine::DrawGlyphs() */
 };
 
 
@@ -247,6 +266,10 @@ public:
           return num_rects;
      }
 
+     virtual unsigned long long pixels() const {
+          return dfb_gfxstats_rects_pixels( drects, num_rects, NULL );
+     }
+
      virtual Base *tesselate( DFBAccelerationMask  accel,
                               const DFBRegion     *clip,
                               const s32           *matrix );
@@ -298,6 +321,15 @@ public:
           return num_rects;
      }
 
+     virtual unsigned long long pixels() const {
+          unsigned long long pixels = 0;
+
+          for (unsigned int i=0; i<num_rects; i++)
+               pixels += (unsigned long long) ABS(points2[i].x - points1[i].x) * ABS(points2[i].y - points1[i].y);
+
+          return pixels;
+     }
+
      virtual Base *tesselate( DFBAccelerationMask  accel,
                               const DFBRegion     *clip,
                               const s32           *matrix );
@@ -343,6 +375,10 @@ public:
           return num_rects;
      }
 
+     virtual unsigned long long pixels() const {
+          return dfb_gfxstats_rects_pixels( rects, num_rects, NULL );
+     }
+
      virtual Base *tesselate( DFBAccelerationMask  accel,
                               const DFBRegion     *clip,
                               const s32           *matrix );
@@ -381,6 +417,10 @@ public:
           return num_lines;
      }
 
+     virtual unsigned long long pixels() const {
+          return dfb_gfxstats_lines_pixels( lines, num_lines );
+     }
+
      virtual Base *tesselate( DFBAccelerationMask  accel,
                               const DFBRegion     *clip,
                               const s32           *matrix );
@@ -419,6 +459,10 @@ public:
           return num_spans;
      }
 
+     virtual unsigned long long pixels() const {
+          return dfb_gfxstats_spans_pixels( spans, num_spans );
+     }
+
      virtual Base *tesselate( DFBAccelerationMask  accel,
                               const DFBRegion     *clip,
                               const s32           *matrix );
@@ -433,6 +477,54 @@ public:
 
 
 
+/*
+ * Spans in device coordinates, tesselated to solid rectangles where coverage is at least 0x80
+ */
+class CoverageSpans : public Base {
+public:
+     CoverageSpans( const CoreCoverageSpan *spans,
+                    unsigned int            num_spans,
+                    DFBAccelerationMask     accel,
+                    bool                    clipped = false,
+                    bool                    del = false )
+          :
+          Base( accel, clipped, del ),
+          spans( (CoreCoverageSpan*) spans ),
+          num_spans( num_spans )
+     {
+     }
+
+     virtual ~CoverageSpans() {
+          if (del)
+               delete spans;
+     }
+
+     virtual unsigned int count() const {
+          return num_spans;
+     }
+
+     virtual unsigned long long pixels() const {
+          unsigned long long pixels = 0;
+
+          for (unsigned int i=0; i<num_spans; i++)
+               pixels += spans[i].w;
+
+          return pixels;
+     }
+
+     virtual Base *tesselate( DFBAccelerationMask  accel,
+                              const DFBRegion     *clip,
+                              const s32           *matrix );
+
+     virtual void render( Renderer::Setup *setup,
+                          Engine          *engine );
+
+     CoreCoverageSpan *spans;
+     unsigned int      num_spans;
+};
+
+
+
 class Trapezoids : public Base {
 public:
      Trapezoids( const DFBTrapezoid  *traps,
@@ -456,6 +548,10 @@ public:
           return num_traps;
      }
 
+     virtual unsigned long long pixels() const {
+          return dfb_gfxstats_trapezoids_pixels( traps, num_traps );
+     }
+
      virtual Base *tesselate( DFBAccelerationMask  accel,
                               const DFBRegion     *clip,
                               const s32           *matrix );
@@ -492,6 +588,10 @@ public:
           return num_tris;
      }
 
+     virtual unsigned long long pixels() const {
+          return dfb_gfxstats_triangles_pixels( tris, num_tris );
+     }
+
      virtual Base *tesselate( DFBAccelerationMask  accel,
                               const DFBRegion     *clip,
                               const s32           *matrix );
@@ -929,7 +1029,11 @@ Blits::tesselate( DFBAccelerationMask  accel,
                                    newpoints[i] = p1;
                               }
 
-                              return new Blits( newrects, newpoints, num_rects, DFXL_BLIT, clipped, true );
+                              Blits *blits = new Blits( newrects, newpoints, num_rects, DFXL_BLIT, clipped, true );
+
+                              blits->glyphs = glyphs;
+
+                              return blits;
                          }
                          break;
 
@@ -1028,7 +1132,10 @@ Blits::render( Renderer::Setup *setup,
                continue;
 
           if (engine->caps.clipping & DFXL_BLIT) {
-               engine->Blit( setup->tasks[i], rects, points, num_rects );
+               if (glyphs)
+                    engine->DrawGlyphs( setup->tasks[i], rects, points, num_rects );
+               else
+                    engine->Blit( setup->tasks[i], rects, points, num_rects );
           }
           else {
                Util::TempArray<DFBRectangle> copied_rects( num_rects );
@@ -1050,8 +1157,12 @@ Blits::render( Renderer::Setup *setup,
                     }
                }
 
-               if (copied_num)
-                    engine->Blit( setup->tasks[i], copied_rects.array, copied_points.array, copied_num );
+               if (copied_num) {
+                    if (glyphs)
+                         engine->DrawGlyphs( setup->tasks[i], copied_rects.array, copied_points.array, copied_num );
+                    else
+                         engine->Blit( setup->tasks[i], copied_rects.array, copied_points.array, copied_num );
+               }
           }
      }
 }
@@ -1609,6 +1720,78 @@ Spans::render( Renderer::Setup *setup,
 }
 
 
+Base *
+CoverageSpans::tesselate( DFBAccelerationMask  accel,
+                          const DFBRegion     *clip,
+                          const s32           *matrix )
+{
+     switch (accel) {
+          case DFXL_FILLRECTANGLE:
+               {
+                    DFBRectangle *rects = new DFBRectangle[num_spans];
+                    unsigned int  num   = 0;
+
+                    for (unsigned int i=0; i<num_spans; i++) {
+                         if (spans[i].coverage < 0x80)
+                              continue;
+
+                         rects[num].x = spans[i].x;
+                         rects[num].y = spans[i].y;
+                         rects[num].w = spans[i].w;
+                         rects[num].h = 1;
+
+                         num++;
+                    }
+
+                    return new Rectangles( rects, num, DFXL_FILLRECTANGLE, clipped, true );
+               }
+               break;
+
+          default:
+               D_UNIMPLEMENTED();
+     }
+
+     return NULL;
+}
+
+void
+CoverageSpans::render( Renderer::Setup *setup,
+                       Engine          *engine )
+{
+     /// loop
+     for (unsigned int i=0; i<setup->tiles_render; i++) {
+          if (!(setup->task_mask & (1 << i)))
+               continue;
+
+          if (engine->caps.clipping & DFXL_FILLRECTANGLE) {
+               engine->FillCoverageSpans( setup->tasks[i], spans, num_spans );
+          }
+          else {
+               Util::TempArray<CoreCoverageSpan> copied_spans( num_spans );
+               unsigned int                      copied_num = 0;
+               const DFBRegion                  *tile_clip  = &setup->clips_clipped[i];
+
+               for (unsigned int n=0; n<num_spans; n++) {
+                    int x1 = MAX( spans[n].x, tile_clip->x1 );
+                    int x2 = MIN( spans[n].x + spans[n].w - 1, tile_clip->x2 );
+
+                    if (spans[n].y < tile_clip->y1 || spans[n].y > tile_clip->y2 || x1 > x2)
+                         continue;
+
+                    copied_spans.array[copied_num]   = spans[n];
+                    copied_spans.array[copied_num].x = x1;
+                    copied_spans.array[copied_num].w = x2 - x1 + 1;
+
+                    copied_num++;
+               }
+
+               if (copied_num)
+                    engine->FillCoverageSpans( setup->tasks[i], copied_spans.array, copied_num );
+          }
+     }
+}
+
+
 typedef struct {
    int xi;
    int xf;
@@ -2550,6 +2733,7 @@ void
 Renderer::render( Primitives::Base *primitives )
 {
      DFBResult ret;
+     long long start = dfb_gfxstats_start();
 
      D_DEBUG_AT( DirectFB_Renderer, "Renderer::%s( %p, %p )\n", __FUNCTION__, this, primitives );
 
@@ -2721,9 +2905,16 @@ Renderer::render( Primitives::Base *primitives )
      ret = update( accel );
      if (ret)
           unbindEngine( 0, CGSCFF_NONE, true );
-     else
+     else {
           tesselated->render( setup, engine );
 
+          /* Account the requested function, time is spent on preparing the tasks only. */
+          if (dfb_gfxstats)
+               dfb_gfxstats_count( primitives->accel, engine->caps.software ? CGSE_SOFTWARE : CGSE_HARDWARE,
+                                   engine->caps.software ? state->fallback : CGFR_NONE,
+                                   primitives->count(), primitives->pixels(), start );
+     }
+
 out:
      if (tesselated != primitives)
           delete tesselated;
@@ -2809,6 +3000,17 @@ Renderer::FillSpans( int            y,
      render( &primitives );
 }
 
+void
+Renderer::FillCoverageSpans( const CoreCoverageSpan *spans,
+                             unsigned int            num_spans )
+{
+     D_DEBUG_AT( DirectFB_Renderer, "Renderer::%s( %p, %p [%d] )\n", __FUNCTION__, this, spans, num_spans );
+
+     Primitives::CoverageSpans primitives( spans, num_spans, DFXL_FILLRECTANGLE );
+
+     render( &primitives );
+}
+
 void
 Renderer::Blit( const DFBRectangle     *rects,
                 const DFBPoint         *points,
@@ -2821,6 +3023,20 @@ Renderer::Blit( const DFBRectangle     *rects,
      render( &primitives );
 }
 
+void
+Renderer::DrawGlyphs( const DFBRectangle     *rects,
+                      const DFBPoint         *points,
+                      u32                     num )
+{
+     D_DEBUG_AT( DirectFB_Renderer, "Renderer::%s( %p, %p %p [%d] )\n", __FUNCTION__, this, rects, points, num );
+
+     Primitives::Blits primitives( rects, points, num, DFXL_BLIT );
+
+     primitives.glyphs = true;
+
+     render( &primitives );
+}
+
 void
 Renderer::Blit2( const DFBRectangle     *rects,
                  const DFBPoint         *points1,
@@ -2976,6 +3192,9 @@ Renderer::getEngine( DFBAccelerationMask  accel,
 
      CHECK_MAGIC();
 
+     /* Reason for using a software engine, see core/gfxstats.h */
+     CoreGfxStatsFallback fallback = CGFR_NO_DRIVER;
+
      if (engine && (transform & engine->caps.transforms) == transform) {
           /* If the function needs to be checked... */
           if (!(state->checked & accel)) {
@@ -3001,6 +3220,7 @@ Renderer::getEngine( DFBAccelerationMask  accel,
 
           if (dfb_config->software_only && !engine->caps.software) {
                D_DEBUG_AT( DirectFB_Renderer, "  -> skipping engine (no-hardware)!\n" );
+               fallback = CGFR_DISABLED;
                continue;
           }
 
@@ -3009,11 +3229,20 @@ Renderer::getEngine( DFBAccelerationMask  accel,
                continue;
           }
 
-          if ((transform & engine->caps.transforms) == transform &&
-              engine->CheckState( state, accel ) == DFB_OK)
-          {
+          if ((transform & engine->caps.transforms) != transform) {
+               if (!engine->caps.software)
+                    fallback = CGFR_RENDER_OPTIONS;
+               continue;
+          }
+
+          if (engine->CheckState( state, accel ) == DFB_OK) {
+               state->fallback = engine->caps.software ? fallback : CGFR_NONE;
+
                return engine;
           }
+
+          if (!engine->caps.software)
+               fallback = CGFR_CHECKSTATE;
      }
 
      return NULL;
@@ -3117,6 +3346,8 @@ Renderer::flushTask( u32                               cookie,
                      CoreGraphicsStateClientFlushFlags flags,
                      bool                              discard )
 {
+     long long start = direct_timeline_now();
+
      D_DEBUG_AT( DirectFB_Renderer, "Renderer::%s( %p )\n", __FUNCTION__, this );
 
      CHECK_MAGIC();
@@ -3147,6 +3378,8 @@ Renderer::flushTask( u32                               cookie,
           setup->tasks[0]->Flush();
      }
 
+     direct_timeline_complete( "renderer", discard ? "Discard" : "Flush", operations, start );
+
      engine     = NULL;
      operations = 0;
 
@@ -3250,6 +3483,35 @@ Engine::FillSpans( SurfaceTask   *task,
      return DFB_UNIMPLEMENTED;
 }
 
+DFBResult
+Engine::FillCoverageSpans( SurfaceTask            *task,
+                           const CoreCoverageSpan *spans,
+                           unsigned int           &num_spans )
+{
+     D_DEBUG_AT( DirectFB_Renderer, "Engine::%s()\n", __FUNCTION__ );
+
+     Util::TempArray<DFBRectangle> rects( num_spans );
+     unsigned int                  num = 0;
+
+     /* Engines without coverage support get solid spans */
+     for (unsigned int i=0; i<num_spans; i++) {
+          if (spans[i].coverage < 0x80)
+               continue;
+
+          rects.array[num].x = spans[i].x;
+          rects.array[num].y = spans[i].y;
+          rects.array[num].w = spans[i].w;
+          rects.array[num].h = 1;
+
+          num++;
+     }
+
+     if (!num)
+          return DFB_OK;
+
+     return FillRectangles( task, rects.array, num );
+}
+
 DFBResult
 Engine::FillQuadrangles( SurfaceTask    *task,
                          const DFBPoint *points,
@@ -3271,6 +3533,17 @@ Engine::Blit( SurfaceTask        *task,
      return DFB_UNIMPLEMENTED;
 }
 
+DFBResult
+Engine::DrawGlyphs( SurfaceTask        *task,
+                    const DFBRectangle *rects,
+                    const DFBPoint     *points,
+                    u32                &num )
+{
+     D_DEBUG_AT( DirectFB_Renderer, "Engine::%s()\n", __FUNCTION__ );
+
+     return Blit( task, rects, points, num );
+}
+
 DFBResult
 Engine::Blit2( SurfaceTask        *task,
                const DFBRectangle *rects,
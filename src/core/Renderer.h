@@ -292,11 +292,20 @@ public:
                             const DFBSpan          *spans,
                             unsigned int            num_spans );
 
+     /* Anti-aliased spans in device coordinates, see dfb_gfxcard_fill_coverage_spans() */
+     void FillCoverageSpans( const CoreCoverageSpan *spans,
+                             unsigned int            num_spans );
+
 
      void Blit            ( const DFBRectangle     *rects,
                             const DFBPoint         *points,
                             u32                     num );
 
+     /* Blits of A8 glyphs from the font cache, same as Blit() with engines not implementing DrawGlyphs() */
+     void DrawGlyphs      ( const DFBRectangle     *rects,
+                            const DFBPoint         *points,
+                            u32                     num );
+
      void Blit2           ( const DFBRectangle     *rects,
                             const DFBPoint         *points1,
                             const DFBPoint         *points2,
@@ -410,6 +419,11 @@ public:
 
      virtual unsigned int count() const = 0;
 
+     /* Destination pixels for statistics, may be an estimate or zero if unknown. */
+     virtual unsigned long long pixels() const {
+          return 0;
+     }
+
      virtual void render( Renderer::Setup *setup,
                           Engine          *engine ) = 0;
 };
@@ -499,6 +513,10 @@ public:
                                          const DFBSpan          *spans,
                                          unsigned int           &num_spans );
 
+     virtual DFBResult FillCoverageSpans( SurfaceTask            *task,
+                                          const CoreCoverageSpan *spans,
+                                          unsigned int           &num_spans );
+
      virtual DFBResult FillQuadrangles ( SurfaceTask            *task,
                                          const DFBPoint         *points,
                                          unsigned int           &num_quads );
@@ -510,6 +528,11 @@ public:
                                          const DFBPoint         *points,
                                          u32                    &num );
 
+     virtual DFBResult DrawGlyphs      ( SurfaceTask            *task,
+                                         const DFBRectangle     *rects,
+                                         const DFBPoint         *points,
+                                         u32                    &num );
+
      virtual DFBResult Blit2           ( SurfaceTask            *task,
                                          const DFBRectangle     *rects,
                                          const DFBPoint         *points1,
@@ -41,8 +41,11 @@
 
 
 extern "C" {
+#include <string.h>
+
 #include <direct/debug.h>
 #include <direct/messages.h>
+#include <direct/timeline.h>
 
 #include <fusion/conf.h>
 
@@ -55,6 +58,7 @@ extern "C" {
 #include <direct/Lists.h>
 
 #include <core/Debug.h>
+#include <core/PacketBuffer.h>
 #include <core/Task.h>
 #include <core/TaskManager.h>
 #include <core/Util.h>
@@ -234,6 +238,348 @@ SimpleTask_Create( SimpleTaskFunc  *push,
 
 /*********************************************************************************************************************/
 
+/*
+ * Task allocation
+ *
+ * Tasks are created by the rendering threads but deleted in the TaskManager thread. Deleted objects are collected
+ * per size class in a thread local list and handed over in batches to a shared list, which an allocating thread
+ * takes over as a whole. Most tasks are thus allocated and freed without locking and without calling malloc().
+ *
+ * Objects of a size class are always allocated with the full class size, so any of them can serve any allocation
+ * of that class, no matter whether the pool existed when it was allocated. The shared lists only exist between
+ * Task::InitPool() and Task::ShutdownPool(), called by the TaskManager, before and after that objects are handed
+ * back to the heap directly.
+ */
+
+D_DEBUG_DOMAIN( DirectFB_TaskPool, "DirectFB/Task/Pool", "DirectFB Task Pool" );
+
+#define TASK_POOL_GRANULARITY  64
+#define TASK_POOL_CLASSES      16        // objects up to 1024 bytes
+#define TASK_POOL_BATCH        32        // freed objects handed over at once
+#define TASK_POOL_MAX_SHARED   1024      // objects per size class on the shared list
+
+#define TASK_POOL_STATS        D_DEBUG_ENABLED     // global counters, shared by all threads
+
+#if TASK_POOL_STATS
+#define TASK_POOL_COUNT(pool,counter,n)   D_SYNC_ADD( &(pool)->counter, n )
+#else
+#define TASK_POOL_COUNT(pool,counter,n)   do {} while (0)
+#endif
+
+class TaskPool
+{
+private:
+     struct Node {
+          Node         *next;
+     };
+
+     struct Cache {
+          Node         *free[TASK_POOL_CLASSES];
+          Node         *freed[TASK_POOL_CLASSES];
+          unsigned int  freed_count[TASK_POOL_CLASSES];
+     };
+
+     static TaskPool     *instance;
+     static DirectTLS     tls;
+     static bool          tls_registered;
+
+     Direct::Mutex  lock;
+     Node          *shared[TASK_POOL_CLASSES];
+     unsigned int   shared_count[TASK_POOL_CLASSES];
+
+public:
+     unsigned int   allocations;     // total number of allocations
+     unsigned int   reused;          // allocations served from a free list
+     unsigned int   recycled;        // objects put on the shared list
+     unsigned int   released;        // objects given back to the heap
+
+     static TaskPool *Get()
+     {
+          return instance;
+     }
+
+     static void Init()
+     {
+          D_DEBUG_AT( DirectFB_TaskPool, "TaskPool::%s()\n", __FUNCTION__ );
+
+          D_ASSERT( instance == NULL );
+
+          /* The thread caches may outlive a pool, e.g. when the core is initialized again. */
+          if (!tls_registered) {
+               direct_tls_register( &tls, TaskPool::destroyCache );
+
+               tls_registered = true;
+          }
+
+          instance = new TaskPool();
+     }
+
+     static void Shutdown()
+     {
+          D_DEBUG_AT( DirectFB_TaskPool, "TaskPool::%s()\n", __FUNCTION__ );
+
+          TaskPool *pool = instance;
+
+          instance = NULL;
+
+          if (pool) {
+               pool->Flush();
+
+               delete pool;
+          }
+     }
+
+     static void *Allocate( size_t size )
+     {
+          unsigned int  cls  = (size - 1) / TASK_POOL_GRANULARITY;
+          TaskPool     *pool = instance;
+          Cache        *cache;
+          Node         *node;
+
+          if (pool)
+               TASK_POOL_COUNT( pool, allocations, 1 );
+
+          if (cls >= TASK_POOL_CLASSES)
+               return allocate( size );
+
+          cache = getCache();
+          if (!cache)
+               return allocate( (cls + 1) * TASK_POOL_GRANULARITY );
+
+          node = cache->free[cls];
+          if (!node) {
+               if (!pool)
+                    return allocate( (cls + 1) * TASK_POOL_GRANULARITY );
+
+               pool->lock.lock();
+
+               node                    = pool->shared[cls];
+               pool->shared[cls]       = NULL;
+               pool->shared_count[cls] = 0;
+
+               pool->lock.unlock();
+
+               if (!node)
+                    return allocate( (cls + 1) * TASK_POOL_GRANULARITY );
+          }
+
+          cache->free[cls] = node->next;
+
+          if (pool)
+               TASK_POOL_COUNT( pool, reused, 1 );
+
+          return node;
+     }
+
+     static void Free( void   *ptr,
+                       size_t  size )
+     {
+          unsigned int  cls = (size - 1) / TASK_POOL_GRANULARITY;
+          Cache        *cache;
+          Node         *node = (Node*) ptr;
+
+          if (cls >= TASK_POOL_CLASSES || !(cache = getCache())) {
+               node->next = NULL;
+
+               release( instance, node, 1 );
+               return;
+          }
+
+          node->next        = cache->freed[cls];
+          cache->freed[cls] = node;
+
+          if (++cache->freed_count[cls] == TASK_POOL_BATCH)
+               handOver( instance, cache, cls );
+     }
+
+     void Flush()
+     {
+          D_DEBUG_AT( DirectFB_TaskPool, "TaskPool::%s()\n", __FUNCTION__ );
+
+          lock.lock();
+
+          for (unsigned int i=0; i<TASK_POOL_CLASSES; i++) {
+               release( this, shared[i], shared_count[i] );
+
+               shared[i]       = NULL;
+               shared_count[i] = 0;
+          }
+
+          lock.unlock();
+     }
+
+private:
+     TaskPool()
+          :
+          allocations( 0 ),
+          reused( 0 ),
+          recycled( 0 ),
+          released( 0 )
+     {
+          memset( shared, 0, sizeof(shared) );
+          memset( shared_count, 0, sizeof(shared_count) );
+     }
+
+     static void *allocate( size_t size )
+     {
+          void *ptr = direct_malloc( size );
+
+          D_ASSERT( ptr != NULL );
+
+          return ptr;
+     }
+
+     static void release( TaskPool     *pool,
+                          Node         *node,
+                          unsigned int  count )
+     {
+          while (node) {
+               Node *next = node->next;
+
+               direct_free( node );
+
+               node = next;
+          }
+
+          if (pool)
+               TASK_POOL_COUNT( pool, released, count );
+     }
+
+     static Cache *getCache()
+     {
+          Cache *cache;
+
+          if (!tls_registered)
+               return NULL;
+
+          cache = (Cache*) direct_tls_get( tls );
+          if (!cache) {
+               cache = (Cache*) direct_calloc( 1, sizeof(Cache) );
+               if (cache)
+                    direct_tls_set( tls, cache );
+          }
+
+          return cache;
+     }
+
+     /* Moves the thread's freed objects of one size class to the shared list, or to the heap without a pool. */
+     static void handOver( TaskPool     *pool,
+                           Cache        *cache,
+                           unsigned int  cls )
+     {
+          Node         *node  = cache->freed[cls];
+          unsigned int  count = cache->freed_count[cls];
+
+          cache->freed[cls]       = NULL;
+          cache->freed_count[cls] = 0;
+
+          if (!node)
+               return;
+
+          if (!pool) {
+               release( NULL, node, count );
+               return;
+          }
+
+          pool->lock.lock();
+
+          if (pool->shared_count[cls] < TASK_POOL_MAX_SHARED) {
+               Node *last = node;
+
+               while (last->next)
+                    last = last->next;
+
+               last->next               = pool->shared[cls];
+               pool->shared[cls]        = node;
+               pool->shared_count[cls] += count;
+
+               pool->lock.unlock();
+
+               TASK_POOL_COUNT( pool, recycled, count );
+          }
+          else {
+               pool->lock.unlock();
+
+               release( pool, node, count );
+          }
+     }
+
+     static void destroyCache( void *ptr )
+     {
+          TaskPool *pool  = instance;
+          Cache    *cache = (Cache*) ptr;
+
+          for (unsigned int i=0; i<TASK_POOL_CLASSES; i++) {
+               unsigned int  count = 0;
+               Node         *node;
+
+               handOver( pool, cache, i );
+
+               for (node = cache->free[i]; node; node = node->next)
+                    count++;
+
+               release( pool, cache->free[i], count );
+          }
+
+          direct_free( cache );
+     }
+};
+
+TaskPool  *TaskPool::instance;
+DirectTLS  TaskPool::tls;
+bool       TaskPool::tls_registered;
+
+void *
+Task::operator new( size_t size )
+{
+     return TaskPool::Allocate( size );
+}
+
+void
+Task::operator delete( void   *ptr,
+                       size_t  size )
+{
+     TaskPool::Free( ptr, size );
+}
+
+void
+Task::InitPool()
+{
+     TaskPool::Init();
+
+     Util::BufferPool<Util::HeapBuffer>::Init();
+}
+
+void
+Task::ShutdownPool()
+{
+     Util::BufferPool<Util::HeapBuffer>::Shutdown();
+
+     TaskPool::Shutdown();
+}
+
+void
+Task::DumpPool()
+{
+#if TASK_POOL_STATS
+     TaskPool                           *pool    = TaskPool::Get();
+     Util::BufferPool<Util::HeapBuffer> *buffers = Util::BufferPool<Util::HeapBuffer>::Get();
+
+     if (pool)
+          direct_log_printf( NULL, "Task pool: %u allocations, %u from free lists (%u%%), %u recycled, %u released\n",
+                             pool->allocations, pool->reused,
+                             pool->allocations ? (unsigned int)(pool->reused * 100ULL / pool->allocations) : 0,
+                             pool->recycled, pool->released );
+
+     if (buffers)
+          direct_log_printf( NULL, "Command buffers: %u allocated, %u reused\n", buffers->allocated, buffers->reused );
+#else
+     direct_log_printf( NULL, "Task pool: statistics are only available with debug support\n" );
+#endif
+}
+
+/*********************************************************************************************************************/
+
 Task::Task()
      :
      magic( D_MAGIC("Task") ),
@@ -411,6 +757,11 @@ Task::Flush()
      ts_flushed = direct_clock_get_time( DIRECT_CLOCK_MONOTONIC );
 #endif
 
+     if (D_TIMELINE_ENABLED()) {
+          direct_timeline_async_begin( "task", TypeName().buffer(), (unsigned long) this );
+          direct_timeline_async_begin( "task", "flushed", (unsigned long) this );
+     }
+
      TaskManager::pushTask( this );
 }
 
@@ -454,6 +805,11 @@ Task::emit()
                D_BREAK( "Push() error" );
      }
 
+     if (D_TIMELINE_ENABLED()) {
+          direct_timeline_async_end( "task", "ready", (unsigned long) this );
+          direct_timeline_async_begin( "task", "running", (unsigned long) this );
+     }
+
      if (flags & TASK_FLAG_NEED_SLAVE_PUSH) {
           Task *slave = next_slave;
 
@@ -474,6 +830,10 @@ Task::emit()
                          break;
 
                     case DFB_OK:
+                         if (D_TIMELINE_ENABLED()) {
+                              direct_timeline_async_begin( "task", slave->TypeName().buffer(), (unsigned long) slave );
+                              direct_timeline_async_begin( "task", "running", (unsigned long) slave );
+                         }
                          break;
 
                     default:
@@ -581,6 +941,11 @@ Task::Done( DFBResult ret )
      ts_done = direct_clock_get_time( DIRECT_CLOCK_MONOTONIC );
 #endif
 
+     if (D_TIMELINE_ENABLED()) {
+          direct_timeline_async_end( "task", "running", (unsigned long) this );
+          direct_timeline_async_end( "task", TypeName().buffer(), (unsigned long) this );
+     }
+
      if (ret)
           enableDump();
 
@@ -607,6 +972,11 @@ Task::Setup()
      ts_ready = direct_clock_get_time( DIRECT_CLOCK_MONOTONIC );
 #endif
 
+     if (D_TIMELINE_ENABLED()) {
+          direct_timeline_async_end( "task", "flushed", (unsigned long) this );
+          direct_timeline_async_begin( "task", "ready", (unsigned long) this );
+     }
+
      return DFB_OK;
 }
 
@@ -751,7 +1121,7 @@ Task::notifyAll( TaskState state )
 
      DFB_TASK_LOG( Direct::String::F( "notifyAll(%zu, %s)", notifies.size(), *ToString<TaskState>(state) ) );
 
-     for (std::vector<TaskNotify>::iterator it = notifies.begin(); it != notifies.end(); ) {
+     for (TaskNotifies::iterator it = notifies.begin(); it != notifies.end(); ) {
           if ((*it).second & state) {
                DFB_TASK_LOG( Direct::String::F( "  notifying %p", (*it).first ) );
 
@@ -925,7 +1295,7 @@ Task::DumpTree( int indent, int max )
      else {
           direct_log_printf( NULL, ".%*s%s\n", indent, "", *Description() );
 
-          for (std::vector<TaskNotify>::iterator it = notifies.begin(); it != notifies.end(); it++) {
+          for (TaskNotifies::iterator it = notifies.begin(); it != notifies.end(); it++) {
                Task *task = (*it).first;
 
                task->DumpTree( indent + 4, max );
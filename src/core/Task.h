@@ -216,6 +216,7 @@ class TaskThreads;
 class DisplayTask;
 
 typedef std::pair<Task*,TaskState> TaskNotify;
+typedef Util::SmallVector<TaskNotify,4> TaskNotifies;
 
 
 class Task
@@ -274,7 +275,7 @@ private:
      unsigned int             refs;
 
      /* building dependency tree */
-     std::vector<TaskNotify>  notifies;      // FIXME: Use Direct::Vector
+     TaskNotifies             notifies;
      unsigned int             block_count;
 
 protected:
@@ -333,6 +334,15 @@ public:
      Direct::String &Description();
      void AddFlags( TaskFlags flags );
 
+     /* allocation from per thread free lists, see Task.cpp */
+     static void *operator new   ( size_t  size );
+     static void  operator delete( void   *ptr,
+                                   size_t  size );
+
+     static void  InitPool();
+     static void  ShutdownPool();
+     static void  DumpPool();
+
 private:
      static const Direct::String _Type;
 };
@@ -41,6 +41,7 @@
 extern "C" {
 #include <directfb_util.h>
 
+#include <direct/conf.h>
 #include <direct/debug.h>
 #include <direct/messages.h>
 
@@ -55,6 +56,7 @@ extern "C" {
 #include <direct/Lists.h>
 
 #include <core/Debug.h>
+#include <core/PacketBuffer.h>
 #include <core/TaskManager.h>
 #include <core/Util.h>
 
@@ -125,6 +127,8 @@ TaskManager::Initialise()
      direct_recursive_mutex_init( &tasks_lock );
 #endif
 
+     Task::InitPool();
+
      if (dfb_config->task_manager) {
           running = true;
 
@@ -159,6 +163,11 @@ TaskManager::Shutdown()
           threads = NULL;
      }
 
+     if (direct_config_get_int_value( "task-pool-stats" ))
+          Task::DumpPool();
+
+     Task::ShutdownPool();
+
 #if DFB_TASK_DEBUG_TASKS
      direct_mutex_deinit( &tasks_lock );
 #endif
@@ -419,7 +428,7 @@ TaskManager::dumpTasks()
 
           direct_log_printf( NULL, "%s\n", task->Description().buffer() );
 
-          for (std::vector<TaskNotify>::const_iterator it = task->notifies.begin(); it != task->notifies.end(); it++)
+          for (TaskNotifies::const_iterator it = task->notifies.begin(); it != task->notifies.end(); it++)
                direct_log_printf( NULL, "   ->  %p\n", (*it).first );
 
           task->DumpLog( DirectFB_Task, DIRECT_LOG_VERBOSE );
@@ -108,6 +108,100 @@ public:
 };
 
 
+/*
+ * Vector keeping the first N elements inline, allocating only when growing beyond.
+ * Erasing keeps the order of the remaining elements.
+ */
+template <typename T, size_t N>
+class SmallVector
+{
+public:
+     typedef T       *iterator;
+     typedef const T *const_iterator;
+
+     SmallVector()
+          :
+          array( fixed ),
+          count( 0 ),
+          capacity( N )
+     {
+     }
+
+     ~SmallVector()
+     {
+          if (array != fixed)
+               delete[] array;
+     }
+
+     inline size_t size() const {
+          return count;
+     }
+
+     inline bool empty() const {
+          return count == 0;
+     }
+
+     inline iterator begin() {
+          return array;
+     }
+
+     inline iterator end() {
+          return array + count;
+     }
+
+     inline const_iterator begin() const {
+          return array;
+     }
+
+     inline const_iterator end() const {
+          return array + count;
+     }
+
+     void push_back( const T &value )
+     {
+          if (count == capacity) {
+               T *grown = new T[capacity * 2];
+
+               for (size_t i=0; i<count; i++)
+                    grown[i] = array[i];
+
+               if (array != fixed)
+                    delete[] array;
+
+               array     = grown;
+               capacity *= 2;
+          }
+
+          array[count++] = value;
+     }
+
+     iterator erase( iterator it )
+     {
+          D_ASSERT( it >= begin() && it < end() );
+
+          for (iterator next = it + 1; next != end(); next++)
+               *(next - 1) = *next;
+
+          count--;
+
+          return it;
+     }
+
+     inline void clear() {
+          count = 0;
+     }
+
+private:
+     T       fixed[N];
+     T      *array;
+     size_t  count;
+     size_t  capacity;
+
+     SmallVector( const SmallVector & );
+     SmallVector &operator = ( const SmallVector & );
+};
+
+
 class FPS : public Direct::Magic<FPS>
 {
 private:
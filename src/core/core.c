@@ -57,7 +57,9 @@
 #include <core/core.h>
 #include <core/core_parts.h>
 #include <core/fonts.h>
+#include <core/gfxcard.h>
 #include <core/graphics_state.h>
+#include <core/input.h>
 #include <core/layer_context.h>
 #include <core/layer_region.h>
 #include <core/palette.h>
@@ -76,14 +78,17 @@
 #include <gfx/util.h>
 
 #include <direct/build.h>
+#include <direct/conf.h>
 #include <direct/debug.h>
 #include <direct/direct.h>
 #include <direct/interface.h>
 #include <direct/mem.h>
 #include <direct/memcpy.h>
 #include <direct/messages.h>
+#include <direct/modules.h>
 #include <direct/perf.h>
 #include <direct/signals.h>
+#include <direct/startup.h>
 #include <direct/thread.h>
 #include <direct/util.h>
 
@@ -91,6 +96,7 @@
 #include <fusion/hash.h>
 
 #include <misc/conf.h>
+#include <misc/gfx_util.h>
 #include <misc/util.h>
 
 #if defined(DFB_DYNAMIC_LINKING) && defined(SOPATH)
@@ -104,6 +110,7 @@ D_DEBUG_DOMAIN( DirectFB_Core, "DirectFB/Core", "DirectFB Core" );
 extern CorePart dfb_clipboard_core;
 extern CorePart dfb_colorhash_core;
 extern CorePart dfb_graphics_core;
+extern CorePart dfb_imagecache_core;
 extern CorePart dfb_input_core;
 extern CorePart dfb_layer_core;
 extern CorePart dfb_screen_core;
@@ -114,6 +121,7 @@ extern CorePart dfb_wm_core;
 static CorePart *core_parts[] = {
      &dfb_clipboard_core,
      &dfb_colorhash_core,
+     &dfb_imagecache_core,
      &dfb_surface_core,
      &dfb_system_core,
      &dfb_input_core,
@@ -137,6 +145,9 @@ dfb_core_get_part( CoreDFB        *core,
           case DFCP_GRAPHICS:
                return dfb_graphics_core.data_local;
 
+          case DFCP_IMAGECACHE:
+               return dfb_imagecache_core.data_local;
+
           case DFCP_INPUT:
                return dfb_input_core.data_local;
 
@@ -187,6 +198,11 @@ static void dfb_core_thread_init_handler( DirectThread *thread, void *arg );
 
 static void dfb_core_process_cleanups( CoreDFB *core, bool emergency );
 
+/*
+ * loads the interface types given by 'interface-preload' in the background
+ */
+static void dfb_core_preload_interfaces( void );
+
 static DirectSignalHandlerResult dfb_core_signal_handler( int   num,
                                                           void *addr,
                                                           void *ctx );
@@ -240,8 +256,9 @@ dfb_core_create( CoreDFB **ret_core )
 #if FUSION_BUILD_MULTI
      char     buf[16];
 #endif
-     CoreDFB       *core   = NULL;
-     CoreDFBShared *shared = NULL;
+     CoreDFB           *core   = NULL;
+     CoreDFBShared     *shared = NULL;
+     DirectStartupSpan  span;
 
      (void)shared;
 
@@ -285,7 +302,12 @@ dfb_core_create( CoreDFB **ret_core )
 #endif
 #endif
 
+     direct_startup_begin( &span );
+
      ret = dfb_system_lookup();
+
+     direct_startup_end( &span, "core", "system lookup" );
+
      if (ret)
           goto error;
 
@@ -326,7 +348,12 @@ dfb_core_create( CoreDFB **ret_core )
 
      core_dfb = core;
 
+     direct_startup_begin( &span );
+
      ret = fusion_enter( dfb_config->session, DIRECTFB_CORE_ABI, FER_ANY, &core->world );
+
+     direct_startup_end( &span, "core", "fusion enter" );
+
      if (ret)
           goto error;
 
@@ -351,10 +378,33 @@ dfb_core_create( CoreDFB **ret_core )
      fusion_call_init( &core_dfb->async_call, Core_AsyncCall_Handler, core, core_dfb->world );
      fusion_call_set_name( &core_dfb->async_call, "Core_AsyncCall" );
 
-     if (dfb_core_is_master( core_dfb ))
+     dfb_core_preload_interfaces();
+
+     direct_startup_begin( &span );
+
+     if (dfb_core_is_master( core_dfb )) {
+          /*
+           * All drivers get probed by the master. Those known by the manifest are not loaded
+           * by exploring, so load them in the background while the system is initialized.
+           */
+          if (dfb_system_caps() & CSCAPS_ACCELERATION) {
+               direct_modules_explore_directory( &dfb_graphics_drivers );
+               direct_modules_preload( &dfb_graphics_drivers );
+          }
+
+          direct_modules_explore_directory( &dfb_input_modules );
+          direct_modules_preload( &dfb_input_modules );
+
           ret = dfb_core_arena_initialize( core_dfb );
+
+          direct_modules_preload_wait( &dfb_input_modules );
+          direct_modules_preload_wait( &dfb_graphics_drivers );
+     }
      else
           ret = dfb_core_arena_join( core_dfb );
+
+     direct_startup_end( &span, "core", dfb_core_is_master( core_dfb ) ? "arena initialize" : "arena join" );
+
      if (ret)
           goto error;
 
@@ -400,6 +450,10 @@ error:
 
      pthread_mutex_unlock( &core_dfb_lock );
 
+     DirectPreloadInterfacesWait();
+
+     dfb_gfx_shutdown_bands();
+
      direct_shutdown();
 
      return ret;
@@ -485,9 +539,14 @@ dfb_core_destroy( CoreDFB *core, bool emergency )
      D_FREE( core );
      core_dfb = NULL;
 
-     if (!emergency)
+     if (!emergency) {
           pthread_mutex_unlock( &core_dfb_lock );
 
+          DirectPreloadInterfacesWait();
+
+          dfb_gfx_shutdown_bands();
+     }
+
      direct_shutdown();
 
      return ret;
@@ -1646,6 +1705,19 @@ dfb_core_thread_init_handler( DirectThread *thread, void *arg )
      dfb_system_thread_init();
 }
 
+static void
+dfb_core_preload_interfaces( void )
+{
+     char *types[16];
+     int   i, num;
+
+     if (direct_config_get( "interface-preload", types, D_ARRAY_SIZE(types), &num ))
+          return;
+
+     for (i=0; i<num; i++)
+          DirectPreloadInterfaces( types[i] );
+}
+
 static void
 dfb_core_process_cleanups( CoreDFB *core, bool emergency )
 {
@@ -1786,6 +1858,7 @@ dfb_core_shutdown( CoreDFB *core, bool emergency )
      dfb_core_part_shutdown( core, &dfb_surface_core, emergency );
      dfb_core_part_shutdown( core, &dfb_input_core, emergency );
      dfb_core_part_shutdown( core, &dfb_system_core, emergency );
+     dfb_core_part_shutdown( core, &dfb_imagecache_core, emergency );
      dfb_core_part_shutdown( core, &dfb_colorhash_core, emergency );
      dfb_core_part_shutdown( core, &dfb_clipboard_core, emergency );
 
@@ -54,6 +54,7 @@ typedef enum {
      DFCP_CLIPBOARD,
      DFCP_COLORHASH,
      DFCP_GRAPHICS,
+     DFCP_IMAGECACHE,
      DFCP_INPUT,
      DFCP_LAYER,
      DFCP_SCREEN,
@@ -392,6 +393,8 @@ typedef struct {
      int          calling;
 
      void        *call_buffer;
+
+     int          gfx_worker;     /* see dfb_gfx_worker_begin() */
 } CoreTLS;
 
 CoreTLS *Core_GetTLS( void );
@@ -44,6 +44,7 @@
 
 #include <direct/mem.h>
 #include <direct/messages.h>
+#include <direct/startup.h>
 
 
 D_DEBUG_DOMAIN( Core_Parts, "Core/Parts", "DirectFB Core Parts" );
@@ -57,6 +58,7 @@ dfb_core_part_initialize( CoreDFB  *core,
      void                *local  = NULL;
      void                *shared = NULL;
      FusionSHMPoolShared *pool;
+     DirectStartupSpan    span;
 
      pool = dfb_core_shmpool( core );
 
@@ -67,6 +69,8 @@ dfb_core_part_initialize( CoreDFB  *core,
 
      D_DEBUG_AT( Core_Parts, "Going to initialize '%s' core...\n", core_part->name );
 
+     direct_startup_begin( &span );
+
      if (core_part->size_local)
           local = D_CALLOC( 1, core_part->size_local );
 
@@ -74,6 +78,9 @@ dfb_core_part_initialize( CoreDFB  *core,
           shared = SHCALLOC( pool, 1, core_part->size_shared );
 
      ret = core_part->Initialize( core, local, shared );
+
+     direct_startup_end( &span, "core", "%s", core_part->name );
+
      if (ret) {
           D_ERROR( "DirectFB/Core: Could not initialize '%s' core!\n"
                     "    --> %s\n", core_part->name,
@@ -102,9 +109,10 @@ DFBResult
 dfb_core_part_join( CoreDFB  *core,
                     CorePart *core_part )
 {
-     DFBResult  ret;
-     void      *local  = NULL;
-     void      *shared = NULL;
+     DFBResult          ret;
+     void              *local  = NULL;
+     void              *shared = NULL;
+     DirectStartupSpan  span;
 
      if (core_part->initialized) {
           D_BUG( "%s already joined", core_part->name );
@@ -113,6 +121,8 @@ dfb_core_part_join( CoreDFB  *core,
 
      D_DEBUG_AT( Core_Parts, "Going to join '%s' core...\n", core_part->name );
 
+     direct_startup_begin( &span );
+
      if (core_part->size_shared &&
          core_arena_get_shared_field( core, core_part->name, &shared ))
           return DFB_FUSION;
@@ -121,6 +131,9 @@ dfb_core_part_join( CoreDFB  *core,
           local = D_CALLOC( 1, core_part->size_local );
 
      ret = core_part->Join( core, local, shared );
+
+     direct_startup_end( &span, "core", "%s (join)", core_part->name );
+
      if (ret) {
           D_ERROR( "DirectFB/Core: Could not join '%s' core!\n"
                     "    --> %s\n", core_part->name,
@@ -42,6 +42,7 @@ typedef struct __DFB_CoreDFBShared           CoreDFBShared;
 typedef struct __DFB_DFBClipboardCore        DFBClipboardCore;
 typedef struct __DFB_DFBColorHashCore        DFBColorHashCore;
 typedef struct __DFB_DFBGraphicsCore         DFBGraphicsCore;
+typedef struct __DFB_DFBImageCacheCore       DFBImageCacheCore;
 typedef struct __DFB_DFBInputCore            DFBInputCore;
 typedef struct __DFB_DFBLayerCore            DFBLayerCore;
 typedef struct __DFB_DFBScreenCore           DFBScreenCore;
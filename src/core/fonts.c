@@ -51,6 +51,7 @@
 #include <direct/hash.h>
 #include <direct/map.h>
 #include <direct/mem.h>
+#include <direct/memcpy.h>
 #include <direct/messages.h>
 #include <direct/utf8.h>
 #include <direct/util.h>
@@ -75,6 +76,9 @@ static bool free_glyphs( DirectHash    *hash,
                          void          *value,
                          void          *ctx );
 
+static void glyph_runs_invalidate( CoreFont    *font,
+                                   CoreSurface *surface );
+
 /**********************************************************************************************************************/
 
 struct __DFB_DFBFontManager {
@@ -650,6 +654,7 @@ DFBResult
 dfb_font_cache_row_deinit( DFBFontCacheRow *row )
 {
      CoreGlyphData *glyph, *next;
+     CoreFont      *last = NULL;
 
      DFB_FONT_CACHE_ROW_ASSERT( row );
 
@@ -660,6 +665,13 @@ dfb_font_cache_row_deinit( DFBFontCacheRow *row )
           D_MAGIC_ASSERT( glyph, CoreGlyphData );
           D_ASSERT( glyph->layer < D_ARRAY_SIZE(font->layers) );
 
+          /* Drop glyph runs using this row. */
+          if (font != last) {
+               glyph_runs_invalidate( font, row->surface );
+
+               last = font;
+          }
+
           /*ret =*/ direct_hash_remove( font->layers[glyph->layer].glyph_hash, glyph->index );
           //FIXME: use D_ASSERT( ret == DFB_OK );
 
@@ -732,6 +744,8 @@ dfb_font_create( CoreDFB                   *core,
 
      font->blittingflags = DSBLIT_BLEND_ALPHACHANNEL | DSBLIT_COLORIZE;
 
+     direct_mutex_init( &font->runs_lock );
+
      D_MAGIC_SET( font, CoreFont );
 
      *ret_font = font;
@@ -770,6 +784,10 @@ dfb_font_destroy( CoreFont *font )
      if (font->encodings)
           D_FREE( font->encodings );
 
+     D_ASSERT( font->runs == NULL );
+
+     direct_mutex_deinit( &font->runs_lock );
+
      D_FREE( font->url );
 
      D_MAGIC_CLEAR( font );
@@ -788,6 +806,8 @@ dfb_font_dispose( CoreFont *font )
 
      dfb_font_manager_lock( font->manager );
 
+     glyph_runs_invalidate( font, NULL );
+
      for (i=0; i<DFB_FONT_MAX_LAYERS; i++) {
           direct_hash_iterate( font->layers[i].glyph_hash, free_glyphs, NULL );
 
@@ -989,6 +1009,401 @@ error:
 
 /**********************************************************************************************************************/
 
+#define GLYPH_RUN_CACHE_SIZE  64      /* runs per font */
+#define GLYPH_RUN_MAX_BYTES   256     /* longer strings are laid out each time */
+
+static u32
+glyph_run_hash( DFBTextEncodingID  encoding,
+                unsigned int       layers,
+                const u8          *text,
+                int                bytes )
+{
+     u32 hash = 2166136261U;   /* FNV-1a */
+     int i;
+
+     hash = (hash ^ encoding) * 16777619U;
+     hash = (hash ^ layers)   * 16777619U;
+
+     for (i=0; i<bytes; i++)
+          hash = (hash ^ text[i]) * 16777619U;
+
+     return hash;
+}
+
+static void
+glyph_run_destroy( CoreGlyphRun *run )
+{
+     unsigned int l, i;
+
+     D_MAGIC_ASSERT( run, CoreGlyphRun );
+     D_ASSERT( run->refs == 0 );
+
+     for (l=0; l<run->layers; l++) {
+          for (i=0; i<run->num_segments[l]; i++)
+               dfb_surface_unref( run->segments[l][i].surface );
+     }
+
+     D_MAGIC_CLEAR( run );
+
+     D_FREE( run );
+}
+
+/* Called with runs_lock. */
+static void
+glyph_run_remove( CoreFont     *font,
+                  CoreGlyphRun *run )
+{
+     D_ASSERT( run->cached );
+
+     direct_list_remove( &font->runs, &run->link );
+
+     font->num_runs--;
+
+     run->cached = false;
+
+     if (!--run->refs)
+          glyph_run_destroy( run );
+}
+
+/*
+ * Drops the cached runs using the surface of an evicted cache row, or all runs if surface is NULL.
+ */
+static void
+glyph_runs_invalidate( CoreFont    *font,
+                       CoreSurface *surface )
+{
+     CoreGlyphRun *run, *next;
+     unsigned int  l, i;
+
+     D_MAGIC_ASSERT( font, CoreFont );
+
+     direct_mutex_lock( &font->runs_lock );
+
+     font->runs_serial++;
+
+     direct_list_foreach_safe (run, next, font->runs) {
+          bool uses = !surface;
+
+          for (l=0; l<run->layers && !uses; l++) {
+               for (i=0; i<run->num_segments[l]; i++) {
+                    if (run->segments[l][i].surface == surface) {
+                         uses = true;
+                         break;
+                    }
+               }
+          }
+
+          if (uses) {
+               D_DEBUG_AT( Core_Font, "  -> dropping glyph run %p\n", run );
+
+               glyph_run_remove( font, run );
+          }
+     }
+
+     direct_mutex_unlock( &font->runs_lock );
+}
+
+static CoreGlyphRun *
+glyph_runs_lookup( CoreFont          *font,
+                   u32                hash,
+                   DFBTextEncodingID  encoding,
+                   const u8          *text,
+                   int                bytes,
+                   unsigned int       layers )
+{
+     CoreGlyphRun *run;
+
+     direct_list_foreach (run, font->runs) {
+          D_MAGIC_ASSERT( run, CoreGlyphRun );
+
+          if (run->hash     == hash     &&
+              run->encoding == encoding &&
+              run->layers   == layers   &&
+              run->bytes    == bytes    &&
+              !memcmp( run->text, text, bytes ))
+          {
+               /* Move to the front. */
+               direct_list_move_to_front( &font->runs, &run->link );
+
+               run->refs++;
+
+               return run;
+          }
+     }
+
+     return NULL;
+}
+
+typedef struct {
+     CoreSurface  *surface;    /* referenced if starting a segment */
+     bool          segment;
+     DFBRectangle  rect;
+     DFBPoint      point;
+} GlyphRunBlit;
+
+/*
+ * Lays out the decoded string, called with the font locked. Returns false in ret_complete if a glyph
+ * could not be loaded (yet), in which case the run must not be cached.
+ *
+ * Loading a glyph may evict the row of a previous one, so glyph data is copied right away and the
+ * surface of each segment is referenced before loading the next glyph.
+ */
+static DFBResult
+glyph_run_create( CoreFont            *font,
+                  DFBTextEncodingID    encoding,
+                  const u8            *text,
+                  int                  bytes,
+                  unsigned int         layers,
+                  const unsigned int  *indices,
+                  int                  num,
+                  bool                *ret_complete,
+                  CoreGlyphRun       **ret_run )
+{
+     GlyphRunBlit        *blits;
+     unsigned int         num_blits[DFB_FONT_MAX_LAYERS] = { 0 };
+     unsigned int         num_segments = 0;
+     unsigned int         total        = 0;
+     bool                 complete     = true;
+     CoreGlyphRun        *run;
+     CoreGlyphRunSegment *segment;
+     DFBRectangle        *run_rects;
+     DFBPoint            *run_points;
+     unsigned int         l, n;
+     int                  i;
+
+     D_ASSERT( layers > 0 && layers <= DFB_FONT_MAX_LAYERS );
+
+     blits = D_MALLOC( layers * (num ? : 1) * sizeof(GlyphRunBlit) );
+     if (!blits)
+          return D_OOM();
+
+     /* Resolve glyphs, kerning and advances. */
+     for (l=0; l<layers; l++) {
+          unsigned int  prev    = 0;
+          CoreSurface  *surface = NULL;
+          int           x       = 0;
+          int           y       = 0;
+
+          for (i=0; i<num; i++) {
+               DFBResult      ret;
+               CoreGlyphData *glyph;
+               unsigned int   current = indices[i];
+               int            kern_x;
+               int            kern_y;
+
+               ret = dfb_font_get_glyph_data( font, current, l, &glyph );
+               if (ret) {
+                    D_DEBUG_AT( Core_Font, "  -> dfb_font_get_glyph_data() failed! [%s]\n", DirectFBErrorString( ret ) );
+                    complete = false;
+                    prev     = current;
+                    continue;
+               }
+
+               if (glyph->retry)
+                    complete = false;
+
+               if (prev && font->GetKerning && font->GetKerning( font, prev, current, &kern_x, &kern_y ) == DFB_OK) {
+                    x += kern_x << 8;
+                    y += kern_y << 8;
+               }
+
+               if (glyph->width) {
+                    GlyphRunBlit *blit = &blits[total];
+
+                    blit->segment = false;
+
+                    if (glyph->surface != surface) {
+                         if (dfb_surface_ref( glyph->surface )) {
+                              complete = false;
+                              surface  = NULL;
+                              goto next;
+                         }
+
+                         surface       = glyph->surface;
+                         blit->segment = true;
+
+                         num_segments++;
+                    }
+
+                    blit->surface = surface;
+                    blit->rect    = (DFBRectangle){ glyph->start, 0, glyph->width, glyph->height };
+                    blit->point   = (DFBPoint){ (x >> 8) + glyph->left, (y >> 8) + glyph->top };
+
+                    num_blits[l]++;
+                    total++;
+               }
+
+next:
+               x   += glyph->xadvance;
+               y   += glyph->yadvance;
+               prev = current;
+          }
+     }
+
+     /* Allocate run, segments, rectangles, points and the text in one chunk. */
+     run = D_CALLOC( 1, sizeof(CoreGlyphRun) + num_segments * sizeof(CoreGlyphRunSegment) +
+                        total * (sizeof(DFBRectangle) + sizeof(DFBPoint)) + bytes );
+     if (!run) {
+          for (n=0; n<total; n++) {
+               if (blits[n].segment)
+                    dfb_surface_unref( blits[n].surface );
+          }
+
+          D_FREE( blits );
+
+          return D_OOM();
+     }
+
+     segment    = (CoreGlyphRunSegment*) (run + 1);
+     run_rects  = (DFBRectangle*) (segment + num_segments);
+     run_points = (DFBPoint*) (run_rects + total);
+
+     run->refs     = 1;
+     run->hash     = glyph_run_hash( encoding, layers, text, bytes );
+     run->encoding = encoding;
+     run->layers   = layers;
+     run->bytes    = bytes;
+     run->text     = (u8*) (run_points + total);
+
+     direct_memcpy( (u8*) run->text, text, bytes );
+
+     for (l=0, n=0; l<layers; l++) {
+          unsigned int end = n + num_blits[l];
+
+          run->segments[l] = segment;
+
+          for (; n<end; n++) {
+               if (blits[n].segment) {
+                    segment->surface = blits[n].surface;
+                    segment->rects   = run_rects;
+                    segment->points  = run_points;
+
+                    segment++;
+
+                    run->num_segments[l]++;
+               }
+
+               D_ASSERT( run->num_segments[l] > 0 );
+
+               *run_rects++  = blits[n].rect;
+               *run_points++ = blits[n].point;
+
+               segment[-1].num++;
+          }
+     }
+
+     D_FREE( blits );
+
+     D_MAGIC_SET( run, CoreGlyphRun );
+
+     *ret_complete = complete;
+     *ret_run      = run;
+
+     return DFB_OK;
+}
+
+DFBResult
+dfb_font_get_glyph_run( CoreFont           *font,
+                        DFBTextEncodingID   encoding,
+                        const u8           *text,
+                        int                 bytes,
+                        unsigned int        layers,
+                        CoreGlyphRun      **ret_run )
+{
+     DFBResult     ret;
+     CoreGlyphRun *run;
+     u32           hash;
+     unsigned int  serial;
+     unsigned int  indices[bytes];
+     int           num;
+     bool          complete;
+
+     D_DEBUG_AT( Core_Font, "%s( %p [%d], %d, %u )\n", __FUNCTION__, text, bytes, encoding, layers );
+
+     D_MAGIC_ASSERT( font, CoreFont );
+     D_ASSERT( text != NULL );
+     D_ASSERT( bytes > 0 );
+     D_ASSERT( ret_run != NULL );
+
+     if (layers < 1 || layers > DFB_FONT_MAX_LAYERS)
+          return DFB_INVARG;
+
+     hash = glyph_run_hash( encoding, layers, text, bytes );
+
+     direct_mutex_lock( &font->runs_lock );
+
+     run = glyph_runs_lookup( font, hash, encoding, text, bytes, layers );
+
+     serial = font->runs_serial;
+
+     direct_mutex_unlock( &font->runs_lock );
+
+     if (run) {
+          D_DEBUG_AT( Core_Font, "  -> cached run %p\n", run );
+
+          *ret_run = run;
+
+          return DFB_OK;
+     }
+
+     /* Decode string to character indices. */
+     ret = dfb_font_decode_text( font, encoding, text, bytes, indices, &num );
+     if (ret)
+          return ret;
+
+     dfb_font_lock( font );
+
+     ret = glyph_run_create( font, encoding, text, bytes, layers, indices, num, &complete, &run );
+     if (ret) {
+          dfb_font_unlock( font );
+          return ret;
+     }
+
+     if (complete && bytes <= GLYPH_RUN_MAX_BYTES) {
+          direct_mutex_lock( &font->runs_lock );
+
+          /* Skip caching if rows were evicted meanwhile, they may have been used by the new run. */
+          if (font->runs_serial == serial) {
+               if (font->num_runs == GLYPH_RUN_CACHE_SIZE)
+                    glyph_run_remove( font, (CoreGlyphRun*) direct_list_get_last( font->runs ) );
+
+               direct_list_prepend( &font->runs, &run->link );
+
+               font->num_runs++;
+
+               run->cached = true;
+               run->refs++;
+          }
+
+          direct_mutex_unlock( &font->runs_lock );
+     }
+
+     dfb_font_unlock( font );
+
+     *ret_run = run;
+
+     return DFB_OK;
+}
+
+void
+dfb_font_put_glyph_run( CoreFont     *font,
+                        CoreGlyphRun *run )
+{
+     D_MAGIC_ASSERT( font, CoreFont );
+     D_MAGIC_ASSERT( run, CoreGlyphRun );
+
+     direct_mutex_lock( &font->runs_lock );
+
+     D_ASSERT( run->refs > 0 );
+
+     if (!--run->refs)
+          glyph_run_destroy( run );
+
+     direct_mutex_unlock( &font->runs_lock );
+}
+
+/**********************************************************************************************************************/
+
 DFBResult
 dfb_font_register_encoding( CoreFont                    *font,
                             const char                  *name,
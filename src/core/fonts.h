@@ -134,6 +134,39 @@ struct _CoreGlyphData {
           D_DEBUG_AT( Domain, "  -> yadvance %d\n", (data)->yadvance );              \
      } while (0)
 
+#define DFB_FONT_MAX_LAYERS 2
+
+/*
+ * laid out glyphs of a string, see dfb_font_get_glyph_run()
+ *
+ * Glyph indices, advances and kerning are resolved into one blit per glyph, grouped by cache row surface
+ * (one segment per row switch), with positions relative to the string origin.
+ */
+typedef struct {
+     CoreSurface         *surface;          /* cache row surface (referenced)   */
+     unsigned int         num;
+     const DFBRectangle  *rects;            /* glyph rectangles in the surface  */
+     const DFBPoint      *points;           /* positions relative to the origin */
+} CoreGlyphRunSegment;
+
+typedef struct {
+     DirectLink           link;
+
+     int                  magic;
+
+     int                  refs;
+     bool                 cached;           /* still in the font's run cache    */
+
+     u32                  hash;
+     DFBTextEncodingID    encoding;
+     unsigned int         layers;
+     int                  bytes;
+     const u8            *text;
+
+     unsigned int         num_segments[DFB_FONT_MAX_LAYERS];
+     CoreGlyphRunSegment *segments[DFB_FONT_MAX_LAYERS];
+} CoreGlyphRun;
+
 typedef struct {
      DFBResult   (* GetCharacterIndex) ( CoreFont       *thiz,
                                          unsigned int    character,
@@ -166,7 +199,6 @@ typedef enum {
 } CoreFontFlags;
 
 
-#define DFB_FONT_MAX_LAYERS 2
 
 /*
  * font struct
@@ -230,6 +262,11 @@ struct _CoreFont {
      int                           underline_thickness;
 
      CoreFontFlags                 flags;
+
+     DirectMutex                   runs_lock;
+     DirectLink                   *runs;          /* glyph run cache, most recently used first */
+     unsigned int                  num_runs;
+     unsigned int                  runs_serial;   /* incremented when runs are invalidated */
 };
 
 #define CORE_FONT_DEBUG_AT(Domain, font)                                             \
@@ -288,6 +325,23 @@ DFBResult dfb_font_get_glyph_data( CoreFont        *font,
                                    CoreGlyphData  **glyph_data );
 
 
+/*
+ * Returns the laid out glyphs of a string for the given number of layers.
+ *
+ * Runs of short strings are cached per font, so that drawing the same text again neither decodes it nor locks
+ * the font. The run is referenced and must be returned via dfb_font_put_glyph_run(). Cached runs are dropped
+ * when one of the cache rows they use is evicted or the font is disposed.
+ */
+DFBResult dfb_font_get_glyph_run( CoreFont           *font,
+                                  DFBTextEncodingID   encoding,
+                                  const u8           *text,
+                                  int                 bytes,
+                                  unsigned int        layers,
+                                  CoreGlyphRun      **ret_run );
+
+void      dfb_font_put_glyph_run( CoreFont           *font,
+                                  CoreGlyphRun       *run );
+
 /*
  * Called by font module to register encoding implementations.
  *
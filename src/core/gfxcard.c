@@ -53,6 +53,7 @@
 
 #include <core/core_parts.h>
 #include <core/gfxcard.h>
+#include <core/gfxstats.h>
 #include <core/fonts.h>
 #include <core/state.h>
 #include <core/palette.h>
@@ -94,6 +95,46 @@ static void fill_tri( DFBTriangle *tri, CardState *state, bool accelerated );
 
 /**********************************************************************************************************************/
 
+/*
+ * Statistics of operations, see core/gfxstats.h
+ *
+ * An operation counts as accelerated if the last acceleration check succeeded and the driver completed it,
+ * otherwise it is accounted to the software engine along with the reason of the (partial) fallback.
+ */
+static __inline__ long long
+gfxcard_stats_start( CardState *state )
+{
+     if (!dfb_gfxstats)
+          return 0;
+
+     state->fallback = CGFR_UNCHECKED;
+
+     return direct_clock_get_time( DIRECT_CLOCK_MONOTONIC );
+}
+
+static void
+gfxcard_stats_count( CardState           *state,
+                     DFBAccelerationMask  accel,
+                     bool                 complete,
+                     unsigned int         num,
+                     unsigned long long   pixels,
+                     long long            start )
+{
+     if (complete && state->fallback == CGFR_NONE)
+          dfb_gfxstats_count( accel, CGSE_HARDWARE, CGFR_NONE, num, pixels, start );
+     else
+          dfb_gfxstats_count( accel, CGSE_SOFTWARE, state->fallback != CGFR_NONE ? state->fallback : CGFR_LIMITS,
+                              num, pixels, start );
+}
+
+#define GFXCARD_STATS( state, accel, complete, num, pixels, start )                              \
+     do {                                                                                        \
+          if (dfb_gfxstats)                                                                      \
+               gfxcard_stats_count( state, accel, complete, num, pixels, start );                \
+     } while (0)
+
+/**********************************************************************************************************************/
+
 DFB_CORE_PART( graphics_core, GraphicsCore );
 
 /**********************************************************************************************************************/
@@ -157,6 +198,9 @@ dfb_graphics_core_initialize( CoreDFB               *core,
      data->core   = core;
      data->shared = shared;
 
+     /* Optional statistics, failure is not fatal. */
+     dfb_gfxstats_init();
+
 
      /* fill generic driver info */
      gGetDriverInfo( &shared->driver_info );
@@ -267,6 +311,9 @@ dfb_graphics_core_join( CoreDFB               *core,
      data->core   = core;
      data->shared = shared;
 
+     /* Optional statistics, failure is not fatal. */
+     dfb_gfxstats_init();
+
      /* Initialize software rasterizer. */
      gGetDriverInfo( &driver_info );
 
@@ -355,6 +402,8 @@ dfb_graphics_core_shutdown( DFBGraphicsCore *data,
           SHFREE( pool, shared->module_name );
 
 
+     dfb_gfxstats_deinit();
+
      D_MAGIC_CLEAR( data );
      D_MAGIC_CLEAR( shared );
 
@@ -380,6 +429,7 @@ dfb_graphics_core_leave( DFBGraphicsCore *data,
           D_FREE( data->driver_data );
      }
 
+     dfb_gfxstats_deinit();
 
      D_MAGIC_CLEAR( data );
 
@@ -623,6 +673,8 @@ dfb_gfxcard_state_check( CardState *state, DFBAccelerationMask accel )
      dst = state->destination;
      src = state->source;
 
+     state->fallback = CGFR_LOCK;
+
      /* Destination may have been destroyed. */
      if (!dst) {
           D_BUG( "no destination" );
@@ -694,6 +746,7 @@ dfb_gfxcard_state_check( CardState *state, DFBAccelerationMask accel )
       */
      if (!card->funcs.CheckState) {
           D_DEBUG_AT( Core_GfxState, "  -> no acceleration available\n" );
+          state->fallback = CGFR_NO_DRIVER;
           return false;
      }
 
@@ -702,6 +755,7 @@ dfb_gfxcard_state_check( CardState *state, DFBAccelerationMask accel )
       */
      if (state->disabled & accel) {
           D_DEBUG_AT( Core_GfxState, "  -> acceleration disabled\n" );
+          state->fallback = CGFR_DISABLED;
           return false;
      }
 
@@ -753,6 +807,8 @@ dfb_gfxcard_state_check( CardState *state, DFBAccelerationMask accel )
      state->mod_hw   |= state->modified;
      state->modified  = 0;
 
+     state->fallback = CGFR_CHECKSTATE;
+
      /*
       * If back_buffer policy is 'system only' and the GPU does not fully
       * support system memory surfaces there's no acceleration available.
@@ -766,6 +822,8 @@ dfb_gfxcard_state_check( CardState *state, DFBAccelerationMask accel )
           /* Clear 'accelerated functions'. */
           state->accel   = DFXL_NONE;
           state->checked = DFXL_ALL;
+
+          state->fallback = dst_buffer->policy == CSP_SYSTEMONLY ? CGFR_SYSTEMONLY : CGFR_RENDER_OPTIONS;
      }
      else if (DFB_BLITTING_FUNCTION( accel )) {
           /*
@@ -773,8 +831,10 @@ dfb_gfxcard_state_check( CardState *state, DFBAccelerationMask accel )
            * no accelerated blitting is available.
            */
           ret = dfb_surface_lock( src );
-          if (ret)
+          if (ret) {
+               state->fallback = CGFR_LOCK;
                return false;
+          }
 
           src_buffer = dfb_surface_get_buffer( src, state->from );
           D_MAGIC_ASSERT( src_buffer, CoreSurfaceBuffer );
@@ -785,12 +845,17 @@ dfb_gfxcard_state_check( CardState *state, DFBAccelerationMask accel )
                /* Clear 'accelerated blitting functions'. */
                state->accel   &= ~DFXL_ALL_BLIT;
                state->checked |=  DFXL_ALL_BLIT;
+
+               state->fallback = CGFR_SYSTEMONLY;
           }
      }
 
      D_DEBUG_AT( Core_GfxState, "  => checked 0x%08x, accel 0x%08x, modified 0x%08x, mod_hw 0x%08x\n",
                  state->checked, state->accel, state->modified, state->mod_hw );
 
+     if (state->accel & accel)
+          state->fallback = CGFR_NONE;
+
      /* Return whether the function bit is set. */
      return !!(state->accel & accel);
 }
@@ -1040,6 +1105,8 @@ dfb_gfxcard_state_check_acquire( CardState *state, DFBAccelerationMask accel )
      src    = state->source;
      shared = card->shared;
 
+     state->fallback = CGFR_LOCK;
+
      locks[num_locks++] = &dst->lock;
 
      /* find locking flags */
@@ -1144,12 +1211,16 @@ dfb_gfxcard_state_check_acquire( CardState *state, DFBAccelerationMask accel )
      }
 
      /* If there's no CheckState function there's no acceleration at all. */
-     if (!card->funcs.CheckState)
+     if (!card->funcs.CheckState) {
+          state->fallback = CGFR_NO_DRIVER;
           return false;
+     }
 
      /* Check if this function has been disabled temporarily. */
-     if (state->disabled & accel)
+     if (state->disabled & accel) {
+          state->fallback = CGFR_DISABLED;
           return false;
+     }
 
      if (core_dfb->shutdown_running)
           return false;
@@ -1241,6 +1312,8 @@ dfb_gfxcard_state_check_acquire( CardState *state, DFBAccelerationMask accel )
           state->accel   = DFXL_NONE;
           state->checked = DFXL_ALL;
 
+          state->fallback = dst_buffer->policy == CSP_SYSTEMONLY ? CGFR_SYSTEMONLY : CGFR_RENDER_OPTIONS;
+
           Core_PopIdentity();
           fusion_skirmish_dismiss_multi( locks, num_locks );
           return false;
@@ -1248,6 +1321,7 @@ dfb_gfxcard_state_check_acquire( CardState *state, DFBAccelerationMask accel )
 
      if (!(state->accel & accel)) {
           D_DEBUG_AT( Core_Graphics, "  -> not accelerated\n" );
+          state->fallback = CGFR_CHECKSTATE;
           Core_PopIdentity();
           fusion_skirmish_dismiss_multi( locks, num_locks );
           return false;
@@ -1414,6 +1488,7 @@ dfb_gfxcard_state_check_acquire( CardState *state, DFBAccelerationMask accel )
           D_ONCE( "USING OLD DRIVER! *** Use 'state->mod_hw' NOT 'modified'." );
 
      state->modified = 0;
+     state->fallback = CGFR_NONE;
 
      return true;
 }
@@ -1544,6 +1619,8 @@ do { \
 void
 dfb_gfxcard_fillrectangles( const DFBRectangle *rects, int num, CardState *state )
 {
+     long long start;
+
      D_DEBUG_AT( Core_GraphicsOps, "%s( %p [%d], %p )\n", __FUNCTION__, rects, num, state );
 
      D_ASSERT( card != NULL );
@@ -1563,6 +1640,8 @@ dfb_gfxcard_fillrectangles( const DFBRectangle *rects, int num, CardState *state
      /* Signal beginning of sequence of operations if not already done. */
      dfb_state_start_drawing( state, card );
 
+     start = gfxcard_stats_start( state );
+
      if (!(state->render_options & DSRO_MATRIX)) {
           while (num > 0) {
                if (dfb_rectangle_region_intersects( rects, &state->clip ))
@@ -1701,6 +1780,9 @@ dfb_gfxcard_fillrectangles( const DFBRectangle *rects, int num, CardState *state
                     }
                }
           }
+
+          GFXCARD_STATS( state, DFXL_FILLRECTANGLE, i == num, num,
+                         dfb_gfxstats_rects_pixels( rects, num, &state->clip ), start );
      }
 
      /* Unlock after execution. */
@@ -1712,6 +1794,7 @@ void dfb_gfxcard_drawrectangle( DFBRectangle *rect, CardState *state )
      DFBRectangle rects[4];
      bool         hw = false;
      int          i = 0, num = 0;
+     long long    start;
 
      D_ASSERT( card != NULL );
      D_ASSERT( card->shared != NULL );
@@ -1731,6 +1814,8 @@ void dfb_gfxcard_drawrectangle( DFBRectangle *rect, CardState *state )
      /* Signal beginning of sequence of operations if not already done. */
      dfb_state_start_drawing( state, card );
 
+     start = gfxcard_stats_start( state );
+
      if (!(state->render_options & DSRO_MATRIX) &&
          !dfb_rectangle_region_intersects( rect, &state->clip ))
      {
@@ -1821,12 +1906,15 @@ void dfb_gfxcard_drawrectangle( DFBRectangle *rect, CardState *state )
           }
      }
 
+     GFXCARD_STATS( state, DFXL_DRAWRECTANGLE, hw, 1, 2 * (rect->w + rect->h), start );
+
      dfb_state_unlock( state );
 }
 
 void dfb_gfxcard_drawlines( DFBRegion *lines, int num_lines, CardState *state )
 {
-     int i = 0;
+     int       i = 0;
+     long long start;
 
      D_DEBUG_AT( Core_GraphicsOps, "%s( %p [%d], %p )\n", __FUNCTION__, lines, num_lines, state );
 
@@ -1847,6 +1935,8 @@ void dfb_gfxcard_drawlines( DFBRegion *lines, int num_lines, CardState *state )
      /* Signal beginning of sequence of operations if not already done. */
      dfb_state_start_drawing( state, card );
 
+     start = gfxcard_stats_start( state );
+
      if (!dfb_config->task_manager &&
          dfb_gfxcard_state_check_acquire( state, DFXL_DRAWLINE ))
      {
@@ -1880,12 +1970,16 @@ void dfb_gfxcard_drawlines( DFBRegion *lines, int num_lines, CardState *state )
           }
      }
 
+     GFXCARD_STATS( state, DFXL_DRAWLINE, i == num_lines, num_lines,
+                    dfb_gfxstats_lines_pixels( lines, num_lines ), start );
+
      dfb_state_unlock( state );
 }
 
 void dfb_gfxcard_fillspans( int y, DFBSpan *spans, int num_spans, CardState *state )
 {
-     int i = 0;
+     int       i = 0;
+     long long start;
 
      D_DEBUG_AT( Core_GraphicsOps, "%s( %d, %p [%d], %p )\n", __FUNCTION__, y, spans, num_spans, state );
 
@@ -1906,6 +2000,8 @@ void dfb_gfxcard_fillspans( int y, DFBSpan *spans, int num_spans, CardState *sta
      /* Signal beginning of sequence of operations if not already done. */
      dfb_state_start_drawing( state, card );
 
+     start = gfxcard_stats_start( state );
+
      if (!dfb_config->task_manager &&
          dfb_gfxcard_state_check_acquire( state, DFXL_FILLRECTANGLE ))
      {
@@ -2051,6 +2147,75 @@ void dfb_gfxcard_fillspans( int y, DFBSpan *spans, int num_spans, CardState *sta
           }
      }
 
+     GFXCARD_STATS( state, DFXL_FILLSPAN, i == num_spans, num_spans,
+                    dfb_gfxstats_spans_pixels( spans, num_spans ), start );
+
+     dfb_state_unlock( state );
+}
+
+/*
+ * Coverage spans are rendered by Genefx only, they come from rasterizing in device coordinates
+ * and therefore are not transformed by the render matrix.
+ */
+void dfb_gfxcard_fill_coverage_spans( const CoreCoverageSpan *spans, int num, CardState *state )
+{
+     int                i;
+     unsigned long long pixels = 0;
+     long long          start;
+
+     D_DEBUG_AT( Core_GraphicsOps, "%s( %p [%d], %p )\n", __FUNCTION__, spans, num, state );
+
+     D_ASSERT( card != NULL );
+     D_ASSERT( card->shared != NULL );
+     D_MAGIC_ASSERT( state, CardState );
+     D_ASSERT( spans != NULL );
+     D_ASSERT( num > 0 );
+
+     D_ASSUME( !dfb_config->task_manager );
+
+     if (dfb_config->task_manager)
+          return;
+
+     /* The state is locked during graphics operations. */
+     dfb_state_lock( state );
+
+     /* Signal beginning of sequence of operations if not already done. */
+     dfb_state_start_drawing( state, card );
+
+     start = gfxcard_stats_start( state );
+
+     if (gAcquire( state, DFXL_FILLRECTANGLE )) {
+          CoreCoverageSpan clipped[256];
+          int              n = 0;
+
+          for (i=0; i<num; i++) {
+               int x1 = MAX( spans[i].x, state->clip.x1 );
+               int x2 = MIN( spans[i].x + spans[i].w - 1, state->clip.x2 );
+
+               if (spans[i].y < state->clip.y1 || spans[i].y > state->clip.y2 || x1 > x2)
+                    continue;
+
+               clipped[n].x        = x1;
+               clipped[n].y        = spans[i].y;
+               clipped[n].w        = x2 - x1 + 1;
+               clipped[n].coverage = spans[i].coverage;
+
+               pixels += clipped[n].w;
+
+               if (++n == D_ARRAY_SIZE(clipped)) {
+                    gFillCoverageSpans( state, clipped, n );
+                    n = 0;
+               }
+          }
+
+          if (n)
+               gFillCoverageSpans( state, clipped, n );
+
+          gRelease( state );
+     }
+
+     GFXCARD_STATS( state, DFXL_FILLSPAN, true, num, pixels, start );
+
      dfb_state_unlock( state );
 }
 
@@ -2221,8 +2386,9 @@ fill_trap( DFBTrapezoid *trap, CardState *state, bool accelerated )
 
 void dfb_gfxcard_filltriangles( const DFBTriangle *tris, int num, CardState *state )
 {
-     bool hw = false;
-     int  i  = 0;
+     bool      hw = false;
+     int       i  = 0;
+     long long start;
 
      D_ASSERT( card != NULL );
      D_ASSERT( card->shared != NULL );
@@ -2243,6 +2409,8 @@ void dfb_gfxcard_filltriangles( const DFBTriangle *tris, int num, CardState *sta
      /* Signal beginning of sequence of operations if not already done. */
      dfb_state_start_drawing( state, card );
 
+     start = gfxcard_stats_start( state );
+
      if (!dfb_config->task_manager &&
          dfb_gfxcard_state_check_acquire( state, DFXL_FILLTRIANGLE ))
      {
@@ -2332,6 +2500,9 @@ void dfb_gfxcard_filltriangles( const DFBTriangle *tris, int num, CardState *sta
           }
      }
 
+     GFXCARD_STATS( state, DFXL_FILLTRIANGLE, true, num,
+                    dfb_gfxstats_triangles_pixels( tris, num ), start );
+
      dfb_state_unlock( state );
 }
 
@@ -2707,6 +2878,7 @@ static void dfb_gfxcard_blit_locked( DFBRectangle *rect,
 {
      bool         hw    = false;
      DFBRectangle drect = { dx, dy, rect->w, rect->h };
+     long long    start;
 
      DFBSurfaceBlittingFlags blittingflags;
 
@@ -2734,6 +2906,8 @@ static void dfb_gfxcard_blit_locked( DFBRectangle *rect,
      /* Signal beginning of sequence of operations if not already done. */
      dfb_state_start_drawing( state, card );
 
+     start = gfxcard_stats_start( state );
+
      if (!(state->render_options & DSRO_MATRIX) &&
          !dfb_clip_blit_precheck( &state->clip, drect.w, drect.h, drect.x, drect.y ))
      {
@@ -2830,6 +3004,8 @@ static void dfb_gfxcard_blit_locked( DFBRectangle *rect,
                }
           }
      }
+
+     GFXCARD_STATS( state, DFXL_BLIT, hw, 1, (unsigned long long) rect->w * rect->h, start );
 }
 
 void dfb_gfxcard_blit( DFBRectangle *rect, int dx, int dy, CardState *state )
@@ -2891,6 +3067,7 @@ void dfb_gfxcard_batchblit( DFBRectangle *rects, DFBPoint *points,
                             int num, CardState *state )
 {
      unsigned int i = 0;
+     long long    start;
 
      DFBSurfaceBlittingFlags blittingflags;
 
@@ -2917,6 +3094,8 @@ void dfb_gfxcard_batchblit( DFBRectangle *rects, DFBPoint *points,
      /* Signal beginning of sequence of operations if not already done. */
      dfb_state_start_drawing( state, card );
 
+     start = gfxcard_stats_start( state );
+
      if (!dfb_config->task_manager &&
          dfb_gfxcard_state_check_acquire( state, DFXL_BLIT ))
      {
@@ -3062,6 +3241,35 @@ void dfb_gfxcard_batchblit( DFBRectangle *rects, DFBPoint *points,
           }
           else {
                if (gAcquire( state, DFXL_BLIT )) {
+                    GenefxState *gfxs = state->gfxs;
+
+                    /* Plain A8 glyphs are collected and rendered as one run, see gDrawGlyphs(). */
+                    if (gfxs->glyphs) {
+                         DFBRectangle srects[64];
+                         DFBPoint     dpoints[64];
+                         int          n = 0;
+
+                         for (; i<num; i++) {
+                              if (dfb_clip_blit_precheck( &state->clip,
+                                                          rects[i].w, rects[i].h,
+                                                          points[i].x, points[i].y ))
+                              {
+                                   srects[n]  = rects[i];
+                                   dpoints[n] = points[i];
+
+                                   dfb_clip_blit( &state->clip, &srects[n], &dpoints[n].x, &dpoints[n].y );
+
+                                   if (++n == D_ARRAY_SIZE(srects)) {
+                                        gDrawGlyphs( state, srects, dpoints, n );
+                                        n = 0;
+                                   }
+                              }
+                         }
+
+                         if (n)
+                              gDrawGlyphs( state, srects, dpoints, n );
+                    }
+
                     for (; i<num; i++) {
                          DFBRectangle drect = { points[i].x, points[i].y, rects[i].w, rects[i].h };
 
@@ -3084,6 +3292,9 @@ void dfb_gfxcard_batchblit( DFBRectangle *rects, DFBPoint *points,
           }
      }
 
+     GFXCARD_STATS( state, DFXL_BLIT, i == num, num,
+                    dfb_gfxstats_rects_pixels( rects, num, NULL ), start );
+
      dfb_state_unlock( state );
 }
 
@@ -3370,6 +3581,7 @@ void dfb_gfxcard_batchstretchblit( DFBRectangle *srects, DFBRectangle *drects,
 {
      int i;
      bool need_clip, acquired = false;
+     long long start;
 
      DFBSurfaceBlittingFlags blittingflags;
 
@@ -3401,6 +3613,8 @@ void dfb_gfxcard_batchstretchblit( DFBRectangle *srects, DFBRectangle *drects,
      /* Signal beginning of sequence of operations if not already done. */
      dfb_state_start_drawing( state, card );
 
+     start = gfxcard_stats_start( state );
+
      need_clip = (!D_FLAGS_IS_SET( card->caps.flags, CCF_CLIPPING )
                   && !D_FLAGS_IS_SET( card->caps.clip, DFXL_STRETCHBLIT ));
      for (i = 0; i < num; ++i) {
@@ -3509,6 +3723,9 @@ void dfb_gfxcard_batchstretchblit( DFBRectangle *srects, DFBRectangle *drects,
           }
      }
 
+     GFXCARD_STATS( state, DFXL_STRETCHBLIT, i == num, num,
+                    dfb_gfxstats_rects_pixels( drects, num, &state->clip ), start );
+
      dfb_state_unlock( state );
 }
 
@@ -3524,7 +3741,8 @@ void dfb_gfxcard_texture_triangles( DFBVertex *vertices, int num,
                                     DFBTriangleFormation formation,
                                     CardState *state )
 {
-     bool hw = false;
+     bool      hw = false;
+     long long start;
 
      D_DEBUG_AT( Core_GraphicsOps, "%s( %p [%d], %s, %p )\n", __FUNCTION__, vertices, num,
                  (formation == DTTF_LIST)  ? "LIST"  :
@@ -3548,6 +3766,8 @@ void dfb_gfxcard_texture_triangles( DFBVertex *vertices, int num,
      /* Signal beginning of sequence of operations if not already done. */
      dfb_state_start_drawing( state, card );
 
+     start = gfxcard_stats_start( state );
+
      if ((D_FLAGS_IS_SET( card->caps.flags, CCF_CLIPPING ) || D_FLAGS_IS_SET( card->caps.clip, DFXL_TEXTRIANGLES )) &&
          !dfb_config->task_manager &&
          dfb_gfxcard_state_check_acquire( state, DFXL_TEXTRIANGLES ))
@@ -3566,6 +3786,8 @@ void dfb_gfxcard_texture_triangles( DFBVertex *vertices, int num,
           }
      }
 
+     GFXCARD_STATS( state, DFXL_TEXTRIANGLES, hw, formation == DTTF_LIST ? num / 3 : num - 2, 0, start );
+
      dfb_state_unlock( state );
 }
 
@@ -3639,18 +3861,13 @@ dfb_gfxcard_drawstring( const u8 *text, int bytes,
                         CoreFont *font, unsigned int layers, CoreGraphicsStateClient *client )
 {
      DFBResult     ret;
-     unsigned int  prev = 0;
-     unsigned int  indices[bytes];
-     int           i, l, num;
-     int           kern_x;
-     int           kern_y;
+     int           l;
+     unsigned int  i, n;
      CoreSurface  *surface;
      CardState     state_backup;
-     DFBPoint      points[50];
-     DFBRectangle  rects[50];
-     int           num_blits = 0;
-     int           ox = x;
-     int           oy = y;
+     CoreGlyphRun *run;
+     DFBPoint      points[100];
+     DFBRectangle  rects[100];
      CardState    *state;
 
      if (encoding == DTEID_UTF8)
@@ -3683,71 +3900,40 @@ dfb_gfxcard_drawstring( const u8 *text, int bytes,
           }
      }
 
-     /* Decode string to character indices. */
-     ret = dfb_font_decode_text( font, encoding, text, bytes, indices, &num );
+     /* Get the laid out glyphs, usually from the font's run cache. */
+     ret = dfb_font_get_glyph_run( font, encoding, text, bytes, layers, &run );
      if (ret)
           return;
 
      font_state_prepare( state, &state_backup, font, surface );
 
-     dfb_font_lock( font );
-
      for (l=layers-1; l>=0; l--) {
-          x = ox << 8;
-          y = oy << 8;
-
           if (layers > 1)
                dfb_state_set_color( state, &state->colors[l] );
 
-          /* blit glyphs */
-          for (i=0; i<num; i++) {
-               DFBResult      ret;
-               CoreGlyphData *glyph;
-               unsigned int   current = indices[i];
-
-               ret = dfb_font_get_glyph_data( font, current, l, &glyph );
-               if (ret) {
-                    D_DEBUG_AT( Core_GraphicsOps, "  -> dfb_font_get_glyph_data() failed! [%s]\n", DirectFBErrorString( ret ) );
-                    prev = current;
-                    continue;
-               }
-
-               if (prev && font->GetKerning && font->GetKerning( font, prev, current, &kern_x, &kern_y) == DFB_OK) {
-                    x += kern_x << 8;
-                    y += kern_y << 8;
-               }
+          /* blit glyphs, one batch per cache row */
+          for (i=0; i<run->num_segments[l]; i++) {
+               const CoreGlyphRunSegment *segment = &run->segments[l][i];
 
-               if (glyph->width) {
-                    if (glyph->surface != state->source || num_blits == D_ARRAY_SIZE(rects)) {
-                         if (num_blits) {
-                              CoreGraphicsStateClient_Blit( client, rects, points, num_blits );
-                              num_blits = 0;
-                         }
+               if (segment->surface != state->source)
+                    dfb_state_set_source( state, segment->surface );
 
-                         if (glyph->surface != state->source)
-                              dfb_state_set_source( state, glyph->surface );
-                    }
+               /* Blitting may clip the arrays in place, so the cached ones are copied. */
+               for (n=0; n<segment->num; n++) {
+                    unsigned int k = n % D_ARRAY_SIZE(rects);
 
-                    points[num_blits] = (DFBPoint){ (x >> 8) + glyph->left, (y >> 8) + glyph->top };
-                    rects[num_blits]  = (DFBRectangle){ glyph->start, 0, glyph->width, glyph->height };
+                    rects[k]  = segment->rects[n];
+                    points[k] = (DFBPoint){ x + segment->points[n].x, y + segment->points[n].y };
 
-                    num_blits++;
+                    if (k == D_ARRAY_SIZE(rects) - 1 || n == segment->num - 1)
+                         CoreGraphicsStateClient_DrawGlyphs( client, rects, points, k + 1 );
                }
-
-               x   += glyph->xadvance;
-               y   += glyph->yadvance;
-               prev = current;
-          }
-
-          if (num_blits) {
-               CoreGraphicsStateClient_Blit( client, rects, points, num_blits );
-               num_blits = 0;
           }
      }
 
-     dfb_font_unlock( font );
-
      font_state_restore( state, &state_backup );
+
+     dfb_font_put_glyph_run( font, run );
 }
 
 void dfb_gfxcard_drawglyph( CoreGlyphData **glyph, int x, int y,
@@ -3786,7 +3972,7 @@ void dfb_gfxcard_drawglyph( CoreGlyphData **glyph, int x, int y,
 
                dfb_state_set_source( state, glyph[l]->surface );
 
-               CoreGraphicsStateClient_Blit( client, &rect, &point, 1 );
+               CoreGraphicsStateClient_DrawGlyphs( client, &rect, &point, 1 );
           }
      }
 
@@ -4398,6 +4584,10 @@ static void dfb_gfxcard_load_driver( void )
 
           link = link->next;
 
+          /* Only load the driver used by the master, e.g. if known by the manifest. */
+          if (!module->loaded && (card->module || !module->name || strcmp( module->name, card->shared->module_name )))
+               continue;
+
           const GraphicsDriverFuncs *funcs = direct_module_ref( module );
 
           if (!funcs)
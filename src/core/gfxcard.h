@@ -60,6 +60,16 @@ struct __DFB_CoreGraphicsSerial {
      unsigned int generation;
 };
 
+/*
+ * Horizontal run of pixels with the same anti-aliasing coverage.
+ */
+typedef struct {
+     int            x;
+     int            y;
+     int            w;
+     int            coverage;   /* 1-255, multiplied with the alpha of the color */
+} CoreCoverageSpan;
+
 typedef struct {
      CardCapabilitiesFlags   flags;
 
@@ -403,6 +413,14 @@ void dfb_gfxcard_fillspans              ( int                   y,
                                           int                   num_spans,
                                           CardState            *state );
 
+/*
+ * Blends the color with coverage times its alpha over the destination (source over),
+ * other drawing flags and blend functions get solid spans where coverage is at least 0x80.
+ */
+void dfb_gfxcard_fill_coverage_spans    ( const CoreCoverageSpan *spans,
+                                          int                     num,
+                                          CardState              *state );
+
 void dfb_gfxcard_filltriangles          ( const DFBTriangle    *tris,
                                           int                   num,
                                           CardState            *state );
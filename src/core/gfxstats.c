@@ -0,0 +1,455 @@
+/*
+   (c) Copyright 2012-2013  DirectFB integrated media GmbH
+   (c) Copyright 2001-2013  The world wide DirectFB Open Source Community (directfb.org)
+   (c) Copyright 2000-2004  Convergence (integrated media) GmbH
+
+   All rights reserved.
+
+   Written by Denis Oliver Kropp <dok@directfb.org>,
+              Andreas Shimokawa <andi@directfb.org>,
+              Marek Pikarski <mass@directfb.org>,
+              Sven Neumann <neo@directfb.org>,
+              Ville Syrjälä <syrjala@sci.fi> and
+              Claudio Ciccani <klan@users.sf.net>.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+
+#include <config.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <directfb.h>
+#include <directfb_util.h>
+
+#include <direct/debug.h>
+#include <direct/atomic.h>
+#include <direct/messages.h>
+#include <direct/system.h>
+#include <direct/thread.h>
+#include <direct/util.h>
+
+#include <core/gfxstats.h>
+
+#include <misc/conf.h>
+
+
+D_DEBUG_DOMAIN( Core_GfxStats, "Core/GfxStats", "DirectFB Graphics Statistics" );
+
+#ifndef O_NOFOLLOW
+#define O_NOFOLLOW 0
+#endif
+
+/**********************************************************************************************************************/
+
+CoreGfxStats *dfb_gfxstats;
+
+static char         gfxstats_path[64];
+static DirectTLS    gfxstats_tls;         /* slot claimed by the thread */
+static DirectMutex  gfxstats_lock;        /* for the shared slot */
+
+/**********************************************************************************************************************/
+
+/*
+ * TLS destructor, frees the slot of an exiting thread for the next one, keeping its counts.
+ */
+static void
+release_slot( void *ptr )
+{
+     CoreGfxStatsSlot *slot = ptr;
+
+     if (slot != &dfb_gfxstats->slots[DFB_GFXSTATS_SLOTS-1])
+          D_SYNC_FETCH_AND_CLEAR( &slot->owner );
+}
+
+static CoreGfxStatsSlot *
+claim_slot( CoreGfxStats *stats )
+{
+     int  i;
+     u32  tid = direct_gettid();
+
+     for (i=0; i<DFB_GFXSTATS_SLOTS-1; i++) {
+          CoreGfxStatsSlot *slot = &stats->slots[i];
+
+          if (!slot->owner && D_SYNC_BOOL_COMPARE_AND_SWAP( &slot->owner, 0, tid ))
+               return slot;
+     }
+
+     return &stats->slots[DFB_GFXSTATS_SLOTS-1];
+}
+
+/**********************************************************************************************************************/
+
+static void
+read_process_name( char *buf, size_t size )
+{
+     int     fd;
+     ssize_t len;
+
+     direct_snputs( buf, "?", size );
+
+     fd = open( "/proc/self/comm", O_RDONLY );
+     if (fd < 0)
+          return;
+
+     len = read( fd, buf, size - 1 );
+     if (len > 0) {
+          buf[len] = 0;
+
+          if (buf[len-1] == '\n')
+               buf[len-1] = 0;
+     }
+
+     close( fd );
+}
+
+DFBResult
+dfb_gfxstats_init( void )
+{
+     int           fd;
+     CoreGfxStats *stats;
+
+     D_DEBUG_AT( Core_GfxStats, "%s()\n", __FUNCTION__ );
+
+     if (!dfb_config->gfx_stats || dfb_gfxstats)
+          return DFB_OK;
+
+     snprintf( gfxstats_path, sizeof(gfxstats_path), DFB_GFXSTATS_PATH, direct_getpid() );
+
+     /*
+      * The path is predictable, so never follow or reuse an existing file. Remove a stale one
+      * left by a previous process with the same pid (or a planted link, not its target).
+      */
+     if (unlink( gfxstats_path ) < 0 && errno != ENOENT) {
+          D_PERROR( "Core/GfxStats: Could not remove stale '%s'!\n", gfxstats_path );
+          return errno2result( errno );
+     }
+
+     fd = open( gfxstats_path, O_RDWR | O_CREAT | O_EXCL | O_NOFOLLOW, 0644 );
+     if (fd < 0) {
+          int erno = errno;
+
+          if (erno == EEXIST)
+               D_ERROR( "Core/GfxStats: '%s' was created by someone else, not recording!\n", gfxstats_path );
+          else
+               D_PERROR( "Core/GfxStats: Could not create '%s'!\n", gfxstats_path );
+
+          return errno2result( erno );
+     }
+
+     if (ftruncate( fd, sizeof(CoreGfxStats) ) < 0) {
+          D_PERROR( "Core/GfxStats: Could not resize '%s'!\n", gfxstats_path );
+          close( fd );
+          unlink( gfxstats_path );
+          return errno2result( errno );
+     }
+
+     stats = mmap( NULL, sizeof(CoreGfxStats), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+
+     close( fd );
+
+     if (stats == MAP_FAILED) {
+          D_PERROR( "Core/GfxStats: Could not map '%s'!\n", gfxstats_path );
+          unlink( gfxstats_path );
+          return DFB_FAILURE;
+     }
+
+     direct_tls_register( &gfxstats_tls, release_slot );
+     direct_mutex_init( &gfxstats_lock );
+
+     /* The file is zero filled by ftruncate(), fill in the header last. */
+     stats->size     = sizeof(CoreGfxStats);
+     stats->pid      = direct_getpid();
+     stats->ts_start = direct_clock_get_time( DIRECT_CLOCK_MONOTONIC );
+
+     read_process_name( stats->name, sizeof(stats->name) );
+
+     stats->version  = DFB_GFXSTATS_VERSION;
+     stats->magic    = DFB_GFXSTATS_MAGIC;
+
+     dfb_gfxstats = stats;
+
+     D_INFO( "Core/GfxStats: Recording to '%s'\n", gfxstats_path );
+
+     return DFB_OK;
+}
+
+void
+dfb_gfxstats_deinit( void )
+{
+     D_DEBUG_AT( Core_GfxStats, "%s()\n", __FUNCTION__ );
+
+     if (!dfb_gfxstats)
+          return;
+
+     /* Threads still running keep their slot pointer, but no longer get the destructor called. */
+     direct_tls_unregister( &gfxstats_tls );
+     direct_mutex_deinit( &gfxstats_lock );
+
+     munmap( dfb_gfxstats, sizeof(CoreGfxStats) );
+
+     dfb_gfxstats = NULL;
+
+     unlink( gfxstats_path );
+}
+
+/**********************************************************************************************************************/
+
+void
+dfb_gfxstats_count( DFBAccelerationMask    accel,
+                    CoreGfxStatsEngine     engine,
+                    CoreGfxStatsFallback   fallback,
+                    unsigned int           primitives,
+                    unsigned long long     pixels,
+                    long long              start )
+{
+     int                   index;
+     bool                  shared;
+     CoreGfxStatsSlot     *slot;
+     CoreGfxStatsCounters *counters;
+     CoreGfxStats         *stats = dfb_gfxstats;
+
+     if (!stats || !accel)
+          return;
+
+     D_ASSERT( engine < _CGSE_NUM );
+     D_ASSERT( fallback < _CGFR_NUM );
+
+     index = D_BITn32( accel );
+     if (index < 0 || index >= DFB_GFXSTATS_FUNCS)
+          return;
+
+     slot = direct_tls_get( gfxstats_tls );
+     if (!slot) {
+          slot = claim_slot( stats );
+
+          direct_tls_set( gfxstats_tls, slot );
+     }
+
+     shared   = (slot == &stats->slots[DFB_GFXSTATS_SLOTS-1]);
+     counters = &slot->funcs[index][engine];
+
+     if (shared)
+          direct_mutex_lock( &gfxstats_lock );
+
+     counters->operations++;
+     counters->primitives += primitives;
+     counters->pixels     += pixels;
+
+     if (start)
+          counters->time += direct_clock_get_time( DIRECT_CLOCK_MONOTONIC ) - start;
+
+     if (engine == CGSE_SOFTWARE)
+          slot->fallbacks[index][fallback]++;
+
+     if (shared)
+          direct_mutex_unlock( &gfxstats_lock );
+}
+
+/**********************************************************************************************************************/
+
+unsigned long long
+dfb_gfxstats_rects_pixels( const DFBRectangle *rects,
+                           unsigned int        num,
+                           const DFBRegion    *clip )
+{
+     unsigned int       i;
+     unsigned long long pixels = 0;
+
+     for (i=0; i<num; i++) {
+          DFBRectangle rect = rects[i];
+
+          if (clip && !dfb_rectangle_intersect_by_region( &rect, clip ))
+               continue;
+
+          if (rect.w > 0 && rect.h > 0)
+               pixels += (unsigned long long) rect.w * rect.h;
+     }
+
+     return pixels;
+}
+
+unsigned long long
+dfb_gfxstats_lines_pixels( const DFBRegion    *lines,
+                           unsigned int        num )
+{
+     unsigned int       i;
+     unsigned long long pixels = 0;
+
+     for (i=0; i<num; i++)
+          pixels += MAX( ABS(lines[i].x2 - lines[i].x1), ABS(lines[i].y2 - lines[i].y1) ) + 1;
+
+     return pixels;
+}
+
+unsigned long long
+dfb_gfxstats_triangles_pixels( const DFBTriangle *tris,
+                               unsigned int       num )
+{
+     unsigned int       i;
+     unsigned long long pixels = 0;
+
+     for (i=0; i<num; i++) {
+          long long area = (long long) (tris[i].x2 - tris[i].x1) * (tris[i].y3 - tris[i].y1) -
+                           (long long) (tris[i].x3 - tris[i].x1) * (tris[i].y2 - tris[i].y1);
+
+          pixels += ABS(area) / 2;
+     }
+
+     return pixels;
+}
+
+unsigned long long
+dfb_gfxstats_trapezoids_pixels( const DFBTrapezoid *traps,
+                                unsigned int        num )
+{
+     unsigned int       i;
+     unsigned long long pixels = 0;
+
+     for (i=0; i<num; i++)
+          pixels += (unsigned long long) (traps[i].w1 + traps[i].w2) * ABS(traps[i].y2 - traps[i].y1) / 2;
+
+     return pixels;
+}
+
+unsigned long long
+dfb_gfxstats_spans_pixels( const DFBSpan *spans,
+                           unsigned int   num )
+{
+     unsigned int       i;
+     unsigned long long pixels = 0;
+
+     for (i=0; i<num; i++)
+          pixels += spans[i].w;
+
+     return pixels;
+}
+
+const char *
+dfb_gfxstats_fallback_name( CoreGfxStatsFallback fallback )
+{
+     switch (fallback) {
+          case CGFR_NONE:
+               return "none";
+          case CGFR_UNCHECKED:
+               return "unchecked";
+          case CGFR_NO_DRIVER:
+               return "no driver";
+          case CGFR_DISABLED:
+               return "disabled";
+          case CGFR_CHECKSTATE:
+               return "CheckState";
+          case CGFR_SYSTEMONLY:
+               return "system only";
+          case CGFR_RENDER_OPTIONS:
+               return "render options";
+          case CGFR_LOCK:
+               return "lock";
+          case CGFR_LIMITS:
+               return "limits";
+          default:
+               break;
+     }
+
+     return "unknown";
+}
+
+/**********************************************************************************************************************/
+
+DFBResult
+dfb_gfxstats_open( int                  pid,
+                   const CoreGfxStats **ret_stats )
+{
+     int           fd;
+     char          path[64];
+     struct stat   st;
+     CoreGfxStats *stats;
+
+     D_ASSERT( ret_stats != NULL );
+
+     snprintf( path, sizeof(path), DFB_GFXSTATS_PATH, pid );
+
+     fd = open( path, O_RDONLY | O_NOFOLLOW );
+     if (fd < 0)
+          return errno2result( errno );
+
+     /* Don't map beyond the end of a segment written by another version. */
+     if (fstat( fd, &st ) < 0 || st.st_size != sizeof(CoreGfxStats)) {
+          close( fd );
+          return DFB_VERSIONMISMATCH;
+     }
+
+     stats = mmap( NULL, sizeof(CoreGfxStats), PROT_READ, MAP_SHARED, fd, 0 );
+
+     close( fd );
+
+     if (stats == MAP_FAILED)
+          return DFB_FAILURE;
+
+     if (stats->magic != DFB_GFXSTATS_MAGIC || stats->version != DFB_GFXSTATS_VERSION ||
+         stats->size != sizeof(CoreGfxStats))
+     {
+          munmap( stats, sizeof(CoreGfxStats) );
+          return DFB_VERSIONMISMATCH;
+     }
+
+     *ret_stats = stats;
+
+     return DFB_OK;
+}
+
+void
+dfb_gfxstats_close( const CoreGfxStats *stats )
+{
+     D_ASSERT( stats != NULL );
+
+     munmap( (void*) stats, sizeof(CoreGfxStats) );
+}
+
+void
+dfb_gfxstats_merge( const CoreGfxStats *stats,
+                    CoreGfxStatsSlot   *ret_totals )
+{
+     int i, f, n;
+
+     D_ASSERT( stats != NULL );
+     D_ASSERT( ret_totals != NULL );
+
+     memset( ret_totals, 0, sizeof(CoreGfxStatsSlot) );
+
+     for (i=0; i<DFB_GFXSTATS_SLOTS; i++) {
+          const CoreGfxStatsSlot *slot = &stats->slots[i];
+
+          for (f=0; f<DFB_GFXSTATS_FUNCS; f++) {
+               for (n=0; n<_CGSE_NUM; n++) {
+                    ret_totals->funcs[f][n].operations += slot->funcs[f][n].operations;
+                    ret_totals->funcs[f][n].primitives += slot->funcs[f][n].primitives;
+                    ret_totals->funcs[f][n].pixels     += slot->funcs[f][n].pixels;
+                    ret_totals->funcs[f][n].time       += slot->funcs[f][n].time;
+               }
+
+               for (n=0; n<_CGFR_NUM; n++)
+                    ret_totals->fallbacks[f][n] += slot->fallbacks[f][n];
+          }
+     }
+}
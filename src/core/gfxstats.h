@@ -0,0 +1,177 @@
+/*
+   (c) Copyright 2012-2013  DirectFB integrated media GmbH
+   (c) Copyright 2001-2013  The world wide DirectFB Open Source Community (directfb.org)
+   (c) Copyright 2000-2004  Convergence (integrated media) GmbH
+
+   All rights reserved.
+
+   Written by Denis Oliver Kropp <dok@directfb.org>,
+              Andreas Shimokawa <andi@directfb.org>,
+              Marek Pikarski <mass@directfb.org>,
+              Sven Neumann <neo@directfb.org>,
+              Ville Syrjälä <syrjala@sci.fi> and
+              Claudio Ciccani <klan@users.sf.net>.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+
+
+
+#ifndef __CORE__GFXSTATS_H__
+#define __CORE__GFXSTATS_H__
+
+#include <direct/clock.h>
+
+#include <directfb.h>
+
+/*
+ * Per operation graphics statistics
+ *
+ * With "gfx-stats" each process records its graphics operations into a shared memory
+ * segment (DFB_GFXSTATS_PATH), which tools like dfbinspector can map and read at any
+ * time without stopping the process.
+ *
+ * Counters are indexed by the bit number of the DFXL_* function and by engine. Each thread
+ * claims a slot of counters that only it writes, so updates need no locking or atomics.
+ * Threads finding no free slot share the last one under a process local lock. Readers sum
+ * up all slots via dfb_gfxstats_merge() and may see counters being updated.
+ */
+
+#define DFB_GFXSTATS_PATH      "/dev/shm/directfb-gfxstats.%d"
+#define DFB_GFXSTATS_MAGIC     0x44464753     /* "DFGS" */
+#define DFB_GFXSTATS_VERSION   2
+
+#define DFB_GFXSTATS_FUNCS     32             /* one per bit of DFBAccelerationMask */
+#define DFB_GFXSTATS_SLOTS     16             /* counter sets, the last one shared */
+
+
+typedef enum {
+     CGSE_HARDWARE       = 0,      /* graphics driver or hardware engine */
+     CGSE_SOFTWARE       = 1,      /* Genefx */
+
+     _CGSE_NUM
+} CoreGfxStatsEngine;
+
+typedef enum {
+     CGFR_NONE           = 0,      /* accelerated */
+     CGFR_UNCHECKED,               /* no acceleration check done (yet) */
+     CGFR_NO_DRIVER,               /* no driver/engine providing acceleration */
+     CGFR_DISABLED,                /* disabled by configuration or temporarily for the state */
+     CGFR_CHECKSTATE,              /* rejected by CheckState of the driver/engine */
+     CGFR_SYSTEMONLY,              /* destination or source buffer is system memory only */
+     CGFR_RENDER_OPTIONS,          /* render options or transformation not supported */
+     CGFR_LOCK,                    /* buffers could not be locked for GPU access */
+     CGFR_LIMITS,                  /* rejected by the driver function or size limits */
+
+     _CGFR_NUM
+} CoreGfxStatsFallback;
+
+typedef struct {
+     u64                      operations;    /* calls */
+     u64                      primitives;    /* rectangles, lines, blits, ... */
+     u64                      pixels;        /* destination pixels (estimated for non rectangular primitives) */
+     u64                      time;          /* microseconds spent in the calling thread */
+} CoreGfxStatsCounters;
+
+typedef struct {
+     u32                      owner;         /* thread id of the writer, 0 if free */
+     u32                      reserved;
+
+     CoreGfxStatsCounters     funcs[DFB_GFXSTATS_FUNCS][_CGSE_NUM];
+     u64                      fallbacks[DFB_GFXSTATS_FUNCS][_CGFR_NUM];
+} CoreGfxStatsSlot;
+
+typedef struct {
+     u32                      magic;
+     u32                      version;
+     u32                      size;          /* sizeof(CoreGfxStats) */
+     s32                      pid;
+
+     char                     name[64];      /* process name */
+
+     s64                      ts_start;      /* monotonic time of creation in microseconds */
+
+     CoreGfxStatsSlot         slots[DFB_GFXSTATS_SLOTS];
+} CoreGfxStats;
+
+
+/*
+ * Segment of this process, NULL unless enabled via "gfx-stats".
+ */
+extern CoreGfxStats *dfb_gfxstats;
+
+
+DFBResult dfb_gfxstats_init  ( void );
+void      dfb_gfxstats_deinit( void );
+
+/*
+ * Returns start time for dfb_gfxstats_count(), or 0 if statistics are disabled.
+ */
+static __inline__ long long
+dfb_gfxstats_start( void )
+{
+     return dfb_gfxstats ? direct_clock_get_time( DIRECT_CLOCK_MONOTONIC ) : 0;
+}
+
+/*
+ * Account an operation of 'accel' (single DFXL_* function) executed by 'engine'.
+ */
+void dfb_gfxstats_count( DFBAccelerationMask    accel,
+                         CoreGfxStatsEngine     engine,
+                         CoreGfxStatsFallback   fallback,
+                         unsigned int           primitives,
+                         unsigned long long     pixels,
+                         long long              start );
+
+/*
+ * Pixel estimates of primitives within the clip.
+ */
+unsigned long long dfb_gfxstats_rects_pixels( const DFBRectangle *rects,
+                                              unsigned int        num,
+                                              const DFBRegion    *clip );
+
+unsigned long long dfb_gfxstats_lines_pixels( const DFBRegion    *lines,
+                                              unsigned int        num );
+
+unsigned long long dfb_gfxstats_triangles_pixels( const DFBTriangle *tris,
+                                                  unsigned int       num );
+
+unsigned long long dfb_gfxstats_trapezoids_pixels( const DFBTrapezoid *traps,
+                                                   unsigned int        num );
+
+unsigned long long dfb_gfxstats_spans_pixels( const DFBSpan *spans,
+                                              unsigned int   num );
+
+const char *dfb_gfxstats_fallback_name( CoreGfxStatsFallback fallback );
+
+
+/*
+ * Map the segment of another process read only.
+ */
+DFBResult dfb_gfxstats_open ( int                  pid,
+                              const CoreGfxStats **ret_stats );
+
+void      dfb_gfxstats_close( const CoreGfxStats  *stats );
+
+/*
+ * Sum up the counters of all slots.
+ */
+void      dfb_gfxstats_merge( const CoreGfxStats  *stats,
+                              CoreGfxStatsSlot    *ret_totals );
+
+#endif
+
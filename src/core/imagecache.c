@@ -0,0 +1,454 @@
+/*
+   (c) Copyright 2012-2013  DirectFB integrated media GmbH
+   (c) Copyright 2001-2013  The world wide DirectFB Open Source Community (directfb.org)
+   (c) Copyright 2000-2004  Convergence (integrated media) GmbH
+
+   All rights reserved.
+
+   Written by Denis Oliver Kropp <dok@directfb.org>,
+              Andreas Shimokawa <andi@directfb.org>,
+              Marek Pikarski <mass@directfb.org>,
+              Sven Neumann <neo@directfb.org>,
+              Ville Syrjälä <syrjala@sci.fi> and
+              Claudio Ciccani <klan@users.sf.net>.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+
+
+#include <config.h>
+
+#include <string.h>
+
+#include <directfb.h>
+
+#include <direct/debug.h>
+#include <direct/list.h>
+#include <direct/memcpy.h>
+
+#include <fusion/conf.h>
+#include <fusion/shmalloc.h>
+#include <fusion/vector.h>
+
+#include <core/core.h>
+#include <core/core_parts.h>
+#include <core/imagecache.h>
+#include <core/surface.h>
+#include <core/surface_buffer.h>
+#include <core/surface_allocation.h>
+
+#include <misc/conf.h>
+
+
+D_DEBUG_DOMAIN( Core_ImageCache, "Core/ImageCache", "DirectFB Decoded Image Cache" );
+
+/**********************************************************************************************************************/
+
+/*
+ * Decoded images are kept in shared surfaces, so every process of the session benefits. The encoded data is kept
+ * as well to tell images apart for sure, the hash is only used to skip most comparisons.
+ */
+
+typedef struct {
+     DirectLink              link;
+
+     int                     magic;
+
+     DFBImageCacheKey        key;
+     void                   *data;          /* copy of the encoded data */
+
+     CoreSurface            *surface;       /* global link */
+     size_t                  size;          /* surface allocations and encoded data */
+} ImageCacheEntry;
+
+typedef struct {
+     int                     magic;
+
+     FusionSkirmish          lock;
+     DirectLink             *entries;       /* most recently used first */
+     size_t                  size;
+     size_t                  limit;         /* "image-cache" of the master */
+
+     FusionSHMPoolShared    *shmpool;
+     FusionSHMPoolShared    *shmpool_data;
+} DFBImageCacheCoreShared;
+
+struct __DFB_DFBImageCacheCore {
+     int                      magic;
+
+     CoreDFB                 *core;
+
+     DFBImageCacheCoreShared *shared;
+
+     CoreCleanup             *cleanup;      /* master only */
+};
+
+
+DFB_CORE_PART( imagecache_core, ImageCacheCore );
+
+/**********************************************************************************************************************/
+
+static void
+image_cache_remove( DFBImageCacheCoreShared *shared,
+                    ImageCacheEntry         *entry,
+                    bool                     unlink )
+{
+     D_MAGIC_ASSERT( entry, ImageCacheEntry );
+
+     D_DEBUG_AT( Core_ImageCache, "  -> removing %dx%d %s (%zu bytes)\n",
+                 entry->key.width, entry->key.height, dfb_pixelformat_name( entry->key.format ), entry->size );
+
+     direct_list_remove( &shared->entries, &entry->link );
+
+     shared->size -= entry->size;
+
+     /* The surface pools are gone already when called at shutdown after an emergency. */
+     if (unlink)
+          dfb_surface_unlink( &entry->surface );
+
+     SHFREE( shared->shmpool_data, entry->data );
+
+     D_MAGIC_CLEAR( entry );
+
+     SHFREE( shared->shmpool, entry );
+}
+
+static void
+image_cache_flush( void *ctx,
+                   int   emergency )
+{
+     DFBImageCacheCore       *data = ctx;
+     DFBImageCacheCoreShared *shared;
+     ImageCacheEntry         *entry, *next;
+
+     D_DEBUG_AT( Core_ImageCache, "%s()\n", __FUNCTION__ );
+
+     D_MAGIC_ASSERT( data, DFBImageCacheCore );
+
+     shared = data->shared;
+
+     D_MAGIC_ASSERT( shared, DFBImageCacheCoreShared );
+
+     data->cleanup = NULL;
+
+     /* Registered for emergencies as well only to know that it is gone, see shutdown. */
+     if (emergency)
+          return;
+
+     if (fusion_skirmish_prevail( &shared->lock ))
+          return;
+
+     direct_list_foreach_safe (entry, next, shared->entries)
+          image_cache_remove( shared, entry, true );
+
+     fusion_skirmish_dismiss( &shared->lock );
+}
+
+static bool
+image_cache_key_equal( const DFBImageCacheKey *a,
+                       const DFBImageCacheKey *b )
+{
+     return a->hash       == b->hash       &&
+            a->length     == b->length     &&
+            a->width      == b->width      &&
+            a->height     == b->height     &&
+            a->format     == b->format     &&
+            a->colorspace == b->colorspace &&
+            a->caps       == b->caps       &&
+            a->flags      == b->flags      &&
+            DFB_RECTANGLE_EQUAL( a->source, b->source );
+}
+
+/* Called with the lock held. */
+static ImageCacheEntry *
+image_cache_find( DFBImageCacheCoreShared *shared,
+                  const DFBImageCacheKey  *key,
+                  const void              *data )
+{
+     ImageCacheEntry *entry;
+
+     direct_list_foreach (entry, shared->entries) {
+          D_MAGIC_ASSERT( entry, ImageCacheEntry );
+
+          if (image_cache_key_equal( &entry->key, key ) && !memcmp( entry->data, data, key->length )) {
+               /* Move to the front. */
+               direct_list_move_to_front( &shared->entries, &entry->link );
+
+               return entry;
+          }
+     }
+
+     return NULL;
+}
+
+/*
+ * Returns the memory used by the allocations of the surface, which includes the pitch of each pool.
+ */
+static size_t
+image_cache_surface_size( CoreSurface *surface )
+{
+     size_t                 size = 0;
+     int                    i, n;
+     CoreSurfaceAllocation *allocation;
+
+     if (dfb_surface_lock( surface ))
+          return 0;
+
+     for (i = 0; i < surface->num_buffers; i++) {
+          fusion_vector_foreach (allocation, n, surface->buffers[i]->allocs)
+               size += allocation->size;
+     }
+
+     dfb_surface_unlock( surface );
+
+     return size;
+}
+
+/**********************************************************************************************************************/
+
+static DFBResult
+dfb_imagecache_core_initialize( CoreDFB                 *core,
+                                DFBImageCacheCore       *data,
+                                DFBImageCacheCoreShared *shared )
+{
+     D_DEBUG_AT( Core_ImageCache, "dfb_imagecache_core_initialize( %p, %p, %p )\n", core, data, shared );
+
+     D_ASSERT( data != NULL );
+     D_ASSERT( shared != NULL );
+
+     data->core   = core;
+     data->shared = shared;
+
+     shared->shmpool      = dfb_core_shmpool( core );
+     shared->shmpool_data = dfb_core_shmpool_data( core );
+     shared->limit        = dfb_config->image_cache;
+
+     fusion_skirmish_init2( &shared->lock, "Image Cache Core", dfb_core_world(core), fusion_config->secure_fusion );
+
+     /* Release the surfaces before the core waits for all objects to be gone. */
+     data->cleanup = dfb_core_cleanup_add( core, image_cache_flush, data, true );
+
+     D_MAGIC_SET( data, DFBImageCacheCore );
+     D_MAGIC_SET( shared, DFBImageCacheCoreShared );
+
+     return DFB_OK;
+}
+
+static DFBResult
+dfb_imagecache_core_join( CoreDFB                 *core,
+                          DFBImageCacheCore       *data,
+                          DFBImageCacheCoreShared *shared )
+{
+     D_DEBUG_AT( Core_ImageCache, "dfb_imagecache_core_join( %p, %p, %p )\n", core, data, shared );
+
+     D_ASSERT( data != NULL );
+     D_MAGIC_ASSERT( shared, DFBImageCacheCoreShared );
+
+     data->core   = core;
+     data->shared = shared;
+
+     D_MAGIC_SET( data, DFBImageCacheCore );
+
+     return DFB_OK;
+}
+
+static DFBResult
+dfb_imagecache_core_shutdown( DFBImageCacheCore *data,
+                              bool               emergency )
+{
+     DFBImageCacheCoreShared *shared;
+     ImageCacheEntry         *entry, *next;
+
+     D_DEBUG_AT( Core_ImageCache, "dfb_imagecache_core_shutdown( %p, %semergency )\n", data, emergency ? "" : "no " );
+
+     D_MAGIC_ASSERT( data, DFBImageCacheCore );
+
+     shared = data->shared;
+
+     D_MAGIC_ASSERT( shared, DFBImageCacheCoreShared );
+
+     if (data->cleanup)
+          dfb_core_cleanup_remove( data->core, data->cleanup );
+
+     direct_list_foreach_safe (entry, next, shared->entries)
+          image_cache_remove( shared, entry, false );
+
+     fusion_skirmish_destroy( &shared->lock );
+
+     D_MAGIC_CLEAR( data );
+     D_MAGIC_CLEAR( shared );
+
+     return DFB_OK;
+}
+
+static DFBResult
+dfb_imagecache_core_leave( DFBImageCacheCore *data,
+                           bool               emergency )
+{
+     D_DEBUG_AT( Core_ImageCache, "dfb_imagecache_core_leave( %p, %semergency )\n", data, emergency ? "" : "no " );
+
+     D_MAGIC_ASSERT( data, DFBImageCacheCore );
+     D_MAGIC_ASSERT( data->shared, DFBImageCacheCoreShared );
+
+     D_MAGIC_CLEAR( data );
+
+     return DFB_OK;
+}
+
+static DFBResult
+dfb_imagecache_core_suspend( DFBImageCacheCore *data )
+{
+     D_DEBUG_AT( Core_ImageCache, "dfb_imagecache_core_suspend( %p )\n", data );
+
+     D_MAGIC_ASSERT( data, DFBImageCacheCore );
+     D_MAGIC_ASSERT( data->shared, DFBImageCacheCoreShared );
+
+     return DFB_OK;
+}
+
+static DFBResult
+dfb_imagecache_core_resume( DFBImageCacheCore *data )
+{
+     D_DEBUG_AT( Core_ImageCache, "dfb_imagecache_core_resume( %p )\n", data );
+
+     D_MAGIC_ASSERT( data, DFBImageCacheCore );
+     D_MAGIC_ASSERT( data->shared, DFBImageCacheCoreShared );
+
+     return DFB_OK;
+}
+
+/**********************************************************************************************************************/
+
+DFBResult
+dfb_image_cache_lookup( DFBImageCacheCore       *core,
+                        const DFBImageCacheKey  *key,
+                        const void              *data,
+                        CoreSurface            **ret_surface )
+{
+     DFBResult                ret = DFB_ITEMNOTFOUND;
+     DFBImageCacheCoreShared *shared;
+     ImageCacheEntry         *entry;
+
+     D_MAGIC_ASSERT( core, DFBImageCacheCore );
+     D_ASSERT( key != NULL );
+     D_ASSERT( data != NULL );
+     D_ASSERT( ret_surface != NULL );
+
+     shared = core->shared;
+
+     D_MAGIC_ASSERT( shared, DFBImageCacheCoreShared );
+
+     if (fusion_skirmish_prevail( &shared->lock ))
+          return DFB_FUSION;
+
+     entry = image_cache_find( shared, key, data );
+     if (entry) {
+          ret = dfb_surface_ref( entry->surface );
+          if (ret == DFB_OK)
+               *ret_surface = entry->surface;
+     }
+
+     fusion_skirmish_dismiss( &shared->lock );
+
+     return ret;
+}
+
+DFBResult
+dfb_image_cache_insert( DFBImageCacheCore      *core,
+                        const DFBImageCacheKey *key,
+                        const void             *data,
+                        CoreSurface            *surface )
+{
+     DFBResult                ret;
+     DFBImageCacheCoreShared *shared;
+     ImageCacheEntry         *entry;
+     size_t                   size;
+
+     D_MAGIC_ASSERT( core, DFBImageCacheCore );
+     D_ASSERT( key != NULL );
+     D_ASSERT( data != NULL );
+     D_MAGIC_ASSERT( surface, CoreSurface );
+
+     shared = core->shared;
+
+     D_MAGIC_ASSERT( shared, DFBImageCacheCoreShared );
+
+     size = image_cache_surface_size( surface );
+     if (!size)
+          return DFB_UNSUPPORTED;
+
+     size += key->length;
+
+     if (size > shared->limit)
+          return DFB_LIMITEXCEEDED;
+
+     entry = SHCALLOC( shared->shmpool, 1, sizeof(ImageCacheEntry) );
+     if (!entry)
+          return D_OOSHM();
+
+     entry->data = SHMALLOC( shared->shmpool_data, key->length );
+     if (!entry->data) {
+          SHFREE( shared->shmpool, entry );
+          return D_OOSHM();
+     }
+
+     direct_memcpy( entry->data, data, key->length );
+
+     entry->key  = *key;
+     entry->size = size;
+
+     if (fusion_skirmish_prevail( &shared->lock )) {
+          ret = DFB_FUSION;
+          goto error;
+     }
+
+     /* Another process or thread might have been faster. */
+     if (image_cache_find( shared, key, data )) {
+          ret = DFB_OK;
+          goto error_locked;
+     }
+
+     ret = dfb_surface_link( &entry->surface, surface );
+     if (ret)
+          goto error_locked;
+
+     while (shared->entries && shared->size + size > shared->limit)
+          image_cache_remove( shared, (ImageCacheEntry*) direct_list_get_last( shared->entries ), true );
+
+     D_MAGIC_SET( entry, ImageCacheEntry );
+
+     direct_list_prepend( &shared->entries, &entry->link );
+
+     shared->size += size;
+
+     D_DEBUG_AT( Core_ImageCache, "  -> added %dx%d %s (%zu bytes, total %zu)\n",
+                 key->width, key->height, dfb_pixelformat_name( key->format ), size, shared->size );
+
+     fusion_skirmish_dismiss( &shared->lock );
+
+     return DFB_OK;
+
+
+error_locked:
+     fusion_skirmish_dismiss( &shared->lock );
+
+error:
+     SHFREE( shared->shmpool_data, entry->data );
+     SHFREE( shared->shmpool, entry );
+
+     return ret;
+}
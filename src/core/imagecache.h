@@ -0,0 +1,75 @@
+/*
+   (c) Copyright 2012-2013  DirectFB integrated media GmbH
+   (c) Copyright 2001-2013  The world wide DirectFB Open Source Community (directfb.org)
+   (c) Copyright 2000-2004  Convergence (integrated media) GmbH
+
+   All rights reserved.
+
+   Written by Denis Oliver Kropp <dok@directfb.org>,
+              Andreas Shimokawa <andi@directfb.org>,
+              Marek Pikarski <mass@directfb.org>,
+              Sven Neumann <neo@directfb.org>,
+              Ville Syrjälä <syrjala@sci.fi> and
+              Claudio Ciccani <klan@users.sf.net>.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+
+
+#ifndef __CORE__IMAGECACHE_H__
+#define __CORE__IMAGECACHE_H__
+
+#include <directfb.h>
+
+#include <core/coretypes.h>
+
+
+/*
+ * Identifies a decoded image. All fields are compared, the encoded data as well.
+ */
+typedef struct {
+     u64                    hash;        /* of the encoded data */
+     unsigned int           length;      /* of the encoded data */
+
+     int                    width;
+     int                    height;
+     DFBSurfacePixelFormat  format;
+     DFBSurfaceColorSpace   colorspace;
+     DFBSurfaceCapabilities caps;        /* only DSCAPS_PREMULTIPLIED */
+     DFBRectangle           source;      /* zero size means the whole image */
+     DIRenderFlags          flags;
+} DFBImageCacheKey;
+
+
+/*
+ * Returns a locally referenced surface with the decoded image or DFB_ITEMNOTFOUND.
+ */
+DFBResult dfb_image_cache_lookup( DFBImageCacheCore       *core,
+                                  const DFBImageCacheKey  *key,
+                                  const void              *data,
+                                  CoreSurface            **ret_surface );
+
+/*
+ * Adds the surface and a copy of the encoded data, evicting the least recently used
+ * images to stay within the "image-cache" budget of the master.
+ */
+DFBResult dfb_image_cache_insert( DFBImageCacheCore      *core,
+                                  const DFBImageCacheKey *key,
+                                  const void             *data,
+                                  CoreSurface            *surface );
+
+#endif
@@ -79,6 +79,7 @@
 #include <direct/memcpy.h>
 #include <direct/messages.h>
 #include <direct/modules.h>
+#include <direct/startup.h>
 #include <direct/trace.h>
 
 #include <fusion/build.h>
@@ -1410,6 +1411,7 @@ init_devices( CoreDFB *core )
           const InputDriverFuncs *funcs;
           InputDriverCapability   driver_cap;
           DFBResult               result;
+          DirectStartupSpan       span;
 
           driver_cap = IDC_NONE;
 
@@ -1430,8 +1432,12 @@ init_devices( CoreDFB *core )
 
           D_DEBUG_AT( Core_Input, "  -> probing '%s'...\n", driver->info.name );
 
+          direct_startup_begin( &span );
+
           driver->nr_devices = funcs->GetAvailable();
 
+          direct_startup_end( &span, "input", "%s probe", driver->info.name );
+
           /*
            * If the input provider supports hot-plug, always load the module.
            */
@@ -1486,6 +1492,8 @@ init_devices( CoreDFB *core )
 
                D_MAGIC_SET( device, CoreInputDevice );
 
+               direct_startup_begin( &span );
+
                if (funcs->OpenDevice( device, n, &device_info, &driver_data )) {
                     SHFREE( pool, shared );
                     D_MAGIC_CLEAR( device );
@@ -1493,6 +1501,8 @@ init_devices( CoreDFB *core )
                     continue;
                }
 
+               direct_startup_end( &span, "input", "%s (%d)", device_info.desc.name, n + 1 );
+
                D_DEBUG_AT( Core_Input, "  -> opened '%s' (%d) %d.%d (%s)\n",
                            device_info.desc.name, n + 1, driver->info.version.major,
                            driver->info.version.minor, driver->info.vendor );
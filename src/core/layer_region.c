@@ -394,7 +394,6 @@ dfb_layer_region_set_surface( CoreLayerRegion *region,
      D_DEBUG_AT( Core_Layers, "%s( %p, %p, %d )\n", __FUNCTION__, region, surface, update );
 
      D_ASSERT( region != NULL );
-     D_ASSERT( surface != NULL );
 
      if (region->display_tasks)
           TaskList_WaitEmpty( region->display_tasks );
@@ -406,6 +405,12 @@ dfb_layer_region_set_surface( CoreLayerRegion *region,
      if (region->surface != surface) {
           /* Setup hardware for the new surface if the region is realized. */
           if (D_FLAGS_IS_SET( region->state, CLRSF_REALIZED )) {
+               /* Only a region not shown can be left without a surface. */
+               if (!surface) {
+                    dfb_layer_region_unlock( region );
+                    return DFB_BUSY;
+               }
+
                ret = dfb_layer_region_set( region, &region->config, CLRCF_SURFACE | CLRCF_PALETTE, surface );
                if (ret) {
                     dfb_layer_region_unlock( region );
@@ -497,6 +502,75 @@ dfb_layer_region_get_surface( CoreLayerRegion  *region,
      return DFB_OK;
 }
 
+static void
+region_add_damage( CoreLayerRegion *region,
+                   CoreSurface     *surface,
+                   const DFBRegion *update )
+{
+     CoreLayerRegionDamage *damage = &region->damage[surface->presents % CORE_LAYER_REGION_DAMAGE_HISTORY];
+
+     damage->frame = surface->presents;
+
+     if (update)
+          damage->region = *update;
+     else
+          damage->region = DFB_REGION_INIT_FROM_RECTANGLE_VALS( 0, 0, surface->config.size.w, surface->config.size.h );
+}
+
+DFBResult
+dfb_layer_region_get_damage( CoreLayerRegion *region,
+                             DFBUpdates      *updates )
+{
+     DFBResult     ret = DFB_OK;
+     unsigned int  i;
+     unsigned int  age;
+     CoreSurface  *surface;
+
+     D_ASSERT( region != NULL );
+     D_ASSERT( updates != NULL );
+
+     /* Lock the region. */
+     if (dfb_layer_region_lock( region ))
+          return DFB_FUSION;
+
+     surface = region->surface;
+     if (!surface) {
+          dfb_layer_region_unlock( region );
+          return DFB_UNSUPPORTED;
+     }
+
+     dfb_surface_lock( surface );
+
+     age = dfb_surface_get_buffer_age( surface, CSBR_BACK, DSSE_LEFT );
+
+     D_DEBUG_AT( Core_Layers, "%s( %p ) <- back buffer age %u\n", __FUNCTION__, region, age );
+
+     if (!age || age > CORE_LAYER_REGION_DAMAGE_HISTORY + 1)
+          ret = DFB_ITEMNOTFOUND;
+     else {
+          /* Frames shown after the back buffer. */
+          for (i=0; i<age-1; i++) {
+               u32                          frame  = surface->presents - i;
+               const CoreLayerRegionDamage *damage = &region->damage[frame % CORE_LAYER_REGION_DAMAGE_HISTORY];
+
+               if (damage->frame != frame) {
+                    ret = DFB_ITEMNOTFOUND;
+                    break;
+               }
+
+               D_DEBUG_AT( Core_Layers, "  -> frame %u: %4d,%4d-%4dx%4d\n", frame, DFB_RECTANGLE_VALS_FROM_REGION( &damage->region ) );
+
+               dfb_updates_add( updates, &damage->region );
+          }
+     }
+
+     dfb_surface_unlock( surface );
+
+     dfb_layer_region_unlock( region );
+
+     return ret;
+}
+
 DFBResult
 dfb_layer_region_flip_update( CoreLayerRegion     *region,
                               const DFBRegion     *update,
@@ -508,6 +582,7 @@ dfb_layer_region_flip_update( CoreLayerRegion     *region,
      CoreLayer               *layer;
      CoreSurface             *surface;
      const DisplayLayerFuncs *funcs;
+     u32                      presents;
 
      if (dfb_config->task_manager)
           return dfb_layer_region_flip_update2( region, update, update, flags, region->surface->flips, -1, NULL );
@@ -582,6 +657,8 @@ dfb_layer_region_flip_update( CoreLayerRegion     *region,
      if (!(surface->frametime_config.flags & DFTCF_INTERVAL))
           dfb_screen_get_frame_interval( layer->screen, &surface->frametime_config.interval );
 
+     presents = surface->presents;
+
      if (flags & DSFLIP_UPDATE)
           goto update_only;
 
@@ -654,6 +731,8 @@ dfb_layer_region_flip_update( CoreLayerRegion     *region,
                /* ...or copy updated contents from back to front buffer. */
                dfb_back_to_front_copy_rotation( surface, update, surface->rotation );
 
+               dfb_surface_mark_presented( surface );
+
                if ((flags & DSFLIP_WAITFORSYNC) == DSFLIP_WAIT) {
                     D_DEBUG_AT( Core_Layers, "  -> Waiting for VSync...\n" );
 
@@ -717,6 +796,10 @@ update_only:
 
      //dfb_surface_dispatch_update( surface, update, update, -1 );
 
+     /* Remember the damage of a new frame for dfb_layer_region_get_damage(). */
+     if (surface->presents != presents)
+          region_add_damage( region, surface, update );
+
      D_DEBUG_AT( Core_Layers, "  -> done.\n" );
 
 out:
@@ -887,6 +970,8 @@ dfb_layer_region_flip_update_stereo( CoreLayerRegion     *region,
 
                dfb_back_to_front_copy_stereo( surface, eyes, left_update, right_update, surface->rotation );
 
+               dfb_surface_mark_presented( surface );
+
                if ((flags & DSFLIP_WAITFORSYNC) == DSFLIP_WAIT) {
                     D_DEBUG_AT( Core_Layers, "  -> Waiting for VSync...\n" );
 
@@ -34,6 +34,7 @@
 #define __CORE__LAYER_REGION_H__
 
 #include <directfb.h>
+#include <directfb_util.h>
 
 #include <core/coretypes.h>
 #include <core/layers.h>
@@ -90,6 +91,15 @@ dfb_layer_region_flip_update_stereo     ( CoreLayerRegion      *region,
                                           DFBSurfaceFlipFlags   flags );
 
 
+/*
+ * Adds the damage of all frames shown since the back buffer was last shown to 'updates',
+ * i.e. what needs to be repainted in addition to new updates instead of copying back.
+ *
+ * Returns DFB_ITEMNOTFOUND if the back buffer is undefined or older than the recorded history.
+ */
+DFBResult dfb_layer_region_get_damage    ( CoreLayerRegion      *region,
+                                           DFBUpdates           *updates );
+
 DFBResult dfb_layer_region_flip_update2  ( CoreLayerRegion      *region,
                                            const DFBRegion      *left_update,
                                            const DFBRegion      *right_update,
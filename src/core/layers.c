@@ -43,6 +43,7 @@
 #include <direct/mem.h>
 #include <direct/memcpy.h>
 #include <direct/messages.h>
+#include <direct/startup.h>
 
 #include <fusion/conf.h>
 #include <fusion/shmalloc.h>
@@ -115,6 +116,7 @@ dfb_layer_core_initialize( CoreDFB            *core,
      int                  i;
      DFBResult            ret;
      FusionSHMPoolShared *pool;
+     DirectStartupSpan    span;
 
      D_DEBUG_AT( Core_Layer, "dfb_layer_core_initialize( %p, %p, %p )\n", core, data, shared );
 
@@ -161,12 +163,17 @@ dfb_layer_core_initialize( CoreDFB            *core,
 
           /* Initialize the layer, get the layer description,
              the default configuration and default color adjustment. */
+          direct_startup_begin( &span );
+
           ret = funcs->InitLayer( layer,
                                   layer->driver_data,
                                   lshared->layer_data,
                                   &lshared->description,
                                   &lshared->default_config,
                                   &lshared->default_adjustment );
+
+          direct_startup_end( &span, "layer", "%s", buf );
+
           if (ret) {
                D_DERROR( ret, "DirectFB/Core/layers: "
                          "Failed to initialize layer %d!\n", lshared->layer_id );
@@ -173,6 +173,13 @@ typedef enum {
      CLRSF_ALL        = 0x0000001F
 } CoreLayerRegionStateFlags;
 
+#define CORE_LAYER_REGION_DAMAGE_HISTORY   4
+
+typedef struct {
+     u32                         frame;      /* Value of surface->presents after showing the frame, 0 if unused. */
+     DFBRegion                   region;     /* Area changed by the frame. */
+} CoreLayerRegionDamage;
+
 struct __DFB_CoreLayerRegion {
      FusionObject                object;
 
@@ -199,6 +206,8 @@ struct __DFB_CoreLayerRegion {
      DFB_DisplayTaskListLocked  *display_tasks;
 
      DFBDisplayLayerID           layer_id;
+
+     CoreLayerRegionDamage       damage[CORE_LAYER_REGION_DAMAGE_HISTORY];    /* Ring indexed by frame */
 };
 
 
@@ -44,6 +44,7 @@
 #include <core/coredefs.h>
 #include <core/coretypes.h>
 #include <core/gfxcard.h>
+#include <core/gfxstats.h>
 #include <core/surface_buffer.h>
 
 #include <gfx/generic/generic.h>
@@ -159,6 +160,7 @@ struct _CardState {
      DFBAccelerationMask      checked;       /* commands for which a state has been checked */
      DFBAccelerationMask      set;           /* commands for which a state is valid */
      DFBAccelerationMask      disabled;      /* commands which are disabled temporarily */
+     CoreGfxStatsFallback     fallback;      /* reason why the last checked command is not accelerated */
 
      CoreGraphicsSerial       serial;        /* hardware serial of the last operation */
 
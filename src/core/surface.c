@@ -669,6 +669,8 @@ dfb_surface_flip_buffers( CoreSurface *surface, bool swap )
 
      D_DEBUG_AT( Core_Surface, "  -> flips %d <-----------------\n", surface->flips );
 
+     dfb_surface_mark_presented( surface );
+
      // FIXME: cleanup, only used by desktop background via primary surface,
      // make it use surface client
      dfb_surface_notify( surface, CSNF_FLIP );
@@ -676,6 +678,54 @@ dfb_surface_flip_buffers( CoreSurface *surface, bool swap )
      return DFB_OK;
 }
 
+void
+dfb_surface_mark_presented( CoreSurface *surface )
+{
+     int index;
+
+     D_MAGIC_ASSERT( surface, CoreSurface );
+
+     FUSION_SKIRMISH_ASSERT( &surface->lock );
+
+     if (surface->num_buffers == 0)
+          return;
+
+     /* Zero is reserved for buffers never shown. */
+     if (!++surface->presents)
+          surface->presents = 1;
+
+     index = surface->buffer_indices[(surface->flips + CSBR_FRONT) % surface->num_buffers];
+
+     if (surface->left_buffers[index])
+          surface->left_buffers[index]->presented = surface->presents;
+
+     if (surface->right_buffers[index])
+          surface->right_buffers[index]->presented = surface->presents;
+
+     D_DEBUG_AT( Core_Surface, "%s( %p ) <- presents %u, front index %d\n", __FUNCTION__, surface, surface->presents, index );
+}
+
+unsigned int
+dfb_surface_get_buffer_age( CoreSurface           *surface,
+                            CoreSurfaceBufferRole  role,
+                            DFBSurfaceStereoEye    eye )
+{
+     CoreSurfaceBuffer *buffer;
+
+     D_MAGIC_ASSERT( surface, CoreSurface );
+
+     FUSION_SKIRMISH_ASSERT( &surface->lock );
+
+     if (surface->num_buffers == 0)
+          return 0;
+
+     buffer = dfb_surface_get_buffer2( surface, role, eye );
+     if (!buffer || !buffer->presented)
+          return 0;
+
+     return surface->presents - buffer->presented + 1;
+}
+
 DFBResult
 dfb_surface_dispatch_event( CoreSurface         *surface,
                             DFBSurfaceEventType  type )
@@ -837,6 +887,9 @@ dfb_surface_reconfig( CoreSurface             *surface,
      if (ret)
           return ret;
 
+     /* New buffers have no age, also let users of the frame counter see the change. */
+     surface->presents++;
+
      /* Destroy the Surface Buffers. */
      num_eyes = surface->config.caps & DSCAPS_STEREO ? 2 : 1;
      for (eye=DSSE_LEFT; num_eyes>0; num_eyes--, eye=DSSE_RIGHT) {
@@ -1628,11 +1681,12 @@ dfb_surface_dump_buffer2( CoreSurface           *surface,
                     }
                }
                else
-                    dfb_convert_to_rgb24( lock.buffer->format,
-                                          srces[0], pitches[0],
-                                          srces[1], pitches[1], srces[2], pitches[2],
-                                          surface->config.size.h,
-                                          buf_p, surface->config.size.w * 3, surface->config.size.w, 1 );
+                    dfb_convert_to_rgb24_colorspace( lock.buffer->format,
+                                                     srces[0], pitches[0],
+                                                     srces[1], pitches[1], srces[2], pitches[2],
+                                                     surface->config.size.h,
+                                                     buf_p, surface->config.size.w * 3, surface->config.size.w, 1,
+                                                     surface->config.colorspace );
 #ifdef USE_ZLIB
                gzwrite( gz_p, buf_p, surface->config.size.w * 3 );
 #else
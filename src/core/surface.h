@@ -246,6 +246,7 @@ struct __DFB_CoreSurface
      int                      buffer_indices[MAX_SURFACE_BUFFERS];
 
      u32                      flips;
+     u32                      presents;      /* Counts frames shown by flipping or copying to the front buffer. */
 
      CorePalette             *palette;
      GlobalReaction           palette_reaction;
@@ -333,6 +334,19 @@ DFBResult dfb_surface_flip          ( CoreSurface                  *surface,
 DFBResult dfb_surface_flip_buffers  ( CoreSurface                  *surface,
                                       bool                          swap );
 
+/*
+ * Stamps the current front buffer(s) as shown, called after flipping or copying to the front.
+ */
+void      dfb_surface_mark_presented( CoreSurface                  *surface );
+
+/*
+ * Returns the number of frames since the buffer's content was shown, 1 meaning that it holds
+ * the content of the current front buffer, or 0 if its content is undefined (never shown).
+ */
+unsigned int dfb_surface_get_buffer_age( CoreSurface               *surface,
+                                         CoreSurfaceBufferRole      role,
+                                         DFBSurfaceStereoEye        eye );
+
 DFBResult dfb_surface_dispatch_event( CoreSurface                  *surface,
                                       DFBSurfaceEventType           type );
 
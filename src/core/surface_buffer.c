@@ -927,11 +927,12 @@ dfb_surface_buffer_dump_type_locked2( CoreSurfaceBuffer     *buffer,
                         }
                    }
                    else
-                        dfb_convert_to_argb( buffer->format,
-                                             srces[0], pitches[0],
-                                             srces[1], pitches[1], srces[2], pitches[2],
-                                             surface->config.size.h,
-                                             (u32 *)(&buf_p[0]), surface->config.size.w * 4, surface->config.size.w, 1 );
+                        dfb_convert_to_argb_colorspace( buffer->format,
+                                                        srces[0], pitches[0],
+                                                        srces[1], pitches[1], srces[2], pitches[2],
+                                                        surface->config.size.h,
+                                                        (u32 *)(&buf_p[0]), surface->config.size.w * 4, surface->config.size.w, 1,
+                                                        surface->config.colorspace );
 #ifdef USE_ZLIB
                    gzwrite( gz_p, buf_p, surface->config.size.w * 4 );
 #else
@@ -950,11 +951,12 @@ dfb_surface_buffer_dump_type_locked2( CoreSurfaceBuffer     *buffer,
                     }
                }
                else
-                    dfb_convert_to_rgb24( buffer->format,
-                                          srces[0], pitches[0],
-                                          srces[1], pitches[1], srces[2], pitches[2],
-                                          surface->config.size.h,
-                                          buf_p, surface->config.size.w * 3, surface->config.size.w, 1 );
+                    dfb_convert_to_rgb24_colorspace( buffer->format,
+                                                     srces[0], pitches[0],
+                                                     srces[1], pitches[1], srces[2], pitches[2],
+                                                     surface->config.size.h,
+                                                     buf_p, surface->config.size.w * 3, surface->config.size.w, 1,
+                                                     surface->config.colorspace );
 #ifdef USE_ZLIB
                gzwrite( gz_p, buf_p, surface->config.size.w * 3 );
 #else
@@ -169,6 +169,8 @@ struct __DFB_CoreSurfaceBuffer {
      unsigned long            resource_id;   /* layer id, window id, or user specified */
      
      int                      index;
+
+     u32                      presented;     /* Value of surface->presents when last shown, 0 if never. */
 };
 
 #define CORE_SURFACE_BUFFER_ASSERT(buffer)                                                     \
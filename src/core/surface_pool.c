@@ -36,6 +36,7 @@
 
 #include <direct/debug.h>
 #include <direct/mem.h>
+#include <direct/startup.h>
 
 #include <fusion/conf.h>
 #include <fusion/shmalloc.h>
@@ -1351,7 +1352,8 @@ init_pool( CoreDFB                *core,
            const SurfacePoolFuncs *funcs,
            void                   *ctx )
 {
-     DFBResult ret;
+     DFBResult         ret;
+     DirectStartupSpan span;
 
      D_MAGIC_ASSERT( pool, CoreSurfacePool );
      D_ASSERT( funcs != NULL );
@@ -1385,7 +1387,12 @@ init_pool( CoreDFB                *core,
 
      fusion_vector_init( &pool->allocs, 4, pool->shmpool );
 
+     direct_startup_begin( &span );
+
      ret = funcs->InitPool( core, pool, pool->data, get_local(pool), ctx, &pool->desc );
+
+     direct_startup_end( &span, "pool", "%s", pool->desc.name );
+
      if (ret) {
           D_DERROR( ret, "Core/SurfacePool: Initializing '%s' failed!\n", pool->desc.name );
 
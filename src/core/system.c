@@ -260,15 +260,30 @@ DFBResult
 dfb_system_lookup( void )
 {
      DirectLink *l;
+     const char *only = NULL;
 
      D_DEBUG_AT( Core_System, "%p()\n", __FUNCTION__ );
 
      direct_modules_explore_directory( &dfb_core_systems );
 
+     /* Modules known by name are loaded on demand, skip others if the configured one is available. */
+     if (dfb_config->system) {
+          direct_list_foreach( l, dfb_core_systems.entries ) {
+               DirectModuleEntry *module = (DirectModuleEntry*) l;
+
+               if (!module->disabled && module->name && !strcasecmp( dfb_config->system, module->name ))
+                    only = dfb_config->system;
+          }
+     }
+
+retry:
      direct_list_foreach( l, dfb_core_systems.entries ) {
           DirectModuleEntry     *module = (DirectModuleEntry*) l;
           const CoreSystemFuncs *funcs;
 
+          if (only && !module->loaded && (!module->name || strcasecmp( only, module->name )))
+               continue;
+
           D_DEBUG_AT( Core_System, "module %p\n", module );
           D_DEBUG_AT( Core_System, "  name    '%s'\n", module->name );
           D_DEBUG_AT( Core_System, "  refs     %d\n", module->refs );
@@ -298,6 +313,12 @@ dfb_system_lookup( void )
                direct_module_unref( module );
      }
 
+     /* The configured system failed to load, fall back to any. */
+     if (!system_module && only) {
+          only = NULL;
+          goto retry;
+     }
+
      if (!system_module) {
           D_ERROR("DirectFB/core/system: No system found!\n");
 
@@ -489,6 +489,10 @@ load_module( const char *name )
           DirectModuleEntry *module = (DirectModuleEntry*) l;
           const CoreWMFuncs *funcs;
 
+          /* Don't load other modules if the name is known without loading, e.g. from the manifest. */
+          if (name && !module->loaded && module->name && strcasecmp( name, module->name ))
+               continue;
+
           funcs = direct_module_ref( module );
           if (!funcs)
                continue;
@@ -42,6 +42,7 @@
 #include <direct/log.h>
 #include <direct/mem.h>
 #include <direct/messages.h>
+#include <direct/startup.h>
 #include <direct/util.h>
 
 #include <directfb.h>
@@ -129,14 +130,20 @@ DirectFBUsageString( void )
 DFBResult
 DirectFBInit( int *argc, char *(*argv[]) )
 {
-     DFBResult ret;
+     DFBResult         ret;
+     DirectStartupSpan span;
 
      D_DEBUG_AT( DirectFB_Main, "%s( %p, %p )\n", __FUNCTION__, argc, argv );
 
+     /* Begin before parsing, which may enable the startup profile. */
+     direct_startup_begin( &span );
+
      ret = dfb_config_init( argc, argv );
      if (ret)
           return ret;
 
+     direct_startup_end( &span, "main", "DirectFBInit" );
+
      return DFB_OK;
 }
 
@@ -171,8 +178,9 @@ DFBResult
 DirectFBCreate( IDirectFB **interface_ptr )
 {
 #if !DIRECTFB_BUILD_PURE_VOODOO
-     DFBResult  ret;
-     IDirectFB *dfb;
+     DFBResult         ret;
+     IDirectFB        *dfb;
+     DirectStartupSpan span;
 #endif
 
      D_DEBUG_AT( DirectFB_Main, "%s( %p )\n", __FUNCTION__, interface_ptr );
@@ -217,6 +225,8 @@ DirectFBCreate( IDirectFB **interface_ptr )
 
      static DirectMutex lock = DIRECT_RECURSIVE_MUTEX_INITIALIZER(lock);
 
+     direct_startup_begin( &span );
+
      direct_mutex_lock( &lock );
 
      if (!dfb_config->no_singleton && idirectfb_singleton) {
@@ -261,6 +271,10 @@ DirectFBCreate( IDirectFB **interface_ptr )
 
      D_DEBUG_AT( DirectFB_Main, "  -> Done\n" );
 
+     direct_startup_end( &span, "main", "DirectFBCreate" );
+
+     direct_startup_report( "DirectFBCreate", NULL );
+
      *interface_ptr = dfb;
 
      return DFB_OK;
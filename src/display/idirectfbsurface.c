@@ -3682,6 +3682,42 @@ IDirectFBSurface_Flush( IDirectFBSurface     *thiz,
      return DFB_OK;
 }
 
+static DFBResult
+IDirectFBSurface_GetBufferAge( IDirectFBSurface *thiz,
+                               unsigned int     *ret_age )
+{
+     DFBResult    ret;
+     CoreSurface *surface;
+     u32          age;
+
+     DIRECT_INTERFACE_GET_DATA(IDirectFBSurface)
+
+     D_DEBUG_AT( Surface, "%s( %p )\n", __FUNCTION__, thiz );
+
+     surface = data->surface;
+     if (!surface)
+          return DFB_DESTROYED;
+
+     if (!ret_age)
+          return DFB_INVARG;
+
+     if (!(surface->config.caps & DSCAPS_FLIPPING)) {
+          *ret_age = 1;
+          return DFB_OK;
+     }
+
+     ret = CoreSurface_GetBufferAge( surface, CSBR_BACK,
+                                     (surface->config.caps & DSCAPS_STEREO) ? data->src_eye : DSSE_LEFT, &age );
+     if (ret)
+          return ret;
+
+     D_DEBUG_AT( Surface, "  -> age %u\n", age );
+
+     *ret_age = age;
+
+     return DFB_OK;
+}
+
 /******/
 
 DFBResult IDirectFBSurface_Construct( IDirectFBSurface       *thiz,
@@ -3914,6 +3950,8 @@ DFBResult IDirectFBSurface_Construct( IDirectFBSurface       *thiz,
 
      thiz->Flush          = IDirectFBSurface_Flush;
 
+     thiz->GetBufferAge   = IDirectFBSurface_GetBufferAge;
+
      dfb_surface_attach( surface,
                          IDirectFBSurface_listener, thiz, &data->reaction );
 
@@ -36,6 +36,7 @@
 #include <directfb_util.h>
 
 #include "convert.h"
+#include "convert_row.h"
 
 /* lookup tables for 2/3bit to 8bit color conversion */
 static const u8 lookup3to8[] = { 0x00, 0x24, 0x49, 0x6d, 0x92, 0xb6, 0xdb, 0xff};
@@ -49,6 +50,37 @@ static const u8 lookup2to8[] = { 0x00, 0x55, 0xaa, 0xff};
 #define EXPAND_6to8(v)   (((v) << 2) | ((v) >> 4))
 #define EXPAND_7to8(v)   (((v) << 1) | ((v) >> 6))
 
+/* pixels per step when converting YCbCr to packed 24 bit via ARGB */
+#define ROW_CHUNK        256
+
+static void
+yuv_to_rgb888( const u8 *y, const u8 *cb, const u8 *cr, int cstep, u8 *dst, int width, DFBSurfaceColorSpace colorspace )
+{
+     u32 buf[ROW_CHUNK];
+     int x, n;
+
+     for (x=0; x<width; x+=n) {
+          n = MIN( width - x, ROW_CHUNK );
+
+          dfb_convert_row_yuv_to_argb( y + x, cb + x/2 * cstep, cr + x/2 * cstep, cstep, buf, n, colorspace );
+          dfb_convert_row_argb_to_rgb888( buf, dst + x*3, n );
+     }
+}
+
+static void
+yuy2_to_rgb888( const u8 *src, bool uyvy, u8 *dst, int width, DFBSurfaceColorSpace colorspace )
+{
+     u32 buf[ROW_CHUNK];
+     int x, n;
+
+     for (x=0; x<width; x+=n) {
+          n = MIN( width - x, ROW_CHUNK );
+
+          dfb_convert_row_yuy2_to_argb( src + x*2, buf, n, uyvy, colorspace );
+          dfb_convert_row_argb_to_rgb888( buf, dst + x*3, n );
+     }
+}
+
 
 void
 dfb_pixel_to_color( DFBSurfacePixelFormat  format,
@@ -525,12 +557,7 @@ dfb_convert_to_rgb16( DFBSurfacePixelFormat  format,
           case DSPF_RGB32:
           case DSPF_ARGB:
                while (height--) {
-                    const u32 *src32 = src;
-
-                    for (x=0; x<width; x++)
-                         dst[x] = PIXEL_RGB16( (src32[x] & 0xff0000) >> 16,
-                                               (src32[x] & 0x00ff00) >>  8,
-                                               (src32[x] & 0x0000ff) );
+                    dfb_convert_row_argb_to_rgb16( src, dst, width );
 
                     src += spitch;
                     dst += dp2;
@@ -985,18 +1012,19 @@ dfb_convert_to_rgb555( DFBSurfacePixelFormat  format,
 }
 
 void
-dfb_convert_to_rgb32( DFBSurfacePixelFormat  format,
-                      const void            *src,
-                      int                    spitch,
-                      const void            *src_cb,
-                      int                    scbpitch,
-                      const void            *src_cr,
-                      int                    scrpitch,
-                      int                    surface_height,
-                      u32                   *dst,
-                      int                    dpitch,
-                      int                    width,
-                      int                    height )
+dfb_convert_to_rgb32_colorspace( DFBSurfacePixelFormat  format,
+                                 const void            *src,
+                                 int                    spitch,
+                                 const void            *src_cb,
+                                 int                    scbpitch,
+                                 const void            *src_cr,
+                                 int                    scrpitch,
+                                 int                    surface_height,
+                                 u32                   *dst,
+                                 int                    dpitch,
+                                 int                    width,
+                                 int                    height,
+                                 DFBSurfaceColorSpace   colorspace )
 {
      const int dp4 = dpitch / 4;
      int       x;
@@ -1014,12 +1042,7 @@ dfb_convert_to_rgb32( DFBSurfacePixelFormat  format,
 
           case DSPF_ABGR:
                while (height--) {
-                    const u32 *src32 = src;
-
-                    for (x=0; x<width; x++)
-                         dst[x] = PIXEL_RGB32( (src32[x] & 0x0000ff),
-                                               (src32[x] & 0x00ff00) >>  8,
-                                               (src32[x] & 0xff0000) >> 16 );
+                    dfb_convert_row_swap_rb( src, dst, width, 0xff000000 );
 
                     src += spitch;
                     dst += dp4;
@@ -1028,17 +1051,10 @@ dfb_convert_to_rgb32( DFBSurfacePixelFormat  format,
 
           case DSPF_RGB24:
                while (height--) {
-                    const u8 *src8 = src;
-
-                    for (x=0; x<width; x++)
 #ifdef WORDS_BIGENDIAN
-                         dst[x] = ( src8[x*3+0] << 16 ) |
-                                  ( src8[x*3+1] <<  8 ) |
-                                  ( src8[x*3+2]       );
+                    dfb_convert_row_rgb888_to_argb( src, dst, width, 0 );
 #else
-                         dst[x] = ( src8[x*3+2] << 16 ) |
-                                  ( src8[x*3+1] <<  8 ) |
-                                  ( src8[x*3+0]       );
+                    dfb_convert_row_bgr888_to_argb( src, dst, width, 0 );
 #endif
 
                     src += spitch;
@@ -1048,15 +1064,10 @@ dfb_convert_to_rgb32( DFBSurfacePixelFormat  format,
 
           case DSPF_AYUV:
                while (height--) {
-                    const u32 *src32 = src;
+                    dfb_convert_row_ayuv_to_argb( src, dst, width, colorspace );
 
-                    for (x=0; x<width; x++) {
-                         int r, g, b;
-
-                         YCBCR_TO_RGB( (src32[x] >> 16) & 0xff, (src32[x] >> 8) & 0xff, src32[x] & 0xff, r, g, b );
-
-                         dst[x] = PIXEL_RGB32( r, g, b );
-                    }
+                    for (x=0; x<width; x++)
+                         dst[x] |= 0xff000000;
 
                     src += spitch;
                     dst += dp4;
@@ -1065,20 +1076,9 @@ dfb_convert_to_rgb32( DFBSurfacePixelFormat  format,
 
           case DSPF_NV16:
                while (height--) {
-                    const u8  *src8  = src;
-                    const u16 *src16 = src + surface_height * spitch;
-     
-                    for (x=0; x<width; x++) {
-                         int r, g, b;
-     
-#ifdef WORDS_BIGENDIAN
-                         YCBCR_TO_RGB( src8[x], src16[x>>1] >> 8, src16[x>>1] & 0xff, r, g, b );
-#else
-                         YCBCR_TO_RGB( src8[x], src16[x>>1] & 0xff, src16[x>>1] >> 8, r, g, b );
-#endif
-     
-                         dst[x] = PIXEL_RGB32( r, g, b );
-                    }
+                    const u8 *cbcr = src + surface_height * spitch;
+
+                    dfb_convert_row_yuv_to_argb( src, cbcr, cbcr + 1, 2, dst, width, colorspace );
 
                     src += spitch;
                     dst += dp4;
@@ -1141,12 +1141,7 @@ dfb_convert_to_rgb32( DFBSurfacePixelFormat  format,
 
           case DSPF_RGB16:
                while (height--) {
-                    const u16 *src16 = src;
-
-                    for (x=0; x<width; x++)
-                         dst[x] = PIXEL_RGB32( ((src16[x] & 0xf800) >> 8) | ((src16[x] & 0xe000) >> 13),
-                                               ((src16[x] & 0x07e0) >> 3) | ((src16[x] & 0x0600) >> 9),
-                                               ((src16[x] & 0x001f) << 3) | ((src16[x] & 0x001c) >> 2) );
+                    dfb_convert_row_rgb16_to_argb( src, dst, width, 0xff000000 );
 
                     src += spitch;
                     dst += dp4;
@@ -1291,18 +1286,37 @@ dfb_convert_to_rgb32( DFBSurfacePixelFormat  format,
 }
 
 void
-dfb_convert_to_argb( DFBSurfacePixelFormat  format,
-                     const void            *src,
-                     int                    spitch,
-                     const void            *src_cb,
-                     int                    scbpitch,
-                     const void            *src_cr,
-                     int                    scrpitch,
-                     int                    surface_height,
-                     u32                   *dst,
-                     int                    dpitch,
-                     int                    width,
-                     int                    height )
+dfb_convert_to_rgb32( DFBSurfacePixelFormat  format,
+                      const void            *src,
+                      int                    spitch,
+                      const void            *src_cb,
+                      int                    scbpitch,
+                      const void            *src_cr,
+                      int                    scrpitch,
+                      int                    surface_height,
+                      u32                   *dst,
+                      int                    dpitch,
+                      int                    width,
+                      int                    height )
+{
+     dfb_convert_to_rgb32_colorspace( format, src, spitch, src_cb, scbpitch, src_cr, scrpitch, surface_height,
+                                      dst, dpitch, width, height, DSCS_BT601 );
+}
+
+void
+dfb_convert_to_argb_colorspace( DFBSurfacePixelFormat  format,
+                                const void            *src,
+                                int                    spitch,
+                                const void            *src_cb,
+                                int                    scbpitch,
+                                const void            *src_cr,
+                                int                    scrpitch,
+                                int                    surface_height,
+                                u32                   *dst,
+                                int                    dpitch,
+                                int                    width,
+                                int                    height,
+                                DFBSurfaceColorSpace   colorspace )
 {
      const int dp4 = dpitch / 4;
      int       x;
@@ -1319,13 +1333,7 @@ dfb_convert_to_argb( DFBSurfacePixelFormat  format,
 
           case DSPF_ABGR:
                while (height--) {
-                    const u32 *src32 = src;
-
-                    for (x=0; x<width; x++)
-                         dst[x] = PIXEL_ARGB( (src32[x] & 0xff000000) >> 24,
-                                              (src32[x] & 0x000000ff),
-                                              (src32[x] & 0x0000ff00) >>  8,
-                                              (src32[x] & 0x00ff0000) >> 16 );
+                    dfb_convert_row_swap_rb( src, dst, width, 0 );
 
                     src += spitch;
                     dst += dp4;
@@ -1346,17 +1354,10 @@ dfb_convert_to_argb( DFBSurfacePixelFormat  format,
 
           case DSPF_RGB24:
                while (height--) {
-                    const u8 *src8 = src;
-
-                    for (x=0; x<width; x++)
 #ifdef WORDS_BIGENDIAN
-                         dst[x] = ( src8[x*3+0] << 16 ) |
-                                  ( src8[x*3+1] <<  8 ) |
-                                  ( src8[x*3+2]       ) | 0xff000000;
+                    dfb_convert_row_rgb888_to_argb( src, dst, width, 0xff000000 );
 #else
-                         dst[x] = ( src8[x*3+2] << 16 ) |
-                                  ( src8[x*3+1] <<  8 ) |
-                                  ( src8[x*3+0]       ) | 0xff000000;
+                    dfb_convert_row_bgr888_to_argb( src, dst, width, 0xff000000 );
 #endif
 
                     src += spitch;
@@ -1366,15 +1367,7 @@ dfb_convert_to_argb( DFBSurfacePixelFormat  format,
 
           case DSPF_AYUV:
                while (height--) {
-                    const u32 *src32 = src;
-     
-                    for (x=0; x<width; x++) {
-                         int r, g, b;
-     
-                         YCBCR_TO_RGB( (src32[x] >> 16) & 0xff, (src32[x] >> 8) & 0xff, src32[x] & 0xff, r, g, b );
-     
-                         dst[x] = PIXEL_ARGB( src32[x] >> 24, r, g, b );
-                    }
+                    dfb_convert_row_ayuv_to_argb( src, dst, width, colorspace );
 
                     src += spitch;
                     dst += dp4;
@@ -1383,25 +1376,65 @@ dfb_convert_to_argb( DFBSurfacePixelFormat  format,
 
           case DSPF_NV16:
                while (height--) {
-                    const u8  *src8  = src;
-                    const u16 *src16 = src + surface_height * spitch;
+                    const u8 *cbcr = src + surface_height * spitch;
 
-                    for (x=0; x<width; x++) {
-                         int r, g, b;
+                    dfb_convert_row_yuv_to_argb( src, cbcr, cbcr + 1, 2, dst, width, colorspace );
 
-#ifdef WORDS_BIGENDIAN
-                         YCBCR_TO_RGB( src8[x], src16[x>>1] >> 8, src16[x>>1] & 0xff, r, g, b );
-#else
-                         YCBCR_TO_RGB( src8[x], src16[x>>1] & 0xff, src16[x>>1] >> 8, r, g, b );
-#endif
+                    src += spitch;
+                    dst += dp4;
+               }
+               break;
 
-                         dst[x] = PIXEL_ARGB( 0xff, r, g, b );
+          case DSPF_NV12:
+          case DSPF_NV21: {
+               const u8 *cbcr = src_cb;
+               int       y;
+
+               /* 'src_cb' is the chroma row of the first line */
+               for (y=0; y<height; y++) {
+                    if (format == DSPF_NV12)
+                         dfb_convert_row_yuv_to_argb( src, cbcr, cbcr + 1, 2, dst, width, colorspace );
+                    else
+                         dfb_convert_row_yuv_to_argb( src, cbcr + 1, cbcr, 2, dst, width, colorspace );
+
+                    if (y & 1)
+                         cbcr += scbpitch;
+
+                    src += spitch;
+                    dst += dp4;
+               }
+               break;
+          }
+
+          case DSPF_I420:
+          case DSPF_YV12: {
+               const u8 *cb = src_cb;
+               const u8 *cr = src_cr;
+               int       y;
+
+               for (y=0; y<height; y++) {
+                    dfb_convert_row_yuv_to_argb( src, cb, cr, 1, dst, width, colorspace );
+
+                    if (y & 1) {
+                         cb += scbpitch;
+                         cr += scrpitch;
                     }
 
                     src += spitch;
                     dst += dp4;
                }
                break;
+          }
+
+          case DSPF_YUY2:
+          case DSPF_UYVY:
+               while (height--) {
+                    dfb_convert_row_yuy2_to_argb( src, dst, width, format == DSPF_UYVY, colorspace );
+
+                    src += spitch;
+                    dst += dp4;
+               }
+               break;
 
           case DSPF_ARGB4444:
                while (height--) {
@@ -1489,13 +1522,7 @@ dfb_convert_to_argb( DFBSurfacePixelFormat  format,
 
           case DSPF_RGB16:
                while (height--) {
-                    const u16 *src16 = src;
-
-                    for (x=0; x<width; x++)
-                         dst[x] = PIXEL_ARGB( 0xff,
-                                              ((src16[x] & 0xf800) >> 8) | ((src16[x] & 0xe000) >> 13),
-                                              ((src16[x] & 0x07e0) >> 3) | ((src16[x] & 0x0600) >> 9),
-                                              ((src16[x] & 0x001f) << 3) | ((src16[x] & 0x001c) >> 2) );
+                    dfb_convert_row_rgb16_to_argb( src, dst, width, 0xff000000 );
 
                     src += spitch;
                     dst += dp4;
@@ -1612,30 +1639,14 @@ dfb_convert_to_argb( DFBSurfacePixelFormat  format,
                break;
 
           case DSPF_YV16:
-               {
-               ++height;
-               while (--height) {
-                    const u8 * __restrict y  = src;
-                    const u8 * __restrict cb = src_cb;
-                    const u8 * __restrict cr = src_cr;
-
-                    for (x=0; x<width; x++) {
-                         int r, g, b;
-                         YCBCR_TO_RGB (*y, *cb, *cr, r, g, b);
-
-                         ++y;
-                         cb += (x & 1);
-                         cr += (x & 1);
-
-                         dst[x] = PIXEL_ARGB( 0xff, r, g, b );
-                    }
+               while (height--) {
+                    dfb_convert_row_yuv_to_argb( src, src_cb, src_cr, 1, dst, width, colorspace );
 
                     src += spitch;
                     src_cb += scbpitch;
                     src_cr += scrpitch;
                     dst += dp4;
                }
-               }
                break;
 
           default:
@@ -1644,18 +1655,37 @@ dfb_convert_to_argb( DFBSurfacePixelFormat  format,
 }
 
 void
-dfb_convert_to_rgb24( DFBSurfacePixelFormat  format,
-                      const void            *src,
-                      int                    spitch,
-                      const void            *src_cb,
-                      int                    scbpitch,
-                      const void            *src_cr,
-                      int                    scrpitch,
-                      int                    surface_height,
-                      u8                    *dst,
-                      int                    dpitch,
-                      int                    width,
-                      int                    height )
+dfb_convert_to_argb( DFBSurfacePixelFormat  format,
+                     const void            *src,
+                     int                    spitch,
+                     const void            *src_cb,
+                     int                    scbpitch,
+                     const void            *src_cr,
+                     int                    scrpitch,
+                     int                    surface_height,
+                     u32                   *dst,
+                     int                    dpitch,
+                     int                    width,
+                     int                    height )
+{
+     dfb_convert_to_argb_colorspace( format, src, spitch, src_cb, scbpitch, src_cr, scrpitch, surface_height,
+                                     dst, dpitch, width, height, DSCS_BT601 );
+}
+
+void
+dfb_convert_to_rgb24_colorspace( DFBSurfacePixelFormat  format,
+                                 const void            *src,
+                                 int                    spitch,
+                                 const void            *src_cb,
+                                 int                    scbpitch,
+                                 const void            *src_cr,
+                                 int                    scrpitch,
+                                 int                    surface_height,
+                                 u8                    *dst,
+                                 int                    dpitch,
+                                 int                    width,
+                                 int                    height,
+                                 DFBSurfaceColorSpace   colorspace )
 {
      int n, n3;
 
@@ -1689,14 +1719,9 @@ dfb_convert_to_rgb24( DFBSurfacePixelFormat  format,
                }
                break;
           case DSPF_ARGB:
+          case DSPF_RGB32:
                while (height--) {
-                    const u32 *src32 = src;
-
-                    for (n=0, n3=0; n<width; n++, n3+=3) {
-                         dst[n3+0] = (src32[n] & 0xFF0000) >> 16;
-                         dst[n3+1] = (src32[n] & 0x00FF00) >>  8;
-                         dst[n3+2] = (src32[n] & 0x0000FF);
-                    }
+                    dfb_convert_row_argb_to_rgb888( src, dst, width );
 
                     src += spitch;
                     dst += dpitch;
@@ -1704,13 +1729,7 @@ dfb_convert_to_rgb24( DFBSurfacePixelFormat  format,
                break;
           case DSPF_ABGR:
                while (height--) {
-                    const u32 *src32 = src;
-
-                    for (n=0, n3=0; n<width; n++, n3+=3) {
-                         dst[n3+0] = (src32[n] & 0x0000FF);
-                         dst[n3+1] = (src32[n] & 0x00FF00) >>  8;
-                         dst[n3+2] = (src32[n] & 0xFF0000) >> 16;
-                    }
+                    dfb_convert_row_argb_to_bgr888( src, dst, width );
 
                     src += spitch;
                     dst += dpitch;
@@ -1864,20 +1883,6 @@ dfb_convert_to_rgb24( DFBSurfacePixelFormat  format,
                     dst += dpitch;
                }
                break;
-          case DSPF_RGB32:
-               while (height--) {
-                    const u32 *src32 = src;
-
-                    for (n=0, n3=0; n<width; n++, n3+=3) {
-                         dst[n3+0] = (src32[n] & 0xFF0000) >> 16;
-                         dst[n3+1] = (src32[n] & 0x00FF00) >>  8;
-                         dst[n3+2] = (src32[n] & 0x0000FF);
-                    }
-
-                    src += spitch;
-                    dst += dpitch;
-               }
-               break;
           case DSPF_ARGB8565:
                while (height--) {
                     const u8 * __restrict src8 = src;
@@ -1972,70 +1977,63 @@ dfb_convert_to_rgb24( DFBSurfacePixelFormat  format,
                }
                break;
           case DSPF_YUY2:
+          case DSPF_UYVY:
                while (height--) {
-                    const u32 *src32 = src;
-
-                    for (n=0, n3=0; n<width/2; n++, n3+=6) {
-                         register u32 y0, cb, y1, cr;
-                         y0 = (src32[n] & 0x000000FF);
-                         cb = (src32[n] & 0x0000FF00) >>  8;
-                         y1 = (src32[n] & 0x00FF0000) >> 16;
-                         cr = (src32[n] & 0xFF000000) >> 24;
-                         YCBCR_TO_RGB( y0, cb, cr,
-                                       dst[n3+0], dst[n3+1], dst[n3+2] );
-                         YCBCR_TO_RGB( y1, cb, cr,
-                                       dst[n3+3], dst[n3+4], dst[n3+5] );
-                    }
+                    yuy2_to_rgb888( src, format == DSPF_UYVY, dst, width, colorspace );
 
                     src += spitch;
                     dst += dpitch;
                }
                break;
-          case DSPF_UYVY:
+          case DSPF_NV16:
                while (height--) {
-                    const u32 *src32 = src;
+                    const u8 *cbcr = src + surface_height * spitch;
 
-                    for (n=0, n3=0; n<width/2; n++, n3+=6) {
-                         register u32 y0, cb, y1, cr;
-                         cb = (src32[n] & 0x000000FF);
-                         y0 = (src32[n] & 0x0000FF00) >>  8;
-                         cr = (src32[n] & 0x00FF0000) >> 16;
-                         y1 = (src32[n] & 0xFF000000) >> 24;
-                         YCBCR_TO_RGB( y0, cb, cr,
-                                       dst[n3+0], dst[n3+1], dst[n3+2] );
-                         YCBCR_TO_RGB( y1, cb, cr,
-                                       dst[n3+3], dst[n3+4], dst[n3+5] );
-                    }
+                    yuv_to_rgb888( src, cbcr, cbcr + 1, 2, dst, width, colorspace );
 
                     src += spitch;
                     dst += dpitch;
                }
                break;
-          case DSPF_NV16:
-               while (height--) {
-                    const u16 *cbcr = src + surface_height * spitch;
-                    const u8  *src8 = src;
+          case DSPF_NV12:
+          case DSPF_NV21: {
+               const u8 *cbcr = src_cb;
+               int       y;
 
-                    for (n=0, n3=0; n<width/2; n++, n3+=6) {
-#ifdef WORDS_BIGENDIAN
-                         YCBCR_TO_RGB( src8[n*2+0], cbcr[n] >> 8, cbcr[n] & 0xff,
-                                       dst[n3+0], dst[n3+1], dst[n3+2] );
-     
-                         YCBCR_TO_RGB( src8[n*2+1], cbcr[n] >> 8, cbcr[n] & 0xff,
-                                       dst[n3+3], dst[n3+4], dst[n3+5] );
-#else
-                         YCBCR_TO_RGB( src8[n*2+0], cbcr[n] & 0xff, cbcr[n] >> 8,
-                                       dst[n3+0], dst[n3+1], dst[n3+2] );
-     
-                         YCBCR_TO_RGB( src8[n*2+1], cbcr[n] & 0xff, cbcr[n] >> 8,
-                                       dst[n3+3], dst[n3+4], dst[n3+5] );
-#endif
+               /* 'src_cb' is the chroma row of the first line */
+               for (y=0; y<height; y++) {
+                    if (format == DSPF_NV12)
+                         yuv_to_rgb888( src, cbcr, cbcr + 1, 2, dst, width, colorspace );
+                    else
+                         yuv_to_rgb888( src, cbcr + 1, cbcr, 2, dst, width, colorspace );
+
+                    if (y & 1)
+                         cbcr += scbpitch;
+
+                    src += spitch;
+                    dst += dpitch;
+               }
+               break;
+          }
+          case DSPF_I420:
+          case DSPF_YV12: {
+               const u8 *cb = src_cb;
+               const u8 *cr = src_cr;
+               int       y;
+
+               for (y=0; y<height; y++) {
+                    yuv_to_rgb888( src, cb, cr, 1, dst, width, colorspace );
+
+                    if (y & 1) {
+                         cb += scbpitch;
+                         cr += scrpitch;
                     }
 
                     src += spitch;
                     dst += dpitch;
                }
                break;
+          }
           case DSPF_RGBA5551:
                while (height--) {
                     const u16 *src16 = src;
@@ -2067,34 +2065,38 @@ dfb_convert_to_rgb24( DFBSurfacePixelFormat  format,
                }
                break;
           case DSPF_YV16:
-               {
-               ++height;
-               while (--height) {
-                    const u8 * __restrict y  = src;
-                    const u8 * __restrict cb = src_cb;
-                    const u8 * __restrict cr = src_cr;
-
-                    for (n=0, n3=0; n<width; n++, n3+=3) {
-                         YCBCR_TO_RGB (*y, *cb, *cr,
-                                       dst[n3+0], dst[n3+1], dst[n3+2]);
-
-                         ++y;
-                         cb += (n & 1);
-                         cr += (n & 1);
-                    }
+               while (height--) {
+                    yuv_to_rgb888( src, src_cb, src_cr, 1, dst, width, colorspace );
 
                     src += spitch;
                     src_cb += scbpitch;
                     src_cr += scrpitch;
                     dst += dpitch;
                }
-               }
                break;
           default:
                D_ONCE( "unsupported format" );
      }
 }
 
+void
+dfb_convert_to_rgb24( DFBSurfacePixelFormat  format,
+                      const void            *src,
+                      int                    spitch,
+                      const void            *src_cb,
+                      int                    scbpitch,
+                      const void            *src_cr,
+                      int                    scrpitch,
+                      int                    surface_height,
+                      u8                    *dst,
+                      int                    dpitch,
+                      int                    width,
+                      int                    height )
+{
+     dfb_convert_to_rgb24_colorspace( format, src, spitch, src_cb, scbpitch, src_cr, scrpitch, surface_height,
+                                      dst, dpitch, width, height, DSCS_BT601 );
+}
+
 void
 dfb_convert_to_a8( DFBSurfacePixelFormat  format,
                    const void            *src,
@@ -677,6 +677,52 @@ void dfb_convert_to_rgb24( DFBSurfacePixelFormat  format,
                            int                    width,
                            int                    height );
 
+/*
+ * Variants of the above taking the colorspace of YCbCr sources, the ones without assume BT.601.
+ * Formats converted per pixel other than DSPF_AYUV are always treated as BT.601.
+ */
+void dfb_convert_to_argb_colorspace( DFBSurfacePixelFormat  format,
+                                     const void            *src,
+                                     int                    spitch,
+                                     const void            *src_cb,
+                                     int                    scbpitch,
+                                     const void            *src_cr,
+                                     int                    scrpitch,
+                                     int                    surface_height,
+                                     u32                   *dst,
+                                     int                    dpitch,
+                                     int                    width,
+                                     int                    height,
+                                     DFBSurfaceColorSpace   colorspace );
+
+void dfb_convert_to_rgb32_colorspace( DFBSurfacePixelFormat  format,
+                                      const void            *src,
+                                      int                    spitch,
+                                      const void            *src_cb,
+                                      int                    scbpitch,
+                                      const void            *src_cr,
+                                      int                    scrpitch,
+                                      int                    surface_height,
+                                      u32                   *dst,
+                                      int                    dpitch,
+                                      int                    width,
+                                      int                    height,
+                                      DFBSurfaceColorSpace   colorspace );
+
+void dfb_convert_to_rgb24_colorspace( DFBSurfacePixelFormat  format,
+                                      const void            *src,
+                                      int                    spitch,
+                                      const void            *src_cb,
+                                      int                    scbpitch,
+                                      const void            *src_cr,
+                                      int                    scrpitch,
+                                      int                    surface_height,
+                                      u8                    *dst,
+                                      int                    dpitch,
+                                      int                    width,
+                                      int                    height,
+                                      DFBSurfaceColorSpace   colorspace );
+
 void dfb_convert_to_a8( DFBSurfacePixelFormat  format,
                         const void            *src,
                         int                    spitch,
@@ -0,0 +1,442 @@
+/*
+   (c) Copyright 2012-2013  DirectFB integrated media GmbH
+   (c) Copyright 2001-2013  The world wide DirectFB Open Source Community (directfb.org)
+   (c) Copyright 2000-2004  Convergence (integrated media) GmbH
+
+   All rights reserved.
+
+   Written by Denis Oliver Kropp <dok@directfb.org>,
+              Andreas Shimokawa <andi@directfb.org>,
+              Marek Pikarski <mass@directfb.org>,
+              Sven Neumann <neo@directfb.org>,
+              Ville Syrjälä <syrjala@sci.fi> and
+              Claudio Ciccani <klan@users.sf.net>.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+#include <config.h>
+
+#include <string.h>
+
+#include <directfb.h>
+
+#include <direct/util.h>
+
+#include <misc/conf.h>
+
+#include <gfx/convert_row.h>
+
+/**********************************************************************************************************************/
+
+/*
+ * YCbCr to RGB matrix in 8 bit fixed point, the BT.601 one is the same as used by YCBCR_TO_RGB().
+ */
+typedef struct {
+     int  y_offset;
+     int  y;
+     int  r_cr;
+     int  g_cb;
+     int  g_cr;
+     int  b_cb;
+} YCbCrMatrix;
+
+static const YCbCrMatrix matrix_bt601      = { 16, 298, 409, 100, 208, 516 };
+static const YCbCrMatrix matrix_bt601_full = {  0, 256, 359,  88, 183, 454 };
+static const YCbCrMatrix matrix_bt709      = { 16, 298, 459,  55, 136, 541 };
+
+static const YCbCrMatrix *
+ycbcr_matrix( DFBSurfaceColorSpace colorspace )
+{
+     switch (colorspace) {
+          case DSCS_BT601_FULLRANGE:
+               return &matrix_bt601_full;
+
+          case DSCS_BT709:
+               return &matrix_bt709;
+
+          default:
+               return &matrix_bt601;
+     }
+}
+
+/*
+ * RGB to YCbCr matrix in 8 bit fixed point, the BT.601 one is the same as used by RGB_TO_YCBCR().
+ */
+typedef struct {
+     int  y_offset;
+     int  y_r,  y_g,  y_b;
+     int  cb_r, cb_g, cb_b;
+     int  cr_r, cr_g, cr_b;
+} RGBMatrix;
+
+static const RGBMatrix rgb_bt601      = { 16, 66, 129, 25, -38, -74, 112, 112,  -94, -18 };
+static const RGBMatrix rgb_bt601_full = {  0, 77, 150, 29, -43, -85, 128, 128, -107, -21 };
+static const RGBMatrix rgb_bt709      = { 16, 47, 157, 16, -26, -87, 112, 112, -102, -10 };
+
+static const RGBMatrix *
+rgb_matrix( DFBSurfaceColorSpace colorspace )
+{
+     switch (colorspace) {
+          case DSCS_BT601_FULLRANGE:
+               return &rgb_bt601_full;
+
+          case DSCS_BT709:
+               return &rgb_bt709;
+
+          default:
+               return &rgb_bt601;
+     }
+}
+
+static inline u32
+ycbcr_to_argb( const YCbCrMatrix *m, int y, int cb, int cr )
+{
+     int _y = m->y * (y - m->y_offset) + 128;
+     int r, g, b;
+
+     cb -= 128;
+     cr -= 128;
+
+     r = (_y + m->r_cr * cr) >> 8;
+     g = (_y - m->g_cb * cb - m->g_cr * cr) >> 8;
+     b = (_y + m->b_cb * cb) >> 8;
+
+     return 0xff000000 | (CLAMP( r, 0, 255 ) << 16) | (CLAMP( g, 0, 255 ) << 8) | CLAMP( b, 0, 255 );
+}
+
+/* Keeps the alpha of 'p', full range chroma can reach 256 and is clamped. */
+static inline u32
+argb_to_ycbcr( const RGBMatrix *m, u32 p )
+{
+     int r = (p >> 16) & 0xff;
+     int g = (p >>  8) & 0xff;
+     int b =  p        & 0xff;
+     int y, cb, cr;
+
+     y  = (m->y_r  * r + m->y_g  * g + m->y_b  * b + m->y_offset * 256 + 128) >> 8;
+     cb = (m->cb_r * r + m->cb_g * g + m->cb_b * b +        128 * 256 + 128) >> 8;
+     cr = (m->cr_r * r + m->cr_g * g + m->cr_b * b +        128 * 256 + 128) >> 8;
+
+     return (p & 0xff000000) | (CLAMP( y, 0, 255 ) << 16) | (CLAMP( cb, 0, 255 ) << 8) | CLAMP( cr, 0, 255 );
+}
+
+/**********************************************************************************************************************/
+
+typedef void (*ToPacked24Func)( const u32 *src, u8 *dst, int num );
+typedef void (*FromPacked24Func)( const u8 *src, u32 *dst, int num, u32 alpha );
+typedef void (*ToRGB16Func)( const u32 *src, u16 *dst, int num );
+typedef void (*FromRGB16Func)( const u16 *src, u32 *dst, int num, u32 alpha );
+typedef void (*SwapFunc)( const u32 *src, u32 *dst, int num, u32 alpha );
+typedef void (*YUVFunc)( const YCbCrMatrix *m, const u8 *y, const u8 *cb, const u8 *cr, int cstep, u32 *dst, int num );
+typedef void (*YUY2Func)( const YCbCrMatrix *m, const u8 *src, u32 *dst, int num, bool uyvy );
+typedef void (*AYUVFunc)( const YCbCrMatrix *m, const u32 *src, u32 *dst, int num );
+typedef void (*ToAYUVFunc)( const RGBMatrix *m, const u32 *src, u32 *dst, int num );
+
+static void
+argb_to_rgb888_C( const u32 *src, u8 *dst, int num )
+{
+     int x;
+
+     for (x=0; x<num; x++, dst+=3) {
+          dst[0] = src[x] >> 16;
+          dst[1] = src[x] >>  8;
+          dst[2] = src[x];
+     }
+}
+
+static void
+argb_to_bgr888_C( const u32 *src, u8 *dst, int num )
+{
+     int x;
+
+     for (x=0; x<num; x++, dst+=3) {
+          dst[0] = src[x];
+          dst[1] = src[x] >>  8;
+          dst[2] = src[x] >> 16;
+     }
+}
+
+static void
+rgb888_to_argb_C( const u8 *src, u32 *dst, int num, u32 alpha )
+{
+     int x;
+
+     for (x=0; x<num; x++, src+=3)
+          dst[x] = (src[0] << 16) | (src[1] << 8) | src[2] | alpha;
+}
+
+static void
+bgr888_to_argb_C( const u8 *src, u32 *dst, int num, u32 alpha )
+{
+     int x;
+
+     for (x=0; x<num; x++, src+=3)
+          dst[x] = (src[2] << 16) | (src[1] << 8) | src[0] | alpha;
+}
+
+static void
+argb_to_rgb16_C( const u32 *src, u16 *dst, int num )
+{
+     int x;
+
+     for (x=0; x<num; x++)
+          dst[x] = ((src[x] & 0xf80000) >> 8) | ((src[x] & 0x00fc00) >> 5) | ((src[x] & 0x0000f8) >> 3);
+}
+
+static void
+rgb16_to_argb_C( const u16 *src, u32 *dst, int num, u32 alpha )
+{
+     int x;
+
+     for (x=0; x<num; x++) {
+          u32 p = src[x];
+
+          dst[x] = (((p & 0xf800) << 8) | ((p & 0xe000) << 3) |
+                    ((p & 0x07e0) << 5) | ((p & 0x0600) >> 1) |
+                    ((p & 0x001f) << 3) | ((p & 0x001c) >> 2) | alpha);
+     }
+}
+
+static void
+swap_rb_C( const u32 *src, u32 *dst, int num, u32 alpha )
+{
+     int x;
+
+     for (x=0; x<num; x++)
+          dst[x] = (src[x] & 0xff00ff00) | ((src[x] & 0xff) << 16) | ((src[x] >> 16) & 0xff) | alpha;
+}
+
+static void
+yuv_to_argb_C( const YCbCrMatrix *m, const u8 *y, const u8 *cb, const u8 *cr, int cstep, u32 *dst, int num )
+{
+     int x;
+
+     for (x=0; x<num; x++) {
+          int c = (x >> 1) * cstep;
+
+          dst[x] = ycbcr_to_argb( m, y[x], cb[c], cr[c] );
+     }
+}
+
+static void
+yuy2_to_argb_C( const YCbCrMatrix *m, const u8 *src, u32 *dst, int num, bool uyvy )
+{
+     const int yo = uyvy ? 1 : 0;
+     const int co = uyvy ? 0 : 1;
+     int       x;
+
+     for (x=0; x<num; x++) {
+          const u8 *s = src + (x & ~1) * 2;
+
+          dst[x] = ycbcr_to_argb( m, s[(x & 1) * 2 + yo], s[co], s[co + 2] );
+     }
+}
+
+static void
+ayuv_to_argb_C( const YCbCrMatrix *m, const u32 *src, u32 *dst, int num )
+{
+     int x;
+
+     for (x=0; x<num; x++) {
+          u32 p = src[x];
+
+          dst[x] = (ycbcr_to_argb( m, (p >> 16) & 0xff, (p >> 8) & 0xff, p & 0xff ) & 0x00ffffff) | (p & 0xff000000);
+     }
+}
+
+static void
+argb_to_ayuv_C( const RGBMatrix *m, const u32 *src, u32 *dst, int num )
+{
+     int x;
+
+     for (x=0; x<num; x++)
+          dst[x] = argb_to_ycbcr( m, src[x] );
+}
+
+/**********************************************************************************************************************/
+
+#ifndef WORDS_BIGENDIAN
+
+#if defined(USE_SSE) && defined(__SSE2__)
+# include "convert_row_sse2.h"
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+# include "convert_row_neon.h"
+#endif
+
+#endif
+
+static ToPacked24Func   argb_to_rgb888 = argb_to_rgb888_C;
+static ToPacked24Func   argb_to_bgr888 = argb_to_bgr888_C;
+static FromPacked24Func rgb888_to_argb = rgb888_to_argb_C;
+static FromPacked24Func bgr888_to_argb = bgr888_to_argb_C;
+static ToRGB16Func      argb_to_rgb16  = argb_to_rgb16_C;
+static FromRGB16Func    rgb16_to_argb  = rgb16_to_argb_C;
+static SwapFunc         swap_rb        = swap_rb_C;
+static YUVFunc          yuv_to_argb    = yuv_to_argb_C;
+static YUY2Func         yuy2_to_argb   = yuy2_to_argb_C;
+static AYUVFunc         ayuv_to_argb   = ayuv_to_argb_C;
+static ToAYUVFunc       argb_to_ayuv   = argb_to_ayuv_C;
+
+static void
+init_rows( void )
+{
+     static bool initialized = false;
+
+     if (initialized)
+          return;
+
+     initialized = true;
+
+#ifndef WORDS_BIGENDIAN
+#if defined(USE_SSE) && defined(__SSE2__)
+     /* Same switch as for MMX, "no-mmx" turns off all x86 SIMD code. Tools may convert without a config. */
+     if (!dfb_config || dfb_config->mmx) {
+          argb_to_rgb888 = argb_to_rgb888_SSE2;
+          argb_to_bgr888 = argb_to_bgr888_SSE2;
+          rgb888_to_argb = rgb888_to_argb_SSE2;
+          bgr888_to_argb = bgr888_to_argb_SSE2;
+          argb_to_rgb16  = argb_to_rgb16_SSE2;
+          rgb16_to_argb  = rgb16_to_argb_SSE2;
+          swap_rb        = swap_rb_SSE2;
+          yuv_to_argb    = yuv_to_argb_SSE2;
+          yuy2_to_argb   = yuy2_to_argb_SSE2;
+          ayuv_to_argb   = ayuv_to_argb_SSE2;
+          argb_to_ayuv   = argb_to_ayuv_SSE2;
+     }
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+     argb_to_rgb888 = argb_to_rgb888_NEON;
+     argb_to_bgr888 = argb_to_bgr888_NEON;
+     rgb888_to_argb = rgb888_to_argb_NEON;
+     bgr888_to_argb = bgr888_to_argb_NEON;
+     argb_to_rgb16  = argb_to_rgb16_NEON;
+     rgb16_to_argb  = rgb16_to_argb_NEON;
+     swap_rb        = swap_rb_NEON;
+     yuv_to_argb    = yuv_to_argb_NEON;
+     yuy2_to_argb   = yuy2_to_argb_NEON;
+#endif
+#endif
+}
+
+/**********************************************************************************************************************/
+
+void
+dfb_convert_row_argb_to_rgb888( const u32 *src, u8 *dst, int num )
+{
+     init_rows();
+
+     argb_to_rgb888( src, dst, num );
+}
+
+void
+dfb_convert_row_argb_to_bgr888( const u32 *src, u8 *dst, int num )
+{
+     init_rows();
+
+     argb_to_bgr888( src, dst, num );
+}
+
+void
+dfb_convert_row_rgb888_to_argb( const u8 *src, u32 *dst, int num, u32 alpha )
+{
+     init_rows();
+
+     rgb888_to_argb( src, dst, num, alpha );
+}
+
+void
+dfb_convert_row_bgr888_to_argb( const u8 *src, u32 *dst, int num, u32 alpha )
+{
+     init_rows();
+
+     bgr888_to_argb( src, dst, num, alpha );
+}
+
+void
+dfb_convert_row_argb_to_rgb16( const u32 *src, u16 *dst, int num )
+{
+     init_rows();
+
+     argb_to_rgb16( src, dst, num );
+}
+
+void
+dfb_convert_row_rgb16_to_argb( const u16 *src, u32 *dst, int num, u32 alpha )
+{
+     init_rows();
+
+     rgb16_to_argb( src, dst, num, alpha );
+}
+
+void
+dfb_convert_row_swap_rb( const u32 *src, u32 *dst, int num, u32 alpha )
+{
+     init_rows();
+
+     swap_rb( src, dst, num, alpha );
+}
+
+void
+dfb_convert_row_yuv_to_argb( const u8             *y,
+                             const u8             *cb,
+                             const u8             *cr,
+                             int                   cstep,
+                             u32                  *dst,
+                             int                   num,
+                             DFBSurfaceColorSpace  colorspace )
+{
+     init_rows();
+
+     yuv_to_argb( ycbcr_matrix( colorspace ), y, cb, cr, cstep, dst, num );
+}
+
+void
+dfb_convert_row_yuy2_to_argb( const u8             *src,
+                              u32                  *dst,
+                              int                   num,
+                              bool                  uyvy,
+                              DFBSurfaceColorSpace  colorspace )
+{
+     init_rows();
+
+     yuy2_to_argb( ycbcr_matrix( colorspace ), src, dst, num, uyvy );
+}
+
+void
+dfb_convert_row_ayuv_to_argb( const u32            *src,
+                              u32                  *dst,
+                              int                   num,
+                              DFBSurfaceColorSpace  colorspace )
+{
+     init_rows();
+
+     ayuv_to_argb( ycbcr_matrix( colorspace ), src, dst, num );
+}
+
+void
+dfb_convert_row_argb_to_ayuv( const u32            *src,
+                              u32                  *dst,
+                              int                   num,
+                              DFBSurfaceColorSpace  colorspace )
+{
+     init_rows();
+
+     argb_to_ayuv( rgb_matrix( colorspace ), src, dst, num );
+}
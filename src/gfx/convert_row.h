@@ -0,0 +1,101 @@
+/*
+   (c) Copyright 2012-2013  DirectFB integrated media GmbH
+   (c) Copyright 2001-2013  The world wide DirectFB Open Source Community (directfb.org)
+   (c) Copyright 2000-2004  Convergence (integrated media) GmbH
+
+   All rights reserved.
+
+   Written by Denis Oliver Kropp <dok@directfb.org>,
+              Andreas Shimokawa <andi@directfb.org>,
+              Marek Pikarski <mass@directfb.org>,
+              Sven Neumann <neo@directfb.org>,
+              Ville Syrjälä <syrjala@sci.fi> and
+              Claudio Ciccani <klan@users.sf.net>.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+#ifndef __GFX__CONVERT_ROW_H__
+#define __GFX__CONVERT_ROW_H__
+
+#include <directfb.h>
+
+/*
+ * Row converters
+ *
+ * Conversion of a single row of pixels between the formats used most by surface dumps, screen capture and
+ * image loading. The plain C versions are the reference, SSE2 or NEON versions are selected at runtime and
+ * produce exactly the same output.
+ *
+ * Packed 24 bit pixels are named after their byte order in memory, i.e. DSPF_RGB24 is "bgr888" on little
+ * endian and "rgb888" on big endian machines. The 'alpha' argument is or'ed into each resulting pixel.
+ */
+
+void dfb_convert_row_argb_to_rgb888( const u32 *src, u8  *dst, int num );
+void dfb_convert_row_argb_to_bgr888( const u32 *src, u8  *dst, int num );
+
+void dfb_convert_row_rgb888_to_argb( const u8  *src, u32 *dst, int num, u32 alpha );
+void dfb_convert_row_bgr888_to_argb( const u8  *src, u32 *dst, int num, u32 alpha );
+
+void dfb_convert_row_argb_to_rgb16 ( const u32 *src, u16 *dst, int num );
+void dfb_convert_row_rgb16_to_argb ( const u16 *src, u32 *dst, int num, u32 alpha );
+
+/*
+ * Exchanges red and blue, i.e. ARGB <-> ABGR.
+ */
+void dfb_convert_row_swap_rb       ( const u32 *src, u32 *dst, int num, u32 alpha );
+
+/*
+ * Converts horizontally subsampled YCbCr (4:2:2 or one row of 4:2:0) to opaque ARGB.
+ *
+ * Pixel x uses the chroma samples cb[(x/2)*cstep] and cr[(x/2)*cstep], i.e. 'cstep' is 1 for planar formats
+ * and 2 for semi planar formats like NV12 (cr = cb + 1) or NV21 (cb = cr + 1).
+ *
+ * The colorspace selects the BT.601, BT.601 full range or BT.709 matrix, anything else means BT.601.
+ */
+void dfb_convert_row_yuv_to_argb   ( const u8             *y,
+                                     const u8             *cb,
+                                     const u8             *cr,
+                                     int                   cstep,
+                                     u32                  *dst,
+                                     int                   num,
+                                     DFBSurfaceColorSpace  colorspace );
+
+/*
+ * Converts packed YUY2 (or UYVY if 'uyvy' is set) to opaque ARGB.
+ */
+void dfb_convert_row_yuy2_to_argb  ( const u8             *src,
+                                     u32                  *dst,
+                                     int                   num,
+                                     bool                  uyvy,
+                                     DFBSurfaceColorSpace  colorspace );
+
+/*
+ * Converts DSPF_AYUV to ARGB and back, keeping the alpha. This is also the layout of lib/dvc's line buffers.
+ *
+ * Source and destination may be the same buffer.
+ */
+void dfb_convert_row_ayuv_to_argb  ( const u32            *src,
+                                     u32                  *dst,
+                                     int                   num,
+                                     DFBSurfaceColorSpace  colorspace );
+
+void dfb_convert_row_argb_to_ayuv  ( const u32            *src,
+                                     u32                  *dst,
+                                     int                   num,
+                                     DFBSurfaceColorSpace  colorspace );
+
+#endif
@@ -0,0 +1,296 @@
+/*
+   (c) Copyright 2012-2013  DirectFB integrated media GmbH
+   (c) Copyright 2001-2013  The world wide DirectFB Open Source Community (directfb.org)
+   (c) Copyright 2000-2004  Convergence (integrated media) GmbH
+
+   All rights reserved.
+
+   Written by Denis Oliver Kropp <dok@directfb.org>,
+              Andreas Shimokawa <andi@directfb.org>,
+              Marek Pikarski <mass@directfb.org>,
+              Sven Neumann <neo@directfb.org>,
+              Ville Syrjälä <syrjala@sci.fi> and
+              Claudio Ciccani <klan@users.sf.net>.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+#ifndef __GFX__CONVERT_ROW_NEON_H__
+#define __GFX__CONVERT_ROW_NEON_H__
+
+#include <arm_neon.h>
+
+/*
+ * Eight pixels (sixteen for YUY2) are converted per iteration using the (de)interleaving loads and stores,
+ * the remaining ones by the C versions.
+ */
+
+static void
+argb_to_rgb888_NEON( const u32 *src, u8 *dst, int num )
+{
+     int x;
+
+     for (x=0; x<num-7; x+=8, dst+=24) {
+          uint8x8x4_t p = vld4_u8( (const u8*)(src + x) );
+          uint8x8x3_t o;
+
+          o.val[0] = p.val[2];
+          o.val[1] = p.val[1];
+          o.val[2] = p.val[0];
+
+          vst3_u8( dst, o );
+     }
+
+     argb_to_rgb888_C( src + x, dst, num - x );
+}
+
+static void
+argb_to_bgr888_NEON( const u32 *src, u8 *dst, int num )
+{
+     int x;
+
+     for (x=0; x<num-7; x+=8, dst+=24) {
+          uint8x8x4_t p = vld4_u8( (const u8*)(src + x) );
+          uint8x8x3_t o;
+
+          o.val[0] = p.val[0];
+          o.val[1] = p.val[1];
+          o.val[2] = p.val[2];
+
+          vst3_u8( dst, o );
+     }
+
+     argb_to_bgr888_C( src + x, dst, num - x );
+}
+
+static void
+rgb888_to_argb_NEON( const u8 *src, u32 *dst, int num, u32 alpha )
+{
+     const uint8x8_t a = vdup_n_u8( alpha >> 24 );
+     int             x;
+
+     for (x=0; x<num-7; x+=8, src+=24) {
+          uint8x8x3_t p = vld3_u8( src );
+          uint8x8x4_t o;
+
+          o.val[0] = p.val[2];
+          o.val[1] = p.val[1];
+          o.val[2] = p.val[0];
+          o.val[3] = a;
+
+          vst4_u8( (u8*)(dst + x), o );
+     }
+
+     rgb888_to_argb_C( src, dst + x, num - x, alpha );
+}
+
+static void
+bgr888_to_argb_NEON( const u8 *src, u32 *dst, int num, u32 alpha )
+{
+     const uint8x8_t a = vdup_n_u8( alpha >> 24 );
+     int             x;
+
+     for (x=0; x<num-7; x+=8, src+=24) {
+          uint8x8x3_t p = vld3_u8( src );
+          uint8x8x4_t o;
+
+          o.val[0] = p.val[0];
+          o.val[1] = p.val[1];
+          o.val[2] = p.val[2];
+          o.val[3] = a;
+
+          vst4_u8( (u8*)(dst + x), o );
+     }
+
+     bgr888_to_argb_C( src, dst + x, num - x, alpha );
+}
+
+static void
+argb_to_rgb16_NEON( const u32 *src, u16 *dst, int num )
+{
+     int x;
+
+     for (x=0; x<num-7; x+=8) {
+          uint8x8x4_t p   = vld4_u8( (const u8*)(src + x) );
+          uint16x8_t  rgb = vshll_n_u8( p.val[2], 8 );
+
+          rgb = vsriq_n_u16( rgb, vshll_n_u8( p.val[1], 8 ), 5 );
+          rgb = vsriq_n_u16( rgb, vshll_n_u8( p.val[0], 8 ), 11 );
+
+          vst1q_u16( dst + x, rgb );
+     }
+
+     argb_to_rgb16_C( src + x, dst + x, num - x );
+}
+
+static void
+rgb16_to_argb_NEON( const u16 *src, u32 *dst, int num, u32 alpha )
+{
+     const uint8x8_t a = vdup_n_u8( alpha >> 24 );
+     int             x;
+
+     for (x=0; x<num-7; x+=8) {
+          uint16x8_t  p = vld1q_u16( src + x );
+          uint8x8_t   r = vshrn_n_u16( p, 8 );
+          uint8x8_t   g = vshrn_n_u16( p, 3 );
+          uint8x8_t   b = vmovn_u16( vshlq_n_u16( p, 3 ) );
+          uint8x8x4_t o;
+
+          o.val[0] = vorr_u8( b, vshr_n_u8( b, 5 ) );
+          o.val[1] = vorr_u8( vand_u8( g, vdup_n_u8( 0xfc ) ), vshr_n_u8( g, 6 ) );
+          o.val[2] = vorr_u8( vand_u8( r, vdup_n_u8( 0xf8 ) ), vshr_n_u8( r, 5 ) );
+          o.val[3] = a;
+
+          vst4_u8( (u8*)(dst + x), o );
+     }
+
+     rgb16_to_argb_C( src + x, dst + x, num - x, alpha );
+}
+
+static void
+swap_rb_NEON( const u32 *src, u32 *dst, int num, u32 alpha )
+{
+     const uint8x8_t a = vdup_n_u8( alpha >> 24 );
+     int             x;
+
+     for (x=0; x<num-7; x+=8) {
+          uint8x8x4_t p = vld4_u8( (const u8*)(src + x) );
+          uint8x8_t   t = p.val[0];
+
+          p.val[0] = p.val[2];
+          p.val[2] = t;
+          p.val[3] = vorr_u8( p.val[3], a );
+
+          vst4_u8( (u8*)(dst + x), p );
+     }
+
+     swap_rb_C( src + x, dst + x, num - x, alpha );
+}
+
+static inline uint8x8_t
+ycbcr_channel( int32x4_t yl, int32x4_t yh, int32x4_t cl, int32x4_t ch )
+{
+     int16x8_t v = vcombine_s16( vshrn_n_s32( vaddq_s32( yl, cl ), 8 ), vshrn_n_s32( vaddq_s32( yh, ch ), 8 ) );
+
+     /* Saturation to 0..255 is the same as CLAMP(). */
+     return vqmovun_s16( v );
+}
+
+/*
+ * Eight pixels with their own chroma samples each, using the same terms as ycbcr_to_argb().
+ */
+static inline uint8x8x4_t
+ycbcr_8( const YCbCrMatrix *m, uint8x8_t y, uint8x8_t cb, uint8x8_t cr )
+{
+     int16x8_t   y16  = vsubq_s16( vreinterpretq_s16_u16( vmovl_u8( y ) ), vdupq_n_s16( m->y_offset ) );
+     int16x8_t   cb16 = vsubq_s16( vreinterpretq_s16_u16( vmovl_u8( cb ) ), vdupq_n_s16( 128 ) );
+     int16x8_t   cr16 = vsubq_s16( vreinterpretq_s16_u16( vmovl_u8( cr ) ), vdupq_n_s16( 128 ) );
+     int32x4_t   yl   = vmlal_n_s16( vdupq_n_s32( 128 ), vget_low_s16( y16 ),  m->y );
+     int32x4_t   yh   = vmlal_n_s16( vdupq_n_s32( 128 ), vget_high_s16( y16 ), m->y );
+     uint8x8x4_t o;
+
+     o.val[0] = ycbcr_channel( yl, yh,
+                               vmull_n_s16( vget_low_s16( cb16 ),  m->b_cb ),
+                               vmull_n_s16( vget_high_s16( cb16 ), m->b_cb ) );
+     o.val[1] = ycbcr_channel( yl, yh,
+                               vmlal_n_s16( vmull_n_s16( vget_low_s16( cb16 ),  -m->g_cb ), vget_low_s16( cr16 ),  -m->g_cr ),
+                               vmlal_n_s16( vmull_n_s16( vget_high_s16( cb16 ), -m->g_cb ), vget_high_s16( cr16 ), -m->g_cr ) );
+     o.val[2] = ycbcr_channel( yl, yh,
+                               vmull_n_s16( vget_low_s16( cr16 ),  m->r_cr ),
+                               vmull_n_s16( vget_high_s16( cr16 ), m->r_cr ) );
+     o.val[3] = vdup_n_u8( 0xff );
+
+     return o;
+}
+
+static void
+yuv_to_argb_NEON( const YCbCrMatrix *m, const u8 *y, const u8 *cb, const u8 *cr, int cstep, u32 *dst, int num )
+{
+     int x = 0;
+
+     if (cstep == 1) {
+          for (; x<num-7; x+=8) {
+               u32       c[2];
+               uint8x8_t cb8, cr8;
+
+               memcpy( &c[0], cb + x/2, 4 );
+               memcpy( &c[1], cr + x/2, 4 );
+
+               cb8 = vreinterpret_u8_u32( vdup_n_u32( c[0] ) );
+               cr8 = vreinterpret_u8_u32( vdup_n_u32( c[1] ) );
+
+               /* c0 c1 c2 c3 -> c0 c0 c1 c1 c2 c2 c3 c3 */
+               vst4_u8( (u8*)(dst + x),
+                        ycbcr_8( m, vld1_u8( y + x ), vzip_u8( cb8, cb8 ).val[0], vzip_u8( cr8, cr8 ).val[0] ) );
+          }
+     }
+     else if (cstep == 2 && (cr == cb + 1 || cb == cr + 1)) {
+          const u8 *uv = cb < cr ? cb : cr;
+
+          for (; x<num-7; x+=8) {
+               u64         c;
+               uint8x8x2_t p;
+
+               memcpy( &c, uv + x, 8 );
+
+               /* First and second bytes of the pairs, the lower half of each is used. NV21 has cr first. */
+               p = vuzp_u8( vcreate_u8( c ), vcreate_u8( c ) );
+
+               if (cb > cr) {
+                    uint8x8_t t = p.val[0];
+
+                    p.val[0] = p.val[1];
+                    p.val[1] = t;
+               }
+
+               vst4_u8( (u8*)(dst + x),
+                        ycbcr_8( m, vld1_u8( y + x ), vzip_u8( p.val[0], p.val[0] ).val[0],
+                                 vzip_u8( p.val[1], p.val[1] ).val[0] ) );
+          }
+     }
+
+     yuv_to_argb_C( m, y + x, cb + x/2 * cstep, cr + x/2 * cstep, cstep, dst + x, num - x );
+}
+
+static void
+yuy2_to_argb_NEON( const YCbCrMatrix *m, const u8 *src, u32 *dst, int num, bool uyvy )
+{
+     int x, i;
+
+     for (x=0; x<num-15; x+=16) {
+          /* Y0 U Y1 V (or U Y0 V Y1) of eight pixel pairs */
+          uint8x8x4_t p  = vld4_u8( src + x * 2 );
+          uint8x8_t   cb = uyvy ? p.val[0] : p.val[1];
+          uint8x8_t   cr = uyvy ? p.val[2] : p.val[3];
+          uint8x8x4_t e  = ycbcr_8( m, uyvy ? p.val[1] : p.val[0], cb, cr );
+          uint8x8x4_t o  = ycbcr_8( m, uyvy ? p.val[3] : p.val[2], cb, cr );
+          uint8x8x4_t lo, hi;
+
+          for (i=0; i<4; i++) {
+               uint8x8x2_t z = vzip_u8( e.val[i], o.val[i] );
+
+               lo.val[i] = z.val[0];
+               hi.val[i] = z.val[1];
+          }
+
+          vst4_u8( (u8*)(dst + x),     lo );
+          vst4_u8( (u8*)(dst + x + 8), hi );
+     }
+
+     yuy2_to_argb_C( m, src + x * 2, dst + x, num - x, uyvy );
+}
+
+#endif
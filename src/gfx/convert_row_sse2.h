@@ -0,0 +1,417 @@
+/*
+   (c) Copyright 2012-2013  DirectFB integrated media GmbH
+   (c) Copyright 2001-2013  The world wide DirectFB Open Source Community (directfb.org)
+   (c) Copyright 2000-2004  Convergence (integrated media) GmbH
+
+   All rights reserved.
+
+   Written by Denis Oliver Kropp <dok@directfb.org>,
+              Andreas Shimokawa <andi@directfb.org>,
+              Marek Pikarski <mass@directfb.org>,
+              Sven Neumann <neo@directfb.org>,
+              Ville Syrjälä <syrjala@sci.fi> and
+              Claudio Ciccani <klan@users.sf.net>.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+#ifndef __GFX__CONVERT_ROW_SSE2_H__
+#define __GFX__CONVERT_ROW_SSE2_H__
+
+#include <emmintrin.h>
+
+/*
+ * Eight pixels (four for 32 bit YCbCr) are converted per iteration, the remaining ones by the C versions.
+ */
+
+static inline __m128i
+load32( const void *src )
+{
+     int v;
+
+     memcpy( &v, src, 4 );
+
+     return _mm_cvtsi32_si128( v );
+}
+
+static inline __m128i
+coeff_pair( int a, int b )
+{
+     return _mm_set1_epi32( (u16) a | ((u32)(u16) b << 16) );
+}
+
+static inline __m128i
+swap_rb_4( __m128i v )
+{
+     const __m128i ga = _mm_set1_epi32( 0xff00ff00 );
+     const __m128i lo = _mm_set1_epi32( 0x000000ff );
+
+     return _mm_or_si128( _mm_and_si128( v, ga ),
+                          _mm_or_si128( _mm_slli_epi32( _mm_and_si128( v, lo ), 16 ),
+                                        _mm_and_si128( _mm_srli_epi32( v, 16 ), lo ) ) );
+}
+
+/* Four 32 bit pixels to twelve bytes, dropping the highest byte of each. */
+static inline __m128i
+pack_24( __m128i v )
+{
+     const __m128i lo32 = _mm_set_epi32( 0, 0x00ffffff, 0, 0x00ffffff );
+     const __m128i hi32 = _mm_set_epi32( 0x00ffffff, 0, 0x00ffffff, 0 );
+     const __m128i lo48 = _mm_set_epi32( 0, 0, 0x0000ffff, 0xffffffff );
+
+     v = _mm_or_si128( _mm_and_si128( v, lo32 ), _mm_srli_epi64( _mm_and_si128( v, hi32 ), 8 ) );
+
+     return _mm_or_si128( _mm_and_si128( v, lo48 ), _mm_andnot_si128( lo48, _mm_srli_si128( v, 2 ) ) );
+}
+
+/* Twelve bytes to four 32 bit pixels with the highest byte cleared, the reverse of pack_24(). */
+static inline __m128i
+unpack_24( __m128i v )
+{
+     const __m128i lo32 = _mm_set_epi32( 0, 0x00ffffff, 0, 0x00ffffff );
+     const __m128i hi32 = _mm_set_epi32( 0x00ffffff, 0, 0x00ffffff, 0 );
+     const __m128i lo48 = _mm_set_epi32( 0, 0, 0x0000ffff, 0xffffffff );
+
+     v = _mm_or_si128( _mm_and_si128( v, lo48 ), _mm_slli_si128( _mm_srli_si128( _mm_slli_si128( v, 4 ), 10 ), 8 ) );
+
+     return _mm_or_si128( _mm_and_si128( v, lo32 ), _mm_and_si128( _mm_slli_epi64( v, 8 ), hi32 ) );
+}
+
+static inline void
+argb_to_packed24_SSE2( const u32 *src, u8 *dst, int num, bool swap )
+{
+     int x;
+
+     for (x=0; x<num-7; x+=8, dst+=24) {
+          __m128i a = _mm_loadu_si128( (const __m128i*)(src + x) );
+          __m128i b = _mm_loadu_si128( (const __m128i*)(src + x + 4) );
+
+          if (swap) {
+               a = swap_rb_4( a );
+               b = swap_rb_4( b );
+          }
+
+          a = pack_24( a );
+          b = pack_24( b );
+
+          _mm_storeu_si128( (__m128i*) dst, _mm_or_si128( a, _mm_slli_si128( b, 12 ) ) );
+          _mm_storel_epi64( (__m128i*)(dst + 16), _mm_srli_si128( b, 4 ) );
+     }
+
+     if (swap)
+          argb_to_rgb888_C( src + x, dst, num - x );
+     else
+          argb_to_bgr888_C( src + x, dst, num - x );
+}
+
+static void
+argb_to_rgb888_SSE2( const u32 *src, u8 *dst, int num )
+{
+     argb_to_packed24_SSE2( src, dst, num, true );
+}
+
+static void
+argb_to_bgr888_SSE2( const u32 *src, u8 *dst, int num )
+{
+     argb_to_packed24_SSE2( src, dst, num, false );
+}
+
+static inline void
+packed24_to_argb_SSE2( const u8 *src, u32 *dst, int num, u32 alpha, bool swap )
+{
+     const __m128i va = _mm_set1_epi32( alpha );
+     int           x;
+
+     for (x=0; x<num-7; x+=8, src+=24) {
+          __m128i s0 = _mm_loadu_si128( (const __m128i*) src );
+          __m128i s1 = _mm_loadl_epi64( (const __m128i*)(src + 16) );
+          __m128i a  = unpack_24( s0 );
+          __m128i b  = unpack_24( _mm_or_si128( _mm_srli_si128( s0, 12 ), _mm_slli_si128( s1, 4 ) ) );
+
+          if (swap) {
+               a = swap_rb_4( a );
+               b = swap_rb_4( b );
+          }
+
+          _mm_storeu_si128( (__m128i*)(dst + x),     _mm_or_si128( a, va ) );
+          _mm_storeu_si128( (__m128i*)(dst + x + 4), _mm_or_si128( b, va ) );
+     }
+
+     if (swap)
+          rgb888_to_argb_C( src, dst + x, num - x, alpha );
+     else
+          bgr888_to_argb_C( src, dst + x, num - x, alpha );
+}
+
+static void
+rgb888_to_argb_SSE2( const u8 *src, u32 *dst, int num, u32 alpha )
+{
+     packed24_to_argb_SSE2( src, dst, num, alpha, true );
+}
+
+static void
+bgr888_to_argb_SSE2( const u8 *src, u32 *dst, int num, u32 alpha )
+{
+     packed24_to_argb_SSE2( src, dst, num, alpha, false );
+}
+
+static inline __m128i
+rgb16_4( __m128i v )
+{
+     v = _mm_or_si128( _mm_or_si128( _mm_srli_epi32( _mm_and_si128( v, _mm_set1_epi32( 0xf80000 ) ), 8 ),
+                                     _mm_srli_epi32( _mm_and_si128( v, _mm_set1_epi32( 0x00fc00 ) ), 5 ) ),
+                                     _mm_srli_epi32( _mm_and_si128( v, _mm_set1_epi32( 0x0000f8 ) ), 3 ) );
+
+     /* Sign extend to keep the values through the signed saturation of packssdw. */
+     return _mm_srai_epi32( _mm_slli_epi32( v, 16 ), 16 );
+}
+
+static void
+argb_to_rgb16_SSE2( const u32 *src, u16 *dst, int num )
+{
+     int x;
+
+     for (x=0; x<num-7; x+=8) {
+          __m128i a = rgb16_4( _mm_loadu_si128( (const __m128i*)(src + x) ) );
+          __m128i b = rgb16_4( _mm_loadu_si128( (const __m128i*)(src + x + 4) ) );
+
+          _mm_storeu_si128( (__m128i*)(dst + x), _mm_packs_epi32( a, b ) );
+     }
+
+     argb_to_rgb16_C( src + x, dst + x, num - x );
+}
+
+static inline __m128i
+argb_4( __m128i p, __m128i alpha )
+{
+     __m128i r = _mm_or_si128( _mm_slli_epi32( _mm_and_si128( p, _mm_set1_epi32( 0xf800 ) ), 8 ),
+                               _mm_slli_epi32( _mm_and_si128( p, _mm_set1_epi32( 0xe000 ) ), 3 ) );
+     __m128i g = _mm_or_si128( _mm_slli_epi32( _mm_and_si128( p, _mm_set1_epi32( 0x07e0 ) ), 5 ),
+                               _mm_srli_epi32( _mm_and_si128( p, _mm_set1_epi32( 0x0600 ) ), 1 ) );
+     __m128i b = _mm_or_si128( _mm_slli_epi32( _mm_and_si128( p, _mm_set1_epi32( 0x001f ) ), 3 ),
+                               _mm_srli_epi32( _mm_and_si128( p, _mm_set1_epi32( 0x001c ) ), 2 ) );
+
+     return _mm_or_si128( _mm_or_si128( r, g ), _mm_or_si128( b, alpha ) );
+}
+
+static void
+rgb16_to_argb_SSE2( const u16 *src, u32 *dst, int num, u32 alpha )
+{
+     const __m128i va   = _mm_set1_epi32( alpha );
+     const __m128i zero = _mm_setzero_si128();
+     int           x;
+
+     for (x=0; x<num-7; x+=8) {
+          __m128i p = _mm_loadu_si128( (const __m128i*)(src + x) );
+
+          _mm_storeu_si128( (__m128i*)(dst + x),     argb_4( _mm_unpacklo_epi16( p, zero ), va ) );
+          _mm_storeu_si128( (__m128i*)(dst + x + 4), argb_4( _mm_unpackhi_epi16( p, zero ), va ) );
+     }
+
+     rgb16_to_argb_C( src + x, dst + x, num - x, alpha );
+}
+
+static void
+swap_rb_SSE2( const u32 *src, u32 *dst, int num, u32 alpha )
+{
+     const __m128i va = _mm_set1_epi32( alpha );
+     int           x;
+
+     for (x=0; x<num-3; x+=4)
+          _mm_storeu_si128( (__m128i*)(dst + x),
+                            _mm_or_si128( swap_rb_4( _mm_loadu_si128( (const __m128i*)(src + x) ) ), va ) );
+
+     swap_rb_C( src + x, dst + x, num - x, alpha );
+}
+
+/*
+ * Eight pixels from eight luma values (16 bit) and four chroma pairs (16 bit cb, cr each) which are used by
+ * two pixels each. The terms are the same as in ycbcr_to_argb(), summed up with pmaddwd in 32 bit.
+ */
+static inline void
+ycbcr_8( const YCbCrMatrix *m, __m128i y, __m128i c, u32 *dst )
+{
+     const __m128i ones = _mm_set1_epi16( 1 );
+     const __m128i yc   = coeff_pair( m->y, 128 );
+     __m128i       yl, yh, rc, gc, bc, r, g, b, bg, ra;
+
+     y = _mm_sub_epi16( y, _mm_set1_epi16( m->y_offset ) );
+     c = _mm_sub_epi16( c, _mm_set1_epi16( 128 ) );
+
+     yl = _mm_madd_epi16( _mm_unpacklo_epi16( y, ones ), yc );
+     yh = _mm_madd_epi16( _mm_unpackhi_epi16( y, ones ), yc );
+
+     rc = _mm_madd_epi16( c, coeff_pair( 0, m->r_cr ) );
+     gc = _mm_madd_epi16( c, coeff_pair( -m->g_cb, -m->g_cr ) );
+     bc = _mm_madd_epi16( c, coeff_pair( m->b_cb, 0 ) );
+
+     r = _mm_packs_epi32( _mm_srai_epi32( _mm_add_epi32( yl, _mm_unpacklo_epi32( rc, rc ) ), 8 ),
+                          _mm_srai_epi32( _mm_add_epi32( yh, _mm_unpackhi_epi32( rc, rc ) ), 8 ) );
+     g = _mm_packs_epi32( _mm_srai_epi32( _mm_add_epi32( yl, _mm_unpacklo_epi32( gc, gc ) ), 8 ),
+                          _mm_srai_epi32( _mm_add_epi32( yh, _mm_unpackhi_epi32( gc, gc ) ), 8 ) );
+     b = _mm_packs_epi32( _mm_srai_epi32( _mm_add_epi32( yl, _mm_unpacklo_epi32( bc, bc ) ), 8 ),
+                          _mm_srai_epi32( _mm_add_epi32( yh, _mm_unpackhi_epi32( bc, bc ) ), 8 ) );
+
+     /* Saturation to 0..255 is the same as CLAMP(). */
+     r = _mm_packus_epi16( r, r );
+     g = _mm_packus_epi16( g, g );
+     b = _mm_packus_epi16( b, b );
+
+     bg = _mm_unpacklo_epi8( b, g );
+     ra = _mm_unpacklo_epi8( r, _mm_set1_epi8( 0xff ) );
+
+     _mm_storeu_si128( (__m128i*) dst,      _mm_unpacklo_epi16( bg, ra ) );
+     _mm_storeu_si128( (__m128i*)(dst + 4), _mm_unpackhi_epi16( bg, ra ) );
+}
+
+static void
+yuv_to_argb_SSE2( const YCbCrMatrix *m, const u8 *y, const u8 *cb, const u8 *cr, int cstep, u32 *dst, int num )
+{
+     const __m128i zero = _mm_setzero_si128();
+     int           x    = 0;
+
+     if (cstep == 1) {
+          for (; x<num-7; x+=8) {
+               __m128i c = _mm_unpacklo_epi8( load32( cb + x/2 ), load32( cr + x/2 ) );
+
+               ycbcr_8( m, _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i*)(y + x) ), zero ),
+                        _mm_unpacklo_epi8( c, zero ), dst + x );
+          }
+     }
+     else if (cstep == 2 && (cr == cb + 1 || cb == cr + 1)) {
+          const u8 *uv = cb < cr ? cb : cr;
+
+          for (; x<num-7; x+=8) {
+               __m128i c = _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i*)(uv + x) ), zero );
+
+               /* NV21 has cr first */
+               if (cb > cr)
+                    c = _mm_shufflehi_epi16( _mm_shufflelo_epi16( c, 0xb1 ), 0xb1 );
+
+               ycbcr_8( m, _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i*)(y + x) ), zero ), c, dst + x );
+          }
+     }
+
+     yuv_to_argb_C( m, y + x, cb + x/2 * cstep, cr + x/2 * cstep, cstep, dst + x, num - x );
+}
+
+static void
+yuy2_to_argb_SSE2( const YCbCrMatrix *m, const u8 *src, u32 *dst, int num, bool uyvy )
+{
+     const __m128i mask = _mm_set1_epi16( 0x00ff );
+     int           x;
+
+     for (x=0; x<num-7; x+=8) {
+          __m128i v = _mm_loadu_si128( (const __m128i*)(src + x * 2) );
+
+          if (uyvy)
+               ycbcr_8( m, _mm_srli_epi16( v, 8 ), _mm_and_si128( v, mask ), dst + x );
+          else
+               ycbcr_8( m, _mm_and_si128( v, mask ), _mm_srli_epi16( v, 8 ), dst + x );
+     }
+
+     yuy2_to_argb_C( m, src + x * 2, dst + x, num - x, uyvy );
+}
+
+/*
+ * Four pixels from the low 12 bytes of 'v' holding four bytes for each of the lowest, middle and highest
+ * component, the alpha is taken from 'a'.
+ */
+static inline __m128i
+interleave_4( __m128i v, __m128i a )
+{
+     __m128i lm = _mm_unpacklo_epi8( v, _mm_srli_si128( v, 4 ) );
+     __m128i h  = _mm_unpacklo_epi8( _mm_srli_si128( v, 8 ), _mm_setzero_si128() );
+
+     return _mm_or_si128( _mm_unpacklo_epi16( lm, h ), _mm_and_si128( a, _mm_set1_epi32( 0xff000000 ) ) );
+}
+
+/*
+ * Four AYUV pixels per iteration with one pmaddwd per term pair, in place operation is fine as
+ * each block is loaded before it is stored.
+ */
+static void
+ayuv_to_argb_SSE2( const YCbCrMatrix *m, const u32 *src, u32 *dst, int num )
+{
+     const __m128i m0   = _mm_set1_epi32( 0x000000ff );
+     const __m128i m16  = _mm_set1_epi32( 0x0000ffff );
+     const __m128i c128 = _mm_set1_epi32( 128 );
+     const __m128i ones = _mm_set1_epi32( 1 << 16 );
+     const __m128i kr   = coeff_pair( m->y, m->r_cr );
+     const __m128i kg0  = coeff_pair( m->y, -m->g_cb );
+     const __m128i kg1  = coeff_pair( -m->g_cr, 128 );
+     const __m128i kb   = coeff_pair( m->y, m->b_cb );
+     int           x;
+
+     for (x=0; x<num-3; x+=4) {
+          __m128i s  = _mm_loadu_si128( (const __m128i*)(src + x) );
+          __m128i y  = _mm_sub_epi32( _mm_and_si128( _mm_srli_epi32( s, 16 ), m0 ), _mm_set1_epi32( m->y_offset ) );
+          __m128i cb = _mm_sub_epi32( _mm_and_si128( _mm_srli_epi32( s,  8 ), m0 ), c128 );
+          __m128i cr = _mm_sub_epi32( _mm_and_si128( s, m0 ), c128 );
+          __m128i ycr, ycb, crc, r, g, b;
+
+          y   = _mm_and_si128( y, m16 );
+          ycr = _mm_or_si128( y, _mm_slli_epi32( cr, 16 ) );
+          ycb = _mm_or_si128( y, _mm_slli_epi32( cb, 16 ) );
+          crc = _mm_or_si128( _mm_and_si128( cr, m16 ), ones );
+
+          r = _mm_srai_epi32( _mm_add_epi32( _mm_madd_epi16( ycr, kr ), c128 ), 8 );
+          g = _mm_srai_epi32( _mm_add_epi32( _mm_madd_epi16( ycb, kg0 ), _mm_madd_epi16( crc, kg1 ) ), 8 );
+          b = _mm_srai_epi32( _mm_add_epi32( _mm_madd_epi16( ycb, kb ), c128 ), 8 );
+
+          /* Saturation to 0..255 is the same as CLAMP(). */
+          _mm_storeu_si128( (__m128i*)(dst + x),
+                            interleave_4( _mm_packus_epi16( _mm_packs_epi32( b, g ), _mm_packs_epi32( r, r ) ), s ) );
+     }
+
+     ayuv_to_argb_C( m, src + x, dst + x, num - x );
+}
+
+/*
+ * The constant terms are paired with 128 to fit into 16 bit, see argb_to_ycbcr().
+ */
+static void
+argb_to_ayuv_SSE2( const RGBMatrix *m, const u32 *src, u32 *dst, int num )
+{
+     const __m128i m0  = _mm_set1_epi32( 0x000000ff );
+     const __m128i m8  = _mm_set1_epi32( 0x0000ff00 );
+     const __m128i c   = _mm_set1_epi32( 128 << 16 );
+     const __m128i ky0 = coeff_pair( m->y_r,  m->y_g );
+     const __m128i ky1 = coeff_pair( m->y_b,  m->y_offset * 2 + 1 );
+     const __m128i ku0 = coeff_pair( m->cb_r, m->cb_g );
+     const __m128i ku1 = coeff_pair( m->cb_b, 257 );
+     const __m128i kv0 = coeff_pair( m->cr_r, m->cr_g );
+     const __m128i kv1 = coeff_pair( m->cr_b, 257 );
+     int           x;
+
+     for (x=0; x<num-3; x+=4) {
+          __m128i s  = _mm_loadu_si128( (const __m128i*)(src + x) );
+          __m128i rg = _mm_or_si128( _mm_and_si128( _mm_srli_epi32( s, 16 ), m0 ), _mm_slli_epi32( _mm_and_si128( s, m8 ), 8 ) );
+          __m128i bc = _mm_or_si128( _mm_and_si128( s, m0 ), c );
+          __m128i y, u, v;
+
+          y = _mm_srai_epi32( _mm_add_epi32( _mm_madd_epi16( rg, ky0 ), _mm_madd_epi16( bc, ky1 ) ), 8 );
+          u = _mm_srai_epi32( _mm_add_epi32( _mm_madd_epi16( rg, ku0 ), _mm_madd_epi16( bc, ku1 ) ), 8 );
+          v = _mm_srai_epi32( _mm_add_epi32( _mm_madd_epi16( rg, kv0 ), _mm_madd_epi16( bc, kv1 ) ), 8 );
+
+          _mm_storeu_si128( (__m128i*)(dst + x),
+                            interleave_4( _mm_packus_epi16( _mm_packs_epi32( v, u ), _mm_packs_epi32( y, y ) ), s ) );
+     }
+
+     argb_to_ayuv_C( m, src + x, dst + x, num - x );
+}
+
+#endif
@@ -42,6 +42,7 @@
 extern "C" {
 #include <direct/debug.h>
 #include <direct/messages.h>
+#include <direct/timeline.h>
 
 #include <core/core.h>
 #include <core/palette.h>
@@ -52,6 +53,8 @@ extern "C" {
 #include <gfx/clip.h>
 #include <gfx/convert.h>
 #include <gfx/generic/generic.h>
+
+#include <misc/gfx_util.h>
 }
 
 #include <core/Debug.h>
@@ -138,8 +141,10 @@ private:
           TYPE_SET_DESTINATION_PALETTE,
           TYPE_SET_SOURCE_PALETTE,
           TYPE_FILL_RECTS,
+          TYPE_FILL_COVERAGE_SPANS,
           TYPE_DRAW_LINES,
           TYPE_BLIT,
+          TYPE_DRAW_GLYPHS,
           TYPE_STRETCHBLIT,
           TYPE_TEXTURE_TRIANGLES
      } Type;
@@ -207,7 +212,8 @@ public:
                                                       DFXL_BLIT |
                                                       DFXL_STRETCHBLIT |
                                                       DFXL_TEXTRIANGLES);
-          caps.render_options = (DFBSurfaceRenderOptions)(DSRO_SMOOTH_DOWNSCALE | DSRO_SMOOTH_UPSCALE);
+          caps.render_options = (DFBSurfaceRenderOptions)(DSRO_SMOOTH_DOWNSCALE | DSRO_SMOOTH_UPSCALE |
+                                                          DSRO_SMOOTH_BICUBIC | DSRO_SMOOTH_LANCZOS);
           caps.max_operations = 300000;
 
           desc.name = "Genefx";
@@ -523,6 +529,52 @@ public:
      }
 
 
+     virtual DFBResult FillCoverageSpans( DirectFB::SurfaceTask  *task,
+                                          const CoreCoverageSpan *spans,
+                                          unsigned int           &num_spans )
+     {
+          GenefxTask *mytask = (GenefxTask *)task;
+          u32         count  = 0;
+          u32        *count_ptr;
+
+          D_DEBUG_AT( DirectFB_GenefxEngine, "GenefxEngine::%s( %d )  <- clip %d,%d-%dx%d\n", __FUNCTION__, num_spans,
+                      DFB_RECTANGLE_VALS_FROM_REGION(&mytask->clip) );
+
+          u32 *buf = (u32*) mytask->commands.GetBuffer( 4 * (2 + num_spans * 4) );
+
+          if (!buf)
+               return DFB_NOSYSTEMMEMORY;
+
+
+          *buf++ = GenefxTask::TYPE_FILL_COVERAGE_SPANS;
+
+          count_ptr = buf++;
+
+          for (unsigned int i=0; i<num_spans; i++) {
+               int x1 = MAX( spans[i].x, mytask->clip.x1 );
+               int x2 = MIN( spans[i].x + spans[i].w - 1, mytask->clip.x2 );
+
+               if (spans[i].y < mytask->clip.y1 || spans[i].y > mytask->clip.y2 || x1 > x2)
+                    continue;
+
+               *buf++ = x1;
+               *buf++ = spans[i].y;
+               *buf++ = x2 - x1 + 1;
+               *buf++ = spans[i].coverage;
+
+               count++;
+
+               mytask->addDrawingWeight( x2 - x1 + 1 );
+          }
+
+          *count_ptr = count;
+
+          mytask->commands.PutBuffer( buf );
+
+          return DFB_OK;
+     }
+
+
      virtual DFBResult DrawRectangles( DirectFB::SurfaceTask  *task,
                                        const DFBRectangle     *rects,
                                        unsigned int           &num_rects )
@@ -620,7 +672,32 @@ public:
                              const DFBPoint         *points,
                              u32                    &num )
      {
-          GenefxTask *mytask = (GenefxTask *)task;
+          D_DEBUG_AT( DirectFB_GenefxEngine, "GenefxEngine::%s( %d )\n", __FUNCTION__, num );
+
+          return encodeBlits( (GenefxTask *)task, GenefxTask::TYPE_BLIT, rects, points, num );
+     }
+
+
+     /*
+      * Same encoding as Blit(), but GenefxTask::Run() passes the whole run to gDrawGlyphs()
+      */
+     virtual DFBResult DrawGlyphs( DirectFB::SurfaceTask  *task,
+                                   const DFBRectangle     *rects,
+                                   const DFBPoint         *points,
+                                   u32                    &num )
+     {
+          D_DEBUG_AT( DirectFB_GenefxEngine, "GenefxEngine::%s( %d )\n", __FUNCTION__, num );
+
+          return encodeBlits( (GenefxTask *)task, GenefxTask::TYPE_DRAW_GLYPHS, rects, points, num );
+     }
+
+
+     DFBResult encodeBlits( GenefxTask             *mytask,
+                            GenefxTask::Type        type,
+                            const DFBRectangle     *rects,
+                            const DFBPoint         *points,
+                            u32                     num )
+     {
           u32         count  = 0;
           u32        *count_ptr;
 
@@ -633,7 +710,7 @@ public:
                return DFB_NOSYSTEMMEMORY;
 
 
-          *buf++ = GenefxTask::TYPE_BLIT;
+          *buf++ = type;
 
           count_ptr = buf++;
 
@@ -839,9 +916,13 @@ GenefxTask::Run()
      CardState            state;
      bool                 single_tile;
      bool                 disable_rendering = false;
+     long long            start             = direct_timeline_now();
 
      D_DEBUG_AT( DirectFB_GenefxTask, "GenefxTask::%s()\n", __FUNCTION__ );
 
+     /* Several tasks run at once on the Genefx threads, keep band parallel operations on this thread. */
+     dfb_gfx_worker_begin();
+
      dfb_state_init( &state, core_dfb );
 
      state.destination = &dest;
@@ -1054,6 +1135,47 @@ GenefxTask::Run()
                               i += num * 4;
                          break;
 
+                    case GenefxTask::TYPE_FILL_COVERAGE_SPANS:
+                         D_DEBUG_AT( DirectFB_GenefxTask, "  -> FILL_COVERAGE_SPANS\n" );
+
+                         num = buffer[++i];
+                         D_DEBUG_AT( DirectFB_GenefxTask, "  -> num %d\n", num );
+
+                         if (!disable_rendering && num && gAcquireSetup( &state, DFXL_FILLRECTANGLE )) {
+                              Util::TempArray<CoreCoverageSpan> spans( num );
+                              u32                               count = 0;
+
+                              for (u32 n=0; n<num; n++) {
+                                   CoreCoverageSpan &span = spans.array[count];
+
+                                   span.x        = buffer[++i];
+                                   span.y        = buffer[++i];
+                                   span.w        = buffer[++i];
+                                   span.coverage = buffer[++i];
+
+                                   D_DEBUG_AT( DirectFB_GenefxTask, "  -> %4d,%4d-%4d [%3d]\n", span.x, span.y, span.w, span.coverage );
+
+                                   if (!single_tile) {
+                                        int x1 = MAX( span.x, state.clip.x1 );
+                                        int x2 = MIN( span.x + span.w - 1, state.clip.x2 );
+
+                                        if (span.y < state.clip.y1 || span.y > state.clip.y2 || x1 > x2)
+                                             continue;
+
+                                        span.x = x1;
+                                        span.w = x2 - x1 + 1;
+                                   }
+
+                                   count++;
+                              }
+
+                              if (count)
+                                   gFillCoverageSpans( &state, spans, count );
+                         }
+                         else
+                              i += num * 4;
+                         break;
+
                     case GenefxTask::TYPE_DRAW_LINES:
                          D_DEBUG_AT( DirectFB_GenefxTask, "  -> DRAW_LINES\n" );
 
@@ -1118,6 +1240,47 @@ GenefxTask::Run()
                               i += num * 6;
                          break;
 
+                    case GenefxTask::TYPE_DRAW_GLYPHS:
+                         D_DEBUG_AT( DirectFB_GenefxTask, "  -> DRAW_GLYPHS\n" );
+
+                         num = buffer[++i];
+                         D_DEBUG_AT( DirectFB_GenefxTask, "  -> num %d\n", num );
+
+                         if (!disable_rendering && num && gAcquireSetup( &state, DFXL_BLIT )) {
+                              Util::TempArray<DFBRectangle> rects( num );
+                              Util::TempArray<DFBPoint>     points( num );
+                              u32                           count = 0;
+
+                              for (u32 n=0; n<num; n++) {
+                                   DFBRectangle &rect  = rects.array[count];
+                                   DFBPoint     &point = points.array[count];
+
+                                   rect.x  = buffer[++i];
+                                   rect.y  = buffer[++i];
+                                   rect.w  = buffer[++i];
+                                   rect.h  = buffer[++i];
+                                   point.x = buffer[++i];
+                                   point.y = buffer[++i];
+
+                                   D_DEBUG_AT( DirectFB_GenefxTask, "  -> %4d,%4d-%4dx%4d -> %4d,%4d\n",
+                                               rect.x, rect.y, rect.w, rect.h, point.x, point.y );
+
+                                   if (single_tile)
+                                        count++;
+                                   else if (dfb_clip_blit_precheck( &state.clip, rect.w, rect.h, point.x, point.y )) {
+                                        dfb_clip_blit( &state.clip, &rect, &point.x, &point.y );
+
+                                        count++;
+                                   }
+                              }
+
+                              if (count)
+                                   gDrawGlyphs( &state, rects, points, count );
+                         }
+                         else
+                              i += num * 6;
+                         break;
+
                     case GenefxTask::TYPE_STRETCHBLIT:
                          D_DEBUG_AT( DirectFB_GenefxTask, "  -> STRETCHBLIT\n" );
 
@@ -1192,6 +1355,10 @@ GenefxTask::Run()
 
      dfb_state_destroy( &state );
 
+     dfb_gfx_worker_end();
+
+     direct_timeline_complete( "genefx", "Tile", tile_number, start );
+
      /* Return task to manager */
      Done();
 
@@ -8930,6 +8930,8 @@ gAcquireSetup( CardState *state, DFBAccelerationMask accel )
      gfxs  = state->gfxs;
      funcs = gfxs->funcs;
 
+     gfxs->glyphs = false;
+
 
      /*
       * Destination setup
@@ -9066,7 +9068,8 @@ gAcquireSetup( CardState *state, DFBAccelerationMask accel )
      }
 
 
-     gfxs->color = color;
+     gfxs->color    = color;
+     gfxs->coverage = Bop_a8_set_alphapixel_Aop_PFI[dst_pfi];
 
 
      switch (gfxs->dst_format) {
@@ -9554,6 +9557,7 @@ gAcquireSetup( CardState *state, DFBAccelerationMask accel )
                {
                     if (gfxs->src_format == DSPF_A8 && Bop_a8_set_alphapixel_Aop_PFI[dst_pfi]) {
                          *funcs++ = Bop_a8_set_alphapixel_Aop_PFI[dst_pfi];
+                         gfxs->glyphs = true;
                          break;
                     }
                     if (gfxs->src_format == DSPF_A1 && Bop_a1_set_alphapixel_Aop_PFI[dst_pfi]) {
@@ -170,6 +170,9 @@ struct _GenefxState {
      int Xphase;    /* initial value for fractional steps (zero if not clipped) */
 
      bool need_accumulator;
+     bool glyphs;   /* pipeline is a single Bop_a8_set_alphapixel_Aop_* function, see gDrawGlyphs() */
+
+     GenefxFunc coverage;   /* Bop_a8_set_alphapixel_Aop_* of the destination format, if any */
 
      int *trans;
      int  num_trans;
@@ -203,6 +206,16 @@ void gDrawLine      ( CardState *state, DFBRegion    *line );
 void gBlit          ( CardState *state, DFBRectangle *rect, int dx, int dy );
 void gStretchBlit   ( CardState *state, DFBRectangle *srect, DFBRectangle *drect );
 
+/*
+ * Renders a run of already clipped A8 glyphs, one source rectangle and destination point each.
+ */
+void gDrawGlyphs    ( CardState *state, const DFBRectangle *rects, const DFBPoint *points, int num );
+
+/*
+ * Renders already clipped coverage spans after acquiring DFXL_FILLRECTANGLE, see dfb_gfxcard_fill_coverage_spans().
+ */
+void gFillCoverageSpans( CardState *state, const CoreCoverageSpan *spans, int num );
+
 
 void Genefx_TextureTriangles( CardState            *state,
                               DFBVertex            *vertices,
@@ -0,0 +1,398 @@
+/*
+   (c) Copyright 2012-2013  DirectFB integrated media GmbH
+   (c) Copyright 2001-2013  The world wide DirectFB Open Source Community (directfb.org)
+   (c) Copyright 2000-2004  Convergence (integrated media) GmbH
+
+   All rights reserved.
+
+   Written by Denis Oliver Kropp <dok@directfb.org>,
+              Andreas Shimokawa <andi@directfb.org>,
+              Marek Pikarski <mass@directfb.org>,
+              Sven Neumann <neo@directfb.org>,
+              Ville Syrjälä <syrjala@sci.fi> and
+              Claudio Ciccani <klan@users.sf.net>.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+#include <config.h>
+
+#include <string.h>
+
+#include <directfb.h>
+
+#include <core/state.h>
+
+#include <misc/conf.h>
+
+#include <direct/util.h>
+
+#include "generic.h"
+
+/**********************************************************************************************************************/
+
+typedef void (*GlyphRowFunc)( const GenefxState *gfxs, const u8 *S, void *D, int w );
+
+/*
+ * The row functions produce exactly the same result as Bop_a8_set_alphapixel_Aop_argb/rgb32(),
+ * which are used for other formats and when there's no vectorized version.
+ */
+
+static inline u32
+glyph_pixel_argb( u32 d, u32 a, u32 rb, u32 g )
+{
+     u32 s  = a + 1;
+     u32 s1 = 256 - a;
+     u32 sa = (((d >> 24) * s1) >> 8) + a;
+
+     /* Also correct for a = 0 (keeps d) and a = 0xff (gives the color). */
+     return (sa << 24) +
+            (((((d & 0x00ff00ff)       * s1) + (rb * s)) >> 8) & 0x00ff00ff) +
+            (((((d & 0x0000ff00) >> 8) * s1) + (g  * s))       & 0x0000ff00);
+}
+
+static inline u32
+glyph_pixel_rgb32( u32 d, u32 a, u32 Cop )
+{
+     u32 s, t1, t2;
+
+     switch (a) {
+          case 0xff:
+               return Cop;
+
+          case 0:
+               return d;
+     }
+
+     s  = a + 1;
+     t1 = d & 0x00ff00ff;
+     t2 = d & 0x0000ff00;
+
+     return (((((Cop & 0xff00ff) - t1) * s + (t1 << 8)) & 0xff00ff00) +
+             ((((Cop & 0x00ff00) - t2) * s + (t2 << 8)) & 0x00ff0000)) >> 8;
+}
+
+#if defined(USE_SSE) && defined(__SSE2__)
+
+#include <emmintrin.h>
+
+/*
+ * Four pixels per iteration in 16 bit per channel, d * (256 - a) + c * (a + 1) can't exceed 0xffff.
+ * Groups of four fully transparent or fully opaque pixels are skipped or filled.
+ */
+static void
+glyph_row_argb_SSE2( const GenefxState *gfxs, const u8 *S, void *D, int w )
+{
+     const u32     Cop   = gfxs->Cop | 0xff000000;
+     const __m128i zero  = _mm_setzero_si128();
+     const __m128i c     = _mm_unpacklo_epi8( _mm_cvtsi32_si128( Cop & 0x00ffffff ), zero );
+     const __m128i cc    = _mm_unpacklo_epi64( c, c );
+     const __m128i v256  = _mm_set1_epi16( 256 );
+     const __m128i ones  = _mm_set1_epi16( 1 );
+     const __m128i amask = _mm_set_epi16( -1, 0, 0, 0, -1, 0, 0, 0 );
+     u32          *d     = D;
+     int           x;
+
+     for (x=0; x<w-3; x+=4) {
+          u32     a4;
+          __m128i a, al, ah, dl, dh, pd;
+
+          memcpy( &a4, S + x, 4 );
+
+          if (!a4)
+               continue;
+
+          if (a4 == 0xffffffff) {
+               _mm_storeu_si128( (__m128i*)(d + x), _mm_set1_epi32( Cop ) );
+               continue;
+          }
+
+          /* a0 a0 a0 a0 a1 a1 a1 a1 (a2, a3) */
+          a  = _mm_unpacklo_epi8( _mm_cvtsi32_si128( a4 ), zero );
+          a  = _mm_unpacklo_epi16( a, a );
+          al = _mm_unpacklo_epi32( a, a );
+          ah = _mm_unpackhi_epi32( a, a );
+
+          pd = _mm_loadu_si128( (const __m128i*)(d + x) );
+          dl = _mm_unpacklo_epi8( pd, zero );
+          dh = _mm_unpackhi_epi8( pd, zero );
+
+          /* (d * (256 - a) + c * (a + 1)) >> 8, alpha being (d * (256 - a)) >> 8 + a */
+          dl = _mm_add_epi16( _mm_srli_epi16( _mm_add_epi16( _mm_mullo_epi16( dl, _mm_sub_epi16( v256, al ) ),
+                                                             _mm_mullo_epi16( cc, _mm_add_epi16( al, ones ) ) ), 8 ),
+                              _mm_and_si128( al, amask ) );
+          dh = _mm_add_epi16( _mm_srli_epi16( _mm_add_epi16( _mm_mullo_epi16( dh, _mm_sub_epi16( v256, ah ) ),
+                                                             _mm_mullo_epi16( cc, _mm_add_epi16( ah, ones ) ) ), 8 ),
+                              _mm_and_si128( ah, amask ) );
+
+          _mm_storeu_si128( (__m128i*)(d + x), _mm_packus_epi16( dl, dh ) );
+     }
+
+     for (; x<w; x++)
+          d[x] = glyph_pixel_argb( d[x], S[x], Cop & 0x00ff00ff, gfxs->color.g );
+}
+
+/*
+ * Like the ARGB version with d * (255 - a) + c * (a + 1), the alpha byte being cleared except for
+ * the pixels which are kept (a = 0) or replaced by the color (a = 0xff).
+ */
+static void
+glyph_row_rgb32_SSE2( const GenefxState *gfxs, const u8 *S, void *D, int w )
+{
+     const u32     Cop   = gfxs->Cop;
+     const __m128i zero  = _mm_setzero_si128();
+     const __m128i c     = _mm_unpacklo_epi8( _mm_cvtsi32_si128( Cop & 0x00ffffff ), zero );
+     const __m128i cc    = _mm_unpacklo_epi64( c, c );
+     const __m128i v255  = _mm_set1_epi16( 255 );
+     const __m128i ones  = _mm_set1_epi16( 1 );
+     const __m128i rgb   = _mm_set1_epi32( 0x00ffffff );
+     const __m128i vcop  = _mm_set1_epi32( Cop );
+     u32          *d     = D;
+     int           x;
+
+     for (x=0; x<w-3; x+=4) {
+          u32     a4;
+          __m128i a, a32, al, ah, dl, dh, pd, r, keep, fill;
+
+          memcpy( &a4, S + x, 4 );
+
+          if (!a4)
+               continue;
+
+          if (a4 == 0xffffffff) {
+               _mm_storeu_si128( (__m128i*)(d + x), vcop );
+               continue;
+          }
+
+          a   = _mm_unpacklo_epi8( _mm_cvtsi32_si128( a4 ), zero );
+          a32 = _mm_unpacklo_epi16( a, zero );
+          a   = _mm_unpacklo_epi16( a, a );
+          al  = _mm_unpacklo_epi32( a, a );
+          ah  = _mm_unpackhi_epi32( a, a );
+
+          pd = _mm_loadu_si128( (const __m128i*)(d + x) );
+          dl = _mm_unpacklo_epi8( pd, zero );
+          dh = _mm_unpackhi_epi8( pd, zero );
+
+          dl = _mm_srli_epi16( _mm_add_epi16( _mm_mullo_epi16( dl, _mm_sub_epi16( v255, al ) ),
+                                              _mm_mullo_epi16( cc, _mm_add_epi16( al, ones ) ) ), 8 );
+          dh = _mm_srli_epi16( _mm_add_epi16( _mm_mullo_epi16( dh, _mm_sub_epi16( v255, ah ) ),
+                                              _mm_mullo_epi16( cc, _mm_add_epi16( ah, ones ) ) ), 8 );
+
+          r    = _mm_and_si128( _mm_packus_epi16( dl, dh ), rgb );
+          keep = _mm_cmpeq_epi32( a32, zero );
+          fill = _mm_cmpeq_epi32( a32, _mm_set1_epi32( 0xff ) );
+
+          r = _mm_or_si128( _mm_andnot_si128( _mm_or_si128( keep, fill ), r ),
+                            _mm_or_si128( _mm_and_si128( keep, pd ), _mm_and_si128( fill, vcop ) ) );
+
+          _mm_storeu_si128( (__m128i*)(d + x), r );
+     }
+
+     for (; x<w; x++)
+          d[x] = glyph_pixel_rgb32( d[x], S[x], Cop );
+}
+
+#endif
+
+static void
+glyph_row_argb_C( const GenefxState *gfxs, const u8 *S, void *D, int w )
+{
+     const u32  Cop = gfxs->Cop | 0xff000000;
+     u32       *d   = D;
+     int        x;
+
+     for (x=0; x<w; x++) {
+          if (S[x])
+               d[x] = glyph_pixel_argb( d[x], S[x], Cop & 0x00ff00ff, gfxs->color.g );
+     }
+}
+
+static void
+glyph_row_rgb32_C( const GenefxState *gfxs, const u8 *S, void *D, int w )
+{
+     u32 *d = D;
+     int  x;
+
+     for (x=0; x<w; x++)
+          d[x] = glyph_pixel_rgb32( d[x], S[x], gfxs->Cop );
+}
+
+static GlyphRowFunc glyph_row_argb  = glyph_row_argb_C;
+static GlyphRowFunc glyph_row_rgb32 = glyph_row_rgb32_C;
+
+static void
+init_glyph_rows( void )
+{
+     static bool initialized = false;
+
+     if (initialized)
+          return;
+
+     initialized = true;
+
+#if defined(USE_SSE) && defined(__SSE2__)
+     /* Same switch as for MMX, "no-mmx" turns off all x86 SIMD code. */
+     if (dfb_config->mmx) {
+          glyph_row_argb  = glyph_row_argb_SSE2;
+          glyph_row_rgb32 = glyph_row_rgb32_SSE2;
+     }
+#endif
+}
+
+/*
+ * Runs the A8 function of the destination format on one row, which is the whole pipeline for glyphs.
+ */
+static void
+glyph_row_pipeline( const GenefxState *gfxs, const u8 *S, void *D, int w )
+{
+     GenefxState *state = (GenefxState*) gfxs;
+
+     state->Aop[0] = D;
+     state->Bop[0] = (void*) S;
+     state->length = w;
+
+     state->coverage( state );
+}
+
+static GlyphRowFunc
+glyph_row_func( const GenefxState *gfxs )
+{
+     init_glyph_rows();
+
+     switch (gfxs->dst_format) {
+          case DSPF_ARGB:
+          case DSPF_ABGR:
+               return glyph_row_argb;
+
+          case DSPF_RGB32:
+               return glyph_row_rgb32;
+
+          default:
+               return glyph_row_pipeline;
+     }
+}
+
+static bool
+glyph_row_direct( const GenefxState *gfxs )
+{
+     return gfxs->coverage &&
+            !DFB_PLANAR_PIXELFORMAT( gfxs->dst_format ) &&
+            gfxs->dst_format != DSPF_YUY2 && gfxs->dst_format != DSPF_UYVY &&
+            !(gfxs->dst_caps & DSCAPS_SEPARATED) &&
+            !dfb_config->software_warn && !dfb_config->software_trace;
+}
+
+/**********************************************************************************************************************/
+
+void gDrawGlyphs( CardState *state, const DFBRectangle *rects, const DFBPoint *points, int num )
+{
+     GenefxState  *gfxs = state->gfxs;
+     GlyphRowFunc  func;
+     int           i;
+
+     D_ASSERT( gfxs != NULL );
+     D_ASSERT( rects != NULL );
+     D_ASSERT( points != NULL );
+
+     /*
+      * Anything else than the plain A8 glyph pipeline on a single plane is done blit by blit,
+      * also when warning about or tracing software operations.
+      */
+     if (!gfxs->glyphs || gfxs->funcs[0] != gfxs->coverage || gfxs->funcs[1] || !glyph_row_direct( gfxs ) ||
+         (gfxs->src_caps & DSCAPS_SEPARATED) || gfxs->src_org[0] == gfxs->dst_org[0])
+     {
+          for (i=0; i<num; i++) {
+               DFBRectangle rect = rects[i];
+
+               gBlit( state, &rect, points[i].x, points[i].y );
+          }
+
+          return;
+     }
+
+     func = glyph_row_func( gfxs );
+
+     for (i=0; i<num; i++) {
+          const u8 *S = (const u8*) gfxs->src_org[0] + rects[i].y * gfxs->src_pitch + rects[i].x;
+          u8       *D = (u8*) gfxs->dst_org[0] + points[i].y * gfxs->dst_pitch + points[i].x * gfxs->dst_bpp;
+          int       h;
+
+          D_ASSERT( state->clip.x1 <= points[i].x );
+          D_ASSERT( state->clip.y1 <= points[i].y );
+          D_ASSERT( state->clip.x2 >= (points[i].x + rects[i].w - 1) );
+          D_ASSERT( state->clip.y2 >= (points[i].y + rects[i].h - 1) );
+
+          for (h=0; h<rects[i].h; h++) {
+               func( gfxs, S, D, rects[i].w );
+
+               S += gfxs->src_pitch;
+               D += gfxs->dst_pitch;
+          }
+     }
+}
+
+void gFillCoverageSpans( CardState *state, const CoreCoverageSpan *spans, int num )
+{
+     GenefxState  *gfxs = state->gfxs;
+     GlyphRowFunc  func;
+     u8            row[256];
+     int           i, x, a, last = -1;
+
+     D_ASSERT( gfxs != NULL );
+     D_ASSERT( spans != NULL );
+
+     /*
+      * The A8 functions do source over, other drawing flags and blend functions get solid spans.
+      */
+     if (!glyph_row_direct( gfxs ) ||
+         (state->drawingflags != DSDRAW_NOFX &&
+          (state->drawingflags != DSDRAW_BLEND ||
+           state->src_blend != DSBF_SRCALPHA || state->dst_blend != DSBF_INVSRCALPHA)))
+     {
+          for (i=0; i<num; i++) {
+               DFBRectangle rect = { spans[i].x, spans[i].y, spans[i].w, 1 };
+
+               if (spans[i].coverage >= 0x80)
+                    gFillRectangle( state, &rect );
+          }
+
+          return;
+     }
+
+     func = glyph_row_func( gfxs );
+
+     for (i=0; i<num; i++) {
+          u8 *D = (u8*) gfxs->dst_org[0] + spans[i].y * gfxs->dst_pitch + spans[i].x * gfxs->dst_bpp;
+
+          D_ASSERT( state->clip.x1 <= spans[i].x );
+          D_ASSERT( state->clip.y1 <= spans[i].y );
+          D_ASSERT( state->clip.x2 >= (spans[i].x + spans[i].w - 1) );
+          D_ASSERT( state->clip.y2 >= spans[i].y );
+
+          a = (spans[i].coverage * (gfxs->color.a + 1)) >> 8;
+          if (!a)
+               continue;
+
+          if (a != last) {
+               memset( row, a, sizeof(row) );
+               last = a;
+          }
+
+          for (x=0; x<spans[i].w; x+=sizeof(row))
+               func( gfxs, row, D + x * gfxs->dst_bpp, MIN( spans[i].w - x, (int) sizeof(row) ) );
+     }
+}
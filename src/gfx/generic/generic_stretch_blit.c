@@ -50,6 +50,7 @@
 #include <core/state.h>
 #include <core/palette.h>
 
+#include <misc/gfx_resample.h>
 #include <misc/gfx_util.h>
 #include <misc/util.h>
 #include <misc/conf.h>
@@ -694,6 +695,102 @@ stretch_hvx( CardState *state, DFBRectangle *srect, DFBRectangle *drect )
 }
 #endif /* DFB_SMOOTH_SCALING */
 
+/**********************************************************************************************************************/
+/*** Bicubic and Lanczos filtering ************************************************************************************/
+/**********************************************************************************************************************/
+
+typedef struct {
+     const DFBResampler *resampler;
+     const void         *src;
+     int                 spitch;
+     u8                 *dst;         /* first pixel of the clipped destination */
+     int                 dpitch;
+     int                 x1;
+     int                 x2;
+     int                 y1;
+} ResampleCtx;
+
+static void
+resample_row( void *arg, int y, const u32 *row )
+{
+     const ResampleCtx *ctx = arg;
+
+     direct_memcpy( ctx->dst + (y - ctx->y1) * ctx->dpitch, row, (ctx->x2 - ctx->x1) * 4 );
+}
+
+static void
+resample_band( void *arg, int y1, int y2 )
+{
+     const ResampleCtx *ctx = arg;
+
+     dfb_resampler_run( ctx->resampler, ctx->src, ctx->spitch, ctx->x1, ctx->x2, y1, y2, resample_row, (void*) ctx );
+}
+
+/*
+ * Separable filtering of 32 bit sources for DSRO_SMOOTH_BICUBIC and DSRO_SMOOTH_LANCZOS,
+ * processing row bands of the destination on the band worker threads. Within a Genefx task,
+ * i.e. per tile, the bands are processed inline (see dfb_gfx_worker_begin()).
+ */
+__attribute__((noinline))
+static bool
+stretch_resample( CardState *state, DFBRectangle *srect, DFBRectangle *drect )
+{
+     GenefxState       *gfxs = state->gfxs;
+     DFBResampleFilter  filter;
+     DFBResampleFlags   flags = DRSF_NONE;
+     DFBResampler       resampler;
+     ResampleCtx        ctx;
+     DFBRegion          clip;
+
+     if (srect->w > drect->w && srect->h > drect->h) {
+          if (!(state->render_options & DSRO_SMOOTH_DOWNSCALE))
+               return false;
+     }
+     else {
+          if (!(state->render_options & DSRO_SMOOTH_UPSCALE))
+               return false;
+     }
+
+     if (state->blittingflags != DSBLIT_NOFX)
+          return false;
+
+     if ((gfxs->src_format != DSPF_ARGB && gfxs->src_format != DSPF_RGB32) ||
+         (gfxs->dst_format != DSPF_ARGB && gfxs->dst_format != DSPF_RGB32))
+          return false;
+
+     filter = (state->render_options & DSRO_SMOOTH_LANCZOS) ? DRF_LANCZOS : DRF_BICUBIC;
+
+     if (gfxs->src_format == DSPF_RGB32 || gfxs->dst_format == DSPF_RGB32)
+          flags = DRSF_OPAQUE;
+     else if (state->source->config.caps & DSCAPS_PREMULTIPLIED)
+          flags = DRSF_SRC_PREMULTIPLIED | DRSF_DST_PREMULTIPLIED;
+
+     clip = state->clip;
+
+     if (!dfb_region_rectangle_intersect( &clip, drect ))
+          return true;
+
+     dfb_region_translate( &clip, - drect->x, - drect->y );
+
+     if (dfb_resampler_init( &resampler, filter, flags, srect->w, srect->h, drect->w, drect->h ))
+          return false;
+
+     ctx.resampler = &resampler;
+     ctx.src       = gfxs->src_org[0] + srect->y * gfxs->src_pitch + srect->x * 4;
+     ctx.spitch    = gfxs->src_pitch;
+     ctx.dst       = gfxs->dst_org[0] + (drect->y + clip.y1) * gfxs->dst_pitch + (drect->x + clip.x1) * 4;
+     ctx.dpitch    = gfxs->dst_pitch;
+     ctx.x1        = clip.x1;
+     ctx.x2        = clip.x2 + 1;
+     ctx.y1        = clip.y1;
+
+     dfb_gfx_run_bands( resample_band, &ctx, clip.y1, clip.y2 + 1 );
+
+     dfb_resampler_deinit( &resampler );
+
+     return true;
+}
+
 void gStretchBlit( CardState *state, DFBRectangle *srect, DFBRectangle *drect )
 {
      GenefxState    *gfxs  = state->gfxs;
@@ -729,6 +826,10 @@ void gStretchBlit( CardState *state, DFBRectangle *srect, DFBRectangle *drect )
 
      CHECK_PIPELINE();
 
+     if (state->render_options & (DSRO_SMOOTH_BICUBIC | DSRO_SMOOTH_LANCZOS) && !rotated &&
+         stretch_resample( state, srect, drect ))
+          return;
+
 #if DFB_SMOOTH_SCALING
      if (state->render_options & (DSRO_SMOOTH_UPSCALE | DSRO_SMOOTH_DOWNSCALE) &&
          stretch_hvx( state, srect, drect ))
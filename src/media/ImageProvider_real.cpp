@@ -183,4 +183,15 @@ IImageProvider_Real::RenderTo(
 }
 
 
+DFBResult
+IImageProvider_Real::SetSourceRectangle(
+                    const DFBRectangle                        *rect
+)
+{
+     D_MAGIC_ASSERT( obj, ImageProviderDispatch );
+
+     return obj->provider->SetSourceRectangle( obj->provider, rect );
+}
+
+
 }
@@ -233,6 +233,22 @@ IDirectFBDataBuffer_CreateFont( IDirectFBDataBuffer       *thiz,
 #endif
 }
 
+static DFBResult
+IDirectFBDataBuffer_GetDataPointer( IDirectFBDataBuffer  *thiz,
+                                    const void          **ret_data,
+                                    unsigned int         *ret_length )
+{
+     return DFB_UNSUPPORTED;
+}
+
+static DFBResult
+IDirectFBDataBuffer_PeekDataPointer( IDirectFBDataBuffer  *thiz,
+                                     const void          **ret_data,
+                                     unsigned int         *ret_length )
+{
+     return DFB_UNSUPPORTED;
+}
+
 DFBResult
 IDirectFBDataBuffer_Construct( IDirectFBDataBuffer *thiz,
                                const char          *filename,
@@ -269,6 +285,8 @@ IDirectFBDataBuffer_Construct( IDirectFBDataBuffer *thiz,
      thiz->CreateImageProvider    = IDirectFBDataBuffer_CreateImageProvider;
      thiz->CreateVideoProvider    = IDirectFBDataBuffer_CreateVideoProvider;
      thiz->CreateFont             = IDirectFBDataBuffer_CreateFont;
+     thiz->GetDataPointer         = IDirectFBDataBuffer_GetDataPointer;
+     thiz->PeekDataPointer        = IDirectFBDataBuffer_PeekDataPointer;
      
      return DFB_OK;
 }
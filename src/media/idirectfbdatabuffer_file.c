@@ -257,6 +257,25 @@ IDirectFBDataBuffer_File_PutData( IDirectFBDataBuffer *thiz,
      return DFB_UNSUPPORTED;
 }
 
+static DFBResult
+IDirectFBDataBuffer_File_GetDataPointer( IDirectFBDataBuffer  *thiz,
+                                         const void          **ret_data,
+                                         unsigned int         *ret_length )
+{
+     DFBResult ret;
+
+     DIRECT_INTERFACE_GET_DATA(IDirectFBDataBuffer_File)
+
+     if (!ret_data || !ret_length)
+          return DFB_INVARG;
+
+     direct_mutex_lock( &data->mutex );
+     ret = direct_stream_map( data->stream, ret_data, ret_length );
+     direct_mutex_unlock( &data->mutex );
+
+     return ret;
+}
+
 DFBResult
 IDirectFBDataBuffer_File_Construct( IDirectFBDataBuffer *thiz,
                                     const char          *filename,
@@ -291,6 +310,7 @@ IDirectFBDataBuffer_File_Construct( IDirectFBDataBuffer *thiz,
      thiz->PeekData               = IDirectFBDataBuffer_File_PeekData;
      thiz->HasData                = IDirectFBDataBuffer_File_HasData;
      thiz->PutData                = IDirectFBDataBuffer_File_PutData;
+     thiz->GetDataPointer         = IDirectFBDataBuffer_File_GetDataPointer;
 
      return DFB_OK;
 }
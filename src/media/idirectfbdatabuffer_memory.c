@@ -222,6 +222,22 @@ IDirectFBDataBuffer_Memory_PutData( IDirectFBDataBuffer *thiz,
      return DFB_UNSUPPORTED;
 }
 
+static DFBResult
+IDirectFBDataBuffer_Memory_GetDataPointer( IDirectFBDataBuffer  *thiz,
+                                           const void          **ret_data,
+                                           unsigned int         *ret_length )
+{
+     DIRECT_INTERFACE_GET_DATA(IDirectFBDataBuffer_Memory)
+
+     if (!ret_data || !ret_length)
+          return DFB_INVARG;
+
+     *ret_data   = data->buffer;
+     *ret_length = data->length;
+
+     return DFB_OK;
+}
+
 DFBResult
 IDirectFBDataBuffer_Memory_Construct( IDirectFBDataBuffer *thiz,
                                       const void          *data_buffer,
@@ -254,6 +270,7 @@ IDirectFBDataBuffer_Memory_Construct( IDirectFBDataBuffer *thiz,
      thiz->PeekData               = IDirectFBDataBuffer_Memory_PeekData;
      thiz->HasData                = IDirectFBDataBuffer_Memory_HasData;
      thiz->PutData                = IDirectFBDataBuffer_Memory_PutData;
+     thiz->GetDataPointer         = IDirectFBDataBuffer_Memory_GetDataPointer;
 
      return DFB_OK;
 }
@@ -32,13 +32,13 @@
 
 #include <config.h>
 
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 #include <string.h>
 #include <errno.h>
 
-#include <direct/list.h>
 #include <direct/thread.h>
 
 #include <directfb.h>
@@ -48,22 +48,9 @@
 #include <direct/memcpy.h>
 #include <direct/util.h>
 
-#include <media/idirectfbdatabuffer.h>
-
-typedef struct {
-     DirectLink    link;
-
-     void         *data;   /* actual data hold */
-     unsigned int  length; /* length of chunk */
+#include <misc/conf.h>
 
-     unsigned int  done;   /* number of bytes already consumed */
-} DataChunk;
-
-static DataChunk *
-create_chunk( const void *data, int length );
-
-static void
-destroy_chunk( DataChunk *chunk );
+#include <media/idirectfbdatabuffer.h>
 
 /*
  * private data struct of IDirectFBDataBuffer_Streamed
@@ -71,28 +58,59 @@ destroy_chunk( DataChunk *chunk );
 typedef struct {
      IDirectFBDataBuffer_data  base;
 
-     DirectLink               *chunks;          /* data chunks */
+     u8                       *ring;            /* ring buffer holding the data */
+     unsigned int              size;            /* capacity of the ring buffer */
+     unsigned int              head;            /* offset of the oldest byte */
+
+     unsigned int              length;          /* number of bytes buffered */
+
+     unsigned int              high;            /* PutData() blocks at this level (0 = never) */
+     unsigned int              low;             /* until the level dropped to this */
+     bool                      blocked;         /* whether PutData() is waiting */
 
-     unsigned int              length;          /* total length of all chunks */
+     unsigned int              waiting;         /* number of readers in WaitForData() */
+     unsigned int              wanted;          /* largest length they are waiting for */
+
+     bool                      pointer;         /* whether PeekDataPointer() returned ring data */
+     u8                       *stale;           /* ring replaced while that data is referenced */
 
      bool                      finished;        /* whether Finish() has been called */
 
-     DirectMutex               chunks_mutex;    /* mutex lock for accessing
-                                                   the chunk list */
+     DirectMutex               ring_mutex;      /* mutex lock for accessing
+                                                   the ring buffer */
 
      DirectWaitQueue           wait_condition;  /* condition used for idle
                                                    wait in WaitForEvent() */
+
+     DirectWaitQueue           space_condition; /* condition used for waiting
+                                                   in PutData() */
 } IDirectFBDataBuffer_Streamed_data;
 
+static DFBResult
+GrowRing( IDirectFBDataBuffer_Streamed_data *data,
+          unsigned int                       length );
+
+static void
+ReadRingData( IDirectFBDataBuffer_Streamed_data *data,
+              void                              *buffer,
+              unsigned int                       offset,
+              unsigned int                       length,
+              bool                               flush );
+
+static void
+WriteRingData( IDirectFBDataBuffer_Streamed_data *data,
+               const void                        *buffer,
+               unsigned int                       length );
+
+static void
+BeginWait( IDirectFBDataBuffer_Streamed_data *data,
+           unsigned int                       length );
+
 static void
-DestroyAllChunks( IDirectFBDataBuffer_Streamed_data *data );
+EndWait( IDirectFBDataBuffer_Streamed_data *data );
 
 static void
-ReadChunkData( IDirectFBDataBuffer_Streamed_data *data,
-               void                              *buffer,
-               unsigned int                       offset,
-               unsigned int                       length,
-               bool                               flush );
+ReleasePointer( IDirectFBDataBuffer_Streamed_data *data );
 
 
 static void
@@ -101,8 +119,15 @@ IDirectFBDataBuffer_Streamed_Destruct( IDirectFBDataBuffer *thiz )
      IDirectFBDataBuffer_Streamed_data *data =
           (IDirectFBDataBuffer_Streamed_data*) thiz->priv;
 
+     if (data->ring)
+          D_FREE( data->ring );
+
+     if (data->stale)
+          D_FREE( data->stale );
+
+     direct_waitqueue_deinit( &data->space_condition );
      direct_waitqueue_deinit( &data->wait_condition );
-     direct_mutex_deinit( &data->chunks_mutex );
+     direct_mutex_deinit( &data->ring_mutex );
 
      IDirectFBDataBuffer_Destruct( thiz );
 }
@@ -123,11 +148,17 @@ IDirectFBDataBuffer_Streamed_Flush( IDirectFBDataBuffer *thiz )
 {
      DIRECT_INTERFACE_GET_DATA(IDirectFBDataBuffer_Streamed)
 
-     direct_mutex_lock( &data->chunks_mutex );
+     direct_mutex_lock( &data->ring_mutex );
 
-     DestroyAllChunks( data );
+     ReleasePointer( data );
 
-     direct_mutex_unlock( &data->chunks_mutex );
+     /* Drop all data, keeping the capacity. */
+     data->head   = 0;
+     data->length = 0;
+
+     direct_waitqueue_broadcast( &data->space_condition );
+
+     direct_mutex_unlock( &data->ring_mutex );
 
      return DFB_OK;
 }
@@ -140,9 +171,10 @@ IDirectFBDataBuffer_Streamed_Finish( IDirectFBDataBuffer *thiz )
      if (!data->finished) {
           data->finished = true;
 
-          direct_mutex_lock( &data->chunks_mutex );
+          direct_mutex_lock( &data->ring_mutex );
           direct_waitqueue_broadcast( &data->wait_condition );
-          direct_mutex_unlock( &data->chunks_mutex );
+          direct_waitqueue_broadcast( &data->space_condition );
+          direct_mutex_unlock( &data->ring_mutex );
      }
 
      return DFB_OK;
@@ -172,7 +204,7 @@ IDirectFBDataBuffer_Streamed_GetLength( IDirectFBDataBuffer *thiz,
      if (!length)
           return DFB_INVARG;
 
-     /* Return total length of all chunks. */
+     /* Return the number of bytes buffered. */
      *length = data->length;
 
      return DFB_OK;
@@ -184,15 +216,21 @@ IDirectFBDataBuffer_Streamed_WaitForData( IDirectFBDataBuffer *thiz,
 {
      DIRECT_INTERFACE_GET_DATA(IDirectFBDataBuffer_Streamed)
 
-     if (data->finished && !data->chunks)
+     if (data->finished && !data->length)
           return DFB_EOF;
           
-     direct_mutex_lock( &data->chunks_mutex );
+     direct_mutex_lock( &data->ring_mutex );
+
+     if (data->length < length && !data->finished) {
+          BeginWait( data, length );
 
-     while (data->length < length && !data->finished)
-          direct_waitqueue_wait( &data->wait_condition, &data->chunks_mutex );
+          while (data->length < length && !data->finished)
+               direct_waitqueue_wait( &data->wait_condition, &data->ring_mutex );
 
-     direct_mutex_unlock( &data->chunks_mutex );
+          EndWait( data );
+     }
+
+     direct_mutex_unlock( &data->ring_mutex );
 
      return DFB_OK;
 }
@@ -208,12 +246,12 @@ IDirectFBDataBuffer_Streamed_WaitForDataWithTimeout( IDirectFBDataBuffer *thiz,
 
      DIRECT_INTERFACE_GET_DATA(IDirectFBDataBuffer_Streamed)
 
-     if (data->finished && !data->chunks)
+     if (data->finished && !data->length)
           return DFB_EOF;
           
-     if (direct_mutex_trylock( &data->chunks_mutex ) == 0) {
+     if (direct_mutex_trylock( &data->ring_mutex ) == 0) {
           if (data->length >= length) {
-               direct_mutex_unlock( &data->chunks_mutex );
+               direct_mutex_unlock( &data->ring_mutex );
 
                return DFB_OK;
           }
@@ -222,17 +260,23 @@ IDirectFBDataBuffer_Streamed_WaitForDataWithTimeout( IDirectFBDataBuffer *thiz,
      }
 
      if (!locked)
-          direct_mutex_lock( &data->chunks_mutex );
-
-     while (data->length < length && !data->finished) {
-          ret = direct_waitqueue_wait_timeout( &data->wait_condition,
-                                               &data->chunks_mutex,
-                                               seconds * 1000000 + milli_seconds * 1000 );
-          if (ret == DR_TIMEOUT)
-               break;
+          direct_mutex_lock( &data->ring_mutex );
+
+     if (data->length < length && !data->finished) {
+          BeginWait( data, length );
+
+          while (data->length < length && !data->finished) {
+               ret = direct_waitqueue_wait_timeout( &data->wait_condition,
+                                                    &data->ring_mutex,
+                                                    seconds * 1000000 + milli_seconds * 1000 );
+               if (ret == DR_TIMEOUT)
+                    break;
+          }
+
+          EndWait( data );
      }
 
-     direct_mutex_unlock( &data->chunks_mutex );
+     direct_mutex_unlock( &data->ring_mutex );
 
      return ret;
 }
@@ -247,30 +291,34 @@ IDirectFBDataBuffer_Streamed_GetData( IDirectFBDataBuffer *thiz,
 
      DIRECT_INTERFACE_GET_DATA(IDirectFBDataBuffer_Streamed)
 
-     if (!data_buffer || !length)
+     /* A NULL buffer consumes data returned by PeekDataPointer(). */
+     if (!length)
           return DFB_INVARG;
 
-     direct_mutex_lock( &data->chunks_mutex );
+     direct_mutex_lock( &data->ring_mutex );
+
+     ReleasePointer( data );
 
-     if (!data->chunks) {
-          direct_mutex_unlock( &data->chunks_mutex );
+     if (!data->length) {
+          direct_mutex_unlock( &data->ring_mutex );
           return data->finished ? DFB_EOF : DFB_BUFFEREMPTY;
      }
 
      /* Calculate maximum number of bytes to be read. */
      len = MIN( length, data->length );
 
-     /* Read data from chunks (destructive). */
-     ReadChunkData( data, data_buffer, 0, len, true );
+     /* Read data from the ring buffer (destructive). */
+     ReadRingData( data, data_buffer, 0, len, true );
 
-     /* Decrease total number of bytes. */
-     data->length -= len;
+     /* Wake up a blocked writer when reaching the low watermark. */
+     if (data->blocked && data->length <= data->low)
+          direct_waitqueue_broadcast( &data->space_condition );
 
      /* Return number of bytes read. */
      if (read_out)
           *read_out = len;
 
-     direct_mutex_unlock( &data->chunks_mutex );
+     direct_mutex_unlock( &data->ring_mutex );
 
      return DFB_OK;
 }
@@ -289,24 +337,55 @@ IDirectFBDataBuffer_Streamed_PeekData( IDirectFBDataBuffer *thiz,
      if (!data_buffer || !length || offset < 0)
           return DFB_INVARG;
 
-     direct_mutex_lock( &data->chunks_mutex );
+     direct_mutex_lock( &data->ring_mutex );
 
-     if (!data->chunks || (unsigned int) offset >= data->length) {
-          direct_mutex_unlock( &data->chunks_mutex );
+     if ((unsigned int) offset >= data->length) {
+          direct_mutex_unlock( &data->ring_mutex );
           return data->finished ? DFB_EOF : DFB_BUFFEREMPTY;
      }
 
      /* Calculate maximum number of bytes to be read. */
      len = MIN( length, data->length - offset );
 
-     /* Read data from chunks (non-destructive). */
-     ReadChunkData( data, data_buffer, offset, len, false );
+     /* Read data from the ring buffer (non-destructive). */
+     ReadRingData( data, data_buffer, offset, len, false );
 
      /* Return number of bytes read. */
      if (read_out)
           *read_out = len;
 
-     direct_mutex_unlock( &data->chunks_mutex );
+     direct_mutex_unlock( &data->ring_mutex );
+
+     return DFB_OK;
+}
+
+static DFBResult
+IDirectFBDataBuffer_Streamed_PeekDataPointer( IDirectFBDataBuffer  *thiz,
+                                              const void          **ret_data,
+                                              unsigned int         *ret_length )
+{
+     DIRECT_INTERFACE_GET_DATA(IDirectFBDataBuffer_Streamed)
+
+     if (!ret_data || !ret_length)
+          return DFB_INVARG;
+
+     direct_mutex_lock( &data->ring_mutex );
+
+     if (!data->length) {
+          direct_mutex_unlock( &data->ring_mutex );
+          return data->finished ? DFB_EOF : DFB_BUFFEREMPTY;
+     }
+
+     /*
+      * Return the data up to the end of the ring buffer. The writer only appends behind it,
+      * and GrowRing() keeps the old ring until the reader calls GetData() or Flush().
+      */
+     data->pointer = true;
+
+     *ret_data   = data->ring + data->head;
+     *ret_length = MIN( data->length, data->size - data->head );
+
+     direct_mutex_unlock( &data->ring_mutex );
 
      return DFB_OK;
 }
@@ -316,8 +395,8 @@ IDirectFBDataBuffer_Streamed_HasData( IDirectFBDataBuffer *thiz )
 {
      DIRECT_INTERFACE_GET_DATA(IDirectFBDataBuffer_Streamed)
           
-     /* If there's no chunk there's no data. */
-     if (!data->chunks)
+     /* If there's nothing buffered there's no data. */
+     if (!data->length)
           return data->finished ? DFB_EOF : DFB_BUFFEREMPTY;
 
      return DFB_OK;
@@ -328,7 +407,7 @@ IDirectFBDataBuffer_Streamed_PutData( IDirectFBDataBuffer *thiz,
                                       const void          *data_buffer,
                                       unsigned int         length )
 {
-     DataChunk *chunk;
+     DFBResult ret;
 
      DIRECT_INTERFACE_GET_DATA(IDirectFBDataBuffer_Streamed)
 
@@ -340,22 +419,36 @@ IDirectFBDataBuffer_Streamed_PutData( IDirectFBDataBuffer *thiz,
      if (data->finished)
           return DFB_UNSUPPORTED;
 
-     /* Create a chunk containing a copy of the provided data. */
-     chunk = create_chunk( data_buffer, length );
-     if (!chunk)
-          return DFB_NOSYSTEMMEMORY;
+     direct_mutex_lock( &data->ring_mutex );
 
-     direct_mutex_lock( &data->chunks_mutex );
+     /*
+      * Flow control, wait for the reader to drain the buffer down to the low watermark.
+      * Never block while a reader waits for more than is buffered, it would not drain.
+      */
+     if (data->high && data->length >= data->high && data->wanted <= data->length) {
+          data->blocked = true;
 
-     /* Append new chunk. */
-     direct_list_append( &data->chunks, &chunk->link );
+          while (data->length > data->low && data->wanted <= data->length && !data->finished)
+               direct_waitqueue_wait( &data->space_condition, &data->ring_mutex );
 
-     /* Increase total length. */
-     data->length += length;
+          data->blocked = false;
+     }
+
+     /* Make room for the new data. */
+     if (data->size - data->length < length) {
+          ret = GrowRing( data, data->length + length );
+          if (ret) {
+               direct_mutex_unlock( &data->ring_mutex );
+               return ret;
+          }
+     }
+
+     /* Append a copy of the provided data. */
+     WriteRingData( data, data_buffer, length );
 
      direct_waitqueue_broadcast( &data->wait_condition );
 
-     direct_mutex_unlock( &data->chunks_mutex );
+     direct_mutex_unlock( &data->ring_mutex );
 
      return DFB_OK;
 }
@@ -373,8 +466,20 @@ IDirectFBDataBuffer_Streamed_Construct( IDirectFBDataBuffer *thiz,
      if (ret)
           return ret;
 
-     direct_mutex_init( &data->chunks_mutex );
+     /* Preallocate the ring buffer, it only grows if the reader falls behind. */
+     data->size = dfb_config->stream_buffer;
+     data->ring = D_MALLOC( data->size );
+     if (!data->ring) {
+          IDirectFBDataBuffer_Destruct( thiz );
+          return D_OOM();
+     }
+
+     data->high = dfb_config->stream_buffer_high;
+     data->low  = dfb_config->stream_buffer_low;
+
+     direct_mutex_init( &data->ring_mutex );
      direct_waitqueue_init( &data->wait_condition );
+     direct_waitqueue_init( &data->space_condition );
 
      thiz->Release                = IDirectFBDataBuffer_Streamed_Release;
      thiz->Flush                  = IDirectFBDataBuffer_Streamed_Flush;
@@ -386,6 +491,7 @@ IDirectFBDataBuffer_Streamed_Construct( IDirectFBDataBuffer *thiz,
      thiz->WaitForDataWithTimeout = IDirectFBDataBuffer_Streamed_WaitForDataWithTimeout;
      thiz->GetData                = IDirectFBDataBuffer_Streamed_GetData;
      thiz->PeekData               = IDirectFBDataBuffer_Streamed_PeekData;
+     thiz->PeekDataPointer        = IDirectFBDataBuffer_Streamed_PeekDataPointer;
      thiz->HasData                = IDirectFBDataBuffer_Streamed_HasData;
      thiz->PutData                = IDirectFBDataBuffer_Streamed_PutData;
 
@@ -394,126 +500,157 @@ IDirectFBDataBuffer_Streamed_Construct( IDirectFBDataBuffer *thiz,
 
 /******************************************************************************/
 
-static void
-DestroyAllChunks( IDirectFBDataBuffer_Streamed_data *data )
+static DFBResult
+GrowRing( IDirectFBDataBuffer_Streamed_data *data,
+          unsigned int                       length )
 {
-     DirectLink *l, *n;
+     u8           *ring;
+     unsigned int  size = data->size;
 
      D_ASSERT( data != NULL );
+     D_ASSERT( length > data->size );
+
+     /* Double the capacity to keep the number of reallocations low. */
+     while (size < length) {
+          if (size > UINT_MAX / 2)
+               return DFB_LIMITEXCEEDED;
 
-     /* Loop through list. */
-     direct_list_foreach_safe (l, n, data->chunks) {
-          /* Deallocate chunk. */
-          destroy_chunk( (DataChunk*) l );
+          size *= 2;
      }
 
-     /* Clear lists. */
-     data->chunks = NULL;
+     ring = D_MALLOC( size );
+     if (!ring)
+          return D_OOM();
+
+     /* Move the data to the beginning of the new ring buffer. */
+     if (data->length)
+          ReadRingData( data, ring, 0, data->length, false );
+
+     /* Keep the ring referenced by PeekDataPointer(), later ones are not. */
+     if (data->pointer && !data->stale)
+          data->stale = data->ring;
+     else
+          D_FREE( data->ring );
+
+     data->ring = ring;
+     data->size = size;
+     data->head = 0;
+
+     return DFB_OK;
 }
 
 static void
-ReadChunkData( IDirectFBDataBuffer_Streamed_data *data,
-               void                              *buffer,
-               unsigned int                       offset,
-               unsigned int                       length,
-               bool                               flush )
+ReadRingData( IDirectFBDataBuffer_Streamed_data *data,
+              void                              *buffer,
+              unsigned int                       offset,
+              unsigned int                       length,
+              bool                               flush )
 {
-     DirectLink *l, *n;
+     unsigned int start;
+     unsigned int len;
 
      D_ASSERT( data != NULL );
-     D_ASSERT( buffer != NULL );
+     D_ASSERT( buffer != NULL || flush );
+     D_ASSERT( offset + length <= data->length );
 
-     /* Loop through links. */
-     direct_list_foreach_safe (l, n, data->chunks) {
-          unsigned int  len;
-          unsigned int  off   = 0;
-          DataChunk    *chunk = (DataChunk*) l;
+     /* Only drop the data without a buffer. */
+     if (buffer) {
+          /* Calculate the position of the first byte to be read. */
+          start = data->head + offset;
+          if (start >= data->size)
+               start -= data->size;
 
-          /* Is there data to be skipped? */
-          if (offset) {
-               /* Calculate number of bytes to be skipped from this chunk. */
-               off = MIN( offset, chunk->length - chunk->done );
+          /* Copy the contiguous part up to the end of the ring buffer... */
+          len = MIN( length, data->size - start );
 
-               /* Decrease number of bytes to skipped. */
-               offset -= off;
-          }
+          direct_memcpy( buffer, data->ring + start, len );
 
-          /* Calculate number of bytes to be read from this chunk. */
-          len = MIN( length, chunk->length - chunk->done - off );
+          /* ...and the wrapped around rest, if any. */
+          if (len < length)
+               direct_memcpy( (u8*) buffer + len, data->ring, length - len );
+     }
 
-          /* Can we read from this chunk? */
-          if (len) {
-               /* Copy as many bytes as possible. */
-               direct_memcpy( buffer, (char*) chunk->data + chunk->done + off, len );
+     /* Destructive read? */
+     if (flush) {
+          D_ASSERT( offset == 0 );
 
-               /* Increase write pointer. */
-               buffer = (char*) buffer + len;
+          data->length -= length;
 
-               /* Decrease number of bytes to read. */
-               length -= len;
+          /* Restart at the beginning when empty, keeping data contiguous. */
+          if (data->length) {
+               data->head += length;
+               if (data->head >= data->size)
+                    data->head -= data->size;
           }
+          else
+               data->head = 0;
+     }
+}
 
-          /* Destructive read? */
-          if (flush) {
-               /* Increase number of consumed bytes. */
-               chunk->done += len + off;
+static void
+WriteRingData( IDirectFBDataBuffer_Streamed_data *data,
+               const void                        *buffer,
+               unsigned int                       length )
+{
+     unsigned int tail;
+     unsigned int len;
 
-               /* Completely consumed? */
-               if (chunk->done == chunk->length) {
-                    /* Remove the chunk from the list. */
-                    direct_list_remove( &data->chunks, l );
+     D_ASSERT( data != NULL );
+     D_ASSERT( buffer != NULL );
+     D_ASSERT( data->size - data->length >= length );
 
-                    /* Deallocate chunk. */
-                    destroy_chunk( chunk );
-               }
-          }
-     }
+     /* Calculate the position behind the last byte. */
+     tail = data->head + data->length;
+     if (tail >= data->size)
+          tail -= data->size;
 
-     D_ASSERT( length == 0 );
-     D_ASSERT( offset == 0 );
-}
+     /* Copy up to the end of the ring buffer... */
+     len = MIN( length, data->size - tail );
 
-/******************************************************************************/
+     direct_memcpy( data->ring + tail, buffer, len );
 
-static DataChunk *
-create_chunk( const void *data, int length )
-{
-     DataChunk *chunk;
+     /* ...and wrap around with the rest. */
+     if (len < length)
+          direct_memcpy( data->ring, (const u8*) buffer + len, length - len );
+
+     data->length += length;
+}
 
+static void
+BeginWait( IDirectFBDataBuffer_Streamed_data *data,
+           unsigned int                       length )
+{
      D_ASSERT( data != NULL );
-     D_ASSERT( length > 0 );
-
-     /* Allocate chunk information. */
-     chunk = D_CALLOC( 1, sizeof(DataChunk) );
-     if (!chunk)
-          return NULL;
-
-     /* Allocate chunk data. */
-     chunk->data = D_MALLOC( length );
-     if (!chunk->data) {
-          D_FREE( chunk );
-          return NULL;
-     }
 
-     /* Fill chunk data. */
-     direct_memcpy( chunk->data, data, length );
+     data->waiting++;
 
-     /* Remember chunk length. */
-     chunk->length = length;
+     if (data->wanted < length)
+          data->wanted = length;
 
-     return chunk;
+     /* Release a writer blocked at the high watermark. */
+     if (data->blocked && data->wanted > data->length)
+          direct_waitqueue_broadcast( &data->space_condition );
 }
 
 static void
-destroy_chunk( DataChunk *chunk )
+EndWait( IDirectFBDataBuffer_Streamed_data *data )
 {
-     D_ASSERT( chunk != NULL );
-     D_ASSERT( chunk->data != NULL );
-
-     /* Deallocate chunk data. */
-     D_FREE( chunk->data );
+     D_ASSERT( data != NULL );
+     D_ASSERT( data->waiting > 0 );
 
-     /* Deallocate chunk information. */
-     D_FREE( chunk );
+     if (!--data->waiting)
+          data->wanted = 0;
 }
 
+static void
+ReleasePointer( IDirectFBDataBuffer_Streamed_data *data )
+{
+     D_ASSERT( data != NULL );
+
+     data->pointer = false;
+
+     if (data->stale) {
+          D_FREE( data->stale );
+          data->stale = NULL;
+     }
+}
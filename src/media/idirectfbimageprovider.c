@@ -36,19 +36,32 @@
 #include <string.h>
 
 #include <directfb.h>
+#include <directfb_util.h>
 
 #include <core/core.h>
+#include <core/imagecache.h>
+#include <core/surface.h>
 
+#include <direct/debug.h>
 #include <direct/interface.h>
 #include <direct/mem.h>
 
+#include <display/idirectfbsurface.h>
+
 #include <fusion/conf.h>
 
+#include <gfx/util.h>
+
+#include <misc/conf.h>
+
 #include <media/idirectfbimageprovider.h>
 #include <media/idirectfbimageprovider_client.h>
 #include <media/idirectfbdatabuffer.h>
 
 
+D_DEBUG_DOMAIN( ImageProvider_Cache, "ImageProvider/Cache", "Decoded image cache" );
+
+
 static DirectResult
 IDirectFBImageProvider_AddRef( IDirectFBImageProvider *thiz )
 {
@@ -139,6 +152,353 @@ IDirectFBImageProvider_WriteBack( IDirectFBImageProvider *thiz,
      return DFB_UNIMPLEMENTED;
 }
 
+static DFBResult
+IDirectFBImageProvider_SetSourceRectangle( IDirectFBImageProvider *thiz,
+                                           const DFBRectangle     *source_rect )
+{
+     return DFB_UNIMPLEMENTED;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * Emulated source rectangle
+ *
+ * Providers using the base data without their own SetSourceRectangle() decode the whole image into a temporary
+ * surface, the source rectangle is stretched from there to the destination.
+ */
+
+static DFBResult
+IDirectFBImageProvider_Source_RenderTo( IDirectFBImageProvider *thiz,
+                                        IDirectFBSurface       *destination,
+                                        const DFBRectangle     *destination_rect )
+{
+     DFBResult               ret;
+     DFBSurfaceDescription   desc;
+     DFBSurfaceCapabilities  caps;
+     DFBRectangle            source;
+     DFBRectangle            image;
+     IDirectFBSurface       *surface;
+
+     DIRECT_INTERFACE_GET_DATA( IDirectFBImageProvider )
+
+     if (!destination)
+          return DFB_INVARG;
+
+     if (!data->source.w || !data->source.h)
+          return data->RenderTo( thiz, destination, destination_rect );
+
+     ret = thiz->GetSurfaceDescription( thiz, &desc );
+     if (ret)
+          return ret;
+
+     image.x = 0;
+     image.y = 0;
+     image.w = desc.width;
+     image.h = desc.height;
+
+     source = data->source;
+
+     if (!dfb_rectangle_intersect( &source, &image ))
+          return DFB_INVAREA;
+
+     ret = destination->GetCapabilities( destination, &caps );
+     if (ret)
+          return ret;
+
+     /* Decode with the premultiplication of the destination, so that the stretching is a plain copy. */
+     desc.flags &= DSDESC_WIDTH | DSDESC_HEIGHT | DSDESC_PIXELFORMAT;
+     desc.flags |= DSDESC_CAPS;
+     desc.caps   = caps & DSCAPS_PREMULTIPLIED;
+
+     ret = data->idirectfb->CreateSurface( data->idirectfb, &desc, &surface );
+     if (ret)
+          return ret;
+
+     ret = data->RenderTo( thiz, surface, NULL );
+     if (ret == DFB_OK) {
+          destination->SetBlittingFlags( destination, DSBLIT_NOFX );
+
+          ret = destination->StretchBlit( destination, surface, &source, destination_rect );
+
+          destination->ReleaseSource( destination );
+     }
+
+     surface->Release( surface );
+
+     return ret;
+}
+
+static DFBResult
+IDirectFBImageProvider_Source_SetSourceRectangle( IDirectFBImageProvider *thiz,
+                                                  const DFBRectangle     *source_rect )
+{
+     DFBResult             ret;
+     DFBSurfaceDescription desc;
+     DFBRectangle          rect;
+     DFBRectangle          image;
+
+     DIRECT_INTERFACE_GET_DATA( IDirectFBImageProvider )
+
+     if (!source_rect) {
+          memset( &data->source, 0, sizeof(DFBRectangle) );
+          return DFB_OK;
+     }
+
+     if (source_rect->w < 1 || source_rect->h < 1)
+          return DFB_INVARG;
+
+     ret = thiz->GetSurfaceDescription( thiz, &desc );
+     if (ret)
+          return ret;
+
+     image.x = 0;
+     image.y = 0;
+     image.w = desc.width;
+     image.h = desc.height;
+
+     rect = *source_rect;
+
+     if (!dfb_rectangle_intersect( &rect, &image ))
+          return DFB_INVAREA;
+
+     /* Kept unclipped like the image cache does, RenderTo() clips again. */
+     data->source = *source_rect;
+
+     return DFB_OK;
+}
+
+/*
+ * RenderTo() of the provider, including the emulated source rectangle.
+ */
+static inline DFBResult
+image_provider_render( IDirectFBImageProvider      *thiz,
+                       IDirectFBImageProvider_data *data,
+                       IDirectFBSurface            *destination,
+                       const DFBRectangle          *destination_rect )
+{
+     if (data->source_emulated)
+          return IDirectFBImageProvider_Source_RenderTo( thiz, destination, destination_rect );
+
+     return data->RenderTo( thiz, destination, destination_rect );
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * Decoded image cache
+ *
+ * Enabled by "image-cache=<kb>", RenderTo() results are kept in shared surfaces by the image cache core, keyed by the
+ * encoded data, destination size, pixel format, color space, premultiplication, source rectangle and render flags.
+ * A hit is a blit instead of a decode. Only buffers providing a pointer to their complete data are cached.
+ */
+
+static bool
+image_cache_supported( CoreSurface *surface )
+{
+     if (DFB_PIXELFORMAT_IS_INDEXED( surface->config.format ))
+          return false;
+
+     return !(surface->config.caps & (DSCAPS_SEPARATED | DSCAPS_STEREO));
+}
+
+static u64
+image_cache_hash( const u8 *data, unsigned int length )
+{
+     unsigned int i;
+     u64          hash = 14695981039346656037ULL;   /* FNV-1a */
+
+     for (i = 0; i < length; i++) {
+          hash ^= data[i];
+          hash *= 1099511628211ULL;
+     }
+
+     return hash;
+}
+
+/*
+ * Blits the visible part of the decoded image at 'rect' of the destination.
+ */
+static void
+image_cache_blit( CoreSurface        *source,
+                  CoreSurface        *destination,
+                  const DFBRectangle *rect,
+                  const DFBRegion    *clip )
+{
+     DFBRectangle clipped = *rect;
+     DFBRectangle area;
+
+     if (!dfb_rectangle_intersect_by_region( &clipped, clip ))
+          return;
+
+     area.x = clipped.x - rect->x;
+     area.y = clipped.y - rect->y;
+     area.w = clipped.w;
+     area.h = clipped.h;
+
+     dfb_gfx_copy_stereo( source, DSSE_LEFT, destination, DSSE_LEFT, &area, clipped.x, clipped.y, true );
+}
+
+static DFBResult
+IDirectFBImageProvider_Cache_RenderTo( IDirectFBImageProvider *thiz,
+                                       IDirectFBSurface       *destination,
+                                       const DFBRectangle     *destination_rect )
+{
+     DFBResult              ret;
+     IDirectFBSurface_data *dst_data;
+     CoreSurface           *dst_surface;
+     DFBImageCacheCore     *cache;
+     DFBRegion              clip;
+     DFBRectangle           rect;
+     DFBImageCacheKey       key;
+     const void            *encoded;
+     unsigned int           length;
+     CoreSurface           *surface;
+     IDirectFBSurface      *target;
+
+     DIRECT_INTERFACE_GET_DATA( IDirectFBImageProvider )
+
+     D_DEBUG_AT( ImageProvider_Cache, "%s( %p )\n", __FUNCTION__, thiz );
+
+     if (!destination)
+          return DFB_INVARG;
+
+     dst_data = destination->priv;
+     if (!dst_data)
+          return DFB_DEAD;
+
+     dst_surface = dst_data->surface;
+     if (!dst_surface)
+          return DFB_DESTROYED;
+
+     /* Progressive rendering needs the real thing. */
+     if (data->render_callback || !image_cache_supported( dst_surface ))
+          return image_provider_render( thiz, data, destination, destination_rect );
+
+     if (data->buffer->GetDataPointer( data->buffer, &encoded, &length ))
+          return image_provider_render( thiz, data, destination, destination_rect );
+
+     if (!data->hashed) {
+          data->hash   = image_cache_hash( encoded, length );
+          data->hashed = true;
+     }
+
+     dfb_region_from_rectangle( &clip, &dst_data->area.current );
+
+     if (destination_rect) {
+          if (destination_rect->w < 1 || destination_rect->h < 1)
+               return DFB_INVARG;
+
+          rect = *destination_rect;
+          rect.x += dst_data->area.wanted.x;
+          rect.y += dst_data->area.wanted.y;
+     }
+     else
+          rect = dst_data->area.wanted;
+
+     if (!dfb_rectangle_region_intersects( &rect, &clip ))
+          return DFB_OK;
+
+     cache = dfb_core_get_part( data->core, DFCP_IMAGECACHE );
+
+     memset( &key, 0, sizeof(key) );
+
+     key.hash       = data->hash;
+     key.length     = length;
+     key.width      = rect.w;
+     key.height     = rect.h;
+     key.format     = dst_surface->config.format;
+     key.colorspace = dst_surface->config.colorspace;
+     key.caps       = dst_surface->config.caps & DSCAPS_PREMULTIPLIED;
+     key.source     = data->source;
+     key.flags      = data->render_flags;
+
+     if (dfb_image_cache_lookup( cache, &key, encoded, &surface ) == DFB_OK) {
+          D_DEBUG_AT( ImageProvider_Cache, "  -> hit %dx%d %s\n", rect.w, rect.h, dfb_pixelformat_name( key.format ) );
+
+          image_cache_blit( surface, dst_surface, &rect, &clip );
+
+          dfb_surface_unref( surface );
+
+          return DFB_OK;
+     }
+
+     D_DEBUG_AT( ImageProvider_Cache, "  -> miss %dx%d %s\n", rect.w, rect.h, dfb_pixelformat_name( key.format ) );
+
+     ret = dfb_surface_create_simple( data->core, rect.w, rect.h, key.format, key.colorspace,
+                                      key.caps, CSTF_SHARED, 0, NULL, &surface );
+     if (ret)
+          return image_provider_render( thiz, data, destination, destination_rect );
+
+     DIRECT_ALLOCATE_INTERFACE( target, IDirectFBSurface );
+     if (!target) {
+          dfb_surface_unref( surface );
+          return D_OOM();
+     }
+
+     ret = IDirectFBSurface_Construct( target, NULL, NULL, NULL, NULL, surface, key.caps, data->core, data->idirectfb );
+     if (ret) {
+          dfb_surface_unref( surface );
+          return ret;
+     }
+
+     ret = image_provider_render( thiz, data, target, NULL );
+
+     target->Release( target );
+
+     if (ret) {
+          /* Incomplete or broken images are not cached, render them the usual way. */
+          dfb_surface_unref( surface );
+
+          return image_provider_render( thiz, data, destination, destination_rect );
+     }
+
+     image_cache_blit( surface, dst_surface, &rect, &clip );
+
+     dfb_image_cache_insert( cache, &key, encoded, surface );
+
+     dfb_surface_unref( surface );
+
+     return DFB_OK;
+}
+
+static DFBResult
+IDirectFBImageProvider_Cache_SetSourceRectangle( IDirectFBImageProvider *thiz,
+                                                 const DFBRectangle     *source_rect )
+{
+     DFBResult ret;
+
+     DIRECT_INTERFACE_GET_DATA( IDirectFBImageProvider )
+
+     ret = data->SetSourceRectangle( thiz, source_rect );
+     if (ret)
+          return ret;
+
+     if (source_rect)
+          data->source = *source_rect;
+     else
+          memset( &data->source, 0, sizeof(DFBRectangle) );
+
+     return DFB_OK;
+}
+
+static DFBResult
+IDirectFBImageProvider_Cache_SetRenderFlags( IDirectFBImageProvider *thiz,
+                                             DIRenderFlags           flags )
+{
+     DFBResult ret;
+
+     DIRECT_INTERFACE_GET_DATA( IDirectFBImageProvider )
+
+     ret = data->SetRenderFlags( thiz, flags );
+     if (ret)
+          return ret;
+
+     data->render_flags = flags;
+
+     return DFB_OK;
+}
+
 static void
 IDirectFBImageProvider_Construct( IDirectFBImageProvider *thiz )
 {
@@ -150,6 +510,7 @@ IDirectFBImageProvider_Construct( IDirectFBImageProvider *thiz )
      thiz->SetRenderCallback     = IDirectFBImageProvider_SetRenderCallback;
      thiz->SetRenderFlags        = IDirectFBImageProvider_SetRenderFlags;
      thiz->WriteBack             = IDirectFBImageProvider_WriteBack;
+     thiz->SetSourceRectangle    = IDirectFBImageProvider_SetSourceRectangle;
 }
      
 DFBResult
@@ -205,8 +566,9 @@ IDirectFBImageProvider_CreateFromBuffer( IDirectFBDataBuffer     *buffer,
           return DFB_OK;
      }
 
-     /* Find a suitable implementation. */
-     ret = DirectGetInterface( &funcs, "IDirectFBImageProvider", NULL, DirectProbeInterface, &ctx );
+     /* Find a suitable implementation, only loading those whose signatures match the header. */
+     ret = DirectGetInterfaceForData( &funcs, "IDirectFBImageProvider", NULL, DirectProbeInterface, &ctx,
+                                      ctx.header, sizeof(ctx.header) );
      if (ret)
           return ret;
 
@@ -224,6 +586,35 @@ IDirectFBImageProvider_CreateFromBuffer( IDirectFBDataBuffer     *buffer,
 
      data->idirectfb = idirectfb;
 
+     /* Only providers using the base data can have their source rectangle emulated. */
+     if (imageprovider->AddRef == IDirectFBImageProvider_AddRef &&
+         imageprovider->SetSourceRectangle == IDirectFBImageProvider_SetSourceRectangle)
+     {
+          data->RenderTo        = imageprovider->RenderTo;
+          data->source_emulated = true;
+
+          imageprovider->RenderTo           = IDirectFBImageProvider_Source_RenderTo;
+          imageprovider->SetSourceRectangle = IDirectFBImageProvider_Source_SetSourceRectangle;
+     }
+
+     /*
+      * Only providers using the base data and reference counting can be cached. Secure slaves only get here for
+      * DFIFF, they can't write the shared cache.
+      */
+     if (dfb_config->image_cache && imageprovider->AddRef == IDirectFBImageProvider_AddRef &&
+         !(fusion_config->secure_fusion && !dfb_core_is_master( core )))
+     {
+          if (!data->source_emulated)
+               data->RenderTo = imageprovider->RenderTo;
+
+          data->SetSourceRectangle = imageprovider->SetSourceRectangle;
+          data->SetRenderFlags     = imageprovider->SetRenderFlags;
+
+          imageprovider->RenderTo           = IDirectFBImageProvider_Cache_RenderTo;
+          imageprovider->SetSourceRectangle = IDirectFBImageProvider_Cache_SetSourceRectangle;
+          imageprovider->SetRenderFlags     = IDirectFBImageProvider_Cache_SetRenderFlags;
+     }
+
      *interface = imageprovider;
 
      return DFB_OK;
@@ -68,6 +68,22 @@ typedef struct {
      void                *render_callback_context;
 
      void (*Destruct)( IDirectFBImageProvider *thiz );
+
+     /* decoded image cache (see "image-cache" option) and emulated source rectangle, original methods */
+     DFBResult (*RenderTo)( IDirectFBImageProvider *thiz,
+                            IDirectFBSurface       *destination,
+                            const DFBRectangle     *destination_rect );
+     DFBResult (*SetSourceRectangle)( IDirectFBImageProvider *thiz,
+                                      const DFBRectangle     *source_rect );
+     DFBResult (*SetRenderFlags)( IDirectFBImageProvider *thiz,
+                                  DIRenderFlags           flags );
+
+     bool                 source_emulated; /* SetSourceRectangle() stretches from a full decode */
+
+     bool                 hashed;      /* 'hash' has been computed */
+     u64                  hash;        /* hash of the encoded image data */
+     DFBRectangle         source;      /* source rectangle, zero size means whole image */
+     DIRenderFlags        render_flags; /* last flags accepted by SetRenderFlags() */
 } IDirectFBImageProvider_data;
 
 
@@ -135,6 +135,15 @@ IDirectFBImageProvider_Client_WriteBack( IDirectFBImageProvider *thiz,
      return DFB_UNIMPLEMENTED;
 }
 
+static DFBResult
+IDirectFBImageProvider_Client_SetSourceRectangle( IDirectFBImageProvider *thiz,
+                                                  const DFBRectangle     *source_rect )
+{
+     DIRECT_INTERFACE_GET_DATA( IDirectFBImageProvider_Client )
+
+     return ImageProvider_SetSourceRectangle( &data->client, source_rect );
+}
+
 DFBResult
 IDirectFBImageProvider_Client_Construct( IDirectFBImageProvider *thiz,
                                          IDirectFBDataBuffer    *buffer,
@@ -174,6 +183,7 @@ IDirectFBImageProvider_Client_Construct( IDirectFBImageProvider *thiz,
      thiz->RenderTo              = IDirectFBImageProvider_Client_RenderTo;
      thiz->SetRenderCallback     = IDirectFBImageProvider_Client_SetRenderCallback;
      thiz->WriteBack             = IDirectFBImageProvider_Client_WriteBack;
+     thiz->SetSourceRectangle    = IDirectFBImageProvider_Client_SetSourceRectangle;
 
      return DFB_OK;
 }
@@ -115,6 +115,7 @@ static const char *config_usage_strings[]  = {
      "  [no-]always-flush-callbuffer   Flush call buffer upon commit, effectively disabling it\n"
      "  [no-]layers-fps=[<ms>]         Print FPS of layers being updated, optional interval (default 1000)\n"
      "  [no-]gfxcard-stats=[<ms>]      Print GPU usage statistics periodically (default 1000)\n"
+     "  [no-]gfx-stats                 Record per operation statistics, shown by 'dfbinspector -s <pid>'\n"
      "  screen-frame-interval=<us>     Set default value for screen refresh interval if not encoder defined (default 16666)\n"
      "  max-frame-advance=<us>         Set default value for maximum time ahead for rendering frames (default 100000)\n"
      "  max-render-tasks=<num>         Set maximum number of rendering tasks per Renderer (gfx context) before blocking client\n"
@@ -179,6 +180,13 @@ static const char *config_usage_strings[]  = {
      "  flip-notify-max-latency=<ms>   Set maximum FlipNotify latency (ms from Flip to Notify, default 200)\n"
      "  videoram-limit=<amount>        Limit amount of Video RAM in kb\n"
      "  agpmem-limit=<amount>          Limit amount of AGP memory in kb\n"
+     "  image-cache=<amount>           Cache decoded images up to this amount in kb (default 0 = off)\n"
+     "  image-scale-filter=(linear|bicubic|lanczos)\n"
+     "                                 Filter for scaling images while decoding (default=linear)\n"
+     "  stream-buffer=<amount>         Initial size of streamed data buffers in kb (default 64)\n"
+     "  stream-buffer-limit=<high>[,<low>]\n"
+     "                                 Block PutData() on streamed data buffers holding <high> kb\n"
+     "                                 until <low> kb are left (default 0 = off, <low> = <high>/2)\n"
      "  screenshot-dir=<directory>     Dump screen content on <Print> key presses\n"
      "  video-phys=<hexaddress>        Physical start of video memory (devmem system)\n"
      "  video-length=<bytes>           Length of video memory (devmem system)\n"
@@ -518,6 +526,8 @@ static void config_allocate( void )
      dfb_config->max_font_rows      = 99;
      dfb_config->max_font_row_width = 2048;
 
+     dfb_config->stream_buffer      = 64 << 10;
+
      dfb_config->core_sighandler    = true;
 
      dfb_config->flip_notify_max_latency = 200;
@@ -828,6 +838,99 @@ DFBResult dfb_config_set( const char *name, const char *value )
                return DFB_INVARG;
           }
      } else
+     if (strcmp (name, "image-cache" ) == 0) {
+          if (value) {
+               unsigned long limit;
+
+               if (value[0] == '-' || direct_sscanf( value, "%lu", &limit ) < 1) {
+                    D_ERROR("DirectFB/Config 'image-cache': Could not parse value!\n");
+                    return DFB_INVARG;
+               }
+
+               if (limit > SIZE_MAX >> 10) {
+                    D_ERROR("DirectFB/Config 'image-cache': Value too large!\n");
+                    return DFB_INVARG;
+               }
+
+               dfb_config->image_cache = (size_t) limit << 10;
+          }
+          else {
+               D_ERROR("DirectFB/Config 'image-cache': No value specified!\n");
+               return DFB_INVARG;
+          }
+     } else
+     if (strcmp (name, "stream-buffer" ) == 0) {
+          if (value) {
+               int size;
+
+               if (direct_sscanf( value, "%d", &size ) < 1) {
+                    D_ERROR("DirectFB/Config 'stream-buffer': Could not parse value!\n");
+                    return DFB_INVARG;
+               }
+
+               if (size < 1)
+                    size = 1;
+
+               dfb_config->stream_buffer = size << 10;
+          }
+          else {
+               D_ERROR("DirectFB/Config 'stream-buffer': No value specified!\n");
+               return DFB_INVARG;
+          }
+     } else
+     if (strcmp (name, "stream-buffer-limit" ) == 0) {
+          if (value) {
+               int high, low;
+
+               switch (direct_sscanf( value, "%d,%d", &high, &low )) {
+                    case 1:
+                         low = high / 2;
+                         break;
+
+                    case 2:
+                         break;
+
+                    default:
+                         D_ERROR("DirectFB/Config 'stream-buffer-limit': Could not parse value!\n");
+                         return DFB_INVARG;
+               }
+
+               if (high < 0)
+                    high = 0;
+
+               if (low < 0 || low > high) {
+                    D_ERROR("DirectFB/Config 'stream-buffer-limit': Low watermark must be between 0 and %d!\n", high);
+                    return DFB_INVARG;
+               }
+
+               dfb_config->stream_buffer_high = high << 10;
+               dfb_config->stream_buffer_low  = low  << 10;
+          }
+          else {
+               D_ERROR("DirectFB/Config 'stream-buffer-limit': No value specified!\n");
+               return DFB_INVARG;
+          }
+     } else
+     if (strcmp (name, "image-scale-filter" ) == 0) {
+          if (value) {
+               if (strcmp( value, "linear" ) == 0) {
+                    dfb_config->image_scale_filter = DRF_LINEAR;
+               } else
+               if (strcmp( value, "bicubic" ) == 0) {
+                    dfb_config->image_scale_filter = DRF_BICUBIC;
+               } else
+               if (strcmp( value, "lanczos" ) == 0) {
+                    dfb_config->image_scale_filter = DRF_LANCZOS;
+               } else {
+                    D_ERROR( "DirectFB/Config '%s': Unknown filter '%s'!\n", name, value );
+                    return DFB_INVARG;
+               }
+          }
+          else {
+               D_ERROR( "DirectFB/Config '%s': No value specified!\n", name );
+               return DFB_INVARG;
+          }
+     } else
      if (strcmp (name, "keep-accumulators" ) == 0) {
           if (value) {
                int limit;
@@ -1911,6 +2014,12 @@ DFBResult dfb_config_set( const char *name, const char *value )
      if (strcmp (name, "no-gfxcard-stats" ) == 0) {
           dfb_config->gfxcard_stats = 0;
      } else
+     if (strcmp (name, "gfx-stats" ) == 0) {
+          dfb_config->gfx_stats = true;
+     } else
+     if (strcmp (name, "no-gfx-stats" ) == 0) {
+          dfb_config->gfx_stats = false;
+     } else
      if (strcmp (name, "screen-frame-interval" ) == 0) {
           if (value) {
                char *error;
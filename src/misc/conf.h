@@ -41,6 +41,8 @@
 
 #include <core/coredefs.h>
 
+#include <misc/gfx_resample.h>
+
 
 typedef struct {
      bool                                init;
@@ -326,6 +328,16 @@ typedef struct
      long long     max_frame_advance;
 
      bool          ownership_check;
+
+     size_t        image_cache;    /* decoded image cache budget in bytes */
+
+     DFBResampleFilter image_scale_filter;   /* used by dfb_scale_linear_32() */
+
+     bool          gfx_stats;      /* per operation statistics in a shared memory segment, see core/gfxstats.h */
+
+     unsigned int  stream_buffer;       /* initial capacity of streamed data buffers in bytes */
+     unsigned int  stream_buffer_high;  /* PutData() on streamed data buffers blocks at this level (0 = never) */
+     unsigned int  stream_buffer_low;   /* ...until the level dropped to this */
 } DFBConfig;
 
 extern DFBConfig DIRECTFB_API *dfb_config;
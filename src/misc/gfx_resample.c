@@ -0,0 +1,629 @@
+/*
+   (c) Copyright 2012-2013  DirectFB integrated media GmbH
+   (c) Copyright 2001-2013  The world wide DirectFB Open Source Community (directfb.org)
+   (c) Copyright 2000-2004  Convergence (integrated media) GmbH
+
+   All rights reserved.
+
+   Written by Denis Oliver Kropp <dok@directfb.org>,
+              Andreas Shimokawa <andi@directfb.org>,
+              Marek Pikarski <mass@directfb.org>,
+              Sven Neumann <neo@directfb.org>,
+              Ville Syrjälä <syrjala@sci.fi> and
+              Claudio Ciccani <klan@users.sf.net>.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+#include <config.h>
+
+#include <math.h>
+#include <string.h>
+
+#include <directfb.h>
+
+#include <direct/debug.h>
+#include <direct/mem.h>
+#include <direct/memcpy.h>
+#include <direct/messages.h>
+#include <direct/thread.h>
+#include <direct/util.h>
+
+#include <misc/conf.h>
+#include <misc/gfx_resample.h>
+
+
+D_DEBUG_DOMAIN( Gfx_Resample, "Gfx/Resample", "Separable image resampling" );
+
+/**********************************************************************************************************************/
+
+/*
+ * Weights are signed 2.14 fixed point. The horizontal pass keeps 6 fractional bits in its 16 bit output, so
+ * that the vertical pass can use 16x16 bit multiplications as well and overshooting of the bicubic and Lanczos
+ * kernels still fits.
+ */
+#define WEIGHT_BITS      14
+#define HPASS_SHIFT      (WEIGHT_BITS - 6)
+#define VPASS_SHIFT      (WEIGHT_BITS + 6)
+
+#define CACHE_SIZE       8
+
+struct __DFB_DFBResampleWeights {
+     int                 refs;
+     bool                cached;
+
+     DFBResampleFilter   filter;
+     int                 src_len;
+     int                 dst_len;
+
+     int                 taps;       /* per destination pixel */
+     int                *start;      /* first source pixel per destination pixel */
+     s16                *weights;    /* taps weights per destination pixel, sum is 1 << WEIGHT_BITS */
+};
+
+typedef void (*HFilterFunc)( const u32 *src, s16 *dst, const int *start, const s16 *weights, int taps, int num );
+typedef void (*VFilterFunc)( const s16 **src, u32 *dst, const s16 *weights, int taps, int num );
+
+static DirectMutex         cache_lock = DIRECT_MUTEX_INITIALIZER(cache_lock);
+static DFBResampleWeights *cache[CACHE_SIZE];
+static unsigned int        cache_next;
+
+/**********************************************************************************************************************/
+
+static double
+filter_radius( DFBResampleFilter filter )
+{
+     switch (filter) {
+          case DRF_BICUBIC:
+               return 2.0;
+          case DRF_LANCZOS:
+               return 3.0;
+          default:
+               return 1.0;
+     }
+}
+
+static double
+filter_kernel( DFBResampleFilter filter, double x )
+{
+     x = fabs( x );
+
+     switch (filter) {
+          case DRF_BICUBIC:
+               if (x < 1.0)
+                    return (1.5 * x - 2.5) * x * x + 1.0;
+               if (x < 2.0)
+                    return ((-0.5 * x + 2.5) * x - 4.0) * x + 2.0;
+               return 0.0;
+
+          case DRF_LANCZOS:
+               if (x < 1e-8)
+                    return 1.0;
+               if (x < 3.0)
+                    return 3.0 * sin( M_PI * x ) * sin( M_PI * x / 3.0 ) / (M_PI * M_PI * x * x);
+               return 0.0;
+
+          default:
+               return x < 1.0 ? 1.0 - x : 0.0;
+     }
+}
+
+static DFBResampleWeights *
+weights_create( DFBResampleFilter filter, int src_len, int dst_len )
+{
+     DFBResampleWeights *weights;
+     double              scale = (double) dst_len / src_len;
+     double              fscale;
+     double              radius;
+     double             *raw;
+     int                 max_taps;
+     int                 i, t;
+
+     /* Linear filtering uses area averaging when scaling down. */
+     bool box = (filter == DRF_LINEAR && scale < 1.0);
+
+     fscale = scale < 1.0 ? 1.0 / scale : 1.0;
+     radius = filter_radius( filter ) * fscale;
+
+     if (box)
+          max_taps = (int) ceil( fscale ) + 1;
+     else
+          max_taps = (int) ceil( 2.0 * radius ) + 1;
+
+     weights = D_CALLOC( 1, sizeof(DFBResampleWeights) );
+     if (!weights) {
+          D_OOM();
+          return NULL;
+     }
+
+     weights->filter  = filter;
+     weights->src_len = src_len;
+     weights->dst_len = dst_len;
+     weights->taps    = MIN( max_taps, src_len );
+     weights->start   = D_MALLOC( dst_len * sizeof(int) );
+     weights->weights = D_CALLOC( dst_len * weights->taps, sizeof(s16) );
+
+     raw = D_MALLOC( (max_taps + weights->taps) * sizeof(double) );
+
+     if (!weights->start || !weights->weights || !raw) {
+          D_OOM();
+
+          if (raw)
+               D_FREE( raw );
+          if (weights->weights)
+               D_FREE( weights->weights );
+          if (weights->start)
+               D_FREE( weights->start );
+          D_FREE( weights );
+
+          return NULL;
+     }
+
+     for (i=0; i<dst_len; i++) {
+          double *slots = raw + max_taps;
+          double  sum   = 0.0;
+          s16    *dst   = weights->weights + i * weights->taps;
+          int     left, start, total, largest = 0;
+
+          if (box) {
+               double a = i / scale;
+               double b = (i + 1) / scale;
+
+               left = (int) floor( a );
+
+               for (t=0; t<max_taps; t++) {
+                    double overlap = MIN( left + t + 1, b ) - MAX( left + t, a );
+
+                    raw[t] = overlap > 0.0 ? overlap : 0.0;
+               }
+          }
+          else {
+               double center = (i + 0.5) / scale - 0.5;
+
+               left = (int) ceil( center - radius );
+
+               for (t=0; t<max_taps; t++)
+                    raw[t] = filter_kernel( filter, (left + t - center) / fscale );
+          }
+
+          /* Fold samples beyond the edges onto the edge pixels. */
+          start = CLAMP( left, 0, src_len - weights->taps );
+
+          memset( slots, 0, weights->taps * sizeof(double) );
+
+          for (t=0; t<max_taps; t++) {
+               int k = CLAMP( left + t, 0, src_len - 1 ) - start;
+
+               D_ASSERT( k >= 0 && k < weights->taps );
+
+               slots[k] += raw[t];
+               sum      += raw[t];
+          }
+
+          if (sum == 0.0) {
+               slots[CLAMP( left + max_taps / 2, 0, src_len - 1 ) - start] = 1.0;
+               sum = 1.0;
+          }
+
+          /* Convert to fixed point, putting the rounding error into the largest weight. */
+          for (t=0, total=0; t<weights->taps; t++) {
+               dst[t] = (s16) floor( slots[t] / sum * (1 << WEIGHT_BITS) + 0.5 );
+
+               total += dst[t];
+
+               if (dst[t] > dst[largest])
+                    largest = t;
+          }
+
+          dst[largest] += (1 << WEIGHT_BITS) - total;
+
+          weights->start[i] = start;
+     }
+
+     D_FREE( raw );
+
+     D_DEBUG_AT( Gfx_Resample, "  -> created weights for %d -> %d, filter %d, %d taps\n",
+                 src_len, dst_len, filter, weights->taps );
+
+     return weights;
+}
+
+static void
+weights_destroy( DFBResampleWeights *weights )
+{
+     D_FREE( weights->weights );
+     D_FREE( weights->start );
+     D_FREE( weights );
+}
+
+static DFBResampleWeights *
+weights_get( DFBResampleFilter filter, int src_len, int dst_len )
+{
+     int                 i;
+     DFBResampleWeights *weights;
+
+     direct_mutex_lock( &cache_lock );
+
+     for (i=0; i<CACHE_SIZE; i++) {
+          weights = cache[i];
+
+          if (weights && weights->filter == filter && weights->src_len == src_len && weights->dst_len == dst_len) {
+               weights->refs++;
+
+               direct_mutex_unlock( &cache_lock );
+
+               return weights;
+          }
+     }
+
+     direct_mutex_unlock( &cache_lock );
+
+     weights = weights_create( filter, src_len, dst_len );
+     if (!weights)
+          return NULL;
+
+     weights->refs = 1;
+
+     direct_mutex_lock( &cache_lock );
+
+     /* Replace the next entry that is not in use, round robin. */
+     for (i=0; i<CACHE_SIZE; i++) {
+          unsigned int index = (cache_next + i) % CACHE_SIZE;
+
+          if (!cache[index] || !cache[index]->refs) {
+               if (cache[index])
+                    weights_destroy( cache[index] );
+
+               cache[index]    = weights;
+               cache_next      = index + 1;
+               weights->cached = true;
+               break;
+          }
+     }
+
+     direct_mutex_unlock( &cache_lock );
+
+     return weights;
+}
+
+static void
+weights_put( DFBResampleWeights *weights )
+{
+     direct_mutex_lock( &cache_lock );
+
+     D_ASSERT( weights->refs > 0 );
+
+     if (!--weights->refs && !weights->cached)
+          weights_destroy( weights );
+
+     direct_mutex_unlock( &cache_lock );
+}
+
+/**********************************************************************************************************************/
+
+static void
+hfilter_C( const u32 *src, s16 *dst, const int *start, const s16 *weights, int taps, int num )
+{
+     int x, k;
+
+     for (x=0; x<num; x++) {
+          const u32 *s  = src + start[x];
+          int        c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+
+          for (k=0; k<taps; k++) {
+               u32 p = s[k];
+               int w = weights[k];
+
+               c0 += (int)((p      ) & 0xff) * w;
+               c1 += (int)((p >>  8) & 0xff) * w;
+               c2 += (int)((p >> 16) & 0xff) * w;
+               c3 += (int)((p >> 24)       ) * w;
+          }
+
+          dst[0] = (c0 + (1 << (HPASS_SHIFT - 1))) >> HPASS_SHIFT;
+          dst[1] = (c1 + (1 << (HPASS_SHIFT - 1))) >> HPASS_SHIFT;
+          dst[2] = (c2 + (1 << (HPASS_SHIFT - 1))) >> HPASS_SHIFT;
+          dst[3] = (c3 + (1 << (HPASS_SHIFT - 1))) >> HPASS_SHIFT;
+
+          dst     += 4;
+          weights += taps;
+     }
+}
+
+static inline u32
+vfilter_pixel( const s16 **src, int offset, const s16 *weights, int taps )
+{
+     int c[4] = { 0, 0, 0, 0 };
+     int i, k;
+
+     for (k=0; k<taps; k++) {
+          const s16 *s = src[k] + offset;
+
+          c[0] += s[0] * weights[k];
+          c[1] += s[1] * weights[k];
+          c[2] += s[2] * weights[k];
+          c[3] += s[3] * weights[k];
+     }
+
+     for (i=0; i<4; i++) {
+          c[i] = (c[i] + (1 << (VPASS_SHIFT - 1))) >> VPASS_SHIFT;
+          c[i] = CLAMP( c[i], 0, 0xff );
+     }
+
+     return c[0] | (c[1] << 8) | (c[2] << 16) | ((u32) c[3] << 24);
+}
+
+static void
+vfilter_C( const s16 **src, u32 *dst, const s16 *weights, int taps, int num )
+{
+     int x;
+
+     for (x=0; x<num; x++)
+          dst[x] = vfilter_pixel( src, x * 4, weights, taps );
+}
+
+#if defined(USE_SSE) && defined(__SSE2__)
+# include "gfx_resample_sse2.h"
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+# include "gfx_resample_neon.h"
+#endif
+
+static HFilterFunc hfilter = hfilter_C;
+static VFilterFunc vfilter = vfilter_C;
+
+static void
+init_filters( void )
+{
+     static bool initialized = false;
+
+     if (initialized)
+          return;
+
+     initialized = true;
+
+#if defined(USE_SSE) && defined(__SSE2__)
+     /* Same switch as for MMX, "no-mmx" turns off all x86 SIMD code. */
+     if (dfb_config->mmx) {
+          hfilter = hfilter_SSE2;
+          vfilter = vfilter_SSE2;
+     }
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+     hfilter = hfilter_NEON;
+     vfilter = vfilter_NEON;
+#endif
+}
+
+/**********************************************************************************************************************/
+
+static void
+premultiply_row( const u32 *src, u32 *dst, int num, DFBResampleFlags flags )
+{
+     int x;
+
+     if (flags & (DRSF_SRC_PREMULTIPLIED | DRSF_OPAQUE)) {
+          direct_memcpy( dst, src, num * 4 );
+          return;
+     }
+
+     for (x=0; x<num; x++) {
+          u32 p = src[x];
+          u32 a = p >> 24;
+
+          if (a == 0xff)
+               dst[x] = p;
+          else if (!a)
+               dst[x] = 0;
+          else {
+               u32 rb = (p & 0xff00ff) * a + 0x800080;
+               u32 g  = (p & 0x00ff00) * a + 0x008000;
+
+               rb = ((rb + ((rb >> 8) & 0xff00ff)) >> 8) & 0xff00ff;
+               g  = ((g  + ((g  >> 8) & 0x00ff00)) >> 8) & 0x00ff00;
+
+               dst[x] = (a << 24) | rb | g;
+          }
+     }
+}
+
+/* Clamp colors to alpha after overshooting, remove premultiplication if requested. */
+static void
+finish_row( u32 *row, int num, DFBResampleFlags flags )
+{
+     int x;
+
+     if (flags & DRSF_OPAQUE) {
+          for (x=0; x<num; x++)
+               row[x] |= 0xff000000;
+
+          return;
+     }
+
+     for (x=0; x<num; x++) {
+          u32 p = row[x];
+          u32 a = p >> 24;
+          u32 r, g, b;
+
+          if (a == 0xff)
+               continue;
+
+          if (!a) {
+               row[x] = 0;
+               continue;
+          }
+
+          r = MIN( (p >> 16) & 0xff, a );
+          g = MIN( (p >>  8) & 0xff, a );
+          b = MIN( (p      ) & 0xff, a );
+
+          if (!(flags & DRSF_DST_PREMULTIPLIED)) {
+               r = (r * 0xff + a / 2) / a;
+               g = (g * 0xff + a / 2) / a;
+               b = (b * 0xff + a / 2) / a;
+          }
+
+          row[x] = (a << 24) | (r << 16) | (g << 8) | b;
+     }
+}
+
+/**********************************************************************************************************************/
+
+DFBResult
+dfb_resampler_init( DFBResampler      *resampler,
+                    DFBResampleFilter  filter,
+                    DFBResampleFlags   flags,
+                    int                sw,
+                    int                sh,
+                    int                dw,
+                    int                dh )
+{
+     D_DEBUG_AT( Gfx_Resample, "%s( %p, filter %d, flags 0x%x, %dx%d -> %dx%d )\n",
+                 __FUNCTION__, resampler, filter, flags, sw, sh, dw, dh );
+
+     D_ASSERT( resampler != NULL );
+
+     if (sw < 1 || sh < 1 || dw < 1 || dh < 1)
+          return DFB_INVARG;
+
+     init_filters();
+
+     memset( resampler, 0, sizeof(DFBResampler) );
+
+     resampler->flags = flags;
+     resampler->sw    = sw;
+     resampler->sh    = sh;
+     resampler->dw    = dw;
+     resampler->dh    = dh;
+
+     resampler->x = weights_get( filter, sw, dw );
+     if (!resampler->x)
+          return DFB_NOSYSTEMMEMORY;
+
+     resampler->y = weights_get( filter, sh, dh );
+     if (!resampler->y) {
+          weights_put( resampler->x );
+          return DFB_NOSYSTEMMEMORY;
+     }
+
+     return DFB_OK;
+}
+
+void
+dfb_resampler_deinit( DFBResampler *resampler )
+{
+     D_ASSERT( resampler != NULL );
+
+     if (resampler->y)
+          weights_put( resampler->y );
+
+     if (resampler->x)
+          weights_put( resampler->x );
+
+     resampler->x = NULL;
+     resampler->y = NULL;
+}
+
+DFBResult
+dfb_resampler_run( const DFBResampler *resampler,
+                   const u32          *src,
+                   int                 spitch,
+                   int                 x1,
+                   int                 x2,
+                   int                 y1,
+                   int                 y2,
+                   DFBResampleRowFunc  func,
+                   void               *ctx )
+{
+     const DFBResampleWeights  *xw;
+     const DFBResampleWeights  *yw;
+     int                        num;
+     int                        sx1, sx2;
+     int                        x, y, k;
+     int                        next_row;
+     int                       *start;
+     u32                       *pm;
+     u32                       *out;
+     s16                       *ring;
+     const s16                **rows;
+     void                      *mem;
+
+     D_ASSERT( resampler != NULL );
+     D_ASSERT( resampler->x != NULL );
+     D_ASSERT( resampler->y != NULL );
+     D_ASSERT( src != NULL );
+     D_ASSERT( func != NULL );
+
+     xw = resampler->x;
+     yw = resampler->y;
+
+     x1 = MAX( x1, 0 );
+     y1 = MAX( y1, 0 );
+     x2 = MIN( x2, resampler->dw );
+     y2 = MIN( y2, resampler->dh );
+
+     if (x1 >= x2 || y1 >= y2)
+          return DFB_OK;
+
+     num = x2 - x1;
+     sx1 = xw->start[x1];
+     sx2 = xw->start[x2-1] + xw->taps;
+
+     /* Row pointers and horizontally filtered rows, source pixels of a row, output row, start indices. */
+     mem = D_MALLOC( yw->taps * (sizeof(void*) + num * 4 * sizeof(s16)) + (sx2 - sx1) * 4 + num * 4 + num * sizeof(int) );
+     if (!mem)
+          return D_OOM();
+
+     rows  = mem;
+     ring  = (s16 *)(rows + yw->taps);
+     pm    = (u32 *)(ring + yw->taps * num * 4);
+     out   = pm + (sx2 - sx1);
+     start = (int *)(out + num);
+
+     for (x=0; x<num; x++)
+          start[x] = xw->start[x1 + x] - sx1;
+
+     next_row = -1;
+
+     for (y=y1; y<y2; y++) {
+          int ys = yw->start[y];
+
+          /* Filter the source rows not yet in the ring horizontally, which holds the last 'taps' rows. */
+          for (k = MAX( next_row, ys ); k < ys + yw->taps; k++) {
+               premultiply_row( (const u32*)((const u8*) src + k * spitch) + sx1, pm, sx2 - sx1, resampler->flags );
+
+               hfilter( pm, ring + (k % yw->taps) * num * 4, start, xw->weights + x1 * xw->taps, xw->taps, num );
+          }
+
+          next_row = ys + yw->taps;
+
+          for (k=0; k<yw->taps; k++)
+               rows[k] = ring + ((ys + k) % yw->taps) * num * 4;
+
+          vfilter( rows, out, yw->weights + y * yw->taps, yw->taps, num );
+
+          finish_row( out, num, resampler->flags );
+
+          func( ctx, y, out );
+     }
+
+     D_FREE( mem );
+
+     return DFB_OK;
+}
+
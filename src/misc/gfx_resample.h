@@ -0,0 +1,102 @@
+/*
+   (c) Copyright 2012-2013  DirectFB integrated media GmbH
+   (c) Copyright 2001-2013  The world wide DirectFB Open Source Community (directfb.org)
+   (c) Copyright 2000-2004  Convergence (integrated media) GmbH
+
+   All rights reserved.
+
+   Written by Denis Oliver Kropp <dok@directfb.org>,
+              Andreas Shimokawa <andi@directfb.org>,
+              Marek Pikarski <mass@directfb.org>,
+              Sven Neumann <neo@directfb.org>,
+              Ville Syrjälä <syrjala@sci.fi> and
+              Claudio Ciccani <klan@users.sf.net>.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+#ifndef __GFX_RESAMPLE_H__
+#define __GFX_RESAMPLE_H__
+
+#include <directfb.h>
+
+/*
+ * Separable resampling of 32 bit ARGB images
+ *
+ * Each destination pixel is computed from a horizontal and a vertical one dimensional filter, the weights of which
+ * are calculated once per filter and scale factor and shared via a small cache. Filtering happens on premultiplied
+ * pixels in 16 bit fixed point, with SSE2 or NEON inner loops where available.
+ */
+
+typedef enum {
+     DRF_LINEAR          = 0,      /* Bilinear for upscaling, area averaging for downscaling. */
+     DRF_BICUBIC         = 1,      /* Catmull-Rom cubic spline. */
+     DRF_LANCZOS         = 2       /* Lanczos with three lobes. */
+} DFBResampleFilter;
+
+typedef enum {
+     DRSF_NONE              = 0x00000000,
+     DRSF_SRC_PREMULTIPLIED = 0x00000001,  /* Source pixels are premultiplied already. */
+     DRSF_DST_PREMULTIPLIED = 0x00000002,  /* Keep output premultiplied instead of dividing by alpha. */
+     DRSF_OPAQUE            = 0x00000004   /* Ignore source alpha, output alpha is always 0xff. */
+} DFBResampleFlags;
+
+typedef struct __DFB_DFBResampleWeights DFBResampleWeights;
+
+typedef struct {
+     DFBResampleFlags           flags;
+
+     int                        sw;
+     int                        sh;
+     int                        dw;
+     int                        dh;
+
+     DFBResampleWeights        *x;
+     DFBResampleWeights        *y;
+} DFBResampler;
+
+/*
+ * Called for each destination row with the pixels of the requested columns.
+ */
+typedef void (*DFBResampleRowFunc)( void *ctx, int y, const u32 *row );
+
+
+DFBResult dfb_resampler_init  ( DFBResampler       *resampler,
+                                DFBResampleFilter   filter,
+                                DFBResampleFlags    flags,
+                                int                 sw,
+                                int                 sh,
+                                int                 dw,
+                                int                 dh );
+
+void      dfb_resampler_deinit( DFBResampler       *resampler );
+
+/*
+ * Produces destination rows y1 to y2 and columns x1 to x2 (exclusive) from the source image of sw x sh pixels
+ * with a pitch in bytes. Different ranges may be processed by several threads at the same time.
+ */
+DFBResult dfb_resampler_run   ( const DFBResampler *resampler,
+                                const u32          *src,
+                                int                 spitch,
+                                int                 x1,
+                                int                 x2,
+                                int                 y1,
+                                int                 y2,
+                                DFBResampleRowFunc  func,
+                                void               *ctx );
+
+#endif
+
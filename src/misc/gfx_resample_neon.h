@@ -0,0 +1,84 @@
+/*
+   (c) Copyright 2012-2013  DirectFB integrated media GmbH
+   (c) Copyright 2001-2013  The world wide DirectFB Open Source Community (directfb.org)
+   (c) Copyright 2000-2004  Convergence (integrated media) GmbH
+
+   All rights reserved.
+
+   Written by Denis Oliver Kropp <dok@directfb.org>,
+              Andreas Shimokawa <andi@directfb.org>,
+              Marek Pikarski <mass@directfb.org>,
+              Sven Neumann <neo@directfb.org>,
+              Ville Syrjälä <syrjala@sci.fi> and
+              Claudio Ciccani <klan@users.sf.net>.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+#ifndef __GFX_RESAMPLE_NEON_H__
+#define __GFX_RESAMPLE_NEON_H__
+
+#include <arm_neon.h>
+
+/*
+ * Both passes produce exactly the same output as their C counterparts, one pixel with its four channels
+ * is processed per vector, multiplied and accumulated per tap.
+ */
+
+static void
+hfilter_NEON( const u32 *src, s16 *dst, const int *start, const s16 *weights, int taps, int num )
+{
+     int x, k;
+
+     for (x=0; x<num; x++) {
+          const u32 *s   = src + start[x];
+          int32x4_t  acc = vdupq_n_s32( 1 << (HPASS_SHIFT - 1) );
+
+          for (k=0; k<taps; k++) {
+               uint16x8_t p = vmovl_u8( vreinterpret_u8_u32( vdup_n_u32( s[k] ) ) );
+
+               acc = vmlal_n_s16( acc, vreinterpret_s16_u16( vget_low_u16( p ) ), weights[k] );
+          }
+
+          vst1_s16( dst, vqmovn_s32( vshrq_n_s32( acc, HPASS_SHIFT ) ) );
+
+          dst     += 4;
+          weights += taps;
+     }
+}
+
+static void
+vfilter_NEON( const s16 **src, u32 *dst, const s16 *weights, int taps, int num )
+{
+     int x, k;
+
+     for (x=0; x<num; x++) {
+          int32x4_t  acc = vdupq_n_s32( 1 << (VPASS_SHIFT - 1) );
+          uint16x4_t c;
+          uint8x8_t  p;
+
+          for (k=0; k<taps; k++)
+               acc = vmlal_n_s16( acc, vld1_s16( src[k] + x * 4 ), weights[k] );
+
+          c = vqmovun_s32( vshrq_n_s32( acc, VPASS_SHIFT ) );
+          p = vqmovn_u16( vcombine_u16( c, c ) );
+
+          dst[x] = vget_lane_u32( vreinterpret_u32_u8( p ), 0 );
+     }
+}
+
+#endif
+
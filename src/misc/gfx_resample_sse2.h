@@ -0,0 +1,126 @@
+/*
+   (c) Copyright 2012-2013  DirectFB integrated media GmbH
+   (c) Copyright 2001-2013  The world wide DirectFB Open Source Community (directfb.org)
+   (c) Copyright 2000-2004  Convergence (integrated media) GmbH
+
+   All rights reserved.
+
+   Written by Denis Oliver Kropp <dok@directfb.org>,
+              Andreas Shimokawa <andi@directfb.org>,
+              Marek Pikarski <mass@directfb.org>,
+              Sven Neumann <neo@directfb.org>,
+              Ville Syrjälä <syrjala@sci.fi> and
+              Claudio Ciccani <klan@users.sf.net>.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+#ifndef __GFX_RESAMPLE_SSE2_H__
+#define __GFX_RESAMPLE_SSE2_H__
+
+#include <emmintrin.h>
+
+/*
+ * Both passes produce exactly the same output as their C counterparts. Pairs of taps are multiplied and added
+ * at once via pmaddwd, which gets the channels of two pixels interleaved and the two weights repeated.
+ */
+
+static inline __m128i
+weight_pair( const s16 *weights )
+{
+     return _mm_set1_epi32( (u16) weights[0] | ((u32)(u16) weights[1] << 16) );
+}
+
+static void
+hfilter_SSE2( const u32 *src, s16 *dst, const int *start, const s16 *weights, int taps, int num )
+{
+     const __m128i zero  = _mm_setzero_si128();
+     const __m128i round = _mm_set1_epi32( 1 << (HPASS_SHIFT - 1) );
+     int           x, k;
+
+     for (x=0; x<num; x++) {
+          const u32 *s   = src + start[x];
+          __m128i    acc = round;
+
+          for (k=0; k<taps-1; k+=2) {
+               __m128i p = _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i*)(s + k) ), zero );
+
+               /* b0 g0 r0 a0 b1 g1 r1 a1 -> b0 b1 g0 g1 r0 r1 a0 a1 */
+               p = _mm_unpacklo_epi16( p, _mm_srli_si128( p, 8 ) );
+
+               acc = _mm_add_epi32( acc, _mm_madd_epi16( p, weight_pair( weights + k ) ) );
+          }
+
+          if (k < taps) {
+               __m128i p = _mm_unpacklo_epi8( _mm_cvtsi32_si128( s[k] ), zero );
+
+               p = _mm_unpacklo_epi16( p, zero );
+
+               acc = _mm_add_epi32( acc, _mm_madd_epi16( p, _mm_set1_epi32( (u16) weights[k] ) ) );
+          }
+
+          acc = _mm_srai_epi32( acc, HPASS_SHIFT );
+
+          _mm_storel_epi64( (__m128i*) dst, _mm_packs_epi32( acc, acc ) );
+
+          dst     += 4;
+          weights += taps;
+     }
+}
+
+static void
+vfilter_SSE2( const s16 **src, u32 *dst, const s16 *weights, int taps, int num )
+{
+     const __m128i zero  = _mm_setzero_si128();
+     const __m128i round = _mm_set1_epi32( 1 << (VPASS_SHIFT - 1) );
+     int           x, k;
+
+     /* Two pixels at once. */
+     for (x=0; x<num-1; x+=2) {
+          __m128i acc0 = round;
+          __m128i acc1 = round;
+
+          for (k=0; k<taps-1; k+=2) {
+               __m128i a = _mm_loadu_si128( (const __m128i*)(src[k]   + x * 4) );
+               __m128i b = _mm_loadu_si128( (const __m128i*)(src[k+1] + x * 4) );
+               __m128i w = weight_pair( weights + k );
+
+               acc0 = _mm_add_epi32( acc0, _mm_madd_epi16( _mm_unpacklo_epi16( a, b ), w ) );
+               acc1 = _mm_add_epi32( acc1, _mm_madd_epi16( _mm_unpackhi_epi16( a, b ), w ) );
+          }
+
+          if (k < taps) {
+               __m128i a = _mm_loadu_si128( (const __m128i*)(src[k] + x * 4) );
+               __m128i w = _mm_set1_epi32( (u16) weights[k] );
+
+               acc0 = _mm_add_epi32( acc0, _mm_madd_epi16( _mm_unpacklo_epi16( a, zero ), w ) );
+               acc1 = _mm_add_epi32( acc1, _mm_madd_epi16( _mm_unpackhi_epi16( a, zero ), w ) );
+          }
+
+          acc0 = _mm_srai_epi32( acc0, VPASS_SHIFT );
+          acc1 = _mm_srai_epi32( acc1, VPASS_SHIFT );
+
+          acc0 = _mm_packs_epi32( acc0, acc1 );
+
+          _mm_storel_epi64( (__m128i*)(dst + x), _mm_packus_epi16( acc0, acc0 ) );
+     }
+
+     if (x < num)
+          dst[x] = vfilter_pixel( src, x * 4, weights, taps );
+}
+
+#endif
+
@@ -34,6 +34,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #include <pthread.h>
 
@@ -49,32 +50,18 @@
 #include <direct/memcpy.h>
 #include <direct/mem.h>
 #include <direct/messages.h>
+#include <direct/thread.h>
 #include <direct/util.h>
 
+#include <misc/conf.h>
 #include <misc/util.h>
 #include <misc/dither.h>
 #include <misc/dither565.h>
+#include <misc/gfx_resample.h>
 #include <misc/gfx_util.h>
 
-#include <gfx/clip.h>
 #include <gfx/convert.h>
-
-
-#define SUBSAMPLE_BITS 4
-#define SUBSAMPLE (1 << SUBSAMPLE_BITS)
-#define SUBSAMPLE_MASK ((1 << SUBSAMPLE_BITS)-1)
-#define SCALE_SHIFT 16
-
-
-typedef struct _PixopsFilter PixopsFilter;
-
-struct _PixopsFilter {
-     int *weights;
-     int n_x;
-     int n_y;
-     float x_offset;
-     float y_offset;
-};
+#include <gfx/convert_row.h>
 
 
 static void write_argb_span (u32 *src, u8 *dst[], int len,
@@ -207,8 +194,7 @@ static void write_argb_span (u32 *src, u8 *dst[], int len,
                     }
                }
 #else
-               for (i = 0; i < len; i++)
-                    ((u16*)d)[i] = RGB32_TO_RGB16( src[i] );
+               dfb_convert_row_argb_to_rgb16( src, (u16*) d, len );
 #endif
                break;
 
@@ -251,17 +237,11 @@ static void write_argb_span (u32 *src, u8 *dst[], int len,
                break;
 
           case DSPF_RGB24:
-               for (i = 0; i < len; i++) {
 #ifdef WORDS_BIGENDIAN
-                    *d++ = src[i] >> 16;
-                    *d++ = src[i] >> 8;
-                    *d++ = src[i];
+               dfb_convert_row_argb_to_rgb888( src, d, len );
 #else
-                    *d++ = src[i];
-                    *d++ = src[i] >> 8;
-                    *d++ = src[i] >> 16;
+               dfb_convert_row_argb_to_bgr888( src, d, len );
 #endif
-               }
                break;
 
           case DSPF_RGB32:
@@ -270,8 +250,7 @@ static void write_argb_span (u32 *src, u8 *dst[], int len,
                break;
 
           case DSPF_ABGR:
-               for (i = 0; i < len; i++)
-                    ((u32*)d)[i] = ARGB_TO_ABGR( src[i] );
+               dfb_convert_row_swap_rb( src, (u32*) d, len, 0 );
                break;
 
           case DSPF_AiRGB:
@@ -392,16 +371,7 @@ static void write_argb_span (u32 *src, u8 *dst[], int len,
                break;
 
           case DSPF_AYUV:
-               for (i = 0; i < len; i++) {
-                    u32 a, y, u, v;
-
-                    RGB_TO_YCBCR( (src[i] >> 16) & 0xff,
-                                  (src[i] >>  8) & 0xff,
-                                  (src[i]      ) & 0xff, y, u, v );
-                    a = (src[i] >> 24) & 0xff;
-
-                    ((u32*)d)[i] = PIXEL_AYUV( a, y, u, v );
-               }
+               dfb_convert_row_argb_to_ayuv( src, (u32*) d, len, dst_surface->config.colorspace );
                break;
 
           case DSPF_AVYU:
@@ -624,520 +594,456 @@ static void write_argb_span (u32 *src, u8 *dst[], int len,
           ? (((u8*)(dst)) + (y)/2 * (pitch) + (((y)%2) ? (h)/2 * (pitch) : 0)) \
           : (((u8*)(dst)) + (y) * (pitch)))
 
-void dfb_copy_buffer_32( u32 *src,
-                         void  *dst, int dpitch, DFBRectangle *drect,
-                         CoreSurface *dst_surface, const DFBRegion *dst_clip )
-{
-     u8   *dst1, *dst2;
-     int   sw = drect->w;
-     int   y, x;
-
-     if (dst_clip) {
-          int sx = 0, sy = 0;
+/**********************************************************************************************************************/
 
-          if (drect->x < dst_clip->x1) {
-               sx = dst_clip->x1 - drect->x;
-               drect->w -= sx;
-               drect->x += sx;
-          }
-          if (drect->y < dst_clip->y1) {
-               sy = dst_clip->y1 - drect->y;
-               drect->h -= sy;
-               drect->y += sy;
-          }
-          if ((drect->x + drect->w - 1) > dst_clip->x2) {
-               drect->w -= drect->x + drect->w - 1 - dst_clip->x2;
-          }
-          if ((drect->y + drect->h - 1) > dst_clip->y2) {
-               drect->h -= drect->y + drect-> h - 1 - dst_clip->y2;
-          }
-
-          src += sy * sw + sx;
-     }
-
-     if (drect->w < 1 || drect->h < 1)
-          return;
-     x = drect->x;
-
-     switch (dst_surface->config.format) {
-          case DSPF_YV12:
-          case DSPF_I420:
-               if (dst_surface->config.format == DSPF_I420) {
-                    dst1 = (u8*)dst  + dpitch   * dst_surface->config.size.h;
-                    dst2 = dst1 + dpitch/2 * dst_surface->config.size.h/2;
-               } else {
-                    dst2 = (u8*)dst  + dpitch   * dst_surface->config.size.h;
-                    dst1 = dst2 + dpitch/2 * dst_surface->config.size.h/2;
-               }
-
-               for (y = drect->y; y < drect->y + drect->h; y++) {
-                    u8 *d[3];
-
-                    d[0] = LINE_PTR( dst, dst_surface->config.caps, y,
-                                     dst_surface->config.size.h, dpitch ) + x;
-                    d[1] = LINE_PTR( dst1, dst_surface->config.caps, y/2,
-                                     dst_surface->config.size.h/2, dpitch/2 ) + x/2;
-                    d[2] = LINE_PTR( dst2, dst_surface->config.caps, y/2,
-                                     dst_surface->config.size.h/2, dpitch/2 ) + x/2;
-
-                    write_argb_span( src, d, drect->w, x, y, dst_surface, true );
+/*
+ * Destination rows are independent of each other, so copying and scaling is split into bands of rows which are
+ * processed by a small pool of worker threads. The pool is sized by the "software-cores" option like the Genefx
+ * threads, the calling thread takes part as well and returns when all bands are done. Calls from workers (Genefx
+ * task threads, band functions) as well as concurrent calls run inline on the calling thread. The workers are started on first use and joined by dfb_gfx_shutdown_bands()
+ * when the core is destroyed.
+ */
+
+#define BAND_MIN_ROWS 16
+
+typedef DFBGfxBandFunc BandFunc;
+
+static DirectMutex      band_call_lock = DIRECT_MUTEX_INITIALIZER(band_call_lock);
+static DirectMutex      band_lock      = DIRECT_MUTEX_INITIALIZER(band_lock);
+static DirectWaitQueue  band_start     = DIRECT_WAITQUEUE_INITIALIZER(band_start);
+static DirectWaitQueue  band_done      = DIRECT_WAITQUEUE_INITIALIZER(band_done);
+
+static DirectThread   **band_thread_list;
+static unsigned int     band_threads;
+static bool             band_stop;
+static unsigned int     band_serial;
+static BandFunc         band_func;
+static void            *band_ctx;
+static int              band_next;
+static int              band_end;
+static int              band_rows;
+static int              band_busy;
+
+/* Called with band_lock held, returns with band_lock held. */
+static void
+band_process( void )
+{
+     while (band_next < band_end) {
+          int y1 = band_next;
+          int y2 = MIN( y1 + band_rows, band_end );
 
-                    src += sw;
-               }
-               break;
+          band_next = y2;
+          band_busy++;
 
-          case DSPF_YV16:
-               dst2 = (u8*)dst  + dpitch   * dst_surface->config.size.h;
-               dst1 = dst2 + dpitch/2 * dst_surface->config.size.h;
+          direct_mutex_unlock( &band_lock );
 
-               for (y = drect->y; y < drect->y + drect->h; y++) {
-                    u8 *d[3];
+          dfb_gfx_worker_begin();
 
-                    d[0] = LINE_PTR( dst, dst_surface->config.caps, y,
-                                     dst_surface->config.size.h, dpitch ) + x;
-                    d[1] = LINE_PTR( dst1, dst_surface->config.caps, y,
-                                     dst_surface->config.size.h, dpitch/2 ) + x/2;
-                    d[2] = LINE_PTR( dst2, dst_surface->config.caps, y,
-                                     dst_surface->config.size.h, dpitch/2 ) + x/2;
+          band_func( band_ctx, y1, y2 );
 
-                    write_argb_span( src, d, drect->w, x, y, dst_surface, true );
+          dfb_gfx_worker_end();
 
-                    src += sw;
-               }
-               break;
+          direct_mutex_lock( &band_lock );
 
-          case DSPF_NV12:
-          case DSPF_NV21:
-               dst1 = (u8*)dst + dpitch * dst_surface->config.size.h;
+          if (!--band_busy && band_next == band_end)
+               direct_waitqueue_broadcast( &band_done );
+     }
+}
 
-               for (y = drect->y; y < drect->y + drect->h; y++) {
-                    u8 *d[2];
+static void *
+band_thread( DirectThread *thread, void *arg )
+{
+     unsigned int serial = 0;
 
-                    d[0] = LINE_PTR( dst, dst_surface->config.caps, y,
-                                     dst_surface->config.size.h, dpitch ) + x;
-                    d[1] = LINE_PTR( dst1, dst_surface->config.caps, y/2,
-                                     dst_surface->config.size.h/2, dpitch ) + (x&~1);
+     direct_mutex_lock( &band_lock );
 
-                    write_argb_span( src, d, drect->w, x, y, dst_surface, true );
+     while (true) {
+          while (serial == band_serial && !band_stop)
+               direct_waitqueue_wait( &band_start, &band_lock );
 
-                    src += sw;
-               }
+          if (band_stop)
                break;
 
-          case DSPF_NV16:
-               dst1 = (u8*)dst + dpitch * dst_surface->config.size.h;
-
-               for (y = drect->y; y < drect->y + drect->h; y++) {
-                    u8 *d[2];
+          serial = band_serial;
 
-                    d[0] = LINE_PTR( dst, dst_surface->config.caps, y,
-                                     dst_surface->config.size.h, dpitch ) + x;
-                    d[1] = LINE_PTR( dst1, dst_surface->config.caps, y,
-                                     dst_surface->config.size.h, dpitch ) + (x&~1);
-
-                    write_argb_span( src, d, drect->w, x, y, dst_surface, true );
-
-                    src += sw;
-               }
-               break;
+          band_process();
+     }
 
-          case DSPF_YUV444P:
-               dst1 = (u8*)dst  + dpitch * dst_surface->config.size.h;
-               dst2 = dst1 + dpitch * dst_surface->config.size.h;
+     direct_mutex_unlock( &band_lock );
 
-               for (y = drect->y; y < drect->y + drect->h; y++) {
-                    u8 *d[3];
+     return NULL;
+}
 
-                    d[0] = LINE_PTR( dst, dst_surface->config.caps, y,
-                                     dst_surface->config.size.h, dpitch ) + x;
-                    d[1] = LINE_PTR( dst1, dst_surface->config.caps, y,
-                                     dst_surface->config.size.h, dpitch ) + x;
-                    d[2] = LINE_PTR( dst2, dst_surface->config.caps, y,
-                                     dst_surface->config.size.h, dpitch ) + x;
+void
+dfb_gfx_worker_begin( void )
+{
+     CoreTLS *core_tls = Core_GetTLS();
 
-                    write_argb_span( src, d, drect->w, x, y, dst_surface, true );
+     if (core_tls)
+          core_tls->gfx_worker++;
+}
 
-                    src += sw;
-            }
-            break;
+void
+dfb_gfx_worker_end( void )
+{
+     CoreTLS *core_tls = Core_GetTLS();
 
-          default:
-               for (y = drect->y; y < drect->y + drect->h; y++) {
-                    u8 *d[1];
+     if (core_tls) {
+          D_ASSERT( core_tls->gfx_worker > 0 );
 
-                    d[0] = LINE_PTR( dst, dst_surface->config.caps,
-                                     y, dst_surface->config.size.h, dpitch ) +
-                           DFB_BYTES_PER_LINE( dst_surface->config.format, x );
+          core_tls->gfx_worker--;
+     }
+}
 
-                    write_argb_span( src, d, drect->w, x, y, dst_surface, true );
+static bool
+is_worker( void )
+{
+     CoreTLS *core_tls = Core_GetTLS();
 
-                    src += sw;
-               }
-               break;
-     }
+     return core_tls && core_tls->gfx_worker > 0;
 }
 
-static int bilinear_make_fast_weights( PixopsFilter *filter,
-                                       const float x_scale, const float y_scale )
+static void
+run_bands( BandFunc func, void *ctx, int y1, int y2, bool parallel )
 {
-     int i_offset, j_offset;
-     float *x_weights, *y_weights;
-     int n_x, n_y;
+     unsigned int cores = dfb_config->software_cores;
 
-     if (x_scale > 1.0) {      /* Bilinear */
-          n_x = 2;
-          filter->x_offset = 0.5 * (1.0 / x_scale - 1);
-     }
-     else {                    /* Tile */
-          n_x = D_ICEIL (1.0 + 1.0 / x_scale);
-          filter->x_offset = 0.0;
+     if (!parallel || cores < 2 || y2 - y1 < BAND_MIN_ROWS * 2 || is_worker()) {
+          func( ctx, y1, y2 );
+          return;
      }
 
-     if (y_scale > 1.0) {      /* Bilinear */
-          n_y = 2;
-          filter->y_offset = 0.5 * (1.0 / y_scale - 1);
-     }
-     else {                    /* Tile */
-          n_y = D_ICEIL (1.0 + 1.0 / y_scale);
-          filter->y_offset = 0.0;
+     /*
+      * The pool serves one call at a time. Calls from other threads while the pool is busy are run inline, as well
+      * as nested calls not marked as from a worker (the lock is held by the outer call, possibly on this thread).
+      */
+     if (direct_mutex_trylock( &band_call_lock )) {
+          func( ctx, y1, y2 );
+          return;
      }
 
-     if (n_x > 64)
-          n_x = 64;
+     if (band_threads < cores - 1) {
+          DirectThread **list = D_REALLOC( band_thread_list, (cores - 1) * sizeof(DirectThread*) );
 
-     if (n_y > 64)
-          n_y = 64;
+          if (list) {
+               band_thread_list = list;
 
-     filter->n_y = n_y;
-     filter->n_x = n_x;
-     filter->weights = (int *) D_MALLOC( SUBSAMPLE * SUBSAMPLE * n_x * n_y *
-                                         sizeof (int) );
-     if (!filter->weights) {
-          D_WARN ("couldn't allocate memory for scaling");
-          return 0;
+               while (band_threads < cores - 1) {
+                    list[band_threads] = direct_thread_create( DTT_DEFAULT, band_thread, NULL, "Genefx Band" );
+                    if (!list[band_threads])
+                         break;
+
+                    band_threads++;
+               }
+          }
      }
 
-     x_weights = (float *) alloca (n_x * sizeof (float));
-     y_weights = (float *) alloca (n_y * sizeof (float));
+     direct_mutex_lock( &band_lock );
 
-     if (!x_weights || !y_weights) {
-          D_FREE( filter->weights );
+     band_func = func;
+     band_ctx  = ctx;
+     band_next = y1;
+     band_end  = y2;
+     band_rows = MAX( (y2 - y1) / ((band_threads + 1) * 2), BAND_MIN_ROWS );
 
-          D_WARN ("couldn't allocate memory for scaling");
-          return 0;
-     }
+     band_serial++;
 
-     for (i_offset = 0; i_offset < SUBSAMPLE; i_offset++)
-          for (j_offset = 0; j_offset < SUBSAMPLE; j_offset++) {
-               int *pixel_weights = filter->weights
-                                    + ((i_offset * SUBSAMPLE) + j_offset)
-                                    * n_x * n_y;
+     direct_waitqueue_broadcast( &band_start );
 
-               float x = (float)j_offset / 16;
-               float y = (float)i_offset / 16;
-               int i, j;
+     band_process();
 
-               if (x_scale > 1.0) {     /* Bilinear */
-                    for (i = 0; i < n_x; i++) {
-                         x_weights[i] = ((i == 0) ? (1 - x) : x) / x_scale;
-                    }
-               }
-               else {                   /* Tile */
-                    for (i = 0; i < n_x; i++) {
-                         if (i < x) {
-                              if (i + 1 > x)
-                                   x_weights[i] = MIN( i + 1, x + 1.0 / x_scale ) -x;
-                              else
-                                   x_weights[i] = 0;
-                         }
-                         else {
-                              if (x + 1/x_scale > i)
-                                   x_weights[i] = MIN( i + 1, x + 1.0 / x_scale ) -i;
-                              else
-                                   x_weights[i] = 0;
-                         }
-                    }
-               }
+     while (band_busy)
+          direct_waitqueue_wait( &band_done, &band_lock );
 
-               if (y_scale > 1.0) {     /* Bilinear */
-                    for (i = 0; i < n_y; i++) {
-                         y_weights[i] = ((i == 0) ? (1 - y) : y) / y_scale;
-                    }
-               }
-               else {                   /* Tile */
-                    for (i = 0; i < n_y; i++) {
-                         if (i < y) {
-                              if (i + 1 > y)
-                                   y_weights[i] = MIN( i + 1, y + 1.0 / y_scale ) -y;
-                              else
-                                   y_weights[i] = 0;
-                         }
-                         else {
-                              if (y + 1/y_scale > i)
-                                   y_weights[i] = MIN( i + 1, y + 1.0 / y_scale ) -i;
-                              else
-                                   y_weights[i] = 0;
-                         }
-                    }
-               }
+     direct_mutex_unlock( &band_lock );
 
-               for (i = 0; i < n_y; i++) {
-                    for (j = 0; j < n_x; j++) {
-                         pixel_weights[n_x * i + j] =
-                              65536.0 * x_weights[j] * x_scale
-                              * y_weights[i] * y_scale;
-                    }
-               }
-          }
+     direct_mutex_unlock( &band_call_lock );
+}
 
-     return 1;
+void
+dfb_gfx_run_bands( DFBGfxBandFunc func, void *ctx, int y1, int y2 )
+{
+     run_bands( func, ctx, y1, y2, true );
 }
 
-static void scale_pixel( const int *weights, int n_x, int n_y,
-                         u32 *dst, const u32 **src, int x, int sw )
+void
+dfb_gfx_shutdown_bands( void )
 {
-     u32 r = 0, g = 0, b = 0, a = 0;
-     int i, j;
+     unsigned int i;
 
-     for (i = 0; i < n_y; i++) {
-          const int *pixel_weights = weights + n_x * i;
+     /* Waits for a call in progress. */
+     direct_mutex_lock( &band_call_lock );
 
-          for (j = 0; j < n_x; j++) {
-               const u32 *q;
+     direct_mutex_lock( &band_lock );
 
-               if (x + j < 0)
-                    q = src[i];
-               else if (x + j < sw)
-                    q = src[i] + x + j;
-               else
-                    q = src[i] + sw - 1;
+     band_stop = true;
 
-               {
-                    const u32 ta = ((*q & 0xFF000000) >> 24) * pixel_weights[j];
+     direct_waitqueue_broadcast( &band_start );
 
-                    b += ta * (((*q & 0xFF)) + 1);
-                    g += ta * (((*q & 0xFF00) >> 8) + 1);
-                    r += ta * (((*q & 0xFF0000) >> 16) + 1);
-                    a += ta;
-               }
-          }
+     direct_mutex_unlock( &band_lock );
+
+     for (i = 0; i < band_threads; i++) {
+          direct_thread_join( band_thread_list[i] );
+          direct_thread_destroy( band_thread_list[i] );
+     }
+
+     if (band_thread_list) {
+          D_FREE( band_thread_list );
+          band_thread_list = NULL;
      }
 
-     r = (r >> 24) == 0xFF ? 0xFF : (r + 0x800000) >> 24;
-     g = (g >> 24) == 0xFF ? 0xFF : (g + 0x800000) >> 24;
-     b = (b >> 24) == 0xFF ? 0xFF : (b + 0x800000) >> 24;
-     a = (a >> 16) == 0xFF ? 0xFF : (a + 0x8000) >> 16;
+     band_threads = 0;
+     band_stop    = false;
 
-     *dst = (a << 24) | (r << 16) | (g << 8) | b;
+     direct_mutex_unlock( &band_call_lock );
 }
 
-static u32* scale_line( const int *weights, int n_x, int n_y,
-                        u32 *dst, u32 *dst_end,
-                        const u32 **src, int x, int x_step, int sw )
+/**********************************************************************************************************************/
+
+typedef struct {
+     u32                *src;
+     int                 sw;
+     int                 sh;
+     int                 spitch;      /* in pixels */
+
+     u8                 *dst;
+     u8                 *dst1;
+     u8                 *dst2;
+     int                 dpitch;
+     const DFBRectangle *drect;
+     CoreSurface        *dst_surface;
+} SpanContext;
+
+static void span_init( SpanContext *ctx, u32 *src, int sw, int sh, int spitch,
+                       void *dst, int dpitch, const DFBRectangle *drect,
+                       CoreSurface *dst_surface )
 {
-     while (dst < dst_end) {
-          const int  x_scaled      = x >> SCALE_SHIFT;
-          const int *pixel_weights = weights + ((x >> (SCALE_SHIFT -
-                                                       SUBSAMPLE_BITS))
-                                                & SUBSAMPLE_MASK) * n_x * n_y;
-          u32 r = 0, g = 0, b = 0, a = 0;
-          int i, j;
-
-          for (i = 0; i < n_y; i++) {
-               const int *line_weights = pixel_weights + n_x * i;
-               const u32 *q            = src[i] + x_scaled;
-
-               for (j = 0; j < n_x; j++) {
-                    const u32 ta = ((*q & 0xFF000000) >> 24) * line_weights[j];
-
-                    b += ta * (((*q & 0xFF)) + 1);
-                    g += ta * (((*q & 0xFF00) >> 8) + 1);
-                    r += ta * (((*q & 0xFF0000) >> 16) + 1);
-                    a += ta;
-
-                    if ((x_scaled + j) < sw-1)
-                        q++;
-               }
-          }
-
-          r = (r >> 24) == 0xFF ? 0xFF : (r + 0x800000) >> 24;
-          g = (g >> 24) == 0xFF ? 0xFF : (g + 0x800000) >> 24;
-          b = (b >> 24) == 0xFF ? 0xFF : (b + 0x800000) >> 24;
-          a = (a >> 16) == 0xFF ? 0xFF : (a + 0x8000) >> 16;
+     memset( ctx, 0, sizeof(SpanContext) );
 
-          *dst++ = (a << 24) | (r << 16) | (g << 8) | b;
+     ctx->src         = src;
+     ctx->sw          = sw;
+     ctx->sh          = sh;
+     ctx->spitch      = spitch;
+     ctx->dst         = dst;
+     ctx->dpitch      = dpitch;
+     ctx->drect       = drect;
+     ctx->dst_surface = dst_surface;
 
-          x += x_step;
+     switch (dst_surface->config.format) {
+          case DSPF_I420:
+               ctx->dst1 = (u8*)dst  + dpitch   * dst_surface->config.size.h;
+               ctx->dst2 = ctx->dst1 + dpitch/2 * dst_surface->config.size.h/2;
+               break;
+          case DSPF_YV12:
+               ctx->dst2 = (u8*)dst  + dpitch   * dst_surface->config.size.h;
+               ctx->dst1 = ctx->dst2 + dpitch/2 * dst_surface->config.size.h/2;
+               break;
+          case DSPF_YV16:
+               ctx->dst2 = (u8*)dst  + dpitch   * dst_surface->config.size.h;
+               ctx->dst1 = ctx->dst2 + dpitch/2 * dst_surface->config.size.h;
+               break;
+          case DSPF_NV12:
+          case DSPF_NV21:
+          case DSPF_NV16:
+               ctx->dst1 = (u8*)dst + dpitch * dst_surface->config.size.h;
+               break;
+          case DSPF_YUV444P:
+               ctx->dst1 = (u8*)dst  + dpitch * dst_surface->config.size.h;
+               ctx->dst2 = ctx->dst1 + dpitch * dst_surface->config.size.h;
+               break;
+          default:
+               break;
      }
-
-     return dst;
 }
 
-void dfb_scale_linear_32( u32 *src, int sw, int sh,
-                          void  *dst, int dpitch, DFBRectangle *drect,
-                          CoreSurface *dst_surface, const DFBRegion *dst_clip )
+/* The palette lookup of LUT8 and ALUT44 must not run concurrently. */
+static bool span_parallel( const SpanContext *ctx )
 {
-     DFBRectangle srect = { 0, 0, sw, sh };
-     float scale_x, scale_y;
-     int i, j;
-     int sx, sy;
-     int x_step, y_step;
-     int scaled_x_offset;
-     PixopsFilter filter;
-     u8   *dst1 = NULL, *dst2 = NULL;
-     u32  *buf;
-
-     if (drect->w == sw && drect->h == sh) {
-          dfb_copy_buffer_32( src, dst, dpitch, drect, dst_surface, dst_clip );
-          return;
+     switch (ctx->dst_surface->config.format) {
+          case DSPF_LUT8:
+          case DSPF_ALUT44:
+               return false;
+          default:
+               return true;
      }
+}
 
-     if (dst_clip)
-          dfb_clip_stretchblit( dst_clip, &srect, drect );
-
-     if (srect.w < 1 || srect.h < 1 || drect->w < 1 || drect->h < 1)
-          return;
-
-     src += srect.y * sw + srect.x;
-
-     scale_x = (float)drect->w / srect.w;
-     scale_y = (float)drect->h / srect.h;
-
-     x_step = (1 << SCALE_SHIFT) / scale_x;
-     y_step = (1 << SCALE_SHIFT) / scale_y;
-
-     if (! bilinear_make_fast_weights( &filter, scale_x, scale_y ))
-          return;
+static void span_lines( const SpanContext *ctx, int y, u8 *d[3] )
+{
+     CoreSurface *surface = ctx->dst_surface;
+     int          x       = ctx->drect->x;
 
-     scaled_x_offset = D_IFLOOR( filter.x_offset * (1 << SCALE_SHIFT) );
-     sy = D_IFLOOR( filter.y_offset * (1 << SCALE_SHIFT) );
+     d[0] = LINE_PTR( ctx->dst, surface->config.caps,
+                      y, surface->config.size.h, ctx->dpitch ) +
+            DFB_BYTES_PER_LINE( surface->config.format, x );
 
-     switch (dst_surface->config.format) {
+     switch (surface->config.format) {
           case DSPF_I420:
-               dst1 = (u8*)dst  + dpitch   * dst_surface->config.size.h;
-               dst2 = dst1 + dpitch/2 * dst_surface->config.size.h/2;
-               break;
           case DSPF_YV12:
-               dst2 = (u8*)dst  + dpitch   * dst_surface->config.size.h;
-               dst1 = dst2 + dpitch/2 * dst_surface->config.size.h/2;
+               d[1] = LINE_PTR( ctx->dst1, surface->config.caps, y/2,
+                                surface->config.size.h/2, ctx->dpitch/2 ) + x/2;
+               d[2] = LINE_PTR( ctx->dst2, surface->config.caps, y/2,
+                                surface->config.size.h/2, ctx->dpitch/2 ) + x/2;
                break;
           case DSPF_YV16:
-               dst2 = (u8*)dst  + dpitch   * dst_surface->config.size.h;
-               dst1 = dst2 + dpitch/2 * dst_surface->config.size.h;
+               d[1] = LINE_PTR( ctx->dst1, surface->config.caps, y,
+                                surface->config.size.h, ctx->dpitch/2 ) + x/2;
+               d[2] = LINE_PTR( ctx->dst2, surface->config.caps, y,
+                                surface->config.size.h, ctx->dpitch/2 ) + x/2;
                break;
           case DSPF_NV12:
           case DSPF_NV21:
+               d[1] = LINE_PTR( ctx->dst1, surface->config.caps, y/2,
+                                surface->config.size.h/2, ctx->dpitch ) + (x&~1);
+               break;
           case DSPF_NV16:
-               dst1 = (u8*)dst + dpitch * dst_surface->config.size.h;
+               d[1] = LINE_PTR( ctx->dst1, surface->config.caps, y,
+                                surface->config.size.h, ctx->dpitch ) + (x&~1);
                break;
           case DSPF_YUV444P:
-               dst1 = (u8*)dst  + dpitch * dst_surface->config.size.h;
-               dst2 = dst1 + dpitch * dst_surface->config.size.h;
+               d[1] = LINE_PTR( ctx->dst1, surface->config.caps, y,
+                                surface->config.size.h, ctx->dpitch ) + x;
+               d[2] = LINE_PTR( ctx->dst2, surface->config.caps, y,
+                                surface->config.size.h, ctx->dpitch ) + x;
                break;
           default:
                break;
      }
+}
 
-     buf = (u32*) alloca( drect->w * 4 );
+static void copy_band( void *arg, int y1, int y2 )
+{
+     const SpanContext *ctx = arg;
+     u32               *src = ctx->src + (y1 - ctx->drect->y) * ctx->spitch;
+     int                y;
 
-     for (i = drect->y; i < drect->y + drect->h; i++) {
-          int         x_start;
-          int         y_start;
-          const int  *run_weights;
-          u32        *outbuf     = buf;
-          u32        *outbuf_end = buf + drect->w;
-          u32        *new_outbuf;
-          const u32 **line_bufs;
-          u8         *d[3];
+     for (y = y1; y < y2; y++) {
+          u8 *d[3];
 
-          y_start = sy >> SCALE_SHIFT;
+          span_lines( ctx, y, d );
 
-          run_weights = filter.weights + ((sy >> (SCALE_SHIFT - SUBSAMPLE_BITS))
-                                          & SUBSAMPLE_MASK) * filter.n_x * filter.n_y * SUBSAMPLE;
+          write_argb_span( src, d, ctx->drect->w, ctx->drect->x, y, ctx->dst_surface, true );
 
-          line_bufs = (const u32 **) alloca( filter.n_y * sizeof (void *) );
+          src += ctx->spitch;
+     }
+}
 
-          for (j = 0; j < filter.n_y; j++) {
-               if (y_start <  0)
-                    line_bufs[j] = src;
-               else if (y_start < sh)
-                    line_bufs[j] = src + sw * y_start;
-               else
-                    line_bufs[j] = src + sw * (sh - 1);
+static void copy_buffer_32( u32 *src, int spitch,
+                            void *dst, int dpitch, DFBRectangle *drect,
+                            CoreSurface *dst_surface, const DFBRegion *dst_clip )
+{
+     SpanContext ctx;
 
-               y_start++;
-          }
+     if (dst_clip) {
+          int sx = 0, sy = 0;
 
-          sx = scaled_x_offset;
-          x_start = sx >> SCALE_SHIFT;
-
-          while (x_start < 0 && outbuf < outbuf_end) {
-               scale_pixel( run_weights + ((sx >> (SCALE_SHIFT - SUBSAMPLE_BITS))
-                                            & SUBSAMPLE_MASK) * (filter.n_x * filter.n_y),
-                            filter.n_x, filter.n_y,
-                            outbuf, line_bufs, sx >> SCALE_SHIFT, sw );
-               sx += x_step;
-               x_start = sx >> SCALE_SHIFT;
-               outbuf++;
+          if (drect->x < dst_clip->x1) {
+               sx = dst_clip->x1 - drect->x;
+               drect->w -= sx;
+               drect->x += sx;
           }
-
-          new_outbuf = scale_line( run_weights, filter.n_x, filter.n_y,
-                                   outbuf, outbuf_end, line_bufs,
-                                   sx >> SCALE_SHIFT, x_step, sw );
-          sx = ((outbuf_end - outbuf) >> 2) * x_step + scaled_x_offset;
-          outbuf = new_outbuf;
-
-          while (outbuf < outbuf_end) {
-               scale_pixel( run_weights + ((sx >> (SCALE_SHIFT - SUBSAMPLE_BITS))
-                                            & SUBSAMPLE_MASK) * (filter.n_x * filter.n_y),
-                            filter.n_x, filter.n_y,
-                            outbuf, line_bufs, sx >> SCALE_SHIFT, sw );
-               sx += x_step;
-               outbuf++;
+          if (drect->y < dst_clip->y1) {
+               sy = dst_clip->y1 - drect->y;
+               drect->h -= sy;
+               drect->y += sy;
           }
-
-          sy += y_step;
-
-          d[0] = LINE_PTR( dst, dst_surface->config.caps,
-                           i, dst_surface->config.size.h, dpitch ) +
-                 DFB_BYTES_PER_LINE( dst_surface->config.format, drect->x );
-
-          switch (dst_surface->config.format) {
-               case DSPF_I420:
-               case DSPF_YV12:
-                    d[1] = LINE_PTR( dst1, dst_surface->config.caps, i/2,
-                                     dst_surface->config.size.h/2, dpitch/2 ) + drect->x/2;
-                    d[2] = LINE_PTR( dst2, dst_surface->config.caps, i/2,
-                                     dst_surface->config.size.h/2, dpitch/2 ) + drect->x/2;
-                    break;
-               case DSPF_YV16:
-                    d[1] = LINE_PTR( dst1, dst_surface->config.caps, i,
-                                     dst_surface->config.size.h, dpitch/2 ) + drect->x/2;
-                    d[2] = LINE_PTR( dst2, dst_surface->config.caps, i,
-                                     dst_surface->config.size.h, dpitch/2 ) + drect->x/2;
-                    break;
-               case DSPF_NV12:
-               case DSPF_NV21:
-                    d[1] = LINE_PTR( dst1, dst_surface->config.caps, i/2,
-                                     dst_surface->config.size.h/2, dpitch ) + (drect->x&~1);
-                    break;
-               case DSPF_NV16:
-                    d[1] = LINE_PTR( dst1, dst_surface->config.caps, i,
-                                     dst_surface->config.size.h, dpitch ) + (drect->x&~1);
-                    break;
-               case DSPF_YUV444P:
-                    d[1] = LINE_PTR( dst1, dst_surface->config.caps, i,
-                                     dst_surface->config.size.h, dpitch ) + drect->x;
-                    d[2] = LINE_PTR( dst2, dst_surface->config.caps, i,
-                                     dst_surface->config.size.h, dpitch ) + drect->x;
-                    break;
-               default:
-                    break;
+          if ((drect->x + drect->w - 1) > dst_clip->x2) {
+               drect->w -= drect->x + drect->w - 1 - dst_clip->x2;
+          }
+          if ((drect->y + drect->h - 1) > dst_clip->y2) {
+               drect->h -= drect->y + drect-> h - 1 - dst_clip->y2;
           }
 
-          write_argb_span( buf, d, drect->w, drect->x, i, dst_surface, false );
+          src += sy * spitch + sx;
      }
 
-     D_FREE(filter.weights);
+     if (drect->w < 1 || drect->h < 1)
+          return;
+
+     span_init( &ctx, src, drect->w, drect->h, spitch, dst, dpitch, drect, dst_surface );
+
+     run_bands( copy_band, &ctx, drect->y, drect->y + drect->h, span_parallel( &ctx ) );
+}
+
+void dfb_copy_buffer_32( u32 *src,
+                         void  *dst, int dpitch, DFBRectangle *drect,
+                         CoreSurface *dst_surface, const DFBRegion *dst_clip )
+{
+     copy_buffer_32( src, drect->w, dst, dpitch, drect, dst_surface, dst_clip );
 }
 
+typedef struct {
+     SpanContext         span;
+     const DFBResampler *resampler;
+     int                 x1;
+     int                 x2;
+     int                 y1;          /* first destination row of the scaled image */
+} ScaleContext;
+
+static void scale_row( void *arg, int y, const u32 *row )
+{
+     const ScaleContext *ctx = arg;
+     u8                 *d[3];
+
+     span_lines( &ctx->span, ctx->y1 + y, d );
+
+     write_argb_span( (u32*) row, d, ctx->x2 - ctx->x1, ctx->span.drect->x, ctx->y1 + y, ctx->span.dst_surface, false );
+}
+
+static void scale_band( void *arg, int y1, int y2 )
+{
+     ScaleContext *ctx = arg;
+
+     dfb_resampler_run( ctx->resampler, ctx->span.src, ctx->span.spitch * 4,
+                        ctx->x1, ctx->x2, y1 - ctx->y1, y2 - ctx->y1, scale_row, ctx );
+}
+
+void dfb_scale_linear_32( u32 *src, int sw, int sh,
+                          void  *dst, int dpitch, DFBRectangle *drect,
+                          CoreSurface *dst_surface, const DFBRegion *dst_clip )
+{
+     dfb_scale_linear_32_pitch( src, sw, sh, sw * 4, dst, dpitch, drect, dst_surface, dst_clip );
+}
+
+void dfb_scale_linear_32_pitch( u32 *src, int sw, int sh, int spitch,
+                                void  *dst, int dpitch, DFBRectangle *drect,
+                                CoreSurface *dst_surface, const DFBRegion *dst_clip )
+{
+     DFBRegion     clip = { drect->x, drect->y, drect->x + drect->w - 1, drect->y + drect->h - 1 };
+     DFBResampler  resampler;
+     ScaleContext  ctx;
+
+     D_ASSERT( spitch % 4 == 0 );
+
+     if (drect->w == sw && drect->h == sh) {
+          copy_buffer_32( src, spitch / 4, dst, dpitch, drect, dst_surface, dst_clip );
+          return;
+     }
+
+     if (sw < 1 || sh < 1 || drect->w < 1 || drect->h < 1)
+          return;
+
+     if (dst_clip && !dfb_region_region_intersect( &clip, dst_clip ))
+          return;
+
+     /* The weights depend on the full destination size, clipping only selects the rows and columns produced. */
+     if (dfb_resampler_init( &resampler, dfb_config->image_scale_filter, DRSF_DST_PREMULTIPLIED,
+                             sw, sh, drect->w, drect->h ))
+          return;
+
+     ctx.resampler = &resampler;
+     ctx.x1        = clip.x1 - drect->x;
+     ctx.x2        = clip.x2 - drect->x + 1;
+     ctx.y1        = drect->y;
+
+     drect->x = clip.x1;
+     drect->y = clip.y1;
+     drect->w = clip.x2 - clip.x1 + 1;
+     drect->h = clip.y2 - clip.y1 + 1;
+
+     span_init( &ctx.span, src, sw, sh, spitch / 4, dst, dpitch, drect, dst_surface );
+
+     run_bands( scale_band, &ctx, drect->y, drect->y + drect->h, span_parallel( &ctx.span ) );
+
+     dfb_resampler_deinit( &resampler );
+}
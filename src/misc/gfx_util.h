@@ -45,5 +45,35 @@ void dfb_scale_linear_32( u32 *src, int sw, int sh,
                           void *dst, int dpitch, DFBRectangle *drect,
                           CoreSurface *dst_surface, const DFBRegion *dst_clip );
 
+/*
+ * Same as dfb_scale_linear_32() for a source with a pitch (in bytes),
+ * e.g. a sub-rectangle of a larger image.
+ */
+void dfb_scale_linear_32_pitch( u32 *src, int sw, int sh, int spitch,
+                                void *dst, int dpitch, DFBRectangle *drect,
+                                CoreSurface *dst_surface, const DFBRegion *dst_clip );
+
+/*
+ * Calls func for bands of the rows y1 to y2 (exclusive) on the band worker threads
+ * ("software-cores") and returns when all bands are done. Bands are at least 16 rows.
+ * Calls from a band function or while the workers are busy with another call run inline.
+ */
+typedef void (*DFBGfxBandFunc)( void *ctx, int y1, int y2 );
+
+void dfb_gfx_run_bands( DFBGfxBandFunc func, void *ctx, int y1, int y2 );
+
+/*
+ * Marks the calling thread as a rendering worker until the matching dfb_gfx_worker_end(), e.g. a
+ * Genefx task thread rendering a tile, or a band thread. dfb_gfx_run_bands() runs inline on workers,
+ * the band threads are only used by a single top level caller.
+ */
+void dfb_gfx_worker_begin( void );
+void dfb_gfx_worker_end  ( void );
+
+/*
+ * Stops and joins the band worker threads, they are started again by the next parallel call.
+ */
+void dfb_gfx_shutdown_bands( void );
+
 
 #endif
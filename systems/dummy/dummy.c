@@ -61,12 +61,23 @@ D_DEBUG_DOMAIN( Dummy_Display_PTS, "Dummy/Display/PTS", "DirectFB Dummy System D
 /**********************************************************************************************************************/
 /**********************************************************************************************************************/
 
-static DirectThread    *dummy_display_thread;
-static bool             dummy_display_thread_stop;
-static DirectMutex      dummy_display_lock;
-static DirectWaitQueue  dummy_display_wq;
-static DirectLink      *dummy_display_list;
-static DFB_DisplayTask *dummy_display_task;
+/*
+ * Each layer has its own display queue and thread, so a flip on one layer never completes or waits for
+ * the display task of another.
+ */
+typedef struct {
+     long                   index;
+
+     DirectThread          *thread;
+     bool                   thread_stop;
+     DirectMutex            lock;
+     DirectWaitQueue        wq;
+     DirectLink            *list;
+     DFB_DisplayTask       *task;
+} DummyLayer;
+
+static DummyLayer dummy_layers[MAX_LAYERS];
+static int        dummy_num_layers;
 
 typedef struct {
      DirectLink             link;
@@ -89,29 +100,31 @@ static void *
 dummy_display_loop( DirectThread *thread,
                     void         *ctx )
 {
-     while (!dummy_display_thread_stop) {
+     DummyLayer *dummy = ctx;
+
+     while (!dummy->thread_stop) {
           DummyDisplayBuffer *request;
 
-          direct_mutex_lock( &dummy_display_lock );
+          direct_mutex_lock( &dummy->lock );
 
-          while (!dummy_display_list) {
-               direct_waitqueue_wait( &dummy_display_wq, &dummy_display_lock );
+          while (!dummy->list) {
+               direct_waitqueue_wait( &dummy->wq, &dummy->lock );
 
-               if (dummy_display_thread_stop) {
-                    direct_mutex_unlock( &dummy_display_lock );
+               if (dummy->thread_stop) {
+                    direct_mutex_unlock( &dummy->lock );
                     goto out;
                }
           }
 
-          request = (DummyDisplayBuffer*) dummy_display_list;
+          request = (DummyDisplayBuffer*) dummy->list;
           D_MAGIC_ASSERT( request, DummyDisplayBuffer );
 
-          direct_mutex_unlock( &dummy_display_lock );
+          direct_mutex_unlock( &dummy->lock );
 
 
           long long now = direct_clock_get_time( DIRECT_CLOCK_MONOTONIC );
 
-          D_DEBUG_AT( Dummy_Display, "%s() <- request %p\n", __FUNCTION__, request );
+          D_DEBUG_AT( Dummy_Display, "%s() <- request %p (layer %ld)\n", __FUNCTION__, request, dummy->index );
           D_DEBUG_AT( Dummy_Display, "  -> surface %p\n", request->surface );
           D_DEBUG_AT( Dummy_Display, "  -> index   %d\n", request->index );
           D_DEBUG_AT( Dummy_Display, "  -> task    %p\n", request->task );
@@ -148,22 +161,22 @@ dummy_display_loop( DirectThread *thread,
           }
 
 
-          direct_mutex_lock( &dummy_display_lock );
+          direct_mutex_lock( &dummy->lock );
 
-          if (dummy_display_task) {
-               D_DEBUG_AT( Dummy_Display, "  <= done previous task %p (pts %lld, %lld to current)\n", dummy_display_task,
-                           DisplayTask_GetPTS( dummy_display_task ), request->pts - DisplayTask_GetPTS( dummy_display_task ) );
+          if (dummy->task) {
+               D_DEBUG_AT( Dummy_Display, "  <= done previous task %p (pts %lld, %lld to current)\n", dummy->task,
+                           DisplayTask_GetPTS( dummy->task ), request->pts - DisplayTask_GetPTS( dummy->task ) );
 
-               Task_Done( dummy_display_task );
+               Task_Done( dummy->task );
           }
 
-          dummy_display_task = request->task;
+          dummy->task = request->task;
 
-          direct_list_remove( &dummy_display_list, &request->link );
+          direct_list_remove( &dummy->list, &request->link );
 
-          direct_mutex_unlock( &dummy_display_lock );
+          direct_mutex_unlock( &dummy->lock );
 
-          direct_waitqueue_broadcast( &dummy_display_wq );
+          direct_waitqueue_broadcast( &dummy->wq );
 
 
           dfb_surface_buffer_unref( request->buffer );
@@ -178,8 +191,11 @@ dummy_display_loop( DirectThread *thread,
 out:
      D_DEBUG_AT( Dummy_Display, "%s() <- stop!\n", __FUNCTION__ );
 
-     if (dummy_display_task)
-          Task_Done( dummy_display_task );
+     if (dummy->task) {
+          Task_Done( dummy->task );
+
+          dummy->task = NULL;
+     }
 
      return NULL;
 }
@@ -199,33 +215,6 @@ dummyInitScreen( CoreScreen           *screen,
 
      direct_snputs( description->name, "Dummy", DFB_SCREEN_DESC_NAME_LENGTH );
 
-     dummy_display_thread = direct_thread_create( DTT_OUTPUT, dummy_display_loop, NULL, "Dummy Display" );
-
-     return DFB_OK;
-}
-
-static DFBResult
-dummyShutdownScreen( CoreScreen           *screen,
-                     void                 *driver_data,
-                     void                 *screen_data )
-{
-     D_DEBUG_AT( Dummy_Screen, "%s( %p )\n", __FUNCTION__, screen );
-
-     direct_mutex_lock( &dummy_display_lock );
-
-     dummy_display_thread_stop = true;
-
-     direct_waitqueue_signal( &dummy_display_wq );
-
-     direct_mutex_unlock( &dummy_display_lock );
-
-
-     direct_thread_join( dummy_display_thread );
-     direct_thread_destroy( dummy_display_thread );
-
-     dummy_display_thread      = NULL;
-     dummy_display_thread_stop = false;
-
      return DFB_OK;
 }
 
@@ -244,14 +233,14 @@ dummyGetScreenSize( CoreScreen *screen,
 
 static ScreenFuncs dummyScreenFuncs = {
      .InitScreen     = dummyInitScreen,
-     .ShutdownScreen = dummyShutdownScreen,
      .GetScreenSize  = dummyGetScreenSize
 };
 
 /**********************************************************************************************************************/
 
 static DFBResult
-dummyDisplayRequest( CoreSurface           *surface,
+dummyDisplayRequest( DummyLayer            *dummy,
+                     CoreSurface           *surface,
                      CoreSurfaceBufferLock *lock )
 {
      DFBResult           ret;
@@ -302,13 +291,13 @@ dummyDisplayRequest( CoreSurface           *surface,
      D_DEBUG_AT( Dummy_Display, "  -> index %d\n", request->index );
      D_DEBUG_AT( Dummy_Display, "  -> pts   %lld\n", request->pts );
 
-     direct_mutex_lock( &dummy_display_lock );
+     direct_mutex_lock( &dummy->lock );
 
-     direct_list_append( &dummy_display_list, &request->link );
+     direct_list_append( &dummy->list, &request->link );
 
-     direct_waitqueue_signal( &dummy_display_wq );
+     direct_waitqueue_signal( &dummy->wq );
 
-     direct_mutex_unlock( &dummy_display_lock );
+     direct_mutex_unlock( &dummy->lock );
 
      return DFB_OK;
 }
@@ -323,12 +312,23 @@ dummyInitLayer( CoreLayer                  *layer,
                 DFBDisplayLayerConfig      *config,
                 DFBColorAdjustment         *adjustment )
 {
+     DummyLayer *dummy = driver_data;
+     long        index = dummy->index;
+
      description->type             = DLTF_GRAPHICS;
      description->caps             = DLCAPS_SURFACE;
      description->surface_caps     = DSCAPS_SYSTEMONLY;
      description->surface_accessor = CSAID_CPU;
 
-     direct_snputs( description->name, "Dummy", DFB_DISPLAY_LAYER_DESC_NAME_LENGTH );
+     if (index) {
+          /* Additional layers (option 'dummy-layers') can be placed and scaled anywhere. */
+          description->type |= DLTF_VIDEO;
+          description->caps |= DLCAPS_SCREEN_LOCATION;
+
+          snprintf( description->name, DFB_DISPLAY_LAYER_DESC_NAME_LENGTH, "Dummy Overlay %ld", index );
+     }
+     else
+          direct_snputs( description->name, "Dummy", DFB_DISPLAY_LAYER_DESC_NAME_LENGTH );
 
 
      config->flags       = DLCONF_WIDTH | DLCONF_HEIGHT | DLCONF_PIXELFORMAT | DLCONF_BUFFERMODE;
@@ -337,6 +337,38 @@ dummyInitLayer( CoreLayer                  *layer,
      config->pixelformat = dfb_config->mode.format ?: DUMMY_FORMAT;
      config->buffermode  = DLBM_FRONTONLY;
 
+     dummy->thread = direct_thread_create( DTT_OUTPUT, dummy_display_loop, dummy, "Dummy Display" );
+
+     return DFB_OK;
+}
+
+static DFBResult
+dummyShutdownLayer( CoreLayer *layer,
+                    void      *driver_data,
+                    void      *layer_data )
+{
+     DummyLayer *dummy = driver_data;
+
+     D_DEBUG_AT( Dummy_Layer, "%s( %p ) <- layer %ld\n", __FUNCTION__, layer, dummy->index );
+
+     if (!dummy->thread)
+          return DFB_OK;
+
+     direct_mutex_lock( &dummy->lock );
+
+     dummy->thread_stop = true;
+
+     direct_waitqueue_signal( &dummy->wq );
+
+     direct_mutex_unlock( &dummy->lock );
+
+
+     direct_thread_join( dummy->thread );
+     direct_thread_destroy( dummy->thread );
+
+     dummy->thread      = NULL;
+     dummy->thread_stop = false;
+
      return DFB_OK;
 }
 
@@ -374,18 +406,20 @@ dummyRemoveRegion( CoreLayer *layer,
                    void      *layer_data,
                    void      *region_data )
 {
-     direct_mutex_lock( &dummy_display_lock );
+     DummyLayer *dummy = driver_data;
+
+     direct_mutex_lock( &dummy->lock );
 
-     while (dummy_display_list)
-          direct_waitqueue_wait( &dummy_display_wq, &dummy_display_lock );
+     while (dummy->list)
+          direct_waitqueue_wait( &dummy->wq, &dummy->lock );
 
-     if (dummy_display_task) {
-          Task_Done( dummy_display_task );
+     if (dummy->task) {
+          Task_Done( dummy->task );
 
-          dummy_display_task = NULL;
+          dummy->task = NULL;
      }
 
-     direct_mutex_unlock( &dummy_display_lock );
+     direct_mutex_unlock( &dummy->lock );
 
      return DFB_OK;
 }
@@ -404,7 +438,7 @@ dummyFlipRegion( CoreLayer             *layer,
 {
      dfb_surface_flip( surface, false );
 
-     return dummyDisplayRequest( surface, left_lock );
+     return dummyDisplayRequest( driver_data, surface, left_lock );
 }
 
 static DFBResult
@@ -418,11 +452,12 @@ dummyUpdateRegion( CoreLayer             *layer,
                    const DFBRegion       *right_update,
                    CoreSurfaceBufferLock *right_lock )
 {
-     return dummyDisplayRequest( surface, left_lock );
+     return dummyDisplayRequest( driver_data, surface, left_lock );
 }
 
 static DisplayLayerFuncs dummyLayerFuncs = {
      .InitLayer     = dummyInitLayer,
+     .ShutdownLayer = dummyShutdownLayer,
      .TestRegion    = dummyTestRegion,
      .SetRegion     = dummySetRegion,
      .RemoveRegion  = dummyRemoveRegion,
@@ -445,16 +480,51 @@ system_get_info( CoreSystemInfo *info )
      direct_snputs( info->name, "Dummy", DFB_CORE_SYSTEM_INFO_NAME_LENGTH );
 }
 
+static void
+register_layers( CoreScreen *screen )
+{
+     long i;
+     long num = direct_config_get_int_value_with_default( "dummy-layers", 1 );
+
+     if (num < 1 || num > MAX_LAYERS) {
+          D_WARN( "dummy-layers=%ld out of range, using %ld", num, num < 1 ? 1L : (long) MAX_LAYERS );
+
+          num = num < 1 ? 1 : MAX_LAYERS;
+     }
+
+     dummy_num_layers = num;
+
+     for (i=0; i<num; i++) {
+          DummyLayer *dummy = &dummy_layers[i];
+
+          dummy->index = i;
+
+          direct_mutex_init( &dummy->lock );
+          direct_waitqueue_init( &dummy->wq );
+
+          dfb_layers_register( screen, dummy, &dummyLayerFuncs );
+     }
+}
+
+static void
+unregister_layers( void )
+{
+     int i;
+
+     for (i=0; i<dummy_num_layers; i++) {
+          direct_mutex_deinit( &dummy_layers[i].lock );
+          direct_waitqueue_deinit( &dummy_layers[i].wq );
+     }
+
+     dummy_num_layers = 0;
+}
+
 static DFBResult
 system_initialize( CoreDFB *core, void **ret_data )
 {
      CoreScreen *screen = dfb_screens_register( NULL, NULL, &dummyScreenFuncs );
-     CoreLayer  *layer  = dfb_layers_register( screen, NULL, &dummyLayerFuncs );
 
-     (void) layer;
-
-     direct_mutex_init( &dummy_display_lock );
-     direct_waitqueue_init( &dummy_display_wq );
+     register_layers( screen );
 
      return DFB_OK;
 }
@@ -463,9 +533,8 @@ static DFBResult
 system_join( CoreDFB *core, void **ret_data )
 {
      CoreScreen *screen = dfb_screens_register( NULL, NULL, &dummyScreenFuncs );
-     CoreLayer  *layer  = dfb_layers_register( screen, NULL, &dummyLayerFuncs );
 
-     (void) layer;
+     register_layers( screen );
 
      return DFB_OK;
 }
@@ -473,8 +542,7 @@ system_join( CoreDFB *core, void **ret_data )
 static DFBResult
 system_shutdown( bool emergency )
 {
-     direct_mutex_deinit( &dummy_display_lock );
-     direct_waitqueue_deinit( &dummy_display_wq );
+     unregister_layers();
 
      return DFB_OK;
 }
@@ -482,6 +550,8 @@ system_shutdown( bool emergency )
 static DFBResult
 system_leave( bool emergency )
 {
+     unregister_layers();
+
      return DFB_OK;
 }
 
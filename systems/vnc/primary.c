@@ -173,6 +173,12 @@ primaryInitScreen( CoreScreen           *screen,
      vnc->rfb_screen->serverFormat.greenMax   = 255;
      vnc->rfb_screen->serverFormat.blueMax    = 255;
 
+     /* Without change detection every updated region is sent. */
+     ret = vnc_tiles_init( &vnc->tiles, vnc->buffer_lock.addr, vnc->buffer_lock.pitch,
+                           shared->screen_size.w, shared->screen_size.h );
+     if (ret)
+          D_DERROR( ret, "DirectFB/VNC: Could not initialize tile change detection!\n" );
+
      rfbRunEventLoop( vnc->rfb_screen, -1, TRUE );
 
      return DFB_OK;
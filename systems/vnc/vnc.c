@@ -153,6 +153,9 @@ system_shutdown( bool emergency )
 
      fusion_call_destroy( &dfb_vnc->shared->call );
 
+     if (dfb_vnc->tiles.hashes)
+          vnc_tiles_deinit( &dfb_vnc->tiles );
+
      SHFREE( dfb_core_shmpool(dfb_vnc->core), dfb_vnc->shared );
 
      D_FREE( dfb_vnc );
@@ -302,11 +305,24 @@ system_surface_data_destroy( CoreSurface *surface, void *data )
 
 /**********************************************************************************************************************/
 
+static void
+mark_tiles( void            *ctx,
+            const DFBRegion *region )
+{
+     DFBVNC *vnc = ctx;
+
+     rfbMarkRectAsModified( vnc->rfb_screen, region->x1, region->y1, region->x2 + 1, region->y2 + 1 );
+}
+
 static int
 VNC_Dispatch_MarkRectAsModified( DFBVNC                   *vnc,
                                  DFBVNCMarkRectAsModified *mark )
 {
-     rfbMarkRectAsModified( vnc->rfb_screen, mark->region.x1, mark->region.y1, mark->region.x2 + 1, mark->region.y2 + 1 );
+     /* Only mark tiles whose contents actually changed. */
+     if (vnc->tiles.hashes)
+          vnc_tiles_update( &vnc->tiles, vnc->buffer_lock.addr, vnc->buffer_lock.pitch, &mark->region, mark_tiles, vnc );
+     else
+          rfbMarkRectAsModified( vnc->rfb_screen, mark->region.x1, mark->region.y1, mark->region.x2 + 1, mark->region.y2 + 1 );
 
      return 0;
 }
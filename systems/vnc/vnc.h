@@ -43,6 +43,8 @@
 #include <core/layers.h>
 #include <core/screens.h>
 
+#include "vnctiles.h"
+
 #define VNC_MAX_LAYERS 2
 
 typedef struct {
@@ -77,6 +79,8 @@ typedef struct {
      unsigned int        layer_count;
 
      CoreSurfaceBufferLock  buffer_lock;
+
+     VNCTiles            tiles;
 } DFBVNC;
 
 typedef enum {
@@ -0,0 +1,270 @@
+/*
+   (c) Copyright 2012-2013  DirectFB integrated media GmbH
+   (c) Copyright 2001-2013  The world wide DirectFB Open Source Community (directfb.org)
+   (c) Copyright 2000-2004  Convergence (integrated media) GmbH
+
+   All rights reserved.
+
+   Written by Denis Oliver Kropp <dok@directfb.org>,
+              Andreas Shimokawa <andi@directfb.org>,
+              Marek Pikarski <mass@directfb.org>,
+              Sven Neumann <neo@directfb.org>,
+              Ville Syrjälä <syrjala@sci.fi> and
+              Claudio Ciccani <klan@users.sf.net>.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+#include <config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <directfb.h>
+#include <directfb_util.h>
+
+#include <direct/util.h>
+
+#include "vnctiles.h"
+
+/*
+ * Plays a recorded stream of screen updates against the tile change detector.
+ *
+ * Each line of a stream file is "<x> <y> <w> <h> [<percent>]", where percent is the part
+ * of the rectangle's rows whose pixels really change (default 100, use 0 for a redundant
+ * repaint). Without a file a built-in kiosk like stream is played. Use "--dfb:software-cores=<n>"
+ * to hash large updates in parallel.
+ */
+
+/*****************************************************************************/
+
+typedef struct {
+     DFBRectangle rect;
+     int          percent;
+} Update;
+
+static int            width   = 1280;
+static int            height  = 720;
+static int            seconds = 3;
+static const char    *stream;
+
+static Update        *updates;
+static int            num_updates;
+
+/* blinking cursor, clock, ticker and a redundant full screen repaint */
+static const Update builtin[] = {
+     { {  100,  100,    2,   16 }, 100 },
+     { { 1100,   10,  120,   24 }, 100 },
+     { {    0,  680, 1280,   40 }, 100 },
+     { {  100,  100,    2,   16 }, 100 },
+     { {    0,    0, 1280,  720 },   0 },
+     { {  100,  100,    2,   16 }, 100 },
+     { {  200,  200,  400,  300 },  10 }
+};
+
+/*****************************************************************************/
+
+static inline long long
+microsec( void )
+{
+     struct timeval tv;
+
+     gettimeofday( &tv, NULL );
+
+     return (long long) tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+static void
+load_stream( const char *filename )
+{
+     FILE *fp;
+     char  line[256];
+     int   size = 0;
+
+     fp = fopen( filename, "r" );
+     if (!fp) {
+          perror( filename );
+          exit( EXIT_FAILURE );
+     }
+
+     while (fgets( line, sizeof(line), fp )) {
+          Update update = { .percent = 100 };
+
+          if (line[0] == '#' ||
+              sscanf( line, "%d %d %d %d %d", &update.rect.x, &update.rect.y,
+                      &update.rect.w, &update.rect.h, &update.percent ) < 4)
+               continue;
+
+          if (num_updates == size) {
+               size    = size ? size * 2 : 256;
+               updates = realloc( updates, size * sizeof(Update) );
+               if (!updates) {
+                    fprintf( stderr, "Out of memory!\n" );
+                    exit( EXIT_FAILURE );
+               }
+          }
+
+          updates[num_updates++] = update;
+     }
+
+     fclose( fp );
+
+     if (!num_updates) {
+          fprintf( stderr, "No updates in '%s'!\n", filename );
+          exit( EXIT_FAILURE );
+     }
+}
+
+/* Redraws the update, changing the pixels of the given part of its rows. */
+static void
+draw_update( u32 *fb, const Update *update, unsigned int frame )
+{
+     DFBRegion clip = DFB_REGION_INIT_FROM_RECTANGLE( &update->rect );
+     int       x, y;
+
+     if (!dfb_region_intersect( &clip, 0, 0, width - 1, height - 1 ))
+          return;
+
+     for (y = clip.y1; y <= clip.y1 + (clip.y2 - clip.y1 + 1) * update->percent / 100 - 1; y++) {
+          for (x = clip.x1; x <= clip.x2; x++)
+               fb[y * width + x] = 0xff000000 | (frame * 0x010203) | (x ^ y);
+     }
+}
+
+static void
+count_marked( void *ctx, const DFBRegion *region )
+{
+     long long *pixels = ctx;
+
+     *pixels += (long long) (region->x2 - region->x1 + 1) * (region->y2 - region->y1 + 1);
+}
+
+/*****************************************************************************/
+
+static void
+usage( void )
+{
+     fprintf( stderr, "Usage: vnc_tiles_bench [options] [stream]\n\n" );
+     fprintf( stderr, "Options:\n" );
+     fprintf( stderr, "  -h, --help                   Show this help\n" );
+     fprintf( stderr, "  -s, --size <width>x<height>  Set screen size\n" );
+     fprintf( stderr, "  -T, --time <seconds>         Duration of the test\n" );
+     fprintf( stderr, "\n" );
+     exit( EXIT_FAILURE );
+}
+
+static void
+parse_options( int argc, char **argv )
+{
+     int i;
+
+     for (i = 1; i < argc; i++) {
+          char *opt = argv[i];
+          char *arg = argv[i+1];
+
+          if (!strcmp( opt, "-h" ) || !strcmp( opt, "--help" )) {
+               usage();
+          }
+          else if (!strcmp( opt, "-s" ) || !strcmp( opt, "--size" )) {
+               if (!arg || sscanf( arg, "%dx%d", &width, &height ) != 2 || width < 1 || height < 1)
+                    usage();
+               i++;
+          }
+          else if (!strcmp( opt, "-T" ) || !strcmp( opt, "--time" )) {
+               if (!arg || (seconds = atoi( arg )) < 1)
+                    usage();
+               i++;
+          }
+          else if (opt[0] != '-' && !stream)
+               stream = opt;
+          else
+               usage();
+     }
+}
+
+/*****************************************************************************/
+
+int
+main( int argc, char **argv )
+{
+     DFBResult     ret;
+     VNCTiles      tiles;
+     u32          *fb;
+     unsigned int  frame   = 0;
+     long long     time    = 0;
+     long long     updated = 0;
+     long long     marked  = 0;
+     long long     start;
+
+     /* Only needed for the configuration, e.g. "--dfb:software-cores=4". */
+     ret = DirectFBInit( &argc, &argv );
+     if (ret)
+          DirectFBErrorFatal( "DirectFBInit()", ret );
+
+     parse_options( argc, argv );
+
+     if (stream)
+          load_stream( stream );
+     else {
+          updates     = (Update*) builtin;
+          num_updates = D_ARRAY_SIZE( builtin );
+     }
+
+     fb = calloc( width * height, 4 );
+     if (!fb) {
+          fprintf( stderr, "Out of memory!\n" );
+          return EXIT_FAILURE;
+     }
+
+     ret = vnc_tiles_init( &tiles, fb, width * 4, width, height );
+     if (ret)
+          DirectFBErrorFatal( "vnc_tiles_init()", ret );
+
+     printf( "** Playing %d updates on %dx%d for %d seconds **\n\n", num_updates, width, height, seconds );
+
+     start = microsec();
+
+     do {
+          const Update *update = &updates[frame % num_updates];
+          DFBRegion     region = DFB_REGION_INIT_FROM_RECTANGLE( &update->rect );
+          long long     t;
+
+          draw_update( fb, update, frame++ );
+
+          t = microsec();
+
+          vnc_tiles_update( &tiles, fb, width * 4, &region, count_marked, &marked );
+
+          time += microsec() - t;
+
+          if (dfb_region_intersect( &region, 0, 0, width - 1, height - 1 ))
+               updated += (long long) (region.x2 - region.x1 + 1) * (region.y2 - region.y1 + 1);
+     } while (microsec() < start + seconds * 1000000LL);
+
+     printf( "  Updates         %10u\n", frame );
+     printf( "  Time per update %10.3f us\n", (double) time / frame );
+     printf( "  Hashing         %10.3f MPixel/s\n", (double) updated / (time ? time : 1) );
+     printf( "  Updated pixels  %10lld\n", updated );
+     printf( "  Marked pixels   %10lld (%.1f%%)\n", marked, updated ? marked * 100.0 / updated : 0.0 );
+
+     vnc_tiles_deinit( &tiles );
+
+     free( fb );
+
+     return EXIT_SUCCESS;
+}
@@ -0,0 +1,261 @@
+/*
+   (c) Copyright 2012-2013  DirectFB integrated media GmbH
+   (c) Copyright 2001-2013  The world wide DirectFB Open Source Community (directfb.org)
+   (c) Copyright 2000-2004  Convergence (integrated media) GmbH
+
+   All rights reserved.
+
+   Written by Denis Oliver Kropp <dok@directfb.org>,
+              Andreas Shimokawa <andi@directfb.org>,
+              Marek Pikarski <mass@directfb.org>,
+              Sven Neumann <neo@directfb.org>,
+              Ville Syrjälä <syrjala@sci.fi> and
+              Claudio Ciccani <klan@users.sf.net>.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+
+
+#include <config.h>
+
+#include <string.h>
+
+#include <directfb.h>
+#include <directfb_util.h>
+
+#include <direct/debug.h>
+#include <direct/mem.h>
+#include <direct/messages.h>
+#include <direct/util.h>
+
+#include <misc/gfx_util.h>
+
+#include "vnctiles.h"
+
+
+D_DEBUG_DOMAIN( VNC_Tiles, "VNC/Tiles", "VNC Tile Change Detection" );
+
+/**********************************************************************************************************************/
+
+#define HASH_MUL   0x9e3779b97f4a7c15ULL
+
+static inline u64
+hash_step( u64 h, u64 v )
+{
+     return (((h << 5) | (h >> 59)) ^ v) * HASH_MUL;
+}
+
+/*
+ * Hashes a tile four pixels (16 bytes) at a time, two per lane in two independent lanes.
+ */
+static u64
+hash_tile( const u8 *addr,
+           int       pitch,
+           int       width,
+           int       height )
+{
+     u64 h0 = 0xcbf29ce484222325ULL;
+     u64 h1 = 0x84222325cbf29ce4ULL;
+     int x, y;
+
+     for (y = 0; y < height; y++) {
+          const u8 *p = addr + y * pitch;
+          u64       a, b;
+
+          for (x = 0; x < width - 3; x += 4) {
+               memcpy( &a, p,     8 );
+               memcpy( &b, p + 8, 8 );
+
+               h0 = hash_step( h0, a );
+               h1 = hash_step( h1, b );
+
+               p += 16;
+          }
+
+          for (; x < width; x++) {
+               u32 c;
+
+               memcpy( &c, p, 4 );
+
+               h0 = hash_step( h0, c );
+
+               p += 4;
+          }
+     }
+
+     h0 ^= (h1 << 32) | (h1 >> 32);
+
+     /* final avalanche */
+     h0 ^= h0 >> 33;
+     h0 *= 0xff51afd7ed558ccdULL;
+     h0 ^= h0 >> 33;
+
+     return h0;
+}
+
+static void
+hash_band( void *ctx, int y1, int y2 )
+{
+     VNCTiles *tiles = ctx;
+     int       r, c;
+
+     /* Process the tile rows starting within the band. */
+     for (r = (y1 + VNC_TILE_HEIGHT - 1) / VNC_TILE_HEIGHT; r * VNC_TILE_HEIGHT < y2; r++) {
+          int ty = r * VNC_TILE_HEIGHT;
+          int th = MIN( VNC_TILE_HEIGHT, tiles->height - ty );
+
+          for (c = tiles->x1; c <= tiles->x2; c++) {
+               int tx   = c * VNC_TILE_WIDTH;
+               int tw   = MIN( VNC_TILE_WIDTH, tiles->width - tx );
+               u64 hash = hash_tile( tiles->addr + ty * tiles->pitch + tx * 4, tiles->pitch, tw, th );
+
+               if (tiles->hashes[r * tiles->cols + c] != hash) {
+                    tiles->hashes[r * tiles->cols + c]  = hash;
+                    tiles->changed[r * tiles->cols + c] = 1;
+               }
+          }
+     }
+}
+
+static void
+hash_region( VNCTiles   *tiles,
+             const void *addr,
+             int         pitch,
+             int         c1,
+             int         r1,
+             int         c2,
+             int         r2 )
+{
+     tiles->addr  = addr;
+     tiles->pitch = pitch;
+     tiles->x1    = c1;
+     tiles->x2    = c2;
+
+     dfb_gfx_run_bands( hash_band, tiles, r1 * VNC_TILE_HEIGHT, MIN( (r2 + 1) * VNC_TILE_HEIGHT, tiles->height ) );
+
+     tiles->addr = NULL;
+}
+
+/**********************************************************************************************************************/
+
+DFBResult
+vnc_tiles_init( VNCTiles   *tiles,
+                const void *addr,
+                int         pitch,
+                int         width,
+                int         height )
+{
+     D_DEBUG_AT( VNC_Tiles, "%s( %p, %d, %dx%d )\n", __FUNCTION__, addr, pitch, width, height );
+
+     D_ASSERT( tiles != NULL );
+     D_ASSERT( addr != NULL );
+     D_ASSERT( width > 0 );
+     D_ASSERT( height > 0 );
+
+     memset( tiles, 0, sizeof(VNCTiles) );
+
+     tiles->width  = width;
+     tiles->height = height;
+     tiles->cols   = (width  + VNC_TILE_WIDTH  - 1) / VNC_TILE_WIDTH;
+     tiles->rows   = (height + VNC_TILE_HEIGHT - 1) / VNC_TILE_HEIGHT;
+
+     tiles->hashes  = D_CALLOC( tiles->cols * tiles->rows, sizeof(u64) );
+     tiles->changed = D_CALLOC( tiles->cols * tiles->rows, sizeof(u8) );
+
+     if (!tiles->hashes || !tiles->changed) {
+          vnc_tiles_deinit( tiles );
+          return D_OOM();
+     }
+
+     hash_region( tiles, addr, pitch, 0, 0, tiles->cols - 1, tiles->rows - 1 );
+
+     memset( tiles->changed, 0, tiles->cols * tiles->rows );
+
+     return DFB_OK;
+}
+
+void
+vnc_tiles_deinit( VNCTiles *tiles )
+{
+     D_ASSERT( tiles != NULL );
+
+     if (tiles->hashes)
+          D_FREE( tiles->hashes );
+
+     if (tiles->changed)
+          D_FREE( tiles->changed );
+
+     memset( tiles, 0, sizeof(VNCTiles) );
+}
+
+unsigned int
+vnc_tiles_update( VNCTiles         *tiles,
+                  const void       *addr,
+                  int               pitch,
+                  const DFBRegion  *region,
+                  VNCTilesMarkFunc  mark,
+                  void             *ctx )
+{
+     DFBRegion    clip;
+     int          c1, r1, c2, r2, r, c;
+     unsigned int count = 0;
+
+     D_ASSERT( tiles != NULL );
+     D_ASSERT( tiles->hashes != NULL );
+     DFB_REGION_ASSERT( region );
+     D_ASSERT( mark != NULL );
+
+     D_DEBUG_AT( VNC_Tiles, "%s( %4d,%4d-%4dx%4d )\n", __FUNCTION__, DFB_RECTANGLE_VALS_FROM_REGION( region ) );
+
+     clip = *region;
+
+     if (!dfb_region_intersect( &clip, 0, 0, tiles->width - 1, tiles->height - 1 ))
+          return 0;
+
+     c1 = clip.x1 / VNC_TILE_WIDTH;
+     r1 = clip.y1 / VNC_TILE_HEIGHT;
+     c2 = clip.x2 / VNC_TILE_WIDTH;
+     r2 = clip.y2 / VNC_TILE_HEIGHT;
+
+     hash_region( tiles, addr, pitch, c1, r1, c2, r2 );
+
+     for (r = r1; r <= r2; r++) {
+          u8 *changed = tiles->changed + r * tiles->cols;
+
+          for (c = c1; c <= c2; c++) {
+               DFBRegion run;
+
+               if (!changed[c])
+                    continue;
+
+               run.x1 = c * VNC_TILE_WIDTH;
+               run.y1 = r * VNC_TILE_HEIGHT;
+               run.y2 = MIN( (r + 1) * VNC_TILE_HEIGHT, tiles->height ) - 1;
+
+               for (; c <= c2 && changed[c]; c++, count++)
+                    changed[c] = 0;
+
+               run.x2 = MIN( c * VNC_TILE_WIDTH, tiles->width ) - 1;
+
+               D_DEBUG_AT( VNC_Tiles, "  -> changed %4d,%4d-%4dx%4d\n", DFB_RECTANGLE_VALS_FROM_REGION( &run ) );
+
+               mark( ctx, &run );
+          }
+     }
+
+     return count;
+}
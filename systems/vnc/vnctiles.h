@@ -0,0 +1,90 @@
+/*
+   (c) Copyright 2012-2013  DirectFB integrated media GmbH
+   (c) Copyright 2001-2013  The world wide DirectFB Open Source Community (directfb.org)
+   (c) Copyright 2000-2004  Convergence (integrated media) GmbH
+
+   All rights reserved.
+
+   Written by Denis Oliver Kropp <dok@directfb.org>,
+              Andreas Shimokawa <andi@directfb.org>,
+              Marek Pikarski <mass@directfb.org>,
+              Sven Neumann <neo@directfb.org>,
+              Ville Syrjälä <syrjala@sci.fi> and
+              Claudio Ciccani <klan@users.sf.net>.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+
+
+#ifndef __VNC__VNCTILES_H__
+#define __VNC__VNCTILES_H__
+
+#include <directfb.h>
+
+/*
+ * Change detection for the RFB framebuffer
+ *
+ * The framebuffer is divided into tiles with a 64 bit hash each. After the screen has
+ * been updated, only tiles within the updated region whose hash changed are reported,
+ * so redundant repaints are not encoded and sent to the clients again.
+ */
+
+#define VNC_TILE_WIDTH   32
+#define VNC_TILE_HEIGHT  32
+
+typedef struct {
+     int           width;
+     int           height;
+
+     int           cols;
+     int           rows;
+
+     u64          *hashes;
+     u8           *changed;
+
+     const u8     *addr;        /* set during vnc_tiles_update() */
+     int           pitch;
+     int           x1;          /* tile columns being updated */
+     int           x2;
+} VNCTiles;
+
+typedef void (*VNCTilesMarkFunc)( void            *ctx,
+                                  const DFBRegion *region );
+
+/*
+ * Hashes the initial contents of the ARGB/RGB32 framebuffer.
+ */
+DFBResult    vnc_tiles_init  ( VNCTiles         *tiles,
+                               const void       *addr,
+                               int               pitch,
+                               int               width,
+                               int               height );
+
+void         vnc_tiles_deinit( VNCTiles         *tiles );
+
+/*
+ * Rehashes the tiles intersecting 'region' and calls 'mark' for each horizontal run
+ * of changed tiles (clipped to the framebuffer). Returns the number of changed tiles.
+ */
+unsigned int vnc_tiles_update( VNCTiles         *tiles,
+                               const void       *addr,
+                               int               pitch,
+                               const DFBRegion  *region,
+                               VNCTilesMarkFunc  mark,
+                               void             *ctx );
+
+#endif
@@ -0,0 +1,283 @@
+/*
+   (c) Copyright 2012-2013  DirectFB integrated media GmbH
+   (c) Copyright 2001-2013  The world wide DirectFB Open Source Community (directfb.org)
+   (c) Copyright 2000-2004  Convergence (integrated media) GmbH
+
+   All rights reserved.
+
+   Written by Denis Oliver Kropp <dok@directfb.org>,
+              Andreas Shimokawa <andi@directfb.org>,
+              Marek Pikarski <mass@directfb.org>,
+              Sven Neumann <neo@directfb.org>,
+              Ville Syrjälä <syrjala@sci.fi> and
+              Claudio Ciccani <klan@users.sf.net>.
+
+   This file is subject to the terms and conditions of the MIT License:
+
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify, merge,
+   publish, distribute, sublicense, and/or sell copies of the Software,
+   and to permit persons to whom the Software is furnished to do so,
+   subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be
+   included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+   MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+   IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+   CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+   TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+   SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <config.h>
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <direct/messages.h>
+#include <direct/util.h>
+
+#include <directfb.h>
+
+#include <dfiff.h>
+
+/**********************************************************************************************************************/
+
+#define WIDTH   16
+#define HEIGHT  16
+#define PITCH   (WIDTH * 4)
+
+/*
+ * A version 2 file with one uncompressed ARGB level in one tile, the pixel data at DFIFF_DATA_ALIGN.
+ */
+typedef struct {
+     DFIFFHeader    header;
+     DFIFFExtension ext;
+     DFIFFLevel     level;
+     DFIFFTile      tile;
+     u8             pad[DFIFF_DATA_ALIGN - sizeof(DFIFFHeader) - sizeof(DFIFFExtension) -
+                        sizeof(DFIFFLevel) - sizeof(DFIFFTile)];
+     u8             pixels[HEIGHT * PITCH];
+} TestFile;
+
+static void
+build_file( TestFile *file )
+{
+     memset( file, 0x55, sizeof(TestFile) );
+
+     memcpy( file->header.magic, "DFIFF", 5 );
+
+     file->header.major  = DFIFF_MAJOR_V2;
+     file->header.minor  = 0;
+     file->header.flags  = DFIFF_FLAG_LITTLE_ENDIAN;
+     file->header.width  = WIDTH;
+     file->header.height = HEIGHT;
+     file->header.format = DSPF_ARGB;
+     file->header.pitch  = PITCH;
+
+     file->ext.compression = DFIFF_COMPRESSION_NONE;
+     file->ext.tile_height = HEIGHT;
+     file->ext.num_levels  = 1;
+     file->ext.num_tiles   = 1;
+
+     file->level.width      = WIDTH;
+     file->level.height     = HEIGHT;
+     file->level.pitch      = PITCH;
+     file->level.first_tile = 0;
+
+     file->tile.offset = offsetof( TestFile, pixels );
+     file->tile.size   = HEIGHT * PITCH;
+}
+
+/*
+ * Loads the data and renders it, returns DFB_OK only if both succeed.
+ */
+static DFBResult
+load_and_render( IDirectFB        *dfb,
+                 IDirectFBSurface *surface,
+                 const void       *ptr,
+                 unsigned int      len )
+{
+     DFBResult                 ret;
+     DFBDataBufferDescription  ddsc;
+     IDirectFBDataBuffer      *buffer;
+     IDirectFBImageProvider   *provider;
+
+     ddsc.flags         = DBDESC_MEMORY;
+     ddsc.memory.data   = ptr;
+     ddsc.memory.length = len;
+
+     ret = dfb->CreateDataBuffer( dfb, &ddsc, &buffer );
+     if (ret) {
+          D_DERROR( ret, "DFBTest/DFIFF: IDirectFB::CreateDataBuffer() failed!\n" );
+          return ret;
+     }
+
+     ret = buffer->CreateImageProvider( buffer, &provider );
+     if (ret == DFB_OK) {
+          ret = provider->RenderTo( provider, surface, NULL );
+
+          provider->Release( provider );
+     }
+
+     buffer->Release( buffer );
+
+     return ret;
+}
+
+typedef struct {
+     const char   *name;
+     void        (*corrupt)( TestFile *file, unsigned int *len );
+} Corruption;
+
+static void
+corrupt_truncated( TestFile *file, unsigned int *len )
+{
+     *len -= PITCH;
+}
+
+static void
+corrupt_pitch_overflow( TestFile *file, unsigned int *len )
+{
+     /* height * pitch wraps around to a small value in 32 bits */
+     file->level.height = 0x10000;
+     file->level.pitch  = 0x10000;
+}
+
+static void
+corrupt_pitch_huge( TestFile *file, unsigned int *len )
+{
+     file->level.pitch = 0xffffffff;
+}
+
+static void
+corrupt_tile_offset( TestFile *file, unsigned int *len )
+{
+     file->tile.offset = 0xfffffff0;
+}
+
+static void
+corrupt_tile_size( TestFile *file, unsigned int *len )
+{
+     /* The stored size fits, but the level extent does not. */
+     file->tile.size    = PITCH;
+     file->level.height = HEIGHT * 2;
+}
+
+static void
+corrupt_first_tile( TestFile *file, unsigned int *len )
+{
+     file->level.first_tile = 0xffffffff;
+}
+
+static void
+corrupt_num_levels( TestFile *file, unsigned int *len )
+{
+     file->ext.num_levels = 0x40000000;
+}
+
+static void
+corrupt_format( TestFile *file, unsigned int *len )
+{
+     file->header.format = 0xffffffff;
+}
+
+static void
+corrupt_v0_pitch( TestFile *file, unsigned int *len )
+{
+     file->header.major  = 0;
+     file->header.height = 0x10000;
+     file->header.pitch  = 0x10000;
+}
+
+static const Corruption corruptions[] = {
+     { "truncated",      corrupt_truncated },
+     { "pitch overflow", corrupt_pitch_overflow },
+     { "pitch huge",     corrupt_pitch_huge },
+     { "tile offset",    corrupt_tile_offset },
+     { "tile size",      corrupt_tile_size },
+     { "first tile",     corrupt_first_tile },
+     { "num levels",     corrupt_num_levels },
+     { "format",         corrupt_format },
+     { "v0 pitch",       corrupt_v0_pitch },
+};
+
+/**********************************************************************************************************************/
+
+int
+main( int argc, char *argv[] )
+{
+     DFBResult              ret;
+     int                    i;
+     unsigned int           len;
+     int                    failed = 0;
+     IDirectFB             *dfb;
+     IDirectFBSurface      *surface;
+     DFBSurfaceDescription  desc;
+     TestFile               file;
+
+     /* Initialize DirectFB. */
+     ret = DirectFBInit( &argc, &argv );
+     if (ret) {
+          D_DERROR( ret, "DFBTest/DFIFF: DirectFBInit() failed!\n" );
+          return ret;
+     }
+
+     /* Create super interface. */
+     ret = DirectFBCreate( &dfb );
+     if (ret) {
+          D_DERROR( ret, "DFBTest/DFIFF: DirectFBCreate() failed!\n" );
+          return ret;
+     }
+
+     desc.flags       = DSDESC_WIDTH | DSDESC_HEIGHT | DSDESC_PIXELFORMAT;
+     desc.width       = WIDTH;
+     desc.height      = HEIGHT;
+     desc.pixelformat = DSPF_ARGB;
+
+     ret = dfb->CreateSurface( dfb, &desc, &surface );
+     if (ret) {
+          D_DERROR( ret, "DFBTest/DFIFF: IDirectFB::CreateSurface() failed!\n" );
+          dfb->Release( dfb );
+          return ret;
+     }
+
+     /* The intact file must load. */
+     build_file( &file );
+
+     ret = load_and_render( dfb, surface, &file, sizeof(file) );
+     if (ret) {
+          D_DERROR( ret, "DFBTest/DFIFF: Valid file was rejected!\n" );
+          failed++;
+     }
+
+     /* Every malformed variant must be rejected. */
+     for (i = 0; i < D_ARRAY_SIZE( corruptions ); i++) {
+          build_file( &file );
+
+          len = sizeof(file);
+
+          corruptions[i].corrupt( &file, &len );
+
+          ret = load_and_render( dfb, surface, &file, len );
+          if (ret == DFB_OK) {
+               D_ERROR( "DFBTest/DFIFF: Malformed file (%s) was accepted!\n", corruptions[i].name );
+               failed++;
+          }
+          else
+               direct_log_printf( NULL, "Malformed file (%s) rejected.\n", corruptions[i].name );
+     }
+
+     surface->Release( surface );
+
+     /* Shutdown DirectFB. */
+     dfb->Release( dfb );
+
+     return failed ? DFB_FAILURE : DFB_OK;
+}
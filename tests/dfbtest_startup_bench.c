@@ -0,0 +1,165 @@
+/*
+   (c) Copyright 2012-2013  DirectFB integrated media GmbH
+   (c) Copyright 2001-2013  The world wide DirectFB Open Source Community (directfb.org)
+   (c) Copyright 2000-2004  Convergence (integrated media) GmbH
+
+   All rights reserved.
+
+   Written by Denis Oliver Kropp <dok@directfb.org>,
+              Andreas Shimokawa <andi@directfb.org>,
+              Marek Pikarski <mass@directfb.org>,
+              Sven Neumann <neo@directfb.org>,
+              Ville Syrjälä <syrjala@sci.fi> and
+              Claudio Ciccani <klan@users.sf.net>.
+
+   This file is subject to the terms and conditions of the MIT License:
+
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify, merge,
+   publish, distribute, sublicense, and/or sell copies of the Software,
+   and to permit persons to whom the Software is furnished to do so,
+   subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be
+   included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+   MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+   IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+   CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+   TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+   SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <direct/clock.h>
+#include <direct/messages.h>
+
+#include <directfb.h>
+
+/*
+ * Benchmark of bringing up and shutting down DirectFB, by default on the dummy system so that
+ * results only depend on the core and module loading. The first round is reported separately,
+ * it includes loading the modules and faulting in code. Run with "--dfb:startup-profile" to see
+ * where the time goes.
+ */
+
+/**********************************************************************************************************************/
+
+static int         num_rounds  = 10;
+static const char *system_name = "dummy";
+
+/**********************************************************************************************************************/
+
+static int
+show_usage( const char *name )
+{
+     fprintf( stderr, "Usage: %s [-r <rounds>] [-s <system>] [--dfb:<option>...]\n", name );
+
+     return -1;
+}
+
+int
+main( int argc, char *argv[] )
+{
+     DFBResult  ret;
+     IDirectFB *dfb;
+     int        i;
+     long long  wall, cpu;
+     long long  first_wall = 0, first_cpu = 0;
+     long long  min_wall   = 0, max_wall  = 0;
+     long long  sum_wall   = 0, sum_cpu   = 0;
+     long long  sum_release = 0;
+
+     /* Initialize DirectFB, removing its options from the command line. */
+     ret = DirectFBInit( &argc, &argv );
+     if (ret) {
+          D_DERROR( ret, "DFBTest/StartupBench: DirectFBInit() failed!\n" );
+          return ret;
+     }
+
+     for (i=1; i<argc; i++) {
+          if (!strcmp( argv[i], "-r" ) && i + 1 < argc)
+               num_rounds = atoi( argv[++i] );
+          else if (!strcmp( argv[i], "-s" ) && i + 1 < argc)
+               system_name = argv[++i];
+          else
+               return show_usage( argv[0] );
+     }
+
+     if (num_rounds < 1)
+          return show_usage( argv[0] );
+
+     DirectFBSetOption( "system", system_name );
+     DirectFBSetOption( "no-banner", NULL );
+
+     for (i=0; i<num_rounds; i++) {
+          wall = direct_clock_get_time( DIRECT_CLOCK_MONOTONIC );
+          cpu  = direct_clock_get_time( DIRECT_CLOCK_PROCESS_CPUTIME_ID );
+
+          /* Create super interface. */
+          ret = DirectFBCreate( &dfb );
+          if (ret) {
+               D_DERROR( ret, "DFBTest/StartupBench: DirectFBCreate() failed!\n" );
+               return ret;
+          }
+
+          wall = direct_clock_get_time( DIRECT_CLOCK_MONOTONIC ) - wall;
+          cpu  = direct_clock_get_time( DIRECT_CLOCK_PROCESS_CPUTIME_ID ) - cpu;
+
+          if (!i) {
+               first_wall = wall;
+               first_cpu  = cpu;
+          }
+          else {
+               if (i == 1 || wall < min_wall)
+                    min_wall = wall;
+
+               if (wall > max_wall)
+                    max_wall = wall;
+
+               sum_wall += wall;
+               sum_cpu  += cpu;
+          }
+
+          wall = direct_clock_get_time( DIRECT_CLOCK_MONOTONIC );
+
+          /* Shutdown DirectFB. */
+          ret = dfb->Release( dfb );
+          if (ret) {
+               D_DERROR( ret, "DFBTest/StartupBench: IDirectFB::Release() failed!\n" );
+               return ret;
+          }
+
+          sum_release += direct_clock_get_time( DIRECT_CLOCK_MONOTONIC ) - wall;
+     }
+
+     printf( "** DirectFBCreate() on '%s', %d rounds **\n\n", system_name, num_rounds );
+
+     printf( "  first      %8lld.%03lld ms wall %8lld.%03lld ms cpu\n",
+             first_wall / 1000, first_wall % 1000, first_cpu / 1000, first_cpu % 1000 );
+
+     if (num_rounds > 1) {
+          long long avg_wall = sum_wall / (num_rounds - 1);
+          long long avg_cpu  = sum_cpu  / (num_rounds - 1);
+
+          printf( "  average    %8lld.%03lld ms wall %8lld.%03lld ms cpu\n",
+                  avg_wall / 1000, avg_wall % 1000, avg_cpu / 1000, avg_cpu % 1000 );
+          printf( "  min / max  %8lld.%03lld ms      %8lld.%03lld ms\n",
+                  min_wall / 1000, min_wall % 1000, max_wall / 1000, max_wall % 1000 );
+     }
+
+     printf( "  release    %8lld.%03lld ms wall (average)\n",
+             sum_release / num_rounds / 1000, sum_release / num_rounds % 1000 );
+
+     return 0;
+}
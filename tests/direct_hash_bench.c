@@ -0,0 +1,454 @@
+/*
+   (c) Copyright 2012-2013  DirectFB integrated media GmbH
+   (c) Copyright 2001-2013  The world wide DirectFB Open Source Community (directfb.org)
+   (c) Copyright 2000-2004  Convergence (integrated media) GmbH
+
+   All rights reserved.
+
+   Written by Denis Oliver Kropp <dok@directfb.org>,
+              Andreas Shimokawa <andi@directfb.org>,
+              Marek Pikarski <mass@directfb.org>,
+              Sven Neumann <neo@directfb.org>,
+              Ville Syrjälä <syrjala@sci.fi> and
+              Claudio Ciccani <klan@users.sf.net>.
+
+   This file is subject to the terms and conditions of the MIT License:
+
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify, merge,
+   publish, distribute, sublicense, and/or sell copies of the Software,
+   and to permit persons to whom the Software is furnished to do so,
+   subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be
+   included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+   MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+   IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+   CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+   TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+   SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <direct/clock.h>
+#include <direct/direct.h>
+#include <direct/hash.h>
+#include <direct/mem.h>
+#include <direct/messages.h>
+#include <direct/thread.h>
+#include <direct/util.h>
+
+/*
+ * Benchmark of DirectHash against the previous implementation (linear probing over a prime sized table),
+ * with sequential ids and pointer like keys, and with lookups from several threads (lock free versus
+ * the previous implementation under a mutex).
+ */
+
+/**********************************************************************************************************************/
+
+static int num_keys    = 100000;
+static int num_rounds  = 10;
+static int num_threads = 4;
+
+/**********************************************************************************************************************/
+
+/*
+ * Previous implementation for comparison, not inlined to match the cost of calling into libdirect.
+ */
+
+typedef struct {
+     int                 size;
+     int                 count;
+     int                 removed;
+     DirectHashElement  *elements;
+} LegacyHash;
+
+#define LEGACY_REMOVED ((void *) -1)
+
+static const unsigned int legacy_primes[] = {
+     11, 19, 37, 73, 109, 163, 251, 367, 557, 823, 1237, 1861, 2777, 4177, 6247, 9371, 14057, 21089, 31627,
+     47431, 71143, 106721, 160073, 240101, 360163, 540217, 810343, 1215497, 1823231, 2734867, 4102283,
+     6153409, 9230113, 13845163
+};
+
+static void
+legacy_init( LegacyHash *hash )
+{
+     hash->size     = 17;
+     hash->count    = 0;
+     hash->removed  = 0;
+     hash->elements = calloc( hash->size, sizeof(DirectHashElement) );
+}
+
+static void
+legacy_deinit( LegacyHash *hash )
+{
+     free( hash->elements );
+}
+
+static int
+legacy_locate( const LegacyHash *hash, unsigned long key )
+{
+     int pos = key % hash->size;
+
+     while (hash->elements[pos].value) {
+          if (hash->elements[pos].value != LEGACY_REMOVED && hash->elements[pos].key == key)
+               return pos;
+
+          if (++pos == hash->size)
+               pos = 0;
+     }
+
+     return -1;
+}
+
+static void __attribute__((noinline))
+legacy_insert( LegacyHash *hash, unsigned long key, void *value )
+{
+     int pos;
+
+     if ((hash->count + hash->removed) > hash->size / 2) {
+          int                i, size = legacy_primes[D_ARRAY_SIZE(legacy_primes) - 1];
+          DirectHashElement *elements;
+
+          for (i=0; i<D_ARRAY_SIZE(legacy_primes); i++) {
+               if (legacy_primes[i] > hash->size) {
+                    size = legacy_primes[i];
+                    break;
+               }
+          }
+
+          elements = calloc( size, sizeof(DirectHashElement) );
+
+          for (i=0; i<hash->size; i++) {
+               if (hash->elements[i].value && hash->elements[i].value != LEGACY_REMOVED) {
+                    pos = hash->elements[i].key % size;
+
+                    while (elements[pos].value) {
+                         if (++pos == size)
+                              pos = 0;
+                    }
+
+                    elements[pos] = hash->elements[i];
+               }
+          }
+
+          free( hash->elements );
+
+          hash->size     = size;
+          hash->elements = elements;
+          hash->removed  = 0;
+     }
+
+     pos = key % hash->size;
+
+     while (hash->elements[pos].value && hash->elements[pos].value != LEGACY_REMOVED) {
+          if (++pos == hash->size)
+               pos = 0;
+     }
+
+     if (hash->elements[pos].value == LEGACY_REMOVED)
+          hash->removed--;
+
+     hash->elements[pos].key   = key;
+     hash->elements[pos].value = value;
+
+     hash->count++;
+}
+
+static void __attribute__((noinline))
+legacy_remove( LegacyHash *hash, unsigned long key )
+{
+     int pos = legacy_locate( hash, key );
+
+     if (pos != -1) {
+          hash->elements[pos].value = LEGACY_REMOVED;
+
+          hash->count--;
+          hash->removed++;
+     }
+}
+
+static void * __attribute__((noinline))
+legacy_lookup( const LegacyHash *hash, unsigned long key )
+{
+     int pos = legacy_locate( hash, key );
+
+     return (pos != -1) ? hash->elements[pos].value : NULL;
+}
+
+/**********************************************************************************************************************/
+
+typedef enum {
+     KEYS_SEQUENTIAL,
+     KEYS_POINTER,
+     KEYS_STRIDE
+} KeyPattern;
+
+static unsigned long
+make_key( KeyPattern pattern, int i )
+{
+     switch (pattern) {
+          case KEYS_SEQUENTIAL:
+               return i + 1;
+
+          case KEYS_POINTER:
+               return 0x7f3a20001000UL + (unsigned long) i * 48;
+
+          case KEYS_STRIDE:
+               return (unsigned long) i * 65536;
+     }
+
+     return i;
+}
+
+static const char *
+pattern_name( KeyPattern pattern )
+{
+     switch (pattern) {
+          case KEYS_SEQUENTIAL:
+               return "sequential";
+
+          case KEYS_POINTER:
+               return "pointer";
+
+          case KEYS_STRIDE:
+               return "stride";
+     }
+
+     return "?";
+}
+
+static void
+report( const char *what, KeyPattern pattern, const char *impl, long long us, long long ops )
+{
+     printf( "  %-14s %-10s  %-7s  %8.2f ns/op\n", what, pattern_name( pattern ), impl, us * 1000.0 / ops );
+}
+
+/**********************************************************************************************************************/
+
+static void
+bench_single( KeyPattern pattern )
+{
+     int          i, r;
+     long long    t_insert = 0, t_hit = 0, t_miss = 0, t_remove = 0, t0;
+     void        *value = (void*) 1;
+     unsigned long sum = 0;
+
+     /* Previous implementation */
+     for (r=0; r<num_rounds; r++) {
+          LegacyHash hash;
+
+          legacy_init( &hash );
+
+          t0 = direct_clock_get_micros();
+          for (i=0; i<num_keys; i++)
+               legacy_insert( &hash, make_key( pattern, i ), value );
+          t_insert += direct_clock_get_micros() - t0;
+
+          t0 = direct_clock_get_micros();
+          for (i=0; i<num_keys; i++)
+               sum += (unsigned long) legacy_lookup( &hash, make_key( pattern, (i * 7919) % num_keys ) );
+          t_hit += direct_clock_get_micros() - t0;
+
+          t0 = direct_clock_get_micros();
+          for (i=0; i<num_keys; i++)
+               sum += (unsigned long) legacy_lookup( &hash, make_key( pattern, num_keys + i ) );
+          t_miss += direct_clock_get_micros() - t0;
+
+          t0 = direct_clock_get_micros();
+          for (i=0; i<num_keys; i++)
+               legacy_remove( &hash, make_key( pattern, i ) );
+          t_remove += direct_clock_get_micros() - t0;
+
+          legacy_deinit( &hash );
+     }
+
+     report( "insert",        pattern, "old", t_insert, (long long) num_keys * num_rounds );
+     report( "lookup (hit)",  pattern, "old", t_hit,    (long long) num_keys * num_rounds );
+     report( "lookup (miss)", pattern, "old", t_miss,   (long long) num_keys * num_rounds );
+     report( "remove",        pattern, "old", t_remove, (long long) num_keys * num_rounds );
+
+     t_insert = t_hit = t_miss = t_remove = 0;
+
+     /* DirectHash */
+     for (r=0; r<num_rounds; r++) {
+          DirectHash hash;
+
+          direct_hash_init( &hash, 17 );
+
+          t0 = direct_clock_get_micros();
+          for (i=0; i<num_keys; i++)
+               direct_hash_insert( &hash, make_key( pattern, i ), value );
+          t_insert += direct_clock_get_micros() - t0;
+
+          t0 = direct_clock_get_micros();
+          for (i=0; i<num_keys; i++)
+               sum += (unsigned long) direct_hash_lookup( &hash, make_key( pattern, (i * 7919) % num_keys ) );
+          t_hit += direct_clock_get_micros() - t0;
+
+          t0 = direct_clock_get_micros();
+          for (i=0; i<num_keys; i++)
+               sum += (unsigned long) direct_hash_lookup( &hash, make_key( pattern, num_keys + i ) );
+          t_miss += direct_clock_get_micros() - t0;
+
+          t0 = direct_clock_get_micros();
+          for (i=0; i<num_keys; i++)
+               direct_hash_remove( &hash, make_key( pattern, i ) );
+          t_remove += direct_clock_get_micros() - t0;
+
+          direct_hash_deinit( &hash );
+     }
+
+     report( "insert",        pattern, "new", t_insert, (long long) num_keys * num_rounds );
+     report( "lookup (hit)",  pattern, "new", t_hit,    (long long) num_keys * num_rounds );
+     report( "lookup (miss)", pattern, "new", t_miss,   (long long) num_keys * num_rounds );
+     report( "remove",        pattern, "new", t_remove, (long long) num_keys * num_rounds );
+
+     if (sum != 2UL * num_keys * num_rounds)
+          D_ERROR( "Direct/HashBench: Lookups returned wrong values!\n" );
+}
+
+/**********************************************************************************************************************/
+
+typedef struct {
+     bool          legacy;
+     LegacyHash   *legacy_hash;
+     DirectHash   *hash;
+     DirectMutex  *lock;
+     int           offset;
+     long long     us;
+     unsigned long found;
+} LookupThread;
+
+static void *
+lookup_thread( DirectThread *thread,
+               void         *arg )
+{
+     LookupThread *data = arg;
+     long long     t0   = direct_clock_get_micros();
+     int           i, r;
+
+     for (r=0; r<num_rounds; r++) {
+          for (i=0; i<num_keys; i++) {
+               unsigned long key = make_key( KEYS_POINTER, (i * 7919 + data->offset) % num_keys );
+
+               if (data->legacy) {
+                    direct_mutex_lock( data->lock );
+                    data->found += legacy_lookup( data->legacy_hash, key ) != NULL;
+                    direct_mutex_unlock( data->lock );
+               }
+               else
+                    data->found += direct_hash_lookup_lockfree( data->hash, key ) != NULL;
+          }
+     }
+
+     data->us = direct_clock_get_micros() - t0;
+
+     return NULL;
+}
+
+static void
+bench_threads( void )
+{
+     int          i, n, impl;
+     LegacyHash   legacy_hash;
+     DirectHash   hash;
+     DirectMutex  lock;
+
+     legacy_init( &legacy_hash );
+     direct_hash_init( &hash, 17 );
+     direct_mutex_init( &lock );
+
+     for (i=0; i<num_keys; i++) {
+          legacy_insert( &legacy_hash, make_key( KEYS_POINTER, i ), (void*) 1 );
+          direct_hash_insert( &hash, make_key( KEYS_POINTER, i ), (void*) 1 );
+     }
+
+     for (impl=0; impl<2; impl++) {
+          DirectThread *threads[num_threads];
+          LookupThread  data[num_threads];
+          long long     us = 0;
+
+          for (n=0; n<num_threads; n++) {
+               data[n].legacy      = !impl;
+               data[n].legacy_hash = &legacy_hash;
+               data[n].hash        = &hash;
+               data[n].lock        = &lock;
+               data[n].offset      = n * 1013;
+               data[n].found       = 0;
+
+               threads[n] = direct_thread_create( DTT_DEFAULT, lookup_thread, &data[n], "Lookup" );
+          }
+
+          for (n=0; n<num_threads; n++) {
+               direct_thread_join( threads[n] );
+               direct_thread_destroy( threads[n] );
+
+               us = MAX( us, data[n].us );
+
+               if (data[n].found != (unsigned long) num_keys * num_rounds)
+                    D_ERROR( "Direct/HashBench: Lookups from threads missed keys!\n" );
+          }
+
+          printf( "  %d threads      %-10s  %-7s  %8.2f Mlookups/s\n", num_threads, pattern_name( KEYS_POINTER ),
+                  impl ? "new" : "old+lock", (double) num_keys * num_rounds * num_threads / us );
+     }
+
+     direct_mutex_deinit( &lock );
+     direct_hash_deinit( &hash );
+     legacy_deinit( &legacy_hash );
+}
+
+/**********************************************************************************************************************/
+
+static int
+show_usage( const char *name )
+{
+     fprintf( stderr, "Usage: %s [-n <keys>] [-r <rounds>] [-t <threads>]\n", name );
+
+     return -1;
+}
+
+int
+main( int argc, char *argv[] )
+{
+     int i;
+
+     for (i=1; i<argc; i++) {
+          if (!strcmp( argv[i], "-n" ) && i + 1 < argc)
+               num_keys = atoi( argv[++i] );
+          else if (!strcmp( argv[i], "-r" ) && i + 1 < argc)
+               num_rounds = atoi( argv[++i] );
+          else if (!strcmp( argv[i], "-t" ) && i + 1 < argc)
+               num_threads = atoi( argv[++i] );
+          else
+               return show_usage( argv[0] );
+     }
+
+     if (num_keys < 1 || num_rounds < 1 || num_threads < 1)
+          return show_usage( argv[0] );
+
+     direct_initialize();
+
+     printf( "** DirectHash with %d keys, %d rounds **\n\n", num_keys, num_rounds );
+
+     bench_single( KEYS_SEQUENTIAL );
+     bench_single( KEYS_POINTER );
+     bench_single( KEYS_STRIDE );
+     bench_threads();
+
+     direct_shutdown();
+
+     return 0;
+}
@@ -0,0 +1,395 @@
+/*
+   (c) Copyright 2012-2013  DirectFB integrated media GmbH
+   (c) Copyright 2001-2013  The world wide DirectFB Open Source Community (directfb.org)
+   (c) Copyright 2000-2004  Convergence (integrated media) GmbH
+
+   All rights reserved.
+
+   Written by Denis Oliver Kropp <dok@directfb.org>,
+              Andreas Shimokawa <andi@directfb.org>,
+              Marek Pikarski <mass@directfb.org>,
+              Sven Neumann <neo@directfb.org>,
+              Ville Syrjälä <syrjala@sci.fi> and
+              Claudio Ciccani <klan@users.sf.net>.
+
+   This file is subject to the terms and conditions of the MIT License:
+
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify, merge,
+   publish, distribute, sublicense, and/or sell copies of the Software,
+   and to permit persons to whom the Software is furnished to do so,
+   subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be
+   included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+   MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+   IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+   CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+   TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+   SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <config.h>
+
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <direct/conf.h>
+#include <direct/debug.h>
+#include <direct/direct.h>
+#include <direct/messages.h>
+#include <direct/stream.h>
+#include <direct/util.h>
+
+/*
+ * Tests prefetching, seeking and caching of HTTP streams against a minimal local HTTP/1.1 server
+ * which supports ranges and keep-alive and counts the connections and requests.
+ */
+
+D_DEBUG_DOMAIN( Direct_StreamHTTP, "Direct/StreamHTTP", "libdirect HTTP stream test" );
+
+
+#define RESOURCE_SIZE  (1024 * 1024 + 123)
+
+typedef struct {
+     int connections;
+     int requests;
+} ServerStats;
+
+static ServerStats *stats;
+
+static inline u8
+resource_byte( unsigned int offset )
+{
+     return (offset * 2654435761u) >> 24;
+}
+
+/**********************************************************************************************************************/
+
+static bool
+server_send( int fd, const char *buf, size_t length )
+{
+     while (length) {
+          ssize_t len = write( fd, buf, length );
+
+          if (len <= 0)
+               return false;
+
+          buf    += len;
+          length -= len;
+     }
+
+     return true;
+}
+
+static bool
+server_request( int fd )
+{
+     char         buf[2048];
+     int          len = 0;
+     long long    start = -1, end = -1;
+     bool         keepalive;
+     char        *line;
+     unsigned int i;
+
+     buf[0] = 0;
+
+     /* read headers */
+     while (!strstr( buf, "\r\n\r\n" )) {
+          ssize_t s;
+
+          if (len == sizeof(buf) - 1)
+               return false;
+
+          s = read( fd, buf + len, sizeof(buf) - 1 - len );
+          if (s <= 0)
+               return false;
+
+          len += s;
+          buf[len] = 0;
+     }
+
+     __sync_fetch_and_add( &stats->requests, 1 );
+
+     keepalive = strstr( buf, "HTTP/1.1" ) != NULL;
+
+     line = strstr( buf, "Range: bytes=" );
+     if (line) {
+          start = strtoll( line + 13, &line, 10 );
+          if (line[1] >= '0' && line[1] <= '9')
+               end = strtoll( line + 1, NULL, 10 );
+     }
+
+     if (start >= RESOURCE_SIZE) {
+          len = snprintf( buf, sizeof(buf), "HTTP/1.1 416 Range Not Satisfiable\r\n"
+                          "Content-Range: bytes */%d\r\nContent-Length: 0\r\n\r\n", RESOURCE_SIZE );
+
+          return server_send( fd, buf, len ) && keepalive;
+     }
+
+     if (start >= 0) {
+          if (end < 0 || end >= RESOURCE_SIZE)
+               end = RESOURCE_SIZE - 1;
+
+          len = snprintf( buf, sizeof(buf), "HTTP/1.1 206 Partial Content\r\n"
+                          "Content-Range: bytes %lld-%lld/%d\r\n", start, end, RESOURCE_SIZE );
+     }
+     else {
+          start = 0;
+          end   = RESOURCE_SIZE - 1;
+
+          len = snprintf( buf, sizeof(buf), "HTTP/1.1 200 OK\r\n" );
+     }
+
+     len += snprintf( buf + len, sizeof(buf) - len, "Content-Length: %lld\r\n"
+                      "Content-Type: application/octet-stream\r\n"
+                      "Accept-Ranges: bytes\r\n"
+                      "ETag: \"%d\"\r\n"
+                      "Connection: %s\r\n\r\n",
+                      end - start + 1, RESOURCE_SIZE, keepalive ? "keep-alive" : "close" );
+
+     if (!server_send( fd, buf, len ))
+          return false;
+
+     while (start <= end) {
+          for (i = 0; i < sizeof(buf) && start + i <= end; i++)
+               buf[i] = resource_byte( start + i );
+
+          if (!server_send( fd, buf, i ))
+               return false;
+
+          start += i;
+     }
+
+     return keepalive;
+}
+
+static void
+server_run( int sd )
+{
+     signal( SIGPIPE, SIG_IGN );
+
+     while (true) {
+          int fd = accept( sd, NULL, NULL );
+
+          if (fd < 0)
+               continue;
+
+          __sync_fetch_and_add( &stats->connections, 1 );
+
+          if (fork() == 0) {
+               close( sd );
+
+               while (server_request( fd ));
+
+               _exit( 0 );
+          }
+
+          close( fd );
+     }
+}
+
+/**********************************************************************************************************************/
+
+static bool
+check_read( DirectStream *stream, unsigned int offset, unsigned int length )
+{
+     DirectResult  ret;
+     u8           *buf = alloca( length );
+     unsigned int  done = 0;
+     unsigned int  i;
+
+     ret = direct_stream_seek( stream, offset );
+     if (ret) {
+          D_DERROR( ret, "Direct/StreamHTTP: Seeking to %u failed!\n", offset );
+          return false;
+     }
+
+     while (done < length) {
+          unsigned int len;
+
+          ret = direct_stream_wait( stream, length - done, NULL );
+          if (ret == DR_OK)
+               ret = direct_stream_read( stream, length - done, buf + done, &len );
+          if (ret) {
+               D_DERROR( ret, "Direct/StreamHTTP: Reading at %u failed!\n", offset + done );
+               return false;
+          }
+
+          done += len;
+     }
+
+     for (i = 0; i < length; i++) {
+          if (buf[i] != resource_byte( offset + i )) {
+               D_ERROR( "Direct/StreamHTTP: Mismatch at %u!\n", offset + i );
+               return false;
+          }
+     }
+
+     D_DEBUG_AT( Direct_StreamHTTP, "  -> %7u (%u) ok, %d connections, %d requests\n",
+                 offset, length, stats->connections, stats->requests );
+
+     return true;
+}
+
+/*
+ * Reads the stream at various positions, or only within the blocks cached completely by a full run
+ * (0-262143), staying a prefetch buffer (64 KiB) away from their end.
+ */
+static bool
+run_checks( const char *url, bool cached )
+{
+     DirectResult  ret;
+     DirectStream *stream;
+     bool          ok = false;
+     u8            tail[16];
+     unsigned int  len;
+
+     ret = direct_stream_create( url, &stream );
+     if (ret) {
+          D_DERROR( ret, "Direct/StreamHTTP: Opening '%s' failed!\n", url );
+          return false;
+     }
+
+     if (direct_stream_length( stream ) != RESOURCE_SIZE || !direct_stream_seekable( stream )) {
+          D_ERROR( "Direct/StreamHTTP: Wrong length %u or not seekable!\n", direct_stream_length( stream ) );
+          goto out;
+     }
+
+     if (cached) {
+          ok = check_read( stream, 0, 150000 ) &&
+               check_read( stream, 5000, 70000 ) &&
+               check_read( stream, 100000, 90000 );
+          goto out;
+     }
+
+     /* sequential, forward within the prefetched data, far forward, backward */
+     if (!check_read( stream, 0, 200000 ) ||
+         !check_read( stream, 210000, 1000 ) ||
+         !check_read( stream, 900000, 50000 ) ||
+         !check_read( stream, 5000, 70000 ) ||
+         !check_read( stream, RESOURCE_SIZE - 1000, 1000 ))
+          goto out;
+
+     if (direct_stream_read( stream, sizeof(tail), tail, &len ) != DR_EOF) {
+          D_ERROR( "Direct/StreamHTTP: No end of file!\n" );
+          goto out;
+     }
+
+     ok = true;
+
+out:
+     direct_stream_destroy( stream );
+
+     return ok;
+}
+
+int
+main( int argc, char *argv[] )
+{
+     int                 sd;
+     pid_t               server;
+     struct sockaddr_in  addr;
+     socklen_t           addrlen = sizeof(addr);
+     char                url[64];
+     char                cache[] = "/tmp/direct_stream_http.XXXXXX";
+     int                 requests;
+     bool                ok;
+
+     stats = mmap( NULL, sizeof(ServerStats), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0 );
+     if (stats == MAP_FAILED)
+          return -1;
+
+     memset( &addr, 0, sizeof(addr) );
+     addr.sin_family      = AF_INET;
+     addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+
+     sd = socket( AF_INET, SOCK_STREAM, 0 );
+     if (sd < 0 || bind( sd, (struct sockaddr*) &addr, sizeof(addr) ) ||
+         listen( sd, 8 ) || getsockname( sd, (struct sockaddr*) &addr, &addrlen ))
+     {
+          perror( "server socket" );
+          return -1;
+     }
+
+     server = fork();
+     if (server == 0)
+          server_run( sd );
+
+     close( sd );
+
+     snprintf( url, sizeof(url), "http://127.0.0.1:%d/resource", ntohs( addr.sin_port ) );
+
+     if (!mkdtemp( cache )) {
+          perror( "mkdtemp" );
+          kill( server, SIGTERM );
+          return -1;
+     }
+
+     /* Initialize libdirect. */
+     direct_initialize();
+
+     direct_config_set( "stream-prefetch", "64" );
+     direct_config_set( "stream-cache", cache );
+
+     ok = run_checks( url, false );
+
+     D_INFO( "Direct/StreamHTTP: First pass %s, %d connections, %d requests\n",
+             ok ? "ok" : "FAILED", stats->connections, stats->requests );
+
+     /* All seeks are served by ranges over the same kept alive connection. */
+     if (ok && stats->connections != 1) {
+          D_ERROR( "Direct/StreamHTTP: Expected one connection, got %d!\n", stats->connections );
+          ok = false;
+     }
+
+     /* Again, now served from the cache. */
+     if (ok) {
+          requests = stats->requests;
+
+          ok = run_checks( url, true );
+
+          D_INFO( "Direct/StreamHTTP: Second pass %s, %d requests\n",
+                  ok ? "ok" : "FAILED", stats->requests - requests );
+
+          /* Only the request opening the stream, which validates the cache, no ranges for the data. */
+          if (ok && stats->requests - requests != 1) {
+               D_ERROR( "Direct/StreamHTTP: Expected only the opening request, got %d!\n", stats->requests - requests );
+               ok = false;
+          }
+     }
+
+     /* Without prefetching. */
+     if (ok) {
+          direct_config_set( "stream-prefetch", "0" );
+
+          ok = run_checks( url, false );
+
+          D_INFO( "Direct/StreamHTTP: Unbuffered pass %s\n", ok ? "ok" : "FAILED" );
+     }
+
+     /* Shutdown libdirect. */
+     direct_shutdown();
+
+     kill( server, SIGTERM );
+     waitpid( server, NULL, 0 );
+
+     snprintf( url, sizeof(url), "rm -rf %s", cache );
+
+     if (system( url ))
+          fprintf( stderr, "Could not remove %s!\n", cache );
+
+     return ok ? 0 : -1;
+}
@@ -0,0 +1,306 @@
+/*
+   (c) Copyright 2012-2013  DirectFB integrated media GmbH
+   (c) Copyright 2001-2013  The world wide DirectFB Open Source Community (directfb.org)
+   (c) Copyright 2000-2004  Convergence (integrated media) GmbH
+
+   All rights reserved.
+
+   Written by Denis Oliver Kropp <dok@directfb.org>,
+              Andreas Shimokawa <andi@directfb.org>,
+              Marek Pikarski <mass@directfb.org>,
+              Sven Neumann <neo@directfb.org>,
+              Ville Syrjälä <syrjala@sci.fi> and
+              Claudio Ciccani <klan@users.sf.net>.
+
+   This file is subject to the terms and conditions of the MIT License:
+
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify, merge,
+   publish, distribute, sublicense, and/or sell copies of the Software,
+   and to permit persons to whom the Software is furnished to do so,
+   subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be
+   included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+   MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+   IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+   CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+   TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+   SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <config.h>
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <directfb.h>
+
+#include <direct/messages.h>
+#include <direct/thread.h>
+
+#include <sawman.h>
+#include <sawman_config.h>
+#include <sawman_internal.h>
+
+#include <isawman.h>
+
+/*
+ * Tests promotion of windows to an overlay layer, their demotion and the hysteresis in between,
+ * using the dummy system with an additional layer.
+ */
+
+#define HYSTERESIS 4
+
+static IDirectFB *dfb;
+static SaWMan    *sawman;
+
+/**********************************************************************************************************************/
+
+/*
+ * Returns true if the window is currently shown on the overlay.
+ */
+static bool
+promoted( IDirectFBWindow *window )
+{
+     bool        ret = false;
+     DFBWindowID id;
+
+     window->GetID( window, &id );
+
+     if (sawman_lock( sawman ))
+          return false;
+
+     if (sawman->overlays[0].window)
+          ret = sawman->overlays[0].window->id == id;
+
+     sawman_unlock( sawman );
+
+     return ret;
+}
+
+/*
+ * Lets all pending repaints (asynchronous) be processed.
+ */
+static void
+settle( void )
+{
+     dfb->WaitIdle( dfb );
+
+     direct_thread_sleep( 50000 );
+}
+
+/*
+ * Flips the window until it is promoted, returning the number of flips or -1 if it never was.
+ * Promotion happens with the 'overlay-hysteresis'th flip, passes caused by other windows don't count.
+ */
+static int
+flip_until_promoted( IDirectFBWindow *window )
+{
+     int               flips;
+     IDirectFBSurface *surface;
+
+     window->GetSurface( window, &surface );
+
+     for (flips=0; flips<HYSTERESIS * 4; flips++) {
+          if (promoted( window ))
+               break;
+
+          surface->Clear( surface, 0x40, 0x80, 0xc0, 0xff );
+          surface->Flip( surface, NULL, DSFLIP_NONE );
+
+          settle();
+     }
+
+     surface->Release( surface );
+
+     return promoted( window ) ? flips : -1;
+}
+
+static IDirectFBWindow *
+create_window( IDirectFBDisplayLayer *layer,
+               int                    x,
+               int                    y,
+               int                    width,
+               int                    height )
+{
+     DFBResult             ret;
+     DFBWindowDescription  desc;
+     IDirectFBWindow      *window;
+
+     desc.flags       = DWDESC_CAPS | DWDESC_POSX | DWDESC_POSY | DWDESC_WIDTH | DWDESC_HEIGHT | DWDESC_PIXELFORMAT;
+     desc.caps        = DWCAPS_NODECORATION;
+     desc.posx        = x;
+     desc.posy        = y;
+     desc.width       = width;
+     desc.height      = height;
+     desc.pixelformat = DSPF_RGB32;
+
+     ret = layer->CreateWindow( layer, &desc, &window );
+     if (ret) {
+          DirectFBError( "IDirectFBDisplayLayer::CreateWindow() failed", ret );
+          return NULL;
+     }
+
+     window->SetOpacity( window, 0xff );
+
+     settle();
+
+     return window;
+}
+
+/**********************************************************************************************************************/
+
+int
+main( int argc, char *argv[] )
+{
+     DFBResult              ret;
+     int                    flips;
+     char                   buf[16];
+     bool                   ok     = false;
+     ISaWMan               *saw    = NULL;
+     IDirectFBDisplayLayer *layer  = NULL;
+     IDirectFBWindow       *window = NULL;
+     IDirectFBWindow       *cover  = NULL;
+
+     /* Initialize DirectFB. */
+     ret = DirectFBInit( &argc, &argv );
+     if (ret) {
+          DirectFBError( "DirectFBInit", ret );
+          return -1;
+     }
+
+     DirectFBSetOption( "system", "dummy" );
+     DirectFBSetOption( "dummy-layers", "2" );
+     DirectFBSetOption( "wm", "sawman" );
+     DirectFBSetOption( "mode", "640x480" );
+
+     /* Initialize SaWMan, using the second dummy layer for promotion. */
+     ret = SaWManInit( &argc, &argv );
+     if (ret) {
+          DirectFBError( "SaWManInit", ret );
+          return -1;
+     }
+
+     sawman_config_set( "overlay-layer", "1" );
+     snprintf( buf, sizeof(buf), "%d", HYSTERESIS );
+     sawman_config_set( "overlay-hysteresis", buf );
+
+     /* Create the super interface. */
+     ret = DirectFBCreate( &dfb );
+     if (ret) {
+          DirectFBError( "DirectFBCreate", ret );
+          return -1;
+     }
+
+     /* Create the SaWMan interface to get at the overlay state. */
+     ret = SaWManCreate( &saw );
+     if (ret) {
+          DirectFBError( "SaWManCreate", ret );
+          goto out;
+     }
+
+     sawman = ((ISaWMan_data*) saw->priv)->sawman;
+     D_MAGIC_ASSERT( sawman, SaWMan );
+
+     if (sawman->num_overlays != 1) {
+          D_ERROR( "SaWMan/Overlay: Layer 1 not used as overlay!\n" );
+          goto out;
+     }
+
+     ret = dfb->GetDisplayLayer( dfb, DLID_PRIMARY, &layer );
+     if (ret) {
+          DirectFBError( "IDirectFB::GetDisplayLayer() failed", ret );
+          goto out;
+     }
+
+     window = create_window( layer, 100, 100, 200, 150 );
+     if (!window)
+          goto out;
+
+     /* Not promoted before being eligible for 'overlay-hysteresis' passes. */
+     if (promoted( window )) {
+          D_ERROR( "SaWMan/Overlay: Promoted right after being shown!\n" );
+          goto out;
+     }
+
+     flips = flip_until_promoted( window );
+     if (flips != HYSTERESIS) {
+          D_ERROR( "SaWMan/Overlay: Promoted after %d flips instead of %d!\n", flips, HYSTERESIS );
+          goto out;
+     }
+
+     /* Demoted when its geometry changes, promoted again after the hysteresis. */
+     window->MoveTo( window, 50, 60 );
+
+     settle();
+
+     if (promoted( window )) {
+          D_ERROR( "SaWMan/Overlay: Not demoted after moving!\n" );
+          goto out;
+     }
+
+     flips = flip_until_promoted( window );
+     if (flips != HYSTERESIS) {
+          D_ERROR( "SaWMan/Overlay: Promoted after %d flips instead of %d after moving!\n", flips, HYSTERESIS );
+          goto out;
+     }
+
+     /* Demoted when covered by another window, promoted again when that is gone. */
+     cover = create_window( layer, 150, 150, 50, 50 );
+     if (!cover)
+          goto out;
+
+     if (promoted( window )) {
+          D_ERROR( "SaWMan/Overlay: Not demoted while covered!\n" );
+          goto out;
+     }
+
+     cover->Destroy( cover );
+     cover->Release( cover );
+     cover = NULL;
+
+     settle();
+
+     flips = flip_until_promoted( window );
+     if (flips != HYSTERESIS) {
+          D_ERROR( "SaWMan/Overlay: Promoted after %d flips instead of %d after uncovering!\n", flips, HYSTERESIS );
+          goto out;
+     }
+
+     /* Demoted when becoming translucent. */
+     window->SetOpacity( window, 0x80 );
+
+     settle();
+
+     if (promoted( window )) {
+          D_ERROR( "SaWMan/Overlay: Not demoted when translucent!\n" );
+          goto out;
+     }
+
+     D_INFO( "SaWMan/Overlay: All tests passed\n" );
+
+     ok = true;
+
+out:
+     if (cover)
+          cover->Release( cover );
+
+     if (window)
+          window->Release( window );
+
+     if (layer)
+          layer->Release( layer );
+
+     if (saw)
+          saw->Release( saw );
+
+     dfb->Release( dfb );
+
+     return ok ? 0 : 1;
+}
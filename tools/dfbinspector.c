@@ -1,14 +1,20 @@
+#include <signal.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <sys/stat.h>
 
+#include <direct/conf.h>
 #include <direct/messages.h>
+#include <direct/timeline.h>
 #include <direct/util.h>
 
 #include <directfb.h>
 #include <directfb_strings.h>
 
+#include <core/gfxstats.h>
+
 /**********************************************************************************************************************/
 
 static const DirectFBPixelFormatNames(format_names);
@@ -19,8 +25,11 @@ static const DirectFBAccelerationMaskNames(accelerationmask_names);
 /**********************************************************************************************************************/
 
 typedef enum {
-     NONE         = 0x00000000,
-     CREATE_FILES = 0x00000001
+     NONE           = 0x00000000,
+     CREATE_FILES   = 0x00000001,
+     DUMP_TIMELINE  = 0x00000002,
+     SIGNAL_ONLY    = 0x00000004,
+     STATS_ONLY     = 0x00000008
 } Options;
 
 typedef struct {
@@ -29,6 +38,7 @@ typedef struct {
 
      Options           options;
      const char       *directory;
+     const char       *timeline;
 
      struct {
           FILE *formats;
@@ -39,6 +49,78 @@ typedef struct {
 
 /**********************************************************************************************************************/
 
+static const char *
+accel_name( int index )
+{
+     int i;
+
+     for (i=0; accelerationmask_names[i].mask; i++) {
+          if (accelerationmask_names[i].mask == (1 << index))
+               return accelerationmask_names[i].name;
+     }
+
+     return "?";
+}
+
+/*
+ * Print the statistics of another process (started with "gfx-stats").
+ */
+static DFBResult
+Inspector_ShowStats( int pid )
+{
+     DFBResult           ret;
+     int                 i, e, r;
+     const CoreGfxStats *stats;
+     CoreGfxStatsSlot    totals;
+     static const char  *engine_names[_CGSE_NUM] = { "hardware", "software" };
+
+     ret = dfb_gfxstats_open( pid, &stats );
+     if (ret) {
+          D_DERROR( ret, "Inspector/Stats: Could not open statistics of process %d!\n", pid );
+          return ret;
+     }
+
+     dfb_gfxstats_merge( stats, &totals );
+
+     printf( "\nGraphics statistics of '%s' (%d), %lld seconds\n\n", stats->name, stats->pid,
+             (direct_clock_get_time( DIRECT_CLOCK_MONOTONIC ) - stats->ts_start) / 1000000 );
+
+     printf( "%-16s %-8s %12s %12s %14s %12s\n", "Function", "Engine", "Operations", "Primitives", "Pixels", "Time [us]" );
+
+     for (i=0; i<DFB_GFXSTATS_FUNCS; i++) {
+          for (e=0; e<_CGSE_NUM; e++) {
+               const CoreGfxStatsCounters *counters = &totals.funcs[i][e];
+
+               if (!counters->operations)
+                    continue;
+
+               printf( "%-16s %-8s %12llu %12llu %14llu %12llu\n", accel_name( i ), engine_names[e],
+                       (unsigned long long) counters->operations, (unsigned long long) counters->primitives,
+                       (unsigned long long) counters->pixels, (unsigned long long) counters->time );
+          }
+     }
+
+     printf( "\n%-16s %-16s %12s\n", "Function", "Fallback", "Operations" );
+
+     for (i=0; i<DFB_GFXSTATS_FUNCS; i++) {
+          for (r=0; r<_CGFR_NUM; r++) {
+               if (!totals.fallbacks[i][r])
+                    continue;
+
+               printf( "%-16s %-16s %12llu\n", accel_name( i ), dfb_gfxstats_fallback_name( r ),
+                       (unsigned long long) totals.fallbacks[i][r] );
+          }
+     }
+
+     printf( "\n" );
+
+     dfb_gfxstats_close( stats );
+
+     return DFB_OK;
+}
+
+/**********************************************************************************************************************/
+
 static DFBResult
 Inspector_Init( Inspector *inspector, int argc, char *argv[] )
 {
@@ -58,8 +140,50 @@ Inspector_Init( Inspector *inspector, int argc, char *argv[] )
                inspector->directory  = argv[i];
                inspector->options   |= CREATE_FILES;
           }
+          else if (!strcmp( argv[i], "-t" )) {
+               if (++i == argc) {
+                    D_ERROR( "Inspector/Init: Missing argument to option '-t'!\n" );
+                    return DFB_INVARG;
+               }
+
+               inspector->timeline  = argv[i];
+               inspector->options  |= DUMP_TIMELINE;
+          }
+          else if (!strcmp( argv[i], "-T" )) {
+               if (++i == argc) {
+                    D_ERROR( "Inspector/Init: Missing argument to option '-T'!\n" );
+                    return DFB_INVARG;
+               }
+
+               /*
+                * Let another process (started with "timeline=<events>") dump its timeline.
+                * SIGURG is ignored by processes not recording one.
+                */
+               if (kill( atoi( argv[i] ), SIGURG )) {
+                    D_PERROR( "Inspector/Init: Could not signal process %s!\n", argv[i] );
+                    return DFB_FAILURE;
+               }
+
+               inspector->options |= SIGNAL_ONLY;
+
+               return DFB_OK;
+          }
+          else if (!strcmp( argv[i], "-s" )) {
+               if (++i == argc) {
+                    D_ERROR( "Inspector/Init: Missing argument to option '-s'!\n" );
+                    return DFB_INVARG;
+               }
+
+               inspector->options |= STATS_ONLY;
+
+               return Inspector_ShowStats( atoi( argv[i] ) );
+          }
      }
 
+     /* Record our own run, unless a timeline size has been configured already. */
+     if ((inspector->options & DUMP_TIMELINE) && !D_TIMELINE_ENABLED())
+          direct_config_set( "timeline", "65536" );
+
      ret = DirectFBCreate( &inspector->dfb );
      if (ret) {
           D_DERROR( ret, "Inspector/Init: DirectFBCreate() failed!\n" );
@@ -290,7 +414,15 @@ main( int argc, char *argv[] )
      ret = Inspector_Init( &inspector, argc, argv );
      if (ret)
           return ret;
-          
-     return Inspector_Run( &inspector );
+
+     if (inspector.options & (SIGNAL_ONLY | STATS_ONLY))
+          return DFB_OK;
+
+     ret = Inspector_Run( &inspector );
+
+     if (inspector.options & DUMP_TIMELINE)
+          direct_timeline_dump( inspector.timeline );
+
+     return ret;
 }
 
@@ -0,0 +1,84 @@
+/*
+   (c) Copyright 2012-2013  DirectFB integrated media GmbH
+   (c) Copyright 2001-2013  The world wide DirectFB Open Source Community (directfb.org)
+   (c) Copyright 2000-2004  Convergence (integrated media) GmbH
+
+   All rights reserved.
+
+   Written by Denis Oliver Kropp <dok@directfb.org>,
+              Andreas Shimokawa <andi@directfb.org>,
+              Marek Pikarski <mass@directfb.org>,
+              Sven Neumann <neo@directfb.org>,
+              Ville Syrjälä <syrjala@sci.fi> and
+              Claudio Ciccani <klan@users.sf.net>.
+
+   This file is subject to the terms and conditions of the MIT License:
+
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify, merge,
+   publish, distribute, sublicense, and/or sell copies of the Software,
+   and to permit persons to whom the Software is furnished to do so,
+   subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be
+   included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+   MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+   IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+   CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+   TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+   SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <config.h>
+
+#include <stdio.h>
+
+#include <directfb.h>
+
+#include <direct/conf.h>
+#include <direct/interface.h>
+#include <direct/modules.h>
+
+#include <core/gfxcard.h>
+#include <core/input.h>
+#include <core/system.h>
+#include <core/wm.h>
+
+/*
+ * Writes the manifests of all module directories, so that applications only load the modules they select.
+ * Run after (un)installing modules, e.g. "dfbmanifest --dfb:module-dir=<directory>".
+ */
+int
+main( int argc, char *argv[] )
+{
+     DFBResult ret;
+
+     /* Parse command line and environment, e.g. for the module directory. */
+     ret = DirectFBInit( &argc, &argv );
+     if (ret) {
+          DirectFBError( "DirectFBInit", ret );
+          return -1;
+     }
+
+     /* Load all modules instead of using the old manifests, and write new ones. */
+     direct_config_set( "module-manifest", "update" );
+
+     direct_modules_explore_directory( &dfb_core_systems );
+     direct_modules_explore_directory( &dfb_graphics_drivers );
+     direct_modules_explore_directory( &dfb_input_modules );
+     direct_modules_explore_directory( &dfb_core_wm_modules );
+
+     ret = DirectUpdateInterfaceManifest( NULL );
+     if (ret) {
+          DirectFBError( "DirectUpdateInterfaceManifest", ret );
+          return -2;
+     }
+
+     return 0;
+}
@@ -51,6 +51,7 @@
 #include <directfb_strings.h>
 
 #include <direct/debug.h>
+#include <direct/fastlz.h>
 
 #include <gfx/convert.h>
 #include <misc/dither565.h>
@@ -63,12 +64,16 @@ static const char            *filename;
 static DFBSurfacePixelFormat  format        = DSPF_UNKNOWN;
 static DFBSurfacePixelFormat  rgbformat     = DSPF_UNKNOWN;
 static bool                   premultiplied = false;
+static bool                   compress      = false;
+static unsigned int           tile_height   = 0;
+static unsigned int           mipmaps       = 0;
 
 /**********************************************************************************************************************/
 
 static DFBResult
 load_image (const char            *filename,
-            DFBSurfaceDescription *desc)
+            DFBSurfaceDescription *desc,
+            DFBSurfacePixelFormat *ret_format)
 {
      DFBSurfacePixelFormat dest_format;
      DFBSurfacePixelFormat src_format;
@@ -207,7 +212,7 @@ load_image (const char            *filename,
      if (!dest_format)
           dest_format = src_format;
 
-     if (premultiplied) {
+     if (premultiplied && src_format == DSPF_ARGB) {
           int y;
 
           for (y=0; y<height; y++) {
@@ -225,11 +230,54 @@ load_image (const char            *filename,
           }
      }
 
+     desc->flags = (DSDESC_WIDTH | DSDESC_HEIGHT | DSDESC_PIXELFORMAT |
+                    DSDESC_PREALLOCATED);
+     desc->width       = width;
+     desc->height      = height;
+     desc->pixelformat = src_format;
+     desc->preallocated[0].pitch = pitch;
+     desc->preallocated[0].data  = data;
+
+     *ret_format = dest_format;
+
+     data = NULL;
+
+ cleanup:
+     if (fp)
+          fclose (fp);
+
+     if (png_ptr)
+          png_destroy_read_struct (&png_ptr, &info_ptr, NULL);
+
+     if (data)
+          free (data);
+
+     return ((desc->flags) ? DFB_OK : DFB_FAILURE);
+}
+
+/*
+ * Converts the image in 'desc' to 'dest_format', replacing the data if needed.
+ * The original data is left for the caller to free.
+ */
+static DFBResult
+convert_image (DFBSurfaceDescription *desc,
+               DFBSurfacePixelFormat  dest_format)
+{
+     DFBSurfacePixelFormat  src_format = desc->pixelformat;
+     unsigned char         *data       = desc->preallocated[0].data;
+     int                    pitch      = desc->preallocated[0].pitch;
+     unsigned int           width      = desc->width;
+     unsigned int           height     = desc->height;
+
      if (DFB_BYTES_PER_PIXEL(src_format) != DFB_BYTES_PER_PIXEL(dest_format)) {
           unsigned char *s, *d, *dest;
           int            d_pitch, h;
 
-          D_ASSERT( DFB_BYTES_PER_PIXEL(src_format) == 4 );
+          if (DFB_BYTES_PER_PIXEL(src_format) != 4) {
+               fprintf (stderr,
+                        "Sorry, unsupported format conversion.\n");
+               return DFB_UNSUPPORTED;
+          }
 
           d_pitch = (DFB_BYTES_PER_LINE(dest_format, width) + 7) & ~7;
 
@@ -237,7 +285,7 @@ load_image (const char            *filename,
           if (!dest) {
                fprintf (stderr, "Failed to allocate %lu bytes.\n",
                         (unsigned long)(height * d_pitch));
-               goto cleanup;
+               return DFB_NOSYSTEMMEMORY;
           }
 
           h = height;
@@ -296,35 +344,65 @@ load_image (const char            *filename,
                default:
                     fprintf (stderr,
                              "Sorry, unsupported format conversion.\n");
-                    goto cleanup;
+                    free (dest);
+                    return DFB_UNSUPPORTED;
           }
 
-          free (data);
-          data = dest;
-          pitch = d_pitch;
+          desc->preallocated[0].data  = dest;
+          desc->preallocated[0].pitch = d_pitch;
      }
 
-     desc->flags = (DSDESC_WIDTH | DSDESC_HEIGHT | DSDESC_PIXELFORMAT |
-                    DSDESC_PREALLOCATED);
-     desc->width       = width;
-     desc->height      = height;
      desc->pixelformat = dest_format;
-     desc->preallocated[0].pitch = pitch;
-     desc->preallocated[0].data  = data;
 
-     data = NULL;
+     return DFB_OK;
+}
 
- cleanup:
-     if (fp)
-          fclose (fp);
 
-     if (png_ptr)
-          png_destroy_read_struct (&png_ptr, &info_ptr, NULL);
+/*
+ * Creates the next mip level of the image in 'src' by averaging 2x2 pixels,
+ * which is done per byte as the source formats only have 8 bit components.
+ */
+static DFBResult
+downscale_image (const DFBSurfaceDescription *src,
+                 DFBSurfaceDescription       *dst)
+{
+     int            bpp = DFB_BYTES_PER_PIXEL( src->pixelformat );
+     int            x, y, i;
+     unsigned char *data;
 
-     if (data)
-          free (data);
+     *dst = *src;
 
-     return ((desc->flags) ? DFB_OK : DFB_FAILURE);
+     dst->width  = MAX( src->width  / 2, 1 );
+     dst->height = MAX( src->height / 2, 1 );
+
+     dst->preallocated[0].pitch = (DFB_BYTES_PER_LINE( src->pixelformat, dst->width ) + 7) & ~7;
+
+     data = malloc (dst->height * dst->preallocated[0].pitch);
+     if (!data) {
+          fprintf (stderr, "Failed to allocate %lu bytes.\n",
+                   (unsigned long)(dst->height * dst->preallocated[0].pitch));
+          return DFB_NOSYSTEMMEMORY;
+     }
+
+     for (y = 0; y < dst->height; y++) {
+          const unsigned char *s0 = (const unsigned char*) src->preallocated[0].data +
+                                    MIN( y * 2, src->height - 1 ) * src->preallocated[0].pitch;
+          const unsigned char *s1 = (const unsigned char*) src->preallocated[0].data +
+                                    MIN( y * 2 + 1, src->height - 1 ) * src->preallocated[0].pitch;
+          unsigned char       *d  = data + y * dst->preallocated[0].pitch;
+
+          for (x = 0; x < dst->width; x++) {
+               int x0 = MIN( x * 2,     src->width - 1 ) * bpp;
+               int x1 = MIN( x * 2 + 1, src->width - 1 ) * bpp;
+
+               for (i = 0; i < bpp; i++)
+                    d[x*bpp+i] = (s0[x0+i] + s0[x1+i] + s1[x0+i] + s1[x1+i] + 2) >> 2;
+          }
+     }
+
+     dst->preallocated[0].data = data;
+
+     return DFB_OK;
 }
 
 /**********************************************************************************************************************/
@@ -340,6 +418,9 @@ print_usage (const char *prg_name)
      fprintf (stderr, "   -f, --format    <pixelformat>   Choose the pixel format (in all cases)\n");
      fprintf (stderr, "   -r, --rgbformat <pixelformat>   Choose the pixel format (in case of RGB)\n");
      fprintf (stderr, "   -p, --premultiplied             Generate premultiplied pixels\n");
+     fprintf (stderr, "   -c, --compress                  Compress the image data (fastlz)\n");
+     fprintf (stderr, "   -t, --tile-height <rows>        Split the image into tiles of <rows> (default 64 if compressed)\n");
+     fprintf (stderr, "   -m, --mipmaps     <count>       Add up to <count> mip levels (implies premultiplied)\n");
      fprintf (stderr, "   -h, --help                      Show this help message\n");
      fprintf (stderr, "   -v, --version                   Print version information\n");
      fprintf (stderr, "\n");
@@ -439,6 +520,33 @@ parse_command_line( int argc, char *argv[] )
                continue;
           }
 
+          if (strcmp (arg, "-c") == 0 || strcmp (arg, "--compress") == 0) {
+               compress = true;
+               continue;
+          }
+
+          if (strcmp (arg, "-t") == 0 || strcmp (arg, "--tile-height") == 0) {
+               if (++n == argc || sscanf( argv[n], "%u", &tile_height ) != 1 || !tile_height) {
+                    print_usage (argv[0]);
+                    return DFB_FALSE;
+               }
+
+               continue;
+          }
+
+          if (strcmp (arg, "-m") == 0 || strcmp (arg, "--mipmaps") == 0) {
+               if (++n == argc || sscanf( argv[n], "%u", &mipmaps ) != 1) {
+                    print_usage (argv[0]);
+                    return DFB_FALSE;
+               }
+
+               /* Averaging requires premultiplied pixels. */
+               if (mipmaps)
+                    premultiplied = true;
+
+               continue;
+          }
+
           if (filename || access( arg, R_OK )) {
                print_usage (argv[0]);
                return DFB_FALSE;
@@ -464,10 +572,131 @@ static DFIFFHeader header = {
      flags: DFIFF_FLAG_LITTLE_ENDIAN
 };
 
+#define MAX_LEVELS 16
+
+typedef struct {
+     const void   *data;
+     unsigned int  size;
+} Chunk;
+
+static unsigned int
+level_tiles( const DFBSurfaceDescription *level,
+             unsigned int                 rows )
+{
+     return (level->height + rows - 1) / rows;
+}
+
+/*
+ * Writes a version 2 file, see dfiff.h for the layout.
+ */
+static int
+write_v2( const DFBSurfaceDescription *levels,
+          unsigned int                 num_levels )
+{
+     DFIFFExtension ext;
+     DFIFFLevel     level_table[MAX_LEVELS];
+     DFIFFTile     *tile_table;
+     Chunk         *chunks;
+     unsigned int   i, n, t;
+     size_t         offset, written;
+
+     ext.compression = compress ? DFIFF_COMPRESSION_FASTLZ : DFIFF_COMPRESSION_NONE;
+     ext.tile_height = tile_height ? tile_height : compress ? 64U : (unsigned int) levels[0].height;
+     ext.num_levels  = num_levels;
+     ext.num_tiles   = 0;
+
+     for (i = 0; i < num_levels; i++)
+          ext.num_tiles += level_tiles( &levels[i], ext.tile_height );
+
+     tile_table = calloc( ext.num_tiles, sizeof(DFIFFTile) );
+     chunks     = calloc( ext.num_tiles, sizeof(Chunk) );
+     if (!tile_table || !chunks) {
+          fprintf (stderr, "Out of memory!\n");
+          return -3;
+     }
+
+     offset = sizeof(DFIFFHeader) + sizeof(DFIFFExtension) +
+              num_levels * sizeof(DFIFFLevel) + ext.num_tiles * sizeof(DFIFFTile);
+
+     for (i = 0, n = 0; i < num_levels; i++) {
+          const DFBSurfaceDescription *level = &levels[i];
+
+          offset = (offset + DFIFF_DATA_ALIGN - 1) & ~(DFIFF_DATA_ALIGN - 1);
+
+          level_table[i].width      = level->width;
+          level_table[i].height     = level->height;
+          level_table[i].pitch      = level->preallocated[0].pitch;
+          level_table[i].first_tile = n;
+
+          for (t = 0; t < level_tiles( level, ext.tile_height ); t++, n++) {
+               unsigned int  rows = MIN( ext.tile_height, level->height - t * ext.tile_height );
+               unsigned int  size = rows * level->preallocated[0].pitch;
+               const u8     *raw  = (const u8*) level->preallocated[0].data + t * ext.tile_height * level->preallocated[0].pitch;
+
+               chunks[n].data = raw;
+               chunks[n].size = size;
+
+               if (compress) {
+                    /* Output may be up to 5% larger, at least 66 bytes. */
+                    void *packed = malloc( size + size / 16 + 66 );
+                    int   length;
+
+                    if (!packed) {
+                         fprintf (stderr, "Out of memory!\n");
+                         return -3;
+                    }
+
+                    length = direct_fastlz_compress( raw, size, packed );
+
+                    /* Keep incompressible tiles as they are. */
+                    if (length > 0 && (unsigned int) length < size) {
+                         chunks[n].data = packed;
+                         chunks[n].size = length;
+                    }
+                    else
+                         free( packed );
+               }
+
+               tile_table[n].offset = offset;
+               tile_table[n].size   = chunks[n].size;
+
+               offset += chunks[n].size;
+          }
+     }
+
+     header.major = DFIFF_MAJOR_V2;
+
+     fwrite( &header, sizeof(header), 1, stdout );
+     fwrite( &ext, sizeof(ext), 1, stdout );
+     fwrite( level_table, sizeof(DFIFFLevel), num_levels, stdout );
+     fwrite( tile_table, sizeof(DFIFFTile), ext.num_tiles, stdout );
+
+     written = sizeof(DFIFFHeader) + sizeof(DFIFFExtension) +
+               num_levels * sizeof(DFIFFLevel) + ext.num_tiles * sizeof(DFIFFTile);
+
+     for (n = 0; n < ext.num_tiles; n++) {
+          static const u8 zero[DFIFF_DATA_ALIGN];
+
+          fwrite( zero, 1, tile_table[n].offset - written, stdout );
+          fwrite( chunks[n].data, 1, chunks[n].size, stdout );
+
+          written = tile_table[n].offset + chunks[n].size;
+     }
+
+     fprintf( stderr, "%u level(s), %u tile(s) of %u rows, %lu bytes\n",
+              num_levels, ext.num_tiles, ext.tile_height, (unsigned long) written );
+
+     return 0;
+}
+
 int
 main( int argc, char *argv[] )
 {
-     int                   i;
+     unsigned int          i;
+     unsigned int          num_levels = 1;
+     DFBSurfacePixelFormat dest_format;
+     DFBSurfaceDescription source[MAX_LEVELS];
+     DFBSurfaceDescription levels[MAX_LEVELS];
      DFBSurfaceDescription desc = { flags: DSDESC_NONE };
 
      /* Parse the command line. */
@@ -479,9 +708,30 @@ main( int argc, char *argv[] )
           desc.pixelformat  = format;
      }
 
-     if (load_image( filename, &desc ))
+     if (load_image( filename, &desc, &dest_format ))
           return -2;
 
+     source[0] = desc;
+
+     /* Mip levels are generated from the source pixels before conversion. */
+     while (num_levels <= mipmaps && num_levels < MAX_LEVELS &&
+            (source[num_levels-1].width > 1 || source[num_levels-1].height > 1))
+     {
+          if (downscale_image( &source[num_levels-1], &source[num_levels] ))
+               return -3;
+
+          num_levels++;
+     }
+
+     for (i=0; i<num_levels; i++) {
+          levels[i] = source[i];
+
+          if (convert_image( &levels[i], dest_format ))
+               return -2;
+     }
+
+     desc = levels[0];
+
      for (i=0; i<D_ARRAY_SIZE(format_names); i++) {
           if (format_names[i].format == desc.pixelformat) {
                fprintf( stderr, "Writing %dx%d %s image...\n", desc.width, desc.height,
@@ -498,6 +748,9 @@ main( int argc, char *argv[] )
      if (premultiplied)
           header.flags |= DFIFF_FLAG_PREMULTIPLIED;
 
+     if (compress || tile_height || num_levels > 1)
+          return write_v2( levels, num_levels );
+
      fwrite( &header, sizeof(header), 1, stdout );
 
      fwrite( desc.preallocated[0].data, header.pitch, header.height, stdout );
@@ -61,6 +61,7 @@
 static DFBBoolean show_geometry = DFB_FALSE;
 static DFBBoolean m_listen      = DFB_FALSE;
 static DFBBoolean m_performance = DFB_FALSE;
+static DFBBoolean m_stats       = DFB_FALSE;
 
 static DFBBoolean parse_command_line( int argc, char *argv[] );
 
@@ -335,6 +336,117 @@ dump_tiers( SaWMan *sawman )
 
           dump_tier( sawman, tier, n++ );
      }
+
+     for (n=0; n<sawman->num_overlays; n++) {
+          SaWManOverlay *overlay = &sawman->overlays[n];
+
+          if (overlay->window)
+               printf( "Overlay [%u]  window %u  %4d,%4d - %4dx%4d  %s\n", overlay->layer_id, overlay->window->id,
+                       DFB_RECTANGLE_VALS( &overlay->dst ), dfb_pixelformat_name( overlay->format ) );
+          else
+               printf( "Overlay [%u]  unused\n", overlay->layer_id );
+     }
+}
+
+/**********************************************************************************************************************/
+
+#define MAX_STATS_WINDOWS  256
+
+static struct {
+     DFBWindowID        id;
+     SaWManWindowStats  stats;
+     bool               seen;
+} m_last_stats[MAX_STATS_WINDOWS];
+
+static unsigned int m_num_last_stats;
+
+static void
+dump_window_stats( SaWMan *sawman, bool print )
+{
+     unsigned int  i, n;
+     SaWManWindow *sawwin;
+
+     D_MAGIC_ASSERT( sawman, SaWMan );
+
+     if (sawman_lock( sawman ))
+          return;
+
+     for (i=0; i<m_num_last_stats; i++)
+          m_last_stats[i].seen = false;
+
+     direct_list_foreach (sawwin, sawman->windows) {
+          CoreWindow        *window;
+          SaWManWindowStats  stats;
+          SaWManWindowStats *last = NULL;
+          unsigned int       displayed;
+
+          D_MAGIC_ASSERT( sawwin, SaWManWindow );
+
+          window = sawwin->window;
+          D_ASSERT( window != NULL );
+
+          stats = sawwin->stats;
+
+          for (i=0; i<m_num_last_stats; i++) {
+               if (m_last_stats[i].id == window->id) {
+                    m_last_stats[i].seen = true;
+
+                    last = &m_last_stats[i].stats;
+                    break;
+               }
+          }
+
+          if (!last) {
+               if (m_num_last_stats == MAX_STATS_WINDOWS)
+                    continue;
+
+               m_last_stats[m_num_last_stats].id   = window->id;
+               m_last_stats[m_num_last_stats].seen = true;
+
+               last = &m_last_stats[m_num_last_stats++].stats;
+
+               memset( last, 0, sizeof(SaWManWindowStats) );
+          }
+
+          displayed = stats.frames_displayed - last->frames_displayed;
+
+          if (print && (stats.frames_submitted != last->frames_submitted || stats.pixels != last->pixels)) {
+               long long avg = displayed ? (stats.latency_total - last->latency_total) / displayed : 0;
+
+               /* The maximum is kept by SaWMan over the window's lifetime, not per interval. */
+               D_INFO( "Window [%4u] pid %5d: %4u submitted, %4u displayed, %4u merged, %6llu Kpixels, "
+                       "latency avg %lld.%03lld ms, lifetime max %lld.%03lld ms\n",
+                       window->id, sawwin->process.pid, stats.frames_submitted - last->frames_submitted, displayed,
+                       stats.frames_merged - last->frames_merged, (stats.pixels - last->pixels) / 1000,
+                       avg / 1000, avg % 1000, stats.latency_max / 1000, stats.latency_max % 1000 );
+
+               /* Only recorded with the 'window-histogram' option of the master. */
+               if (memcmp( stats.histogram, last->histogram, sizeof(stats.histogram) )) {
+                    char buf[SAWMAN_WINDOW_STATS_BUCKETS * 12 + 1];
+                    int  len = 0;
+
+                    for (i=0; i<SAWMAN_WINDOW_STATS_BUCKETS; i++)
+                         len += snprintf( buf + len, sizeof(buf) - len, " %s%3u:%-4u",
+                                          i < SAWMAN_WINDOW_STATS_BUCKETS - 1 ? "<" : ">=",
+                                          1 << (i < SAWMAN_WINDOW_STATS_BUCKETS - 1 ? i : i - 1),
+                                          stats.histogram[i] - last->histogram[i] );
+
+                    D_INFO( "               latency ms%s\n", buf );
+               }
+          }
+
+          *last = stats;
+     }
+
+     sawman_unlock( sawman );
+
+     /* Forget windows that are gone. */
+     for (i=0, n=0; i<m_num_last_stats; i++) {
+          if (m_last_stats[i].seen)
+               m_last_stats[n++] = m_last_stats[i];
+     }
+
+     m_num_last_stats = n;
 }
 
 /**********************************************************************************************************************/
@@ -478,19 +590,35 @@ main( int argc, char *argv[] )
 
      fflush( stdout );
 
-     if (m_performance) {
+     if (m_performance || m_stats) {
           unsigned int       updates;
           unsigned long long pixels;
           long long          duration;
+          unsigned int       hits;
+          unsigned int       rebuilds;
+          unsigned long long saved;
+
+          if (m_performance) {
+               saw->GetPerformance( saw, DWSC_LOWER, DFB_TRUE, &updates, &pixels, &duration );
+               saw->GetPerformance( saw, DWSC_UPPER, DFB_TRUE, &updates, &pixels, &duration );
+
+               saw->GetCachePerformance( saw, DWSC_LOWER, DFB_TRUE, &hits, &rebuilds, &saved );
+          }
 
-          saw->GetPerformance( saw, DWSC_LOWER, DFB_TRUE, &updates, &pixels, &duration );
-          saw->GetPerformance( saw, DWSC_UPPER, DFB_TRUE, &updates, &pixels, &duration );
+          if (m_stats)
+               dump_window_stats( data->sawman, false );
 
           while (true) {
                unsigned int mpixels;
 
                sleep( 2 );
 
+               if (m_stats)
+                    dump_window_stats( data->sawman, true );
+
+               if (!m_performance)
+                    continue;
+
 
                ret = saw->GetPerformance( saw, DWSC_LOWER, DFB_TRUE, &updates, &pixels, &duration );
                if (ret) {
@@ -503,6 +631,10 @@ main( int argc, char *argv[] )
                D_INFO( "Performance [LOWER]: %u updates (%u /sec), %u Mpixels (%u /sec)\n",
                        updates, updates * 1000 / (int)duration, mpixels, mpixels * 1000 / (int)duration );
 
+               if (saw->GetCachePerformance( saw, DWSC_LOWER, DFB_TRUE, &hits, &rebuilds, &saved ) == DR_OK && (hits || rebuilds))
+                    D_INFO( "Cache       [LOWER]: %u hits, %u rebuilds, %llu Mpixels saved\n",
+                            hits, rebuilds, saved / 1000000 );
+
 
                ret = saw->GetPerformance( saw, DWSC_UPPER, DFB_TRUE, &updates, &pixels, &duration );
                if (ret) {
@@ -540,6 +672,7 @@ print_usage (const char *prg_name)
      fprintf (stderr, "   -g, --geometry     Show advanced geometry settings\n");
      fprintf (stderr, "   -l, --listen       Register listener and print events\n");
      fprintf (stderr, "   -p, --performance  Show performance counters\n");
+     fprintf (stderr, "   -s, --stats        Show frame statistics per window\n");
      fprintf (stderr, "   -h, --help         Show this help message\n");
      fprintf (stderr, "   -v, --version      Print version information\n");
      fprintf (stderr, "\n");
@@ -578,6 +711,11 @@ parse_command_line( int argc, char *argv[] )
                continue;
           }
 
+          if (strcmp (arg, "-s") == 0 || strcmp (arg, "--stats") == 0) {
+               m_stats = true;
+               continue;
+          }
+
           print_usage (argv[0]);
 
           return DFB_FALSE;
@@ -160,6 +160,9 @@ typedef struct {
      CoreSurface                  *surface;
      Reaction                      surface_reaction;
      DFB_Task                     *last_notify_task;
+
+     u32                           damaged;            /* frame counter of the surface when its back buffer
+                                                          got the damage of older frames, 0 if never */
 } StackData;
 
 typedef struct {
@@ -1470,6 +1473,26 @@ defaultwm_surface_display_notify( void     *ctx,
      return DFB_OK;
 }
 
+/*
+ * Whether the back buffer is brought up to date by repainting the damage of the frames it missed
+ * instead of copying back from the front buffer after each flip.
+ */
+static bool
+buffer_age( StackData *data )
+{
+     if (dfb_config->task_manager || dfb_config->wm_fullscreen_updates)
+          return false;
+
+     if (!data->region || !data->surface || data->stack->rotation)
+          return false;
+
+     if (data->region->config.options & DLOP_STEREO)
+          return false;
+
+     return data->region->config.buffermode == DLBM_BACKVIDEO ||
+            data->region->config.buffermode == DLBM_TRIPLE;
+}
+
 static void
 flush_updating( StackData *data )
 {
@@ -1550,7 +1573,7 @@ flush_updating( StackData *data )
           dfb_layer_region_flip_update( data->region, &data->updated.bounding, DSFLIP_ONSYNC | DSFLIP_SWAP );
 
 
-     if (left_num_regions) {
+     if (left_num_regions && !buffer_age( data )) {
           D_DEBUG_AT( WM_Default, "  -> copying %d updated regions (F->B)\n", left_num_regions );
 
           for (i=0; i<left_num_regions; i++) {
@@ -1657,9 +1680,22 @@ repaint_stack( CoreWindowStack     *stack,
 
      CoreGraphicsStateClient_Flush( &wmdata->client, 0, CGSCFF_NONE );
 
+     /* Only repairing the back buffer? */
+     if (!bounding) {
+          fusion_skirmish_dismiss( &wmdata->update_skirmish );
+          return;
+     }
 
      switch (region->config.buffermode) {
           case DLBM_TRIPLE:
+               if (buffer_age( data )) {
+                    dfb_updates_add( &data->updating, bounding );
+
+                    if (!data->updated.num_regions)
+                         flush_updating( data );
+                    break;
+               }
+
                /* Add the updated region. */
                for (i=0; i<num_updates; i++) {
                     const DFBRegion *update = &flips[i];
@@ -1682,7 +1718,7 @@ repaint_stack( CoreWindowStack     *stack,
 
                /* Copy back the updated region. */
 
-               if (!dfb_config->wm_fullscreen_updates)
+               if (!dfb_config->wm_fullscreen_updates && !buffer_age( data ))
                     dfb_gfx_copy_regions_client( region->surface, CSBR_FRONT, DSSE_LEFT, region->surface, CSBR_BACK, DSSE_LEFT, updates, num_updates, 0, 0, &wmdata->client );
 
                break;
@@ -1704,6 +1740,32 @@ repaint_stack( CoreWindowStack     *stack,
      fusion_skirmish_dismiss( &wmdata->update_skirmish );
 }
 
+/*
+ * Repaints the damage of the frames missed by the back buffer, before drawing into it directly.
+ */
+static void
+repair_back_buffer( CoreWindowStack *stack,
+                    StackData       *data,
+                    WMData          *wmdata )
+{
+     DFBRegion  regions[CORE_LAYER_REGION_DAMAGE_HISTORY];
+     DFBUpdates damage;
+     DFBRegion  full     = { 0, 0, stack->width - 1, stack->height - 1 };
+     u32        presents = data->surface->presents;
+
+     if (data->damaged && data->damaged == presents)
+          return;
+
+     dfb_updates_init( &damage, regions, D_ARRAY_SIZE(regions) );
+
+     if (dfb_layer_region_get_damage( data->region, &damage ))
+          repaint_stack( stack, data, &full, 1, DSFLIP_NONE, NULL, wmdata );
+     else if (damage.num_regions)
+          repaint_stack( stack, data, damage.regions, damage.num_regions, DSFLIP_NONE, NULL, wmdata );
+
+     data->damaged = presents;
+}
+
 static DFBResult
 process_updates( StackData           *data,
                  WMData              *wmdata,
@@ -1713,6 +1775,7 @@ process_updates( StackData           *data,
      int               n, d;
      int               total;
      int               bounding;
+     DFBRegion         flip;
      CoreLayerContext *context;
      (void)context;
 
@@ -1726,6 +1789,19 @@ process_updates( StackData           *data,
      if (!data->updates.num_regions)
           return DFB_OK;
 
+     /* Flip with the new updates only, the damage of older frames is just repainted. */
+     flip = data->updates.bounding;
+
+     if (buffer_age( data ) && (!data->damaged || data->damaged != data->surface->presents)) {
+          if (dfb_layer_region_get_damage( data->region, &data->updates )) {
+               DFBRegion full = { 0, 0, stack->width - 1, stack->height - 1 };
+
+               dfb_updates_add( &data->updates, &full );
+          }
+
+          data->damaged = data->surface->presents;
+     }
+
      if (dfb_config->wm_fullscreen_updates) {
           DFBRegion reg = { 0, 0, stack->width - 1, stack->height - 1 };
 
@@ -1751,15 +1827,15 @@ process_updates( StackData           *data,
 //          if (context->config.buffermode == DLBM_FRONTONLY)
 //               dfb_region_transpose(&region, context->rotation);
 
-          repaint_stack( stack, data, &region, 1, flags, &data->updates.bounding, wmdata );
+          repaint_stack( stack, data, &region, 1, flags, &flip, wmdata );
      }
      else if (data->updates.num_regions < 2 || total < bounding * n / d)
-          repaint_stack( stack, data, data->updates.regions, data->updates.num_regions, flags, &data->updates.bounding, wmdata );
+          repaint_stack( stack, data, data->updates.regions, data->updates.num_regions, flags, &flip, wmdata );
      else {
 //          direct_log_printf( NULL, "%s() <- %d regions, total %d, bounding %d (%d/%d: %d)\n",
 //                             __FUNCTION__, data->updates.num_regions, total, bounding, n, d, bounding*n/d );
 
-          repaint_stack( stack, data, &data->updates.bounding, 1, flags, &data->updates.bounding, wmdata );
+          repaint_stack( stack, data, &data->updates.bounding, 1, flags, &flip, wmdata );
      }
 
      dfb_updates_reset( &data->updates );
@@ -4452,6 +4528,10 @@ wm_update_cursor( CoreWindowStack       *stack,
 
      D_MAGIC_ASSERT( data, StackData );
 
+     /* The cursor is drawn into the back buffer and shown from there, bring it up to date first. */
+     if (stack->cursor.enabled && stack->cursor.opacity && data->active && buffer_age( data ))
+          repair_back_buffer( stack, data, wm_data );
+
      old_region = data->cursor_region;
 
      transform_stack_to_dest( stack, &old_region, &old_dest );
@@ -82,6 +82,7 @@
 #include <sawman/sawman_config.h>
 
 #include <sawman/sawman_draw.h>
+#include <sawman/sawman_overlay.h>
 #include <sawman/sawman_updates.h>
 #include <sawman/sawman_window.h>
 
@@ -1461,7 +1462,7 @@ sawman_surface_reaction( const void *msg_data,
                                    }
                                    else {
                                         /* Copy back the updated region. */
-                                        if (tier->left.updated.num_regions) {
+                                        if (tier->left.updated.num_regions && !sawman_tier_buffer_age( tier )) {
                                              D_DEBUG_AT( SaWMan_Surface, "  -> copying %d updated regions (F->I) (left)\n", tier->left.updated.num_regions );
      
                                              for (i=0; i<tier->left.updated.num_regions; i++) {
@@ -1594,6 +1595,7 @@ wm_close_stack( CoreWindowStack *stack,
                 void            *stack_data )
 {
      DFBResult    ret;
+     int          i;
      StackData   *data = stack_data;
      SaWMan      *sawman;
      SaWManTier  *tier;
@@ -1624,6 +1626,12 @@ wm_close_stack( CoreWindowStack *stack,
 
      D_ASSERT( tier->context != NULL );
 
+     /* Give back promoted windows. */
+     for (i=0; i<sawman->num_overlays; i++) {
+          if (sawman->overlays[i].tier == tier)
+               sawman_overlay_demote( sawman, sawman->overlays[i].window );
+     }
+
      dfb_surface_detach( tier->surface, &tier->surface_reaction );
 
      tier->stack   = NULL;
@@ -1642,6 +1650,10 @@ wm_close_stack( CoreWindowStack *stack,
      if (tier->cursor_bs_right)
           dfb_surface_unlink( &tier->cursor_bs_right );
 
+     /* Destroy compositing cache. */
+     if (tier->cache.surface)
+          dfb_surface_unlink( &tier->cache.surface );
+
      direct_list_remove( &sawman->tiers, &tier->link );
      D_MAGIC_CLEAR( tier );
      SHFREE( sawman->shmpool, tier );
@@ -3741,6 +3753,8 @@ wm_update_window( CoreWindow          *window,
           dfb_updates_add( &sawwin->right.updates, sawwin->parent ? NULL : right_region );     // FIXME: will crash with NULL
      }
      else {
+          sawman_window_stats_submitted( sawman, sawwin );
+
           if (tier->single_mode && tier->single_window != NULL) {
                if (tier->single_window == sawwin) {
                     /* Save current buffers focus */
@@ -3784,6 +3798,8 @@ wm_update_window( CoreWindow          *window,
                     }
 
                     sawwin->flags &= ~SWMWF_UPDATING;
+
+                    sawman_window_stats_displayed( sawman, sawwin );
                }
           }
           else {
@@ -4102,6 +4118,11 @@ wm_update_cursor( CoreWindowStack       *stack,
 
      D_DEBUG_AT( SaWMan_Cursor, "  -> position %4d,%4d (%d,%d)\n", x, y, stack->cursor.x, stack->cursor.y );
 
+     /* The software cursor is drawn into the back buffer and shown from there, bring it up to date first. */
+     if (!sawman->cursor.region && stack->cursor.enabled && stack->cursor.opacity && tier->active && wmdata->refs &&
+         sawman_tier_buffer_age( tier ))
+          sawman_repair_back_buffer( sawman, tier, wmdata );
+
      old_region = tier->cursor_region;
 
      if (flags & (CCUF_ENABLE | CCUF_POSITION | CCUF_SIZE)) {